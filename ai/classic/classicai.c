@@ -405,6 +405,71 @@ static void cai_auto_settler_reset(struct player *pplayer)
   dai_auto_settler_reset(deftype, pplayer);
 }
 
+/**********************************************************************//**
+  Call default ai with classic ai type as parameter.
+**************************************************************************/
+static void cai_tile_info(struct tile *ptile)
+{
+  struct ai_type *deftype = classic_ai_get_self();
+
+  dai_tile_info(deftype, ptile);
+  dai_danger_tile_changed(deftype, ptile);
+}
+
+/**********************************************************************//**
+  Call default ai with classic ai type as parameter.
+**************************************************************************/
+static void cai_unit_created_event(struct unit *punit)
+{
+  struct ai_type *deftype = classic_ai_get_self();
+
+  dai_stats_unit_created(deftype, punit);
+  dai_danger_unit_event(deftype, punit);
+}
+
+/**********************************************************************//**
+  Call default ai with classic ai type as parameter.
+**************************************************************************/
+static void cai_unit_destroyed_event(struct unit *punit)
+{
+  struct ai_type *deftype = classic_ai_get_self();
+
+  dai_stats_unit_destroyed(deftype, punit);
+  dai_danger_unit_event(deftype, punit);
+}
+
+/**********************************************************************//**
+  Call default ai with classic ai type as parameter.
+**************************************************************************/
+static void cai_unit_moved_event(struct unit *punit)
+{
+  struct ai_type *deftype = classic_ai_get_self();
+
+  dai_stats_unit_moved(deftype, punit);
+  dai_danger_unit_event(deftype, punit);
+}
+
+/**********************************************************************//**
+  Call default ai with classic ai type as parameter.
+**************************************************************************/
+static void cai_unit_changed_event(struct unit *punit)
+{
+  struct ai_type *deftype = classic_ai_get_self();
+
+  dai_stats_unit_changed(deftype, punit);
+  dai_danger_unit_event(deftype, punit);
+}
+
+/**********************************************************************//**
+  Call default ai with classic ai type as parameter.
+**************************************************************************/
+static void cai_danger_city_changed(struct city *pcity)
+{
+  struct ai_type *deftype = classic_ai_get_self();
+
+  dai_danger_city_changed(deftype, pcity);
+}
+
 /**********************************************************************//**
   Call default ai with classic ai type as parameter.
 **************************************************************************/
@@ -661,13 +726,15 @@ bool fc_ai_classic_setup(struct ai_type *ai)
   */
   ai->funcs.unit_alloc = cai_unit_init;
   ai->funcs.unit_free = cai_unit_close;
+  ai->funcs.unit_created = cai_unit_created_event;
+  ai->funcs.unit_destroyed = cai_unit_destroyed_event;
   ai->funcs.unit_got = cai_ferry_init_ferry;
   ai->funcs.unit_lost = cai_ferry_lost;
   ai->funcs.unit_transformed = cai_ferry_transformed;
 
   ai->funcs.unit_turn_end = cai_unit_turn_end;
   ai->funcs.unit_move = cai_unit_move_or_attack;
-  /* ai->funcs.unit_move_seen = NULL; */
+  ai->funcs.unit_move_seen = cai_unit_moved_event;
   ai->funcs.unit_task = cai_unit_new_adv_task;
 
   ai->funcs.unit_save = cai_unit_save;
@@ -697,9 +764,9 @@ bool fc_ai_classic_setup(struct ai_type *ai)
 
   /* ai->funcs.refresh = NULL; */
 
-  /* ai->funcs.tile_info = NULL; */
-  /* ai->funcs.city_info = NULL; */
-  /* ai->funcs.unit_info = NULL; */
+  ai->funcs.tile_info = cai_tile_info;
+  ai->funcs.city_info = cai_danger_city_changed;
+  ai->funcs.unit_info = cai_unit_changed_event;
 
   ai->funcs.revolution_start = cai_revolution_start;
 
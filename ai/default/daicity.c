@@ -19,14 +19,18 @@
 #include <math.h> /* pow */
 
 /* utility */
+#include "fcthread.h"
 #include "rand.h"
 #include "registry.h"
 
 /* common */
 #include "actions.h"
+#include "combat.h"
+#include "effects.h"
 #include "game.h"
 #include "government.h"
 #include "map.h"
+#include "requirements.h"
 #include "research.h"
 #include "specialist.h"
 
@@ -126,13 +130,18 @@ static void resolve_city_emergency(struct ai_type *ait,
   This function must convert from units of 'building want' to 'tech want'.
   We put this conversion in a function because the 'want' scales are
   unclear and kludged. Consequently, this conversion might require tweaking.
+
+  The result is accumulated into 'tech_wants', which is either the
+  player's tech want array or a job-local buffer of the parallel
+  building evaluation.
 **************************************************************************/
 static void want_tech_for_improvement_effect(struct ai_type *ait,
                                              struct player *pplayer,
                                              const struct city *pcity,
                                              const struct impr_type *pimprove,
                                              const struct advance *tech,
-                                             adv_want building_want)
+                                             adv_want building_want,
+                                             adv_want *tech_wants)
 {
   /* The conversion factor was determined by experiment,
    * and might need adjustment. See also dai_tech_effect_values()
@@ -148,8 +157,7 @@ static void want_tech_for_improvement_effect(struct ai_type *ait,
            building_want, tech_want);
 #endif /* 0 */
   if (tech) {
-    def_ai_player_data(pplayer, ait)->tech_want[advance_index(tech)]
-      += tech_want;
+    tech_wants[advance_index(tech)] += tech_want;
   }
 }
 
@@ -162,7 +170,8 @@ void want_techs_for_improvement_effect(struct ai_type *ait,
                                        const struct city *pcity,
                                        const struct impr_type *pimprove,
                                        struct tech_vector *needed_techs,
-                                       adv_want building_want)
+                                       adv_want building_want,
+                                       adv_want *tech_wants)
 {
   int t;
   int n_needed_techs = tech_vector_size(needed_techs);
@@ -170,7 +179,7 @@ void want_techs_for_improvement_effect(struct ai_type *ait,
   for (t = 0; t < n_needed_techs; t++) {
     want_tech_for_improvement_effect(ait, pplayer, pcity, pimprove,
                                      *tech_vector_get(needed_techs, t),
-                                     building_want);
+                                     building_want, tech_wants);
   }
 }
 
@@ -182,13 +191,14 @@ void dont_want_tech_obsoleting_impr(struct ai_type *ait,
                                     struct player *pplayer,
                                     const struct city *pcity,
                                     const struct impr_type *pimprove,
-                                    adv_want building_want)
+                                    adv_want building_want,
+                                    adv_want *tech_wants)
 {
   requirement_vector_iterate(&pimprove->obsolete_by, pobs) {
     if (pobs->source.kind == VUT_ADVANCE && pobs->present) {
       want_tech_for_improvement_effect(ait, pplayer, pcity, pimprove,
                                        pobs->source.value.advance,
-                                       -building_want);
+                                       -building_want, tech_wants);
     }
   } requirement_vector_iterate_end;
 }
@@ -1135,6 +1145,7 @@ void dai_city_alloc(struct ai_type *ait, struct city *pcity)
   struct ai_city *city_data = fc_calloc(1, sizeof(struct ai_city));
 
   city_data->building_wait = BUILDING_WAIT_MINIMUM;
+  city_data->gold_worth_turn = -1;
   adv_init_choice(&(city_data->choice));
 
   city_set_ai_data(pcity, ait, city_data);
@@ -1150,6 +1161,21 @@ void dai_city_free(struct ai_type *ait, struct city *pcity)
   if (city_data != nullptr) {
     adv_deinit_choice(&(city_data->choice));
     city_set_ai_data(pcity, ait, nullptr);
+    if (city_data->danger_reduced != nullptr) {
+      FC_FREE(city_data->danger_reduced);
+    }
+    if (city_data->effect_memo != nullptr) {
+      int i;
+
+      for (i = 0; i < B_LAST; i++) {
+        if (city_data->effect_memo[i] != nullptr) {
+          FC_FREE(city_data->effect_memo[i]->values);
+          FC_FREE(city_data->effect_memo[i]->valid);
+          FC_FREE(city_data->effect_memo[i]);
+        }
+      }
+      FC_FREE(city_data->effect_memo);
+    }
     FC_FREE(city_data);
   }
 }
@@ -1364,7 +1390,8 @@ static bool adjust_wants_for_reqs(struct ai_type *ait,
                                   struct player *pplayer,
                                   struct city *pcity,
                                   const struct impr_type *pimprove,
-                                  const adv_want v)
+                                  const adv_want v,
+                                  adv_want *tech_wants)
 {
   bool all_met = TRUE;
   int n_needed_techs = 0;
@@ -1409,7 +1436,7 @@ static bool adjust_wants_for_reqs(struct ai_type *ait,
     const adv_want dv = v / n_needed_techs;
 
     want_techs_for_improvement_effect(ait, pplayer, pcity, pimprove,
-                                      &needed_techs, dv);
+                                      &needed_techs, dv, tech_wants);
   }
 
   /* If v is negative, the improvement is not worth building,
@@ -1429,7 +1456,8 @@ static bool adjust_wants_for_reqs(struct ai_type *ait,
       /* TODO: increase the want for the needed_impr,
        * if we can build it now */
       /* Recurse */
-      (void) adjust_wants_for_reqs(ait, pplayer, pcity, needed_impr, dv);
+      (void) adjust_wants_for_reqs(ait, pplayer, pcity, needed_impr, dv,
+                                   tech_wants);
     }
   }
 
@@ -1602,12 +1630,19 @@ static adv_want base_want(struct ai_type *ait, struct player *pplayer,
 
   IDEA: Calculate per-continent aggregates of various data, and use this
   for wonders below for better wonder placements.
+
+  'base_v' is the want measured by base_want() in the serial pass of
+  dai_build_adv_adjust(); everything done here only reads game state, so
+  it may run on a worker thread. Tech wants go into 'tech_wants' rather
+  than straight into the player data for the same reason.
 **************************************************************************/
 static void adjust_improvement_wants_by_effects(struct ai_type *ait,
                                                 struct player *pplayer,
                                                 struct city *pcity,
                                                 struct impr_type *pimprove,
-                                                const bool already)
+                                                const bool already,
+                                                adv_want base_v,
+                                                adv_want *tech_wants)
 {
   adv_want v = 0;
   int cities[REQ_RANGE_COUNT];
@@ -1622,6 +1657,9 @@ static void adjust_improvement_wants_by_effects(struct ai_type *ait,
   const bool is_convert = is_convert_improvement(pimprove);
   int turns = 9999;
   int place = tile_continent(pcity->tile);
+  struct effect_list *elist = get_req_source_effects(&source);
+  struct dai_effect_memo *memo = nullptr;
+  int eff_idx = 0;
 
   /* FIXME: Do we really need the effects check to be made *without*
    * passing the city tile? */
@@ -1666,15 +1704,9 @@ static void adjust_improvement_wants_by_effects(struct ai_type *ait,
     }
     /* Without relevant flags, base want remains 0. */
   } else {
-    /* Base want is calculated above using a more direct approach. */
-    v += base_want(ait, pplayer, pcity, pimprove);
-    if (v != 0) {
-      CITY_LOG(LOG_DEBUG, pcity,
-               "%s base_want is " ADV_WANT_PRINTF " (range=%d)",
-               improvement_rule_name(pimprove),
-               v,
-               ai->impr_range[improvement_index(pimprove)]);
-    }
+    /* Base want is measured by base_want() using a more direct
+     * approach. */
+    v += base_v;
   }
 
   if (!is_convert) {
@@ -1721,7 +1753,44 @@ static void adjust_improvement_wants_by_effects(struct ai_type *ait,
     }
   } players_iterate_end;
 
-  effect_list_iterate(get_req_source_effects(&source), peffect) {
+  /* Set up the memo of dai_effect_value() results. The effect arithmetic
+   * mostly depends on city state tracked by pcity->server.state_gen plus
+   * slow-moving player-wide aggregates, so values computed in earlier
+   * turns can be reused until the city itself changes. */
+  if (elist != nullptr && effect_list_size(elist) > 0) {
+    struct ai_city *city_data = def_ai_city_data(pcity, ait);
+
+    if (city_data != nullptr) {
+      int b = improvement_index(pimprove);
+
+      if (city_data->effect_memo == nullptr) {
+        city_data->effect_memo
+          = fc_calloc(B_LAST, sizeof(city_data->effect_memo[0]));
+      }
+      memo = city_data->effect_memo[b];
+      if (memo != nullptr && memo->n_values != effect_list_size(elist)) {
+        /* The ruleset effects changed under us; rebuild the memo. */
+        FC_FREE(memo->values);
+        FC_FREE(memo->valid);
+        FC_FREE(memo);
+        memo = nullptr;
+        city_data->effect_memo[b] = nullptr;
+      }
+      if (memo == nullptr) {
+        memo = fc_malloc(sizeof(*memo));
+        memo->n_values = effect_list_size(elist);
+        memo->values = fc_malloc(memo->n_values * sizeof(memo->values[0]));
+        memo->valid = fc_calloc(memo->n_values, sizeof(memo->valid[0]));
+        memo->gen = pcity->server.state_gen;
+        city_data->effect_memo[b] = memo;
+      } else if (memo->gen != pcity->server.state_gen) {
+        memset(memo->valid, 0, memo->n_values * sizeof(memo->valid[0]));
+        memo->gen = pcity->server.state_gen;
+      }
+    }
+  }
+
+  effect_list_iterate(elist, peffect) {
     enum req_range range = REQ_RANGE_MAX;
     bool active = TRUE;
     int n_needed_techs = 0;
@@ -1759,8 +1828,18 @@ static void adjust_improvement_wants_by_effects(struct ai_type *ait,
 
     n_needed_techs = tech_vector_size(&needed_techs);
     if ((active || n_needed_techs) && !impossible_to_get) {
-      adv_want v1 = dai_effect_value(pplayer, ai, pcity, capital,
-                                     turns, peffect, range, nplayers);
+      adv_want v1;
+
+      if (memo != nullptr && memo->valid[eff_idx]) {
+        v1 = memo->values[eff_idx];
+      } else {
+        v1 = dai_effect_value(pplayer, ai, pcity, capital,
+                              turns, peffect, range, nplayers);
+        if (memo != nullptr) {
+          memo->values[eff_idx] = v1;
+          memo->valid[eff_idx] = TRUE;
+        }
+      }
       /* v1 could be negative (the effect could be undesirable),
        * although it is usually positive.
        * For example, in the default ruleset, Communism decreases the
@@ -1789,11 +1868,12 @@ static void adjust_improvement_wants_by_effects(struct ai_type *ait,
         const adv_want dv = v1 * a / (4 * n_needed_techs);
 
         want_techs_for_improvement_effect(ait, pplayer, pcity, pimprove,
-                                          &needed_techs, dv);
+                                          &needed_techs, dv, tech_wants);
       }
     }
 
     tech_vector_free(&needed_techs);
+    eff_idx++;
   } effect_list_iterate_end;
 
   /* Can the city be the target of an action? */
@@ -1882,13 +1962,15 @@ static void adjust_improvement_wants_by_effects(struct ai_type *ait,
     /* Discourage research of the technology that would make this building
      * obsolete. The bigger the desire for this building, the more
      * we want to discourage the technology. */
-    dont_want_tech_obsoleting_impr(ait, pplayer, pcity, pimprove, v);
+    dont_want_tech_obsoleting_impr(ait, pplayer, pcity, pimprove, v,
+                                   tech_wants);
   } else {
     /* Increase the want for technologies that will enable
      * construction of this improvement, if necessary.
      */
     const bool all_met
-      = adjust_wants_for_reqs(ait, pplayer, pcity, pimprove, v);
+      = adjust_wants_for_reqs(ait, pplayer, pcity, pimprove, v,
+                              tech_wants);
 
     can_build = can_build && all_met;
   }
@@ -1972,15 +2054,134 @@ void dai_build_adv_init(struct ai_type *ait, struct player *pplayer)
   } city_list_iterate_end;
 }
 
+/* Per-city job of the parallel building want evaluation. Workers only
+ * write to their own city's building_want array and to the job-local
+ * tech want buffer, which is merged in city list order afterwards. */
+struct build_adv_job {
+  struct ai_type *ait;
+  struct player *pplayer;
+  struct city *pcity;
+  struct city *wonder_city;
+  const bool *evaluable;              /* Indexed by improvement_index() */
+  adv_want *base_wants;               /* Indexed by improvement_index() */
+  adv_want tech_wants[A_LAST + 1];
+};
+
+/* Job queue shared by the worker threads. */
+struct build_adv_queue {
+  struct build_adv_job *jobs;
+  int njobs;
+  int next;
+  fc_mutex mutex;
+};
+
+/**********************************************************************//**
+  Evaluate the building wants of one city, from the base wants measured
+  in the serial pass. Safe to run on a worker thread: only reads game
+  state (through the frozen effect and requirement caches) and writes
+  nothing but the city's own building_want array and the job-local tech
+  want buffer.
+**************************************************************************/
+static void build_adv_evaluate_city(struct build_adv_job *job)
+{
+  struct city *pcity = job->pcity;
+  struct player *pplayer = job->pplayer;
+  struct ai_type *ait = job->ait;
+
+  improvement_iterate(pimprove) {
+    int idx = improvement_index(pimprove);
+    bool already;
+
+    if (!job->evaluable[idx]) {
+      continue;
+    }
+    if (pcity != job->wonder_city && is_wonder(pimprove)) {
+      /* Only wonder city should build wonders; the want was zeroed
+       * in the serial pass. */
+      continue;
+    }
+
+    /* Building wants vary relatively slowly, so not worthwhile
+     * recalculating them every turn.
+     * We DO want to calculate (tech) wants because of buildings
+     * we already have. */
+    already = city_has_building(pcity, pimprove);
+
+    adjust_improvement_wants_by_effects(ait, pplayer, pcity, pimprove,
+                                        already, job->base_wants[idx],
+                                        job->tech_wants);
+
+    fc_assert(!(already
+                && 0 < pcity->server.adv->building_want[idx]));
+
+    if (is_great_wonder(pimprove)) {
+      /* Not only would we get the wonder, but we would also prevent
+       * opponents from getting it. */
+      pcity->server.adv->building_want[idx] *= 1.5;
+
+      if (pcity->production.kind == VUT_IMPROVEMENT
+          && is_great_wonder(pcity->production.value.building)) {
+        /* If we already are building a great wonder, prefer continuing
+         * to do so over stopping it */
+        pcity->server.adv->building_want[idx] *= 1.25;
+      }
+    }
+
+    /* If I am not an expansionist, I want buildings more than units */
+    if (pcity->server.adv->building_want[idx] > 0) {
+      pcity->server.adv->building_want[idx]
+        = pcity->server.adv->building_want[idx]
+            * TRAIT_DEFAULT_VALUE
+            / ai_trait_get_value(TRAIT_EXPANSIONIST, pplayer);
+    }
+  } improvement_iterate_end;
+}
+
+/**********************************************************************//**
+  Worker of the parallel building want evaluation; pull cities off the
+  shared queue until it is empty.
+**************************************************************************/
+static void build_adv_thread(void *arg)
+{
+  struct build_adv_queue *queue = arg;
+
+  for (;;) {
+    int idx;
+
+    fc_mutex_allocate(&queue->mutex);
+    idx = queue->next++;
+    fc_mutex_release(&queue->mutex);
+
+    if (idx >= queue->njobs) {
+      return;
+    }
+
+    build_adv_evaluate_city(&queue->jobs[idx]);
+  }
+}
+
 /**********************************************************************//**
   Calculate how much an AI player should want to build particular
   improvements, because of the effects of those improvements, and
   increase the want for technologies that will enable buildings with
   desirable effects.
+
+  The evaluation of the cities that recalculate this turn runs on
+  worker threads; see build_adv_evaluate_city() for what keeps that
+  safe. The base wants are measured serially beforehand, because
+  base_want() temporarily modifies the city it measures.
 **************************************************************************/
 void dai_build_adv_adjust(struct ai_type *ait, struct player *pplayer,
                           struct city *wonder_city)
 {
+  struct adv_data *adv = adv_data_get(pplayer, nullptr);
+  struct ai_plr *plr_data = def_ai_player_data(pplayer, ait);
+  bool evaluable[B_LAST];
+  struct build_adv_job *jobs;
+  int njobs = 0;
+  int nthreads;
+  int i;
+
   /* Clear old building wants.
    * Do this separately from the iteration over improvement types
    * because each iteration could actually update more than one improvement,
@@ -2006,59 +2207,124 @@ void dai_build_adv_adjust(struct ai_type *ait, struct player *pplayer,
     }
   } city_list_iterate_end;
 
+  /* Decide once which improvements are worth evaluating at all, and
+   * apply the rules that zero wants wholesale. */
   improvement_iterate(pimprove) {
-    if (can_player_build_improvement_later(pplayer, pimprove)) {
-      city_list_iterate(pplayer->cities, pcity) {
-        struct ai_city *city_data = def_ai_city_data(pcity, ait);
-
-        if (pcity != wonder_city && is_wonder(pimprove)) {
-          /* Only wonder city should build wonders! */
-          pcity->server.adv->building_want[improvement_index(pimprove)] = 0;
-        } else if (city_data->building_turn <= game.info.turn) {
-          /* Building wants vary relatively slowly, so not worthwhile
-           * recalculating them every turn.
-           * We DO want to calculate (tech) wants because of buildings
-           * we already have. */
-          const bool already = city_has_building(pcity, pimprove);
-          int idx = improvement_index(pimprove);
-
-          adjust_improvement_wants_by_effects(ait, pplayer, pcity,
-                                              pimprove, already);
-
-          fc_assert(!(already
-                      && 0 < pcity->server.adv->building_want[idx]));
-
-          if (is_great_wonder(pimprove)) {
-            /* Not only would we get the wonder, but we would also prevent
-             * opponents from getting it. */
-            pcity->server.adv->building_want[idx] *= 1.5;
-
-            if (pcity->production.kind == VUT_IMPROVEMENT
-                && is_great_wonder(pcity->production.value.building)) {
-              /* If we already are building a great wonder, prefer continuing
-               * to do so over stopping it */
-              pcity->server.adv->building_want[idx] *= 1.25;
-            }
-          }
+    int idx = improvement_index(pimprove);
 
-          /* If I am not an expansionist, I want buildings more than units */
-          if (pcity->server.adv->building_want[idx] > 0) {
-            pcity->server.adv->building_want[idx]
-              = pcity->server.adv->building_want[idx]
-                  * TRAIT_DEFAULT_VALUE
-                  / ai_trait_get_value(TRAIT_EXPANSIONIST, pplayer);
-          }
-        }
-        /* else wait until a later turn */
-      } city_list_iterate_end;
-    } else {
+    evaluable[idx] = can_player_build_improvement_later(pplayer, pimprove);
+
+    if (!evaluable[idx]) {
       /* An impossible improvement */
       city_list_iterate(pplayer->cities, pcity) {
-        pcity->server.adv->building_want[improvement_index(pimprove)] = 0;
+        pcity->server.adv->building_want[idx] = 0;
+      } city_list_iterate_end;
+    } else if (is_wonder(pimprove)) {
+      /* Only wonder city should build wonders! */
+      city_list_iterate(pplayer->cities, pcity) {
+        if (pcity != wonder_city) {
+          pcity->server.adv->building_want[idx] = 0;
+        }
       } city_list_iterate_end;
     }
   } improvement_iterate_end;
 
+  /* Collect the cities that recalculate this turn; the others wait
+   * until a later turn. */
+  jobs = fc_calloc(city_list_size(pplayer->cities), sizeof(*jobs));
+  city_list_iterate(pplayer->cities, pcity) {
+    if (def_ai_city_data(pcity, ait)->building_turn <= game.info.turn) {
+      struct build_adv_job *job = &jobs[njobs++];
+
+      job->ait = ait;
+      job->pplayer = pplayer;
+      job->pcity = pcity;
+      job->wonder_city = wonder_city;
+      job->evaluable = evaluable;
+      job->base_wants = fc_calloc(B_LAST, sizeof(*job->base_wants));
+    }
+  } city_list_iterate_end;
+
+  /* Measure the base wants serially: base_want() temporarily adds the
+   * improvement to the city, which the workers must never see. */
+  for (i = 0; i < njobs; i++) {
+    struct city *pcity = jobs[i].pcity;
+
+    improvement_iterate(pimprove) {
+      int idx = improvement_index(pimprove);
+
+      if (!evaluable[idx]
+          || is_convert_improvement(pimprove)
+          || (pcity != wonder_city && is_wonder(pimprove))) {
+        continue;
+      }
+      jobs[i].base_wants[idx] = base_want(ait, pplayer, pcity, pimprove);
+      if (jobs[i].base_wants[idx] != 0) {
+        CITY_LOG(LOG_DEBUG, pcity,
+                 "%s base_want is " ADV_WANT_PRINTF " (range=%d)",
+                 improvement_rule_name(pimprove),
+                 jobs[i].base_wants[idx],
+                 adv->impr_range[idx]);
+      }
+    } improvement_iterate_end;
+  }
+
+  nthreads = MIN(fc_thread_count(), njobs);
+  if (nthreads > 1) {
+    fc_thread *threads;
+    struct build_adv_queue queue;
+    int started = 0;
+
+    /* The workers must not write to the shared evaluation caches. */
+    effect_cache_freeze(TRUE);
+    requirement_memo_freeze(TRUE);
+    city_tile_output_cache_freeze(TRUE);
+    combat_cache_freeze(TRUE);
+
+    queue.jobs = jobs;
+    queue.njobs = njobs;
+    queue.next = 0;
+    fc_mutex_init(&queue.mutex);
+
+    threads = fc_calloc(nthreads, sizeof(*threads));
+    for (i = 0; i < nthreads; i++) {
+      if (fc_thread_start(&threads[started], build_adv_thread,
+                          &queue) == 0) {
+        started++;
+      }
+    }
+    if (started == 0) {
+      /* Could not get any workers after all */
+      build_adv_thread(&queue);
+    }
+    for (i = 0; i < started; i++) {
+      fc_thread_wait(&threads[i]);
+    }
+    free(threads);
+    fc_mutex_destroy(&queue.mutex);
+
+    combat_cache_freeze(FALSE);
+    city_tile_output_cache_freeze(FALSE);
+    requirement_memo_freeze(FALSE);
+    effect_cache_freeze(FALSE);
+  } else {
+    for (i = 0; i < njobs; i++) {
+      build_adv_evaluate_city(&jobs[i]);
+    }
+  }
+
+  /* Merge the job-local tech wants in city list order, so that the
+   * result does not depend on how the jobs were scheduled. */
+  for (i = 0; i < njobs; i++) {
+    int k;
+
+    for (k = 0; k < A_LAST + 1; k++) {
+      plr_data->tech_want[k] += jobs[i].tech_wants[k];
+    }
+    free(jobs[i].base_wants);
+  }
+  free(jobs);
+
 #ifdef FREECIV_DEBUG
   /* This logging is relatively expensive, so activate only if necessary */
   city_list_iterate(pplayer->cities, pcity) {
@@ -25,6 +25,15 @@ struct tech_vector;
 
 struct ai_activity_cache; /* Defined and only used within daicity.c */
 
+/* Memo of dai_effect_value() results for one improvement in one city.
+ * The values are laid out in the improvement's effect list order. */
+struct dai_effect_memo {
+  int gen;          /* City state generation the values were computed at */
+  int n_values;
+  adv_want *values;
+  bool *valid;      /* Whether the effect's value was actually computed */
+};
+
 /* Who's coming to kill us, for attack co-ordination */
 struct ai_invasion {
   int attack;         /* Units capable of attacking city */
@@ -58,6 +67,27 @@ struct ai_city {
   bool diplomat_threat;         /* Enemy diplomat or spy is near the city */
   bool has_diplomat;            /* This city has diplomat or spy defender */
 
+  /* Incremental danger assessment. When 'danger_reduced' is set and
+   * 'danger_stale' is clear, assess_danger() reuses the cached danger
+   * values above instead of rescanning the enemy unit lists; unit and
+   * city events near the city set the stale flag again. */
+  bool danger_stale;
+  unsigned int *danger_reduced; /* [B_LAST] danger each building would
+                                 * reduce, kept for reapplying the
+                                 * building wants */
+
+  /* Memoized dai_effect_value() results of the improvement evaluation,
+   * indexed by improvement_index(); lazily allocated. The entries stay
+   * valid across turns until the city's state generation counter
+   * (pcity->server.state_gen) is bumped by a relevant change. */
+  struct dai_effect_memo **effect_memo; /* [B_LAST] */
+
+  /* Cached city_gold_worth() of this city for treaty evaluation, reused
+   * while the turn and the city's state generation are unchanged. */
+  int gold_worth;
+  int gold_worth_turn;          /* -1 when never computed */
+  int gold_worth_gen;
+
   /* These values are for builder (UTYF_WORKERS) and founder (UTYF_CITIES) units.
    * Negative values indicate that the city needs a boat first;
    * -value is the degree of want in that case. */
@@ -86,13 +116,15 @@ void want_techs_for_improvement_effect(struct ai_type *ait,
                                        const struct city *pcity,
                                        const struct impr_type *pimprove,
                                        struct tech_vector *needed_techs,
-                                       adv_want building_want);
+                                       adv_want building_want,
+                                       adv_want *tech_wants);
 
 void dont_want_tech_obsoleting_impr(struct ai_type *ait,
                                     struct player *pplayer,
                                     const struct city *pcity,
                                     const struct impr_type *pimprove,
-                                    adv_want building_want);
+                                    adv_want building_want,
+                                    adv_want *tech_wants);
 
 void dai_build_adv_init(struct ai_type *ait, struct player *pplayer);
 void dai_build_adv_adjust(struct ai_type *ait, struct player *pplayer,
@@ -37,6 +37,7 @@
 #include "daidiplomacy.h"
 #include "daieffects.h"
 #include "daiferry.h"
+#include "daihunter.h"
 #include "daiplayer.h"
 #include "daisettler.h"
 #include "daiunit.h"
@@ -93,6 +94,13 @@ void dai_data_init(struct ai_type *ait, struct player *pplayer)
   ai->diplomacy.req_love_for_alliance = MAX_AI_LOVE / 4;
 
   ai->settler = NULL;
+  ai->hunter_targets = NULL;
+
+  ai->stats.workers = NULL;
+  ai->stats.ocean_workers = NULL;
+  ai->stats.workers_size = 0;
+  ai->stats.ocean_workers_size = 0;
+  ai->stats.workers_counted = FALSE;
 
   /* Initialise autoworker. */
   dai_auto_settler_init(ai);
@@ -109,6 +117,16 @@ void dai_data_close(struct ai_type *ait, struct player *pplayer)
    * open/finish cycle */
   dai_data_phase_finished(ait, pplayer);
 
+  /* The worker statistics survive across phases; free them here. */
+  if (ai->stats.workers != NULL) {
+    free(ai->stats.workers);
+    ai->stats.workers = NULL;
+  }
+  if (ai->stats.ocean_workers != NULL) {
+    free(ai->stats.ocean_workers);
+    ai->stats.ocean_workers = NULL;
+  }
+
   /* Free autoworker. */
   dai_auto_settler_free(ai);
 
@@ -136,6 +154,172 @@ bool is_ai_data_phase_open(struct ai_type *ait, struct player *pplayer)
   return ai->phase_initialized;
 }
 
+/************************************************************************//**
+  Recount the per-continent worker statistics from scratch and stamp every
+  unit with the continent it got counted on, so that the dai_stats_*()
+  lifecycle hooks can keep the counts up to date afterwards.
+****************************************************************************/
+static void dai_stats_workers_recount(struct ai_type *ait,
+                                      struct player *pplayer,
+                                      const struct adv_data *adv)
+{
+  struct ai_plr *ai = def_ai_player_data(pplayer, ait);
+
+  if (ai->stats.workers != NULL) {
+    free(ai->stats.workers);
+  }
+  if (ai->stats.ocean_workers != NULL) {
+    free(ai->stats.ocean_workers);
+  }
+  ai->stats.workers = fc_calloc(adv->num_continents + 1, sizeof(int));
+  ai->stats.ocean_workers = fc_calloc(adv->num_oceans + 1, sizeof(int));
+  ai->stats.workers_size = adv->num_continents + 1;
+  ai->stats.ocean_workers_size = adv->num_oceans + 1;
+
+  unit_list_iterate(pplayer->units, punit) {
+    struct tile *ptile = unit_tile(punit);
+    struct unit_ai *unit_data = def_ai_unit_data(punit, ait);
+
+    unit_data->counted_cont = 0;
+
+    if (unit_has_type_flag(punit, UTYF_WORKERS)) {
+      Continent_id cont = tile_continent(ptile);
+
+      if (is_ocean_tile(ptile)) {
+        if (cont <= 0 && -cont <= adv->num_oceans) {
+          ai->stats.ocean_workers[(int)-cont]++;
+          unit_data->counted_cont = cont;
+        } else {
+          /* Always fails */
+          fc_assert(cont <= 0 && -cont <= adv->num_oceans);
+        }
+      } else {
+        if (cont >= 0 && cont <= adv->num_continents) {
+          ai->stats.workers[(int)cont]++;
+          unit_data->counted_cont = cont;
+        } else {
+          /* Always fails */
+          fc_assert(cont >= 0 && cont <= adv->num_continents);
+        }
+      }
+    }
+  } unit_list_iterate_end;
+
+  ai->stats.workers_counted = TRUE;
+}
+
+/************************************************************************//**
+  Subtract the unit from the worker statistics it was counted in.
+****************************************************************************/
+static void dai_stats_worker_remove(struct ai_type *ait, struct unit *punit)
+{
+  struct ai_plr *ai = def_ai_player_data(unit_owner(punit), ait);
+  struct unit_ai *unit_data = def_ai_unit_data(punit, ait);
+  Continent_id cont;
+
+  if (ai == NULL || unit_data == NULL) {
+    return;
+  }
+
+  cont = unit_data->counted_cont;
+  unit_data->counted_cont = 0;
+
+  if (!ai->stats.workers_counted || cont == 0) {
+    return;
+  }
+
+  if (cont > 0) {
+    if (cont < ai->stats.workers_size) {
+      ai->stats.workers[(int)cont]--;
+    }
+  } else if (-cont < ai->stats.ocean_workers_size) {
+    ai->stats.ocean_workers[(int)-cont]--;
+  }
+}
+
+/************************************************************************//**
+  Add the unit to the worker statistics of its owner, remembering the
+  continent it got counted on.
+****************************************************************************/
+static void dai_stats_worker_add(struct ai_type *ait, struct unit *punit)
+{
+  struct ai_plr *ai = def_ai_player_data(unit_owner(punit), ait);
+  struct unit_ai *unit_data = def_ai_unit_data(punit, ait);
+  struct tile *ptile = unit_tile(punit);
+  Continent_id cont;
+
+  if (ai == NULL || unit_data == NULL || !ai->stats.workers_counted
+      || ptile == NULL || !unit_has_type_flag(punit, UTYF_WORKERS)) {
+    return;
+  }
+
+  cont = tile_continent(ptile);
+
+  if (is_ocean_tile(ptile)) {
+    if (cont < 0 && -cont < ai->stats.ocean_workers_size) {
+      ai->stats.ocean_workers[(int)-cont]++;
+      unit_data->counted_cont = cont;
+    } else if (cont != 0) {
+      /* An ocean the counters do not cover yet; recount at phase begin. */
+      ai->stats.workers_counted = FALSE;
+    }
+  } else {
+    if (cont > 0 && cont < ai->stats.workers_size) {
+      ai->stats.workers[(int)cont]++;
+      unit_data->counted_cont = cont;
+    } else if (cont != 0) {
+      /* A continent the counters do not cover yet; recount at phase
+       * begin. */
+      ai->stats.workers_counted = FALSE;
+    }
+  }
+}
+
+/************************************************************************//**
+  Unit lifecycle hook: a unit entered play. O(1) bookkeeping keeping
+  dai_data_phase_begin() from having to rescan all units.
+****************************************************************************/
+void dai_stats_unit_created(struct ai_type *ait, struct unit *punit)
+{
+  dai_stats_worker_add(ait, punit);
+}
+
+/************************************************************************//**
+  Unit lifecycle hook: a unit is leaving play.
+****************************************************************************/
+void dai_stats_unit_destroyed(struct ai_type *ait, struct unit *punit)
+{
+  dai_stats_worker_remove(ait, punit);
+}
+
+/************************************************************************//**
+  Unit lifecycle hook: a unit moved; move it between the per-continent
+  counters when it switched continents.
+****************************************************************************/
+void dai_stats_unit_moved(struct ai_type *ait, struct unit *punit)
+{
+  struct unit_ai *unit_data = def_ai_unit_data(punit, ait);
+  struct tile *ptile = unit_tile(punit);
+
+  if (unit_data == NULL || ptile == NULL
+      || unit_data->counted_cont == tile_continent(ptile)) {
+    return;
+  }
+
+  dai_stats_worker_remove(ait, punit);
+  dai_stats_worker_add(ait, punit);
+}
+
+/************************************************************************//**
+  Unit lifecycle hook: a unit changed in some way (possibly converted to
+  another type); resynchronize its statistics entry.
+****************************************************************************/
+void dai_stats_unit_changed(struct ai_type *ait, struct unit *punit)
+{
+  dai_stats_worker_remove(ait, punit);
+  dai_stats_worker_add(ait, punit);
+}
+
 /************************************************************************//**
   Make and cache lots of calculations needed for other functions.
 ****************************************************************************/
@@ -157,6 +341,7 @@ void dai_data_phase_begin(struct ai_type *ait, struct player *pplayer,
   }
 
   ai->phase_initialized = TRUE;
+  ai->fstk_data_built = FALSE;
 
   adv = adv_data_get(pplayer, &caller_closes);
 
@@ -203,31 +388,14 @@ void dai_data_phase_begin(struct ai_type *ait, struct player *pplayer,
 
   /*** Statistics ***/
 
-  ai->stats.workers = fc_calloc(adv->num_continents + 1, sizeof(int));
-  ai->stats.ocean_workers = fc_calloc(adv->num_oceans + 1, sizeof(int));
-  unit_list_iterate(pplayer->units, punit) {
-    struct tile *ptile = unit_tile(punit);
-
-    if (unit_has_type_flag(punit, UTYF_WORKERS)) {
-      Continent_id cont = tile_continent(ptile);
-
-      if (is_ocean_tile(ptile)) {
-        if (cont <= 0 && -cont <= adv->num_oceans) {
-          ai->stats.ocean_workers[(int)-cont]++;
-        } else {
-          /* Always fails */
-          fc_assert(cont <= 0 && -cont <= adv->num_oceans);
-        }
-      } else {
-        if (cont >= 0 && cont <= adv->num_continents) {
-          ai->stats.workers[(int)cont]++;
-        } else {
-          /* Always fails */
-          fc_assert(cont >= 0 && cont <= adv->num_continents);
-        }
-      }
-    }
-  } unit_list_iterate_end;
+  /* The worker counts are maintained incrementally by the dai_stats_*()
+   * unit lifecycle hooks; recount only when they have not been counted
+   * yet or the continents were renumbered under them. */
+  if (!ai->stats.workers_counted
+      || ai->stats.workers_size != adv->num_continents + 1
+      || ai->stats.ocean_workers_size != adv->num_oceans + 1) {
+    dai_stats_workers_recount(ait, pplayer, adv);
+  }
 
   BV_CLR_ALL(ai->stats.diplomat_reservations);
   unit_list_iterate(pplayer->units, punit) {
@@ -248,6 +416,9 @@ void dai_data_phase_begin(struct ai_type *ait, struct player *pplayer,
   } unit_list_iterate_end;
 
   aiferry_init_stats(ait, pplayer);
+  if (is_ai(pplayer) && is_new_phase) {
+    aiferry_match_boats(ait, pplayer);
+  }
 
   /*** Interception engine ***/
 
@@ -290,11 +461,7 @@ void dai_data_phase_finished(struct ai_type *ait, struct player *pplayer)
     return;
   }
 
-  free(ai->stats.workers);
-  ai->stats.workers = NULL;
-
-  free(ai->stats.ocean_workers);
-  ai->stats.ocean_workers = NULL;
+  dai_hunter_targets_free(ait, pplayer);
 
   ai->phase_initialized = FALSE;
 }
@@ -430,7 +597,12 @@ static void dai_diplomacy_destroy(struct ai_type *ait,
       + player_index(plr2);
 
   if (*player_intel_slot != NULL) {
-    free(dai_diplomacy_get(ait, plr1, plr2));
+    struct ai_dip_intel *player_intel = dai_diplomacy_get(ait, plr1, plr2);
+
+    if (player_intel->tech_prices != NULL) {
+      free(player_intel->tech_prices);
+    }
+    free(player_intel);
   }
 
   *player_intel_slot = NULL;
@@ -50,6 +50,19 @@ enum winning_strategy {
 #define SPECENUM_VALUE5NAME "None"
 #include "specenum_gen.h"
 
+/* Cached tech valuation between a giver/taker pair, computed by
+ * compute_tech_sell_price() in daidiplomacy.c. An entry is reused while
+ * the turn, the taker's research progress and the diplomatic state it
+ * was computed under are unchanged. */
+struct dai_tech_price {
+  bool valid;
+  int worth;
+  bool is_dangerous;
+  unsigned char ds;       /* enum diplstate_type at compute time */
+  int turn;               /* Turn the price was computed */
+  int taker_techs;        /* Taker's techs_researched at compute time */
+};
+
 struct ai_dip_intel {
   /* Remember one example of each for text spam purposes. */
   struct player *is_allied_with_enemy;
@@ -65,6 +78,10 @@ struct ai_dip_intel {
   signed char asked_about_alliance;  /* don't nag! */
   signed char asked_about_ceasefire; /* don't ... you get the point */
   signed char warned_about_space;
+
+  /* Per-tech sell prices with the second player of the pair as taker,
+   * indexed by tech id; lazily allocated by compute_tech_sell_price() */
+  struct dai_tech_price *tech_prices;
 };
 
 struct ai_plr
@@ -81,6 +98,13 @@ struct ai_plr
 
     int *workers;     /* Cities to workers on continent */
     int *ocean_workers;
+    int workers_size;       /* Size the arrays above were allocated with */
+    int ocean_workers_size;
+
+    /* Whether the worker counts above are being maintained incrementally
+     * from the unit lifecycle hooks. When FALSE, the next phase begin
+     * recounts them from scratch. */
+    bool workers_counted;
 
     bv_id diplomat_reservations;
   } stats;
@@ -100,6 +124,23 @@ struct ai_plr
   /* Cache map for AI settlers; defined in daisettler.c. */
   struct ai_settler *settler;
 
+  /* Per-phase index of enemy units worth considering as hunter targets;
+   * built on first use and dropped when the phase finishes. Defined in
+   * daihunter.c. */
+  struct hunter_targets *hunter_targets;
+
+  /* Whether the shared military target data (reinforcement strength and
+   * invasion pressure around enemy cities) has been built this phase;
+   * defined in daiunit.c. */
+  bool fstk_data_built;
+
+  /* Inputs of the danger assessment that invalidate every city's cached
+   * assessment when they change: the diplomatic states towards the other
+   * players and our government, which changes the defense effects.
+   * Checked by dai_assess_danger_player(). */
+  unsigned char danger_diplstates[MAX_NUM_PLAYER_SLOTS];
+  struct government *danger_govt;
+
   /* The units of tech_want seem to be shields */
   adv_want tech_want[A_LAST+1];
 };
@@ -110,6 +151,11 @@ void dai_data_close(struct ai_type *ait, struct player *pplayer);
 void dai_data_phase_begin(struct ai_type *ait, struct player *pplayer,
                           bool is_new_phase);
 void dai_data_phase_finished(struct ai_type *ait, struct player *pplayer);
+
+void dai_stats_unit_created(struct ai_type *ait, struct unit *punit);
+void dai_stats_unit_destroyed(struct ai_type *ait, struct unit *punit);
+void dai_stats_unit_moved(struct ai_type *ait, struct unit *punit);
+void dai_stats_unit_changed(struct ai_type *ait, struct unit *punit);
 bool is_ai_data_phase_open(struct ai_type *ait, struct player *pplayer);
 
 struct ai_plr *dai_plr_data_get(struct ai_type *ait, struct player *pplayer,
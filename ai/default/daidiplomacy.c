@@ -31,6 +31,7 @@
 #include "city.h"
 #include "diptreaty.h"
 #include "events.h"
+#include "forkstate.h"
 #include "game.h"
 #include "packets.h"
 #include "player.h"
@@ -222,54 +223,106 @@ static bool dai_players_can_agree_on_ceasefire(struct ai_type *ait,
   This eases tech exchange.
   is_dangerous returns ig the giver is afraid of giving that tech
   (the taker should evaluate it normally, but giver should never give that)
+  The price is cached between the repeated clause evaluations of a
+  negotiation; an entry is dropped when the turn, the taker's research
+  progress or the pair's diplomatic state changes.
 **********************************************************************/
 static int compute_tech_sell_price(struct ai_type *ait,
                                    struct player *giver, struct player *taker,
                                    int tech_id, bool *is_dangerous)
 {
   int worth;
+  struct ai_dip_intel *adip = dai_diplomacy_get(ait, giver, taker);
+  struct dai_tech_price *price = nullptr;
+
+  if (adip != nullptr && tech_id >= 0 && tech_id < A_LAST + 1) {
+    if (adip->tech_prices == nullptr) {
+      adip->tech_prices = fc_calloc(A_LAST + 1,
+                                    sizeof(*adip->tech_prices));
+    }
+    price = &adip->tech_prices[tech_id];
+    if (price->valid
+        && price->turn == game.info.turn
+        && price->taker_techs == research_get(taker)->techs_researched
+        && price->ds == player_diplstate_get(giver, taker)->type) {
+      *is_dangerous = price->is_dangerous;
+      return price->worth;
+    }
+  }
 
   worth = dai_goldequiv_tech(ait, taker, tech_id);
 
   *is_dangerous = FALSE;
 
-  /* Share and expect being shared brotherly between allies */
-  if (pplayers_allied(giver, taker)) {
-    worth /= 2;
-  }
-  if (players_on_same_team(giver, taker)) {
-    return 0;
+  if (players_on_same_team(giver, taker)
+      || research_invention_state(research_get(taker), tech_id)
+         == TECH_KNOWN) {
+    /* Do not bother wanting a tech that we already have. */
+    worth = 0;
+  } else {
+    /* Share and expect being shared brotherly between allies */
+    if (pplayers_allied(giver, taker)) {
+      worth /= 2;
+    }
+
+    /* Calculate in tech leak to our opponents, guess 50% chance */
+    players_iterate_alive(eplayer) {
+      if (eplayer == giver
+          || eplayer == taker
+          || research_invention_state(research_get(eplayer),
+                                      tech_id) == TECH_KNOWN) {
+        continue;
+      }
+
+      /* Don't risk it falling into enemy hands */
+      if (pplayers_allied(taker, eplayer)
+          && adv_is_player_dangerous(giver, eplayer)) {
+        *is_dangerous = TRUE;
+      }
+
+      if (pplayers_allied(taker, eplayer)
+          && !pplayers_allied(giver, eplayer)) {
+        /* Taker can enrich their side with this tech */
+        worth += dai_goldequiv_tech(ait, eplayer, tech_id) / 4;
+      }
+    } players_iterate_alive_end;
   }
 
-  /* Do not bother wanting a tech that we already have. */
-  if (research_invention_state(research_get(taker), tech_id)
-      == TECH_KNOWN) {
-    return 0;
+  if (price != nullptr) {
+    price->valid = TRUE;
+    price->worth = worth;
+    price->is_dangerous = *is_dangerous;
+    price->ds = player_diplstate_get(giver, taker)->type;
+    price->turn = game.info.turn;
+    price->taker_techs = research_get(taker)->techs_researched;
   }
 
-  /* Calculate in tech leak to our opponents, guess 50% chance */
-  players_iterate_alive(eplayer) {
-    if (eplayer == giver
-        || eplayer == taker
-        || research_invention_state(research_get(eplayer),
-                                    tech_id) == TECH_KNOWN) {
-      continue;
-    }
+  return worth;
+}
 
-    /* Don't risk it falling into enemy hands */
-    if (pplayers_allied(taker, eplayer)
-        && adv_is_player_dangerous(giver, eplayer)) {
-      *is_dangerous = TRUE;
-    }
+/******************************************************************//**
+  city_gold_worth() of a city, cached between the repeated clause
+  evaluations of a negotiation. The cached worth is reused while the
+  turn and the city's state generation are unchanged.
+**********************************************************************/
+static int dai_city_gold_worth(struct ai_type *ait,
+                               const struct civ_map *nmap,
+                               struct city *pcity)
+{
+  struct ai_city *city_data = def_ai_city_data(pcity, ait);
 
-    if (pplayers_allied(taker, eplayer)
-        && !pplayers_allied(giver, eplayer)) {
-      /* Taker can enrich their side with this tech */
-      worth += dai_goldequiv_tech(ait, eplayer, tech_id) / 4;
-    }
-  } players_iterate_alive_end;
+  if (city_data == nullptr) {
+    return city_gold_worth(nmap, pcity);
+  }
 
-  return worth;
+  if (city_data->gold_worth_turn != game.info.turn
+      || city_data->gold_worth_gen != pcity->server.state_gen) {
+    city_data->gold_worth = city_gold_worth(nmap, pcity);
+    city_data->gold_worth_turn = game.info.turn;
+    city_data->gold_worth_gen = pcity->server.state_gen;
+  }
+
+  return city_data->gold_worth;
 }
 
 /******************************************************************//**
@@ -541,7 +594,7 @@ static int dai_goldequiv_clause(struct ai_type *ait,
                 "city destroyed during negotiations");
     } else if (give) {
       /* AI must be crazy to trade away its cities */
-      worth -= city_gold_worth(nmap, offer);
+      worth -= dai_city_gold_worth(ait, nmap, offer);
       if (is_capital(offer)) {
         worth = -BIG_NUMBER; /* Never! Ever! */
       } else {
@@ -552,7 +605,7 @@ static int dai_goldequiv_clause(struct ai_type *ait,
         worth /= 2;
       }
     } else {
-      worth = city_gold_worth(nmap, offer);
+      worth = dai_city_gold_worth(ait, nmap, offer);
     }
     if (offer != nullptr) {
       DIPLO_LOG(ait, LOG_DEBUG, pplayer, aplayer, "worth of %s is %d",
@@ -1424,20 +1477,24 @@ static void dai_go_to_war(struct ai_type *ait, struct player *pplayer,
 
   /* Check for Senate obstruction. If so, dissolve it. */
   if (pplayer_can_cancel_treaty(pplayer, target) == DIPL_SENATE_BLOCKING) {
-    struct government *real_gov = pplayer->government;
+    struct fork_state *fork = fork_state_begin();
+    bool revolution_helps;
 
+    fork_state_save(fork, &pplayer->government,
+                    sizeof(pplayer->government));
     pplayer->government = game.government_during_revolution;
+    revolution_helps = (pplayer_can_cancel_treaty(pplayer, target)
+                        == DIPL_OK);
+    fork_state_discard(fork);
 
-    if (pplayer_can_cancel_treaty(pplayer, target) == DIPL_OK) {
+    if (revolution_helps) {
       /* It seems that revolution would help. */
-      pplayer->government = real_gov;
       handle_player_change_government(pplayer,
                                       game.info.government_during_revolution_id);
       def_ai_player_data(pplayer, ait)->diplomacy.war_target = target;
       return;
     } else {
       /* There would be Senate even during revolution. Better not to revolt for nothing */
-      pplayer->government = real_gov;
       adip->countdown = -1; /* War declaration aborted */
 
       DIPLO_LOG(ait, LOG_DEBUG, pplayer, target,
@@ -17,6 +17,7 @@
 
 /* utility */
 #include "log.h"
+#include "mem.h"
 
 /* common */
 #include "game.h"
@@ -71,6 +72,12 @@
 #define FERRY_WANTED       (-1)   /* Needs a boat */
 #define FERRY_NONE         0      /* Has no boat and doesn't need one */
 
+/*
+ * Horizon of the phase-begin boat matching, in turns. Passenger/boat
+ * pairs further apart than this are left for aiferry_find_boat().
+ */
+#define FERRY_MATCH_TURNS  16
+
 
 /* =================== Group log levels, debug options ================= */
 
@@ -527,6 +534,36 @@ int aiferry_find_boat(struct ai_type *ait, struct unit *punit,
     return 0;
   }
 
+  if (0 < ferryboat) {
+    /* The phase-begin matching stage (aiferry_match_boats()) or an earlier
+     * search already dedicated a boat to us. Trust it for as long as it
+     * remains suitable instead of redoing the map-wide search. */
+    struct unit *pferry = game_unit_by_number(ferryboat);
+
+    if (pferry != nullptr && is_boat_free(ait, pferry, punit, cap)) {
+      if (path == nullptr) {
+        return ferryboat;
+      }
+
+      pft_fill_unit_parameter(&param, nmap, punit);
+      param.omniscience = !has_handicap(pplayer, H_MAP);
+      param.get_TB = no_fights_or_unknown;
+      param.get_EC = sea_move;
+      param.get_MC = combined_land_sea_move;
+      param.ignore_none_scopes = FALSE;
+
+      search_map = pf_map_new(&param);
+      *path = pf_map_path(search_map, unit_tile(pferry));
+      pf_map_destroy(search_map);
+
+      if (*path != nullptr) {
+        return ferryboat;
+      }
+      /* The boat sits somewhere we cannot walk to (e.g. a city on another
+       * continent); fall through to the full search. */
+    }
+  }
+
   pft_fill_unit_parameter(&param, nmap, punit);
   param.omniscience = !has_handicap(pplayer, H_MAP);
   param.get_TB = no_fights_or_unknown;
@@ -601,6 +638,163 @@ static int aiferry_find_boat_nearby(struct ai_type *ait, struct unit *punit,
   return 0;
 }
 
+/**********************************************************************//**
+  Pair the player's available boats with the passengers left waiting for
+  one, in a single pass. aiferry_find_boat() reruns its map-wide search
+  every time a passenger is managed, which gets quadratic on archipelago
+  maps with many requesters. Matching once per phase dedicates a boat to
+  each waiting passenger up front, so the later per-unit searches reduce
+  to a single path computation towards the dedicated boat.
+
+  The costs are the rendezvous turn estimates aiferry_find_boat() uses,
+  gathered with one path-finding run per passenger and capped at
+  FERRY_MATCH_TURNS. The assignment is solved greedily, always fixing
+  the cheapest remaining passenger/boat pair.
+**************************************************************************/
+void aiferry_match_boats(struct ai_type *ait, struct player *pplayer)
+{
+  struct unit **boats;
+  struct unit **passengers;
+  int nboats = 0;
+  int npassengers = 0;
+  int *rdv_turns;
+  struct pf_parameter param;
+  struct pf_map *search_map;
+  const struct civ_map *nmap = &(wld.map);
+  int i, j;
+
+  unit_list_iterate(pplayer->units, punit) {
+    struct unit_ai *unit_data = def_ai_unit_data(punit, ait);
+
+    if (dai_is_ferry(punit, ait)
+        && unit_data->passenger == FERRY_AVAILABLE) {
+      nboats++;
+    } else if (unit_data->ferryboat == FERRY_WANTED) {
+      npassengers++;
+    }
+  } unit_list_iterate_end;
+
+  if (nboats == 0 || npassengers == 0) {
+    return;
+  }
+
+  boats = fc_malloc(nboats * sizeof(*boats));
+  passengers = fc_malloc(npassengers * sizeof(*passengers));
+  rdv_turns = fc_malloc(npassengers * nboats * sizeof(*rdv_turns));
+  nboats = 0;
+  npassengers = 0;
+
+  unit_list_iterate(pplayer->units, punit) {
+    struct unit_ai *unit_data = def_ai_unit_data(punit, ait);
+
+    if (dai_is_ferry(punit, ait)
+        && unit_data->passenger == FERRY_AVAILABLE) {
+      boats[nboats++] = punit;
+    } else if (unit_data->ferryboat == FERRY_WANTED) {
+      passengers[npassengers++] = punit;
+    }
+  } unit_list_iterate_end;
+
+  /* Build the cost matrix with one search per passenger. Each search is
+   * the one aiferry_find_boat() runs, except that it records the
+   * rendezvous turns of every free boat it passes instead of stopping at
+   * the first best one. */
+  for (i = 0; i < npassengers; i++) {
+    struct unit *punit = passengers[i];
+    int found = 0;
+
+    for (j = 0; j < nboats; j++) {
+      rdv_turns[i * nboats + j] = FC_INFINITY;
+    }
+
+    pft_fill_unit_parameter(&param, nmap, punit);
+    param.omniscience = !has_handicap(pplayer, H_MAP);
+    param.get_TB = no_fights_or_unknown;
+    param.get_EC = sea_move;
+    param.get_MC = combined_land_sea_move;
+    param.ignore_none_scopes = FALSE;
+
+    search_map = pf_map_new(&param);
+
+    pf_map_positions_iterate(search_map, pos, TRUE) {
+      int radius = (is_ocean_tile(pos.tile) ? 1 : 0);
+
+      if (found >= nboats
+          || pos.turn + pos.total_EC / PF_TURN_FACTOR > FERRY_MATCH_TURNS) {
+        /* All boats located, or the remaining ones are too far away to
+         * promise to this passenger. */
+        break;
+      }
+
+      square_iterate(&(wld.map), pos.tile, radius, ptile) {
+        unit_list_iterate(ptile->units, aunit) {
+          for (j = 0; j < nboats; j++) {
+            if (boats[j] == aunit) {
+              break;
+            }
+          }
+          if (j < nboats && is_boat_free(ait, aunit, punit, 1)) {
+            /* Turns for the unit to get to rendezvous pnt */
+            int u_turns = pos.turn;
+            /* Turns for the boat to get to the rendezvous pnt */
+            int f_turns = ((pos.total_EC / PF_TURN_FACTOR * 16
+                            - aunit->moves_left)
+                           / unit_type_get(aunit)->move_rate);
+            int turns = MAX(u_turns, f_turns);
+
+            if (turns < rdv_turns[i * nboats + j]) {
+              if (rdv_turns[i * nboats + j] == FC_INFINITY) {
+                found++;
+              }
+              rdv_turns[i * nboats + j] = turns;
+            }
+          }
+        } unit_list_iterate_end;
+      } square_iterate_end;
+    } pf_map_positions_iterate_end;
+    pf_map_destroy(search_map);
+  }
+
+  /* Solve the assignment greedily: fix the cheapest remaining pair, then
+   * drop its passenger and its boat from the matrix. */
+  for (;;) {
+    int best_turns = FC_INFINITY;
+    int best_i = -1;
+    int best_j = -1;
+
+    for (i = 0; i < npassengers; i++) {
+      for (j = 0; j < nboats; j++) {
+        if (rdv_turns[i * nboats + j] < best_turns) {
+          best_turns = rdv_turns[i * nboats + j];
+          best_i = i;
+          best_j = j;
+        }
+      }
+    }
+
+    if (best_i < 0) {
+      break;
+    }
+
+    UNIT_LOG(LOGLEVEL_FINDFERRY, passengers[best_i],
+             "matched with boat[%d](%d,%d) at phase begin, %d turns",
+             boats[best_j]->id, TILE_XY(unit_tile(boats[best_j])),
+             best_turns);
+    aiferry_psngr_meet_boat(ait, passengers[best_i], boats[best_j]);
+
+    for (j = 0; j < nboats; j++) {
+      rdv_turns[best_i * nboats + j] = FC_INFINITY;
+    }
+    for (i = 0; i < npassengers; i++) {
+      rdv_turns[i * nboats + best_j] = FC_INFINITY;
+    }
+  }
+
+  free(rdv_turns);
+  free(passengers);
+  free(boats);
+}
+
 
 /* ============================= go by boat ============================== */
 
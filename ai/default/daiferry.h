@@ -36,6 +36,12 @@ void aiferry_init_stats(struct ai_type *ait, struct player *pplayer);
 int aiferry_find_boat(struct ai_type *ait, struct unit *punit,
                       int cap, struct pf_path **path);
 
+/*
+ * Pair available boats with the passengers waiting for one, player-wide.
+ * Run once per phase.
+ */
+void aiferry_match_boats(struct ai_type *ait, struct player *pplayer);
+
 /*
  * How many boats are available
  */
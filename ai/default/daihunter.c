@@ -18,6 +18,7 @@
 /* utility */
 #include "bitvector.h"
 #include "log.h"
+#include "mem.h"
 
 /* common */
 #include "city.h"
@@ -46,6 +47,7 @@
 #include "handicaps.h"
 
 /* ai/default */
+#include "daidata.h"
 #include "daiplayer.h"
 #include "daitools.h"
 #include "daiunit.h"
@@ -296,6 +298,88 @@ bool dai_hunter_qualify(struct player *pplayer, struct unit *punit)
   return FALSE;
 }
 
+/* One candidate in the per-player hunter target index. */
+struct hunter_target {
+  int id;            /* Unit id; the unit may be gone when queried */
+  Continent_id cont; /* Continent the target was indexed on */
+};
+
+struct hunter_targets {
+  int count;
+  struct hunter_target *targets;
+};
+
+/**********************************************************************//**
+  Return the player's index of enemy units worth considering as hunter
+  targets, building it on first use in a phase. Only target properties
+  that do not change within a phase are filtered here - the owner being
+  dangerous to us and the unit type being worth hunting; every hunter
+  rechecks the conditions that depend on itself or move around.
+**************************************************************************/
+static const struct hunter_targets *
+dai_hunter_targets_get(struct ai_type *ait, struct player *pplayer)
+{
+  struct ai_plr *ai = dai_plr_data_get(ait, pplayer, NULL);
+  struct hunter_targets *index;
+  int count = 0;
+
+  if (ai->hunter_targets != NULL) {
+    return ai->hunter_targets;
+  }
+
+  players_iterate_alive(aplayer) {
+    if (aplayer == pplayer
+        || !adv_is_player_dangerous(pplayer, aplayer)) {
+      continue;
+    }
+    count += unit_list_size(aplayer->units);
+  } players_iterate_alive_end;
+
+  index = fc_malloc(sizeof(*index));
+  index->count = 0;
+  index->targets
+    = (count > 0 ? fc_malloc(count * sizeof(index->targets[0])) : NULL);
+
+  players_iterate_alive(aplayer) {
+    if (aplayer == pplayer
+        || !adv_is_player_dangerous(pplayer, aplayer)) {
+      continue;
+    }
+    unit_list_iterate(aplayer->units, target) {
+      if (!utype_acts_hostile(unit_type_get(target))
+          && get_transporter_capacity(target) == 0
+          && !unit_has_type_flag(target, UTYF_GAMELOSS)) {
+        /* Never worth hunting */
+        continue;
+      }
+      index->targets[index->count].id = target->id;
+      index->targets[index->count].cont = tile_continent(unit_tile(target));
+      index->count++;
+    } unit_list_iterate_end;
+  } players_iterate_alive_end;
+
+  ai->hunter_targets = index;
+
+  return index;
+}
+
+/**********************************************************************//**
+  Drop the hunter target index. Called when the player's phase finishes;
+  the index is rebuilt on the first hunt of the next phase.
+**************************************************************************/
+void dai_hunter_targets_free(struct ai_type *ait, struct player *pplayer)
+{
+  struct ai_plr *ai = def_ai_player_data(pplayer, ait);
+
+  if (ai != NULL && ai->hunter_targets != NULL) {
+    if (ai->hunter_targets->targets != NULL) {
+      free(ai->hunter_targets->targets);
+    }
+    free(ai->hunter_targets);
+    ai->hunter_targets = NULL;
+  }
+}
+
 /**********************************************************************//**
   Try to shoot our target with a missile. Also shoot down anything that
   might attempt to intercept _us_. We assign missiles to a hunter in
@@ -444,6 +528,12 @@ int dai_hunter_manage(struct ai_type *ait, struct player *pplayer,
   struct unit *original_target = game_unit_by_number(unit_data->target);
   unsigned original_threat = 0, original_cost = 0;
   struct civ_map *nmap = &(wld.map);
+  const struct hunter_targets *candidates;
+  struct unit *best_target = NULL;
+  unsigned best_threat = 0;
+  int best_dist1 = 0, best_dist2 = 0;
+  Continent_id my_cont = tile_continent(unit_tile(punit));
+  int i;
 
   fc_assert_ret_val(!is_barbarian(pplayer), 0);
   fc_assert_ret_val(pplayer->is_alive, 0);
@@ -457,169 +547,191 @@ int dai_hunter_manage(struct ai_type *ait, struct player *pplayer,
                          &original_threat, &original_cost);
   }
 
-  pf_map_move_costs_iterate(pfm, ptile, move_cost, FALSE) {
-    /* End faster if we have a target */
-    if (move_cost > limit) {
-      UNIT_LOG(LOGLEVEL_HUNT, punit, "gave up finding hunt target");
-      pf_map_destroy(pfm);
-      return 0;
-    }
+  candidates = dai_hunter_targets_get(ait, pplayer);
 
-    if (tile_city(ptile)
-        || !can_unit_attack_tile(punit, NULL, ptile)) {
+  for (i = 0; i < candidates->count; i++) {
+    struct unit *target = game_unit_by_number(candidates->targets[i].id);
+    struct player *aplayer;
+    int dist1, dist2;
+    unsigned stackthreat = 0, stackcost = 0;
+    int move_cost;
+    struct unit_ai *target_data;
+    struct tile *target_tile;
+    struct unit *defender;
+
+    if (target == NULL) {
+      /* Died since the index was built */
       continue;
     }
 
-    unit_list_iterate_safe(ptile->units, target) {
-      struct player *aplayer = unit_owner(target);
-      int dist1, dist2;
-      unsigned stackthreat = 0, stackcost = 0;
-      int sanity_target = target->id;
-      struct pf_path *path;
-      struct unit_ai *target_data;
-      struct tile *target_tile;
-      struct unit *defender;
+    aplayer = unit_owner(target);
+    /* Note that we need not (yet) be at war with aplayer */
+    if (!adv_is_player_dangerous(pplayer, aplayer)) {
+      continue;
+    }
 
-      /* Note that we need not (yet) be at war with aplayer */
-      if (!adv_is_player_dangerous(pplayer, aplayer)) {
-        continue;
-      }
+    target_tile = unit_tile(target);
 
-      target_data = def_ai_unit_data(target, ait);
-      if (BV_ISSET(target_data->hunted, player_index(pplayer))) {
-        /* Can't hunt this one. The bit is cleared in the beginning
-         * of each turn. */
-        continue;
-      }
-      if (!utype_acts_hostile(unit_type_get(target))
-          && get_transporter_capacity(target) == 0
-          && !unit_has_type_flag(target, UTYF_GAMELOSS)) {
-        /* Won't hunt this one. */
-        continue;
-      }
+    /* A land hunter can never reach another continent; skip such targets
+     * without expanding the path-finding map towards them. */
+    if (my_cont > 0 && tile_continent(target_tile) > 0
+        && tile_continent(target_tile) != my_cont) {
+      continue;
+    }
 
-      target_tile = unit_tile(target);
-      if (!unit_attack_unit_at_tile_result(punit, NULL, target, target_tile)) {
-        /* We can't attack the target */
-        continue;
-      }
+    target_data = def_ai_unit_data(target, ait);
+    if (BV_ISSET(target_data->hunted, player_index(pplayer))) {
+      /* Can't hunt this one. The bit is cleared in the beginning
+       * of each turn. */
+      continue;
+    }
 
-      /* Figure out whether unit is coming closer */
-      if (target_data->cur_pos && target_data->prev_pos) {
-        dist1 = real_map_distance(unit_tile(punit), *target_data->cur_pos);
-        dist2 = real_map_distance(unit_tile(punit), *target_data->prev_pos);
-      } else {
-        dist1 = dist2 = 0;
-      }
-      UNIT_LOG(LOGLEVEL_HUNT, punit, "considering chasing %s[%d](%d, %d) "
-                                     "dist1 %d dist2 %d",
-               unit_rule_name(target), target->id, TILE_XY(target_tile),
-               dist1, dist2);
-
-      /* We can't chase if we aren't faster or on intercept vector */
-      if (unit_type_get(punit)->move_rate < unit_type_get(target)->move_rate
-          && dist1 >= dist2) {
-        UNIT_LOG(LOGLEVEL_HUNT, punit,
-                 "giving up racing %s (%d, %d)->(%d, %d)",
-                 unit_rule_name(target),
-                 target_data->prev_pos
-                   ? index_to_map_pos_x(tile_index(*target_data->prev_pos))
-                   : -1,
-                 target_data->prev_pos
-                   ? index_to_map_pos_y(tile_index(*target_data->prev_pos))
-                   : -1,
-                 TILE_XY(target_tile));
-        continue;
-      }
+    if (tile_city(target_tile)
+        || !can_unit_attack_tile(punit, NULL, target_tile)) {
+      continue;
+    }
+    if (!unit_attack_unit_at_tile_result(punit, NULL, target, target_tile)) {
+      /* We can't attack the target */
+      continue;
+    }
 
-      /* Calculate juiciness of target, compare with existing target,
-       * if any. */
-      dai_hunter_juiciness(pplayer, punit, target, &stackthreat, &stackcost);
-      defender = get_defender(nmap, punit, target_tile, NULL);
-      if (defender != NULL) {
-        stackcost *= unit_win_chance(nmap, punit, defender, NULL);
-      }
-      if (stackcost < unit_build_shield_cost_base(punit)) {
-        UNIT_LOG(LOGLEVEL_HUNT, punit, "%d is too expensive (it %d vs us %d)",
-                 target->id, stackcost,
-                 unit_build_shield_cost_base(punit));
-        continue; /* Too expensive */
-      }
-      stackthreat /= move_cost + 1;
-      if (!is_virtual
-          && original_target != target
-          && original_threat > stackthreat) {
-        UNIT_LOG(LOGLEVEL_HUNT, punit, "Unit %d is not worse than %d",
-                 target->id, original_target->id);
-        continue; /* The threat we found originally was worse than this! */
-      }
-      if (stackthreat < unit_build_shield_cost_base(punit)) {
-        UNIT_LOG(LOGLEVEL_HUNT, punit, "%d is not worth it", target->id);
-        continue; /* Not worth it */
-      }
+    move_cost = pf_map_move_cost(pfm, target_tile);
+    if (move_cost == PF_IMPOSSIBLE_MC || move_cost > limit) {
+      /* Unreachable or too far away */
+      continue;
+    }
 
-      UNIT_LOG(LOGLEVEL_HUNT, punit, "hunting %s %s[%d](%d,%d) "
-               "with want %d, dist1 %d, dist2 %d",
-               nation_rule_name(nation_of_unit(target)),
+    /* Figure out whether unit is coming closer */
+    if (target_data->cur_pos && target_data->prev_pos) {
+      dist1 = real_map_distance(unit_tile(punit), *target_data->cur_pos);
+      dist2 = real_map_distance(unit_tile(punit), *target_data->prev_pos);
+    } else {
+      dist1 = dist2 = 0;
+    }
+    UNIT_LOG(LOGLEVEL_HUNT, punit, "considering chasing %s[%d](%d, %d) "
+                                   "dist1 %d dist2 %d",
+             unit_rule_name(target), target->id, TILE_XY(target_tile),
+             dist1, dist2);
+
+    /* We can't chase if we aren't faster or on intercept vector */
+    if (unit_type_get(punit)->move_rate < unit_type_get(target)->move_rate
+        && dist1 >= dist2) {
+      UNIT_LOG(LOGLEVEL_HUNT, punit,
+               "giving up racing %s (%d, %d)->(%d, %d)",
                unit_rule_name(target),
-               target->id,
-               TILE_XY(target_tile),
-               stackthreat,
-               dist1,
-               dist2);
-      /* Ok, now we FINALLY have a target worth destroying! */
-      unit_data->target = target->id;
-      if (is_virtual) {
-        pf_map_destroy(pfm);
-        return stackthreat;
-      }
+               target_data->prev_pos
+                 ? index_to_map_pos_x(tile_index(*target_data->prev_pos))
+                 : -1,
+               target_data->prev_pos
+                 ? index_to_map_pos_y(tile_index(*target_data->prev_pos))
+                 : -1,
+               TILE_XY(target_tile));
+      continue;
+    }
+
+    /* Calculate juiciness of target, compare with existing target,
+     * if any. */
+    dai_hunter_juiciness(pplayer, punit, target, &stackthreat, &stackcost);
+    defender = get_defender(nmap, punit, target_tile, NULL);
+    if (defender != NULL) {
+      stackcost *= unit_win_chance(nmap, punit, defender, NULL);
+    }
+    if (stackcost < unit_build_shield_cost_base(punit)) {
+      UNIT_LOG(LOGLEVEL_HUNT, punit, "%d is too expensive (it %d vs us %d)",
+               target->id, stackcost,
+               unit_build_shield_cost_base(punit));
+      continue; /* Too expensive */
+    }
+    stackthreat /= move_cost + 1;
+    if (!is_virtual
+        && original_target != target
+        && original_threat > stackthreat) {
+      UNIT_LOG(LOGLEVEL_HUNT, punit, "Unit %d is not worse than %d",
+               target->id, original_target->id);
+      continue; /* The threat we found originally was worse than this! */
+    }
+    if (stackthreat < unit_build_shield_cost_base(punit)) {
+      UNIT_LOG(LOGLEVEL_HUNT, punit, "%d is not worth it", target->id);
+      continue; /* Not worth it */
+    }
 
-      /* This assigns missiles to us */
-      dai_unit_new_task(ait, punit, AIUNIT_HUNTER, target_tile);
+    if (stackthreat > best_threat) {
+      best_threat = stackthreat;
+      best_target = target;
+      best_dist1 = dist1;
+      best_dist2 = dist2;
+    }
+  }
 
-      /* Check if we can nuke it */
-      dai_hunter_try_launch(ait, pplayer, punit, target);
+  if (best_target == NULL) {
+    UNIT_LOG(LOGLEVEL_HUNT, punit, "found no hunt target");
+    pf_map_destroy(pfm);
+    return 0; /* Found nothing */
+  }
 
-      /* Check if we have nuked it */
-      if (target != game_unit_by_number(sanity_target)) {
-        UNIT_LOG(LOGLEVEL_HUNT, punit, "mission accomplished by cargo (pre)");
-        dai_unit_new_task(ait, punit, AIUNIT_NONE, NULL);
-        pf_map_destroy(pfm);
-        return -1; /* try again */
-      }
+  {
+    struct unit *target = best_target;
+    struct tile *target_tile = unit_tile(target);
+    int sanity_target = target->id;
+    struct pf_path *path;
+
+    UNIT_LOG(LOGLEVEL_HUNT, punit, "hunting %s %s[%d](%d,%d) "
+             "with want %d, dist1 %d, dist2 %d",
+             nation_rule_name(nation_of_unit(target)),
+             unit_rule_name(target),
+             target->id,
+             TILE_XY(target_tile),
+             best_threat,
+             best_dist1,
+             best_dist2);
+    /* Ok, now we FINALLY have a target worth destroying! */
+    unit_data->target = target->id;
+    if (is_virtual) {
+      pf_map_destroy(pfm);
+      return best_threat;
+    }
 
-      /* Go towards it. */
-      path = pf_map_path(pfm, target_tile);
-      if (!adv_unit_execute_path(punit, path)) {
-        pf_path_destroy(path);
-        pf_map_destroy(pfm);
-        return 0;
-      }
-      pf_path_destroy(path);
+    /* This assigns missiles to us */
+    dai_unit_new_task(ait, punit, AIUNIT_HUNTER, target_tile);
 
-      if (target != game_unit_by_number(sanity_target)) {
-        UNIT_LOG(LOGLEVEL_HUNT, punit, "mission accomplished");
-        dai_unit_new_task(ait, punit, AIUNIT_NONE, NULL);
-        pf_map_destroy(pfm);
-        return -1; /* try again */
-      }
+    /* Check if we can nuke it */
+    dai_hunter_try_launch(ait, pplayer, punit, target);
 
-      /* Check if we can nuke it now */
-      dai_hunter_try_launch(ait, pplayer, punit, target);
-      if (target != game_unit_by_number(sanity_target)) {
-        UNIT_LOG(LOGLEVEL_HUNT, punit, "mission accomplished by cargo (post)");
-        dai_unit_new_task(ait, punit, AIUNIT_NONE, NULL);
-        pf_map_destroy(pfm);
-        return -1; /* try again */
-      }
+    /* Check if we have nuked it */
+    if (target != game_unit_by_number(sanity_target)) {
+      UNIT_LOG(LOGLEVEL_HUNT, punit, "mission accomplished by cargo (pre)");
+      dai_unit_new_task(ait, punit, AIUNIT_NONE, NULL);
+      pf_map_destroy(pfm);
+      return -1; /* try again */
+    }
+
+    /* Go towards it. */
+    path = pf_map_path(pfm, target_tile);
+    if (!adv_unit_execute_path(punit, path)) {
+      pf_path_destroy(path);
+      pf_map_destroy(pfm);
+      return 0;
+    }
+    pf_path_destroy(path);
 
+    if (target != game_unit_by_number(sanity_target)) {
+      UNIT_LOG(LOGLEVEL_HUNT, punit, "mission accomplished");
+      dai_unit_new_task(ait, punit, AIUNIT_NONE, NULL);
       pf_map_destroy(pfm);
-      unit_data->done = TRUE;
-      return stackthreat; /* still have work to do */
-    } unit_list_iterate_safe_end;
-  } pf_map_move_costs_iterate_end;
-
-  UNIT_LOG(LOGLEVEL_HUNT, punit, "ran out of map finding hunt target");
-  pf_map_destroy(pfm);
-  return 0; /* found nothing */
+      return -1; /* try again */
+    }
+
+    /* Check if we can nuke it now */
+    dai_hunter_try_launch(ait, pplayer, punit, target);
+    if (target != game_unit_by_number(sanity_target)) {
+      UNIT_LOG(LOGLEVEL_HUNT, punit, "mission accomplished by cargo (post)");
+      dai_unit_new_task(ait, punit, AIUNIT_NONE, NULL);
+      pf_map_destroy(pfm);
+      return -1; /* try again */
+    }
+
+    pf_map_destroy(pfm);
+    unit_data->done = TRUE;
+    return best_threat; /* still have work to do */
+  }
 }
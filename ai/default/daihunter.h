@@ -22,5 +22,6 @@ void dai_hunter_choice(struct ai_type *ait, struct player *pplayer,
 bool dai_hunter_qualify(struct player *pplayer, struct unit *punit);
 int dai_hunter_manage(struct ai_type *ait, struct player *pplayer,
                       struct unit *punit);
+void dai_hunter_targets_free(struct ai_type *ait, struct player *pplayer);
 
 #endif /* FC__DAIHUNTER_H */
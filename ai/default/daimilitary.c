@@ -19,6 +19,7 @@
 
 /* utility */
 #include "log.h"
+#include "mem.h"
 
 /* common */
 #include "combat.h"
@@ -73,6 +74,11 @@
 #define CITY_CONQUEST_WORTH(_city_, _data_) \
   (_data_->worth * 0.9 + (city_size_get(_city_) - 0.5) * 10)
 
+/* Longest assessment horizon, in turns, that assess_danger() uses
+ * (the cpuhog case). Unit events within this many turns of movement
+ * from a city invalidate the city's cached assessment. */
+#define ASSESS_DANGER_TURNS_MAX 6
+
 static unsigned int assess_danger(struct ai_type *ait,
                                   const struct civ_map *nmap,
                                   struct city *pcity,
@@ -645,12 +651,100 @@ void dai_assess_danger_player(struct ai_type *ait,
 {
   /* Do nothing if game is not running */
   if (S_S_RUNNING == server_state()) {
+    struct ai_plr *ai = def_ai_player_data(pplayer, ait);
+    bool changed = (ai->danger_govt != government_of_player(pplayer));
+
+    /* War declarations change which players count as dangerous and
+     * a new government changes the defense effects; either outdates
+     * every cached assessment at once. */
+    players_iterate(aplayer) {
+      unsigned char dstype
+        = (unsigned char) player_diplstate_get(pplayer, aplayer)->type;
+
+      if (ai->danger_diplstates[player_index(aplayer)] != dstype) {
+        ai->danger_diplstates[player_index(aplayer)] = dstype;
+        changed = TRUE;
+      }
+    } players_iterate_end;
+
+    if (changed) {
+      ai->danger_govt = government_of_player(pplayer);
+      city_list_iterate(pplayer->cities, pcity) {
+        def_ai_city_data(pcity, ait)->danger_stale = TRUE;
+      } city_list_iterate_end;
+    }
+
     city_list_iterate(pplayer->cities, pcity) {
       (void) assess_danger(ait, nmap, pcity, NULL);
     } city_list_iterate_end;
   }
 }
 
+/**********************************************************************//**
+  A unit appeared, died, changed type or moved; mark the cached danger
+  assessment of every city close enough to be affected as stale. The
+  radius is a deliberate overestimate of how far the unit could strike
+  within the assessment horizon: the move rate is doubled to allow for
+  roads and rivers, with slack for adjacency and the step behind us.
+**************************************************************************/
+void dai_danger_unit_event(struct ai_type *ait, const struct unit *punit)
+{
+  const struct tile *utile = unit_tile(punit);
+  int radius = (unit_type_get(punit)->move_rate / SINGLE_MOVE + 1)
+               * ASSESS_DANGER_TURNS_MAX * 2 + 2;
+
+  if (utile == NULL) {
+    return;
+  }
+
+  players_iterate_alive(aplayer) {
+    city_list_iterate(aplayer->cities, pcity) {
+      if (real_map_distance(city_tile(pcity), utile) <= radius) {
+        struct ai_city *city_data = def_ai_city_data(pcity, ait);
+
+        if (city_data != NULL) {
+          city_data->danger_stale = TRUE;
+        }
+      }
+    } city_list_iterate_end;
+  } players_iterate_alive_end;
+}
+
+/**********************************************************************//**
+  A tile changed (terrain, extras or ownership), which may change how
+  fast attackers reach the cities around it; drop their cached
+  assessments. The radius is heuristic - a road network change can in
+  principle shift travel times from much further away.
+**************************************************************************/
+void dai_danger_tile_changed(struct ai_type *ait, struct tile *ptile)
+{
+  players_iterate_alive(aplayer) {
+    city_list_iterate(aplayer->cities, pcity) {
+      if (real_map_distance(city_tile(pcity), ptile)
+          <= 2 * ASSESS_DANGER_TURNS_MAX) {
+        struct ai_city *city_data = def_ai_city_data(pcity, ait);
+
+        if (city_data != NULL) {
+          city_data->danger_stale = TRUE;
+        }
+      }
+    } city_list_iterate_end;
+  } players_iterate_alive_end;
+}
+
+/**********************************************************************//**
+  Something about the city changed (buildings above all, which carry the
+  defense effects); drop its cached danger assessment.
+**************************************************************************/
+void dai_danger_city_changed(struct ai_type *ait, struct city *pcity)
+{
+  struct ai_city *city_data = def_ai_city_data(pcity, ait);
+
+  if (city_data != NULL) {
+    city_data->danger_stale = TRUE;
+  }
+}
+
 /**********************************************************************//**
   Set (overwrite) our want for a building. Syela tries to explain:
 
@@ -734,6 +828,27 @@ static unsigned int assess_danger(struct ai_type *ait,
 
   TIMING_LOG(AIT_DANGER, TIMER_START);
 
+  if (ul_cb == NULL && !city_data->danger_stale
+      && city_data->danger_reduced != NULL) {
+    /* Nothing that feeds the assessment changed near this city since
+     * the last full scan. Reuse the cached danger values, but reapply
+     * the building wants: dai_build_adv_adjust() may have recalculated
+     * them from scratch meanwhile. */
+    defense = assess_defense_igwall(ait, pcity);
+    for (i = 0; i < B_LAST; i++) {
+      if (0 < city_data->danger_reduced[i]) {
+        dai_reevaluate_building(pcity,
+                                &pcity->server.adv->building_want[i],
+                                city_data->urgency,
+                                city_data->danger_reduced[i], defense);
+      }
+    }
+
+    TIMING_LOG(AIT_DANGER, TIMER_STOP);
+
+    return city_data->urgency;
+  }
+
   /* Initialize data. */
   memset(&danger_reduced, 0, sizeof(danger_reduced));
   if (has_handicap(pplayer, H_DANGER)) {
@@ -981,6 +1096,22 @@ static unsigned int assess_danger(struct ai_type *ait,
   }
   city_data->urgency = urgency;
 
+  if (ul_cb == NULL) {
+    /* Cache the assessment until a unit or city event near the city,
+     * or a diplomatic change, invalidates it. */
+    if (city_data->danger_reduced == NULL) {
+      city_data->danger_reduced
+        = fc_calloc(B_LAST, sizeof(*city_data->danger_reduced));
+    }
+    memcpy(city_data->danger_reduced, danger_reduced,
+           sizeof(danger_reduced));
+    city_data->danger_stale = FALSE;
+  } else {
+    /* Ran against a caller-supplied unit list; the cached values no
+     * longer match a full assessment. */
+    city_data->danger_stale = TRUE;
+  }
+
   TIMING_LOG(AIT_DANGER, TIMER_STOP);
 
   return urgency;
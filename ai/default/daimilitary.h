@@ -42,6 +42,9 @@ struct adv_choice *military_advisor_choose_build(struct ai_type *ait,
                                                  player_unit_list_getter ul_cb);
 void dai_assess_danger_player(struct ai_type *ait,
                               const struct civ_map *nmap, struct player *pplayer);
+void dai_danger_unit_event(struct ai_type *ait, const struct unit *punit);
+void dai_danger_tile_changed(struct ai_type *ait, struct tile *ptile);
+void dai_danger_city_changed(struct ai_type *ait, struct city *pcity);
 int assess_defense_quadratic(struct ai_type *ait, struct city *pcity);
 int assess_defense_unit(struct ai_type *ait, struct city *pcity,
                         struct unit *punit, bool igwall);
@@ -26,6 +26,7 @@
 
 /* common */
 #include "city.h"
+#include "forkstate.h"
 #include "game.h"
 #include "government.h"
 #include "map.h"
@@ -124,7 +125,8 @@ struct tile_data_cache {
 
   int reserved; /* Reservation for this tile; used by print_citymap() */
 
-  int turn;     /* The turn the values were calculated */
+  int epoch;    /* Settler map epoch the values were stored under;
+                 * see tdc_plr_set(). */
 };
 
 
@@ -143,6 +145,16 @@ static void tile_data_cache_destroy(struct tile_data_cache *ptdc);
 struct ai_settler {
   struct tile_data_cache_hash *tdc_hash;
 
+  /* The tile data cache persists across turns. Single tiles are dropped
+   * by dai_tile_info() when the map changes under them; 'epoch' is
+   * bumped when the advisor priorities or the goal government change,
+   * which outdates every stored entry at once. */
+  int epoch;
+  struct {
+    int food, shield, science;
+  } prio;
+  struct government *goal_govt;
+
 #ifdef FREECIV_DEBUG
   struct {
     int hit;
@@ -188,7 +200,7 @@ static const struct tile_data_cache *tdc_plr_get(struct ai_type *ait,
                                                  struct player *plr,
                                                  int tindex);
 static void tdc_plr_set(struct ai_type *ait, struct player *plr, int tindex,
-                        const struct tile_data_cache *tdcache);
+                        struct tile_data_cache *tdcache);
 
 static struct cityresult *cityresult_new(struct tile *ptile);
 static void cityresult_destroy(struct cityresult *result);
@@ -277,9 +289,7 @@ static struct cityresult *cityresult_fill(struct ai_type *ait,
                                           struct tile *center)
 {
   struct city *pcity = tile_city(center);
-  struct government *curr_govt = government_of_player(pplayer);
-  struct player *saved_owner = NULL;
-  struct tile *saved_claimer = NULL;
+  struct fork_state *fork;
   bool virtual_city = FALSE;
   bool handicap = has_handicap(pplayer, H_MAP);
   struct adv_data *adv = adv_data_get(pplayer, NULL);
@@ -289,16 +299,18 @@ static struct cityresult *cityresult_fill(struct ai_type *ait,
   fc_assert_ret_val(adv != NULL, NULL);
   fc_assert_ret_val(center != NULL, NULL);
 
+  /* Evaluate under the government we are aiming for; the fork restores
+   * everything we touch on any exit. */
+  fork = fork_state_begin();
+  fork_state_save(fork, &pplayer->government,
+                  sizeof(pplayer->government));
   pplayer->government = adv->goal.govt.gov;
 
   /* Create a city result and set default values. */
   result = cityresult_new(center);
 
   if (pcity == NULL) {
-    pcity = create_city_virtual(pplayer, result->tile, "Virtuaville");
-    saved_owner = tile_owner(result->tile);
-    saved_claimer = tile_claimer(result->tile);
-    tile_set_owner(result->tile, pplayer, result->tile); /* Temporarily */
+    pcity = fork_state_city(fork, result->tile, pplayer, "Virtuaville");
     city_choose_build_default(nmap, pcity);  /* ?? */
     virtual_city = TRUE;
   }
@@ -322,7 +334,6 @@ static struct cityresult *cityresult_fill(struct ai_type *ait,
       ptdc->food = 0;
       ptdc->sum = -1;
       ptdc->reserved = reserved;
-      /* ptdc->turn was set by tile_data_cache_new(). */
     } else {
       const struct tile_data_cache *ptdc_hit = tdc_plr_get(ait, pplayer, tindex);
 
@@ -399,6 +410,8 @@ static struct cityresult *cityresult_fill(struct ai_type *ait,
   if (result->city_center.tdc == NULL) {
     fc_assert(result->city_center.tdc != NULL);
 
+    fork_state_discard(fork);
+
     return NULL;
   }
 
@@ -414,6 +427,7 @@ static struct cityresult *cityresult_fill(struct ai_type *ait,
   } else {
     /* There is no available tile in this city. All is worked. */
     result->total = 0;
+    fork_state_discard(fork);
     return result;
   }
 
@@ -452,11 +466,7 @@ static struct cityresult *cityresult_fill(struct ai_type *ait,
   result->total -= result->waste;
   result->total = MAX(0, result->total);
 
-  pplayer->government = curr_govt;
-  if (virtual_city) {
-    destroy_city_virtual(pcity);
-    tile_set_owner(result->tile, saved_owner, saved_claimer);
-  }
+  fork_state_discard(fork);
 
   fc_assert_ret_val(result->city_center.tdc->sum >= 0, NULL);
   fc_assert_ret_val(result->remaining >= 0, NULL);
@@ -469,12 +479,7 @@ static struct cityresult *cityresult_fill(struct ai_type *ait,
 *****************************************************************************/
 struct tile_data_cache *tile_data_cache_new(void)
 {
-  struct tile_data_cache *ptdc_copy = fc_calloc(1, sizeof(*ptdc_copy));
-
-  /* Set the turn the tile data cache was created. */
-  ptdc_copy->turn = game.info.turn;
-
-  return ptdc_copy;
+  return fc_calloc(1, sizeof(struct tile_data_cache));
 }
 
 /*************************************************************************//**
@@ -493,7 +498,7 @@ struct tile_data_cache *
 
   ptdc_copy->sum = ptdc->sum;
   ptdc_copy->reserved = ptdc->reserved;
-  ptdc_copy->turn = ptdc->turn;
+  ptdc_copy->epoch = ptdc->epoch;
 
   return ptdc_copy;
 }
@@ -530,7 +535,8 @@ static const struct tile_data_cache *tdc_plr_get(struct ai_type *ait,
     ai->settler->cache.miss++;
 #endif /* FREECIV_DEBUG */
     return NULL;
-  } else if (ptdc->turn != game.info.turn) {
+  } else if (ptdc->epoch != ai->settler->epoch) {
+    /* Stored under outdated priorities or goal government. */
 #ifdef FREECIV_DEBUG
     ai->settler->cache.old++;
 #endif /* FREECIV_DEBUG */
@@ -547,7 +553,7 @@ static const struct tile_data_cache *tdc_plr_get(struct ai_type *ait,
   Store player's tile data cache
 *****************************************************************************/
 static void tdc_plr_set(struct ai_type *ait, struct player *plr, int tindex,
-                        const struct tile_data_cache *ptdc)
+                        struct tile_data_cache *ptdc)
 {
   struct ai_plr *ai = dai_plr_data_get(ait, plr, NULL);
 
@@ -560,6 +566,7 @@ static void tdc_plr_set(struct ai_type *ait, struct player *plr, int tindex,
     ai->settler->cache.save++;
 #endif /* FREECIV_DEBUG */
 
+  ptdc->epoch = ai->settler->epoch;
   tile_data_cache_hash_replace(ai->settler->tdc_hash, tindex, ptdc);
 }
 
@@ -727,11 +734,9 @@ struct cityresult *city_desirability(struct ai_type *ait, struct player *pplayer
   }
 
   /* Check if another settler has taken a spot within mindist */
-  square_iterate(&(wld.map), ptile, game.info.citymindist-1, tile1) {
-    if (citymap_is_reserved(tile1)) {
-      return NULL;
-    }
-  } square_iterate_end;
+  if (citymap_reserved_nearby(ptile) > 0) {
+    return NULL;
+  }
 
   if (adv_danger_at(punit, ptile)) {
     return NULL;
@@ -1222,6 +1227,7 @@ void dai_auto_settler_reset(struct ai_type *ait, struct player *pplayer)
 {
   bool caller_closes;
   struct ai_plr *ai = dai_plr_data_get(ait, pplayer, &caller_closes);
+  struct adv_data *adv = adv_data_get(pplayer, NULL);
 
   fc_assert_ret(ai != NULL);
   fc_assert_ret(ai->settler != NULL);
@@ -1239,13 +1245,45 @@ void dai_auto_settler_reset(struct ai_type *ait, struct player *pplayer)
   ai->settler->cache.save = 0;
 #endif /* FREECIV_DEBUG */
 
-  tile_data_cache_hash_clear(ai->settler->tdc_hash);
+  /* The cached tile values are weighted by the advisor priorities and
+   * computed under the goal government; when either changes the stored
+   * entries are all outdated. Otherwise the cache persists, and map
+   * changes drop the affected tiles via dai_tile_info(). */
+  if (adv != NULL
+      && (ai->settler->prio.food != adv->food_priority
+          || ai->settler->prio.shield != adv->shield_priority
+          || ai->settler->prio.science != adv->science_priority
+          || ai->settler->goal_govt != adv->goal.govt.gov)) {
+    ai->settler->prio.food = adv->food_priority;
+    ai->settler->prio.shield = adv->shield_priority;
+    ai->settler->prio.science = adv->science_priority;
+    ai->settler->goal_govt = adv->goal.govt.gov;
+    ai->settler->epoch++;
+  }
 
   if (caller_closes) {
     dai_data_phase_finished(ait, pplayer);
   }
 }
 
+/*************************************************************************//**
+  A tile changed (terrain, extras or ownership); drop the values cached
+  for it so that the next city spot evaluation recomputes them.
+*****************************************************************************/
+void dai_tile_info(struct ai_type *ait, struct tile *ptile)
+{
+  int tindex = tile_index(ptile);
+
+  players_iterate(pplayer) {
+    struct ai_plr *ai = def_ai_player_data(pplayer, ait);
+
+    if (ai != NULL && ai->settler != NULL
+        && ai->settler->tdc_hash != NULL) {
+      tile_data_cache_hash_remove(ai->settler->tdc_hash, tindex);
+    }
+  } players_iterate_end;
+}
+
 /*************************************************************************//**
   Deinitialize ai settler engine.
 *****************************************************************************/
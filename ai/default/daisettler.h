@@ -29,6 +29,7 @@ void dai_auto_settler_init(struct ai_plr *ai);
 void dai_auto_settler_free(struct ai_plr *ai);
 
 void dai_auto_settler_reset(struct ai_type *ait, struct player *pplayer);
+void dai_tile_info(struct ai_type *ait, struct tile *ptile);
 void dai_auto_settler_run(struct ai_type *ait, const struct civ_map *nmap,
                           struct player *pplayer,
                           struct unit *punit, struct workermap *state);
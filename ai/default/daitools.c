@@ -36,6 +36,7 @@
 
 /* common/aicore */
 #include "citymap.h"
+#include "pf_hier.h"
 #include "pf_tools.h"
 
 /* server */
@@ -380,7 +381,6 @@ bool dai_unit_goto_constrained(struct ai_type *ait, struct unit *punit,
                                struct pf_parameter *parameter)
 {
   bool alive = TRUE;
-  struct pf_map *pfm;
   struct pf_path *path;
 
   UNIT_LOG(LOG_DEBUG, punit, "constrained goto to %d,%d", TILE_XY(ptile));
@@ -404,8 +404,7 @@ bool dai_unit_goto_constrained(struct ai_type *ait, struct unit *punit,
     return TRUE;
   }
 
-  pfm = pf_map_new(parameter);
-  path = pf_map_path(pfm, ptile);
+  path = pf_hier_map_path(parameter, ptile);
 
   if (path) {
     dai_log_path(punit, path, parameter);
@@ -416,7 +415,6 @@ bool dai_unit_goto_constrained(struct ai_type *ait, struct unit *punit,
   }
 
   pf_path_destroy(path);
-  pf_map_destroy(pfm);
 
   return alive;
 }
@@ -370,8 +370,11 @@ static int avg_benefit(int benefit, int loss, double chance)
 /**********************************************************************//**
   Calculates the value and cost of nearby allied units to see if we can
   expect any help in our attack. Base function.
+
+  Counts every allied unit; an attacker evaluating targets takes itself
+  out via fstk_adjust_for_attacker().
 **************************************************************************/
-static void reinforcements_cost_and_value(struct unit *punit,
+static void reinforcements_cost_and_value(struct player *pplayer,
                                           struct tile *ptile0,
                                           int *value, int *cost)
 {
@@ -379,8 +382,7 @@ static void reinforcements_cost_and_value(struct unit *punit,
   *value = 0;
   square_iterate(&(wld.map), ptile0, 1, ptile) {
     unit_list_iterate(ptile->units, aunit) {
-      if (aunit != punit
-          && pplayers_allied(unit_owner(punit), unit_owner(aunit))) {
+      if (pplayers_allied(pplayer, unit_owner(aunit))) {
         int val = adv_unit_att_rating(aunit);
 
         if (val != 0) {
@@ -990,11 +992,12 @@ static void dai_military_defend(struct ai_type *ait, struct player *pplayer,
 }
 
 /**********************************************************************//**
-  Mark invasion possibilities of single unit in a city.
+  Mark invasion possibilities of single unit in a city. With a negative
+  'sign' an earlier mark is taken out again.
 **************************************************************************/
 static void single_invader(struct ai_city *city_data,
                            const struct unit_type *utype,
-                           int which)
+                           int which, int sign)
 {
   int attacks;
 
@@ -1004,9 +1007,9 @@ static void single_invader(struct ai_city *city_data,
   } else {
     attacks = utype->move_rate;
   }
-  city_data->invasion.attack += attacks;
+  city_data->invasion.attack += sign * attacks;
   if (which == INVASION_OCCUPY) {
-    city_data->invasion.occupy++;
+    city_data->invasion.occupy += sign;
   }
 }
 
@@ -1019,9 +1022,12 @@ static void single_invader(struct ai_city *city_data,
   tell attack which can only kill units from occupy possibility).
 
   If dest is TRUE then a valid goto is presumed.
+
+  With a negative 'sign' the marks of an earlier positive call are taken
+  out again.
 **************************************************************************/
 static void invasion_funct(struct ai_type *ait, struct unit *punit,
-                           bool dest, int radius, int which)
+                           bool dest, int radius, int which, int sign)
 {
   struct tile *ptile;
   struct player *pplayer = unit_owner(punit);
@@ -1043,7 +1049,7 @@ static void invasion_funct(struct ai_type *ait, struct unit *punit,
       struct ai_city *city_data = def_ai_city_data(pcity, ait);
 
       /* Unit itself */
-      single_invader(city_data, unit_type_get(punit), which);
+      single_invader(city_data, unit_type_get(punit), which, sign);
 
       /* Cargo */
       unit_cargo_iterate(punit, cargo) {
@@ -1052,13 +1058,138 @@ static void invasion_funct(struct ai_type *ait, struct unit *punit,
         if (IS_ATTACKER(utype)) {
           single_invader(city_data, utype,
                          unit_can_take_over(cargo)
-                         ? INVASION_OCCUPY : INVASION_ATTACK);
+                         ? INVASION_OCCUPY : INVASION_ATTACK, sign);
         }
       } unit_cargo_iterate_end;
     }
   } square_iterate_end;
 }
 
+/**********************************************************************//**
+  Count one of our units into the shared target data: the invasion marks
+  it leaves around its position and its goto destination, and its attack
+  strength on the city it is heading to. With a negative 'sign' the
+  contribution of an earlier positive call is taken out again.
+**************************************************************************/
+static void fstk_count_unit(struct ai_type *ait, struct unit *aunit,
+                            int sign)
+{
+  const struct unit_type *atype = unit_type_get(aunit);
+
+  if (IS_ATTACKER(atype)) {
+    if (aunit->activity == ACTIVITY_GOTO) {
+      struct city *pcity;
+
+      invasion_funct(ait, aunit, TRUE, 0,
+                     (unit_can_take_over(aunit)
+                      ? INVASION_OCCUPY : INVASION_ATTACK), sign);
+      if ((pcity = tile_city(aunit->goto_tile))) {
+        struct ai_city *city_data = def_ai_city_data(pcity, ait);
+
+        city_data->attack += sign * adv_unit_att_rating(aunit);
+        city_data->bcost += sign * unit_build_shield_cost_base(aunit);
+      }
+    }
+    invasion_funct(ait, aunit, FALSE, unit_move_rate(aunit) / SINGLE_MOVE,
+                   (unit_can_take_over(aunit)
+                    ? INVASION_OCCUPY : INVASION_ATTACK), sign);
+  } else if (def_ai_unit_data(aunit, ait)->passenger != 0) {
+    /* It's a transport with reinforcements */
+    if (aunit->activity == ACTIVITY_GOTO) {
+      invasion_funct(ait, aunit, TRUE, 1, INVASION_OCCUPY, sign);
+    }
+    invasion_funct(ait, aunit, FALSE, 2, INVASION_OCCUPY, sign);
+  }
+}
+
+/**********************************************************************//**
+  Build the shared part of the find_something_to_kill() target data:
+  the reinforcement strength waiting around every potentially hostile
+  city and the invasion pressure our units already put on them. This
+  used to be recomputed for every single attacker; it is built once per
+  player phase instead, and each attacker takes its own contribution
+  back out while evaluating targets (see fstk_adjust_for_attacker()).
+**************************************************************************/
+static void fstk_build_target_data(struct ai_type *ait,
+                                   struct player *pplayer)
+{
+  struct ai_plr *ai = def_ai_player_data(pplayer, ait);
+
+  if (ai->fstk_data_built) {
+    return;
+  }
+
+  /* Reset enemy cities data. */
+  players_iterate(aplayer) {
+    /* Use the broader hostility test so that the data also covers the
+     * virtual unit case of find_something_to_kill(). */
+    if (!POTENTIALLY_HOSTILE_PLAYER(ait, pplayer, aplayer)) {
+      continue;
+    }
+    city_list_iterate(aplayer->cities, acity) {
+      struct ai_city *city_data = def_ai_city_data(acity, ait);
+
+      reinforcements_cost_and_value(pplayer, acity->tile,
+                                    &city_data->attack,
+                                    &city_data->bcost);
+      city_data->invasion.attack = 0;
+      city_data->invasion.occupy = 0;
+    } city_list_iterate_end;
+  } players_iterate_end;
+
+  /* Calculate in units on their way there, and mark targets for
+   * invasion. */
+  unit_list_iterate(pplayer->units, aunit) {
+    fstk_count_unit(ait, aunit, +1);
+  } unit_list_iterate_end;
+
+  ai->fstk_data_built = TRUE;
+}
+
+/**********************************************************************//**
+  Adjust the shared target data for the attacker under evaluation: with
+  sign -1 the attacker's own reinforcement and invasion contributions
+  are taken out (it cannot reinforce its own attack), with sign +1 they
+  are put back afterwards. Transports stacked with the attacker do not
+  count as incoming reinforcements either while it is evaluated.
+**************************************************************************/
+static void fstk_adjust_for_attacker(struct ai_type *ait,
+                                     struct player *pplayer,
+                                     struct unit *punit, int sign)
+{
+  struct tile *punit_tile = unit_tile(punit);
+
+  if (punit->id != 0) {
+    int val = adv_unit_att_rating(punit);
+
+    if (val != 0) {
+      int cost = unit_build_shield_cost_base(punit);
+
+      square_iterate(&(wld.map), punit_tile, 1, ptile) {
+        struct city *acity = tile_city(ptile);
+
+        if (acity != nullptr
+            && POTENTIALLY_HOSTILE_PLAYER(ait, pplayer,
+                                          city_owner(acity))) {
+          struct ai_city *city_data = def_ai_city_data(acity, ait);
+
+          city_data->attack += sign * val;
+          city_data->bcost += sign * cost;
+        }
+      } square_iterate_end;
+    }
+
+    fstk_count_unit(ait, punit, sign);
+  }
+
+  unit_list_iterate(punit_tile->units, aunit) {
+    if (aunit != punit && unit_owner(aunit) == pplayer
+        && !IS_ATTACKER(unit_type_get(aunit))) {
+      fstk_count_unit(ait, aunit, sign);
+    }
+  } unit_list_iterate_end;
+}
+
 /**********************************************************************//**
   Returns TRUE if a beachhead has been found to reach 'dest_tile'.
 **************************************************************************/
@@ -1212,65 +1343,13 @@ adv_want find_something_to_kill(struct ai_type *ait, struct player *pplayer,
 
   /*** Part 1: Calculate targets ***/
 
-  /* This horrible piece of code attempts to calculate the attractiveness of
-   * enemy cities as targets for our units, by checking how many units are
-   * going towards it or are near it already. */
-
-  /* Reset enemy cities data. */
-  players_iterate(aplayer) {
-    /* See comment below in next usage of POTENTIALLY_HOSTILE_PLAYER. */
-    if ((punit->id == 0 && !POTENTIALLY_HOSTILE_PLAYER(ait, pplayer, aplayer))
-        || (punit->id != 0 && !pplayers_at_war(pplayer, aplayer))) {
-      continue;
-    }
-    city_list_iterate(aplayer->cities, acity) {
-      struct ai_city *city_data = def_ai_city_data(acity, ait);
-
-      reinforcements_cost_and_value(punit, acity->tile,
-                                    &city_data->attack,
-                                    &city_data->bcost);
-      city_data->invasion.attack = 0;
-      city_data->invasion.occupy = 0;
-    } city_list_iterate_end;
-  } players_iterate_end;
-
-  /* Second, calculate in units on their way there, and mark targets for
-   * invasion */
-  unit_list_iterate(pplayer->units, aunit) {
-    const struct unit_type *atype;
-
-    if (aunit == punit) {
-      continue;
-    }
-
-    atype = unit_type_get(aunit);
-
-    /* Dealing with invasion stuff */
-    if (IS_ATTACKER(atype)) {
-      if (aunit->activity == ACTIVITY_GOTO) {
-        invasion_funct(ait, aunit, TRUE, 0,
-                       (unit_can_take_over(aunit)
-                        ? INVASION_OCCUPY : INVASION_ATTACK));
-        if ((pcity = tile_city(aunit->goto_tile))) {
-          struct ai_city *city_data = def_ai_city_data(pcity, ait);
-
-          city_data->attack += adv_unit_att_rating(aunit);
-          city_data->bcost += unit_build_shield_cost_base(aunit);
-        }
-      }
-      invasion_funct(ait, aunit, FALSE, unit_move_rate(aunit) / SINGLE_MOVE,
-                     (unit_can_take_over(aunit)
-                      ? INVASION_OCCUPY : INVASION_ATTACK));
-    } else if (def_ai_unit_data(aunit, ait)->passenger != 0
-               && !same_pos(unit_tile(aunit), unit_tile(punit))) {
-      /* It's a transport with reinforcements */
-      if (aunit->activity == ACTIVITY_GOTO) {
-        invasion_funct(ait, aunit, TRUE, 1, INVASION_OCCUPY);
-      }
-      invasion_funct(ait, aunit, FALSE, 2, INVASION_OCCUPY);
-    }
-  } unit_list_iterate_end;
-  /* End horrible initialization subroutine */
+  /* The attractiveness of enemy cities as targets - how many of our
+   * units are going towards them or are near them already - is shared
+   * between all our attackers and built only once per phase. Here we
+   * only take this attacker's own contribution out of the shared data;
+   * it is put back below, once the targets have been evaluated. */
+  fstk_build_target_data(ait, pplayer);
+  fstk_adjust_for_attacker(ait, pplayer, punit, -1);
 
 
   /*** Part 2: Now pick one target ***/
@@ -1339,6 +1418,14 @@ adv_want find_something_to_kill(struct ai_type *ait, struct player *pplayer,
     }
   }
 
+  if (ferry_map != nullptr) {
+    /* Both maps get queried repeatedly below; fill them up front, in
+     * parallel. */
+    struct pf_map *fill_maps[2] = { punit_map, ferry_map };
+
+    pf_maps_prefill_parallel(fill_maps, 2);
+  }
+
   can_occupy = unit_can_take_over(punit);
 
   players_iterate(aplayer) {
@@ -1617,6 +1704,9 @@ adv_want find_something_to_kill(struct ai_type *ait, struct player *pplayer,
     } unit_list_iterate_end;
   } players_iterate_end;
 
+  /* Put our own contribution back into the shared target data. */
+  fstk_adjust_for_attacker(ait, pplayer, punit, +1);
+
   if (ppath != nullptr) {
     *ppath = (goto_dest_tile != nullptr && goto_dest_tile != punit_tile
               ? pf_map_path(punit_map, goto_dest_tile) : nullptr);
@@ -2378,6 +2468,9 @@ static void dai_manage_caravan(struct ai_type *ait, struct player *pplayer,
     }
 
     caravan_parameter_init_from_unit(&parameter, punit);
+    /* Share pair valuations with the player's other caravans this
+     * turn; with many caravans the evaluation is mostly repeated. */
+    parameter.batch_valuations = TRUE;
     /* Make more trade with allies than other peaceful nations
      * by considering only allies 50% of the time.
      * (the other 50% allies are still considered, but so are other nations) */
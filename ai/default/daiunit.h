@@ -43,6 +43,10 @@ struct unit_ai {
   bv_player hunted; /* If a player is hunting us, set by that player */
   bool done;  /* We are done controlling this unit this turn */
 
+  Continent_id counted_cont; /* Continent this unit is counted on in the
+                              * owner's worker statistics (daidata.c);
+                              * 0 when it is not counted */
+
   enum ai_unit_task task;
 };
 
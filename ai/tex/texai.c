@@ -21,6 +21,7 @@
 
 /* ai/default */
 #include "daicity.h"
+#include "daidata.h"
 #include "daidiplomacy.h"
 #include "daidomestic.h"
 #include "daiferry.h"
@@ -387,6 +388,83 @@ static void texwai_auto_settler_reset(struct player *pplayer)
   TEXAI_DFUNC(dai_auto_settler_reset, pplayer);
 }
 
+/**********************************************************************//**
+  Pass tile info both to the threaded world map and to the default ai
+  parts we use.
+**************************************************************************/
+static void texwai_tile_info(struct tile *ptile)
+{
+  TEXAI_AIT;
+
+  texai_tile_info(ptile);
+  TEXAI_DFUNC(dai_tile_info, ptile);
+  TEXAI_DFUNC(dai_danger_tile_changed, ptile);
+}
+
+/**********************************************************************//**
+  Pass a unit event both to the threaded world model and to the danger
+  assessment of the default ai parts we use.
+**************************************************************************/
+static void texwai_unit_created(struct unit *punit)
+{
+  TEXAI_AIT;
+
+  texai_unit_created(punit);
+  TEXAI_DFUNC(dai_stats_unit_created, punit);
+  TEXAI_DFUNC(dai_danger_unit_event, punit);
+}
+
+/**********************************************************************//**
+  Pass a unit event both to the threaded world model and to the danger
+  assessment of the default ai parts we use.
+**************************************************************************/
+static void texwai_unit_destroyed(struct unit *punit)
+{
+  TEXAI_AIT;
+
+  texai_unit_destroyed(punit);
+  TEXAI_DFUNC(dai_stats_unit_destroyed, punit);
+  TEXAI_DFUNC(dai_danger_unit_event, punit);
+}
+
+/**********************************************************************//**
+  Pass a unit event both to the threaded world model and to the danger
+  assessment of the default ai parts we use.
+**************************************************************************/
+static void texwai_unit_move_seen(struct unit *punit)
+{
+  TEXAI_AIT;
+
+  texai_unit_move_seen(punit);
+  TEXAI_DFUNC(dai_stats_unit_moved, punit);
+  TEXAI_DFUNC(dai_danger_unit_event, punit);
+}
+
+/**********************************************************************//**
+  Pass a unit change both to the threaded world model and to the danger
+  assessment of the default ai parts we use.
+**************************************************************************/
+static void texwai_unit_changed(struct unit *punit)
+{
+  TEXAI_AIT;
+
+  texai_unit_changed(punit);
+  TEXAI_DFUNC(dai_stats_unit_changed, punit);
+  TEXAI_DFUNC(dai_danger_unit_event, punit);
+}
+
+/**********************************************************************//**
+  Pass a city change both to the threaded world model and to the danger
+  assessment of the default ai parts we use.
+**************************************************************************/
+static void texwai_city_changed(struct city *pcity)
+{
+  TEXAI_AIT;
+
+  texai_city_changed(pcity);
+  TEXAI_DFUNC(dai_danger_city_changed, pcity);
+}
+
 /**********************************************************************//**
   Call default ai with tex ai type as parameter.
 **************************************************************************/
@@ -641,8 +719,8 @@ bool fc_ai_tex_setup(struct ai_type *ai)
   ai->funcs.unit_alloc = texwai_unit_alloc;
   ai->funcs.unit_free = texwai_unit_free;
 
-  ai->funcs.unit_created = texai_unit_created;
-  ai->funcs.unit_destroyed = texai_unit_destroyed;
+  ai->funcs.unit_created = texwai_unit_created;
+  ai->funcs.unit_destroyed = texwai_unit_destroyed;
 
   ai->funcs.unit_got = texwai_ferry_init_ferry;
   ai->funcs.unit_lost = texwai_ferry_lost;
@@ -650,7 +728,7 @@ bool fc_ai_tex_setup(struct ai_type *ai)
 
   ai->funcs.unit_turn_end = texwai_unit_turn_end;
   ai->funcs.unit_move = texwai_unit_move_or_attack;
-  ai->funcs.unit_move_seen = texai_unit_move_seen;
+  ai->funcs.unit_move_seen = texwai_unit_move_seen;
   ai->funcs.unit_task = texwai_unit_new_adv_task;
 
   ai->funcs.unit_save = texwai_unit_save;
@@ -681,9 +759,9 @@ bool fc_ai_tex_setup(struct ai_type *ai)
 
   ai->funcs.refresh = texwai_refresh;
 
-  ai->funcs.tile_info = texai_tile_info;
-  ai->funcs.city_info = texai_city_changed;
-  ai->funcs.unit_info = texai_unit_changed;
+  ai->funcs.tile_info = texwai_tile_info;
+  ai->funcs.city_info = texwai_city_changed;
+  ai->funcs.unit_info = texwai_unit_changed;
 
   ai->funcs.revolution_start = texwai_revolution_start;
 
@@ -91,8 +91,77 @@
 static struct {
   struct timer *wall_timer;
   int apply_result_ignored, apply_result_applied, refresh_forced;
+  int state_unchanged;
 } stats;
 
+/****************************************************************************
+  Fingerprints of the city states the governor last left in place, by
+  city id. A city change notification whose fingerprint matches the
+  stored one (e.g. a mere shield stock tick) cannot affect the solution
+  and is ignored without rerunning the solver.
+****************************************************************************/
+#define SPECHASH_TAG city_state
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_INT_DATA_TYPE
+#include "spechash.h"
+
+static struct city_state_hash *state_hash = NULL;
+
+/************************************************************************//**
+  Compute a fingerprint of everything the solver's answer for the given
+  governed city can depend on: the stored parameter, city size and map
+  radius, the current citizen allocation, the happiness summary and the
+  potential output of every city tile. Bookkeeping updates like shield
+  or food stock ticks leave the fingerprint unchanged.
+****************************************************************************/
+static unsigned int
+city_state_fingerprint(struct city *pcity,
+                       const struct cm_parameter *parameter)
+{
+  unsigned int hash = 2166136261u;
+  bool celebrating = city_celebrating(pcity);
+  int radius_sq = city_map_radius_sq_get(pcity);
+  struct tile *pcenter = city_tile(pcity);
+
+#define FINGERPRINT_FEED(value) \
+  hash = (hash ^ (unsigned int) (value)) * 16777619u
+
+  output_type_iterate(o) {
+    FINGERPRINT_FEED(parameter->minimal_surplus[o]);
+    FINGERPRINT_FEED(parameter->factor[o]);
+    FINGERPRINT_FEED(pcity->surplus[o]);
+    FINGERPRINT_FEED(pcity->bonus[o]);
+  } output_type_iterate_end;
+  FINGERPRINT_FEED(parameter->happy_factor);
+  FINGERPRINT_FEED(parameter->require_happy ? 1 : 2);
+  FINGERPRINT_FEED(parameter->max_growth ? 1 : 2);
+
+  FINGERPRINT_FEED(city_size_get(pcity));
+  FINGERPRINT_FEED(radius_sq);
+  FINGERPRINT_FEED(celebrating ? 1 : 2);
+  FINGERPRINT_FEED(pcity->anarchy);
+
+  specialist_type_iterate(sp) {
+    FINGERPRINT_FEED(pcity->specialists[sp]);
+  } specialist_type_iterate_end;
+
+  FINGERPRINT_FEED(pcity->feel[CITIZEN_HAPPY][FEELING_FINAL]);
+  FINGERPRINT_FEED(pcity->feel[CITIZEN_CONTENT][FEELING_FINAL]);
+  FINGERPRINT_FEED(pcity->feel[CITIZEN_UNHAPPY][FEELING_FINAL]);
+  FINGERPRINT_FEED(pcity->feel[CITIZEN_ANGRY][FEELING_FINAL]);
+
+  city_tile_iterate_index(&(wld.map), radius_sq, pcenter, ptile, cindex) {
+    FINGERPRINT_FEED(tile_worked(ptile) == pcity ? cindex : ~cindex);
+    output_type_iterate(o) {
+      FINGERPRINT_FEED(city_tile_output(pcity, ptile, celebrating, o));
+    } output_type_iterate_end;
+  } city_tile_iterate_index_end;
+
+#undef FINGERPRINT_FEED
+
+  return hash;
+}
+
 /************************************************************************//**
   Returns TRUE iff the two results are equal. Both results have to be
   results for the given city.
@@ -349,6 +418,7 @@ static void report_stats(void)
            per_mill / 10, per_mill % 10, stats.apply_result_ignored,
            (1000 - per_mill) / 10, (1000 - per_mill) % 10,
            stats.apply_result_applied, total);
+  log_test("CMA: changes skipped as irrelevant: %d", stats.state_unchanged);
 #endif /* SHOW_TIME_STATS */
 }
 
@@ -448,10 +518,34 @@ static void handle_city(struct city *pcity)
 static void city_changed(int city_id)
 {
   struct city *pcity = game_city_by_number(city_id);
+  struct cm_parameter parameter;
 
   if (pcity) {
+    if (pcity == check_city(city_id, &parameter)) {
+      unsigned int fingerprint = city_state_fingerprint(pcity, &parameter);
+      int stored;
+
+      if (city_state_hash_lookup(state_hash, city_id, &stored)
+          && (unsigned int) stored == fingerprint) {
+        /* Nothing the solver cares about has changed since we last left
+         * the city in the wanted state. */
+        stats.state_unchanged++;
+        return;
+      }
+    }
+
     cm_clear_cache(pcity);
     handle_city(pcity);
+
+    /* Remember the state we left behind; while it lasts, further change
+     * notifications for this city are no-ops. */
+    if (pcity == check_city(city_id, &parameter)) {
+      city_state_hash_replace(state_hash, city_id,
+                              (int) city_state_fingerprint(pcity,
+                                                           &parameter));
+    } else {
+      city_state_hash_remove(state_hash, city_id);
+    }
   }
 }
 
@@ -460,6 +554,7 @@ static void city_changed(int city_id)
 ****************************************************************************/
 static void city_remove(int city_id)
 {
+  city_state_hash_remove(state_hash, city_id);
   release_city(city_id);
 }
 
@@ -494,6 +589,13 @@ void cma_init(void)
   stats.wall_timer = timer_renew(timer, TIMER_USER, TIMER_ACTIVE,
                                  timer != NULL ? NULL : "agent: stats");
 
+  /* Like the timer, the state hash survives repeated cma_init() calls. */
+  if (state_hash == NULL) {
+    state_hash = city_state_hash_new();
+  } else {
+    city_state_hash_clear(state_hash);
+  }
+
   memset(&self, 0, sizeof(self));
   strcpy(self.name, "CMA");
   self.level = 1;
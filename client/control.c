@@ -649,6 +649,8 @@ void unit_focus_set_and_select(struct unit *punit)
 static struct unit *find_best_focus_candidate(bool accept_current)
 {
   struct tile *ptile = get_center_tile_mapcanvas();
+  struct unit *best = NULL;
+  int best_dist = FC_INFINITY;
 
   if (!get_focus_unit_on_tile(ptile)) {
     struct unit *pfirst = head_of_units_in_focus();
@@ -658,22 +660,27 @@ static struct unit *find_best_focus_candidate(bool accept_current)
     }
   }
 
-  iterate_outward(&(wld.map), ptile, FC_INFINITY, ptile2) {
-    unit_list_iterate(ptile2->units, punit) {
-      if ((!unit_is_in_focus(punit) || accept_current)
-          && unit_owner(punit) == client.conn.playing
-          && punit->client.focus_status == FOCUS_AVAIL
-          && punit->activity == ACTIVITY_IDLE
-          && !unit_has_orders(punit)
-          && (punit->moves_left > 0 || unit_type_get(punit)->move_rate == 0)
-          && !punit->done_moving
-          && punit->ssa_controller == SSA_NONE) {
-        return punit;
+  /* Scan the player's own unit list, which the unit packet handlers keep
+   * up to date, instead of walking every tile of the map outward from
+   * ptile; only own units can qualify anyway. */
+  unit_list_iterate(client.conn.playing->units, punit) {
+    if ((!unit_is_in_focus(punit) || accept_current)
+        && punit->client.focus_status == FOCUS_AVAIL
+        && punit->activity == ACTIVITY_IDLE
+        && !unit_has_orders(punit)
+        && (punit->moves_left > 0 || unit_type_get(punit)->move_rate == 0)
+        && !punit->done_moving
+        && punit->ssa_controller == SSA_NONE) {
+      int dist = sq_map_distance(unit_tile(punit), ptile);
+
+      if (dist < best_dist) {
+        best_dist = dist;
+        best = punit;
       }
-    } unit_list_iterate_end;
-  } iterate_outward_end;
+    }
+  } unit_list_iterate_end;
 
-  return NULL;
+  return best;
 }
 
 /**********************************************************************//**
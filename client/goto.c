@@ -26,6 +26,7 @@
 #include "map.h"
 #include "movement.h"
 #include "packets.h"
+#include "pf_hier.h"
 #include "pf_tools.h"
 #include "road.h"
 #include "unit.h"
@@ -172,6 +173,9 @@ void free_client_goto(void)
 
   goto_destination = nullptr;
   goto_warned = FALSE;
+
+  /* The warm maps are useless once the map info changes. */
+  pf_map_cache_free();
 }
 
 /************************************************************************//**
@@ -462,7 +466,10 @@ static void add_part(struct goto_map *goto_map)
   p->path = nullptr;
   p->end_tile = p->start_tile;
   parameter.start_tile = p->start_tile;
-  p->map = pf_map_new(&parameter);
+  /* Goes through the shared cache, so re-entering goto mode with an
+   * unchanged unit reuses the warm map and successive destination
+   * hovers are pure lookups. */
+  p->map = pf_map_cache_get(&parameter);
 }
 
 /************************************************************************//**
@@ -479,7 +486,7 @@ static void remove_last_part(struct goto_map *goto_map)
     /* We do not always have a path */
     pf_path_destroy(p->path);
   }
-  pf_map_destroy(p->map);
+  pf_map_cache_put(p->map);
   goto_map->num_parts--;
 }
 
@@ -1569,13 +1576,10 @@ static void send_rally_path(struct city *pcity, struct unit *punit,
 bool send_goto_tile(struct unit *punit, struct tile *ptile)
 {
   struct pf_parameter parameter;
-  struct pf_map *pfm;
   struct pf_path *path;
 
   goto_fill_parameter_base(&parameter, punit);
-  pfm = pf_map_new(&parameter);
-  path = pf_map_path(pfm, ptile);
-  pf_map_destroy(pfm);
+  path = pf_hier_map_path(&parameter, ptile);
 
   if (path != nullptr) {
     send_goto_path(punit, path, nullptr);
@@ -1595,7 +1599,6 @@ bool send_rally_tile(struct city *pcity, struct tile *ptile, bool persistent)
   const struct unit_type *putype;
   struct unit *punit;
   struct pf_parameter parameter;
-  struct pf_map *pfm;
   struct pf_path *path;
 
   fc_assert_ret_val(pcity != nullptr, FALSE);
@@ -1614,9 +1617,7 @@ bool send_rally_tile(struct city *pcity, struct tile *ptile, bool persistent)
 
   /* Use the unit to find a path to the destination tile. */
   goto_fill_parameter_base(&parameter, punit);
-  pfm = pf_map_new(&parameter);
-  path = pf_map_path(pfm, ptile);
-  pf_map_destroy(pfm);
+  path = pf_hier_map_path(&parameter, ptile);
 
   if (path != nullptr) {
     /* Send orders to server. */
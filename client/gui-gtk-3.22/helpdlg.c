@@ -915,7 +915,8 @@ static void help_update_improvement(const struct help_item *pitem,
 
   gtk_widget_show(help_itable);
 
-  helptext_building(buf, sizeof(buf), client.conn.playing, pitem->text, imp);
+  helptext_building(buf, sizeof(buf), client.conn.playing,
+                    help_item_get_text(pitem), imp);
   gtk_text_buffer_set_text(help_text, buf, -1);
   gtk_widget_show(help_text_sw);
 }
@@ -977,7 +978,8 @@ static void help_update_wonder(const struct help_item *pitem,
 
   gtk_widget_show(help_wtable);
 
-  helptext_building(buf, sizeof(buf), client.conn.playing, pitem->text, imp);
+  helptext_building(buf, sizeof(buf), client.conn.playing,
+                    help_item_get_text(pitem), imp);
   gtk_text_buffer_set_text(help_text, buf, -1);
   gtk_widget_show(help_text_sw);
 }
@@ -1018,7 +1020,8 @@ static void help_update_unit_type(const struct help_item *pitem,
 			 utype_name_translation(utype->obsoleted_by));
     }
 
-    helptext_unit(buf, sizeof(buf), client.conn.playing, pitem->text, utype,
+    helptext_unit(buf, sizeof(buf), client.conn.playing,
+                  help_item_get_text(pitem), utype,
                   TRUE);
 
     gtk_text_buffer_set_text(help_text, buf, -1);
@@ -1092,7 +1095,8 @@ static void help_update_tech(const struct help_item *pitem, char *title)
     gtk_widget_show(help_tree_sw);
     gtk_widget_show(help_tree_buttons_hbox);
 
-    helptext_advance(buf, sizeof(buf), client.conn.playing, pitem->text, i);
+    helptext_advance(buf, sizeof(buf), client.conn.playing,
+                     help_item_get_text(pitem), i);
     len = strlen(buf);
     fc_chomp(buf, len);
 
@@ -1389,7 +1393,8 @@ static void help_update_terrain(const struct help_item *pitem,
     gtk_widget_show(help_vbox);
   }
 
-  helptext_terrain(buf, sizeof(buf), client.conn.playing, pitem->text, pterrain);
+  helptext_terrain(buf, sizeof(buf), client.conn.playing,
+                   help_item_get_text(pitem), pterrain);
 
   gtk_text_buffer_set_text(help_text, buf, -1);
   gtk_widget_show(help_text_sw);
@@ -1407,7 +1412,7 @@ static void help_update_extra(const struct help_item *pitem, char *title)
 
   buf[0] = '\0';
   if (pextra == NULL) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
     struct road_type *proad = extra_road_get(pextra);
     bool is_resource = is_extra_caused_by(pextra, EC_RESOURCE);
@@ -1471,7 +1476,8 @@ static void help_update_extra(const struct help_item *pitem, char *title)
       gtk_widget_set_visible(GTK_WIDGET(help_elabel[5]), FALSE);
     }
 
-    helptext_extra(buf, sizeof(buf), client.conn.playing, pitem->text, pextra);
+    helptext_extra(buf, sizeof(buf), client.conn.playing,
+                   help_item_get_text(pitem), pextra);
   }
   gtk_widget_show(help_etable);
 
@@ -1489,9 +1495,10 @@ static void help_update_goods(const struct help_item *pitem,
   struct goods_type *pgood = goods_by_translated_name(title);
 
   if (!pgood) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
-    helptext_goods(buf, sizeof(buf), client.conn.playing, pitem->text,
+    helptext_goods(buf, sizeof(buf), client.conn.playing,
+                   help_item_get_text(pitem),
                    pgood);
   }
 
@@ -1509,9 +1516,10 @@ static void help_update_specialist(const struct help_item *pitem,
   struct specialist *pspec = specialist_by_translated_name(title);
 
   if (!pspec) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
-    helptext_specialist(buf, sizeof(buf), client.conn.playing, pitem->text,
+    helptext_specialist(buf, sizeof(buf), client.conn.playing,
+                        help_item_get_text(pitem),
                         pspec);
   }
 
@@ -1529,9 +1537,10 @@ static void help_update_government(const struct help_item *pitem,
   struct government *gov = government_by_translated_name(title);
 
   if (!gov) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
-    helptext_government(buf, sizeof(buf), client.conn.playing, pitem->text, gov);
+    helptext_government(buf, sizeof(buf), client.conn.playing,
+                        help_item_get_text(pitem), gov);
   }
 
   gtk_text_buffer_set_text(help_text, buf, -1);
@@ -1547,9 +1556,9 @@ static void help_update_nation(const struct help_item *pitem, char *title,
   char buf[4096];
 
   if (!pnation) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
-    helptext_nation(buf, sizeof(buf), pnation, pitem->text);
+    helptext_nation(buf, sizeof(buf), pnation, help_item_get_text(pitem));
 
     set_help_tile_from_sprite(get_nation_flag_sprite(tileset, pnation));
   }
@@ -1608,7 +1617,7 @@ static void help_update_dialog(const struct help_item *pitem)
   case HELP_TEXT:
   default:
     /* It was a pure text item */
-    gtk_text_buffer_set_text(help_text, pitem->text, -1);
+    gtk_text_buffer_set_text(help_text, help_item_get_text(pitem), -1);
     gtk_widget_show(help_text_sw);
     break;
   }
@@ -944,7 +944,8 @@ static void help_update_improvement(const struct help_item *pitem,
 
   gtk_widget_set_visible(help_itable, TRUE);
 
-  helptext_building(buf, sizeof(buf), client_player(), pitem->text, imp);
+  helptext_building(buf, sizeof(buf), client_player(),
+                    help_item_get_text(pitem), imp);
   gtk_text_buffer_set_text(help_text, buf, -1);
   gtk_widget_set_visible(help_text_sw, TRUE);
 }
@@ -1006,7 +1007,8 @@ static void help_update_wonder(const struct help_item *pitem,
 
   gtk_widget_set_visible(help_wtable, TRUE);
 
-  helptext_building(buf, sizeof(buf), client_player(), pitem->text, imp);
+  helptext_building(buf, sizeof(buf), client_player(),
+                    help_item_get_text(pitem), imp);
   gtk_text_buffer_set_text(help_text, buf, -1);
   gtk_widget_set_visible(help_text_sw, TRUE);
 }
@@ -1053,7 +1055,8 @@ static void help_update_unit_type(const struct help_item *pitem,
                          utype_name_translation(utype->obsoleted_by));
     }
 
-    helptext_unit(buf, sizeof(buf), client_player(), pitem->text, utype,
+    helptext_unit(buf, sizeof(buf), client_player(),
+                  help_item_get_text(pitem), utype,
                   TRUE);
 
     gtk_text_buffer_set_text(help_text, buf, -1);
@@ -1131,7 +1134,8 @@ static void help_update_tech(const struct help_item *pitem, char *title)
     gtk_widget_set_visible(help_tree_sw, TRUE);
     gtk_widget_set_visible(help_tree_buttons_hbox, TRUE);
 
-    helptext_advance(buf, sizeof(buf), client.conn.playing, pitem->text, i);
+    helptext_advance(buf, sizeof(buf), client.conn.playing,
+                     help_item_get_text(pitem), i);
     len = strlen(buf);
     fc_chomp(buf, len);
 
@@ -1435,7 +1439,7 @@ static void help_update_terrain(const struct help_item *pitem,
   }
 
   helptext_terrain(buf, sizeof(buf), client.conn.playing,
-                   pitem->text, pterrain);
+                   help_item_get_text(pitem), pterrain);
 
   gtk_text_buffer_set_text(help_text, buf, -1);
   gtk_widget_set_visible(help_text_sw, TRUE);
@@ -1453,7 +1457,7 @@ static void help_update_extra(const struct help_item *pitem, char *title)
 
   buf[0] = '\0';
   if (pextra == NULL) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
     struct road_type *proad = extra_road_get(pextra);
     bool is_resource = is_extra_caused_by(pextra, EC_RESOURCE);
@@ -1518,7 +1522,8 @@ static void help_update_extra(const struct help_item *pitem, char *title)
       gtk_widget_set_visible(GTK_WIDGET(help_elabel[5]), FALSE);
     }
 
-    helptext_extra(buf, sizeof(buf), client.conn.playing, pitem->text, pextra);
+    helptext_extra(buf, sizeof(buf), client.conn.playing,
+                   help_item_get_text(pitem), pextra);
   }
   gtk_widget_set_visible(help_etable, TRUE);
 
@@ -1536,9 +1541,10 @@ static void help_update_goods(const struct help_item *pitem,
   struct goods_type *pgood = goods_by_translated_name(title);
 
   if (pgood == nullptr) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
-    helptext_goods(buf, sizeof(buf), client.conn.playing, pitem->text,
+    helptext_goods(buf, sizeof(buf), client.conn.playing,
+                   help_item_get_text(pitem),
                    pgood);
   }
 
@@ -1556,9 +1562,10 @@ static void help_update_specialist(const struct help_item *pitem,
   struct specialist *pspec = specialist_by_translated_name(title);
 
   if (pspec == nullptr) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
-    helptext_specialist(buf, sizeof(buf), client.conn.playing, pitem->text,
+    helptext_specialist(buf, sizeof(buf), client.conn.playing,
+                        help_item_get_text(pitem),
                         pspec);
   }
 
@@ -1576,10 +1583,10 @@ static void help_update_government(const struct help_item *pitem,
   struct government *gov = government_by_translated_name(title);
 
   if (gov == nullptr) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
     helptext_government(buf, sizeof(buf), client.conn.playing,
-                        pitem->text, gov);
+                        help_item_get_text(pitem), gov);
   }
 
   gtk_text_buffer_set_text(help_text, buf, -1);
@@ -1595,9 +1602,9 @@ static void help_update_nation(const struct help_item *pitem, char *title,
   char buf[4096];
 
   if (pnation == nullptr) {
-    strcat(buf, pitem->text);
+    strcat(buf, help_item_get_text(pitem));
   } else {
-    helptext_nation(buf, sizeof(buf), pnation, pitem->text);
+    helptext_nation(buf, sizeof(buf), pnation, help_item_get_text(pitem));
 
     set_help_tile_from_sprite(get_nation_flag_sprite(tileset, pnation));
   }
@@ -1656,7 +1663,7 @@ static void help_update_dialog(const struct help_item *pitem)
   case HELP_TEXT:
   default:
     /* It was a pure text item */
-    gtk_text_buffer_set_text(help_text, pitem->text, -1);
+    gtk_text_buffer_set_text(help_text, help_item_get_text(pitem), -1);
     gtk_widget_set_visible(help_text_sw, TRUE);
     break;
   }
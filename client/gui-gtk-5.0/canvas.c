@@ -176,6 +176,29 @@ void canvas_put_sprite_fogged(struct canvas *pcanvas,
                                psprite, fog);
 }
 
+/************************************************************************//**
+  Draw a batch of full sprites onto the canvas, in array order. This
+  implementation simply loops; the mapview canvas already keeps a cairo
+  context open between draws.
+****************************************************************************/
+void canvas_put_sprite_batch(struct canvas *pcanvas,
+                             const struct canvas_sprite_draw *draws,
+                             int ndraws)
+{
+  int i;
+
+  for (i = 0; i < ndraws; i++) {
+    if (draws[i].fog) {
+      canvas_put_sprite_fogged(pcanvas, draws[i].canvas_x,
+                               draws[i].canvas_y, draws[i].sprite,
+                               TRUE, draws[i].canvas_x, draws[i].canvas_y);
+    } else {
+      canvas_put_sprite_full(pcanvas, draws[i].canvas_x, draws[i].canvas_y,
+                             draws[i].sprite);
+    }
+  }
+}
+
 /************************************************************************//**
   Draw a filled-in colored rectangle onto the mapview or citydialog canvas.
   Supplied coordinates are prior to any canvas zoom.
@@ -2743,6 +2743,8 @@ GtkApplication *gui_app(void)
 void setup_gui_properties(void)
 {
   gui_properties.animations = TRUE;
+  /* gdk-pixbuf can decode image files off the gui thread. */
+  gui_properties.threaded_sprite_decode = TRUE;
   gui_properties.views.isometric = TRUE;
   gui_properties.views.overhead = TRUE;
 #ifdef GTK3_3D_ENABLED
@@ -604,6 +604,8 @@ void qtg_insert_client_build_info(char *outbuf, size_t outlen)
 void qtg_setup_gui_properties()
 {
   gui_properties.animations = FALSE;
+  /* QPixmap may only be used from the gui thread. */
+  gui_properties.threaded_sprite_decode = FALSE;
   gui_properties.views.isometric = TRUE;
   gui_properties.views.overhead = TRUE;
   gui_properties.views.d3 = FALSE;
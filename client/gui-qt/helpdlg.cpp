@@ -864,11 +864,7 @@ void help_widget::set_bottom_panel(QWidget *widget) {
 void help_widget::set_topic_other(const help_item *topic,
                                     const char *title)
 {
-  if (topic->text) {
-    text_browser->setPlainText(topic->text);
-  } else {
-    text_browser->setPlainText(""); // Something better to do ?
-  }
+  text_browser->setPlainText(help_item_get_text(topic));
 }
 
 /**********************************************************************//**
@@ -889,7 +885,7 @@ void help_widget::set_topic_unit(const help_item *topic,
   utype = unit_type_by_translated_name(title);
   if (utype) {
     helptext_unit(buffer, sizeof(buffer), client.conn.playing,
-                  topic->text, utype, TRUE);
+                  help_item_get_text(topic), utype, TRUE);
     text_browser->setPlainText(buffer);
 
     // Create information panel
@@ -1012,7 +1008,7 @@ void help_widget::set_topic_building(const help_item *topic,
 
   if (itype) {
     helptext_building(buffer, sizeof(buffer), client.conn.playing,
-                      topic->text, itype);
+                      help_item_get_text(topic), itype);
     text_browser->setPlainText(buffer);
     show_info_panel();
     spr = get_building_sprite(tileset, itype);
@@ -1191,7 +1187,7 @@ void help_widget::set_topic_tech(const help_item *topic,
 
     info_panel_done();
     helptext_advance(buffer, sizeof(buffer), client.conn.playing,
-                     topic->text, n);
+                     help_item_get_text(topic), n);
     text_browser->setPlainText(buffer);
   } else {
     set_topic_other(topic, title);
@@ -1306,7 +1302,7 @@ void help_widget::set_topic_terrain(const help_item *topic,
     for_terr.value.terrain = pterrain;
 
     helptext_terrain(buffer, sizeof(buffer), client.conn.playing,
-                     topic->text, pterrain);
+                     help_item_get_text(topic), pterrain);
     text_browser->setPlainText(buffer);
 
     // Create information panel
@@ -1483,7 +1479,7 @@ bool help_widget::set_topic_extra(const help_item *topic,
     struct drawn_sprite sprs[80];
 
     helptext_extra(buffer, sizeof(buffer), client.conn.playing,
-                  topic->text, pextra);
+                  help_item_get_text(topic), pextra);
     text_browser->setPlainText(buffer);
 
     // Create information panel
@@ -1518,7 +1514,7 @@ void help_widget::set_topic_specialist(const help_item *topic,
   struct specialist *pspec = specialist_by_translated_name(title);
   if (pspec) {
     helptext_specialist(buffer, sizeof(buffer), client.conn.playing,
-                        topic->text, pspec);
+                        help_item_get_text(topic), pspec);
     text_browser->setPlainText(buffer);
   } else {
     set_topic_other(topic, title);
@@ -1535,7 +1531,7 @@ void help_widget::set_topic_government(const help_item *topic,
   struct government *pgov = government_by_translated_name(title);
   if (pgov) {
     helptext_government(buffer, sizeof(buffer), client.conn.playing,
-                        topic->text, pgov);
+                        help_item_get_text(topic), pgov);
     text_browser->setPlainText(buffer);
   } else {
     set_topic_other(topic, title);
@@ -1551,7 +1547,8 @@ void help_widget::set_topic_nation(const help_item *topic,
   char buffer[MAX_HELP_TEXT_SIZE];
   struct nation_type *pnation = nation_by_translated_plural(title);
   if (pnation) {
-    helptext_nation(buffer, sizeof(buffer), pnation, topic->text);
+    helptext_nation(buffer, sizeof(buffer), pnation,
+                    help_item_get_text(topic));
     text_browser->setPlainText(buffer);
   } else {
     set_topic_other(topic, title);
@@ -1568,7 +1565,7 @@ void help_widget::set_topic_goods(const help_item* topic,
   struct goods_type *pgood = goods_by_translated_name(title);
   if (pgood) {
     helptext_goods(buffer, sizeof(buffer), client.conn.playing,
-                   topic->text, pgood);
+                   help_item_get_text(topic), pgood);
     text_browser->setText(buffer);
   } else {
     set_topic_other(topic, title);
@@ -61,6 +61,7 @@ void setup_gui_funcs()
   funcs->canvas_put_sprite_full = qtg_canvas_put_sprite_full;
   funcs->canvas_put_sprite_full_scaled = qtg_canvas_put_sprite_full_scaled;
   funcs->canvas_put_sprite_fogged = qtg_canvas_put_sprite_fogged;
+  funcs->canvas_put_sprite_batch = qtg_canvas_put_sprite_batch;
   funcs->canvas_put_rectangle = qtg_canvas_put_rectangle;
   funcs->canvas_fill_sprite_area = qtg_canvas_fill_sprite_area;
   funcs->canvas_put_line = qtg_canvas_put_line;
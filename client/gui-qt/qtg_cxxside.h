@@ -77,6 +77,9 @@ void qtg_canvas_put_sprite_fogged(struct canvas *pcanvas,
                                   int canvas_x, int canvas_y,
                                   struct sprite *psprite,
                                   bool fog, int fog_x, int fog_y);
+void qtg_canvas_put_sprite_batch(struct canvas *pcanvas,
+                                 const struct canvas_sprite_draw *draws,
+                                 int ndraws);
 void qtg_canvas_put_rectangle(struct canvas *pcanvas,
                               struct color *pcolor,
                               int canvas_x, int canvas_y,
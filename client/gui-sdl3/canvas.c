@@ -148,6 +148,23 @@ void canvas_put_sprite_fogged(struct canvas *pcanvas,
   }
 }
 
+/**********************************************************************//**
+  Draw a batch of full sprites onto the canvas, in array order.
+**************************************************************************/
+void canvas_put_sprite_batch(struct canvas *pcanvas,
+                             const struct canvas_sprite_draw *draws,
+                             int ndraws)
+{
+  int i;
+
+  for (i = 0; i < ndraws; i++) {
+    SDL_Rect dst = {draws[i].canvas_x, draws[i].canvas_y, 0, 0};
+
+    alphablit(GET_SURF(draws[i].sprite), NULL, pcanvas->surf, &dst,
+              draws[i].fog ? 160 : 255);
+  }
+}
+
 /**********************************************************************//**
   Draw a filled-in colored rectangle onto canvas.
 **************************************************************************/
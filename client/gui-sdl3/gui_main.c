@@ -1359,6 +1359,8 @@ bool flush_event(void)
 void setup_gui_properties(void)
 {
   gui_properties.animations = FALSE;
+  /* Plain surfaces; IMG_Load() is safe off the main thread. */
+  gui_properties.threaded_sprite_decode = TRUE;
   gui_properties.views.isometric = TRUE;
   gui_properties.views.overhead = TRUE;
   gui_properties.views.d3 = FALSE;
@@ -115,6 +115,30 @@ void gui_canvas_put_sprite_fogged(struct canvas *pcanvas,
   /* PORTME */
 }
 
+/************************************************************************//**
+  Draw a batch of full sprites onto the canvas, in array order. A port
+  can draw the whole batch with one paint setup instead of one per
+  sprite; this fallback just loops.
+****************************************************************************/
+void gui_canvas_put_sprite_batch(struct canvas *pcanvas,
+                                 const struct canvas_sprite_draw *draws,
+                                 int ndraws)
+{
+  int i;
+
+  for (i = 0; i < ndraws; i++) {
+    if (draws[i].fog) {
+      gui_canvas_put_sprite_fogged(pcanvas, draws[i].canvas_x,
+                                   draws[i].canvas_y, draws[i].sprite,
+                                   TRUE, draws[i].canvas_x,
+                                   draws[i].canvas_y);
+    } else {
+      gui_canvas_put_sprite_full(pcanvas, draws[i].canvas_x,
+                                 draws[i].canvas_y, draws[i].sprite);
+    }
+  }
+}
+
 /************************************************************************//**
   Draw a filled-in colored rectangle onto canvas.
 ****************************************************************************/
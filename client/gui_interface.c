@@ -275,6 +275,16 @@ void canvas_put_sprite_fogged(struct canvas *pcanvas,
                                  psprite, fog, fog_x, fog_y);
 }
 
+/**********************************************************************//**
+  Call canvas_put_sprite_batch callback
+**************************************************************************/
+void canvas_put_sprite_batch(struct canvas *pcanvas,
+                             const struct canvas_sprite_draw *draws,
+                             int ndraws)
+{
+  funcs.canvas_put_sprite_batch(pcanvas, draws, ndraws);
+}
+
 /**********************************************************************//**
   Call canvas_put_rectangle callback
 **************************************************************************/
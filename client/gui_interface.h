@@ -85,6 +85,9 @@ struct gui_funcs {
                                    int canvas_x, int canvas_y,
                                    struct sprite *psprite,
                                    bool fog, int fog_x, int fog_y);
+  void (*canvas_put_sprite_batch)(struct canvas *pcanvas,
+                                  const struct canvas_sprite_draw *draws,
+                                  int ndraws);
   void (*canvas_put_rectangle)(struct canvas *pcanvas,
                                struct color *pcolor,
                                int canvas_x, int canvas_y,
@@ -19,6 +19,10 @@ extern "C" {
 
 struct client_properties {
   bool animations;
+  /* TRUE if load_gfxfile() may be called from worker threads while the
+   * tileset loads. Leave FALSE when the gui's image objects are tied to
+   * the gui thread. */
+  bool threaded_sprite_decode;
   struct {
     bool isometric;
     bool overhead;
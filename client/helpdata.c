@@ -126,8 +126,14 @@ void free_help_texts(void)
 {
   check_help_nodes_init();
   help_list_iterate(help_nodes, ptmp) {
+    int i;
+
     free(ptmp->topic);
     free(ptmp->text);
+    for (i = 0; i < ptmp->npara; i++) {
+      free(ptmp->paras[i]);
+    }
+    free(ptmp->paras);
     free(ptmp);
   } help_list_iterate_end;
   help_list_clear(help_nodes);
@@ -735,10 +741,47 @@ static struct help_item *new_help_item(int type)
   pitem->topic = NULL;
   pitem->text = NULL;
   pitem->type = type;
+  pitem->paras = NULL;
+  pitem->npara = 0;
 
   return pitem;
 }
 
+/************************************************************************//**
+  Generate the text of a help item whose raw helpdata.txt paragraphs were
+  stored at boot time. Translation and expansion of "$" paragraphs happen
+  here, so topics nobody opens never pay for them.
+****************************************************************************/
+static void generate_help_text(struct help_item *pitem)
+{
+  char long_buffer[64000]; /* HACK: this may be overrun. */
+  int i;
+
+  long_buffer[0] = '\0';
+  for (i = 0; i < pitem->npara; i++) {
+    bool inserted;
+    const char *para = pitem->paras[i];
+
+    if (!fc_strncmp(para, "$", 1)) {
+      inserted
+        = insert_generated_text(long_buffer, sizeof(long_buffer), para + 1);
+    } else {
+      sz_strlcat(long_buffer, _(para));
+      inserted = TRUE;
+    }
+    if (inserted && i != pitem->npara - 1) {
+      sz_strlcat(long_buffer, "\n\n");
+    }
+  }
+
+  for (i = 0; i < pitem->npara; i++) {
+    free(pitem->paras[i]);
+  }
+  FC_FREE(pitem->paras);
+  pitem->npara = 0;
+  pitem->text = fc_strdup(long_buffer);
+}
+
 /************************************************************************//**
   For help_list_sort(); sort by topic via compare_strings()
   (sort topics with more leading spaces after those with fewer)
@@ -776,7 +819,6 @@ void boot_help_texts(void)
   struct section_list *sec;
   const char **paras;
   size_t npara;
-  char long_buffer[64000]; /* HACK: this may be overrun. */
 
   check_help_nodes_init();
 
@@ -1268,25 +1310,18 @@ void boot_help_texts(void)
 
       paras = secfile_lookup_str_vec(sf, &npara, "%s.text", sec_name);
 
-      long_buffer[0] = '\0';
-      for (i = 0; i < npara; i++) {
-        bool inserted;
-        const char *para = paras[i];
-
-        if (!fc_strncmp(para, "$", 1)) {
-          inserted
-            = insert_generated_text(long_buffer, sizeof(long_buffer), para+1);
-        } else {
-          sz_strlcat(long_buffer, _(para));
-          inserted = TRUE;
-        }
-        if (inserted && i != npara - 1) {
-          sz_strlcat(long_buffer, "\n\n");
+      /* Store the raw paragraphs only; the translated and expanded text
+       * is generated by help_item_get_text() when the topic is first
+       * opened. */
+      pitem->npara = npara;
+      if (npara > 0) {
+        pitem->paras = fc_malloc(npara * sizeof(pitem->paras[0]));
+        for (i = 0; i < npara; i++) {
+          pitem->paras[i] = fc_strdup(paras[i]);
         }
       }
       free(paras);
       paras = NULL;
-      pitem->text = fc_strdup(long_buffer);
       help_list_append(help_nodes, pitem);
     } section_list_iterate_end;
 
@@ -1389,6 +1424,24 @@ get_help_item_spec(const char *name, enum help_page_type htype, int *pos)
   return pitem;
 }
 
+/************************************************************************//**
+  Return the text of a help item, generating it on first access.
+  pitem->text may still be NULL for topics that have never been opened;
+  always go through this function instead of reading the field directly.
+****************************************************************************/
+const char *help_item_get_text(const struct help_item *pitem)
+{
+  /* Deferred generation is just a cache fill, so keep the const
+   * interface the callers expect. */
+  struct help_item *item = (struct help_item *) pitem;
+
+  if (item->text == NULL) {
+    generate_help_text(item);
+  }
+
+  return item->text;
+}
+
 /************************************************************************//**
   Start iterating through help items;
   that is, reset iterator to start position.
@@ -25,6 +25,11 @@ extern "C" {
 struct help_item {
   char *topic, *text;
   enum help_page_type type;
+  /* Raw helpdata.txt paragraphs for text that has not been generated
+   * yet; private to helpdata.c. Use help_item_get_text() instead of
+   * reading the text field directly, as the latter may still be NULL. */
+  char **paras;
+  size_t npara;
 };
 
 void helpdata_init(void);
@@ -38,6 +43,7 @@ const struct help_item *get_help_item(int pos);
 const struct help_item *get_help_item_spec(const char *name,
                                            enum help_page_type htype,
                                            int *pos);
+const char *help_item_get_text(const struct help_item *pitem);
 void help_iter_start(void);
 const struct help_item *help_iter_next(void);
 
@@ -52,6 +52,17 @@ GUI_FUNC_PROTO(void, canvas_put_sprite_fogged, struct canvas *pcanvas,
                int canvas_x, int canvas_y,
                struct sprite *psprite,
                bool fog, int fog_x, int fog_y)
+
+/* One full-sprite draw within a batch handed to canvas_put_sprite_batch().
+ * Draws must be performed in array order. */
+struct canvas_sprite_draw {
+  struct sprite *sprite;
+  int canvas_x, canvas_y;
+  bool fog;             /* Draw darkened, as canvas_put_sprite_fogged() */
+};
+
+GUI_FUNC_PROTO(void, canvas_put_sprite_batch, struct canvas *pcanvas,
+               const struct canvas_sprite_draw *draws, int ndraws)
 GUI_FUNC_PROTO(void, canvas_put_rectangle, struct canvas *pcanvas,
                struct color *pcolor,
                int canvas_x, int canvas_y, int width, int height)
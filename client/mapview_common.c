@@ -16,8 +16,10 @@
 #endif
 
 /* utility */
+#include "astring.h"
 #include "fcintl.h"
 #include "log.h"
+#include "mem.h"
 #include "rand.h"
 #include "support.h"
 #include "timing.h"
@@ -127,6 +129,28 @@ static const int MAX_TRADE_ROUTE_DRAW_LINES = 2;
 
 static struct timer *anim_timer = NULL;
 
+/* Frame-time instrumentation behind the draw_frame_stats option. A
+ * frame is one unqueue_mapview_updates() pass: the fill timer covers
+ * the fill_sprite_array() calls deciding what to draw, the flush timer
+ * the push of the backing store to the screen, and the frame timer the
+ * whole pass. Frame times also go into a power-of-two millisecond
+ * histogram that is logged when the option is switched off again. */
+#define FRAME_STATS_BUCKETS 9
+static struct {
+  bool frame_open;              /* Between begin and end of a frame */
+  struct timer *frame_timer;
+  struct timer *fill_timer;
+  struct timer *flush_timer;
+  struct timer *rate_timer;     /* Time between frame completions */
+  double last_frame_ms;         /* Last completed frame, for overlay */
+  double last_fill_ms;
+  double last_flush_ms;
+  double last_interval;         /* Seconds since the previous frame */
+  double total_ms;
+  int frames;
+  int histogram[FRAME_STATS_BUCKETS];  /* <1ms, <2ms, ... >=128ms */
+} frame_stats;
+
 enum animation_type { ANIM_MOVEMENT, ANIM_BATTLE, ANIM_EXPL, ANIM_NUKE };
 
 struct animation
@@ -226,6 +250,129 @@ static void anim_timer_renew(void)
   timer_start(anim_timer);
 }
 
+/************************************************************************//**
+  Log the frame-time histogram collected so far and restart it.
+****************************************************************************/
+static void frame_stats_log(void)
+{
+  struct astring line = ASTRING_INIT;
+  int i;
+
+  if (frame_stats.frames == 0) {
+    return;
+  }
+
+  astr_set(&line, "frame-stats: frames=%d avg=%.1fms buckets(ms)",
+           frame_stats.frames, frame_stats.total_ms / frame_stats.frames);
+  for (i = 0; i < FRAME_STATS_BUCKETS; i++) {
+    if (i < FRAME_STATS_BUCKETS - 1) {
+      astr_add(&line, " <%d:%d", 1 << i, frame_stats.histogram[i]);
+    } else {
+      astr_add(&line, " >=%d:%d", 1 << (i - 1), frame_stats.histogram[i]);
+    }
+  }
+  log_normal("%s", astr_str(&line));
+  astr_free(&line);
+
+  frame_stats.frames = 0;
+  frame_stats.total_ms = 0.0;
+  memset(frame_stats.histogram, 0, sizeof(frame_stats.histogram));
+}
+
+/************************************************************************//**
+  Open a frame measurement if the option is on; the timers are created
+  on first use. When the option has just been switched off, dump the
+  histogram collected while it was on.
+****************************************************************************/
+static void frame_stats_begin(void)
+{
+  if (!gui_options.draw_frame_stats) {
+    frame_stats_log();
+    return;
+  }
+
+  if (frame_stats.frame_timer == NULL) {
+    frame_stats.frame_timer = timer_new(TIMER_USER, TIMER_ACTIVE, "frame");
+    frame_stats.fill_timer = timer_new(TIMER_USER, TIMER_ACTIVE,
+                                       "frame fill");
+    frame_stats.flush_timer = timer_new(TIMER_USER, TIMER_ACTIVE,
+                                        "frame flush");
+    frame_stats.rate_timer = timer_new(TIMER_USER, TIMER_ACTIVE,
+                                       "frame rate");
+    timer_start(frame_stats.rate_timer);
+  }
+
+  timer_clear(frame_stats.frame_timer);
+  timer_start(frame_stats.frame_timer);
+  timer_clear(frame_stats.fill_timer);
+  timer_clear(frame_stats.flush_timer);
+  frame_stats.frame_open = TRUE;
+}
+
+/************************************************************************//**
+  Close the frame measurement: record the completed frame for the
+  overlay and the histogram.
+****************************************************************************/
+static void frame_stats_end(void)
+{
+  double ms;
+  int bucket = 0;
+
+  if (!frame_stats.frame_open) {
+    return;
+  }
+  frame_stats.frame_open = FALSE;
+
+  timer_stop(frame_stats.frame_timer);
+  ms = timer_read_seconds(frame_stats.frame_timer) * 1000.0;
+  frame_stats.last_frame_ms = ms;
+  frame_stats.last_fill_ms
+    = timer_read_seconds(frame_stats.fill_timer) * 1000.0;
+  frame_stats.last_flush_ms
+    = timer_read_seconds(frame_stats.flush_timer) * 1000.0;
+
+  frame_stats.last_interval = timer_read_seconds(frame_stats.rate_timer);
+  timer_clear(frame_stats.rate_timer);
+  timer_start(frame_stats.rate_timer);
+
+  while (bucket < FRAME_STATS_BUCKETS - 1 && ms >= (1 << bucket)) {
+    bucket++;
+  }
+  frame_stats.histogram[bucket]++;
+  frame_stats.frames++;
+  frame_stats.total_ms += ms;
+}
+
+/************************************************************************//**
+  Paint the frame-time overlay into the top-left corner of the mapview
+  backing store. Shows the last completed frame, so the cost of the
+  overlay itself is included in what it reports.
+****************************************************************************/
+static void frame_stats_overlay(void)
+{
+  char buf[128];
+  int width, height;
+
+  if (frame_stats.frames == 0 && frame_stats.last_frame_ms == 0.0) {
+    /* Nothing measured yet. */
+    return;
+  }
+
+  fc_snprintf(buf, sizeof(buf),
+              "%.1f ms (%.1f fps) fill %.1f flush %.1f",
+              frame_stats.last_frame_ms,
+              frame_stats.last_interval > 0.0
+              ? 1.0 / frame_stats.last_interval : 0.0,
+              frame_stats.last_fill_ms, frame_stats.last_flush_ms);
+  get_text_size(&width, &height, FONT_CITY_NAME, buf);
+  canvas_put_rectangle(mapview.store,
+                       get_color(tileset, COLOR_MAPVIEW_UNKNOWN),
+                       0, 0, width + 8, height + 4);
+  canvas_put_text(mapview.store, 4, 2, FONT_CITY_NAME,
+                  get_color(tileset, COLOR_MAPVIEW_CITYTEXT), buf);
+  dirty_rect(0, 0, width + 8, height + 4);
+}
+
 /************************************************************************//**
   Add new animation to the queue.
 ****************************************************************************/
@@ -937,6 +1084,20 @@ static void base_set_mapview_origin(float gui_x0, float gui_y0, float zoom)
     mapview.tmp_store = mapview.store;
     mapview.store = target;
 
+    if (mapview.layer_store != NULL && mapview.layer_store_valid) {
+      /* Scroll the static layer cache the same way, so it stays aligned
+       * with the store. tmp_store is scratch between repaints, so it can
+       * serve as the shift buffer here too. */
+      canvas_copy(mapview.tmp_store, mapview.layer_store,
+                  common_x0 - old_gui_x0,
+                  common_y0 - old_gui_y0,
+                  common_x0 - gui_x0, common_y0 - gui_y0,
+                  common_x1 - common_x0, common_y1 - common_y0);
+      target = mapview.layer_store;
+      mapview.layer_store = mapview.tmp_store;
+      mapview.tmp_store = target;
+    }
+
     if (update_y1 > update_y0) {
       update_map_canvas(0, update_y0 - gui_y0,
                         width, update_y1 - update_y0);
@@ -1322,6 +1483,70 @@ bool tile_visible_and_not_on_border_mapcanvas(struct tile *ptile)
   return TRUE;
 }
 
+/* Pending full-sprite draws collected during a mapview repaint, so that
+ * a whole layer can be submitted to the GUI as one batch instead of one
+ * blit call per sprite. Only draws targeting 'canvas' are collected;
+ * 'canvas' is NULL while no batch is open. */
+static struct {
+  struct canvas *canvas;
+  struct canvas_sprite_draw *draws;
+  int ndraws;
+  int size;
+} sprite_batch = { NULL, NULL, 0, 0 };
+
+/************************************************************************//**
+  Start collecting full-sprite draws aimed at the given canvas.
+****************************************************************************/
+static void sprite_batch_begin(struct canvas *pcanvas)
+{
+  fc_assert_ret(sprite_batch.canvas == NULL);
+  sprite_batch.canvas = pcanvas;
+  sprite_batch.ndraws = 0;
+}
+
+/************************************************************************//**
+  Submit the collected draws to the GUI, keeping the batch open.
+****************************************************************************/
+static void sprite_batch_flush(void)
+{
+  if (sprite_batch.ndraws > 0) {
+    canvas_put_sprite_batch(sprite_batch.canvas, sprite_batch.draws,
+                            sprite_batch.ndraws);
+    sprite_batch.ndraws = 0;
+  }
+}
+
+/************************************************************************//**
+  Submit any collected draws and stop collecting.
+****************************************************************************/
+static void sprite_batch_end(void)
+{
+  sprite_batch_flush();
+  sprite_batch.canvas = NULL;
+}
+
+/************************************************************************//**
+  Append one full-sprite draw to the open batch.
+****************************************************************************/
+static void sprite_batch_add(struct sprite *sprite, int canvas_x,
+                             int canvas_y, bool fog)
+{
+  struct canvas_sprite_draw *draw;
+
+  if (sprite_batch.ndraws == sprite_batch.size) {
+    sprite_batch.size = MAX(2 * sprite_batch.size, 256);
+    sprite_batch.draws = fc_realloc(sprite_batch.draws,
+                                    sprite_batch.size
+                                    * sizeof(*sprite_batch.draws));
+  }
+
+  draw = sprite_batch.draws + sprite_batch.ndraws++;
+  draw->sprite = sprite;
+  draw->canvas_x = canvas_x;
+  draw->canvas_y = canvas_y;
+  draw->fog = fog;
+}
+
 /************************************************************************//**
   Draw an array of drawn sprites onto the canvas.
 ****************************************************************************/
@@ -1330,6 +1555,7 @@ void put_drawn_sprites(struct canvas *pcanvas, float zoom,
                        int count, struct drawn_sprite *pdrawn,
                        bool fog)
 {
+  bool batching = (sprite_batch.canvas == pcanvas);
   int i;
 
   for (i = 0; i < count; i++) {
@@ -1340,12 +1566,21 @@ void put_drawn_sprites(struct canvas *pcanvas, float zoom,
 
     if (pdrawn[i].w > 0) {
       /* TODO: Fog support */
+      if (batching) {
+        /* Keep the draws in order. */
+        sprite_batch_flush();
+      }
       canvas_put_flag_sprite(pcanvas,
                              canvas_x / zoom + pdrawn[i].offset_x,
                              canvas_y / zoom + pdrawn[i].offset_y,
                              pdrawn[i].w / zoom,
                              pdrawn[i].h / zoom,
                              pdrawn[i].sprite);
+    } else if (batching) {
+      sprite_batch_add(pdrawn[i].sprite,
+                       canvas_x / zoom + pdrawn[i].offset_x,
+                       canvas_y / zoom + pdrawn[i].offset_y,
+                       fog && pdrawn[i].foggable);
     } else if (fog && pdrawn[i].foggable) {
       canvas_put_sprite_fogged(pcanvas,
                                canvas_x / zoom + pdrawn[i].offset_x,
@@ -1380,12 +1615,20 @@ void put_one_element(struct canvas *pcanvas, float zoom,
                      const struct unit_type *putype)
 {
   struct drawn_sprite tile_sprs[80];
-  int count = fill_sprite_array(tileset, tile_sprs, layer,
-                                ptile, pedge, pcorner,
-                                punit, pcity, citymode, putype);
+  int count;
   bool fog = (ptile && gui_options.draw_fog_of_war
               && TILE_KNOWN_UNSEEN == client_tile_get_known(ptile));
 
+  if (frame_stats.frame_open) {
+    timer_start(frame_stats.fill_timer);
+  }
+  count = fill_sprite_array(tileset, tile_sprs, layer,
+                            ptile, pedge, pcorner,
+                            punit, pcity, citymode, putype);
+  if (frame_stats.frame_open) {
+    timer_stop(frame_stats.fill_timer);
+  }
+
   /*** Draw terrain and specials ***/
   put_drawn_sprites(pcanvas, zoom, canvas_x, canvas_y, count, tile_sprs, fog);
 }
@@ -1726,6 +1969,47 @@ static void draw_trade_routes(void)
   }
 }
 
+/************************************************************************//**
+  Returns TRUE iff the given layer only changes together with the tiles
+  themselves (terrain, extras, ...), so that its rendering can be cached
+  in mapview.layer_store. Anything that can change without a tile update
+  being queued for the affected area - units, cities, fog, grid and all
+  decorations - must stay out of the cache.
+****************************************************************************/
+static bool mapview_layer_is_static(enum mapview_layer layer)
+{
+  switch (layer) {
+  case LAYER_BACKGROUND:
+    /* Depends on unit and city presence when solid color behind units
+     * is enabled. */
+    return !gui_options.solid_color_behind_units;
+  case LAYER_TERRAIN1:
+  case LAYER_DARKNESS:
+  case LAYER_TERRAIN2:
+  case LAYER_TERRAIN3:
+  case LAYER_WATER:
+  case LAYER_ROADS:
+  case LAYER_SPECIAL1:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+/************************************************************************//**
+  Returns TRUE iff repaints may use mapview.layer_store. The cache holds
+  the leading run of static layers in the tileset's layer order; it is
+  kept aligned with mapview.store, which only works without zoom and
+  when tiles cannot appear in the view twice.
+****************************************************************************/
+static bool mapview_layer_cache_usable(void)
+{
+  return (mapview.layer_store != NULL
+          && mapview.can_do_cached_drawing
+          && !zoom_is_enabled()
+          && mapview_layer_is_static(tileset_get_layer(tileset, 0)));
+}
+
 /************************************************************************//**
   Update (refresh) the map canvas starting at the given tile (in map
   coordinates) and with the given dimensions (also in map coordinates).
@@ -1740,11 +2024,17 @@ static void draw_trade_routes(void)
 
   x, y, width, and height are in map coordinates; they need not be
   normalized or even real.
+
+  If 'fg_only' is TRUE the caller asserts that no static layer changed
+  in the area, so the background may be composited from
+  mapview.layer_store instead of being re-rendered; this is silently
+  downgraded to a normal repaint when the cache cannot be used.
 ****************************************************************************/
-void update_map_canvas(int canvas_x, int canvas_y, int width, int height)
+static void update_map_canvas_real(int canvas_x, int canvas_y,
+                                   int width, int height, bool fg_only)
 {
   int gui_x0, gui_y0;
-  bool full;
+  bool full, use_cache, in_bg_prefix;
   struct canvas *tmp;
 
   if (canvas_x < 0) {
@@ -1777,6 +2067,16 @@ void update_map_canvas(int canvas_x, int canvas_y, int width, int height)
   log_debug("update_map_canvas(pos=(%d,%d), size=(%d,%d))",
             canvas_x, canvas_y, width, height);
 
+  use_cache = mapview_layer_cache_usable();
+  if (!use_cache) {
+    /* The repainted area will not be mirrored into the cache, so the
+     * cache as a whole can no longer be trusted. */
+    mapview.layer_store_valid = FALSE;
+  }
+  if (fg_only && !(use_cache && mapview.layer_store_valid)) {
+    fg_only = FALSE;
+  }
+
   /* If a full redraw is done, we just draw everything onto the canvas.
    * However if a partial redraw is done we draw everything onto the
    * tmp_canvas then copy *just* the area of update onto the canvas. */
@@ -1787,18 +2087,76 @@ void update_map_canvas(int canvas_x, int canvas_y, int width, int height)
     mapview.tmp_store = tmp;
   }
 
-  /* Clear the area. This is necessary since some parts of the rectangle
-   * may not actually have any tiles drawn on them. This will happen when
-   * the mapview is large enough so that the tile is visible in multiple
-   * locations. In this case it will only be drawn in one place.
-   *
-   * Of course it's necessary to draw to the whole area to cover up any old
-   * drawing that was done there. */
-  canvas_put_rectangle(mapview.store,
-                       get_color(tileset, COLOR_MAPVIEW_UNKNOWN),
-                       canvas_x, canvas_y, width / map_zoom, height / map_zoom);
+  if (use_cache && !fg_only) {
+    /* (Re)render the static layers of the area into the cache. The
+     * clearing below is necessary since some parts of the rectangle
+     * may not actually have any tiles drawn on them. This will happen
+     * when the mapview is large enough so that a tile is visible in
+     * multiple locations; in this case it will only be drawn in one
+     * place. */
+    canvas_put_rectangle(mapview.layer_store,
+                         get_color(tileset, COLOR_MAPVIEW_UNKNOWN),
+                         canvas_x, canvas_y, width, height);
+
+    mapview_layer_iterate(layer) {
+      if (!mapview_layer_is_static(layer)) {
+        /* Only the leading run of static layers is cached. */
+        break;
+      }
+      sprite_batch_begin(mapview.layer_store);
+      gui_rect_iterate_coord(gui_x0, gui_y0, width,
+                             height + (tileset_is_isometric(tileset)
+                                       ? (tileset_tile_height(tileset) / 2
+                                          * map_zoom) : 0),
+                             ptile, pedge, pcorner, gui_x, gui_y, map_zoom) {
+        const int cx = gui_x - mapview.gui_x0, cy = gui_y - mapview.gui_y0;
+
+        if (ptile) {
+          put_one_tile(mapview.layer_store, layer, ptile, cx, cy, NULL);
+        } else if (pedge) {
+          put_one_element(mapview.layer_store, map_zoom, layer,
+                          NULL, pedge, NULL,
+                          NULL, NULL, cx, cy, NULL, NULL);
+        } else if (pcorner) {
+          put_one_element(mapview.layer_store, map_zoom, layer,
+                          NULL, NULL, pcorner,
+                          NULL, NULL, cx, cy, NULL, NULL);
+        } else {
+          /* This can happen, for instance for unreal tiles. */
+        }
+      } gui_rect_iterate_coord_end;
+      sprite_batch_end();
+    } mapview_layer_iterate_end;
+  }
+
+  if (use_cache) {
+    /* Composite the cached static layers; the dynamic layers are drawn
+     * over them below. */
+    canvas_copy(mapview.store, mapview.layer_store,
+                canvas_x, canvas_y, canvas_x, canvas_y, width, height);
+  } else {
+    /* Clear the area. This is necessary since some parts of the rectangle
+     * may not actually have any tiles drawn on them. This will happen when
+     * the mapview is large enough so that the tile is visible in multiple
+     * locations. In this case it will only be drawn in one place.
+     *
+     * Of course it's necessary to draw to the whole area to cover up any
+     * old drawing that was done there. */
+    canvas_put_rectangle(mapview.store,
+                         get_color(tileset, COLOR_MAPVIEW_UNKNOWN),
+                         canvas_x, canvas_y,
+                         width / map_zoom, height / map_zoom);
+  }
 
+  in_bg_prefix = use_cache;
   mapview_layer_iterate(layer) {
+    if (in_bg_prefix) {
+      if (mapview_layer_is_static(layer)) {
+        /* Already composited from the cache. */
+        continue;
+      }
+      in_bg_prefix = FALSE;
+    }
     if (layer == LAYER_TILELABEL) {
       show_tile_labels(canvas_x, canvas_y, width, height);
     }
@@ -1806,6 +2164,9 @@ void update_map_canvas(int canvas_x, int canvas_y, int width, int height)
       show_city_descriptions(canvas_x, canvas_y, width, height);
       continue;
     }
+    /* Collect the sprites of the whole layer, so that the GUI gets them
+     * as one batched draw instead of one blit call per sprite. */
+    sprite_batch_begin(mapview.store);
     gui_rect_iterate_coord(gui_x0, gui_y0, width,
                            height + (tileset_is_isometric(tileset)
                                      ? (tileset_tile_height(tileset) / 2 * map_zoom) : 0),
@@ -1824,6 +2185,7 @@ void update_map_canvas(int canvas_x, int canvas_y, int width, int height)
         /* This can happen, for instance for unreal tiles. */
       }
     } gui_rect_iterate_coord_end;
+    sprite_batch_end();
   } mapview_layer_iterate_end;
 
   draw_trade_routes();
@@ -1848,6 +2210,12 @@ void update_map_canvas(int canvas_x, int canvas_y, int width, int height)
     } adjc_dir_base_iterate_end;
   } gui_rect_iterate_end;
 
+  if (use_cache && !fg_only && full) {
+    /* The whole backing store was rendered, so the cache now mirrors
+     * it everywhere. */
+    mapview.layer_store_valid = TRUE;
+  }
+
   if (!full) {
     /* Swap store and tmp_store back. */
     tmp = mapview.store;
@@ -1860,6 +2228,18 @@ void update_map_canvas(int canvas_x, int canvas_y, int width, int height)
   }
 
   dirty_rect(canvas_x, canvas_y, width, height);
+
+  if (gui_options.draw_frame_stats) {
+    frame_stats_overlay();
+  }
+}
+
+/************************************************************************//**
+  Update (refresh) the map canvas; see update_map_canvas_real().
+****************************************************************************/
+void update_map_canvas(int canvas_x, int canvas_y, int width, int height)
+{
+  update_map_canvas_real(canvas_x, canvas_y, width, height, FALSE);
 }
 
 /************************************************************************//**
@@ -2966,6 +3346,10 @@ void get_city_mapview_trade_routes(struct city *pcity,
 static enum update_type needed_updates = UPDATE_NONE;
 static bool callback_queued = FALSE;
 
+/* While positive, unqueue_mapview_updates() keeps everything queued
+ * instead of repainting; see mapview_updates_freeze(). */
+static int mapview_frozen_level = 0;
+
 /* These values hold the tiles that need city, unit, or tile updates.
  * These different types of updates just tell what area need to be updated,
  * not necessarily what's sitting on the tile. A city update covers the
@@ -2996,6 +3380,30 @@ static void queue_add_callback(void)
   }
 }
 
+/************************************************************************//**
+  Hold back all queued mapview updates. While frozen,
+  unqueue_mapview_updates() just keeps everything queued, so a flood of
+  per-packet updates (e.g. during turn change) is repainted in a single
+  pass at thaw time.
+****************************************************************************/
+void mapview_updates_freeze(void)
+{
+  mapview_frozen_level++;
+}
+
+/************************************************************************//**
+  Thaw the mapview update queue, repainting anything queued while it
+  was frozen.
+****************************************************************************/
+void mapview_updates_thaw(void)
+{
+  mapview_frozen_level--;
+  fc_assert(0 <= mapview_frozen_level);
+  if (0 == mapview_frozen_level) {
+    queue_add_callback();
+  }
+}
+
 /************************************************************************//**
   This function, along with unqueue_mapview_update(), helps in updating
   the mapview when a packet is received. Previously, we just called
@@ -3080,6 +3488,11 @@ void unqueue_mapview_updates(bool write_to_screen)
 
   int i;
 
+  if (0 < mapview_frozen_level) {
+    /* Keep everything queued; mapview_updates_thaw() reschedules us. */
+    return;
+  }
+
   if (!can_client_change_view()) {
     /* Double sanity check: make sure we don't unqueue an invalid update
      * after we've already detached. */
@@ -3089,6 +3502,8 @@ void unqueue_mapview_updates(bool write_to_screen)
   log_debug("unqueue_mapview_update: needed_updates=%d",
             needed_updates);
 
+  frame_stats_begin();
+
   /* This code "pops" the lists of tile updates off of the static array and
    * stores them locally. This allows further updates to be queued within
    * the function itself (namely, within update_map_canvas() ). */
@@ -3107,10 +3522,28 @@ void unqueue_mapview_updates(bool write_to_screen)
       /* Have to update the overview too, since some tiles may have changed. */
       refresh_overview_canvas();
     } else {
-      int min_x = mapview.width, min_y = mapview.height;
-      int max_x = 0, max_y = 0;
+      /* Collect the damaged areas into a small set of disjoint rectangles
+       * so that scattered updates (a unit moving in one corner, a city
+       * description changing in another) don't force a repaint of the
+       * whole bounding box between them. Overlapping rectangles are
+       * merged; if there are too many we fall back to merging everything
+       * into the first one. Updates that only touch dynamic layers
+       * (units, city descriptions, tile labels) are flagged so that
+       * update_map_canvas_real() may composite the cached static layers
+       * instead of re-rendering them. */
+#define MAX_DAMAGE_RECTS 16
+      struct damage_rect {
+        int x0, y0, x1, y1;
+        bool full;
+      } rects[MAX_DAMAGE_RECTS], tmp;
+      int num_rects = 0;
+      int j;
 
       for (i = 0; i < TILE_UPDATE_COUNT; i++) {
+        bool full = (i != TILE_UPDATE_UNIT
+                     && i != TILE_UPDATE_CITY_DESC
+                     && i != TILE_UPDATE_TILE_LABEL);
+
         if (my_tile_updates[i]) {
           tile_list_iterate(my_tile_updates[i], ptile) {
             float xl, yt;
@@ -3125,10 +3558,51 @@ void unqueue_mapview_updates(bool write_to_screen)
 
             if (xr > 0 && xl < mapview.width
                 && yb > 0 && yt < mapview.height) {
-              min_x = MIN(min_x, xl);
-              min_y = MIN(min_y, yt);
-              max_x = MAX(max_x, xr);
-              max_y = MAX(max_y, yb);
+              if (num_rects == MAX_DAMAGE_RECTS) {
+                /* Too fragmented; collapse into the first rectangle. */
+                for (j = 1; j < num_rects; j++) {
+                  rects[0].x0 = MIN(rects[0].x0, rects[j].x0);
+                  rects[0].y0 = MIN(rects[0].y0, rects[j].y0);
+                  rects[0].x1 = MAX(rects[0].x1, rects[j].x1);
+                  rects[0].y1 = MAX(rects[0].y1, rects[j].y1);
+                  rects[0].full = rects[0].full || rects[j].full;
+                }
+                num_rects = 1;
+              }
+              rects[num_rects].x0 = xl;
+              rects[num_rects].y0 = yt;
+              rects[num_rects].x1 = xr;
+              rects[num_rects].y1 = yb;
+              rects[num_rects].full = full;
+              num_rects++;
+
+              /* Merge any rectangle that overlaps the new one into it.
+               * Growing the rectangle may create new overlaps, so keep
+               * rescanning until none remain. */
+              j = 0;
+              while (j < num_rects - 1) {
+                if (rects[j].x0 < rects[num_rects - 1].x1
+                    && rects[num_rects - 1].x0 < rects[j].x1
+                    && rects[j].y0 < rects[num_rects - 1].y1
+                    && rects[num_rects - 1].y0 < rects[j].y1) {
+                  rects[j].x0 = MIN(rects[j].x0, rects[num_rects - 1].x0);
+                  rects[j].y0 = MIN(rects[j].y0, rects[num_rects - 1].y0);
+                  rects[j].x1 = MAX(rects[j].x1, rects[num_rects - 1].x1);
+                  rects[j].y1 = MAX(rects[j].y1, rects[num_rects - 1].y1);
+                  rects[j].full = rects[j].full || rects[num_rects - 1].full;
+                  num_rects--;
+                  if (j < num_rects - 1) {
+                    /* Keep the grown rectangle last so the scan keeps
+                     * testing it against the remaining ones. */
+                    tmp = rects[j];
+                    rects[j] = rects[num_rects - 1];
+                    rects[num_rects - 1] = tmp;
+                  }
+                  j = 0;
+                } else {
+                  j++;
+                }
+              }
             }
 
             /* FIXME: These overview updates should be batched as well.
@@ -3139,9 +3613,13 @@ void unqueue_mapview_updates(bool write_to_screen)
         }
       }
 
-      if (min_x < max_x && min_y < max_y) {
-        update_map_canvas(min_x, min_y, max_x - min_x, max_y - min_y);
+      for (j = 0; j < num_rects; j++) {
+        update_map_canvas_real(rects[j].x0, rects[j].y0,
+                               rects[j].x1 - rects[j].x0,
+                               rects[j].y1 - rects[j].y0,
+                               !rects[j].full);
       }
+#undef MAX_DAMAGE_RECTS
     }
   }
 
@@ -3153,9 +3631,17 @@ void unqueue_mapview_updates(bool write_to_screen)
   needed_updates = UPDATE_NONE;
 
   if (write_to_screen) {
+    if (frame_stats.frame_open) {
+      timer_start(frame_stats.flush_timer);
+    }
     flush_dirty();
     flush_dirty_overview();
+    if (frame_stats.frame_open) {
+      timer_stop(frame_stats.flush_timer);
+    }
   }
+
+  frame_stats_end();
 }
 
 /************************************************************************//**
@@ -3604,6 +4090,7 @@ bool map_canvas_resized(int width, int height)
     if (mapview.store) {
       canvas_free(mapview.store);
       canvas_free(mapview.tmp_store);
+      canvas_free(mapview.layer_store);
     }
     mapview.store = canvas_create(full_width, full_height);
     canvas_set_zoom(mapview.store, map_zoom);
@@ -3615,6 +4102,11 @@ bool map_canvas_resized(int width, int height)
     mapview.tmp_store = canvas_create(full_width, full_height);
     canvas_set_zoom(mapview.tmp_store, map_zoom);
     canvas_mapview_init(mapview.tmp_store);
+
+    mapview.layer_store = canvas_create(full_width, full_height);
+    canvas_set_zoom(mapview.layer_store, map_zoom);
+    canvas_mapview_init(mapview.layer_store);
+    mapview.layer_store_valid = FALSE;
   }
 
   if (!map_is_empty() && can_client_change_view()) {
@@ -3673,6 +4165,7 @@ void free_mapcanvas_and_overview(void)
 {
   canvas_free(mapview.store);
   canvas_free(mapview.tmp_store);
+  canvas_free(mapview.layer_store);
 }
 
 /************************************************************************//**
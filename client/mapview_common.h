@@ -40,6 +40,11 @@ struct view {
   int store_width, store_height;
   bool can_do_cached_drawing;   /* TRUE if cached drawing is possible. */
   struct canvas *store, *tmp_store;
+  /* Cache of the static (terrain-ish) map layers, kept aligned with
+   * 'store'. Valid only while 'layer_store_valid' is set; see
+   * update_map_canvas(). */
+  struct canvas *layer_store;
+  bool layer_store_valid;
 };
 
 void mapdeco_init(void);
@@ -247,6 +252,8 @@ void refresh_city_mapcanvas(struct city *pcity, struct tile *ptile,
                             bool full_refresh, bool write_to_screen);
 
 void unqueue_mapview_updates(bool write_to_screen);
+void mapview_updates_freeze(void);
+void mapview_updates_thaw(void);
 
 void map_to_gui_vector(const struct tileset *t, float zoom,
                        float *gui_dx, float *gui_dy, int map_dx, int map_dy);
@@ -27,6 +27,7 @@
 #include "log.h"
 #include "mem.h"
 #include "registry.h"
+#include "registry_bin.h"
 #include "shared.h"
 #include "string_vector.h"
 #include "support.h"
@@ -189,6 +190,7 @@ struct client_options gui_options = {
   .draw_full_citybar = TRUE,
   .draw_unit_shields = TRUE,
   .draw_unit_stack_size = TRUE,
+  .draw_frame_stats = FALSE,
   .player_dlg_show_dead_players = TRUE,
   .reqtree_show_icons = TRUE,
   .reqtree_curved_lines = FALSE,
@@ -2202,6 +2204,15 @@ static struct client_option client_options[] = {
                      "size of the unit stacks. Not all clients support "
                      "this."),
                   COC_GRAPHICS, GUI_STUB, TRUE, view_option_changed_callback),
+  GEN_BOOL_OPTION(draw_frame_stats, N_("Draw frame timing overlay"),
+                  N_("Setting this option will time every map redraw and "
+                     "show frame time, frame rate and the time spent "
+                     "filling sprites and flushing to the screen in the "
+                     "corner of the map view. A histogram of the frame "
+                     "times is written to the log when the option is "
+                     "turned off again."),
+                  COC_GRAPHICS, GUI_STUB, FALSE,
+                  view_option_changed_callback),
   GEN_BOOL_OPTION(draw_focus_unit, N_("Draw the units in focus"),
                   N_("Setting this option will cause the currently focused "
                      "unit(s) to always be drawn, even if units are not "
@@ -6255,6 +6266,181 @@ void options_dialogs_set(void)
   }
 }
 
+/* Checksum of the option file content as of the last load or save; used
+ * by options_save() to skip rewriting an unchanged option file. */
+static unsigned int saved_options_checksum = 0;
+
+/************************************************************************//**
+  Feed bytes to a FNV-1a checksum.
+****************************************************************************/
+static unsigned int options_checksum_feed(unsigned int hash,
+                                          const void *data, size_t size)
+{
+  const unsigned char *bytes = data;
+  size_t i;
+
+  for (i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+
+  return hash;
+}
+
+/************************************************************************//**
+  Returns a checksum over everything in the section file that would end
+  up in the option file on disk. Entry order does not matter, so the
+  checksum of a freshly loaded file can be compared with the checksum of
+  a section file built for saving.
+****************************************************************************/
+static unsigned int options_content_checksum(const struct section_file *sf)
+{
+  unsigned int total = 0;
+
+  section_list_iterate(secfile_sections(sf), psection) {
+    const char *secname = section_name(psection);
+
+    if (0 == strcmp(secname, "optioncache")) {
+      /* Cache metadata, not option content. */
+      continue;
+    }
+
+    entry_list_iterate(section_entries(psection), pentry) {
+      enum entry_type type = entry_type_get(pentry);
+      unsigned int hash = 2166136261u;
+
+      if (ENTRY_LONG_COMMENT == type) {
+        continue;
+      }
+
+      hash = options_checksum_feed(hash, secname, strlen(secname) + 1);
+      hash = options_checksum_feed(hash, entry_name(pentry),
+                                   strlen(entry_name(pentry)) + 1);
+      hash = options_checksum_feed(hash, &type, sizeof(type));
+
+      switch (type) {
+      case ENTRY_BOOL:
+        {
+          bool value;
+
+          if (entry_bool_get(pentry, &value)) {
+            hash = options_checksum_feed(hash, &value, sizeof(value));
+          }
+        }
+        break;
+      case ENTRY_INT:
+        {
+          int value;
+
+          if (entry_int_get(pentry, &value)) {
+            hash = options_checksum_feed(hash, &value, sizeof(value));
+          }
+        }
+        break;
+      case ENTRY_FLOAT:
+        {
+          float value;
+
+          if (entry_float_get(pentry, &value)) {
+            hash = options_checksum_feed(hash, &value, sizeof(value));
+          }
+        }
+        break;
+      case ENTRY_STR:
+        {
+          const char *value;
+
+          if (entry_str_get(pentry, &value)) {
+            hash = options_checksum_feed(hash, value, strlen(value));
+          }
+        }
+        break;
+      case ENTRY_FILEREFERENCE:
+      case ENTRY_LONG_COMMENT:
+      case ENTRY_ILLEGAL:
+        break;
+      }
+
+      /* Sum instead of xor so that identical entries don't cancel
+       * each other out. */
+      total += hash;
+    } entry_list_iterate_end;
+  } section_list_iterate_end;
+
+  return total;
+}
+
+/************************************************************************//**
+  Fill in the name of the binary cache companion of the given option
+  file.
+****************************************************************************/
+static void option_cache_file_name(char *buf, size_t buf_len,
+                                   const char *name)
+{
+  fc_snprintf(buf, buf_len, "%s.cache", name);
+}
+
+/************************************************************************//**
+  Try to load the options from the binary cache written by the last
+  load or save of the option file 'name'. Returns NULL if there is no
+  cache, or if it was written by another client version or from another
+  revision of the text file; the caller then falls back to parsing the
+  text file.
+****************************************************************************/
+static struct section_file *options_cache_load(const char *name)
+{
+  char cache_name[512];
+  struct section_file *sf;
+  struct stat sbuf;
+  const char *version;
+  int mtime, fsize;
+
+  option_cache_file_name(cache_name, sizeof(cache_name), name);
+  if (!(sf = binfile_load(cache_name, TRUE))) {
+    return NULL;
+  }
+
+  /* The cache is only valid for the exact text file it was built from
+   * and the exact client version that wrote it. */
+  version = secfile_lookup_str_default(sf, "", "optioncache.version");
+  if (0 != strcmp(version, VERSION_STRING)
+      || 0 != fc_stat(name, &sbuf)
+      || !secfile_lookup_int(sf, &mtime, "optioncache.mtime")
+      || !secfile_lookup_int(sf, &fsize, "optioncache.size")
+      || mtime != (int) sbuf.st_mtime
+      || fsize != (int) sbuf.st_size) {
+    log_debug("Option cache '%s' is stale, parsing '%s' instead.",
+              cache_name, name);
+    secfile_destroy(sf);
+    return NULL;
+  }
+
+  log_debug("Loaded options from cache '%s'.", cache_name);
+  return sf;
+}
+
+/************************************************************************//**
+  (Re)write the binary cache of the option file 'name' from the given
+  section file, so that the next client start can skip the text parse.
+  Failure only costs the fast path, so it is not reported to the user.
+****************************************************************************/
+static void options_cache_update(struct section_file *sf, const char *name)
+{
+  char cache_name[512];
+  struct stat sbuf;
+
+  if (0 != fc_stat(name, &sbuf)) {
+    return;
+  }
+
+  option_cache_file_name(cache_name, sizeof(cache_name), name);
+  secfile_replace_str(sf, VERSION_STRING, "optioncache.version");
+  secfile_replace_int(sf, (int) sbuf.st_mtime, "optioncache.mtime");
+  secfile_replace_int(sf, (int) sbuf.st_size, "optioncache.size");
+  if (!secfile_save_bin(sf, cache_name, 0, FZ_PLAIN)) {
+    log_debug("Failed to write option cache '%s'.", cache_name);
+  }
+}
+
 /************************************************************************//**
   Load from the rc file any options that are not ruleset specific.
   It is called after ui_init(), yet before ui_main().
@@ -6278,25 +6464,33 @@ void options_load(void)
     gui_options.first_boot = TRUE;
     return;
   }
-  if (!(sf = secfile_load(name, TRUE))) {
-    log_debug("Error loading option file '%s':\n%s", name, secfile_error());
-    /* Try to create the rc file */
-    sf = secfile_new(TRUE);
-    secfile_insert_str(sf, VERSION_STRING, "client.version");
-
-    create_default_cma_presets();
-    gui_options.first_boot = TRUE;
-    save_cma_presets(sf);
-
-    /* FIXME: need better messages */
-    if (!secfile_save(sf, name, 0, FZ_PLAIN)) {
-      log_error(_("Save failed, cannot write to file %s"), name);
-    } else {
-      log_normal(_("Saved settings to file %s"), name);
+  /* Try the binary cache first; fall back to parsing the text file. */
+  sf = options_cache_load(name);
+  if (sf == NULL) {
+    if (!(sf = secfile_load(name, TRUE))) {
+      log_debug("Error loading option file '%s':\n%s", name,
+                secfile_error());
+      /* Try to create the rc file */
+      sf = secfile_new(TRUE);
+      secfile_insert_str(sf, VERSION_STRING, "client.version");
+
+      create_default_cma_presets();
+      gui_options.first_boot = TRUE;
+      save_cma_presets(sf);
+
+      /* FIXME: need better messages */
+      if (!secfile_save(sf, name, 0, FZ_PLAIN)) {
+        log_error(_("Save failed, cannot write to file %s"), name);
+      } else {
+        log_normal(_("Saved settings to file %s"), name);
+      }
+      secfile_destroy(sf);
+      options_fully_initialized = TRUE;
+      return;
     }
-    secfile_destroy(sf);
-    options_fully_initialized = TRUE;
-    return;
+    /* (Re)build the cache so the next client start can skip the
+     * parse. */
+    options_cache_update(sf, name);
   }
   secfile_allow_digital_boolean(sf, allow_digital_boolean);
 
@@ -6423,6 +6617,8 @@ void options_load(void)
   settable_options_load(sf);
   global_worklists_load(sf);
 
+  saved_options_checksum = options_content_checksum(sf);
+
   secfile_destroy(sf);
   options_fully_initialized = TRUE;
 }
@@ -6479,6 +6675,8 @@ void options_save(option_save_log_callback log_cb)
   struct section_file *sf;
   const char *name = get_current_option_file_name();
   char dir_name[2048];
+  unsigned int checksum;
+  struct stat sbuf;
   int i;
 
   queue_save = FALSE;
@@ -6570,6 +6768,14 @@ void options_save(option_save_log_callback log_cb)
   /* Insert global worklists */
   global_worklists_save(sf);
 
+  /* Skip the write if nothing changed since the last load or save. */
+  checksum = options_content_checksum(sf);
+  if (checksum == saved_options_checksum && 0 == fc_stat(name, &sbuf)) {
+    log_cb(LOG_VERBOSE, _("Options are unchanged, not saving."));
+    secfile_destroy(sf);
+    return;
+  }
+
   /* Directory name */
   sz_strlcpy(dir_name, name);
   for (i = strlen(dir_name) - 1 ; dir_name[i] != DIR_SEPARATOR_CHAR && i >= 0; i--) {
@@ -6591,6 +6797,10 @@ void options_save(option_save_log_callback log_cb)
     log_cb(LOG_ERROR, _("Saving options failed, cannot write to file %s"), name);
   } else {
     log_cb(LOG_VERBOSE, _("Saved options to file %s"), name);
+    saved_options_checksum = checksum;
+    /* Keep the binary cache in sync so the next client start can skip
+     * the text parse. */
+    options_cache_update(sf, name);
   }
   secfile_destroy(sf);
 }
@@ -217,6 +217,7 @@ struct client_options
   bool draw_full_citybar;
   bool draw_unit_shields;
   bool draw_unit_stack_size;
+  bool draw_frame_stats;
 
   bool player_dlg_show_dead_players;
   bool reqtree_show_icons;
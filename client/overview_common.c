@@ -18,8 +18,12 @@
 #include <math.h> /* floor */
 
 /* utility */
+#include "bitvector.h"
 #include "log.h"
 
+/* common */
+#include "tile.h"
+
 /* client */
 #include "client_main.h" /* can_client_change_view() */
 #include "climap.h"
@@ -48,6 +52,17 @@ struct overview overview = {
  */
 static bool overview_dirty = FALSE;
 
+/*
+ * Tiles whose pixels in overview.map are stale. The actual drawing is
+ * deferred until the overview is flushed, so a tile that changes many
+ * times between two frames is only rendered once, and a burst of updates
+ * (joining a game, a nuke) costs one pass over the affected tiles.
+ */
+static struct tile_list *overview_pending_tiles = NULL;
+static struct dbv overview_pending;
+
+static void overview_render_tile(struct tile *ptile);
+
 /************************************************************************//**
   Translate from gui to natural coordinate systems.  This provides natural
   coordinates as a floating-point value so there is no loss of information
@@ -194,6 +209,29 @@ void refresh_overview_from_canvas(void)
               gui_options.overview.width, gui_options.overview.height);
 }
 
+/************************************************************************//**
+  Draw all queued tile updates into the overview backing store. Each
+  queued tile is rendered exactly once, no matter how often it was
+  queued since the last flush.
+****************************************************************************/
+static void overview_flush_tile_updates(void)
+{
+  if (overview_pending_tiles != NULL) {
+    struct tile_list *pending = overview_pending_tiles;
+
+    /* Detach the list first so that updates queued while drawing (there
+     * should be none, but see unqueue_mapview_updates() for the pattern)
+     * start a fresh queue. */
+    overview_pending_tiles = NULL;
+
+    tile_list_iterate(pending, ptile) {
+      dbv_clr(&overview_pending, tile_index(ptile));
+      overview_render_tile(ptile);
+    } tile_list_iterate_end;
+    tile_list_destroy(pending);
+  }
+}
+
 /************************************************************************//**
   Copies the overview image from the backing store to the window and
   draws the viewrect on top of it.
@@ -206,6 +244,8 @@ static void redraw_overview(void)
     return;
   }
 
+  overview_flush_tile_updates();
+
   {
     struct canvas *src = gui_options.overview.map;
     struct canvas *dst = gui_options.overview.window;
@@ -406,9 +446,9 @@ static void put_overview_tile_area(struct canvas *pcanvas,
 }
 
 /************************************************************************//**
-  Redraw the given map position in the overview canvas.
+  Draw the given map position into the overview backing store.
 ****************************************************************************/
-void overview_update_tile(struct tile *ptile)
+static void overview_render_tile(struct tile *ptile)
 {
   int tile_x, tile_y;
 
@@ -444,6 +484,34 @@ void overview_update_tile(struct tile *ptile)
   } do_in_natural_pos_end;
 }
 
+/************************************************************************//**
+  Queue the given map position for a redraw in the overview canvas. The
+  drawing is done when the overview is next flushed or redrawn.
+****************************************************************************/
+void overview_update_tile(struct tile *ptile)
+{
+  if (dbv_bits(&overview_pending) != MAP_INDEX_SIZE) {
+    /* First use, or the map size changed under us. dbv_resize() clears
+     * all bits, so drop any queued tiles along with their marks. */
+    dbv_resize(&overview_pending, MAP_INDEX_SIZE);
+    if (overview_pending_tiles != NULL) {
+      tile_list_destroy(overview_pending_tiles);
+      overview_pending_tiles = NULL;
+    }
+  }
+
+  if (dbv_isset(&overview_pending, tile_index(ptile))) {
+    return;
+  }
+
+  if (overview_pending_tiles == NULL) {
+    overview_pending_tiles = tile_list_new();
+  }
+  dbv_set(&overview_pending, tile_index(ptile));
+  tile_list_append(overview_pending_tiles, ptile);
+  dirty_overview();
+}
+
 /************************************************************************//**
   Called if the map size is know or changes.
 ****************************************************************************/
@@ -516,6 +584,11 @@ void overview_free(void)
     gui_options.overview.map = NULL;
     gui_options.overview.window = NULL;
   }
+  if (overview_pending_tiles != NULL) {
+    tile_list_destroy(overview_pending_tiles);
+    overview_pending_tiles = NULL;
+  }
+  dbv_free(&overview_pending);
 }
 
 /************************************************************************//**
@@ -57,6 +57,11 @@
 #include "unitlist.h"
 #include "worklist.h"
 
+/* common/aicore */
+#include "path_finding.h"
+#include "pf_alt.h"
+#include "pf_hier.h"
+
 /* client/include */
 #include "chatline_g.h"
 #include "citydlg_g.h"
@@ -137,6 +142,11 @@ extern const char forced_tileset_name[];
 
 static int last_turn = 0;
 
+/* TRUE between the freeze and thaw packets bracketing a turn change;
+ * while set, the update queue and the mapview update queue are frozen
+ * so that the packet flood is applied before anything is redrawn. */
+static bool client_frozen = FALSE;
+
 /* Refresh the action selection dialog */
 #define REQEST_BACKGROUND_REFRESH (1)
 /* Get possible actions for fast auto attack. */
@@ -232,6 +242,14 @@ void packhand_free(void)
     free(invisible.placeholder);
     invisible.placeholder = NULL;
   }
+
+  if (client_frozen) {
+    /* The thaw packet never arrived (e.g. connection was lost between
+     * the freeze/thaw pair); don't leave the queues frozen forever. */
+    client_frozen = FALSE;
+    update_queue_thaw();
+    mapview_updates_thaw();
+  }
 }
 
 /************************************************************************//**
@@ -1149,6 +1167,7 @@ void handle_trade_route_info(const struct packet_trade_route_info *packet)
     fc_assert(trade_route_list_size(pcity->routes) == packet->index);
 
     proute = fc_malloc(sizeof(struct trade_route));
+    proute->base_cache.valid = FALSE;
     trade_route_list_append(pcity->routes, proute);
     city_changed = TRUE;
   }
@@ -3454,6 +3473,10 @@ void handle_tile_info(const struct packet_tile_info *packet)
 
   if (ptile->continent != packet->continent) {
     update_continent_cache(ptile, ptile->continent, packet->continent);
+    /* The hierarchical path-finding abstraction and the landmark
+     * tables are built from continent data and are now stale. */
+    pf_alt_invalidate();
+    pf_hier_invalidate();
   }
   ptile->continent = packet->continent;
 
@@ -3468,7 +3491,15 @@ void handle_tile_info(const struct packet_tile_info *packet)
       tile_changed = TRUE;
   }
 
+  /* Extras and continent were written directly above, bypassing the
+   * tile mutators that keep the structure-of-arrays mirror in sync. */
+  map_soa_tile_update(ptile);
+
   if (known_changed || tile_changed) {
+    /* Cached client-side path-finding maps (goto preview) may hold
+     * results crossing this tile; they repair themselves lazily. */
+    pf_map_cache_notify_change(ptile);
+
     /*
      * A tile can only change if it was known before and is still
      * known. In the other cases the tile is new or removed.
@@ -3504,6 +3535,39 @@ void handle_tile_info(const struct packet_tile_info *packet)
    * case of changes in worked tiles above. */
 }
 
+/************************************************************************//**
+  Packet tile_info_bulk handler. Unpacks each slot into an ordinary
+  tile_info packet and feeds it to handle_tile_info(), so that both
+  packets always agree on what a tile update means.
+****************************************************************************/
+void handle_tile_info_bulk(const struct packet_tile_info_bulk *packet)
+{
+  struct packet_tile_info info;
+  int i;
+
+  /* Fields the bulk packet does not carry; tiles where these matter
+   * are sent as individual tile_info packets instead. */
+  info.spec_sprite[0] = '\0';
+  info.label[0] = '\0';
+  info.placing = -1;
+  info.place_turn = 0;
+
+  for (i = 0; i < packet->count; i++) {
+    info.tile = packet->first_tile + i;
+    info.known = packet->known[i];
+    info.continent = packet->continent[i];
+    info.owner = packet->owner[i];
+    info.extras_owner = packet->extras_owner[i];
+    info.worked = packet->worked[i];
+    info.terrain = packet->terrain[i];
+    info.resource = packet->resource[i];
+    info.extras = packet->extras[i];
+    info.altitude = packet->altitude[i];
+
+    handle_tile_info(&info);
+  }
+}
+
 /************************************************************************//**
   Received packet containing info about current scenario
 ****************************************************************************/
@@ -5490,6 +5554,15 @@ void handle_freeze_client(void)
   log_debug("handle_freeze_client");
 
   agents_freeze_hint();
+
+  if (!client_frozen) {
+    /* Hold back all aggregated GUI updates until the thaw packet, so
+     * the packet flood of a turn change is applied in one pass with a
+     * single refresh per dialog and view afterwards. */
+    client_frozen = TRUE;
+    update_queue_freeze();
+    mapview_updates_freeze();
+  }
 }
 
 /************************************************************************//**
@@ -5500,6 +5573,13 @@ void handle_thaw_client(void)
   log_debug("handle_thaw_client");
 
   agents_thaw_hint();
+
+  if (client_frozen) {
+    client_frozen = FALSE;
+    update_queue_thaw();
+    mapview_updates_thaw();
+  }
+
   update_turn_done_button_state();
 }
 
@@ -5700,6 +5780,18 @@ void handle_popup_image(const char *tag)
   popup_image(tag);
 }
 
+/************************************************************************//**
+  Per-turn server profiler timings, sent to admin connections. The
+  regular client just logs them; monitoring tools consume them off the
+  wire.
+****************************************************************************/
+void handle_timing_info(int turn, const char *path, int calls,
+                        float seconds)
+{
+  log_verbose("server timing: turn=%d %s=%f/%d", turn, path,
+              (double) seconds, calls);
+}
+
 /************************************************************************//**
   Open meeting
 ****************************************************************************/
@@ -838,6 +838,76 @@ static void improve(struct reqtree *tree)
   }
 }
 
+/****************************************************************************
+  Cached node ordering from the previous create_reqtree() call. The
+  crossing-reduction passes dominate the cost of building a tree; their
+  result depends only on the node and edge structure, not on node states
+  (researched, reachable, ...) which are read at draw time. When the
+  structure is unchanged since last time we reuse the stored ordering
+  and skip those passes entirely.
+****************************************************************************/
+static struct {
+  bool valid;
+  struct player *pplayer;
+  bool show_all;
+  unsigned int signature;
+  int num_nodes;
+  int *order;           /* Node index -> order within its layer */
+} layout_cache = { .valid = FALSE, .order = NULL };
+
+/*********************************************************************//**
+  Hash the structure of the tree: which nodes exist, on which layers,
+  and how they are connected. Trees with equal signatures get the same
+  result from the node-ordering passes.
+*************************************************************************/
+static unsigned int reqtree_signature(struct reqtree *tree)
+{
+  unsigned int hash = 2166136261u;
+  int i, j;
+
+  for (i = 0; i < tree->num_nodes; i++) {
+    tree->nodes[i]->number = i;
+  }
+
+#define SIGNATURE_FEED(value) \
+  hash = (hash ^ (unsigned int) (value)) * 16777619u
+
+  SIGNATURE_FEED(tree->num_nodes);
+  SIGNATURE_FEED(tree->num_layers);
+  for (i = 0; i < tree->num_nodes; i++) {
+    struct tree_node *node = tree->nodes[i];
+
+    /* Dummy nodes have no meaningful tech field */
+    SIGNATURE_FEED(node->is_dummy ? A_LAST : node->tech);
+    SIGNATURE_FEED(node->layer);
+    SIGNATURE_FEED(node->nrequire);
+    for (j = 0; j < node->nrequire; j++) {
+      SIGNATURE_FEED(node->require[j]->number);
+    }
+  }
+#undef SIGNATURE_FEED
+
+  return hash;
+}
+
+/*********************************************************************//**
+  Apply a cached per-node ordering to the tree. The cache must have been
+  stored for a tree with the same structural signature, so every order
+  value is a valid position within the node's layer.
+*************************************************************************/
+static void restore_node_order(struct reqtree *tree, const int *order)
+{
+  int i;
+
+  for (i = 0; i < tree->num_nodes; i++) {
+    struct tree_node *node = tree->nodes[i];
+
+    fc_assert_ret(order[i] >= 0 && order[i] < tree->layer_size[node->layer]);
+    node->order = order[i];
+    tree->layers[node->layer][node->order] = node;
+  }
+}
+
 /*********************************************************************//**
   Generate optimized tech_tree from current ruleset.
   You should free it by destroy_reqtree().
@@ -847,6 +917,7 @@ static void improve(struct reqtree *tree)
 struct reqtree *create_reqtree(struct player *pplayer, bool show_all)
 {
   struct reqtree *tree1, *tree2;
+  unsigned int signature;
   int i, j;
 
   tree1 = create_dummy_reqtree(pplayer, show_all);
@@ -855,16 +926,40 @@ struct reqtree *create_reqtree(struct player *pplayer, bool show_all)
   destroy_reqtree(tree1);
   set_layers(tree2);
 
-  /* It's good heuristics for beginning */
-  for (j = 0; j < 20; j++) {
-    for (i = 0; i < tree2->num_layers; i++) {
-      barycentric_sort(tree2, i);
+  signature = reqtree_signature(tree2);
+
+  if (layout_cache.valid
+      && layout_cache.pplayer == pplayer
+      && layout_cache.show_all == show_all
+      && layout_cache.num_nodes == tree2->num_nodes
+      && layout_cache.signature == signature) {
+    /* Tree structure is unchanged since the last layout; only node
+     * states may differ and those don't affect the ordering. */
+    restore_node_order(tree2, layout_cache.order);
+  } else {
+    /* It's good heuristics for beginning */
+    for (j = 0; j < 20; j++) {
+      for (i = 0; i < tree2->num_layers; i++) {
+        barycentric_sort(tree2, i);
+      }
+    }
+
+    /* Now burn some CPU */
+    for (j = 0; j < 20; j++) {
+      improve(tree2);
     }
-  }
 
-  /* Now burn some CPU */
-  for (j = 0; j < 20; j++) {
-    improve(tree2);
+    layout_cache.valid = TRUE;
+    layout_cache.pplayer = pplayer;
+    layout_cache.show_all = show_all;
+    layout_cache.signature = signature;
+    layout_cache.num_nodes = tree2->num_nodes;
+    layout_cache.order = fc_realloc(layout_cache.order,
+                                    sizeof(*layout_cache.order)
+                                    * tree2->num_nodes);
+    for (i = 0; i < tree2->num_nodes; i++) {
+      layout_cache.order[i] = tree2->nodes[i]->order;
+    }
   }
 
   calculate_diagram_layout(tree2);
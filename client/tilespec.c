@@ -32,6 +32,7 @@
 #include "capability.h"
 #include "deprecations.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "rand.h"
@@ -3816,6 +3817,105 @@ void finish_loading_sprites(struct tileset *t)
   } specfile_list_iterate_end;
 }
 
+/* Worker decoding the big sprite of one spec file. The candidate
+ * filenames are resolved on the main thread; fileinfoname() is not
+ * thread-safe. */
+struct big_sprite_job {
+  struct specfile *sf;
+  struct strvec *candidates;
+  bool started;                 /* Worker thread running */
+  fc_thread thread;
+};
+
+/************************************************************************//**
+  Worker thread decoding one big sprite. Tries the candidate filenames
+  in extension priority order, like load_gfx_file() does.
+****************************************************************************/
+static void big_sprite_decode_thread(void *data)
+{
+  struct big_sprite_job *job = data;
+
+  strvec_iterate(job->candidates, path) {
+    job->sf->big_sprite = load_gfxfile(path, FALSE);
+    if (job->sf->big_sprite != NULL) {
+      break;
+    }
+  } strvec_iterate_end;
+}
+
+/************************************************************************//**
+  Decode the big sprites of all spec files on worker threads. Image
+  decoding dominates tileset load time and the files are independent.
+  Only a speedup; sprites left unloaded here are loaded, and their
+  errors reported, by ensure_big_sprite() as before.
+****************************************************************************/
+static void tileset_preload_big_sprites(struct tileset *t)
+{
+  struct big_sprite_job *jobs;
+  int njobs = 0;
+
+  if (!gui_properties.threaded_sprite_decode
+      || fc_thread_count() <= 1
+      || specfile_list_size(t->specfiles) <= 1) {
+    return;
+  }
+
+  jobs = fc_calloc(specfile_list_size(t->specfiles), sizeof(*jobs));
+
+  specfile_list_iterate(t->specfiles, sf) {
+    struct big_sprite_job *job = &jobs[njobs];
+    struct section_file *file;
+    const char *gfx_filename;
+
+    if (sf->big_sprite != NULL) {
+      continue;
+    }
+    if (!(file = secfile_load(sf->file_name, TRUE))) {
+      continue;
+    }
+    gfx_filename = secfile_lookup_str(file, "file.gfx");
+    if (gfx_filename != NULL) {
+      const char **gfx_fileexts = gfx_fileextensions();
+      const char *gfx_fileext;
+
+      job->candidates = strvec_new();
+      while ((gfx_fileext = *gfx_fileexts++)) {
+        const char *real_full_name;
+        char full_name[strlen(gfx_filename) + strlen(".")
+                       + strlen(gfx_fileext) + 1];
+
+        sprintf(full_name, "%s.%s", gfx_filename, gfx_fileext);
+        if ((real_full_name = fileinfoname(get_data_dirs(), full_name))) {
+          strvec_append(job->candidates, real_full_name);
+        }
+      }
+      if (strvec_size(job->candidates) > 0) {
+        job->sf = sf;
+        job->started = (fc_thread_start(&job->thread,
+                                        big_sprite_decode_thread,
+                                        job) == 0);
+        if (!job->started) {
+          /* Decode on this thread instead. */
+          big_sprite_decode_thread(job);
+        }
+        njobs++;
+      } else {
+        strvec_destroy(job->candidates);
+        job->candidates = NULL;
+      }
+    }
+    secfile_destroy(file);
+  } specfile_list_iterate_end;
+
+  while (njobs-- > 0) {
+    if (jobs[njobs].started) {
+      fc_thread_wait(&jobs[njobs].thread);
+    }
+    strvec_destroy(jobs[njobs].candidates);
+  }
+  free(jobs);
+}
+
 /************************************************************************//**
   Load the tiles; requires tilespec_read_toplevel() called previously.
   Leads to tile_sprites being allocated and filled with pointers
@@ -3824,6 +3924,7 @@ void finish_loading_sprites(struct tileset *t)
 ****************************************************************************/
 void tileset_load_tiles(struct tileset *t)
 {
+  tileset_preload_big_sprites(t);
   tileset_lookup_sprite_tags(t);
   finish_loading_sprites(t);
 }
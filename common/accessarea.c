@@ -19,6 +19,7 @@
 #include "pf_tools.h"
 
 /* common */
+#include "movement.h"
 #include "player.h"
 
 #include "accessarea.h"
@@ -31,6 +32,20 @@ static struct access_info ainfo = { nullptr };
 
 static struct aarea_list *aalist[MAX_NUM_PLAYERS];
 
+/* Incremental refresh bookkeeping. Connectivity changes that can only
+ * have connected areas (the changed tile is passable to the access unit
+ * afterwards) are queued in a small ring buffer, and each player's next
+ * refresh merges the affected areas with a flood fill bounded to the
+ * changed tiles. Changes that may have removed connectivity, queue
+ * overflow, and city set changes fall back to the full rebuild. */
+#define AREA_CHANGE_QUEUE 16
+
+static struct tile *area_changed_tiles[AREA_CHANGE_QUEUE];
+static int area_change_gen = 0;
+static int area_split_gen = 0;
+static int area_synced_gen[MAX_NUM_PLAYERS];
+static bool area_built[MAX_NUM_PLAYERS];
+
 static void area_list_clear(struct aarea_list *alist);
 
 /*********************************************************************//**
@@ -46,7 +61,12 @@ void access_info_init(const struct unit_type *aunit)
 
     for (i = 0; i < MAX_NUM_PLAYERS; i++) {
       aalist[i] = aarea_list_new();
+      area_synced_gen[i] = 0;
+      area_built[i] = FALSE;
     }
+
+    area_change_gen = 0;
+    area_split_gen = 0;
   }
 }
 
@@ -62,6 +82,7 @@ void access_info_close(void)
 
     for (i = 0; i < MAX_NUM_PLAYERS; i++) {
       area_list_clear(aalist[i]);
+      area_built[i] = FALSE;
     }
   }
 }
@@ -88,6 +109,119 @@ static void area_list_clear(struct aarea_list *alist)
   aarea_list_destroy(alist);
 }
 
+/*********************************************************************//**
+  Record that the terrain or the extras of a tile have changed in a way
+  that may affect access unit movement. Called by the server whenever
+  map connectivity can have changed.
+  @param ptile The changed tile
+*************************************************************************/
+void access_areas_tile_change(struct tile *ptile)
+{
+  if (ainfo.access_unit == nullptr) {
+    return;
+  }
+
+  area_change_gen++;
+
+  if (is_native_tile(ainfo.access_unit, ptile)) {
+    /* The tile is passable afterwards, so the change can only have
+     * connected areas through it. Queue it for a local merge pass. */
+    area_changed_tiles[area_change_gen % AREA_CHANGE_QUEUE] = ptile;
+  } else {
+    /* Connectivity may have been lost; splitting an area needs
+     * a full rebuild. */
+    area_split_gen = area_change_gen;
+  }
+}
+
+/*********************************************************************//**
+  Record that the set of cities of a player has changed (city founded,
+  destroyed, or transferred), invalidating their access areas.
+  @param pplayer Player whose city set changed
+*************************************************************************/
+void access_areas_city_change(const struct player *pplayer)
+{
+  if (ainfo.access_unit != nullptr) {
+    area_built[player_number(pplayer)] = FALSE;
+  }
+}
+
+/*********************************************************************//**
+  Merge access area 'from' into 'into', moving the cities over.
+  @param alist Area list of the owner
+  @param into  Area absorbing the cities
+  @param from  Area to dissolve
+*************************************************************************/
+static void access_area_merge(struct aarea_list *alist,
+                              struct access_area *into,
+                              struct access_area *from)
+{
+  city_list_iterate(from->cities, pcity) {
+    pcity->server.aarea = into;
+    city_list_append(into->cities, pcity);
+  } city_list_iterate_end;
+
+  if (from->capital) {
+    into->capital = TRUE;
+  }
+
+  aarea_list_remove(alist, from);
+  city_list_destroy(from->cities);
+  free(from);
+}
+
+/*********************************************************************//**
+  Merge the player's access areas that are now connected through the
+  given tile: any pair of cities that can be reached from it form
+  a single area.
+  @param nmap  Map to use when determining access
+  @param plr   Player whose areas to update
+  @param ptile Tile the new connection goes through
+*************************************************************************/
+static void access_areas_merge_at(struct civ_map *nmap, struct player *plr,
+                                  struct tile *ptile)
+{
+  int plridx = player_number(plr);
+  struct access_area *merged = nullptr;
+  struct unit *access_unit;
+  struct pf_parameter parameter;
+  struct pf_map *pfm;
+
+  if (!is_native_tile(ainfo.access_unit, ptile)) {
+    /* A later change made the tile impassable again; that change has
+     * forced a full rebuild already. */
+    return;
+  }
+
+  access_unit = unit_virtual_create(plr, nullptr, ainfo.access_unit, 0);
+  unit_tile_set(access_unit, ptile);
+  pft_fill_unit_parameter(&parameter, nmap, access_unit);
+  pfm = pf_map_new(&parameter);
+
+  city_list_iterate(plr->cities, pcity) {
+    struct pf_path *path;
+
+    if (pcity->server.aarea == merged) {
+      /* Already merged through an earlier city of the same area. */
+      continue;
+    }
+
+    path = pf_map_path(pfm, city_tile(pcity));
+    if (path != nullptr) {
+      if (merged == nullptr) {
+        merged = pcity->server.aarea;
+      } else {
+        access_area_merge(aalist[plridx], merged, pcity->server.aarea);
+      }
+    }
+
+    pf_path_destroy(path);
+  } city_list_iterate_end;
+
+  pf_map_destroy(pfm);
+  unit_virtual_destroy(access_unit);
+}
+
 /*********************************************************************//**
   Construct access areas
   @param nmap Map to use when determining access
@@ -98,6 +232,33 @@ void access_areas_refresh(struct civ_map *nmap, struct player *plr)
   if (ainfo.access_unit != nullptr) {
     int plridx = player_number(plr);
     struct unit *access_unit;
+    int gen = area_change_gen;
+
+    if (area_built[plridx]
+        && area_split_gen <= area_synced_gen[plridx]
+        && gen - area_synced_gen[plridx] <= AREA_CHANGE_QUEUE) {
+      /* Every change since our last sync is still in the queue and
+       * none of them can have split an area: update locally. */
+      int i;
+
+      for (i = area_synced_gen[plridx] + 1; i <= gen; i++) {
+        access_areas_merge_at(nmap, plr,
+                              area_changed_tiles[i % AREA_CHANGE_QUEUE]);
+      }
+
+      /* Capitals can move without any connectivity change. */
+      aarea_list_iterate(aalist[plridx], parea) {
+        parea->capital = FALSE;
+      } aarea_list_iterate_end;
+      city_list_iterate(plr->cities, pcity) {
+        if (is_capital(pcity)) {
+          pcity->server.aarea->capital = TRUE;
+        }
+      } city_list_iterate_end;
+
+      area_synced_gen[plridx] = gen;
+      return;
+    }
 
     area_list_clear(aalist[plridx]);
     aalist[plridx] = aarea_list_new();
@@ -149,5 +310,8 @@ void access_areas_refresh(struct civ_map *nmap, struct player *plr)
     } city_list_iterate_end;
 
     unit_virtual_destroy(access_unit);
+
+    area_built[plridx] = TRUE;
+    area_synced_gen[plridx] = gen;
   }
 }
@@ -35,6 +35,8 @@ void access_info_close(void);
 const struct unit_type *access_info_access_unit(void);
 
 void access_areas_refresh(struct civ_map *nmap, struct player *plr);
+void access_areas_tile_change(struct tile *ptile);
+void access_areas_city_change(const struct player *pplayer);
 
 #ifdef __cplusplus
 }
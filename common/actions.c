@@ -61,6 +61,10 @@ static bool actions_initialized = FALSE;
 
 static struct action_enabler_list *action_enablers_by_action[MAX_NUM_ACTIONS];
 
+/* TRUE iff the actor unit type caches of the action enablers match the
+ * current ruleset. */
+static bool ae_actor_index_valid = FALSE;
+
 static struct astring ui_name_str = ASTRING_INIT;
 
 static struct action *
@@ -1503,6 +1507,9 @@ struct action_enabler *action_enabler_new(void)
   requirement_vector_init(&enabler->actor_reqs);
   requirement_vector_init(&enabler->target_reqs);
 
+  /* Conservative default until the index is rebuilt. */
+  BV_SET_ALL(enabler->actor_utypes);
+
   /* Make sure that action doesn't end up as a random value that happens to
    * be a valid action id. */
   enabler->action = ACTION_NONE;
@@ -1554,6 +1561,9 @@ void action_enabler_add(struct action_enabler *enabler)
   action_enabler_list_append(
         action_enablers_for_action(enabler_get_action_id(enabler)),
         enabler);
+
+  /* The actor unit type caches are out of date. */
+  ae_actor_index_valid = FALSE;
 }
 
 /**********************************************************************//**
@@ -1568,6 +1578,9 @@ bool action_enabler_remove(struct action_enabler *enabler)
   /* Sanity check: a non existing action doesn't have enablers. */
   fc_assert_ret_val(action_id_exists(enabler_get_action_id(enabler)), FALSE);
 
+  /* The actor unit type caches are out of date. */
+  ae_actor_index_valid = FALSE;
+
   return action_enabler_list_remove(
         action_enablers_for_action(enabler_get_action_id(enabler)),
         enabler);
@@ -1585,6 +1598,83 @@ action_enablers_for_action(action_id action)
   return action_enablers_by_action[action];
 }
 
+/**********************************************************************//**
+  Rebuild the cache of actor unit types that might fulfill the actor
+  requirements of each action enabler in the current ruleset.
+
+  Only local range, non surviving, unit type narrowing requirements are
+  considered. The cache therefore may keep unit types an enabler never
+  accepts but never drops a unit type it does accept.
+**************************************************************************/
+static void ae_actor_index_rebuild(void)
+{
+  action_iterate_all(act) {
+    action_enabler_list_iterate(action_enablers_by_action[act], enabler) {
+      BV_SET_ALL(enabler->actor_utypes);
+
+      requirement_vector_iterate(&enabler->actor_reqs, preq) {
+        if (preq->range != REQ_RANGE_LOCAL || preq->survives) {
+          continue;
+        }
+
+        switch (preq->source.kind) {
+        case VUT_UTYPE:
+        case VUT_UTFLAG:
+        case VUT_UCLASS:
+        case VUT_UCFLAG:
+          unit_type_iterate(putype) {
+            bool match;
+
+            switch (preq->source.kind) {
+            case VUT_UTYPE:
+              match = (putype == preq->source.value.utype);
+              break;
+            case VUT_UTFLAG:
+              match = utype_has_flag(putype,
+                                     preq->source.value.unitflag);
+              break;
+            case VUT_UCLASS:
+              match = (utype_class(putype) == preq->source.value.uclass);
+              break;
+            case VUT_UCFLAG:
+              match = uclass_has_flag(utype_class(putype),
+                                      preq->source.value.unitclassflag);
+              break;
+            default:
+              fc_assert(FALSE);
+              match = TRUE;
+              break;
+            }
+
+            if (match != preq->present) {
+              BV_CLR(enabler->actor_utypes, utype_index(putype));
+            }
+          } unit_type_iterate_end;
+          break;
+        default:
+          break;
+        }
+      } requirement_vector_iterate_end;
+    } action_enabler_list_iterate_end;
+  } action_iterate_all_end;
+
+  ae_actor_index_valid = TRUE;
+}
+
+/**********************************************************************//**
+  Returns TRUE iff the action enabler can't be fulfilled by an actor unit
+  of the specified unit type no matter the rest of the actor context.
+
+  actor_utype may be nullptr. That stands for an unknown actor unit type.
+**************************************************************************/
+static inline bool
+ae_actor_utype_excluded(const struct action_enabler *enabler,
+                        const struct unit_type *actor_utype)
+{
+  return actor_utype != nullptr
+      && !BV_ISSET(enabler->actor_utypes, utype_index(actor_utype));
+}
+
 /**********************************************************************//**
   Returns a suggestion to add an obligatory hard requirement to an action
   enabler or nullptr if no hard obligatory reqs were missing. It is the
@@ -1704,8 +1794,6 @@ struct req_vec_problem *
 action_enabler_suggest_repair_oblig(const struct action_enabler *enabler)
 {
   struct action *paction;
-  enum action_sub_result sub_res;
-  struct req_vec_problem *out;
 
   /* Sanity check: a non existing action enabler is missing but it doesn't
    * miss any obligatory hard requirements. */
@@ -1716,32 +1804,10 @@ action_enabler_suggest_repair_oblig(const struct action_enabler *enabler)
   fc_assert_ret_val(action_id_exists(enabler_get_action_id(enabler)), nullptr);
   paction = enabler_get_action(enabler);
 
-  if (paction->result != ACTRES_NONE) {
-    /* A hard coded action result may mean obligatory requirements. */
-    out = ae_suggest_repair_if_no_oblig(enabler, oblig_hard_reqs_get(paction->result));
-    if (out != nullptr) {
-      return out;
-    }
-  }
-
-  for (sub_res = action_sub_result_begin();
-       sub_res != action_sub_result_end();
-       sub_res = action_sub_result_next(sub_res)) {
-    if (!BV_ISSET(paction->sub_results, sub_res)) {
-      /* Not relevant */
-      continue;
-    }
-
-    /* The action has this sub result. Check its hard requirements. */
-    out = ae_suggest_repair_if_no_oblig(enabler,
-                                        oblig_hard_reqs_get_sub(sub_res));
-    if (out != nullptr) {
-      return out;
-    }
-  }
-
-  /* No obligatory req problems found. */
-  return nullptr;
+  /* The requirements of the action's result and of all its sub results,
+   * merged to one indexed vector at first use. */
+  return ae_suggest_repair_if_no_oblig(enabler,
+                                       oblig_hard_reqs_get_merged(paction));
 }
 
 /**********************************************************************//**
@@ -3018,8 +3084,20 @@ bool action_enablers_allow(const action_id wanted_action,
                            const struct req_context *actor,
                            const struct req_context *target)
 {
+  const struct unit_type *actor_utype
+      = (actor != nullptr ? actor->unittype : nullptr);
+
+  if (actor_utype != nullptr && !ae_actor_index_valid) {
+    ae_actor_index_rebuild();
+  }
+
   action_enabler_list_iterate(action_enablers_for_action(wanted_action),
                               enabler) {
+    if (ae_actor_utype_excluded(enabler, actor_utype)) {
+      /* No actor unit of this type can fulfill the actor requirements. */
+      continue;
+    }
+
     if (is_enabler_active(enabler, actor, target)) {
       return TRUE;
     }
@@ -3763,9 +3841,19 @@ action_enabled_local(const action_id wanted_action,
     target = req_context_empty();
   }
 
+  if (actor->unittype != nullptr && !ae_actor_index_valid) {
+    ae_actor_index_rebuild();
+  }
+
   result = TRI_NO;
   action_enabler_list_iterate(action_enablers_for_action(wanted_action),
                               enabler) {
+    if (ae_actor_utype_excluded(enabler, actor->unittype)) {
+      /* The actor unit type is known to the actor player, so this
+       * enabler is known not to apply. */
+      continue;
+    }
+
     current = fc_tristate_and(mke_eval_reqs(actor->player,
                                             actor, target,
                                             &enabler->actor_reqs,
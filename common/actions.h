@@ -19,6 +19,7 @@
 #include "fc_types.h"
 #include "map_types.h"
 #include "requirements.h"
+#include "unittype.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -172,6 +173,11 @@ struct action_enabler
   struct requirement_vector actor_reqs;
   struct requirement_vector target_reqs;
 
+  /* Cache of the actor unit types that might fulfill actor_reqs. May
+   * include unit types the enabler never accepts but never misses one it
+   * does accept. Maintained by actions.c. */
+  bv_unit_types actor_utypes;
+
   struct {
     /* Only relevant for ruledit and other rulesave users. Indicates that
      * this action enabler is deleted and shouldn't be saved. */
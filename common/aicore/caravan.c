@@ -19,6 +19,7 @@
 
 /* utility */
 #include "log.h"
+#include "mem.h"
 
 /* common */
 #include "game.h"
@@ -44,6 +45,7 @@ void caravan_parameter_init_default(struct caravan_parameter *parameter)
   parameter->allow_foreign_trade = FTL_NATIONAL_ONLY;
   parameter->ignore_transit_time = FALSE;
   parameter->convert_trade = FALSE;
+  parameter->batch_valuations = FALSE;
   parameter->callback = nullptr;
 }
 
@@ -472,6 +474,145 @@ static bool does_foreign_trade_param_allow(const struct caravan_parameter *param
   return FALSE;
 }
 
+/* Per-turn memo of the arrival-time independent parts of
+ * get_discounted_reward(): which caravan actions are possible against
+ * the destination and the raw trade and windfall values. Keyed by
+ * source city, then destination city; shared by every caravan of the
+ * same kind evaluating the same pair this turn. */
+struct caravan_pair_value {
+  bool wonder_possible;
+  bool trade_possible;
+  bool windfall_possible;
+  double trade;
+  double windfall;
+};
+
+static void caravan_pair_value_destroy(struct caravan_pair_value *pv);
+
+#define SPECHASH_TAG pair_value
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_IDATA_TYPE struct caravan_pair_value *
+#define SPECHASH_IDATA_FREE caravan_pair_value_destroy
+#include "spechash.h"
+
+struct caravan_src_memo {
+  int utype;                    /* Caravan kind the values are for */
+  int owner;                    /* Its owner's player index */
+  bool broken_routes;           /* param->account_for_broken_routes */
+  struct pair_value_hash *dests;
+};
+
+static void caravan_src_memo_destroy(struct caravan_src_memo *memo);
+
+#define SPECHASH_TAG src_memo
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_IDATA_TYPE struct caravan_src_memo *
+#define SPECHASH_IDATA_FREE caravan_src_memo_destroy
+#include "spechash.h"
+
+static struct src_memo_hash *caravan_memo_hash = nullptr;
+static int caravan_memo_turn = -1;
+
+/************************************************************************//**
+  Free one memoized pair valuation.
+****************************************************************************/
+static void caravan_pair_value_destroy(struct caravan_pair_value *pv)
+{
+  free(pv);
+}
+
+/************************************************************************//**
+  Free the memoized valuations of one source city.
+****************************************************************************/
+static void caravan_src_memo_destroy(struct caravan_src_memo *memo)
+{
+  pair_value_hash_destroy(memo->dests);
+  free(memo);
+}
+
+/************************************************************************//**
+  Free the shared caravan valuation memo.
+****************************************************************************/
+void caravan_valuation_cache_free(void)
+{
+  if (caravan_memo_hash != nullptr) {
+    src_memo_hash_destroy(caravan_memo_hash);
+    caravan_memo_hash = nullptr;
+  }
+  caravan_memo_turn = -1;
+}
+
+/************************************************************************//**
+  Return the memoized valuation of the (src, dest) pair for this kind of
+  caravan, computing and storing it on first use this turn.
+****************************************************************************/
+static struct caravan_pair_value *
+caravan_pair_value_get(const struct unit *caravan,
+                       const struct caravan_parameter *param,
+                       const struct city *src, const struct city *dest)
+{
+  struct caravan_src_memo *memo;
+  struct caravan_pair_value *pv;
+  int utype = utype_index(unit_type_get(caravan));
+  int owner = player_index(unit_owner(caravan));
+  const struct civ_map *nmap = &(wld.map);
+
+  if (caravan_memo_turn != game.info.turn) {
+    caravan_valuation_cache_free();
+    caravan_memo_turn = game.info.turn;
+  }
+  if (caravan_memo_hash == nullptr) {
+    caravan_memo_hash = src_memo_hash_new();
+  }
+
+  if (!src_memo_hash_lookup(caravan_memo_hash, src->id, &memo)) {
+    memo = fc_malloc(sizeof(*memo));
+    memo->dests = pair_value_hash_new();
+    src_memo_hash_insert(caravan_memo_hash, src->id, memo);
+  } else if (memo->utype != utype || memo->owner != owner
+             || memo->broken_routes != param->account_for_broken_routes) {
+    /* A different kind of caravan from the same city; start over. */
+    pair_value_hash_destroy(memo->dests);
+    memo->dests = pair_value_hash_new();
+  }
+  memo->utype = utype;
+  memo->owner = owner;
+  memo->broken_routes = param->account_for_broken_routes;
+
+  if (!pair_value_hash_lookup(memo->dests, dest->id, &pv)) {
+    const struct goods_type *pgood = goods_from_city_to_unit(src, nullptr);
+    struct caravan_parameter vparam = *param;
+
+    /* Memoized values must not depend on which benefits this
+     * particular caravan considers. */
+    vparam.consider_trade = TRUE;
+    vparam.consider_windfall = TRUE;
+
+    pv = fc_malloc(sizeof(*pv));
+    pv->wonder_possible = action_prob_possible(
+        action_speculate_unit_on_city(nmap, ACTION_HELP_WONDER,
+                                      caravan, src, city_tile(dest),
+                                      TRUE, dest));
+    pv->trade_possible = action_prob_possible(
+        action_speculate_unit_on_city(nmap, ACTION_TRADE_ROUTE,
+                                      caravan, src, city_tile(dest),
+                                      TRUE, dest));
+    pv->windfall_possible = action_prob_possible(
+        action_speculate_unit_on_city(nmap, ACTION_MARKETPLACE,
+                                      caravan, src, city_tile(dest),
+                                      TRUE, dest));
+    pv->trade = (pv->trade_possible
+                 ? trade_benefit(city_owner(src), src, dest, pgood, &vparam)
+                 : 0.0);
+    pv->windfall = (pv->windfall_possible
+                    ? windfall_benefit(caravan, src, dest, pgood, &vparam)
+                    : 0.0);
+    pair_value_hash_insert(memo->dests, dest->id, pv);
+  }
+
+  return pv;
+}
+
 /************************************************************************//**
   Compute the discounted reward from the trade route that is indicated
   by the src, dest, and arrival_time fields of the result: Fills in
@@ -496,6 +637,7 @@ static bool get_discounted_reward(const struct unit *caravan,
   bool consider_trade;
   bool consider_windfall;
   struct goods_type *pgood;
+  struct caravan_pair_value *pv = nullptr;
   const struct civ_map *nmap = &(wld.map);
 
   /* If no foreign trade is allowed, just quit. */
@@ -504,21 +646,29 @@ static bool get_discounted_reward(const struct unit *caravan,
     return FALSE;
   }
 
-  consider_wonder = parameter->consider_wonders
-    && action_prob_possible(
-        action_speculate_unit_on_city(nmap, ACTION_HELP_WONDER,
-                                      caravan, src, city_tile(dest),
-                                      TRUE, dest));
-  consider_trade = parameter->consider_trade
-    && action_prob_possible(
-        action_speculate_unit_on_city(nmap, ACTION_TRADE_ROUTE,
-                                      caravan, src, city_tile(dest),
-                                      TRUE, dest));
-  consider_windfall = parameter->consider_windfall
-    && action_prob_possible(
-        action_speculate_unit_on_city(nmap, ACTION_MARKETPLACE,
-                                      caravan, src, city_tile(dest),
-                                      TRUE, dest));
+  if (parameter->batch_valuations) {
+    pv = caravan_pair_value_get(caravan, parameter, src, dest);
+    consider_wonder = parameter->consider_wonders && pv->wonder_possible;
+    consider_trade = parameter->consider_trade && pv->trade_possible;
+    consider_windfall = parameter->consider_windfall
+      && pv->windfall_possible;
+  } else {
+    consider_wonder = parameter->consider_wonders
+      && action_prob_possible(
+          action_speculate_unit_on_city(nmap, ACTION_HELP_WONDER,
+                                        caravan, src, city_tile(dest),
+                                        TRUE, dest));
+    consider_trade = parameter->consider_trade
+      && action_prob_possible(
+          action_speculate_unit_on_city(nmap, ACTION_TRADE_ROUTE,
+                                        caravan, src, city_tile(dest),
+                                        TRUE, dest));
+    consider_windfall = parameter->consider_windfall
+      && action_prob_possible(
+          action_speculate_unit_on_city(nmap, ACTION_MARKETPLACE,
+                                        caravan, src, city_tile(dest),
+                                        TRUE, dest));
+  }
 
   if (!consider_wonder && !consider_trade && !consider_windfall) {
     /* No caravan action is possible against this target. */
@@ -540,7 +690,9 @@ static bool get_discounted_reward(const struct unit *caravan,
   pgood = goods_from_city_to_unit(src, nullptr);
 
   if (consider_trade) {
-    trade = trade_benefit(pplayer_src, src, dest, pgood, parameter);
+    trade = (pv != nullptr
+             ? pv->trade
+             : trade_benefit(pplayer_src, src, dest, pgood, parameter));
     if (parameter->horizon == FC_INFINITY) {
       trade = perpetuity(trade, discount);
     } else {
@@ -552,7 +704,9 @@ static bool get_discounted_reward(const struct unit *caravan,
   }
 
   if (consider_windfall) {
-    windfall = windfall_benefit(caravan, src, dest, pgood, parameter);
+    windfall = (pv != nullptr
+                ? pv->windfall
+                : windfall_benefit(caravan, src, dest, pgood, parameter));
     windfall = presentvalue(windfall, arrival_time, discount);
   } else {
     windfall = 0.0;
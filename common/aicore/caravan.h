@@ -115,6 +115,14 @@ struct caravan_parameter {
      */
     bool convert_trade;
 
+    /*
+     * Share the (source, destination) trade and windfall valuations with
+     * the other caravans evaluated this turn instead of recomputing them
+     * for each unit. The shared values ignore trade routes established
+     * earlier the same turn.
+     */
+    bool batch_valuations;
+
     /*
      * This callback, if non-null, is called whenever a trade route
      * is evaluated.  One intended usage is for collecting all the
@@ -148,6 +156,8 @@ void caravan_find_best_destination(const struct civ_map *nmap,
                                    const struct caravan_parameter *parameter,
                                    struct caravan_result *result, bool omniscient);
 
+void caravan_valuation_cache_free(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
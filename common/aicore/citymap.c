@@ -52,8 +52,37 @@
 
 static int *citymap = nullptr;
 
+/* Incrementally maintained summary: for each tile, the number of
+ * reserved (negative) citymap entries within the settler conflict
+ * radius, so placement evaluations read one value instead of scanning
+ * the square. All citymap writes that may change the sign of an entry
+ * go through citymap_set() to keep it in step. */
+static int *citymap_resv_near = nullptr;
+static int citymap_resv_radius = 0;
+
 #define log_citymap log_debug
 
+/**********************************************************************//**
+  Write one citymap entry, updating the nearby-reservation summary when
+  the tile changes between reserved and unreserved.
+**************************************************************************/
+static void citymap_set(struct tile *ptile, int value)
+{
+  int tindex = tile_index(ptile);
+  bool was_reserved = (citymap[tindex] < 0);
+  bool now_reserved = (value < 0);
+
+  citymap[tindex] = value;
+
+  if (was_reserved != now_reserved) {
+    int diff = now_reserved ? 1 : -1;
+
+    square_iterate(&(wld.map), ptile, citymap_resv_radius, tile1) {
+      citymap_resv_near[tile_index(tile1)] += diff;
+    } square_iterate_end;
+  }
+}
+
 /**********************************************************************//**
   Initialize citymap by reserving worked tiles and establishing the
   crowdedness of (virtual) cities.
@@ -67,6 +96,12 @@ void citymap_turn_init(struct player *pplayer)
    * of the game (but it's easier than a separate function to do this). */
   citymap = fc_realloc(citymap, MAP_INDEX_SIZE * sizeof(*citymap));
   memset(citymap, 0, MAP_INDEX_SIZE * sizeof(*citymap));
+  citymap_resv_near = fc_realloc(citymap_resv_near,
+                                 MAP_INDEX_SIZE
+                                 * sizeof(*citymap_resv_near));
+  memset(citymap_resv_near, 0,
+         MAP_INDEX_SIZE * sizeof(*citymap_resv_near));
+  citymap_resv_radius = game.info.citymindist - 1;
 
   players_iterate(pother) {
     city_list_iterate(pother->cities, pcity) {
@@ -79,7 +114,7 @@ void citymap_turn_init(struct player *pplayer)
         struct city *pwork = tile_worked(ptile);
 
         if (pwork != nullptr) {
-          citymap[tile_index(ptile)] = -(pwork->id);
+          citymap_set(ptile, -(pwork->id));
         } else {
           citymap[tile_index(ptile)]++;
         }
@@ -99,7 +134,7 @@ void citymap_turn_init(struct player *pplayer)
         }
       } city_tile_iterate_end;
 
-      citymap[tile_index(punit->goto_tile)] = -(punit->id);
+      citymap_set(punit->goto_tile, -(punit->id));
     }
   } unit_list_iterate_end;
 }
@@ -112,6 +147,9 @@ void citymap_free(void)
   if (citymap != nullptr) {
     FC_FREE(citymap);
   }
+  if (citymap_resv_near != nullptr) {
+    FC_FREE(citymap_resv_near);
+  }
 }
 
 /**********************************************************************//**
@@ -134,14 +172,14 @@ void citymap_reserve_city_spot(struct tile *ptile, int id)
    * Uses the default city map size / squared city radius. */
   city_tile_iterate(nmap, CITY_MAP_DEFAULT_RADIUS_SQ, ptile, ptile1) {
     if (citymap[tile_index(ptile1)] == -id) {
-      citymap[tile_index(ptile1)] = 0;
+      citymap_set(ptile1, 0);
     }
     if (citymap[tile_index(ptile1)] >= 0) {
       citymap[tile_index(ptile1)]++;
     }
   } city_tile_iterate_end;
 
-  citymap[tile_index(ptile)] = -(id);
+  citymap_set(ptile, -(id));
 }
 
 /**********************************************************************//**
@@ -153,7 +191,7 @@ void citymap_free_city_spot(struct tile *ptile, int id)
 
   city_tile_iterate(nmap, CITY_MAP_DEFAULT_RADIUS_SQ, ptile, ptile1) {
     if (citymap[tile_index(ptile1)] == -(id)) {
-      citymap[tile_index(ptile1)] = 0;
+      citymap_set(ptile1, 0);
     } else if (citymap[tile_index(ptile1)] > 0) {
       citymap[tile_index(ptile1)]--;
     }
@@ -170,7 +208,7 @@ void citymap_reserve_tile(struct tile *ptile, int id)
   fc_assert_ret(!citymap_is_reserved(ptile));
 #endif
 
-  citymap[tile_index(ptile)] = -id;
+  citymap_set(ptile, -id);
 }
 
 /**********************************************************************//**
@@ -183,6 +221,17 @@ int citymap_read(struct tile *ptile)
   return citymap[tile_index(ptile)];
 }
 
+/**********************************************************************//**
+  Returns the number of reserved tiles within the settler conflict
+  radius (citymindist - 1) of the tile. Maintained incrementally by the
+  reservation writes; note that tiles that became worked after
+  citymap_turn_init() without being claimed are not counted.
+**************************************************************************/
+int citymap_reserved_nearby(const struct tile *ptile)
+{
+  return citymap_resv_near[tile_index(ptile)];
+}
+
 /**********************************************************************//**
   A tile is reserved if it contains a city or unit id, or a worker is
   assigned to it.
@@ -28,6 +28,7 @@ void citymap_reserve_city_spot(struct tile *ptile, int id);
 void citymap_free_city_spot(struct tile *ptile, int id);
 void citymap_reserve_tile(struct tile *ptile, int id);
 int citymap_read(struct tile *ptile);
+int citymap_reserved_nearby(const struct tile *ptile);
 bool citymap_is_reserved(struct tile *ptile);
 
 void citymap_free(void);
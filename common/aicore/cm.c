@@ -20,6 +20,7 @@
 
 /* utility */
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "shared.h"
@@ -28,6 +29,7 @@
 
 /* common */
 #include "city.h"
+#include "effects.h"
 #include "game.h"
 #include "government.h"
 #include "map.h"
@@ -192,6 +194,17 @@ struct partial_solution {
   int idle;             /* number of idle workers */
 };
 
+/*
+ * The incumbent best fitness, shared between the workers of a parallel
+ * search so that every worker prunes against the globally best known
+ * solution. Solutions themselves stay per-worker; see
+ * cm_find_best_solution_parallel().
+ */
+struct cm_shared_best {
+  struct cm_fitness value;
+  fc_mutex mutex;
+};
+
 /*
  * State of the search.
  * This holds all the information needed to do the search, all in one
@@ -206,6 +219,12 @@ struct cm_state {
   struct tile_type_vector lattice;
   struct tile_type_vector lattice_by_prod[O_LAST];
 
+  /* Contiguous copy of the lattice production values, one row of O_LAST
+   * ints per lattice index. The per-node accumulation in add_workers()
+   * walks this table instead of chasing cm_tile_type pointers; the rows
+   * are refreshed whenever the lattice is re-sorted. */
+  int *tile_prod;
+
   /* the best known solution, and its fitness */
   struct partial_solution best;
   struct cm_fitness best_value;
@@ -232,6 +251,21 @@ struct cm_state {
   } choice;
 
   bool *workers_map; /* placement of the workers within the city map */
+
+  /* Parallel search support. Depth-0 choices with
+   * (choice % stride != offset) are skipped, which partitions the top
+   * of the choice tree among the workers; 'shared' carries the global
+   * incumbent fitness for pruning. A plain search has stride 1 and no
+   * shared incumbent. */
+  struct cm_shared_best *shared;
+  int stride, offset;
+  int root_idle;                /* current.idle of the empty solution */
+  struct cm_fitness best_owned; /* fitness of our own 'best' */
+
+  /* Per-search work counters, folded into cm_stats_totals once the
+   * search is done. */
+  unsigned long stat_nodes;
+  unsigned long stat_prunes;
 };
 
 
@@ -284,6 +318,219 @@ static double estimate_fitness(const struct cm_state *state,
 			       const int production[]);
 static bool choice_is_promising(struct cm_state *state, int newchoice,
                                 bool negative_ok);
+static void cm_query_result_fresh(struct city *pcity,
+                                  const struct cm_parameter *param,
+                                  struct cm_result *result,
+                                  bool negative_ok);
+
+/*
+ * Memoized query results, keyed by city id. A hash plus a verbatim copy
+ * of every input the solver looks at guards reuse: when a city comes
+ * back unchanged on the next turn - the common case - the stored
+ * arrangement is served without searching. Any input or parameter
+ * mismatch simply falls through to a fresh search which then replaces
+ * the entry.
+ */
+struct cm_memo_entry {
+  int city_id;
+  unsigned input_hash;
+  /* The exact value sequence behind 'input_hash'; lookups verify full
+   * equality against it, so a 32-bit collision can never serve a wrong
+   * arrangement. */
+  unsigned *input_key;
+  int input_key_len;
+  struct cm_parameter parameter;
+  struct cm_result *result;
+
+  /* Cost of the last fresh solve, for cm_stats_by_city(). */
+  unsigned long last_nodes;
+  double last_seconds;
+};
+
+static void cm_memo_entry_destroy(struct cm_memo_entry *entry);
+
+#define SPECHASH_TAG cm_memo
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_IDATA_TYPE struct cm_memo_entry *
+#define SPECHASH_IDATA_FREE cm_memo_entry_destroy
+#include "spechash.h"
+#define cm_memo_hash_data_iterate(phash, data)                              \
+  TYPED_HASH_DATA_ITERATE(struct cm_memo_entry *, phash, data)
+#define cm_memo_hash_data_iterate_end HASH_DATA_ITERATE_END
+
+static struct cm_memo_hash *cm_memo = nullptr;
+
+/* Always-on counters behind cm_stats_get(). They are only touched from
+ * the querying thread: the per-search node and prune counts live in the
+ * cm_state and are folded in after any worker threads have been
+ * joined. */
+static struct cm_stats cm_stats_totals;
+static struct timer *cm_stats_timer = nullptr;
+
+/************************************************************************//**
+  Destroy one memoized result.
+****************************************************************************/
+static void cm_memo_entry_destroy(struct cm_memo_entry *entry)
+{
+  cm_result_destroy(entry->result);
+  free(entry->input_key);
+  free(entry);
+}
+
+/*
+ * The input values of the current query in hashing order, kept verbatim
+ * alongside the running hash so that memo lookups can compare the full
+ * key instead of trusting the hash alone. Scratch, like cm_snapshot.
+ */
+static struct {
+  unsigned *vals;
+  int len;
+  int cap;
+} cm_key = { nullptr, 0, 0 };
+
+/************************************************************************//**
+  Append one value to the current input key.
+****************************************************************************/
+static void cm_key_push(unsigned val)
+{
+  if (cm_key.len == cm_key.cap) {
+    cm_key.cap = MAX(64, cm_key.cap * 2);
+    cm_key.vals = fc_realloc(cm_key.vals,
+                             cm_key.cap * sizeof(*cm_key.vals));
+  }
+  cm_key.vals[cm_key.len++] = val;
+}
+
+/*
+ * Per-query snapshot of tile workability and outputs, captured while
+ * hashing the city inputs and consumed when building the lattice, so
+ * the effects machinery is consulted only once per tile. A single-tile
+ * change thus costs one walk: the hash pass that detects it also
+ * gathers the values the lattice rebuild needs.
+ */
+struct cm_tile_snap {
+  bool workable;
+  int production[O_LAST];
+};
+
+static struct {
+  int city_id;
+  int radius_sq;
+  bool valid;
+  struct cm_tile_snap *tiles;
+  int num_tiles;
+} cm_snapshot = { -1, -1, FALSE, nullptr, 0 };
+
+/************************************************************************//**
+  Return the snapshot for this city if the current query captured one,
+  or nullptr when the lattice must fall back to querying the effects
+  machinery itself.
+****************************************************************************/
+static const struct cm_tile_snap *cm_snapshot_get(const struct city *pcity)
+{
+  if (cm_snapshot.valid
+      && cm_snapshot.city_id == pcity->id
+      && cm_snapshot.radius_sq == city_map_radius_sq_get(pcity)) {
+    return cm_snapshot.tiles;
+  }
+
+  return nullptr;
+}
+
+/************************************************************************//**
+  Hash every city input the solver depends on: the effect epoch,
+  government and war states behind happiness, the workable tile
+  outputs, the output bonuses, the specialist outputs, the sizes and
+  stocks, the tax rates, and the supported and garrisoned units. The
+  same values are recorded in cm_key as the full lookup key, so a hash
+  collision cannot serve a wrong arrangement.
+****************************************************************************/
+static unsigned cm_input_hash(struct city *pcity)
+{
+  const struct civ_map *nmap = &(wld.map);
+  struct tile *pcenter = city_tile(pcity);
+  int city_radius_sq = city_map_radius_sq_get(pcity);
+  bool is_celebrating = base_city_celebrating(pcity);
+  const struct player *pplayer = city_owner(pcity);
+  unsigned hash = 2166136261u;
+
+#define cm_hash_mix(val)                                                    \
+  do {                                                                      \
+    unsigned mixval_ = (unsigned) (val);                                    \
+    cm_key_push(mixval_);                                                   \
+    hash = (hash ^ mixval_) * 16777619u;                                    \
+  } while (FALSE)
+
+  cm_key.len = 0;
+
+  /* Happiness and bonus effects - martial law, MAKE_CONTENT buildings,
+   * and the like - expire with the effect cache epoch; the government
+   * and the war states feed unhappiness directly. */
+  cm_hash_mix(effect_cache_epoch());
+  cm_hash_mix(government_number(government_of_player(pplayer)));
+  players_iterate(aplayer) {
+    cm_hash_mix(player_diplstate_get(pplayer, aplayer)->type);
+  } players_iterate_end;
+
+  cm_hash_mix(city_size_get(pcity));
+  cm_hash_mix(city_radius_sq);
+  cm_hash_mix(pcity->food_stock);
+  cm_hash_mix(player_number(pplayer));
+  cm_hash_mix(pplayer->economic.tax);
+  cm_hash_mix(pplayer->economic.luxury);
+  cm_hash_mix(pplayer->economic.science);
+
+  output_type_iterate(o) {
+    cm_hash_mix(pcity->bonus[o]);
+  } output_type_iterate_end;
+
+  specialist_type_iterate(sp) {
+    cm_hash_mix(pcity->specialists[sp]);
+    output_type_iterate(o) {
+      cm_hash_mix(get_specialist_output(pcity, sp, o));
+    } output_type_iterate_end;
+  } specialist_type_iterate_end;
+
+  /* Capture the per-tile values into the snapshot as we hash them;
+   * init_tile_lattice() reads them back instead of recomputing. */
+  if (cm_snapshot.num_tiles < city_map_tiles(city_radius_sq)) {
+    cm_snapshot.num_tiles = city_map_tiles(city_radius_sq);
+    cm_snapshot.tiles = fc_realloc(cm_snapshot.tiles,
+                                   cm_snapshot.num_tiles
+                                   * sizeof(*cm_snapshot.tiles));
+  }
+  cm_snapshot.city_id = pcity->id;
+  cm_snapshot.radius_sq = city_radius_sq;
+  cm_snapshot.valid = TRUE;
+
+  city_tile_iterate_index(nmap, city_radius_sq, pcenter, ptile, ctindex) {
+    struct cm_tile_snap *snap = &cm_snapshot.tiles[ctindex];
+
+    snap->workable = city_can_work_tile(pcity, ptile);
+    cm_hash_mix(ctindex);
+    cm_hash_mix(snap->workable);
+    output_type_iterate(o) {
+      snap->production[o] = city_tile_output(pcity, ptile, is_celebrating,
+                                             o);
+      cm_hash_mix(snap->production[o]);
+    } output_type_iterate_end;
+  } city_tile_iterate_index_end;
+
+  /* Happiness and upkeep contributed by units; moving or losing one
+   * re-solves. */
+  cm_hash_mix(unit_list_size(pcenter->units));
+  unit_list_iterate(pcity->units_supported, punit) {
+    cm_hash_mix(utype_number(unit_type_get(punit)));
+    cm_hash_mix(tile_index(unit_tile(punit)));
+    output_type_iterate(o) {
+      cm_hash_mix(punit->upkeep[o]);
+    } output_type_iterate_end;
+  } unit_list_iterate_end;
+
+#undef cm_hash_mix
+
+  return hash;
+}
 
 /************************************************************************//**
   Initialize the CM data at the start of each game.  Note the citymap
@@ -321,7 +568,9 @@ void cm_init_citymap(void)
 ****************************************************************************/
 void cm_clear_cache(struct city *pcity)
 {
-  /* The B&B algorithm doesn't have city caches so there's nothing to do. */
+  if (cm_memo != nullptr) {
+    cm_memo_hash_remove(cm_memo, pcity->id);
+  }
 }
 
 /************************************************************************//**
@@ -329,6 +578,25 @@ void cm_clear_cache(struct city *pcity)
 ****************************************************************************/
 void cm_free(void)
 {
+  if (cm_memo != nullptr) {
+    cm_memo_hash_destroy(cm_memo);
+    cm_memo = nullptr;
+  }
+
+  cm_snapshot.valid = FALSE;
+  cm_snapshot.num_tiles = 0;
+  FC_FREE(cm_snapshot.tiles);
+
+  cm_key.len = 0;
+  cm_key.cap = 0;
+  FC_FREE(cm_key.vals);
+
+  if (cm_stats_timer != nullptr) {
+    timer_destroy(cm_stats_timer);
+    cm_stats_timer = nullptr;
+  }
+  memset(&cm_stats_totals, 0, sizeof(cm_stats_totals));
+
 #ifdef GATHER_TIME_STATS
   print_performance(&performance.greedy);
   print_performance(&performance.opt);
@@ -1235,6 +1503,19 @@ static void sort_lattice_by_fitness(const struct cm_state *state,
   print_lattice(LOG_LATTICE, lattice);
 }
 
+/************************************************************************//**
+  (Re)fill the contiguous production table from the lattice. Must be
+  called after every re-sort, since sorting reassigns the lattice
+  indices the rows are keyed by.
+****************************************************************************/
+static void refresh_tile_prod_table(struct cm_state *state)
+{
+  tile_type_vector_iterate(&state->lattice, ptype) {
+    memcpy(state->tile_prod + ptype->lattice_index * O_LAST,
+           ptype->production, sizeof(ptype->production));
+  } tile_type_vector_iterate_end;
+}
+
 /************************************************************************//**
   Create the lattice.
 ****************************************************************************/
@@ -1244,6 +1525,7 @@ static void init_tile_lattice(struct city *pcity,
   struct cm_tile_type type;
   struct tile *pcenter = city_tile(pcity);
   const struct civ_map *nmap = &(wld.map);
+  const struct cm_tile_snap *snaps = cm_snapshot_get(pcity);
 
   /* Add all the fields into the lattice */
   tile_type_init(&type); /* Init just once */
@@ -1252,6 +1534,13 @@ static void init_tile_lattice(struct city *pcity,
                           ctindex) {
     if (is_free_worked(pcity, ptile)) {
       continue;
+    } else if (snaps != nullptr) {
+      /* Workability and outputs were already computed while hashing. */
+      if (snaps[ctindex].workable) {
+        memcpy(type.production, snaps[ctindex].production,
+               sizeof(type.production));
+        tile_type_lattice_add(lattice, &type, ctindex);
+      }
     } else if (city_can_work_tile(pcity, ptile)) {
       compute_tile_production(pcity, ptile, &type); /* Clobbers type */
       tile_type_lattice_add(lattice, &type, ctindex); /* Copy type if needed */
@@ -1352,11 +1641,15 @@ static void add_workers(struct partial_solution *soln,
     } tile_type_vector_iterate_end;
   }
 
-  /* update production */
-  output_type_iterate(stat_index) {
-    newcount = soln->production[stat_index] + number * ptype->production[stat_index];
-    soln->production[stat_index] = newcount;
-  } output_type_iterate_end;
+  /* update production; the contiguous row keeps this fixed-length loop
+   * in one cache line and open to the compiler's vectorizer */
+  {
+    const int *row = state->tile_prod + itype * O_LAST;
+
+    output_type_iterate(stat_index) {
+      soln->production[stat_index] += number * row[stat_index];
+    } output_type_iterate_end;
+  }
 }
 
 /************************************************************************//**
@@ -1417,6 +1710,11 @@ static int next_choice(struct cm_state *state, int oldchoice, bool negative_ok)
        newchoice < num_types(state); newchoice++) {
     const struct cm_tile_type *ptype = tile_type_get(state, newchoice);
 
+    if (state->stride > 1 && state->current.idle == state->root_idle
+        && newchoice % state->stride != state->offset) {
+      /* A depth-0 choice belonging to another parallel worker. */
+      continue;
+    }
     if (!ptype->is_specialist && (state->current.worker_counts[newchoice]
                                   == tile_vector_size(&ptype->tiles))) {
       /* we've already used all these tiles */
@@ -1428,6 +1726,7 @@ static int next_choice(struct cm_state *state, int oldchoice, bool negative_ok)
     }
     if (!choice_is_promising(state, newchoice, negative_ok)) {
       /* heuristic says we can't beat the best going this way */
+      state->stat_prunes++;
       log_base(LOG_PRUNE_BRANCH, "--- pruning branch ---");
       print_partial_solution(LOG_PRUNE_BRANCH, &state->current, state);
       print_tile_type(LOG_PRUNE_BRANCH, tile_type_get(state, newchoice),
@@ -1483,6 +1782,20 @@ static bool take_child_choice(struct cm_state *state, bool negative_ok)
     return FALSE;
   }
 
+  /* Screen the node once with the relaxation over the remaining
+   * lattice, i.e. the bound with no worker placement forced. It
+   * dominates every candidate's own bound, so nothing it rejects could
+   * have survived the scan below, and one computation replaces one per
+   * candidate; candidates that pass are still checked precisely in
+   * next_choice(). With a single idle worker the per-candidate bound
+   * takes the cheap shortcut in compute_max_stats_heuristic(), so
+   * there the screen would cost more than it saves. */
+  if (state->current.idle > 1 && !choice_is_promising(state, -1, negative_ok)) {
+    state->stat_prunes++;
+    log_base(LOG_PRUNE_BRANCH, "--- pruning every child of this node ---");
+    return FALSE;
+  }
+
   if (state->choice.size == 0) {
     oldchoice = 0;
   } else {
@@ -1585,6 +1898,11 @@ static int specialists_in_solution(const struct cm_state *state,
   best in at least one stat, the partial solution isn't worth anything.
 
   This function computes the max-stats produced by a partial solution.
+
+  A negative check_choice computes the relaxation over the remaining
+  lattice without forcing any worker placement. Since every candidate
+  choice only restricts the completions available, that bound dominates
+  the bound of every child; see next_choice().
 ****************************************************************************/
 static void compute_max_stats_heuristic(const struct cm_state *state,
                                         const struct partial_solution *soln,
@@ -1598,14 +1916,14 @@ static void compute_max_stats_heuristic(const struct cm_state *state,
      most possible of each kind of production the idle workers could
      produce */
 
-  if (soln->idle == 1) {
+  if (soln->idle == 1 && check_choice >= 0) {
     /* Then the total solution is soln + this new worker. So we know the
        production exactly, and can shortcut the later code. */
-    const struct cm_tile_type *ptype = tile_type_get(state, check_choice);
+    const int *row = state->tile_prod + check_choice * O_LAST;
 
     memcpy(production, soln->production, sizeof(soln->production));
     output_type_iterate(stat_index) {
-      production[stat_index] += ptype->production[stat_index];
+      production[stat_index] += row[stat_index];
     } output_type_iterate_end;
 
   } else {
@@ -1619,7 +1937,9 @@ static void compute_max_stats_heuristic(const struct cm_state *state,
       /* compute the solution that has soln, then the check_choice,
          then complete it with the best available tiles for the stat. */
       copy_partial_solution(&solnplus, soln, state);
-      add_worker(&solnplus, check_choice, state);
+      if (check_choice >= 0) {
+        add_worker(&solnplus, check_choice, state);
+      }
       complete_solution(&solnplus, state, &state->lattice_by_prod[stat_index]);
 
       production[stat_index] = solnplus.production[stat_index];
@@ -1824,15 +2144,40 @@ static double estimate_fitness(const struct cm_state *state,
 ****************************************************************************/
 static bool bb_next(struct cm_state *state, bool negative_ok)
 {
+  state->stat_nodes++;
+
   /* if no idle workers, then look at our solution. */
   if (state->current.idle == 0) {
-    struct cm_fitness value = evaluate_solution(state, &state->current);
+    struct cm_fitness value;
+
+    if (state->shared != nullptr) {
+      /* Adopt the global incumbent, so we prune against the best
+       * solution any worker has found. */
+      fc_mutex_allocate(&state->shared->mutex);
+      if (fitness_better(state->shared->value, state->best_value)) {
+        state->best_value = state->shared->value;
+      }
+      fc_mutex_release(&state->shared->mutex);
+    }
+
+    value = evaluate_solution(state, &state->current);
 
     print_partial_solution(LOG_REACHED_LEAF, &state->current, state);
     if (fitness_better(value, state->best_value)) {
       log_base(LOG_BETTER_LEAF, "-> replaces previous best");
       copy_partial_solution(&state->best, &state->current, state);
       state->best_value = value;
+      state->best_owned = value;
+      if (state->shared != nullptr) {
+        fc_mutex_allocate(&state->shared->mutex);
+        if (fitness_better(value, state->shared->value)) {
+          state->shared->value = value;
+        } else {
+          /* Another worker got here first. */
+          state->best_value = state->shared->value;
+        }
+        fc_mutex_release(&state->shared->mutex);
+      }
     }
   }
 
@@ -1879,6 +2224,10 @@ static struct cm_state *cm_state_init(struct city *pcity, bool negative_ok)
   init_tile_lattice(pcity, &state->lattice);
   numtypes = tile_type_vector_size(&state->lattice);
 
+  /* Rows are filled once the lattice is sorted; see begin_search(). */
+  state->tile_prod = fc_malloc(numtypes * O_LAST
+                               * sizeof(*state->tile_prod));
+
   get_tax_rates(pplayer, rates);
 
   /* For the heuristic, make sorted copies of the lattice */
@@ -1925,6 +2274,12 @@ static struct cm_state *cm_state_init(struct city *pcity, bool negative_ok)
   state->workers_map = fc_calloc(city_map_tiles_from_city(state->pcity),
                                  sizeof(state->workers_map));
 
+  /* A plain single-threaded search, until a parallel driver says
+   * otherwise. */
+  state->shared = nullptr;
+  state->stride = 1;
+  state->offset = 0;
+
   return state;
 }
 
@@ -1995,6 +2350,7 @@ static void begin_search(struct cm_state *state,
   /* copy the parameter and sort the main lattice by it */
   cm_copy_parameter(&state->parameter, parameter);
   sort_lattice_by_fitness(state, &state->lattice);
+  refresh_tile_prod_table(state);
 
   if (parameter->max_growth) {
     state->parameter.minimal_surplus[O_FOOD] =
@@ -2005,11 +2361,15 @@ static void begin_search(struct cm_state *state,
 
   /* Clear out the old solution */
   state->best_value = worst_fitness();
+  state->best_owned = worst_fitness();
   destroy_partial_solution(&state->current);
   init_partial_solution(&state->current, num_types(state),
                         city_size_get(state->pcity),
                         negative_ok);
   state->choice.size = 0;
+  state->root_idle = state->current.idle;
+  state->stat_nodes = 0;
+  state->stat_prunes = 0;
 }
 
 /************************************************************************//**
@@ -2041,6 +2401,7 @@ static void cm_state_free(struct cm_state *state)
   destroy_partial_solution(&state->best);
   destroy_partial_solution(&state->current);
 
+  FC_FREE(state->tile_prod);
   FC_FREE(state->choice.stack);
   FC_FREE(state->workers_map);
   FC_FREE(state);
@@ -2117,6 +2478,115 @@ static void cm_find_best_solution(struct cm_state *state,
   end_search(state);
 }
 
+/* How many worker threads the parallel search uses. */
+#define CM_PARALLEL_WORKERS 4
+
+/* Cities smaller than this solve too quickly for threading to pay. */
+#define CM_PARALLEL_MIN_SIZE 8
+
+struct cm_parallel_worker {
+  struct cm_state *state;
+  struct city city_copy;
+  const struct cm_parameter *parameter;
+  struct cm_result *result;
+  bool negative_ok;
+  fc_thread thread;
+};
+
+/************************************************************************//**
+  Copy a search result into another result of the same city radius.
+****************************************************************************/
+static void cm_result_assign(struct cm_result *dst,
+                             const struct cm_result *src)
+{
+  fc_assert_ret(dst->city_radius_sq == src->city_radius_sq);
+
+  dst->aborted = src->aborted;
+  dst->found_a_valid = src->found_a_valid;
+  dst->disorder = src->disorder;
+  dst->happy = src->happy;
+  memcpy(dst->surplus, src->surplus, sizeof(dst->surplus));
+  memcpy(dst->specialists, src->specialists, sizeof(dst->specialists));
+  memcpy(dst->worker_positions, src->worker_positions,
+         city_map_tiles(dst->city_radius_sq)
+         * sizeof(*dst->worker_positions));
+}
+
+/************************************************************************//**
+  Thread body of one parallel search worker.
+****************************************************************************/
+static void cm_parallel_worker_run(void *data)
+{
+  struct cm_parallel_worker *worker = data;
+
+  cm_find_best_solution(worker->state, worker->parameter, worker->result,
+                        worker->negative_ok);
+}
+
+/************************************************************************//**
+  Run the branch & bound on a worker pool: the depth-0 choices are
+  partitioned among the workers and the incumbent fitness is shared for
+  pruning, so the pool explores the same tree as the plain search,
+  without overlap. The best solution over all workers wins.
+****************************************************************************/
+static void cm_find_best_solution_parallel(struct city *pcity,
+                                           const struct cm_parameter
+                                           *parameter,
+                                           struct cm_result *result,
+                                           bool negative_ok)
+{
+  struct cm_parallel_worker workers[CM_PARALLEL_WORKERS];
+  struct cm_parallel_worker *winner = nullptr;
+  struct cm_shared_best shared;
+  int i;
+
+  shared.value = worst_fitness();
+  fc_mutex_init(&shared.mutex);
+
+  for (i = 0; i < CM_PARALLEL_WORKERS; i++) {
+    struct cm_parallel_worker *worker = &workers[i];
+
+    /* The states are built sequentially from the real city; each worker
+     * then mutates only a private shallow copy during evaluation. The
+     * copy shares read-only pointers (tile cache, supported unit lists)
+     * with the original, which nothing writes to while we search. */
+    worker->state = cm_state_init(pcity, negative_ok);
+    worker->city_copy = *pcity;
+    worker->state->pcity = &worker->city_copy;
+    worker->state->shared = &shared;
+    worker->state->stride = CM_PARALLEL_WORKERS;
+    worker->state->offset = i;
+    worker->parameter = parameter;
+    worker->result = cm_result_new(pcity);
+    worker->negative_ok = negative_ok;
+    fc_thread_start(&worker->thread, cm_parallel_worker_run, worker);
+  }
+
+  for (i = 0; i < CM_PARALLEL_WORKERS; i++) {
+    struct cm_parallel_worker *worker = &workers[i];
+
+    fc_thread_wait(&worker->thread);
+    if (winner == nullptr
+        || fitness_better(worker->state->best_owned,
+                          winner->state->best_owned)) {
+      winner = worker;
+    }
+  }
+
+  /* The surpluses and worker placement of a solution do not depend on
+   * which city copy evaluated it, so the winner's result can be handed
+   * to the caller as is. */
+  cm_result_assign(result, winner->result);
+
+  for (i = 0; i < CM_PARALLEL_WORKERS; i++) {
+    cm_stats_totals.nodes += workers[i].state->stat_nodes;
+    cm_stats_totals.prunes += workers[i].state->stat_prunes;
+    cm_result_destroy(workers[i].result);
+    cm_state_free(workers[i].state);
+  }
+  fc_mutex_destroy(&shared.mutex);
+}
+
 /************************************************************************//**
   Wrapper that actually runs the branch & bound, and returns the best
   solution.
@@ -2125,16 +2595,166 @@ void cm_query_result(struct city *pcity,
                      const struct cm_parameter *param,
                      struct cm_result *result, bool negative_ok)
 {
-  struct cm_state *state = cm_state_init(pcity, negative_ok);
   const struct civ_map *nmap = &(wld.map);
+  struct cm_memo_entry *entry = nullptr;
+  unsigned hash;
+  unsigned long nodes_before;
+  double seconds_before;
+
+  cm_stats_totals.queries++;
 
   /* Refresh the city. Otherwise the CM can give wrong results or just be
    * slower than necessary. Note that cities are often passed in in an
    * unrefreshed state (which should probably be fixed). */
   city_refresh_from_main_map(nmap, pcity, nullptr);
 
-  cm_find_best_solution(state, param, result, negative_ok);
-  cm_state_free(state);
+  hash = cm_input_hash(pcity);
+  if (cm_memo == nullptr) {
+    cm_memo = cm_memo_hash_new();
+  } else if (cm_memo_hash_lookup(cm_memo, pcity->id, &entry)
+             && entry->input_hash == hash
+             && entry->input_key_len == cm_key.len
+             && memcmp(entry->input_key, cm_key.vals,
+                       cm_key.len * sizeof(*cm_key.vals)) == 0
+             && entry->result->city_radius_sq
+                == city_map_radius_sq_get(pcity)
+             && cm_are_parameter_equal(&entry->parameter, param)) {
+    /* Nothing the solver looks at changed; serve the memoized
+     * arrangement. */
+    cm_stats_totals.memo_hits++;
+    cm_snapshot.valid = FALSE;
+    cm_result_assign(result, entry->result);
+    return;
+  }
+
+  nodes_before = cm_stats_totals.nodes;
+  seconds_before = (cm_stats_timer != nullptr
+                    ? timer_read_seconds(cm_stats_timer) : 0.0);
+
+  cm_query_result_fresh(pcity, param, result, negative_ok);
+
+  /* The snapshot is scratch for this query only. */
+  cm_snapshot.valid = FALSE;
+
+  if (result->aborted) {
+    /* A truncated search isn't worth remembering. */
+    return;
+  }
+
+  if (entry == nullptr) {
+    entry = fc_malloc(sizeof(*entry));
+    entry->result = cm_result_new(pcity);
+    entry->input_key = nullptr;
+    entry->input_key_len = 0;
+    cm_memo_hash_insert(cm_memo, pcity->id, entry);
+  } else if (entry->result->city_radius_sq
+             != city_map_radius_sq_get(pcity)) {
+    cm_result_destroy(entry->result);
+    entry->result = cm_result_new(pcity);
+  }
+  entry->city_id = pcity->id;
+  entry->input_hash = hash;
+  if (entry->input_key_len != cm_key.len) {
+    entry->input_key = fc_realloc(entry->input_key,
+                                  cm_key.len * sizeof(*entry->input_key));
+    entry->input_key_len = cm_key.len;
+  }
+  memcpy(entry->input_key, cm_key.vals,
+         cm_key.len * sizeof(*entry->input_key));
+  entry->last_nodes = cm_stats_totals.nodes - nodes_before;
+  entry->last_seconds = timer_read_seconds(cm_stats_timer) - seconds_before;
+  cm_copy_parameter(&entry->parameter, param);
+  cm_result_assign(entry->result, result);
+}
+
+/************************************************************************//**
+  Run the search unconditionally; cm_query_result() consults the memo
+  first.
+****************************************************************************/
+static void cm_query_result_fresh(struct city *pcity,
+                                  const struct cm_parameter *param,
+                                  struct cm_result *result,
+                                  bool negative_ok)
+{
+  if (cm_stats_timer == nullptr) {
+    cm_stats_timer = timer_new(TIMER_USER, TIMER_ACTIVE, "cm solver");
+  }
+  timer_start(cm_stats_timer);
+  cm_stats_totals.solves++;
+
+#ifndef GATHER_TIME_STATS
+  /* The performance bookkeeping of GATHER_TIME_STATS is not thread
+   * aware, so the pool is only used without it. */
+  if (city_size_get(pcity) >= CM_PARALLEL_MIN_SIZE) {
+    cm_find_best_solution_parallel(pcity, param, result, negative_ok);
+  } else
+#endif /* GATHER_TIME_STATS */
+  {
+    struct cm_state *state = cm_state_init(pcity, negative_ok);
+
+    cm_find_best_solution(state, param, result, negative_ok);
+    cm_stats_totals.nodes += state->stat_nodes;
+    cm_stats_totals.prunes += state->stat_prunes;
+    cm_state_free(state);
+  }
+
+  timer_stop(cm_stats_timer);
+}
+
+/************************************************************************//**
+  Copy the accumulated solver statistics to the caller.
+****************************************************************************/
+void cm_stats_get(struct cm_stats *stats)
+{
+  *stats = cm_stats_totals;
+  stats->wall_seconds = (cm_stats_timer != nullptr
+                         ? timer_read_seconds(cm_stats_timer) : 0.0);
+}
+
+/************************************************************************//**
+  Zero the accumulated solver statistics.
+****************************************************************************/
+void cm_stats_reset(void)
+{
+  memset(&cm_stats_totals, 0, sizeof(cm_stats_totals));
+  if (cm_stats_timer != nullptr) {
+    timer_clear(cm_stats_timer);
+  }
+}
+
+/************************************************************************//**
+  Fill 'stats' with up to 'max_len' cities, ordered by the wall time of
+  their last fresh solve, most expensive first. Returns the number of
+  cities filled in. Cities whose last query was served from the memo
+  keep the cost of the solve that produced the memoized arrangement.
+****************************************************************************/
+int cm_stats_by_city(struct cm_city_stats *stats, int max_len)
+{
+  int count = 0;
+
+  if (cm_memo == nullptr || max_len <= 0) {
+    return 0;
+  }
+
+  cm_memo_hash_data_iterate(cm_memo, entry) {
+    int pos;
+
+    if (count < max_len) {
+      count++;
+    } else if (stats[count - 1].wall_seconds >= entry->last_seconds) {
+      continue;
+    }
+    pos = count - 1;
+    while (pos > 0 && stats[pos - 1].wall_seconds < entry->last_seconds) {
+      stats[pos] = stats[pos - 1];
+      pos--;
+    }
+    stats[pos].city_id = entry->city_id;
+    stats[pos].nodes = entry->last_nodes;
+    stats[pos].wall_seconds = entry->last_seconds;
+  } cm_memo_hash_data_iterate_end;
+
+  return count;
 }
 
 /************************************************************************//**
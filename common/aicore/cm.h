@@ -83,6 +83,31 @@ void cm_query_result(struct city *pcity,
  */
 void cm_clear_cache(struct city *pcity);
 
+/*
+ * Always-on solver statistics, cheap enough for production builds
+ * (unlike the GATHER_TIME_STATS instrumentation which needs a debug
+ * build). Counters accumulate until cm_stats_reset().
+ */
+struct cm_stats {
+  unsigned long queries;   /* calls to cm_query_result() */
+  unsigned long memo_hits; /* queries answered without searching */
+  unsigned long solves;    /* branch-and-bound searches run */
+  unsigned long nodes;     /* search tree nodes expanded */
+  unsigned long prunes;    /* branches cut by the heuristic bound */
+  double wall_seconds;     /* time spent inside the solver */
+};
+
+/* Cost of the last fresh solve for one city. */
+struct cm_city_stats {
+  int city_id;
+  unsigned long nodes;
+  double wall_seconds;
+};
+
+void cm_stats_get(struct cm_stats *stats);
+void cm_stats_reset(void);
+int cm_stats_by_city(struct cm_city_stats *stats, int max_len);
+
 /***************** utility methods *************************************/
 bool cm_are_parameter_equal(const struct cm_parameter *const p1,
                             const struct cm_parameter *const p2);
@@ -15,13 +15,17 @@
 #include <fc_config.h>
 #endif
 
+#include <limits.h>
+
 /* utility */
 #include "bitvector.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "support.h"
 
 /* common */
+#include "effects.h"
 #include "game.h"
 #include "map.h"
 #include "movement.h"
@@ -36,6 +40,10 @@
 #define SPECPQ_TAG map_index
 #define SPECPQ_DATA_TYPE int
 #define SPECPQ_PRIORITY_TYPE int
+/* Track heap positions so that replacing a queued node's priority is a
+ * O(log n) decrease-key rather than a scan of the whole queue, and the
+ * fills keep exactly one live entry per map index. */
+#define SPECPQ_INDEXED
 #include "specpq.h"
 #define INITIAL_QUEUE_SIZE 100
 
@@ -46,14 +54,13 @@
 
 /* ======================== Internal structures ========================== */
 
-#ifdef PF_DEBUG
-/* The mode we use the pf_map. Used for cast conversion checks. */
+/* The mode we use the pf_map. Used for cast conversion checks and for
+ * per-mode statistics. */
 enum pf_mode {
   PF_NORMAL = 1,        /* Usual goto */
   PF_DANGER,            /* Goto with dangerous positions */
   PF_FUEL               /* Goto for fueled units */
 };
-#endif /* PF_DEBUG */
 
 enum pf_node_status {
   NS_UNINIT = 0,        /* memory is calloced, hence zero means
@@ -74,11 +81,14 @@ enum pf_zoc_type {
   ZOC_NO                /* No ZoC. */
 };
 
+/* Running per-mode counters, see pf_map_stats_get(). Indexed by
+ * (pf_mode - 1). */
+static struct pf_map_stats pf_stats[PF_STATS_MODE_COUNT];
+
 /* Abstract base class for pf_normal_map, pf_danger_map, and pf_fuel_map. */
 struct pf_map {
-#ifdef PF_DEBUG
-  enum pf_mode mode;    /* The mode of the map, for conversion checking. */
-#endif /* PF_DEBUG */
+  enum pf_mode mode;    /* The mode of the map, for conversion checking
+                         * and statistics. */
 
   /* "Virtual" function table. */
   void (*destroy) (struct pf_map *pfm); /* Destructor. */
@@ -91,6 +101,10 @@ struct pf_map {
   /* Private data. */
   struct tile *tile;          /* The current position (aka iterator). */
   struct pf_parameter params; /* Initial parameters. */
+  bool multi_source;          /* Seeded from several start tiles. */
+  int stale_cost_floor;       /* Results at this cost and above must be
+                               * recomputed; INT_MAX when fully valid.
+                               * See pf_map_cache_notify_change(). */
 };
 
 /* Down-cast macro. */
@@ -175,6 +189,18 @@ static inline int pf_total_CC(const struct pf_parameter *param,
   return PF_TURN_FACTOR * cost + extra * pf_move_rate(param);
 }
 
+/************************************************************************//**
+  Lower bound on the remaining cost-of-path from ptile towards the goal,
+  or 0 when the parameter carries no estimate. Added to queue priorities
+  only; recorded costs stay pure.
+****************************************************************************/
+static inline int pf_estimate_CC(const struct pf_parameter *param,
+                                 const struct tile *ptile)
+{
+  return (param->get_estimate != nullptr
+          ? param->get_estimate(ptile, param) : 0);
+}
+
 /************************************************************************//**
   Take a position previously filled out (as by fill_position) and "finalize"
   it by reversing all fuel multipliers.
@@ -197,6 +223,329 @@ static void pf_position_fill_start_tile(struct pf_position *pos,
                                         const struct pf_parameter *param);
 
 
+/* ================== Arena for segment records ========================== */
+
+/* Danger and fuel maps allocate and release many small segment records
+ * (struct pf_danger_pos arrays and struct pf_fuel_pos) while iterating.
+ * To avoid the malloc()/free() churn, each such map owns an arena which
+ * bump-allocates the records from large chunks, recycles fixed-size
+ * classes through free lists, and returns everything wholesale when the
+ * map is destroyed. */
+
+#define PF_ARENA_CHUNK_SIZE (64 * 1024)
+/* Sizes are rounded up to multiples of the pointer size; records of up
+ * to this many pointer words are recycled through free lists. */
+#define PF_ARENA_FREE_CLASSES 64
+
+struct pf_arena_chunk {
+  struct pf_arena_chunk *next;
+  /* The payload follows the header. */
+};
+
+struct pf_arena {
+  struct pf_arena_chunk *chunks;        /* Newest chunk first. */
+  char *top;                            /* Next free byte. */
+  size_t avail;                         /* Bytes left in newest chunk. */
+  void *free_lists[PF_ARENA_FREE_CLASSES];
+};
+
+/************************************************************************//**
+  Prepare an arena for usage. No memory is allocated yet.
+****************************************************************************/
+static void pf_arena_init(struct pf_arena *arena)
+{
+  memset(arena, 0, sizeof(*arena));
+}
+
+/************************************************************************//**
+  Round a record size up to a whole number of pointer words, the minimum
+  needed to thread records onto a free list.
+****************************************************************************/
+static inline size_t pf_arena_round_size(size_t size)
+{
+  if (size < sizeof(void *)) {
+    size = sizeof(void *);
+  }
+  return (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+}
+
+/************************************************************************//**
+  Allocate a record of 'size' bytes from the arena.
+****************************************************************************/
+static void *pf_arena_alloc(struct pf_arena *arena, size_t size)
+{
+  size_t class_idx;
+  void *ptr;
+
+  size = pf_arena_round_size(size);
+  class_idx = size / sizeof(void *);
+
+  if (class_idx < PF_ARENA_FREE_CLASSES
+      && arena->free_lists[class_idx] != nullptr) {
+    ptr = arena->free_lists[class_idx];
+    arena->free_lists[class_idx] = *(void **) ptr;
+    return ptr;
+  }
+
+  if (arena->avail < size) {
+    size_t payload = MAX(size, PF_ARENA_CHUNK_SIZE);
+    struct pf_arena_chunk *chunk
+      = fc_malloc(sizeof(struct pf_arena_chunk) + payload);
+
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->top = (char *) chunk + sizeof(struct pf_arena_chunk);
+    arena->avail = payload;
+  }
+
+  ptr = arena->top;
+  arena->top += size;
+  arena->avail -= size;
+
+  return ptr;
+}
+
+/************************************************************************//**
+  Return a record to the arena. Records too large for the free lists are
+  simply abandoned until pf_arena_clear().
+****************************************************************************/
+static void pf_arena_free(struct pf_arena *arena, void *ptr, size_t size)
+{
+  size_t class_idx;
+
+  size = pf_arena_round_size(size);
+  class_idx = size / sizeof(void *);
+
+  if (class_idx < PF_ARENA_FREE_CLASSES) {
+    *(void **) ptr = arena->free_lists[class_idx];
+    arena->free_lists[class_idx] = ptr;
+  }
+}
+
+/************************************************************************//**
+  Release all memory held by the arena, invalidating every record
+  allocated from it at once.
+****************************************************************************/
+static void pf_arena_clear(struct pf_arena *arena)
+{
+  struct pf_arena_chunk *chunk = arena->chunks, *next;
+
+  while (chunk != nullptr) {
+    next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  pf_arena_init(arena);
+}
+
+
+/* =================== Calibrated bucket queue =========================== */
+
+/* For parameters without extra costs or jumbo callbacks, every priority
+ * handled by the normal map fill is an exact multiple of PF_TURN_FACTOR
+ * and each Dijkstra step increases the move cost by at most one full
+ * move rate. Such fills can use a monotone bucket queue instead of the
+ * binary heap: O(1) insert and amortized O(1) removal, with stale
+ * entries skipped lazily on removal. */
+
+#define PF_BUCKET_MAX_BUCKETS 8192
+
+/* Sentinels for pf_bucket_queue::latest. */
+#define PF_BUCKET_UNQUEUED  INT_MIN
+#define PF_BUCKET_PROCESSED (INT_MIN + 1)
+
+struct pf_bucket_entry {
+  int tindex;
+  int cost;                     /* Scaled cost when pushed. */
+};
+
+struct pf_bucket {
+  struct pf_bucket_entry *entries;
+  int size, avail;
+};
+
+struct pf_bucket_queue {
+  int num_buckets;              /* Span of simultaneously live costs. */
+  int current;                  /* Scaled cost of the last removal. */
+  int count;                    /* Queued entries, including stale ones. */
+  bool started;
+  struct pf_bucket *buckets;    /* Circular, indexed by cost modulo. */
+  int *latest;                  /* Last pushed cost per map index. */
+};
+
+/************************************************************************//**
+  Returns a bucket queue calibrated for 'parameter', or nullptr if the
+  cost structure of the parameter is not bounded well enough and the
+  caller should use a binary heap instead.
+****************************************************************************/
+static struct pf_bucket_queue *
+pf_bucket_queue_new(const struct pf_parameter *parameter)
+{
+  struct pf_bucket_queue *bq;
+  int span, i;
+
+  if (parameter->get_costs != nullptr || parameter->get_EC != nullptr) {
+    /* Priorities are not multiples of PF_TURN_FACTOR. */
+    return nullptr;
+  }
+
+  if (parameter->get_estimate != nullptr) {
+    /* Goal-directed priorities do not grow by bounded steps. */
+    return nullptr;
+  }
+
+  /* The largest possible cost increase of a single step; see
+   * pf_normal_map_adjust_cost() which clamps every move cost to the
+   * moves left. */
+  span = pf_move_rate(parameter);
+  if (parameter->utype != nullptr && !parameter->omniscience) {
+    span = MAX(span, parameter->utype->unknown_move_cost);
+  }
+  span = MAX(span, SINGLE_MOVE) + 1;
+  if (span > PF_BUCKET_MAX_BUCKETS) {
+    return nullptr;
+  }
+
+  bq = fc_malloc(sizeof(*bq));
+  bq->num_buckets = span;
+  bq->current = 0;
+  bq->count = 0;
+  bq->started = FALSE;
+  bq->buckets = fc_calloc(span, sizeof(*bq->buckets));
+  bq->latest = fc_malloc(MAP_INDEX_SIZE * sizeof(*bq->latest));
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    bq->latest[i] = PF_BUCKET_UNQUEUED;
+  }
+
+  return bq;
+}
+
+/************************************************************************//**
+  Destructor for the bucket queue.
+****************************************************************************/
+static void pf_bucket_queue_destroy(struct pf_bucket_queue *bq)
+{
+  int i;
+
+  for (i = 0; i < bq->num_buckets; i++) {
+    if (bq->buckets[i].entries != nullptr) {
+      free(bq->buckets[i].entries);
+    }
+  }
+  free(bq->buckets);
+  free(bq->latest);
+  free(bq);
+}
+
+/************************************************************************//**
+  Push an entry into its bucket.
+****************************************************************************/
+static void pf_bucket_push(struct pf_bucket_queue *bq, int tindex, int cost)
+{
+  struct pf_bucket *bucket
+    = bq->buckets + FC_WRAP(cost, bq->num_buckets);
+
+  if (bucket->size == bucket->avail) {
+    bucket->avail = (bucket->avail == 0 ? 16 : bucket->avail * 2);
+    bucket->entries = fc_realloc(bucket->entries,
+                                 bucket->avail * sizeof(*bucket->entries));
+  }
+  bucket->entries[bucket->size].tindex = tindex;
+  bucket->entries[bucket->size].cost = cost;
+  bucket->size++;
+  bq->count++;
+}
+
+/************************************************************************//**
+  Widen the circular bucket array so that costs up to
+  'current' + 'needed_span' - 1 fit, redistributing queued entries.
+****************************************************************************/
+static void pf_bucket_queue_grow(struct pf_bucket_queue *bq,
+                                 int needed_span)
+{
+  struct pf_bucket *old_buckets = bq->buckets;
+  int old_num = bq->num_buckets;
+  int i, j;
+
+  bq->num_buckets = needed_span * 2;
+  bq->buckets = fc_calloc(bq->num_buckets, sizeof(*bq->buckets));
+  bq->count = 0;
+
+  for (i = 0; i < old_num; i++) {
+    for (j = 0; j < old_buckets[i].size; j++) {
+      pf_bucket_push(bq, old_buckets[i].entries[j].tindex,
+                     old_buckets[i].entries[j].cost);
+    }
+    if (old_buckets[i].entries != nullptr) {
+      free(old_buckets[i].entries);
+    }
+  }
+  free(old_buckets);
+}
+
+/************************************************************************//**
+  Queue 'tindex' with the given priority (the negated cost of path), or
+  requeue it at a better priority; the previous entry is skipped lazily
+  at removal time.
+****************************************************************************/
+static void pf_bucket_queue_insert(struct pf_bucket_queue *bq, int tindex,
+                                   int priority)
+{
+  int cost = -priority / PF_TURN_FACTOR;
+
+  if (!bq->started) {
+    bq->started = TRUE;
+    bq->current = cost;
+  } else if (cost < bq->current) {
+    /* Cannot happen in a monotone fill; be safe in release builds. */
+#ifdef PF_DEBUG
+    fc_assert(cost >= bq->current);
+#endif
+    cost = bq->current;
+  } else if (cost - bq->current >= bq->num_buckets) {
+    pf_bucket_queue_grow(bq, cost - bq->current + 1);
+  }
+
+  if (bq->latest[tindex] == cost) {
+    /* Requeued at an unchanged cost. */
+    return;
+  }
+  bq->latest[tindex] = cost;
+  pf_bucket_push(bq, tindex, cost);
+}
+
+/************************************************************************//**
+  Remove the entry with the lowest cost. Returns FALSE if the queue is
+  empty.
+****************************************************************************/
+static bool pf_bucket_queue_remove(struct pf_bucket_queue *bq, int *ptindex)
+{
+  while (bq->count > 0) {
+    struct pf_bucket *bucket
+      = bq->buckets + FC_WRAP(bq->current, bq->num_buckets);
+
+    if (bucket->size == 0) {
+      bq->current++;
+      continue;
+    }
+
+    while (bucket->size > 0) {
+      struct pf_bucket_entry *entry = bucket->entries + (--bucket->size);
+
+      bq->count--;
+      if (bq->latest[entry->tindex] == entry->cost) {
+        bq->latest[entry->tindex] = PF_BUCKET_PROCESSED;
+        *ptindex = entry->tindex;
+        return TRUE;
+      }
+      /* Else: superseded by a cheaper entry; skip. */
+    }
+  }
+
+  return FALSE;
+}
+
+
 /* ================ Specific pf_normal_* mode structures ================= */
 
 /* Normal path-finding maps are used for most of units with standard rules.
@@ -232,6 +581,9 @@ struct pf_normal_map {
                                * processed yet (NS_NEW), sorted by their
                                * total_CC. */
   struct pf_normal_node *lattice; /* Lattice of nodes. */
+  struct pf_bucket_queue *bqueue; /* Used instead of 'queue' when the
+                                   * parameter's cost structure allows
+                                   * the calibrated bucket queue. */
 };
 
 /* Up-cast macro. */
@@ -253,6 +605,46 @@ pf_normal_map_check(struct pf_map *pfm, const char *file,
 
 /* ================  Specific pf_normal_* mode functions ================= */
 
+/************************************************************************//**
+  Queue a node, dispatching to the calibrated bucket queue when the map
+  uses one.
+****************************************************************************/
+static inline void pf_normal_queue_insert(struct pf_normal_map *pfnm,
+                                          int tindex, int priority)
+{
+  if (pfnm->bqueue != nullptr) {
+    pf_bucket_queue_insert(pfnm->bqueue, tindex, priority);
+  } else {
+    map_index_pq_insert(pfnm->queue, tindex, priority);
+  }
+}
+
+/************************************************************************//**
+  Requeue a node at a better priority.
+****************************************************************************/
+static inline void pf_normal_queue_replace(struct pf_normal_map *pfnm,
+                                           int tindex, int priority)
+{
+  if (pfnm->bqueue != nullptr) {
+    pf_bucket_queue_insert(pfnm->bqueue, tindex, priority);
+  } else {
+    map_index_pq_replace(pfnm->queue, tindex, priority);
+  }
+}
+
+/************************************************************************//**
+  Remove the best queued node. Returns FALSE when the queue is empty.
+****************************************************************************/
+static inline bool pf_normal_queue_remove(struct pf_normal_map *pfnm,
+                                          int *ptindex)
+{
+  if (pfnm->bqueue != nullptr) {
+    return pf_bucket_queue_remove(pfnm->bqueue, ptindex);
+  } else {
+    return map_index_pq_remove(pfnm->queue, ptindex);
+  }
+}
+
 /************************************************************************//**
   Calculates cached values of the target node. Set the node status to
   NS_INIT to avoid recalculating all values. Returns FALSE if we cannot
@@ -455,9 +847,12 @@ pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
   path = fc_malloc(sizeof(*path));
 
   /* 1: Count the number of steps to get here.
-   * To do it, backtrack until we hit the starting point */
+   * To do it, backtrack until we hit the starting point. Nodes seeded by
+   * pf_map_new_multi() have no direction to them, so we also stop on any
+   * start tile of a multi-source map. */
   for (i = 0; ; i++) {
-    if (ptile == params->start_tile) {
+    if (ptile == params->start_tile
+        || !direction8_is_valid(node->dir_to_here)) {
       /* Ah-ha, reached the starting point! */
       break;
     }
@@ -713,8 +1108,12 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->extra_cost = extra;
         node1->cost = cost;
         node1->dir_to_here = dir;
-        /* As we prefer lower costs, let's reverse the cost of the path. */
-        map_index_pq_insert(pfnm->queue, tindex1, -cost_of_path);
+        /* As we prefer lower costs, let's reverse the cost of the path.
+         * The estimate is folded into the priority only, so the search
+         * leans towards the goal without touching recorded costs. */
+        pf_normal_queue_insert(pfnm, tindex1,
+                               -(cost_of_path
+                                 + pf_estimate_CC(params, tile1)));
       } else if (cost_of_path < pf_total_CC(params, node1->cost,
                                             node1->extra_cost)) {
         /* We found a better route to 'tile1'. Let's register 'tindex1' to
@@ -724,13 +1123,15 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->cost = cost;
         node1->dir_to_here = dir;
         /* As we prefer lower costs, let's reverse the cost of the path. */
-        map_index_pq_replace(pfnm->queue, tindex1, -cost_of_path);
+        pf_normal_queue_replace(pfnm, tindex1,
+                                -(cost_of_path
+                                  + pf_estimate_CC(params, tile1)));
       }
     } adjc_dir_iterate_end;
   }
 
   /* Get the next node (the index with the highest priority). */
-  if (!map_index_pq_remove(pfnm->queue, &tindex)) {
+  if (!pf_normal_queue_remove(pfnm, &tindex)) {
     /* No more indexes in the priority queue, iteration end. */
     return FALSE;
   }
@@ -746,6 +1147,9 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
   return TRUE;
 }
 
+static inline void pf_normal_map_ensure_fresh(struct pf_normal_map *pfnm,
+                                              struct tile *ptile);
+
 /************************************************************************//**
   Iterate the map until 'ptile' is reached.
 ****************************************************************************/
@@ -753,7 +1157,10 @@ static inline bool pf_normal_map_iterate_until(struct pf_normal_map *pfnm,
                                                struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pfnm);
-  struct pf_normal_node *node = pfnm->lattice + tile_index(ptile);
+  struct pf_normal_node *node;
+
+  pf_normal_map_ensure_fresh(pfnm, ptile);
+  node = pfnm->lattice + tile_index(ptile);
 
   if (pf_map_parameter(pfm)->get_costs == nullptr) {
     /* Start position is handled in every function calling this function. */
@@ -847,55 +1254,24 @@ static void pf_normal_map_destroy(struct pf_map *pfm)
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
 
   free(pfnm->lattice);
-  map_index_pq_destroy(pfnm->queue);
+  if (pfnm->bqueue != nullptr) {
+    pf_bucket_queue_destroy(pfnm->bqueue);
+  } else {
+    map_index_pq_destroy(pfnm->queue);
+  }
   free(pfnm);
 }
 
 /************************************************************************//**
-  'pf_normal_map' constructor.
+  Initialise the starting node and the iterator of a freshly allocated or
+  reset normal map.
 ****************************************************************************/
-static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
+static void pf_normal_map_seed(struct pf_normal_map *pfnm)
 {
-  struct pf_normal_map *pfnm;
-  struct pf_map *base_map;
-  struct pf_parameter *params;
+  struct pf_map *base_map = PF_MAP(pfnm);
+  const struct pf_parameter *params = &base_map->params;
   struct pf_normal_node *node;
 
-  pfnm = fc_malloc(sizeof(*pfnm));
-  base_map = &pfnm->base_map;
-  params = &base_map->params;
-#ifdef PF_DEBUG
-  /* Set the mode, used for cast check. */
-  base_map->mode = PF_NORMAL;
-#endif /* PF_DEBUG */
-
-  /* Allocate the map. */
-  pfnm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_normal_node));
-  pfnm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
-
-  if (parameter->get_costs == nullptr) {
-    /* 'get_MC' callback must be set. */
-    fc_assert_ret_val(parameter->get_MC != nullptr, nullptr);
-
-    /* 'get_move_scope' callback must be set. */
-    fc_assert_ret_val(parameter->get_move_scope != nullptr, nullptr);
-  }
-
-  /* Copy parameters. */
-  *params = *parameter;
-
-  /* Initialize virtual function table. */
-  base_map->destroy = pf_normal_map_destroy;
-  base_map->get_move_cost = pf_normal_map_move_cost;
-  base_map->get_path = pf_normal_map_path;
-  base_map->get_position = pf_normal_map_position;
-  if (params->get_costs != nullptr) {
-    base_map->iterate = pf_jumbo_map_iterate;
-  } else {
-    base_map->iterate = pf_normal_map_iterate;
-  }
-
-  /* Initialise starting node. */
   node = pfnm->lattice + tile_index(params->start_tile);
   if (params->get_costs == nullptr) {
     if (!pf_normal_node_init(pfnm, node, params->start_tile, PF_MS_NONE)) {
@@ -930,6 +1306,105 @@ static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
   node->extra_cost = 0;
   node->dir_to_here = direction8_invalid();
   node->status = NS_PROCESSED;
+}
+
+/************************************************************************//**
+  Throw away all results and restart the fill from scratch. Used to
+  repair a map which was kept alive across tile changes.
+****************************************************************************/
+static void pf_normal_map_reset(struct pf_normal_map *pfnm)
+{
+  struct pf_map *base_map = PF_MAP(pfnm);
+
+  memset(pfnm->lattice, 0,
+         MAP_INDEX_SIZE * sizeof(struct pf_normal_node));
+  if (pfnm->bqueue != nullptr) {
+    pf_bucket_queue_destroy(pfnm->bqueue);
+    pfnm->bqueue = pf_bucket_queue_new(&base_map->params);
+  } else {
+    map_index_pq_destroy(pfnm->queue);
+    pfnm->queue = map_index_pq_new_indexed(INITIAL_QUEUE_SIZE,
+                                           MAP_INDEX_SIZE);
+  }
+  base_map->stale_cost_floor = INT_MAX;
+  pf_normal_map_seed(pfnm);
+}
+
+/************************************************************************//**
+  Repair the map before answering a query for 'ptile' if tile changes
+  made the relevant part of the results stale. Results strictly below the
+  stale cost floor are unaffected: the fill processed those nodes in cost
+  order before anything near the changed tile could matter.
+****************************************************************************/
+static inline void pf_normal_map_ensure_fresh(struct pf_normal_map *pfnm,
+                                              struct tile *ptile)
+{
+  struct pf_map *base_map = PF_MAP(pfnm);
+  const struct pf_normal_node *node;
+
+  if (INT_MAX == base_map->stale_cost_floor) {
+    return;
+  }
+
+  node = pfnm->lattice + tile_index(ptile);
+  if (NS_PROCESSED == node->status
+      && node->cost < base_map->stale_cost_floor) {
+    return;
+  }
+
+  pf_normal_map_reset(pfnm);
+}
+
+/************************************************************************//**
+  'pf_normal_map' constructor.
+****************************************************************************/
+static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
+{
+  struct pf_normal_map *pfnm;
+  struct pf_map *base_map;
+  struct pf_parameter *params;
+
+  pfnm = fc_malloc(sizeof(*pfnm));
+  base_map = &pfnm->base_map;
+  params = &base_map->params;
+  /* Set the mode, used for cast check and statistics. */
+  base_map->mode = PF_NORMAL;
+  pf_stats[base_map->mode - 1].maps_built++;
+  base_map->multi_source = FALSE;
+  base_map->stale_cost_floor = INT_MAX;
+
+  /* Allocate the map. */
+  pfnm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_normal_node));
+  pfnm->bqueue = pf_bucket_queue_new(parameter);
+  pfnm->queue = (pfnm->bqueue != nullptr
+                 ? nullptr
+                 : map_index_pq_new_indexed(INITIAL_QUEUE_SIZE,
+                                            MAP_INDEX_SIZE));
+
+  if (parameter->get_costs == nullptr) {
+    /* 'get_MC' callback must be set. */
+    fc_assert_ret_val(parameter->get_MC != nullptr, nullptr);
+
+    /* 'get_move_scope' callback must be set. */
+    fc_assert_ret_val(parameter->get_move_scope != nullptr, nullptr);
+  }
+
+  /* Copy parameters. */
+  *params = *parameter;
+
+  /* Initialize virtual function table. */
+  base_map->destroy = pf_normal_map_destroy;
+  base_map->get_move_cost = pf_normal_map_move_cost;
+  base_map->get_path = pf_normal_map_path;
+  base_map->get_position = pf_normal_map_position;
+  if (params->get_costs != nullptr) {
+    base_map->iterate = pf_jumbo_map_iterate;
+  } else {
+    base_map->iterate = pf_normal_map_iterate;
+  }
+
+  /* Initialise starting node and the iterator. */
+  pf_normal_map_seed(pfnm);
 
   return PF_MAP(pfnm);
 }
@@ -972,6 +1447,7 @@ struct pf_danger_node {
     unsigned extra_cost;        /* See comment above. */
     signed dir_to_here : 4;     /* See comment above. */
   } *danger_segment;
+  unsigned short danger_segment_length; /* For returning it to the arena. */
 };
 
 /* Derived structure of struct pf_map. */
@@ -983,6 +1459,7 @@ struct pf_danger_map {
                                  * sorted by their total_CC. */
   struct map_index_pq *danger_queue; /* Dangerous positions. */
   struct pf_danger_node *lattice; /* Lattice of nodes. */
+  struct pf_arena arena;        /* For the danger segments. */
 };
 
 /* Up-cast macro. */
@@ -1399,7 +1876,10 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
   }
 
   /* Allocate memory for segment */
-  node1->danger_segment = fc_malloc(length * sizeof(struct pf_danger_pos));
+  node1->danger_segment = pf_arena_alloc(&pfdm->arena,
+                                         length
+                                         * sizeof(struct pf_danger_pos));
+  node1->danger_segment_length = length;
 
   /* Reset tile and node pointers for main iteration */
   ptile = PF_MAP(pfdm)->tile;
@@ -1626,7 +2106,9 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
             node1->dir_to_here = dir;
             if (node1->danger_segment != nullptr) {
               /* Clear the previously recorded path back. */
-              free(node1->danger_segment);
+              pf_arena_free(&pfdm->arena, node1->danger_segment,
+                            node1->danger_segment_length
+                            * sizeof(struct pf_danger_pos));
               node1->danger_segment = nullptr;
             }
             if (node->is_dangerous) {
@@ -1851,15 +2333,9 @@ static bool pf_danger_map_position(struct pf_map *pfm, struct tile *ptile,
 static void pf_danger_map_destroy(struct pf_map *pfm)
 {
   struct pf_danger_map *pfdm = PF_DANGER_MAP(pfm);
-  struct pf_danger_node *node;
-  int i;
 
-  /* Need to clean up the dangling danger segments. */
-  for (i = 0, node = pfdm->lattice; i < MAP_INDEX_SIZE; i++, node++) {
-    if (node->danger_segment) {
-      free(node->danger_segment);
-    }
-  }
+  /* This also releases all the danger segments at once. */
+  pf_arena_clear(&pfdm->arena);
   free(pfdm->lattice);
   map_index_pq_destroy(pfdm->queue);
   map_index_pq_destroy(pfdm->danger_queue);
@@ -1879,15 +2355,18 @@ static struct pf_map *pf_danger_map_new(const struct pf_parameter *parameter)
   pfdm = fc_malloc(sizeof(*pfdm));
   base_map = &pfdm->base_map;
   params = &base_map->params;
-#ifdef PF_DEBUG
-  /* Set the mode, used for cast check. */
+  /* Set the mode, used for cast check and statistics. */
   base_map->mode = PF_DANGER;
-#endif /* PF_DEBUG */
+  pf_stats[base_map->mode - 1].maps_built++;
+  base_map->multi_source = FALSE;
+  base_map->stale_cost_floor = INT_MAX;
 
   /* Allocate the map. */
   pfdm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_danger_node));
-  pfdm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
-  pfdm->danger_queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+  pf_arena_init(&pfdm->arena);
+  pfdm->queue = map_index_pq_new_indexed(INITIAL_QUEUE_SIZE, MAP_INDEX_SIZE);
+  pfdm->danger_queue = map_index_pq_new_indexed(INITIAL_QUEUE_SIZE,
+                                                MAP_INDEX_SIZE);
 
   /* 'get_MC' callback must be set. */
   fc_assert_ret_val(parameter->get_MC != nullptr, nullptr);
@@ -2005,6 +2484,7 @@ struct pf_fuel_map {
   struct map_index_pq *waited_queue; /* Queue of nodes to reach farer
                                       * positions after having refueled. */
   struct pf_fuel_node *lattice; /* Lattice of nodes */
+  struct pf_arena arena;        /* For the pf_fuel_pos records. */
 };
 
 /* Up-cast macro. */
@@ -2246,12 +2726,13 @@ static inline struct pf_fuel_pos *pf_fuel_pos_ref(struct pf_fuel_pos *pos)
   Forget how we went to position. Maybe destroy the position, and previous
   ones.
 ****************************************************************************/
-static inline void pf_fuel_pos_unref(struct pf_fuel_pos *pos)
+static inline void pf_fuel_pos_unref(struct pf_arena *arena,
+                                      struct pf_fuel_pos *pos)
 {
   while (pos != nullptr && 0 == --pos->ref_count) {
     struct pf_fuel_pos *prev = pos->prev;
 
-    free(pos);
+    pf_arena_free(arena, pos, sizeof(*pos));
     pos = prev;
   }
 }
@@ -2263,20 +2744,21 @@ static inline void pf_fuel_pos_unref(struct pf_fuel_pos *pos)
   freeing and allocating again.
 ****************************************************************************/
 static inline struct pf_fuel_pos *
-pf_fuel_pos_replace(struct pf_fuel_pos *pos, const struct pf_fuel_node *node)
+pf_fuel_pos_replace(struct pf_arena *arena, struct pf_fuel_pos *pos,
+                    const struct pf_fuel_node *node)
 {
   if (pos == nullptr) {
-    pos = fc_malloc(sizeof(*pos));
+    pos = pf_arena_alloc(arena, sizeof(*pos));
     pos->ref_count = 1;
   } else if (1 < pos->ref_count) {
     pos->ref_count--;
-    pos = fc_malloc(sizeof(*pos));
+    pos = pf_arena_alloc(arena, sizeof(*pos));
     pos->ref_count = 1;
   } else {
 #ifdef PF_DEBUG
     fc_assert(1 == pos->ref_count);
 #endif
-    pf_fuel_pos_unref(pos->prev);
+    pf_fuel_pos_unref(arena, pos->prev);
   }
   pos->cost = node->cost;
   pos->extra_cost = node->extra_cost;
@@ -2518,7 +3000,7 @@ static inline void pf_fuel_map_create_segment(struct pf_fuel_map *pffm,
   struct pf_fuel_pos *pos, *next;
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pffm));
 
-  pos = pf_fuel_pos_replace(node->pos, node);
+  pos = pf_fuel_pos_replace(&pffm->arena, node->pos, node);
   node->pos = pos;
 
   /* Iterate until we reach any built segment. */
@@ -2538,7 +3020,7 @@ static inline void pf_fuel_map_create_segment(struct pf_fuel_map *pffm,
       }
     }
     /* Update position. */
-    pos = pf_fuel_pos_replace(pos, node);
+    pos = pf_fuel_pos_replace(&pffm->arena, pos, node);
     node->pos = pos;
     next->prev = pf_fuel_pos_ref(pos);
   } while (0 != node->moves_left_req && direction8_is_valid(node->dir_to_here));
@@ -3087,14 +3569,9 @@ static bool pf_fuel_map_position(struct pf_map *pfm, struct tile *ptile,
 static void pf_fuel_map_destroy(struct pf_map *pfm)
 {
   struct pf_fuel_map *pffm = PF_FUEL_MAP(pfm);
-  struct pf_fuel_node *node;
-  int i;
 
-  /* Need to clean up the dangling fuel segments. */
-  for (i = 0, node = pffm->lattice; i < MAP_INDEX_SIZE; i++, node++) {
-    pf_fuel_pos_unref(node->pos);
-    pf_fuel_pos_unref(node->segment);
-  }
+  /* This also releases all the fuel segments at once. */
+  pf_arena_clear(&pffm->arena);
   free(pffm->lattice);
   map_index_pq_destroy(pffm->queue);
   map_index_pq_destroy(pffm->waited_queue);
@@ -3114,15 +3591,18 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
   pffm = fc_malloc(sizeof(*pffm));
   base_map = &pffm->base_map;
   params = &base_map->params;
-#ifdef PF_DEBUG
-  /* Set the mode, used for cast check. */
+  /* Set the mode, used for cast check and statistics. */
   base_map->mode = PF_FUEL;
-#endif /* PF_DEBUG */
+  pf_stats[base_map->mode - 1].maps_built++;
+  base_map->multi_source = FALSE;
+  base_map->stale_cost_floor = INT_MAX;
 
   /* Allocate the map. */
   pffm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_fuel_node));
-  pffm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
-  pffm->waited_queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+  pf_arena_init(&pffm->arena);
+  pffm->queue = map_index_pq_new_indexed(INITIAL_QUEUE_SIZE, MAP_INDEX_SIZE);
+  pffm->waited_queue = map_index_pq_new_indexed(INITIAL_QUEUE_SIZE,
+                                                MAP_INDEX_SIZE);
 
   /* 'get_MC' callback must be set. */
   fc_assert_ret_val(parameter->get_MC != nullptr, nullptr);
@@ -3168,7 +3648,8 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
   node->dir_to_here = direction8_invalid();
   /* Record a segment. We need it for correct paths. */
   node->segment
-    = pf_fuel_pos_ref(node->pos = pf_fuel_pos_replace(nullptr, node));
+    = pf_fuel_pos_ref(node->pos
+                      = pf_fuel_pos_replace(&pffm->arena, nullptr, node));
   node->status = NS_PROCESSED;
 
   return PF_MAP(pffm);
@@ -3202,6 +3683,67 @@ struct pf_map *pf_map_new(const struct pf_parameter *parameter)
   return pf_normal_map_new(parameter);
 }
 
+/************************************************************************//**
+  Build one map seeded from several start tiles at once. The resulting
+  costs are, for every tile, the minimum over all the given starts, so a
+  single sweep can rank targets for a whole group of units sharing the
+  same parameter. Danger, fuel and jumbo parameters are not supported.
+  Paths returned by pf_map_path() lead from the nearest seeded start.
+****************************************************************************/
+struct pf_map *pf_map_new_multi(const struct pf_parameter *parameter,
+                                struct tile *const *start_tiles,
+                                int num_start_tiles)
+{
+  struct pf_parameter param = *parameter;
+  struct pf_normal_map *pfnm;
+  struct pf_map *pfm;
+  const struct pf_parameter *params;
+  int i;
+
+  fc_assert_ret_val(num_start_tiles > 0, nullptr);
+  fc_assert_ret_val(parameter->is_pos_dangerous == nullptr, nullptr);
+  fc_assert_ret_val(parameter->get_moves_left_req == nullptr, nullptr);
+  fc_assert_ret_val(parameter->get_costs == nullptr, nullptr);
+
+  param.start_tile = start_tiles[0];
+  pfm = pf_normal_map_new(&param);
+  if (pfm == nullptr) {
+    return nullptr;
+  }
+  pfm->multi_source = TRUE;
+  pfnm = PF_NORMAL_MAP(pfm);
+  params = pf_map_parameter(pfm);
+
+  for (i = 1; i < num_start_tiles; i++) {
+    struct tile *ptile = start_tiles[i];
+    struct pf_normal_node *node = pfnm->lattice + tile_index(ptile);
+    int cost;
+
+    if (NS_UNINIT != node->status) {
+      /* Duplicate start tile. */
+      continue;
+    }
+
+    if (!pf_normal_node_init(pfnm, node, ptile, PF_MS_NONE)) {
+      /* Not enterable at all; leave it to be seeded pessimistically
+       * from its neighbours. */
+      continue;
+    }
+
+    /* Seed like the primary start tile; see pf_normal_map_new(). */
+    cost = pf_move_rate(params) - pf_moves_left_initially(params);
+    node->cost = cost;
+    node->extra_cost = 0;
+    node->dir_to_here = direction8_invalid();
+    node->status = NS_NEW;
+    pf_normal_queue_insert(pfnm, tile_index(ptile),
+                           -(pf_total_CC(params, cost, 0)
+                             + pf_estimate_CC(params, ptile)));
+  }
+
+  return pfm;
+}
+
 /************************************************************************//**
   After usage the map must be destroyed.
 ****************************************************************************/
@@ -3249,7 +3791,10 @@ struct pf_path *pf_map_path(struct pf_map *pfm, struct tile *ptile)
     const struct pf_position *pos = &path->positions[0];
 
     fc_assert(path->length >= 1);
-    fc_assert(pos->tile == param->start_tile);
+    if (!pfm->multi_source) {
+      /* Multi-source paths start from the nearest seeded tile. */
+      fc_assert(pos->tile == param->start_tile);
+    }
     fc_assert(pos->moves_left == param->moves_left_initially);
     fc_assert(pos->fuel_left == param->fuel_left_initially);
 #endif /* FREECIV_NDEBUG */
@@ -3305,9 +3850,129 @@ bool pf_map_iterate(struct pf_map *pfm)
     return FALSE;
   }
 
+  pf_stats[pfm->mode - 1].expansions++;
+
   return TRUE;
 }
 
+/* Shared state of one pf_maps_prefill_parallel() call. Workers pull map
+ * indices from 'next' under 'mutex' until all maps are exhausted. */
+struct pf_fill_pool {
+  struct pf_map *const *maps;
+  int num_maps;
+  int next;
+  fc_mutex mutex;
+};
+
+/* Do not spawn more workers than this, however many maps we get; past
+ * a handful the fills become memory bound anyway. */
+#define PF_FILL_MAX_THREADS 8
+
+/************************************************************************//**
+  Worker body for pf_maps_prefill_parallel(). Repeatedly claims the next
+  unfilled map and iterates it to exhaustion.
+****************************************************************************/
+static void pf_fill_worker(void *arg)
+{
+  struct pf_fill_pool *pool = arg;
+
+  for (;;) {
+    struct pf_map *pfm;
+    int index;
+
+    fc_mutex_allocate(&pool->mutex);
+    index = pool->next++;
+    fc_mutex_release(&pool->mutex);
+
+    if (index >= pool->num_maps) {
+      return;
+    }
+
+    pfm = pool->maps[index];
+    while (pf_map_iterate(pfm)) {
+      /* Just exhaust the map; results are read back by the caller. */
+    }
+  }
+}
+
+/************************************************************************//**
+  Iterate every map in 'pfms' to exhaustion, using worker threads when
+  more than one map is given. On return all positions of all maps are
+  processed, so subsequent queries like pf_map_position() are pure reads.
+
+  The fills only read the game map, so the caller must not modify tiles,
+  units or players while this runs; the usual place is the AI phase where
+  the map state is frozen anyway. The parameter callbacks of the maps are
+  called from worker threads; the move rate and move cost caches they
+  reach only store while the effect caches are unfrozen, so the shared
+  caches are frozen here for the duration of the pool.
+****************************************************************************/
+void pf_maps_prefill_parallel(struct pf_map *const *pfms, int num_maps)
+{
+  struct pf_fill_pool pool;
+  fc_thread threads[PF_FILL_MAX_THREADS];
+  int num_threads = MIN(num_maps, PF_FILL_MAX_THREADS);
+  bool was_frozen;
+  int i;
+
+  if (num_maps <= 0) {
+    return;
+  }
+
+  if (num_threads < 2) {
+    /* Not worth a pool; fill inline. */
+    for (i = 0; i < num_maps; i++) {
+      while (pf_map_iterate(pfms[i])) {
+        /* Nothing. */
+      }
+    }
+    return;
+  }
+
+  pool.maps = pfms;
+  pool.num_maps = num_maps;
+  pool.next = 0;
+  fc_mutex_init(&pool.mutex);
+
+  /* Respect an outer freeze; otherwise set one up for the workers. */
+  was_frozen = effect_cache_is_frozen();
+  if (!was_frozen) {
+    effect_cache_freeze(TRUE);
+    requirement_memo_freeze(TRUE);
+  }
+
+  for (i = 0; i < num_threads; i++) {
+    fc_thread_start(&threads[i], pf_fill_worker, &pool);
+  }
+  for (i = 0; i < num_threads; i++) {
+    fc_thread_wait(&threads[i]);
+  }
+
+  if (!was_frozen) {
+    requirement_memo_freeze(FALSE);
+    effect_cache_freeze(FALSE);
+  }
+
+  fc_mutex_destroy(&pool.mutex);
+}
+
+/************************************************************************//**
+  Copy the per-mode counters accumulated since the last reset into
+  'stats', which must have PF_STATS_MODE_COUNT entries.
+****************************************************************************/
+void pf_map_stats_get(struct pf_map_stats *stats)
+{
+  memcpy(stats, pf_stats, sizeof(pf_stats));
+}
+
+/************************************************************************//**
+  Zero the per-mode counters.
+****************************************************************************/
+void pf_map_stats_reset(void)
+{
+  memset(pf_stats, 0, sizeof(pf_stats));
+}
+
 /************************************************************************//**
   Return the current tile.
 ****************************************************************************/
@@ -3373,6 +4038,299 @@ const struct pf_parameter *pf_map_parameter(const struct pf_map *pfm)
 }
 
 
+/* ====================== pf_map cache functions ========================= */
+
+/* The map cache allows sharing one filled map between all the callers
+ * using equal parameters. Only the client goto code populates it, so a
+ * goto restarted from the same tile with the same unit reuses the warm
+ * map instead of refilling it; tile change packets feed
+ * pf_map_cache_notify_change(). It is not safe for server-side unit
+ * movement, since only terrain and extra changes are notified - unit
+ * positions are not. Entries are reference counted;
+ * pf_map_cache_invalidate() drops them from the hash, and stale entries
+ * are destroyed when their last user calls pf_map_cache_put(). */
+
+static genhash_val_t pf_cache_hash_val(const struct pf_parameter *parameter);
+static bool pf_cache_hash_cmp(const struct pf_parameter *parameter1,
+                              const struct pf_parameter *parameter2);
+
+struct pf_cache_entry {
+  struct pf_map *pfm;
+  struct pf_parameter *param;   /* Hash key, owned by the entry. */
+  int ref_count;
+  bool stale;                   /* Dropped from the hash while in use. */
+  struct pf_cache_entry *next;  /* All live entries, for reverse lookup. */
+};
+
+/* Keep at most this many idle maps warm; beyond that the oldest
+ * unreferenced one is recycled. Referenced maps are never counted out. */
+#define PF_CACHE_MAX_ENTRIES 16
+
+#define SPECHASH_TAG pf_cache
+#define SPECHASH_IKEY_TYPE struct pf_parameter *
+#define SPECHASH_IDATA_TYPE struct pf_cache_entry *
+#define SPECHASH_IKEY_VAL pf_cache_hash_val
+#define SPECHASH_IKEY_COMP pf_cache_hash_cmp
+#include "spechash.h"
+
+static struct pf_cache_hash *pf_cache = nullptr;
+static struct pf_cache_entry *pf_cache_entries = nullptr;
+
+/************************************************************************//**
+  Hash function for the pf_parameter cache key.
+****************************************************************************/
+static genhash_val_t pf_cache_hash_val(const struct pf_parameter *parameter)
+{
+  genhash_val_t result = tile_index(parameter->start_tile);
+
+  result += parameter->move_rate << 10;
+  result += parameter->moves_left_initially << 16;
+  if (parameter->utype != nullptr) {
+    result += utype_number(parameter->utype) << 20;
+  }
+  if (parameter->owner != nullptr) {
+    result += player_number(parameter->owner) << 26;
+  }
+  if (parameter->omniscience) {
+    result += 1u << 31;
+  }
+
+  return result;
+}
+
+/************************************************************************//**
+  Comparison function for the pf_parameter cache key. Any difference which
+  could change the filled costs must make the comparison fail; a false
+  negative only costs a cache miss.
+****************************************************************************/
+static bool pf_cache_hash_cmp(const struct pf_parameter *parameter1,
+                              const struct pf_parameter *parameter2)
+{
+  return (parameter1->map == parameter2->map
+          && parameter1->start_tile == parameter2->start_tile
+          && parameter1->moves_left_initially
+             == parameter2->moves_left_initially
+          && parameter1->fuel_left_initially
+             == parameter2->fuel_left_initially
+          && parameter1->transported_by_initially
+             == parameter2->transported_by_initially
+          && parameter1->cargo_depth == parameter2->cargo_depth
+          && BV_ARE_EQUAL(parameter1->cargo_types, parameter2->cargo_types)
+          && parameter1->move_rate == parameter2->move_rate
+          && parameter1->fuel == parameter2->fuel
+          && parameter1->utype == parameter2->utype
+          && parameter1->owner == parameter2->owner
+          && parameter1->omniscience == parameter2->omniscience
+          && parameter1->get_MC == parameter2->get_MC
+          && parameter1->get_move_scope == parameter2->get_move_scope
+          && parameter1->ignore_none_scopes == parameter2->ignore_none_scopes
+          && parameter1->get_TB == parameter2->get_TB
+          && parameter1->get_EC == parameter2->get_EC
+          && parameter1->get_action == parameter2->get_action
+          && parameter1->actions == parameter2->actions
+          && parameter1->is_action_possible
+             == parameter2->is_action_possible
+          && parameter1->get_zoc == parameter2->get_zoc
+          /* pf_cache_able() keeps these out of the cache today, but
+           * compare them anyway so relaxing it can never silently
+           * reuse a map built for a different caller. */
+          && parameter1->get_estimate == parameter2->get_estimate
+          && parameter1->is_pos_dangerous == parameter2->is_pos_dangerous
+          && parameter1->get_moves_left_req
+             == parameter2->get_moves_left_req
+          && parameter1->get_costs == parameter2->get_costs
+          && parameter1->data == parameter2->data);
+}
+
+/************************************************************************//**
+  Can maps built from this parameter be shared? Danger and fuel maps and
+  jumbo callbacks are excluded, as is anything carrying caller-owned user
+  data the cache could not compare.
+****************************************************************************/
+static inline bool pf_cache_able(const struct pf_parameter *parameter)
+{
+  return (parameter->is_pos_dangerous == nullptr
+          && parameter->get_moves_left_req == nullptr
+          && parameter->get_costs == nullptr
+          && parameter->get_estimate == nullptr
+          && parameter->data == nullptr);
+}
+
+/************************************************************************//**
+  Destroy a cache entry and the map it owns. The entry must already be
+  unlinked from both the hash and the entry list.
+****************************************************************************/
+static void pf_cache_entry_destroy(struct pf_cache_entry *entry)
+{
+  pf_map_destroy(entry->pfm);
+  free(entry->param);
+  free(entry);
+}
+
+/************************************************************************//**
+  Returns a map filled from 'parameter', reusing a cached one when an
+  equivalent map was requested before. The result must be given back with
+  pf_map_cache_put(), not pf_map_destroy().
+****************************************************************************/
+struct pf_map *pf_map_cache_get(const struct pf_parameter *parameter)
+{
+  struct pf_cache_entry *entry;
+
+  if (!pf_cache_able(parameter)) {
+    /* Not shareable; give the caller a private map. pf_map_cache_put()
+     * recognizes it as such and destroys it. */
+    return pf_map_new(parameter);
+  }
+
+  if (pf_cache == nullptr) {
+    pf_cache = pf_cache_hash_new();
+  } else if (pf_cache_hash_lookup(pf_cache, parameter, &entry)) {
+    entry->ref_count++;
+    return entry->pfm;
+  }
+
+  {
+    /* Evict the oldest unreferenced entry when the cache is full. The
+     * list is newest-first, so the last unreferenced one is the oldest. */
+    struct pf_cache_entry *victim = nullptr, **victim_link = nullptr;
+    struct pf_cache_entry **link;
+    int count = 0;
+
+    for (link = &pf_cache_entries; *link != nullptr;
+         link = &(*link)->next) {
+      count++;
+      if (0 == (*link)->ref_count) {
+        victim = *link;
+        victim_link = link;
+      }
+    }
+    if (count >= PF_CACHE_MAX_ENTRIES && victim != nullptr) {
+      *victim_link = victim->next;
+      pf_cache_hash_remove(pf_cache, victim->param);
+      pf_cache_entry_destroy(victim);
+    }
+  }
+
+  entry = fc_malloc(sizeof(*entry));
+  entry->pfm = pf_map_new(parameter);
+  entry->param = fc_malloc(sizeof(*entry->param));
+  *entry->param = *parameter;
+  entry->ref_count = 1;
+  entry->stale = FALSE;
+  entry->next = pf_cache_entries;
+  pf_cache_entries = entry;
+  pf_cache_hash_insert(pf_cache, entry->param, entry);
+
+  return entry->pfm;
+}
+
+/************************************************************************//**
+  Release a map acquired with pf_map_cache_get(). Cached maps stay warm
+  for the next caller; stale and private maps are destroyed.
+****************************************************************************/
+void pf_map_cache_put(struct pf_map *pfm)
+{
+  struct pf_cache_entry *entry, **link;
+
+#ifdef PF_DEBUG
+  fc_assert_ret(pfm != nullptr);
+#endif
+
+  for (link = &pf_cache_entries; (entry = *link) != nullptr;
+       link = &entry->next) {
+    if (entry->pfm == pfm) {
+      entry->ref_count--;
+      if (entry->stale && 0 == entry->ref_count) {
+        *link = entry->next;
+        pf_cache_entry_destroy(entry);
+      }
+      return;
+    }
+  }
+
+  /* Not cached (see pf_cache_able()). */
+  pf_map_destroy(pfm);
+}
+
+/************************************************************************//**
+  Notify the cache that 'ptile' changed (terrain, extras, ...). Instead
+  of flushing the cached maps, this records for each of them the lowest
+  cost at which the changed tile could have been entered; results
+  strictly below that floor stay valid and keep being served warm, while
+  queries at or above it trigger a refill (see
+  pf_normal_map_ensure_fresh()).
+****************************************************************************/
+void pf_map_cache_notify_change(struct tile *ptile)
+{
+  struct pf_cache_entry *entry;
+
+  for (entry = pf_cache_entries; entry != nullptr; entry = entry->next) {
+    /* The cache only holds normal maps; see pf_cache_able(). */
+    struct pf_normal_map *pfnm = PF_NORMAL_MAP(entry->pfm);
+    struct pf_map *pfm = entry->pfm;
+    const struct pf_normal_node *node;
+    int floor = INT_MAX;
+
+    if (entry->stale) {
+      continue;
+    }
+
+    node = pfnm->lattice + tile_index(ptile);
+    if (NS_NEW == node->status || NS_PROCESSED == node->status) {
+      floor = MIN(floor, node->cost);
+    }
+    adjc_iterate(pf_map_parameter(pfm)->map, ptile, atile) {
+      node = pfnm->lattice + tile_index(atile);
+      if (NS_NEW == node->status || NS_PROCESSED == node->status) {
+        floor = MIN(floor, node->cost);
+      }
+    } adjc_iterate_end;
+
+    if (floor < pfm->stale_cost_floor) {
+      pfm->stale_cost_floor = floor;
+    }
+  }
+}
+
+/************************************************************************//**
+  Flush the map cache. Must be called whenever terrain or extras change,
+  as any cached costs may then be out of date. Maps still referenced are
+  only marked stale and die with their last pf_map_cache_put().
+****************************************************************************/
+void pf_map_cache_invalidate(void)
+{
+  struct pf_cache_entry *entry, **link;
+
+  if (pf_cache == nullptr) {
+    return;
+  }
+
+  link = &pf_cache_entries;
+  while ((entry = *link) != nullptr) {
+    pf_cache_hash_remove(pf_cache, entry->param);
+    if (0 == entry->ref_count) {
+      *link = entry->next;
+      pf_cache_entry_destroy(entry);
+    } else {
+      entry->stale = TRUE;
+      link = &entry->next;
+    }
+  }
+}
+
+/************************************************************************//**
+  Free all resources held by the map cache.
+****************************************************************************/
+void pf_map_cache_free(void)
+{
+  pf_map_cache_invalidate();
+  if (pf_cache != nullptr) {
+    pf_cache_hash_destroy(pf_cache);
+    pf_cache = nullptr;
+  }
+}
+
+
 /* ====================== pf_path public functions ======================= */
 
 /************************************************************************//**
@@ -467,6 +467,18 @@ struct pf_parameter {
                     unsigned *to_cost, unsigned *to_extra,
                     const struct pf_parameter *param);
 
+  /* Optional goal-directed search. When both fields are set and the map
+   * runs in normal mode, positions are expanded in order of known cost
+   * plus the estimate, as in A*, so single-destination queries towards
+   * 'goal_tile' process far fewer positions. The estimate must be a lower
+   * bound on the remaining cost-of-path from 'ptile' to 'goal_tile' (in
+   * the internal combined cost units), or shortest paths are no longer
+   * guaranteed. See pf_alt_fill_parameter() for a ready-made estimate.
+   * Maps with an estimate should only be queried for 'goal_tile'. */
+  unsigned (*get_estimate) (const struct tile *ptile,
+                            const struct pf_parameter *param);
+  struct tile *goal_tile;
+
   /* User provided data. Can be used to attach arbitrary information
    * to the map. */
   void *data;
@@ -484,6 +496,10 @@ struct pf_reverse_map;
 /* Create and free. */
 struct pf_map *pf_map_new(const struct pf_parameter *parameter)
                fc__warn_unused_result;
+struct pf_map *pf_map_new_multi(const struct pf_parameter *parameter,
+                                struct tile *const *start_tiles,
+                                int num_start_tiles)
+               fc__warn_unused_result;
 void pf_map_destroy(struct pf_map *pfm);
 
 /* Method A) functions. */
@@ -502,9 +518,39 @@ struct pf_path *pf_map_iter_path(struct pf_map *pfm)
                 fc__warn_unused_result;
 void pf_map_iter_position(struct pf_map *pfm, struct pf_position *pos);
 
+/* Fill several maps completely at once, on worker threads when more than
+ * one map is given. The game state must not change while this runs. */
+void pf_maps_prefill_parallel(struct pf_map *const *pfms, int num_maps);
+
+/* Running counters for benchmarking, one slot per map mode. */
+enum pf_stats_mode {
+  PF_STATS_NORMAL = 0,
+  PF_STATS_DANGER,
+  PF_STATS_FUEL,
+  PF_STATS_MODE_COUNT
+};
+
+struct pf_map_stats {
+  unsigned long maps_built;
+  unsigned long expansions;     /* Positions taken off the queue. */
+};
+
+void pf_map_stats_get(struct pf_map_stats *stats);
+void pf_map_stats_reset(void);
+
 /* Other related functions. */
 const struct pf_parameter *pf_map_parameter(const struct pf_map *pfm);
 
+/* Shared map cache. Maps acquired with pf_map_cache_get() are owned by
+ * the cache and must be returned with pf_map_cache_put() instead of
+ * pf_map_destroy(). */
+struct pf_map *pf_map_cache_get(const struct pf_parameter *parameter)
+               fc__warn_unused_result;
+void pf_map_cache_put(struct pf_map *pfm);
+void pf_map_cache_notify_change(struct tile *ptile);
+void pf_map_cache_invalidate(void);
+void pf_map_cache_free(void);
+
 
 /* Paths functions. */
 void pf_path_destroy(struct pf_path *path);
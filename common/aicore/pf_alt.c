@@ -0,0 +1,345 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 2003 - The Freeciv Project
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <limits.h>
+
+/* utility */
+#include "log.h"
+#include "mem.h"
+
+/* common */
+#include "extras.h"
+#include "map.h"
+#include "movement.h"
+#include "road.h"
+#include "tile.h"
+#include "unittype.h"
+
+#include "pf_alt.h"
+
+/* How many landmarks to pick per continent. More landmarks tighten the
+ * bound but cost one distance table each. */
+#define PF_ALT_LANDMARKS_PER_CONTINENT 12
+
+/* Global cap on tables; small islands past this just get no landmarks
+ * and fall back to the plain search. */
+#define PF_ALT_MAX_LANDMARKS 96
+
+/* Continents smaller than this are not worth a table; the plain search
+ * exhausts them instantly anyway. */
+#define PF_ALT_MIN_CONTINENT_TILES 64
+
+/* If every tile is already this close to some landmark, further
+ * landmarks would not improve the bound noticeably. */
+#define PF_ALT_MIN_SPREAD 4
+
+/* Distance value for tiles a landmark cannot reach. */
+#define PF_ALT_UNREACHABLE USHRT_MAX
+
+struct pf_alt_landmark {
+  Continent_id continent;       /* The continent this landmark serves. */
+  unsigned short *dist;         /* Hops per map index. */
+};
+
+struct pf_alt_table {
+  const struct civ_map *nmap;   /* The map the tables were built from. */
+  int num_landmarks;
+  struct pf_alt_landmark landmarks[PF_ALT_MAX_LANDMARKS];
+};
+
+/* The lazily built tables for the current map. */
+static struct pf_alt_table *pf_alt = nullptr;
+
+/************************************************************************//**
+  Breadth-first hop distances from the given origin, over the tiles of
+  the origin's continent. Unknown tiles (continent 0) are traversed as
+  wildcards so that partial knowledge, as on the client, can only lower
+  distances, keeping the estimate a lower bound. 'dist' must have
+  MAP_INDEX_SIZE entries.
+****************************************************************************/
+static void pf_alt_landmark_bfs(const struct civ_map *nmap,
+                                Continent_id cont, int origin,
+                                unsigned short *dist)
+{
+  int *queue = fc_malloc(MAP_INDEX_SIZE * sizeof(*queue));
+  int head = 0, tail = 0;
+  int i;
+
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    dist[i] = PF_ALT_UNREACHABLE;
+  }
+
+  dist[origin] = 0;
+  queue[tail++] = origin;
+
+  while (head < tail) {
+    int current = queue[head++];
+    struct tile *ptile = index_to_tile(nmap, current);
+
+    adjc_iterate(nmap, ptile, atile) {
+      Continent_id acont = tile_continent(atile);
+      int aindex = tile_index(atile);
+
+      if ((acont == cont || acont == 0)
+          && dist[aindex] == PF_ALT_UNREACHABLE) {
+        dist[aindex] = dist[current] + 1;
+        queue[tail++] = aindex;
+      }
+    } adjc_iterate_end;
+  }
+
+  free(queue);
+}
+
+/************************************************************************//**
+  Pick landmarks for one continent by farthest-point selection and fill
+  their distance tables.
+****************************************************************************/
+static void pf_alt_continent_build(struct pf_alt_table *table,
+                                   Continent_id cont, int seed_index)
+{
+  const struct civ_map *nmap = table->nmap;
+  unsigned short *mind = fc_malloc(MAP_INDEX_SIZE * sizeof(*mind));
+  int next = seed_index;
+  int count = 0;
+  int i;
+
+  /* The seed tile is arbitrary; start from the tile farthest from it so
+   * that the first landmark sits on the continent's rim. */
+  pf_alt_landmark_bfs(nmap, cont, seed_index, mind);
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    if (mind[i] != PF_ALT_UNREACHABLE && mind[i] > mind[next]) {
+      next = i;
+    }
+  }
+
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    mind[i] = PF_ALT_UNREACHABLE;
+  }
+
+  while (count < PF_ALT_LANDMARKS_PER_CONTINENT
+         && table->num_landmarks < PF_ALT_MAX_LANDMARKS) {
+    struct pf_alt_landmark *landmark
+      = table->landmarks + table->num_landmarks;
+    int farthest = next, spread = 0;
+
+    landmark->continent = cont;
+    landmark->dist = fc_malloc(MAP_INDEX_SIZE * sizeof(*landmark->dist));
+    pf_alt_landmark_bfs(nmap, cont, next, landmark->dist);
+    table->num_landmarks++;
+    count++;
+
+    /* Track the distance to the nearest chosen landmark and put the
+     * next one where that distance peaks. */
+    for (i = 0; i < MAP_INDEX_SIZE; i++) {
+      if (landmark->dist[i] < mind[i]) {
+        mind[i] = landmark->dist[i];
+      }
+      if (mind[i] != PF_ALT_UNREACHABLE && mind[i] > spread) {
+        spread = mind[i];
+        farthest = i;
+      }
+    }
+
+    if (spread <= PF_ALT_MIN_SPREAD) {
+      /* The continent is covered; more landmarks would be wasted. */
+      break;
+    }
+    next = farthest;
+  }
+
+  free(mind);
+}
+
+/************************************************************************//**
+  Build the landmark tables for the given map.
+****************************************************************************/
+static struct pf_alt_table *pf_alt_table_build(const struct civ_map *nmap)
+{
+  struct pf_alt_table *table = fc_malloc(sizeof(*table));
+  Continent_id max_cont = 0, cont;
+  int *counts, *seeds;
+  int i;
+
+  table->nmap = nmap;
+  table->num_landmarks = 0;
+
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    cont = tile_continent(index_to_tile(nmap, i));
+    if (cont > max_cont) {
+      max_cont = cont;
+    }
+  }
+
+  counts = fc_calloc(max_cont + 1, sizeof(*counts));
+  seeds = fc_malloc((max_cont + 1) * sizeof(*seeds));
+  for (cont = 0; cont <= max_cont; cont++) {
+    seeds[cont] = -1;
+  }
+
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    cont = tile_continent(index_to_tile(nmap, i));
+    if (cont > 0) {
+      counts[cont]++;
+      if (seeds[cont] < 0) {
+        seeds[cont] = i;
+      }
+    }
+  }
+
+  for (cont = 1; cont <= max_cont; cont++) {
+    if (counts[cont] >= PF_ALT_MIN_CONTINENT_TILES
+        && table->num_landmarks < PF_ALT_MAX_LANDMARKS) {
+      pf_alt_continent_build(table, cont, seeds[cont]);
+    }
+  }
+
+  free(counts);
+  free(seeds);
+
+  return table;
+}
+
+/************************************************************************//**
+  Destroy a landmark table set.
+****************************************************************************/
+static void pf_alt_table_destroy(struct pf_alt_table *table)
+{
+  int i;
+
+  for (i = 0; i < table->num_landmarks; i++) {
+    free(table->landmarks[i].dist);
+  }
+  free(table);
+}
+
+/************************************************************************//**
+  The pf_parameter::get_estimate callback. Lower bound on the remaining
+  cost-of-path: the best landmark bound in hops, at one move fragment per
+  hop. Only landmarks of the goal's continent are valid bounds, as their
+  tables contain every edge such a path may use.
+****************************************************************************/
+static unsigned pf_alt_estimate(const struct tile *ptile,
+                                const struct pf_parameter *param)
+{
+  Continent_id cont;
+  int tindex, gindex, best = 0, i;
+
+  if (pf_alt == nullptr) {
+    /* Invalidated while a map using the estimate was alive; degrade to
+     * the plain ordering rather than touching freed tables. */
+    return 0;
+  }
+
+  cont = tile_continent(param->goal_tile);
+  tindex = tile_index(ptile);
+  gindex = tile_index(param->goal_tile);
+
+  for (i = 0; i < pf_alt->num_landmarks; i++) {
+    const unsigned short *dist = pf_alt->landmarks[i].dist;
+    int diff;
+
+    if (pf_alt->landmarks[i].continent != cont
+        || dist[tindex] == PF_ALT_UNREACHABLE
+        || dist[gindex] == PF_ALT_UNREACHABLE) {
+      continue;
+    }
+
+    diff = (int) dist[tindex] - (int) dist[gindex];
+    if (diff < 0) {
+      diff = -diff;
+    }
+    if (diff > best) {
+      best = diff;
+    }
+  }
+
+  return best * PF_TURN_FACTOR;
+}
+
+/************************************************************************//**
+  Set up 'parameter' for a goal-directed search towards 'goal_tile'.
+  Returns FALSE, leaving the parameter untouched, when the query or the
+  ruleset does not qualify; the caller then simply gets the plain search.
+****************************************************************************/
+bool pf_alt_fill_parameter(struct pf_parameter *parameter,
+                           struct tile *goal_tile)
+{
+  Continent_id cont = tile_continent(parameter->start_tile);
+  int i;
+
+  if (parameter->get_costs != nullptr
+      || parameter->is_pos_dangerous != nullptr
+      || parameter->get_moves_left_req != nullptr
+      || parameter->get_estimate != nullptr
+      || cont <= 0 || cont != tile_continent(goal_tile)) {
+    return FALSE;
+  }
+
+  /* The estimate charges at least one move fragment per hop. Free
+   * movement - zero-cost roads, or free igter steps - would make it an
+   * overestimate, so leave such rulesets to the plain search. */
+  if (parameter->utype != nullptr
+      && utype_has_flag(parameter->utype, UTYF_IGTER)
+      && MOVE_COST_IGTER < 1) {
+    return FALSE;
+  }
+  extra_type_by_cause_iterate(EC_ROAD, pextra) {
+    if (extra_road_get(pextra)->move_cost < 1) {
+      return FALSE;
+    }
+  } extra_type_by_cause_iterate_end;
+
+  if (pf_alt != nullptr && pf_alt->nmap != parameter->map) {
+    pf_alt_invalidate();
+  }
+  if (pf_alt == nullptr) {
+    pf_alt = pf_alt_table_build(parameter->map);
+  }
+
+  for (i = 0; i < pf_alt->num_landmarks; i++) {
+    if (pf_alt->landmarks[i].continent == cont) {
+      parameter->get_estimate = pf_alt_estimate;
+      parameter->goal_tile = goal_tile;
+      return TRUE;
+    }
+  }
+
+  /* No landmarks for this continent (too small, or over the cap). */
+  return FALSE;
+}
+
+/************************************************************************//**
+  Throw away the landmark tables. Must be called whenever terrain changes
+  may have altered movement possibilities; the tables are rebuilt on the
+  next eligible query.
+****************************************************************************/
+void pf_alt_invalidate(void)
+{
+  if (pf_alt != nullptr) {
+    pf_alt_table_destroy(pf_alt);
+    pf_alt = nullptr;
+  }
+}
+
+/************************************************************************//**
+  Free all resources held by this module.
+****************************************************************************/
+void pf_alt_free(void)
+{
+  pf_alt_invalidate();
+}
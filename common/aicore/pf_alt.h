@@ -0,0 +1,42 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 2003 - The Freeciv Project
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__PF_ALT_H
+#define FC__PF_ALT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* common/aicore */
+#include "path_finding.h"
+
+/* Landmark distance tables for goal-directed path finding ("ALT": A*,
+ * landmarks, triangle inequality). A handful of landmark tiles is chosen
+ * on each continent and the breadth-first distance from each landmark to
+ * every tile is precomputed lazily. For a single-destination query,
+ * |dist(L, tile) - dist(L, goal)| then gives a lower bound on the
+ * remaining path length, which pf_parameter::get_estimate turns into a
+ * goal-directed search expanding only a fraction of the map. The tables
+ * are thrown away on terrain change and rebuilt on the next query. */
+
+bool pf_alt_fill_parameter(struct pf_parameter *parameter,
+                           struct tile *goal_tile);
+
+void pf_alt_invalidate(void);
+void pf_alt_free(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FC__PF_ALT_H */
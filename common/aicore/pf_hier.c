@@ -0,0 +1,364 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 2003 - The Freeciv Project
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+/* utility */
+#include "log.h"
+#include "mem.h"
+
+/* common */
+#include "map.h"
+#include "tile.h"
+
+#include "pf_alt.h"
+#include "pf_hier.h"
+
+/* Edge length of a cluster, in native coordinates. */
+#define PF_HIER_CLUSTER_SIZE 16
+
+/* Queries below this real distance just use the flat search; the
+ * abstraction only pays off when the flat search would explore far
+ * beyond the corridor. */
+#define PF_HIER_MIN_DISTANCE 3 * PF_HIER_CLUSTER_SIZE
+
+/* How much longer than the best cluster-level route a cluster chain may
+ * be and still belong to the corridor. Gives the flat search room to
+ * route around local obstacles the abstraction cannot see. */
+#define PF_HIER_CORRIDOR_SLACK 2
+
+/* One cluster of the abstraction graph. Only the set of continents with
+ * at least one tile inside the cluster is recorded; that is all that is
+ * needed to know whether a unit restricted to one continent may pass. */
+struct pf_hier_cluster {
+  Continent_id *continents;     /* Distinct ids, unsorted, usually few. */
+  int num_continents;
+};
+
+struct pf_hier_graph {
+  const struct civ_map *nmap;   /* The map this graph was built from. */
+  int width, height;            /* Cluster grid dimensions. */
+  int num_clusters;
+  struct pf_hier_cluster *clusters;
+};
+
+/* The lazily built graph for the current map. */
+static struct pf_hier_graph *pf_hier = nullptr;
+
+/* Passed to the restricted flat search through pf_parameter::data. */
+struct pf_hier_filter {
+  const struct pf_hier_graph *graph;
+  const bool *corridor;         /* Indexed by cluster. */
+  enum tile_behavior (*orig_get_TB) (const struct tile *ptile,
+                                     enum known_type known,
+                                     const struct pf_parameter *param);
+};
+
+/************************************************************************//**
+  Cluster index of the given tile.
+****************************************************************************/
+static inline int pf_hier_cluster_index(const struct pf_hier_graph *graph,
+                                        const struct tile *ptile)
+{
+  int tindex = tile_index(ptile);
+  int nat_x = tindex % graph->nmap->xsize;
+  int nat_y = tindex / graph->nmap->xsize;
+
+  return (nat_x / PF_HIER_CLUSTER_SIZE
+          + (nat_y / PF_HIER_CLUSTER_SIZE) * graph->width);
+}
+
+/************************************************************************//**
+  Does the cluster contain at least one tile of the given continent?
+****************************************************************************/
+static bool pf_hier_cluster_has_continent(const struct pf_hier_cluster
+                                          *cluster, Continent_id cont)
+{
+  int i;
+
+  for (i = 0; i < cluster->num_continents; i++) {
+    if (cluster->continents[i] == cont) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/************************************************************************//**
+  Build the abstraction graph for the given map.
+****************************************************************************/
+static struct pf_hier_graph *pf_hier_graph_build(const struct civ_map *nmap)
+{
+  struct pf_hier_graph *graph = fc_malloc(sizeof(*graph));
+  int i;
+
+  graph->nmap = nmap;
+  graph->width = (nmap->xsize + PF_HIER_CLUSTER_SIZE - 1)
+                 / PF_HIER_CLUSTER_SIZE;
+  graph->height = (nmap->ysize + PF_HIER_CLUSTER_SIZE - 1)
+                  / PF_HIER_CLUSTER_SIZE;
+  graph->num_clusters = graph->width * graph->height;
+  graph->clusters = fc_calloc(graph->num_clusters,
+                              sizeof(*graph->clusters));
+
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    struct tile *ptile = index_to_tile(nmap, i);
+    Continent_id cont = tile_continent(ptile);
+    struct pf_hier_cluster *cluster;
+
+    if (cont == 0) {
+      continue;
+    }
+
+    cluster = graph->clusters + pf_hier_cluster_index(graph, ptile);
+    if (!pf_hier_cluster_has_continent(cluster, cont)) {
+      cluster->continents
+        = fc_realloc(cluster->continents,
+                     (cluster->num_continents + 1)
+                     * sizeof(*cluster->continents));
+      cluster->continents[cluster->num_continents++] = cont;
+    }
+  }
+
+  return graph;
+}
+
+/************************************************************************//**
+  Destroy an abstraction graph.
+****************************************************************************/
+static void pf_hier_graph_destroy(struct pf_hier_graph *graph)
+{
+  int i;
+
+  for (i = 0; i < graph->num_clusters; i++) {
+    if (graph->clusters[i].continents != nullptr) {
+      free(graph->clusters[i].continents);
+    }
+  }
+  free(graph->clusters);
+  free(graph);
+}
+
+/************************************************************************//**
+  Breadth-first fill of cluster-level distances over the clusters which
+  contain the given continent. 'dist' must have graph->num_clusters
+  entries; unreached clusters are left at -1.
+****************************************************************************/
+static void pf_hier_cluster_bfs(const struct pf_hier_graph *graph,
+                                Continent_id cont, int origin, int *dist)
+{
+  int *queue = fc_malloc(graph->num_clusters * sizeof(*queue));
+  int head = 0, tail = 0;
+  bool wrap_x = wrap_has_flag(graph->nmap->wrap_id, WRAP_X);
+  bool wrap_y = wrap_has_flag(graph->nmap->wrap_id, WRAP_Y);
+  int i;
+
+  for (i = 0; i < graph->num_clusters; i++) {
+    dist[i] = -1;
+  }
+
+  dist[origin] = 0;
+  queue[tail++] = origin;
+
+  while (head < tail) {
+    int current = queue[head++];
+    int cx = current % graph->width;
+    int cy = current / graph->width;
+    int dx, dy;
+
+    for (dy = -1; dy <= 1; dy++) {
+      for (dx = -1; dx <= 1; dx++) {
+        int nx = cx + dx, ny = cy + dy;
+        int neighbor;
+
+        if (dx == 0 && dy == 0) {
+          continue;
+        }
+        if (nx < 0 || nx >= graph->width) {
+          if (!wrap_x) {
+            continue;
+          }
+          nx = FC_WRAP(nx, graph->width);
+        }
+        if (ny < 0 || ny >= graph->height) {
+          if (!wrap_y) {
+            continue;
+          }
+          ny = FC_WRAP(ny, graph->height);
+        }
+
+        neighbor = nx + ny * graph->width;
+        if (dist[neighbor] < 0
+            && pf_hier_cluster_has_continent(graph->clusters + neighbor,
+                                             cont)) {
+          dist[neighbor] = dist[current] + 1;
+          queue[tail++] = neighbor;
+        }
+      }
+    }
+  }
+
+  free(queue);
+}
+
+/************************************************************************//**
+  Tile behavior callback for the corridor-restricted flat search. Tiles
+  outside the corridor are treated as impassable; inside it, the original
+  callback (if any) decides.
+****************************************************************************/
+static enum tile_behavior pf_hier_get_tb(const struct tile *ptile,
+                                         enum known_type known,
+                                         const struct pf_parameter *param)
+{
+  const struct pf_hier_filter *filter = param->data;
+
+  if (!filter->corridor[pf_hier_cluster_index(filter->graph, ptile)]) {
+    return TB_IGNORE;
+  }
+
+  if (filter->orig_get_TB != nullptr) {
+    return filter->orig_get_TB(ptile, known, param);
+  }
+
+  return TB_NORMAL;
+}
+
+/************************************************************************//**
+  Plain flat search, used below the distance threshold and as fallback.
+****************************************************************************/
+static struct pf_path *pf_hier_flat_path(const struct pf_parameter
+                                         *parameter, struct tile *ptile)
+{
+  struct pf_map *pfm = pf_map_new(parameter);
+  struct pf_path *path = pf_map_path(pfm, ptile);
+
+  pf_map_destroy(pfm);
+
+  return path;
+}
+
+/************************************************************************//**
+  Find a path from parameter->start_tile to 'ptile', using the cluster
+  abstraction when the query qualifies for it. Works exactly like
+  pf_map_new() followed by pf_map_path() otherwise; this makes it a safe
+  drop-in for one-shot path queries with any parameter.
+****************************************************************************/
+struct pf_path *pf_hier_map_path(const struct pf_parameter *parameter,
+                                 struct tile *ptile)
+{
+  Continent_id cont = tile_continent(parameter->start_tile);
+  struct pf_parameter base, param;
+  struct pf_hier_filter filter;
+  struct pf_path *path;
+  bool *corridor;
+  int *dist_s, *dist_d;
+  int origin, dest, best, i;
+
+  /* Goal-directed ordering is independent of the corridor restriction
+   * and speeds up the flat search as well; a no-op when the query does
+   * not qualify for it. */
+  base = *parameter;
+  pf_alt_fill_parameter(&base, ptile);
+  parameter = &base;
+
+  if (parameter->get_costs != nullptr
+      || parameter->is_pos_dangerous != nullptr
+      || parameter->get_moves_left_req != nullptr
+      || parameter->data != nullptr
+      || cont == 0 || cont != tile_continent(ptile)
+      || real_map_distance(parameter->start_tile, ptile)
+         < PF_HIER_MIN_DISTANCE) {
+    /* Not eligible for the abstraction. */
+    return pf_hier_flat_path(parameter, ptile);
+  }
+
+  if (pf_hier != nullptr && pf_hier->nmap != parameter->map) {
+    pf_hier_invalidate();
+  }
+  if (pf_hier == nullptr) {
+    pf_hier = pf_hier_graph_build(parameter->map);
+  }
+
+  origin = pf_hier_cluster_index(pf_hier, parameter->start_tile);
+  dest = pf_hier_cluster_index(pf_hier, ptile);
+
+  dist_s = fc_malloc(pf_hier->num_clusters * sizeof(*dist_s));
+  dist_d = fc_malloc(pf_hier->num_clusters * sizeof(*dist_d));
+  pf_hier_cluster_bfs(pf_hier, cont, origin, dist_s);
+  pf_hier_cluster_bfs(pf_hier, cont, dest, dist_d);
+
+  if (dist_s[dest] < 0) {
+    /* Same continent but not cluster-connected; should not happen, but
+     * trust the flat search over the abstraction. */
+    free(dist_s);
+    free(dist_d);
+    return pf_hier_flat_path(parameter, ptile);
+  }
+
+  /* The corridor consists of every cluster lying on a route at most
+   * PF_HIER_CORRIDOR_SLACK steps longer than the best one. */
+  best = dist_s[dest];
+  corridor = fc_malloc(pf_hier->num_clusters * sizeof(*corridor));
+  for (i = 0; i < pf_hier->num_clusters; i++) {
+    corridor[i] = (dist_s[i] >= 0 && dist_d[i] >= 0
+                   && dist_s[i] + dist_d[i]
+                      <= best + PF_HIER_CORRIDOR_SLACK);
+  }
+  free(dist_s);
+  free(dist_d);
+
+  filter.graph = pf_hier;
+  filter.corridor = corridor;
+  filter.orig_get_TB = parameter->get_TB;
+
+  param = *parameter;
+  param.get_TB = pf_hier_get_tb;
+  param.data = &filter;
+
+  path = pf_hier_flat_path(&param, ptile);
+  free(corridor);
+
+  if (path == nullptr) {
+    /* The corridor was too tight; retry unrestricted. */
+    log_debug("pf_hier: corridor search failed, falling back to flat "
+              "search (%d, %d) -> (%d, %d).",
+              TILE_XY(parameter->start_tile), TILE_XY(ptile));
+    return pf_hier_flat_path(parameter, ptile);
+  }
+
+  return path;
+}
+
+/************************************************************************//**
+  Throw away the abstraction graph. Must be called whenever terrain
+  changes may have altered continent data; the graph is rebuilt on the
+  next eligible query.
+****************************************************************************/
+void pf_hier_invalidate(void)
+{
+  if (pf_hier != nullptr) {
+    pf_hier_graph_destroy(pf_hier);
+    pf_hier = nullptr;
+  }
+}
+
+/************************************************************************//**
+  Free all resources held by this module.
+****************************************************************************/
+void pf_hier_free(void)
+{
+  pf_hier_invalidate();
+}
@@ -0,0 +1,42 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 2003 - The Freeciv Project
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__PF_HIER_H
+#define FC__PF_HIER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* common/aicore */
+#include "path_finding.h"
+
+/* A hierarchical layer on top of "path_finding.[ch]" for long-range
+ * one-shot path queries. The map is partitioned into fixed-size clusters
+ * and a cluster-level abstraction graph is built lazily from continent
+ * data. A long-range query first finds a corridor of clusters at the
+ * abstract level and then runs the flat search restricted to that
+ * corridor, falling back to the unrestricted flat search whenever the
+ * restricted one fails or the parameter is not supported. */
+
+struct pf_path *pf_hier_map_path(const struct pf_parameter *parameter,
+                                 struct tile *ptile)
+                fc__warn_unused_result;
+
+void pf_hier_invalidate(void);
+void pf_hier_free(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FC__PF_HIER_H */
@@ -696,6 +696,8 @@ pft_fill_default_parameter(struct pf_parameter *parameter,
   parameter->get_action = nullptr;
   parameter->is_action_possible = nullptr;
   parameter->actions = PF_AA_NONE;
+  parameter->get_estimate = nullptr;
+  parameter->goal_tile = nullptr;
 
   parameter->utype = punittype;
 }
@@ -16,12 +16,16 @@
 #endif
 
 /* utility */
+#include "bitvector.h"
 #include "fcintl.h"
 #include "log.h"
+#include "mem.h"
 
 /* common */
+#include "effects.h"
 #include "game.h"
 #include "map.h"
+#include "player.h"
 #include "tile.h"
 #include "unit.h"
 
@@ -96,20 +100,158 @@ int tile_border_source_strength(struct tile *ptile)
 }
 
 /*********************************************************************//**
-  Border source strength at tile
+  Accumulate EFT_BORDER_STRENGTH_PCT into strengths[] for a batch of
+  cityless claimer tiles sharing one owner, then convert the accumulated
+  percentage of each batch member to its source strength.
 *************************************************************************/
-int tile_border_strength(struct tile *ptile, struct tile *source)
+static void claimer_batch_strengths(const struct player *powner,
+                                    struct tile *const *batch,
+                                    const int *batch_idx, int count,
+                                    int *strengths, struct dbv *active)
+{
+  const struct req_context ctx = { .player = powner };
+  unsigned have = req_context_present_mask(&ctx) | REQF_TILE;
+  int k;
+
+  effect_list_iterate(get_effects(EFT_BORDER_STRENGTH_PCT), peffect) {
+    int value = peffect->value;
+
+    if ((peffect->context_need & ~have) != 0) {
+      /* Some requirement needs a context member these queries do not
+       * provide; the requirements cannot all hold. */
+      continue;
+    }
+
+    if (peffect->multiplier != NULL) {
+      if (powner == NULL) {
+        continue;
+      }
+      value = (value
+               * player_multiplier_effect_value(powner,
+                                                peffect->multiplier)) / 100;
+    }
+
+    are_reqs_active_tiles(&ctx, NULL, &peffect->reqs, RPT_CERTAIN,
+                          batch, count, active);
+    for (k = 0; k < count; k++) {
+      if (dbv_isset(active, k)) {
+        strengths[batch_idx[k]] += value;
+      }
+    }
+  } effect_list_iterate_end;
+
+  for (k = 0; k < count; k++) {
+    /* Base strength 100 / 100 = 1 */
+    strengths[batch_idx[k]] = (100 + strengths[batch_idx[k]]) / 100;
+  }
+}
+
+/*********************************************************************//**
+  Fill strengths[] with the border source strength of each tile in
+  tiles[]. City sources go through the cached city effect query as
+  before; terrain claimer sources of each owner share one batched
+  requirement sweep per effect instead of a full effect query per tile.
+*************************************************************************/
+void tile_border_source_strengths(struct tile *const *tiles, int ntiles,
+                                  int *strengths)
+{
+  struct extra_type_list *terr_claimers = extra_type_list_of_terr_claimers();
+  bool *pending;
+  struct tile **batch;
+  int *batch_idx;
+  struct dbv active;
+  int i, j;
+
+  if (ntiles <= 0) {
+    return;
+  }
+
+  if (BORDERS_DISABLED == game.info.borders) {
+    for (i = 0; i < ntiles; i++) {
+      strengths[i] = 0;
+    }
+    return;
+  }
+
+  pending = fc_calloc(ntiles, sizeof(*pending));
+
+  for (i = 0; i < ntiles; i++) {
+    struct city *pcity = tile_city(tiles[i]);
+
+    strengths[i] = 0;
+
+    if (pcity != NULL) {
+      strengths[i] = (city_size_get(pcity) + 2)
+        * (100 + get_city_bonus(pcity, EFT_BORDER_STRENGTH_PCT)) / 100;
+    } else {
+      extra_type_list_iterate(terr_claimers, pextra) {
+        if (tile_has_extra(tiles[i], pextra)) {
+          pending[i] = TRUE;
+          break;
+        }
+      } extra_type_list_iterate_end;
+    }
+  }
+
+  batch = fc_malloc(ntiles * sizeof(*batch));
+  batch_idx = fc_malloc(ntiles * sizeof(*batch_idx));
+  dbv_init(&active, ntiles);
+
+  /* One sweep per distinct tile owner; within a batch only the tile
+   * varies, matching the context get_tile_bonus() would have used for
+   * a cityless tile. */
+  for (i = 0; i < ntiles; i++) {
+    struct player *powner;
+    int count = 0;
+
+    if (!pending[i]) {
+      continue;
+    }
+
+    powner = tile_owner(tiles[i]);
+    for (j = i; j < ntiles; j++) {
+      if (pending[j] && tile_owner(tiles[j]) == powner) {
+        batch_idx[count] = j;
+        batch[count++] = tiles[j];
+        pending[j] = FALSE;
+      }
+    }
+
+    claimer_batch_strengths(powner, batch, batch_idx, count, strengths,
+                            &active);
+  }
+
+  dbv_free(&active);
+  free(batch_idx);
+  free(batch);
+  free(pending);
+}
+
+/*********************************************************************//**
+  Border source strength at tile, for a source strength the caller has
+  already computed.
+*************************************************************************/
+int tile_border_strength_full(struct tile *ptile, struct tile *source,
+                              int source_strength)
 {
-  int full_strength = tile_border_source_strength(source);
   int sq_dist = sq_map_distance(ptile, source);
 
   if (sq_dist > 0) {
-    return full_strength * full_strength / sq_dist;
+    return source_strength * source_strength / sq_dist;
   } else {
     return FC_INFINITY;
   }
 }
 
+/*********************************************************************//**
+  Border source strength at tile
+*************************************************************************/
+int tile_border_strength(struct tile *ptile, struct tile *source)
+{
+  return tile_border_strength_full(ptile, source,
+                                   tile_border_source_strength(source));
+}
+
 /*********************************************************************//**
   Is given tile source to borders.
 *************************************************************************/
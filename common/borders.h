@@ -22,7 +22,11 @@ struct tile;
 bool is_border_source(struct tile *ptile);
 int tile_border_source_radius_sq(struct tile *ptile);
 int tile_border_source_strength(struct tile *ptile);
+void tile_border_source_strengths(struct tile *const *tiles, int ntiles,
+                                  int *strengths);
 int tile_border_strength(struct tile *ptile, struct tile *source);
+int tile_border_strength_full(struct tile *ptile, struct tile *source,
+                              int source_strength);
 
 #ifdef __cplusplus
 }
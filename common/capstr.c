@@ -93,4 +93,12 @@ void init_our_capability(void)
     s = NETWORK_CAPSTRING;
   }
   sz_strlcpy(our_capability_internal, s);
+
+#ifdef FREECIV_HAVE_LIBZSTD
+  if (getenv("FREECIV_CAPS") == NULL) {
+    /* Optional capability: we can receive network streams compressed
+     * with zstd instead of zlib. See conn_compression_flush(). */
+    sz_strlcat(our_capability_internal, " zstdnet");
+  }
+#endif /* FREECIV_HAVE_LIBZSTD */
 }
@@ -77,6 +77,61 @@ static inline int city_tile_cache_get_output(const struct city *pcity,
                                              int city_tile_index,
                                              enum output_type_id o);
 
+/**************************************************************************
+  Per-(city, tile, output) cache of city_tile_output() results. City
+  refreshes and cm lattice builds ask for the same values many times
+  between game state changes. Entries are keyed by city id and city map
+  index and stamped with a generation counter that advances whenever
+  effects or tile contents change, so stale values are never read.
+  Server side only - the client does not see every change that would
+  have to invalidate it.
+**************************************************************************/
+struct tile_output_cache_tile {
+  unsigned valid;               /* Bit (celeb * O_LAST + otype) */
+  int output[2][O_LAST];        /* [is_celebrating][otype] */
+};
+
+struct tile_output_cache {
+  unsigned generation;          /* tile_output_generation when reset */
+  int radius_sq;                /* City radius the entries are sized for */
+  struct tile_output_cache_tile *tiles;
+};
+
+static void tile_output_cache_destroy(struct tile_output_cache *pcache);
+
+#define SPECHASH_TAG tile_output
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_IDATA_TYPE struct tile_output_cache *
+#define SPECHASH_IDATA_FREE tile_output_cache_destroy
+#include "spechash.h"
+
+static struct tile_output_hash *tile_output_cache_hash = NULL;
+static unsigned tile_output_generation = 1;
+static bool tile_output_cache_frozen = FALSE;
+
+/* Cache of can_city_build_improvement_now() results, keyed by city id.
+ * Entries expire with the effect cache epoch (buildings, techs,
+ * government, city sizes, turn change), the tile output generation
+ * (terrain and extra changes) and the city's own state generation
+ * (worked tiles, ownership). Server only. */
+struct city_build_cache {
+  unsigned epoch;               /* effect_cache_epoch() when reset */
+  unsigned tile_gen;            /* tile_output_generation when reset */
+  int state_gen;                /* server.state_gen when reset */
+  bv_imprs known;               /* Which bits of buildable are valid */
+  bv_imprs buildable;
+};
+
+static void city_build_cache_destroy(struct city_build_cache *pcache);
+
+#define SPECHASH_TAG city_build
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_IDATA_TYPE struct city_build_cache *
+#define SPECHASH_IDATA_FREE city_build_cache_destroy
+#include "spechash.h"
+
+static struct city_build_hash *city_build_cache_hash = NULL;
+
 static const struct city *nearest_gov_center(const struct city *pcity,
                                              int *min_dist)
   fc__attribute((nonnull (1, 2)));
@@ -823,6 +878,69 @@ int city_production_turns_to_build(const struct city *pcity,
   return city_turns_to_build(pcity, &pcity->production, include_shield_stock);
 }
 
+/**********************************************************************//**
+  Free one city buildability cache entry.
+**************************************************************************/
+static void city_build_cache_destroy(struct city_build_cache *pcache)
+{
+  free(pcache);
+}
+
+/**********************************************************************//**
+  Free the city buildability cache.
+**************************************************************************/
+void city_build_cache_free(void)
+{
+  if (city_build_cache_hash != NULL) {
+    city_build_hash_destroy(city_build_cache_hash);
+    city_build_cache_hash = NULL;
+  }
+}
+
+/**********************************************************************//**
+  Return the buildability cache entry for 'pcity', with stale contents
+  cleared, or NULL when no entry may be used. Shares the tile output
+  cache freeze so the entries are read-only while AI threads run.
+**************************************************************************/
+static struct city_build_cache *
+city_build_cache_get(const struct city *pcity)
+{
+  struct city_build_cache *pcache;
+
+  if (!is_server() || pcity->id == IDENTITY_NUMBER_ZERO) {
+    /* Virtual cities carry speculative content. */
+    return NULL;
+  }
+
+  if (city_build_cache_hash == NULL) {
+    if (tile_output_cache_frozen) {
+      return NULL;
+    }
+    city_build_cache_hash = city_build_hash_new();
+  }
+  if (!city_build_hash_lookup(city_build_cache_hash, pcity->id, &pcache)) {
+    if (tile_output_cache_frozen) {
+      return NULL;
+    }
+    pcache = fc_calloc(1, sizeof(*pcache));
+    city_build_hash_insert(city_build_cache_hash, pcity->id, pcache);
+  }
+  if (pcache->epoch != effect_cache_epoch()
+      || pcache->tile_gen != tile_output_generation
+      || pcache->state_gen != pcity->server.state_gen) {
+    if (tile_output_cache_frozen) {
+      return NULL;
+    }
+    BV_CLR_ALL(pcache->known);
+    BV_CLR_ALL(pcache->buildable);
+    pcache->epoch = effect_cache_epoch();
+    pcache->tile_gen = tile_output_generation;
+    pcache->state_gen = pcity->server.state_gen;
+  }
+
+  return pcache;
+}
+
 /**********************************************************************//**
   Return whether given city can build given building, ignoring whether
   it is obsolete.
@@ -854,14 +972,25 @@ bool can_city_build_improvement_direct(const struct city *pcity,
 bool can_city_build_improvement_now(const struct city *pcity,
                                     const struct impr_type *pimprove)
 {
-  if (!can_city_build_improvement_direct(pcity, pimprove)) {
-    return FALSE;
+  struct city_build_cache *pcache = city_build_cache_get(pcity);
+  int inx = improvement_index(pimprove);
+  bool can;
+
+  if (pcache != NULL && BV_ISSET(pcache->known, inx)) {
+    return BV_ISSET(pcache->buildable, inx);
   }
-  if (improvement_obsolete(city_owner(pcity), pimprove, pcity)) {
-    return FALSE;
+
+  can = (can_city_build_improvement_direct(pcity, pimprove)
+         && !improvement_obsolete(city_owner(pcity), pimprove, pcity));
+
+  if (pcache != NULL && !tile_output_cache_frozen) {
+    BV_SET(pcache->known, inx);
+    if (can) {
+      BV_SET(pcache->buildable, inx);
+    }
   }
 
-  return TRUE;
+  return can;
 }
 
 /**********************************************************************//**
@@ -1183,6 +1312,9 @@ void city_size_set(struct city *pcity, citizens size)
 
   /* Set city size. */
   pcity->size = size;
+
+  /* Size is a common effect requirement. */
+  effect_cache_invalidate();
 }
 
 /**********************************************************************//**
@@ -1272,6 +1404,91 @@ int city_improvement_upkeep(const struct city *pcity,
   return upkeep;
 }
 
+/**********************************************************************//**
+  Free one entry of the tile output cache.
+**************************************************************************/
+static void tile_output_cache_destroy(struct tile_output_cache *pcache)
+{
+  free(pcache->tiles);
+  free(pcache);
+}
+
+/**********************************************************************//**
+  Invalidate all cached city_tile_output() values. Must be called
+  whenever game state that the outputs can depend on changes; effect
+  changes route here via effect_cache_invalidate(), terrain and extra
+  changes via the tile mutators.
+**************************************************************************/
+void city_tile_output_cache_invalidate(void)
+{
+  tile_output_generation++;
+}
+
+/**********************************************************************//**
+  Freeze or thaw the tile output cache. While frozen, cached values are
+  still used but no new entries are stored, making the cache safe to
+  read from several threads at once.
+**************************************************************************/
+void city_tile_output_cache_freeze(bool frozen)
+{
+  tile_output_cache_frozen = frozen;
+}
+
+/**********************************************************************//**
+  Free the tile output cache.
+**************************************************************************/
+void city_tile_output_cache_free(void)
+{
+  if (tile_output_cache_hash != NULL) {
+    tile_output_hash_destroy(tile_output_cache_hash);
+    tile_output_cache_hash = NULL;
+  }
+}
+
+/**********************************************************************//**
+  Return the tile output cache entry for 'pcity', with stale contents
+  cleared, or NULL when no entry may be created.
+**************************************************************************/
+static struct tile_output_cache *
+tile_output_cache_get(const struct city *pcity)
+{
+  struct tile_output_cache *pcache;
+  int radius_sq = city_map_radius_sq_get(pcity);
+
+  if (tile_output_cache_hash == NULL) {
+    if (tile_output_cache_frozen) {
+      return NULL;
+    }
+    tile_output_cache_hash = tile_output_hash_new();
+  }
+  if (!tile_output_hash_lookup(tile_output_cache_hash, pcity->id,
+                               &pcache)) {
+    if (tile_output_cache_frozen) {
+      return NULL;
+    }
+    pcache = fc_calloc(1, sizeof(*pcache));
+    pcache->radius_sq = -1;
+    tile_output_hash_insert(tile_output_cache_hash, pcity->id, pcache);
+  }
+  if (pcache->generation != tile_output_generation
+      || pcache->radius_sq != radius_sq) {
+    if (tile_output_cache_frozen) {
+      return NULL;
+    }
+    if (pcache->radius_sq != radius_sq) {
+      pcache->tiles = fc_realloc(pcache->tiles,
+                                 city_map_tiles(radius_sq)
+                                 * sizeof(*pcache->tiles));
+      pcache->radius_sq = radius_sq;
+    }
+    memset(pcache->tiles, 0,
+           city_map_tiles(radius_sq) * sizeof(*pcache->tiles));
+    pcache->generation = tile_output_generation;
+  }
+
+  return pcache;
+}
+
 /**********************************************************************//**
   Calculate the output for the tile.
   pcity may be NULL.
@@ -1284,6 +1501,9 @@ int city_tile_output(const struct city *pcity, const struct tile *ptile,
                      bool is_celebrating, Output_type_id otype)
 {
   int prod;
+  int celeb = is_celebrating ? 1 : 0;
+  int cindex = -1;
+  struct tile_output_cache *pcache = NULL;
   const struct req_context city_ctxt = {
     .player = pcity ? city_owner(pcity) : NULL,
     .city = pcity,
@@ -1300,6 +1520,24 @@ int city_tile_output(const struct city *pcity, const struct tile *ptile,
     return 0;
   }
 
+  /* Virtual cities and virtual tiles carry speculative content; the
+   * pointer comparison rejects virtual copies of real tiles, which share
+   * the real tile's index. */
+  if (pcity != NULL && pcity->id != IDENTITY_NUMBER_ZERO && is_server()
+      && index_to_tile(&(wld.map), tile_index(ptile)) == ptile) {
+    int cx, cy;
+
+    if (city_base_to_city_map(&cx, &cy, pcity, ptile)) {
+      cindex = city_tile_xy_to_index(cx, cy, city_map_radius_sq_get(pcity));
+      pcache = tile_output_cache_get(pcity);
+      if (pcache != NULL
+          && (pcache->tiles[cindex].valid
+              & (1u << (celeb * O_LAST + otype)))) {
+        return pcache->tiles[cindex].output[celeb][otype];
+      }
+    }
+  }
+
   prod = pterrain->output[otype];
   if (tile_resource_is_valid(ptile)) {
     prod += tile_resource(ptile)->data.resource->output[otype];
@@ -1368,6 +1606,11 @@ int city_tile_output(const struct city *pcity, const struct tile *ptile,
     prod = MAX(prod, game.info.min_city_center_output[otype]);
   }
 
+  if (pcache != NULL && !tile_output_cache_frozen) {
+    pcache->tiles[cindex].output[celeb][otype] = prod;
+    pcache->tiles[cindex].valid |= 1u << (celeb * O_LAST + otype);
+  }
+
   return prod;
 }
 
@@ -3001,8 +3244,7 @@ inline void set_city_production(struct city *pcity)
     if (can_trade) {
       int value;
 
-      value =
-        trade_base_between_cities(pcity, game_city_by_number(proute->partner));
+      value = trade_base_cached(proute, pcity, tcity);
       proute->value = trade_from_route(pcity, proute, value);
       pcity->prod[O_TRADE] += proute->value
         * (100 + get_city_bonus(pcity, EFT_TRADE_ROUTE_PCT)) / 100;
@@ -3399,6 +3641,8 @@ void city_add_improvement(struct city *pcity,
 {
   pcity->built[improvement_index(pimprove)].turn = game.info.turn; /*I_ACTIVE*/
 
+  effect_cache_invalidate();
+
   if (is_server() && is_wonder(pimprove)) {
     /* Client just read the info from the packets. */
     wonder_built(pcity, pimprove);
@@ -3416,6 +3660,8 @@ void city_remove_improvement(struct city *pcity,
 
   pcity->built[improvement_index(pimprove)].turn = I_DESTROYED;
 
+  effect_cache_invalidate();
+
   if (is_server() && is_wonder(pimprove)) {
     /* Client just read the info from the packets. */
     wonder_destroyed(pcity, pimprove);
@@ -445,6 +445,11 @@ struct city {
       /* the city map is synced with the client. */
       bool synced;
 
+      /* Incremented whenever city state that want evaluations depend on
+       * changes: buildings, worked tiles, ownership. The AIs compare it
+       * against the generation their per-city caches were computed at. */
+      int state_gen;
+
       bool debug;                   /* not saved */
 
       struct adv_city *adv;
@@ -693,6 +698,10 @@ void free_city_map_index(void);
 void city_production_caravan_shields_init(void);
 
 /* Output on spot */
+void city_tile_output_cache_invalidate(void);
+void city_tile_output_cache_freeze(bool frozen);
+void city_tile_output_cache_free(void);
+void city_build_cache_free(void);
 int city_tile_output(const struct city *pcity, const struct tile *ptile,
                      bool is_celebrating, Output_type_id otype);
 int city_tile_output_now(const struct city *pcity, const struct tile *ptile,
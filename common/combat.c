@@ -16,6 +16,7 @@
 #endif
 
 #include <math.h>
+#include <string.h>
 
 /* utility */
 #include "bitvector.h"
@@ -24,6 +25,8 @@
 
 /* common */
 #include "base.h"
+#include "effects.h"
+#include "fc_interface.h"
 #include "game.h"
 #include "map.h"
 #include "movement.h"
@@ -833,6 +836,84 @@ static int get_defense_rating(const struct civ_map *nmap,
   return rating;
 }
 
+/*******************************************************************//**
+  Best defender cache. The AI asks get_defender() about the same
+  (attacker, tile) pairs over and over inside its nested attacker-victim
+  loops, and ranking a stack costs several effect evaluations per unit.
+  Entries live in a small direct-mapped table and are self-validating:
+  the key covers everything of the attacker that feeds the ranking, a
+  hash over the tile's terrain and extras and the stack's unit ids, hit
+  points, veterancy, activity and transport state detects any change to
+  the battleground or the defenders, and an effect cache epoch stamp
+  expires entries on tech, building and government changes, so no
+  explicit invalidation hooks are needed. Server side only.
+***********************************************************************/
+struct defender_cache_entry {
+  int tile_index;
+  int attacker_owner;
+  int attacker_type;
+  int attacker_veteran;
+  int attacker_hp;                /* Never zero in a used entry */
+  int attacker_moves;
+  int action_id;                  /* -1 for no action */
+  unsigned stack_hash;
+  unsigned epoch;                 /* effect_cache_epoch() at store time */
+  int defender_id;                /* -1 for no valid defender */
+};
+
+#define DEFENDER_CACHE_SIZE 4096  /* Power of two */
+static struct defender_cache_entry defender_cache[DEFENDER_CACHE_SIZE];
+static bool combat_cache_frozen = FALSE;
+
+/*******************************************************************//**
+  Return a hash over the state of 'ptile' and its stack that the best
+  defender choice depends on.
+***********************************************************************/
+static unsigned defender_stack_hash(const struct tile *ptile)
+{
+  unsigned hash = 2166136261u;
+  const struct terrain *pterrain = tile_terrain(ptile);
+  size_t i;
+
+#define STACK_HASH_MIX(val) \
+  hash = (hash ^ (unsigned)(val)) * 16777619u
+  /* Defense bonuses depend on the battleground itself - a terrain
+   * transformation or a fortress appearing must miss. */
+  STACK_HASH_MIX(pterrain != NULL ? terrain_number(pterrain) : -1);
+  for (i = 0; i < sizeof(ptile->extras.vec); i++) {
+    STACK_HASH_MIX(ptile->extras.vec[i]);
+  }
+  unit_list_iterate(ptile->units, punit) {
+    STACK_HASH_MIX(punit->id);
+    STACK_HASH_MIX(punit->hp);
+    STACK_HASH_MIX(punit->veteran);
+    STACK_HASH_MIX(punit->activity);
+    STACK_HASH_MIX(unit_transported(punit) ? 1 : 0);
+  } unit_list_iterate_end;
+#undef STACK_HASH_MIX
+
+  return hash;
+}
+
+/*******************************************************************//**
+  Freeze or thaw the best defender cache. While frozen, cached values
+  are still used but no new entries are stored, making the cache safe
+  to read from several threads at once.
+***********************************************************************/
+void combat_cache_freeze(bool frozen)
+{
+  combat_cache_frozen = frozen;
+}
+
+/*******************************************************************//**
+  Drop all best defender cache entries. Must be called when the game a
+  cached unit id could refer to goes away.
+***********************************************************************/
+void combat_cache_clear(void)
+{
+  memset(defender_cache, 0, sizeof(defender_cache));
+}
+
 /*******************************************************************//**
   Finds the best defender on the tile, given an attacker. The diplomatic
   relationship of attacker and defender is ignored; the caller should check
@@ -845,6 +926,39 @@ struct unit *get_defender(const struct civ_map *nmap,
 {
   struct unit *bestdef = NULL;
   int bestvalue = -99, best_cost = 0, rating_of_best = 0;
+  struct defender_cache_entry *pentry = NULL;
+  unsigned shash = 0;
+  int act_id = (paction != NULL ? action_number(paction) : -1);
+
+  if (is_server() && unit_list_size(ptile->units) > 0) {
+    unsigned slot
+      = (((unsigned) tile_index(ptile)) * 2654435761u
+         + ((unsigned) utype_number(unit_type_get(attacker))) * 97u
+         + ((unsigned) (act_id + 1)) * 13u
+         + (unsigned) attacker->veteran)
+        & (DEFENDER_CACHE_SIZE - 1);
+
+    shash = defender_stack_hash(ptile);
+    pentry = &defender_cache[slot];
+    if (pentry->tile_index == tile_index(ptile)
+        && pentry->attacker_owner == player_number(unit_owner(attacker))
+        && pentry->attacker_type == utype_number(unit_type_get(attacker))
+        && pentry->attacker_veteran == attacker->veteran
+        && pentry->attacker_hp == attacker->hp
+        && pentry->attacker_moves == attacker->moves_left
+        && pentry->action_id == act_id
+        && pentry->stack_hash == shash
+        && pentry->epoch == effect_cache_epoch()) {
+      if (pentry->defender_id < 0) {
+        return NULL;
+      }
+      bestdef = game_unit_by_number(pentry->defender_id);
+      if (bestdef != NULL && unit_tile(bestdef) == ptile) {
+        return bestdef;
+      }
+      bestdef = NULL;
+    }
+  }
 
   /* Simply call unit_win_chance() with all the possible defenders in turn, and
    * take the best one. It currently uses build cost as a tiebreaker in
@@ -899,6 +1013,19 @@ struct unit *get_defender(const struct civ_map *nmap,
     }
   } unit_list_iterate_end;
 
+  if (pentry != NULL && !combat_cache_frozen) {
+    pentry->tile_index = tile_index(ptile);
+    pentry->attacker_owner = player_number(unit_owner(attacker));
+    pentry->attacker_type = utype_number(unit_type_get(attacker));
+    pentry->attacker_veteran = attacker->veteran;
+    pentry->attacker_hp = attacker->hp;
+    pentry->attacker_moves = attacker->moves_left;
+    pentry->action_id = act_id;
+    pentry->stack_hash = shash;
+    pentry->epoch = effect_cache_epoch();
+    pentry->defender_id = (bestdef != NULL ? bestdef->id : -1);
+  }
+
   return bestdef;
 }
 
@@ -94,6 +94,8 @@ int get_total_attack_power(const struct unit *attacker,
                            const struct unit *defender,
                            const struct action *paction);
 
+void combat_cache_freeze(bool frozen);
+void combat_cache_clear(void);
 struct unit *get_defender(const struct civ_map *nmap,
                           const struct unit *attacker,
                           const struct tile *ptile,
@@ -19,6 +19,7 @@
 
 /* utility */
 #include "astring.h"
+#include "bitvector.h"
 #include "fcintl.h"
 #include "log.h"
 #include "mem.h"
@@ -32,6 +33,7 @@
 #include "government.h"
 #include "improvement.h"
 #include "map.h"
+#include "metaknowledge.h"
 #include "packets.h"
 #include "player.h"
 #include "tech.h"
@@ -136,6 +138,164 @@ static struct {
   } reqs;
 } ruleset_cache;
 
+/**************************************************************************
+  Effect value cache. get_player_bonus() and get_city_bonus() results
+  are memoized per (effect type, player) and (effect type, city) until
+  effect_cache_invalidate() is called; city refresh code asks the same
+  questions many times between game state changes. Server side only -
+  the client does not see every event that would have to invalidate it.
+**************************************************************************/
+BV_DEFINE(bv_eff_cached, EFT_COUNT);
+
+struct city_eff_cache {
+  unsigned epoch;
+  bv_eff_cached valid;
+  int values[EFT_COUNT];
+};
+
+static void city_eff_cache_destroy(struct city_eff_cache *entry);
+
+#define SPECHASH_TAG eff_city
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_IDATA_TYPE struct city_eff_cache *
+#define SPECHASH_IDATA_FREE city_eff_cache_destroy
+#include "spechash.h"
+
+struct player_eff_cache {
+  unsigned epoch;
+  bv_eff_cached valid;
+  int values[EFT_COUNT];
+};
+
+static struct eff_city_hash *eff_city_cache = NULL;
+static struct player_eff_cache eff_player_cache[MAX_NUM_PLAYER_SLOTS];
+static unsigned eff_cache_epoch = 1;
+static bool eff_cache_frozen = FALSE;
+
+/*
+ * Hot-path query counters for the /reqstats command. Plain increments;
+ * concurrent AI threads may drop an occasional count, which is
+ * acceptable for profiling.
+ */
+static struct {
+  size_t calls[EFT_COUNT];
+  size_t turn_calls[EFT_COUNT];      /* Last completed turn */
+  size_t prev_calls[EFT_COUNT];
+  size_t cache_hits;
+  size_t cache_misses;
+  size_t turn_cache_hits;
+  size_t turn_cache_misses;
+  size_t prev_cache_hits;
+  size_t prev_cache_misses;
+} eff_stats;
+
+/**********************************************************************//**
+  Snapshot per-turn effect query counters. Called at turn change.
+**************************************************************************/
+void effect_stats_turn(void)
+{
+  int type;
+
+  for (type = 0; type < EFT_COUNT; type++) {
+    eff_stats.turn_calls[type]
+      = eff_stats.calls[type] - eff_stats.prev_calls[type];
+    eff_stats.prev_calls[type] = eff_stats.calls[type];
+  }
+  eff_stats.turn_cache_hits
+    = eff_stats.cache_hits - eff_stats.prev_cache_hits;
+  eff_stats.prev_cache_hits = eff_stats.cache_hits;
+  eff_stats.turn_cache_misses
+    = eff_stats.cache_misses - eff_stats.prev_cache_misses;
+  eff_stats.prev_cache_misses = eff_stats.cache_misses;
+}
+
+/**********************************************************************//**
+  Reset all effect query counters.
+**************************************************************************/
+void effect_stats_clear(void)
+{
+  memset(&eff_stats, 0, sizeof(eff_stats));
+}
+
+/**********************************************************************//**
+  Read the get_target_bonus_effects() call counters for one effect type.
+**************************************************************************/
+void effect_stats_get(enum effect_type type,
+                      size_t *calls, size_t *turn_calls)
+{
+  fc_assert_ret(type >= 0 && type < EFT_COUNT);
+
+  *calls = eff_stats.calls[type];
+  *turn_calls = eff_stats.turn_calls[type];
+}
+
+/**********************************************************************//**
+  Read the player/city effect value cache hit/miss counters.
+**************************************************************************/
+void effect_stats_cache(size_t *hits, size_t *misses,
+                        size_t *turn_hits, size_t *turn_misses)
+{
+  *hits = eff_stats.cache_hits;
+  *misses = eff_stats.cache_misses;
+  *turn_hits = eff_stats.turn_cache_hits;
+  *turn_misses = eff_stats.turn_cache_misses;
+}
+
+/**********************************************************************//**
+  Free one city effect cache entry.
+**************************************************************************/
+static void city_eff_cache_destroy(struct city_eff_cache *entry)
+{
+  free(entry);
+}
+
+/**********************************************************************//**
+  Invalidate all cached effect values. Must be called whenever game
+  state that effect requirements can depend on changes: buildings being
+  built or lost, government changes, techs gained, city size changes and
+  turn change all route through here.
+**************************************************************************/
+void effect_cache_invalidate(void)
+{
+  eff_cache_epoch++;
+
+  /* Effect provided embassies (EFT_HAVE_EMBASSIES) feed diplomatic
+   * knowability. */
+  metaknowledge_intel_invalidate();
+
+  /* Effect bonuses are an input of cached city tile outputs. */
+  city_tile_output_cache_invalidate();
+}
+
+/**********************************************************************//**
+  Freeze or thaw the effect value caches. While frozen, cached values
+  are still used but no new entries are stored, making the caches safe
+  to read from several threads at once. The game state that the cached
+  values depend on must not change while they are frozen.
+**************************************************************************/
+void effect_cache_freeze(bool frozen)
+{
+  eff_cache_frozen = frozen;
+}
+
+/**********************************************************************//**
+  Return the current effect cache epoch. Derived caches can stamp their
+  entries with it to expire alongside the effect value caches.
+**************************************************************************/
+unsigned effect_cache_epoch(void)
+{
+  return eff_cache_epoch;
+}
+
+/**********************************************************************//**
+  Return whether the effect value caches are currently frozen. Derived
+  caches must not store new entries while this is TRUE.
+**************************************************************************/
+bool effect_cache_is_frozen(void)
+{
+  return eff_cache_frozen;
+}
+
 
 /**********************************************************************//**
   Get a list of effects of this type.
@@ -193,6 +353,7 @@ struct effect *effect_new(enum effect_type type, int value,
   peffect->type = type;
   peffect->value = value;
   peffect->multiplier = pmul;
+  peffect->context_need = 0;
 
   requirement_vector_init(&peffect->reqs);
 
@@ -268,6 +429,7 @@ void effect_req_append(struct effect *peffect, struct requirement req)
   struct effect_list *eff_list = get_req_source_effects(&req.source);
 
   requirement_vector_append(&peffect->reqs, req);
+  peffect->context_need |= requirement_context_mask(&req);
 
   if (eff_list != NULL) {
     effect_list_append(eff_list, peffect);
@@ -375,6 +537,12 @@ void ruleset_cache_free(void)
     }
   }
 
+  if (eff_city_cache != NULL) {
+    eff_city_hash_destroy(eff_city_cache);
+    eff_city_cache = NULL;
+  }
+  effect_cache_invalidate();
+
   initialized = FALSE;
 }
 
@@ -446,6 +614,26 @@ int effect_cumulative_min(enum effect_type type, struct universal *for_uni)
   return value;
 }
 
+/**************************************************************************
+  Memo for effect_value_from_universals(). The result depends only on
+  the ruleset effects and the universals template, so an entry stays
+  valid until effect_cache_invalidate() is called. Help text generation
+  and AI what-if evaluation ask for the same few templates repeatedly.
+**************************************************************************/
+#define EFF_UNIS_MEMO_SLOTS 256
+#define EFF_UNIS_MEMO_MAX_UNIS 4
+
+struct eff_unis_memo {
+  unsigned epoch;
+  enum effect_type type;
+  size_t n_unis;
+  enum universals_n kinds[EFF_UNIS_MEMO_MAX_UNIS];
+  int numbers[EFF_UNIS_MEMO_MAX_UNIS];
+  int value;
+};
+
+static struct eff_unis_memo eff_unis_memo_tbl[EFF_UNIS_MEMO_SLOTS];
+
 /**********************************************************************//**
   Return the base value of a given effect that can always be expected from
   just the sources in the list, independent of other factors.
@@ -461,6 +649,32 @@ int effect_value_from_universals(enum effect_type type,
 {
   int value = 0;
   struct effect_list *el = get_effects(type);
+  struct eff_unis_memo *memo = NULL;
+
+  if (n_unis <= EFF_UNIS_MEMO_MAX_UNIS) {
+    unsigned hash = (unsigned) type;
+    size_t i;
+
+    for (i = 0; i < n_unis; i++) {
+      hash = hash * 257 + (unsigned) unis[i].kind;
+      hash = hash * 257 + (unsigned) universal_number(&unis[i]);
+    }
+    memo = &eff_unis_memo_tbl[hash % EFF_UNIS_MEMO_SLOTS];
+
+    if (memo->epoch == eff_cache_epoch
+        && memo->type == type
+        && memo->n_unis == n_unis) {
+      bool match = TRUE;
+
+      for (i = 0; match && i < n_unis; i++) {
+        match = (memo->kinds[i] == unis[i].kind
+                 && memo->numbers[i] == universal_number(&unis[i]));
+      }
+      if (match) {
+        return memo->value;
+      }
+    }
+  }
 
   effect_list_iterate(el, peffect) {
     bool effect_applies = TRUE;
@@ -524,6 +738,19 @@ int effect_value_from_universals(enum effect_type type,
     }
   } effect_list_iterate_end;
 
+  if (memo != NULL && !eff_cache_frozen) {
+    size_t i;
+
+    memo->epoch = eff_cache_epoch;
+    memo->type = type;
+    memo->n_unis = n_unis;
+    for (i = 0; i < n_unis; i++) {
+      memo->kinds[i] = unis[i].kind;
+      memo->numbers[i] = universal_number(&unis[i]);
+    }
+    memo->value = value;
+  }
+
   return value;
 }
 
@@ -747,13 +974,24 @@ int get_target_bonus_effects(struct effect_list *plist,
                              enum effect_type effect_type)
 {
   int bonus = 0;
+  unsigned have;
+
+  if (effect_type < EFT_COUNT) {
+    eff_stats.calls[effect_type]++;
+  }
 
   if (context == NULL) {
     context = req_context_empty();
   }
+  have = req_context_present_mask(context);
 
   /* Loop over all effects of this type. */
   effect_list_iterate(get_effects(effect_type), peffect) {
+    if ((peffect->context_need & ~have) != 0) {
+      /* Some requirement needs a context member this query does not
+       * provide; the requirements cannot all hold. */
+      continue;
+    }
     /* For each effect, see if it is active. */
     if (are_reqs_active(context, other_context,
                         &peffect->reqs, RPT_CERTAIN)) {
@@ -824,16 +1062,49 @@ int get_world_bonus(enum effect_type effect_type)
 int get_player_bonus(const struct player *pplayer,
                      enum effect_type effect_type)
 {
+  struct player_eff_cache *pcache;
+  int value;
+
   if (!initialized) {
     return 0;
   }
 
-  return get_target_bonus_effects(NULL,
-                                  &(const struct req_context) {
-                                    .player = pplayer,
-                                  },
-                                  NULL,
-                                  effect_type);
+  if (!is_server()) {
+    return get_target_bonus_effects(NULL,
+                                    &(const struct req_context) {
+                                      .player = pplayer,
+                                    },
+                                    NULL,
+                                    effect_type);
+  }
+
+  pcache = &eff_player_cache[player_index(pplayer)];
+  if (pcache->epoch != eff_cache_epoch) {
+    if (eff_cache_frozen) {
+      pcache = NULL;
+    } else {
+      BV_CLR_ALL(pcache->valid);
+      pcache->epoch = eff_cache_epoch;
+    }
+  }
+  if (pcache != NULL && BV_ISSET(pcache->valid, effect_type)) {
+    eff_stats.cache_hits++;
+    return pcache->values[effect_type];
+  }
+
+  eff_stats.cache_misses++;
+  value = get_target_bonus_effects(NULL,
+                                   &(const struct req_context) {
+                                     .player = pplayer,
+                                   },
+                                   NULL,
+                                   effect_type);
+  if (pcache != NULL && !eff_cache_frozen) {
+    pcache->values[effect_type] = value;
+    BV_SET(pcache->valid, effect_type);
+  }
+
+  return value;
 }
 
 /**********************************************************************//**
@@ -841,17 +1112,65 @@ int get_player_bonus(const struct player *pplayer,
 **************************************************************************/
 int get_city_bonus(const struct city *pcity, enum effect_type effect_type)
 {
+  struct city_eff_cache *pcache;
+  int value;
+
   if (!initialized) {
     return 0;
   }
 
-  return get_target_bonus_effects(NULL,
-                                  &(const struct req_context) {
-                                    .player = city_owner(pcity),
-                                    .city = pcity,
-                                    .tile = city_tile(pcity),
-                                  },
-                                  NULL, effect_type);
+  if (!is_server() || pcity->id == IDENTITY_NUMBER_ZERO) {
+    /* Virtual cities all share id zero, so caching by id would mix
+     * their speculative results - and real cities pass through here
+     * briefly before their identity number is assigned. */
+    return get_target_bonus_effects(NULL,
+                                    &(const struct req_context) {
+                                      .player = city_owner(pcity),
+                                      .city = pcity,
+                                      .tile = city_tile(pcity),
+                                    },
+                                    NULL, effect_type);
+  }
+
+  if (eff_city_cache == NULL && !eff_cache_frozen) {
+    eff_city_cache = eff_city_hash_new();
+  }
+  if (eff_city_cache == NULL
+      || !eff_city_hash_lookup(eff_city_cache, pcity->id, &pcache)) {
+    if (eff_cache_frozen) {
+      pcache = NULL;
+    } else {
+      pcache = fc_calloc(1, sizeof(*pcache));
+      eff_city_hash_insert(eff_city_cache, pcity->id, pcache);
+    }
+  }
+  if (pcache != NULL && pcache->epoch != eff_cache_epoch) {
+    if (eff_cache_frozen) {
+      pcache = NULL;
+    } else {
+      BV_CLR_ALL(pcache->valid);
+      pcache->epoch = eff_cache_epoch;
+    }
+  }
+  if (pcache != NULL && BV_ISSET(pcache->valid, effect_type)) {
+    eff_stats.cache_hits++;
+    return pcache->values[effect_type];
+  }
+
+  eff_stats.cache_misses++;
+  value = get_target_bonus_effects(NULL,
+                                   &(const struct req_context) {
+                                     .player = city_owner(pcity),
+                                     .city = pcity,
+                                     .tile = city_tile(pcity),
+                                   },
+                                   NULL, effect_type);
+  if (pcache != NULL && !eff_cache_frozen) {
+    pcache->values[effect_type] = value;
+    BV_SET(pcache->valid, effect_type);
+  }
+
+  return value;
 }
 
 /**********************************************************************//**
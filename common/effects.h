@@ -52,6 +52,11 @@ struct effect {
    * active if all of these requirement are met. */
   struct requirement_vector reqs;
 
+  /* REQF_* bits of the context members the requirements cannot evaluate
+   * without; queries lacking one of them can skip this effect outright.
+   * Maintained by effect_req_append(). */
+  unsigned context_need;
+
   /* Only relevant for ruledit and other rulesave users. */
   struct {
     /* Indicates that this effect is deleted and shouldn't be saved. */
@@ -99,6 +104,17 @@ struct packet_ruleset_effect;
 
 void ruleset_cache_init(void);
 void ruleset_cache_free(void);
+
+void effect_cache_invalidate(void);
+void effect_cache_freeze(bool frozen);
+unsigned effect_cache_epoch(void);
+bool effect_cache_is_frozen(void);
+void effect_stats_turn(void);
+void effect_stats_clear(void);
+void effect_stats_get(enum effect_type type,
+                      size_t *calls, size_t *turn_calls);
+void effect_stats_cache(size_t *hits, size_t *misses,
+                        size_t *turn_hits, size_t *turn_misses);
 void recv_ruleset_effect(const struct packet_ruleset_effect *packet);
 void send_ruleset_cache(struct conn_list *dest);
 
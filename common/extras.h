@@ -322,6 +322,22 @@ bool player_knows_extra_exist(const struct player *pplayer,
   }                                               \
 }
 
+/* Iterate the extra types whose bits are set in a bv_extras, jumping
+ * straight from one set bit to the next a word at a time instead of
+ * testing every extra type. The bound check guards against stray bits
+ * above the ruleset's extra count. */
+#define extra_set_iterate(_bv, _p)                                          \
+{                                                                           \
+  int _i_##_p;                                                              \
+  for (_i_##_p = BV_FIRST_SET(_bv);                                         \
+       _i_##_p >= 0 && _i_##_p < game.control.num_extra_types;              \
+       _i_##_p = BV_NEXT_SET(_bv, _i_##_p)) {                               \
+    struct extra_type *_p = extra_by_number(_i_##_p);
+
+#define extra_set_iterate_end                     \
+  }                                               \
+}
+
 #define extra_type_re_active_iterate(_p)                      \
   extra_type_iterate(_p) {                                    \
     if (!_p->ruledit_disabled) {
@@ -18,6 +18,7 @@
 /* utility */
 #include "astring.h"
 #include "fciconv.h"
+#include "fcthread.h"
 #include "netfile.h"
 #include "shared.h"
 
@@ -112,4 +113,5 @@ void libfreeciv_free(void)
   fc_iconv_close();
   fc_support_free();
   fc_astr_free();
+  fc_taskpool_global_free();
 }
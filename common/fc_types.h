@@ -65,6 +65,8 @@ extern "C" {
 #define MAX_CALENDAR_FRAGMENTS 52     /* Used in the network protocol. */
 #define MAX_NUM_TECH_CLASSES   16     /* Used in the network protocol. */
 #define MAX_NUM_ANIMALS        32     /* Used in the network protocol. */
+/* Used in the network protocol -- tiles per PACKET_TILE_INFO_BULK. */
+#define MAX_TILE_INFO_BULK     64
 
 /* Changing these will probably break network compatibility. */
 #define MAX_LEN_NAME        48
@@ -877,6 +877,14 @@ size_t featured_text_to_plain_text(const char *featured_text,
     *tags = text_tag_list_new();
   }
 
+  /* Fast path: no markup at all, which is the usual case for chat
+   * messages and events. Copy the string in one go. */
+  if (strchr(text_in, SEQ_START) == nullptr) {
+    size_t len = fc_strlcpy(plain_text, featured_text, plain_text_len);
+
+    return MIN(len, plain_text_len - 1);
+  }
+
   while (*text_in != '\0' && text_out_len > 1) {
     if (SEQ_START == *text_in) {
       /* Escape sequence... */
@@ -892,14 +900,17 @@ size_t featured_text_to_plain_text(const char *featured_text,
         switch (seq_type) {
         case ST_START:
           if (tags) {
-            /* Create a new tag. */
-            struct text_tag *ptag = fc_malloc(sizeof(struct text_tag));
+            /* Create a new tag. Parse on the stack first so invalid
+             * sequences don't cost an allocation. */
+            struct text_tag tag;
 
-            if (text_tag_init_from_sequence(ptag, type,
+            if (text_tag_init_from_sequence(&tag, type,
                                             text_out - plain_text, buf)) {
+              struct text_tag *ptag = fc_malloc(sizeof(struct text_tag));
+
+              *ptag = tag;
               text_tag_list_append(*tags, ptag);
             } else {
-              text_tag_destroy(ptag);
               log_featured_text("Couldn't create a text tag with \"%s\".",
                                 buf);
             }
@@ -958,8 +969,16 @@ size_t featured_text_to_plain_text(const char *featured_text,
         text_out_len--;
       }
     } else {
-      *text_out++ = *text_in++;
-      text_out_len--;
+      /* Copy the plain chunk up to the next sequence in one go. */
+      const char *next = strchr(text_in, SEQ_START);
+      size_t chunk = (next != nullptr
+                      ? (size_t) (next - text_in) : strlen(text_in));
+
+      chunk = MIN(chunk, text_out_len - 1);
+      memcpy(text_out, text_in, chunk);
+      text_in += chunk;
+      text_out += chunk;
+      text_out_len -= chunk;
     }
   }
   if (tags) {
@@ -0,0 +1,209 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* FORKSTATE - scratch handles for what-if evaluation
+ *
+ * Evaluation code (AI city placement, attack valuation, tree search)
+ * wants to mutate game state hypothetically and then throw the changes
+ * away. The live world is a web of idex, vision, and connection
+ * references, so a deep copy is not practical; instead a fork_state
+ * records an undo journal. Every mutation is either registered up
+ * front (fork_state_save() snapshots the bytes about to change) or
+ * made through a helper that knows how to reverse itself (virtual
+ * cities and units, tile ownership). fork_state_discard() plays the
+ * journal backwards, so entries may depend on earlier ones.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <string.h>
+
+/* utility */
+#include "log.h"
+#include "mem.h"
+
+/* common */
+#include "city.h"
+#include "tile.h"
+#include "unit.h"
+
+#include "forkstate.h"
+
+enum fork_entry_type {
+  FSE_MEM,        /* Raw bytes to copy back */
+  FSE_TILE_OWNER, /* Tile ownership to reinstate */
+  FSE_CITY,       /* Virtual city to destroy */
+  FSE_UNIT        /* Virtual unit to destroy */
+};
+
+struct fork_entry {
+  enum fork_entry_type type;
+  union {
+    struct {
+      void *data;
+      size_t size;
+      void *saved;
+    } mem;
+    struct {
+      struct tile *ptile;
+      struct player *owner;
+      struct tile *claimer;
+    } towner;
+    struct city *pcity;
+    struct unit *punit;
+  };
+};
+
+struct fork_state {
+  struct fork_entry *entries;
+  int count;
+  int allocated;
+};
+
+/**********************************************************************//**
+  Append a new journal entry to the handle and return it.
+**************************************************************************/
+static struct fork_entry *fork_entry_new(struct fork_state *fs)
+{
+  if (fs->count >= fs->allocated) {
+    fs->allocated = (fs->allocated > 0 ? fs->allocated * 2 : 8);
+    fs->entries = fc_realloc(fs->entries,
+                             fs->allocated * sizeof(*fs->entries));
+  }
+
+  return &fs->entries[fs->count++];
+}
+
+/**********************************************************************//**
+  Open a new scratch handle. Pair with fork_state_discard().
+**************************************************************************/
+struct fork_state *fork_state_begin(void)
+{
+  return fc_calloc(1, sizeof(struct fork_state));
+}
+
+/**********************************************************************//**
+  Snapshot 'size' bytes at 'data' so they are restored on discard.
+  Call before mutating the field.
+**************************************************************************/
+void fork_state_save(struct fork_state *fs, void *data, size_t size)
+{
+  struct fork_entry *pent = fork_entry_new(fs);
+
+  pent->type = FSE_MEM;
+  pent->mem.data = data;
+  pent->mem.size = size;
+  pent->mem.saved = fc_malloc(size);
+  memcpy(pent->mem.saved, data, size);
+}
+
+/**********************************************************************//**
+  Hand the tile to 'powner' (claiming from the tile itself), recording
+  the previous owner and claimer for the discard.
+**************************************************************************/
+void fork_state_tile_owner(struct fork_state *fs, struct tile *ptile,
+                           struct player *powner)
+{
+  struct fork_entry *pent = fork_entry_new(fs);
+
+  pent->type = FSE_TILE_OWNER;
+  pent->towner.ptile = ptile;
+  pent->towner.owner = tile_owner(ptile);
+  pent->towner.claimer = tile_claimer(ptile);
+
+  tile_set_owner(ptile, powner, ptile);
+}
+
+/**********************************************************************//**
+  Put a virtual city of 'pplayer' on the tile, temporarily claiming the
+  tile for them so city calculations see a plausible owner. Both are
+  reverted by the discard. Returns the virtual city; the caller must
+  not destroy it themselves.
+**************************************************************************/
+struct city *fork_state_city(struct fork_state *fs, struct tile *ptile,
+                             struct player *pplayer, const char *name)
+{
+  struct fork_entry *pent;
+  struct city *pcity;
+
+  fork_state_tile_owner(fs, ptile, pplayer);
+
+  pcity = create_city_virtual(pplayer, ptile, name);
+
+  pent = fork_entry_new(fs);
+  pent->type = FSE_CITY;
+  pent->pcity = pcity;
+
+  return pcity;
+}
+
+/**********************************************************************//**
+  Create a virtual unit of 'pplayer', placed on 'ptile' when one is
+  given. The unit is destroyed by the discard; the caller must not
+  destroy it themselves.
+**************************************************************************/
+struct unit *fork_state_unit(struct fork_state *fs, struct player *pplayer,
+                             struct tile *ptile,
+                             const struct unit_type *punittype,
+                             int veteran_level)
+{
+  struct fork_entry *pent;
+  struct unit *punit;
+
+  punit = unit_virtual_create(pplayer, nullptr, punittype, veteran_level);
+  if (ptile != nullptr) {
+    unit_tile_set(punit, ptile);
+  }
+
+  pent = fork_entry_new(fs);
+  pent->type = FSE_UNIT;
+  pent->punit = punit;
+
+  return punit;
+}
+
+/**********************************************************************//**
+  Undo every recorded change in reverse order and release the handle.
+**************************************************************************/
+void fork_state_discard(struct fork_state *fs)
+{
+  int i;
+
+  fc_assert_ret(fs != nullptr);
+
+  for (i = fs->count - 1; i >= 0; i--) {
+    struct fork_entry *pent = &fs->entries[i];
+
+    switch (pent->type) {
+    case FSE_MEM:
+      memcpy(pent->mem.data, pent->mem.saved, pent->mem.size);
+      free(pent->mem.saved);
+      break;
+    case FSE_TILE_OWNER:
+      tile_set_owner(pent->towner.ptile, pent->towner.owner,
+                     pent->towner.claimer);
+      break;
+    case FSE_CITY:
+      destroy_city_virtual(pent->pcity);
+      break;
+    case FSE_UNIT:
+      unit_virtual_destroy(pent->punit);
+      break;
+    }
+  }
+
+  free(fs->entries);
+  free(fs);
+}
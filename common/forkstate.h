@@ -0,0 +1,49 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__FORKSTATE_H
+#define FC__FORKSTATE_H
+
+#include <stddef.h>
+
+/* common */
+#include "fc_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* A fork_state is a scratch handle for what-if evaluation. Register the
+ * live state you are about to change on the handle, mutate it freely,
+ * and fork_state_discard() puts everything back in reverse order. It
+ * replaces the manual save-this-field/restore-that-field pattern, which
+ * tends to leak changes on early returns. */
+struct fork_state;
+
+struct fork_state *fork_state_begin(void);
+void fork_state_discard(struct fork_state *fs);
+
+void fork_state_save(struct fork_state *fs, void *data, size_t size);
+void fork_state_tile_owner(struct fork_state *fs, struct tile *ptile,
+                           struct player *powner);
+struct city *fork_state_city(struct fork_state *fs, struct tile *ptile,
+                             struct player *pplayer, const char *name);
+struct unit *fork_state_unit(struct fork_state *fs, struct player *pplayer,
+                             struct tile *ptile,
+                             const struct unit_type *punittype,
+                             int veteran_level);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FC__FORKSTATE_H */
@@ -24,6 +24,7 @@
 #include "support.h"
 
 /* aicore */
+#include "caravan.h"
 #include "cm.h"
 
 /* common */
@@ -32,6 +33,7 @@
 #include "actions.h"
 #include "actres.h"
 #include "city.h"
+#include "combat.h"
 #include "connection.h"
 #include "counters.h"
 #include "diptreaty.h"
@@ -56,6 +58,7 @@
 #include "unit.h"
 #include "unitlist.h"
 #include "victory.h"
+#include "vision.h"
 
 #include "game.h"
 
@@ -480,11 +483,17 @@ void game_free(void)
   player_slots_free();
   main_map_free();
   free_city_map_index();
+  city_tile_output_cache_free();
+  city_build_cache_free();
+  caravan_valuation_cache_free();
   idex_free(&wld);
   team_slots_free();
   game_ruleset_free();
   researches_free();
   cm_free();
+  combat_cache_clear();
+  move_cost_cache_invalidate();
+  vision_site_pool_free();
 }
 
 /**********************************************************************//**
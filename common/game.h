@@ -172,6 +172,7 @@ struct civ_game {
       enum trait_dist_mode trait_dist;
       int min_players;
       bool natural_city_names;
+      int netlagbytes;
       int netwait;
       int num_phases;
       int occupychance;
@@ -185,6 +186,21 @@ struct civ_game {
       int revolution_length;
       int spaceship_travel_pct;
       bool threaded_save;
+      int threadpoolsize;
+      bool forked_save;
+      bool binary_save;
+      bool delta_saves;
+
+      /* Delta autosave state; maintained by server/savegame/savemain.c.
+       * The counters advance whenever the corresponding savegame
+       * sections go stale; the *_base values are snapshots taken at the
+       * last full save that deltas are diffed against. */
+      struct {
+        bool have_base;
+        char base_path[MAX_LEN_PATH];
+        unsigned map_counter;
+        unsigned map_base;
+      } delta;
       int save_compress_level;
       enum fz_method save_compress_type;
       int save_nturns;
@@ -629,6 +645,10 @@ static inline bool is_ruleset_compat_mode(void)
 #define GAME_MIN_NETWAIT             0
 #define GAME_MAX_NETWAIT             20
 
+#define GAME_DEFAULT_NETLAGBYTES     0
+#define GAME_MIN_NETLAGBYTES         0
+#define GAME_MAX_NETLAGBYTES         (40 * 1024 * 1024)
+
 #define GAME_DEFAULT_PINGTIME        20
 #define GAME_MIN_PINGTIME            1
 #define GAME_MAX_PINGTIME            1800
@@ -696,6 +716,12 @@ static inline bool is_ruleset_compat_mode(void)
 #endif /* FREECIV_WEB */
 
 #define GAME_DEFAULT_THREADED_SAVE   FALSE
+#define GAME_DEFAULT_THREADPOOLSIZE  0
+#define GAME_MIN_THREADPOOLSIZE      0
+#define GAME_MAX_THREADPOOLSIZE      64
+#define GAME_DEFAULT_FORKED_SAVE     FALSE
+#define GAME_DEFAULT_BINARY_SAVE     FALSE
+#define GAME_DEFAULT_DELTA_SAVES     FALSE
 
 #define GAME_DEFAULT_USER_META_MESSAGE ""
 
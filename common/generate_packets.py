@@ -2493,6 +2493,14 @@ class Variant:
         if not self.fields and packet.fields:
             raise ValueError(f"empty variant for nonempty {self.packet_name} with capabilities {self.poscaps}")
 
+        if packet.reset_packets and (
+            not self.fields
+            or not isinstance(self.fields[0].type_info, IntType)
+        ):
+            # reset() is implemented as a packet_cache removal keyed by
+            # the leading field, which must hold the target's int key
+            raise ValueError(f"reset() on {self.packet_name} requires a leading integer id field")
+
     @property
     def cfg(self) -> ScriptConfig:
         """Configuration used when generating code for this packet
@@ -2558,6 +2566,14 @@ class Variant:
         See Packet.want_force"""
         return self.packet.want_force
 
+    @property
+    def uses_packet_cache(self) -> bool:
+        """Whether this variant keeps its delta state in an int-keyed
+        packet_cache rather than a genhash table; true for packets keyed
+        by a single integer field. See packet_cache in packets.c."""
+        return (len(self.key_fields) == 1
+                and isinstance(self.key_fields[0].type_info, IntType))
+
     @property
     def is_info(self) -> str:
         """Whether this is an info or game-info packet"""
@@ -2720,6 +2736,9 @@ memset(stats_{self.name}_counters, 0,
 
     def get_hash(self) -> str:
         """Generate the key hash function for this variant"""
+        if self.uses_packet_cache:
+            # the int-keyed packet_cache needs no hash callback
+            return ""
         if not self.key_fields:
             return f"""\
 #define hash_{self.name} hash_const
@@ -2751,6 +2770,9 @@ static genhash_val_t hash_{self.name}(const void *vkey)
 
     def get_cmp(self) -> str:
         """Generate the key comparison function for this variant"""
+        if self.uses_packet_cache:
+            # the int-keyed packet_cache needs no comparison callback
+            return ""
         if not self.key_fields:
             return f"""\
 #define cmp_{self.name} cmp_const
@@ -2966,12 +2988,30 @@ if (different == 0) {{
         else:
             discard_part = ""
 
-        return f"""\
-#ifdef FREECIV_DELTA_PROTOCOL
-{self.name}_fields fields;
-struct {self.packet_name} *old;
-{declare_differ}\
-{declare_different}\
+        if self.uses_packet_cache:
+            key_name = self.key_fields[0].name
+            lookup_part = f"""\
+struct packet_cache **cache = pc->phs.sent_cache + {self.type};
+
+if (nullptr == *cache) {{
+  *cache = packet_cache_new(destroy_{self.packet_name});
+}}
+BV_CLR_ALL(fields);
+
+old = packet_cache_lookup(*cache, real_packet->{key_name});
+if (nullptr == old) {{
+  old = fc_malloc(sizeof(*old));
+  init_{self.packet_name}(old);
+  packet_cache_insert(*cache, real_packet->{key_name}, old);
+{force_info}\
+}}
+"""
+        else:
+            declare_cache = f"""\
+struct packet_cache **cache;
+""" if self.reset_packets else ""
+            lookup_part = f"""\
+{declare_cache}\
 struct genhash **hash = pc->phs.sent + {self.type};
 
 if (nullptr == *hash) {{
@@ -2988,6 +3028,15 @@ if (!genhash_lookup(*hash, real_packet, (void **) &old)) {{
   init_{self.packet_name}(old);
 {force_info}\
 }}
+"""
+
+        return f"""\
+#ifdef FREECIV_DELTA_PROTOCOL
+{self.name}_fields fields;
+struct {self.packet_name} *old;
+{declare_differ}\
+{declare_different}\
+{lookup_part}\
 
 {cmp_part}\
 {discard_part}\
@@ -3007,13 +3056,15 @@ if (!genhash_lookup(*hash, real_packet, (void **) &old)) {{
 
         copy_to_old = self.get_copy("old", "real_packet")
 
-        # Reset some packets' delta state
+        # Reset some packets' delta state. Reset targets are keyed by a
+        # single integer id matching this packet's leading field (see
+        # packets.def), so their state lives in an int-keyed packet_cache.
         reset_part = "".join(
             f"""\
 
-hash = pc->phs.sent + {reset_packet};
-if (nullptr != *hash) {{
-  genhash_remove(*hash, real_packet);
+cache = pc->phs.sent_cache + {reset_packet};
+if (nullptr != *cache) {{
+  packet_cache_remove(*cache, real_packet->{self.fields[0].name});
 }}
 """
             for reset_packet in self.reset_packets
@@ -3120,21 +3171,53 @@ if (e) {{
             for i, field in enumerate(self.other_fields)
         )
 
-        # Reset some packets' delta state
+        # Reset some packets' delta state. Reset targets are keyed by a
+        # single integer id matching this packet's leading field (see
+        # packets.def), so their state lives in an int-keyed packet_cache.
         reset_part = "".join(
             f"""\
 
-hash = pc->phs.received + {reset_packet};
-if (nullptr != *hash) {{
-  genhash_remove(*hash, real_packet);
+cache = pc->phs.received_cache + {reset_packet};
+if (nullptr != *cache) {{
+  packet_cache_remove(*cache, real_packet->{self.fields[0].name});
 }}
 """
             for reset_packet in self.reset_packets
         )
 
-        return f"""\
-{self.name}_fields fields;
-struct {self.packet_name} *old;
+        if self.uses_packet_cache:
+            key_name = self.key_fields[0].name
+            lookup_part = f"""\
+struct packet_cache **cache = pc->phs.received_cache + {self.type};
+
+if (nullptr == *cache) {{
+  *cache = packet_cache_new(destroy_{self.packet_name});
+}}
+
+old = packet_cache_lookup(*cache, real_packet->{key_name});
+if (nullptr != old) {{
+{copy_from_old}\
+}} else {{
+  /* packet is already initialized empty */
+{log_no_old}\
+}}
+"""
+            insert_part = f"""\
+if (nullptr == old) {{
+  old = fc_malloc(sizeof(*old));
+  init_{self.packet_name}(old);
+{copy_to_old}\
+  packet_cache_insert(*cache, real_packet->{key_name}, old);
+}} else {{
+{copy_to_old}\
+}}
+"""
+        else:
+            declare_cache = f"""\
+struct packet_cache **cache;
+""" if self.reset_packets else ""
+            lookup_part = f"""\
+{declare_cache}\
 struct genhash **hash = pc->phs.received + {self.type};
 
 if (nullptr == *hash) {{
@@ -3148,14 +3231,8 @@ if (genhash_lookup(*hash, real_packet, (void **) &old)) {{
   /* packet is already initialized empty */
 {log_no_old}\
 }}
-
-#ifdef FREECIV_JSON_CONNECTION
-field_addr.name = "fields";
-#endif /* FREECIV_JSON_CONNECTION */
-DIO_BV_GET(&din, &field_addr, fields);
-
-{body}\
-
+"""
+            insert_part = f"""\
 if (nullptr == old) {{
   old = fc_malloc(sizeof(*old));
   init_{self.packet_name}(old);
@@ -3164,6 +3241,21 @@ if (nullptr == old) {{
 }} else {{
 {copy_to_old}\
 }}
+"""
+
+        return f"""\
+{self.name}_fields fields;
+struct {self.packet_name} *old;
+{lookup_part}\
+
+#ifdef FREECIV_JSON_CONNECTION
+field_addr.name = "fields";
+#endif /* FREECIV_JSON_CONNECTION */
+DIO_BV_GET(&din, &field_addr, fields);
+
+{body}\
+
+{insert_part}\
 {reset_part}\
 """
 
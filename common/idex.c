@@ -15,14 +15,17 @@
    idex = ident index: a lookup table for quick mapping of unit and city
    id values to unit and city pointers.
 
-   Method: use separate hash tables for each type.
-   Means code duplication for city/unit cases, but simplicity advantages.
-   Don't have to manage memory at all: store pointers to unit and city
-   structs allocated elsewhere, and keys are pointers to id values inside
-   the structs.
-
-   Note id values should probably be unsigned int: here leave as plain int
-   so can use pointers to pcity->id etc.
+   Method: a power-of-two slot array per type, indexed by the low bits
+   of the id with linear probing. Ids are assigned sequentially, so the
+   common case is a direct hit and a lookup is two loads. The full id
+   stored in each slot doubles as the generation check when id low bits
+   are reused: a stale id never matches the live object now hashing to
+   the same slot. Unregistering leaves the id behind as a deleted
+   marker so later probe chains stay intact; the markers are dropped
+   when the table grows.
+
+   Note id values should probably be unsigned int: here leave as plain
+   int to match pcity->id etc.
 ***********************************************************************/
 
 #ifdef HAVE_CONFIG_H
@@ -31,48 +34,176 @@
 
 /* utility */
 #include "log.h"
+#include "mem.h"
 
 /* common */
 #include "city.h"
+#include "movement.h"
 #include "unit.h"
 #include "world_object.h"
 
 #include "idex.h"
 
+#define IDEX_INITIAL_SIZE 1024
+
+struct idex_table {
+  unsigned size;        /* Number of slots; always a power of two */
+  unsigned used;        /* Live entries plus deleted markers */
+  struct idex_slot *slots;
+};
+
+/**********************************************************************//**
+   Allocate an empty table with the given power-of-two size.
+**************************************************************************/
+static struct idex_table *idex_table_new(unsigned size)
+{
+  struct idex_table *table = fc_malloc(sizeof(*table));
+
+  table->size = size;
+  table->used = 0;
+  table->slots = fc_calloc(size, sizeof(*table->slots));
+
+  return table;
+}
+
+/**********************************************************************//**
+   Insert a pointer under an id that is known not to be in the table.
+   Reuses the first deleted marker of the probe chain when there is
+   one.
+**************************************************************************/
+static void idex_table_insert(struct idex_table *table, int id, void *ptr)
+{
+  unsigned mask = table->size - 1;
+  unsigned i = (unsigned) id & mask;
+  unsigned grave = table->size;
+
+  while (table->slots[i].id != 0) {
+    if (table->slots[i].ptr == NULL && grave == table->size) {
+      grave = i;
+    }
+    i = (i + 1) & mask;
+  }
+
+  if (grave != table->size) {
+    i = grave;
+  } else {
+    table->used++;
+  }
+  table->slots[i].id = id;
+  table->slots[i].ptr = ptr;
+}
+
+/**********************************************************************//**
+   Double the table when the probe chains would get long, re-inserting
+   only the live entries so deleted markers are dropped.
+**************************************************************************/
+static struct idex_table *idex_table_maybe_grow(struct idex_table *table)
+{
+  struct idex_table *fresh;
+  unsigned i;
+
+  if (2 * (table->used + 1) <= table->size) {
+    return table;
+  }
+
+  fresh = idex_table_new(2 * table->size);
+  for (i = 0; i < table->size; i++) {
+    if (table->slots[i].ptr != NULL) {
+      idex_table_insert(fresh, table->slots[i].id, table->slots[i].ptr);
+    }
+  }
+  free(table->slots);
+  free(table);
+
+  return fresh;
+}
+
+/**********************************************************************//**
+   Find the slot holding the given id, or NULL if the id was never
+   registered. The slot of an unregistered object has a NULL pointer.
+**************************************************************************/
+static struct idex_slot *idex_table_find(const struct idex_table *table,
+                                         int id)
+{
+  unsigned mask = table->size - 1;
+  unsigned i = (unsigned) id & mask;
+
+  while (table->slots[i].id != 0) {
+    if (table->slots[i].id == id) {
+      return &table->slots[i];
+    }
+    i = (i + 1) & mask;
+  }
+
+  return NULL;
+}
+
 /**********************************************************************//**
    Initialize. Should call this at the start before use.
 **************************************************************************/
 void idex_init(struct world *iworld)
 {
-  iworld->cities = city_hash_new();
-  iworld->units = unit_hash_new();
+  iworld->cities = idex_table_new(IDEX_INITIAL_SIZE);
+  iworld->units = idex_table_new(IDEX_INITIAL_SIZE);
 }
 
 /**********************************************************************//**
-   Free the hashes.
+   Free the tables.
 **************************************************************************/
 void idex_free(struct world *iworld)
 {
-  city_hash_destroy(iworld->cities);
+  free(iworld->cities->slots);
+  free(iworld->cities);
   iworld->cities = NULL;
 
-  unit_hash_destroy(iworld->units);
+  free(iworld->units->slots);
+  free(iworld->units);
   iworld->units = NULL;
 }
 
+/**********************************************************************//**
+   The raw city slot array, for loops that want to borrow direct
+   references for a phase. See the warning in idex.h.
+**************************************************************************/
+const struct idex_slot *idex_city_slots(const struct world *iworld,
+                                        unsigned *nslots)
+{
+  *nslots = iworld->cities->size;
+
+  return iworld->cities->slots;
+}
+
+/**********************************************************************//**
+   The raw unit slot array, for loops that want to borrow direct
+   references for a phase. See the warning in idex.h.
+**************************************************************************/
+const struct idex_slot *idex_unit_slots(const struct world *iworld,
+                                        unsigned *nslots)
+{
+  *nslots = iworld->units->size;
+
+  return iworld->units->slots;
+}
+
 /**********************************************************************//**
    Register a city into idex, with current pcity->id.
    Call this when pcity created.
 **************************************************************************/
 void idex_register_city(struct world *iworld, struct city *pcity)
 {
-  struct city *old;
+  struct idex_slot *slot = idex_table_find(iworld->cities, pcity->id);
+  struct city *old = (slot != NULL ? slot->ptr : NULL);
 
-  city_hash_replace_full(iworld->cities, pcity->id, pcity, NULL, &old);
   fc_assert_ret_msg(NULL == old,
                     "IDEX: city collision: new %d %p %s, old %d %p %s",
                     pcity->id, (void *) pcity, city_name_get(pcity),
                     old->id, (void *) old, city_name_get(old));
+
+  iworld->cities = idex_table_maybe_grow(iworld->cities);
+  idex_table_insert(iworld->cities, pcity->id, pcity);
+
+  /* Cities are an input of cached move legality verdicts. */
+  move_legality_cache_invalidate();
 }
 
 /**********************************************************************//**
@@ -81,13 +212,19 @@ void idex_register_city(struct world *iworld, struct city *pcity)
 **************************************************************************/
 void idex_register_unit(struct world *iworld, struct unit *punit)
 {
-  struct unit *old;
+  struct idex_slot *slot = idex_table_find(iworld->units, punit->id);
+  struct unit *old = (slot != NULL ? slot->ptr : NULL);
 
-  unit_hash_replace_full(iworld->units, punit->id, punit, NULL, &old);
   fc_assert_ret_msg(NULL == old,
                     "IDEX: unit collision: new %d %p %s, old %d %p %s",
                     punit->id, (void *) punit, unit_rule_name(punit),
                     old->id, (void *) old, unit_rule_name(old));
+
+  iworld->units = idex_table_maybe_grow(iworld->units);
+  idex_table_insert(iworld->units, punit->id, punit);
+
+  /* Units are an input of cached move legality verdicts. */
+  move_legality_cache_invalidate();
 }
 
 /**********************************************************************//**
@@ -96,9 +233,9 @@ void idex_register_unit(struct world *iworld, struct unit *punit)
 **************************************************************************/
 void idex_unregister_city(struct world *iworld, struct city *pcity)
 {
-  struct city *old;
+  struct idex_slot *slot = idex_table_find(iworld->cities, pcity->id);
+  struct city *old = (slot != NULL ? slot->ptr : NULL);
 
-  city_hash_remove_full(iworld->cities, pcity->id, NULL, &old);
   fc_assert_ret_msg(NULL != old,
                     "IDEX: city unreg missing: %d %p %s",
                     pcity->id, (void *) pcity, city_name_get(pcity));
@@ -106,6 +243,11 @@ void idex_unregister_city(struct world *iworld, struct city *pcity)
                     "unreg %d %p %s, old %d %p %s",
                     pcity->id, (void *) pcity, city_name_get(pcity),
                     old->id, (void *) old, city_name_get(old));
+
+  slot->ptr = NULL;
+
+  /* Cities are an input of cached move legality verdicts. */
+  move_legality_cache_invalidate();
 }
 
 /**********************************************************************//**
@@ -114,16 +256,21 @@ void idex_unregister_city(struct world *iworld, struct city *pcity)
 **************************************************************************/
 void idex_unregister_unit(struct world *iworld, struct unit *punit)
 {
-  struct unit *old;
+  struct idex_slot *slot = idex_table_find(iworld->units, punit->id);
+  struct unit *old = (slot != NULL ? slot->ptr : NULL);
 
-  unit_hash_remove_full(iworld->units, punit->id, NULL, &old);
   fc_assert_ret_msg(NULL != old,
                     "IDEX: unit unreg missing: %d %p %s",
                     punit->id, (void *) punit, unit_rule_name(punit));
   fc_assert_ret_msg(old == punit, "IDEX: unit unreg mismatch: "
                     "unreg %d %p %s, old %d %p %s",
                     punit->id, (void *) punit, unit_rule_name(punit),
-                    old->id, (void*) old, unit_rule_name(old));
+                    old->id, (void *) old, unit_rule_name(old));
+
+  slot->ptr = NULL;
+
+  /* Units are an input of cached move legality verdicts. */
+  move_legality_cache_invalidate();
 }
 
 /**********************************************************************//**
@@ -132,11 +279,9 @@ void idex_unregister_unit(struct world *iworld, struct unit *punit)
 **************************************************************************/
 struct city *idex_lookup_city(const struct world *iworld, int id)
 {
-  struct city *pcity;
-
-  city_hash_lookup(iworld->cities, id, &pcity);
+  struct idex_slot *slot = idex_table_find(iworld->cities, id);
 
-  return pcity;
+  return (slot != NULL ? slot->ptr : NULL);
 }
 
 /**********************************************************************//**
@@ -145,9 +290,7 @@ struct city *idex_lookup_city(const struct world *iworld, int id)
 **************************************************************************/
 struct unit *idex_lookup_unit(const struct world *iworld, int id)
 {
-  struct unit *punit;
-
-  unit_hash_lookup(iworld->units, id, &punit);
+  struct idex_slot *slot = idex_table_find(iworld->units, id);
 
-  return punit;
+  return (slot != NULL ? slot->ptr : NULL);
 }
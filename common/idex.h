@@ -27,9 +27,25 @@ extern "C" {
 
 struct world;
 
+/* One slot of an id-indexed table. A slot whose id is zero has never
+ * been used; a slot with an id but a NULL pointer belonged to an
+ * object that has been unregistered. Exposed read-only so hot loops
+ * can borrow direct references for the span of a phase - the slots
+ * may move whenever something is registered, so do not hold them
+ * across that. */
+struct idex_slot {
+  int id;
+  void *ptr;
+};
+
 void idex_init(struct world *iworld);
 void idex_free(struct world *iworld);
 
+const struct idex_slot *idex_city_slots(const struct world *iworld,
+                                        unsigned *nslots);
+const struct idex_slot *idex_unit_slots(const struct world *iworld,
+                                        unsigned *nslots);
+
 void idex_register_city(struct world *iworld, struct city *pcity);
 void idex_register_unit(struct world *iworld, struct unit *punit);
 
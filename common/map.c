@@ -27,10 +27,12 @@
 /* common */
 #include "ai.h"
 #include "city.h"
+#include "effects.h"
 #include "game.h"
 #include "movement.h"
 #include "nation.h"
 #include "packets.h"
+#include "player.h"
 #include "road.h"
 #include "unit.h"
 #include "unitlist.h"
@@ -161,6 +163,7 @@ void map_init(struct civ_map *imap, bool server_side)
   imap->num_continents = 0;
   imap->num_oceans = 0;
   imap->tiles = nullptr;
+  imap->adjc_tiles = nullptr;
   imap->startpos_table = nullptr;
   imap->iterate_outwards_indices = nullptr;
 
@@ -189,6 +192,7 @@ void map_init(struct civ_map *imap, bool server_side)
     imap->server.landpercent = MAP_DEFAULT_LANDMASS;
     imap->server.wetness = MAP_DEFAULT_WETNESS;
     imap->server.steepness = MAP_DEFAULT_STEEPNESS;
+    imap->server.flowrivers = MAP_DEFAULT_FLOWRIVERS;
     imap->server.generator = MAP_DEFAULT_GENERATOR;
     imap->server.startpos = MAP_DEFAULT_STARTPOS;
     imap->server.tinyisles = MAP_DEFAULT_TINYISLES;
@@ -390,6 +394,10 @@ struct tile *mapstep(const struct civ_map *nmap,
     return nullptr;
   }
 
+  if (nmap->adjc_tiles != nullptr) {
+    return nmap->adjc_tiles[tile_index(ptile) * 8 + dir];
+  }
+
   index_to_map_pos(&tile_x, &tile_y, tile_index(ptile));
   DIRSTEP(dx, dy, dir);
 
@@ -522,6 +530,28 @@ void map_allocate(struct civ_map *amap)
     tile_init(ptile);
   } whole_map_iterate_end;
 
+  /* Precompute the neighbor of every tile in every direction, so that
+   * adjacency iteration is plain array reads instead of per-neighbor
+   * coordinate wrapping. */
+  amap->adjc_tiles = fc_malloc(MAP_INDEX_SIZE * 8
+                               * sizeof(*amap->adjc_tiles));
+  whole_map_iterate(amap, ptile) {
+    int tile_x, tile_y, dir;
+
+    index_to_map_pos(&tile_x, &tile_y, tile_index(ptile));
+    for (dir = 0; dir < 8; dir++) {
+      struct tile *adjc = nullptr;
+
+      if (is_valid_dir((enum direction8) dir)) {
+        int dx, dy;
+
+        DIRSTEP(dx, dy, (enum direction8) dir);
+        adjc = map_pos_to_tile(amap, tile_x + dx, tile_y + dy);
+      }
+      amap->adjc_tiles[tile_index(ptile) * 8 + dir] = adjc;
+    }
+  } whole_map_iterate_end;
+
   if (amap->startpos_table != nullptr) {
     startpos_hash_destroy(amap->startpos_table);
   }
@@ -534,6 +564,12 @@ void map_allocate(struct civ_map *amap)
 void main_map_allocate(void)
 {
   map_allocate(&(wld.map));
+  if (is_server()) {
+    /* Only server-side sweeps read the structure-of-arrays mirror;
+     * don't duplicate the tile data on clients, where map memory is
+     * mostly dead weight for unknown tiles already. */
+    map_soa_allocate();
+  }
   generate_city_map_indices();
   generate_map_indices();
   CALL_FUNC_EACH_AI(map_alloc);
@@ -554,6 +590,8 @@ void map_free(struct civ_map *fmap, bool server_side)
     free(fmap->tiles);
     fmap->tiles = nullptr;
 
+    FC_FREE(fmap->adjc_tiles);
+
     if (fmap->startpos_table) {
       startpos_hash_destroy(fmap->startpos_table);
       fmap->startpos_table = nullptr;
@@ -599,9 +637,118 @@ void map_free(struct civ_map *fmap, bool server_side)
 void main_map_free(void)
 {
   map_free(&(wld.map), is_server());
+  map_soa_free();
   CALL_FUNC_EACH_AI(map_free);
 }
 
+/* Structure-of-arrays mirror of the hot struct tile fields of the main
+ * map. Map-wide sweeps that only need the terrain, owner, continent or
+ * extras of each tile can read these dense parallel arrays instead of
+ * striding through struct tile, which mixes them with cold pointers.
+ * The tile mutator functions (tile_set_terrain() etc.) keep the mirror
+ * in sync through map_soa_tile_update(). */
+static struct {
+  int size;               /* MAP_INDEX_SIZE the mirror was built for */
+  Terrain_type_id *terrain;     /* terrain_number(); -1 for unknown */
+  Continent_id *continent;
+  int *owner;                   /* player_number(); -1 for unowned */
+  bv_extras *extras;
+} tile_soa = { .size = 0 };
+
+/*******************************************************************//**
+  Copy the hot fields of ptile into the structure-of-arrays mirror.
+  Does nothing for virtual tiles and tiles of other maps than the main
+  one, and before the mirror has been allocated.
+***********************************************************************/
+void map_soa_tile_update(const struct tile *ptile)
+{
+  int tindex;
+
+  if (tile_soa.size == 0
+      || ptile < wld.map.tiles
+      || ptile >= wld.map.tiles + tile_soa.size) {
+    return;
+  }
+
+  tindex = tile_index(ptile);
+  tile_soa.terrain[tindex]
+    = (ptile->terrain != T_UNKNOWN ? terrain_number(ptile->terrain) : -1);
+  tile_soa.continent[tindex] = ptile->continent;
+  tile_soa.owner[tindex]
+    = (ptile->owner != nullptr ? player_number(ptile->owner) : -1);
+  tile_soa.extras[tindex] = ptile->extras;
+}
+
+/*******************************************************************//**
+  Free the structure-of-arrays mirror.
+***********************************************************************/
+void map_soa_free(void)
+{
+  if (tile_soa.size > 0) {
+    FC_FREE(tile_soa.terrain);
+    FC_FREE(tile_soa.continent);
+    FC_FREE(tile_soa.owner);
+    FC_FREE(tile_soa.extras);
+    tile_soa.size = 0;
+  }
+}
+
+/*******************************************************************//**
+  Allocate the structure-of-arrays mirror for the current main map and
+  fill it from the tiles.
+***********************************************************************/
+void map_soa_allocate(void)
+{
+  map_soa_free();
+
+  tile_soa.terrain = fc_malloc(MAP_INDEX_SIZE * sizeof(*tile_soa.terrain));
+  tile_soa.continent
+    = fc_malloc(MAP_INDEX_SIZE * sizeof(*tile_soa.continent));
+  tile_soa.owner = fc_malloc(MAP_INDEX_SIZE * sizeof(*tile_soa.owner));
+  tile_soa.extras = fc_malloc(MAP_INDEX_SIZE * sizeof(*tile_soa.extras));
+  tile_soa.size = MAP_INDEX_SIZE;
+
+  whole_map_iterate(&(wld.map), ptile) {
+    map_soa_tile_update(ptile);
+  } whole_map_iterate_end;
+}
+
+/*******************************************************************//**
+  Terrain numbers of the main map by tile index, or nullptr when the
+  mirror is not allocated.
+***********************************************************************/
+const Terrain_type_id *map_soa_terrain(void)
+{
+  return tile_soa.terrain;
+}
+
+/*******************************************************************//**
+  Continent ids of the main map by tile index, or nullptr when the
+  mirror is not allocated.
+***********************************************************************/
+const Continent_id *map_soa_continent(void)
+{
+  return tile_soa.continent;
+}
+
+/*******************************************************************//**
+  Owner player numbers of the main map by tile index, or nullptr when
+  the mirror is not allocated.
+***********************************************************************/
+const int *map_soa_owner(void)
+{
+  return tile_soa.owner;
+}
+
+/*******************************************************************//**
+  Extras bitvectors of the main map by tile index, or nullptr when the
+  mirror is not allocated.
+***********************************************************************/
+const bv_extras *map_soa_extras(void)
+{
+  return tile_soa.extras;
+}
+
 /*******************************************************************//**
   Return the "distance" (which is really the Manhattan distance, and should
   rarely be used) for a given vector.
@@ -900,6 +1047,40 @@ int get_lake_surrounder(Continent_id id)
   }
 }
 
+/*******************************************************************//**
+  Move cost cache. Pathfinding calls tile_move_cost_ptrs() for every
+  edge on every node expansion, and the road/integrator scan it runs is
+  the expensive part. Results for the terrain-speed path are memoized
+  per (tile pair, unit class, IGTER, infrastructure restriction) in a
+  small direct-mapped table; everything else the cost depends on is
+  tile content, so the entries are expired by a generation counter the
+  tile mutators advance.
+***********************************************************************/
+struct move_cost_cache_entry {
+  unsigned generation;          /* Zero in an unused entry */
+  int t1_index;
+  int t2_index;
+  unsigned short class_key;     /* Class number + flag bits */
+  short cost;
+};
+
+#define MOVE_COST_CACHE_SIZE 8192 /* Power of two */
+static struct move_cost_cache_entry move_cost_cache[MOVE_COST_CACHE_SIZE];
+static unsigned move_cost_generation = 1;
+
+/*******************************************************************//**
+  Invalidate all cached move costs. The terrain and extra tile mutators
+  must call this, as both feed the cached values.
+***********************************************************************/
+void move_cost_cache_invalidate(void)
+{
+  move_cost_generation++;
+  if (move_cost_generation == 0) {
+    /* Zero marks unused entries. */
+    move_cost_generation = 1;
+  }
+}
+
 /*******************************************************************//**
   The basic cost to move punit from tile t1 to tile t2.
   That is, tile_move_cost(), with pre-calculated tile pointers;
@@ -919,6 +1100,8 @@ int tile_move_cost_ptrs(const struct civ_map *nmap,
   int cost;
   signed char cardinal_move = -1;
   bool ri;
+  struct move_cost_cache_entry *pentry = NULL;
+  unsigned short class_key = 0;
 
   /* Try to exit early for detectable conditions */
   if (!uclass_has_flag(pclass, UCF_TERRAIN_SPEED)) {
@@ -956,9 +1139,29 @@ int tile_move_cost_ptrs(const struct civ_map *nmap,
     }
   }
 
-  cost = tile_terrain(t2)->movement_cost * SINGLE_MOVE;
   ri = restrict_infra(pplayer, t1, t2);
 
+  if (nmap == &(wld.map)) {
+    unsigned slot;
+
+    class_key = (uclass_number(pclass) << 2)
+      | (utype_has_flag(punittype, UTYF_IGTER) ? 2 : 0)
+      | (ri ? 1 : 0);
+    slot = (((unsigned) tile_index(t1)) * 2654435761u
+            + ((unsigned) tile_index(t2)) * 97u
+            + class_key)
+           & (MOVE_COST_CACHE_SIZE - 1);
+    pentry = &move_cost_cache[slot];
+    if (pentry->generation == move_cost_generation
+        && pentry->t1_index == tile_index(t1)
+        && pentry->t2_index == tile_index(t2)
+        && pentry->class_key == class_key) {
+      return pentry->cost;
+    }
+  }
+
+  cost = tile_terrain(t2)->movement_cost * SINGLE_MOVE;
+
   extra_type_list_iterate(pclass->cache.bonus_roads, pextra) {
     struct road_type *proad = extra_road_get(pextra);
 
@@ -1031,10 +1234,20 @@ int tile_move_cost_ptrs(const struct civ_map *nmap,
                        || is_move_cardinal(nmap, t1, t2)) ? 1 : 0;
     }
     if (cardinal_move == 0) {
-      return cost * 181 >> 7; /* == (int) (cost * 1.41421356f) if cost < 99 */
+      cost = cost * 181 >> 7; /* == (int) (cost * 1.41421356f) if cost < 99 */
     }
   }
 
+  if (pentry != NULL && !effect_cache_is_frozen()) {
+    /* The effect cache freeze marks the multi-threaded evaluation
+     * window; no caches may store entries then. */
+    pentry->generation = move_cost_generation;
+    pentry->t1_index = tile_index(t1);
+    pentry->t2_index = tile_index(t2);
+    pentry->class_key = class_key;
+    pentry->cost = cost;
+  }
+
   return cost;
 }
 
@@ -55,6 +55,17 @@ void main_map_allocate(void);
 void map_free(struct civ_map *fmap, bool server_side);
 void main_map_free(void);
 
+/* Structure-of-arrays mirror of the hot tile fields of the main map,
+ * for cache friendly map-wide sweeps. Kept in sync by the tile mutator
+ * functions; the accessors return nullptr before allocation. */
+void map_soa_allocate(void);
+void map_soa_free(void);
+void map_soa_tile_update(const struct tile *ptile);
+const Terrain_type_id *map_soa_terrain(void);
+const Continent_id *map_soa_continent(void);
+const int *map_soa_owner(void);
+const bv_extras *map_soa_extras(void);
+
 int map_vector_to_real_distance(int dx, int dy);
 int map_vector_to_sq_distance(int dx, int dy);
 int map_distance(const struct tile *tile0, const struct tile *tile1);
@@ -277,6 +288,7 @@ bool is_move_cardinal(const struct civ_map *nmap,
                       const struct tile *src_tile,
                       const struct tile *dst_tile);
 
+void move_cost_cache_invalidate(void);
 int tile_move_cost_ptrs(const struct civ_map *nmap,
                         const struct unit *punit,
                         const struct unit_type *punittype,
@@ -524,19 +536,15 @@ extern struct terrain_misc terrain_control;
                              dirlist, dircount)                             \
 {                                                                           \
   enum direction8 _dir;                                                     \
-  int _tile##_x, _tile##_y, _tile##_cx, _tile##_cy;                         \
   struct tile *_tile;                                                       \
-  const struct tile *_tile##_center = (center_tile);                        \
+  struct tile *const *_tile##_adjc                                          \
+    = (nmap)->adjc_tiles + tile_index(center_tile) * 8;                     \
   int _tile##_index = 0;                                                    \
-  index_to_map_pos(&_tile##_cx, &_tile##_cy, tile_index(_tile##_center));   \
   for (;                                                                    \
        _tile##_index < (dircount);                                          \
        _tile##_index++) {                                                   \
     _dir = (dirlist)[_tile##_index];                                        \
-    DIRSTEP(_tile##_x, _tile##_y, _dir);                                    \
-    _tile##_x += _tile##_cx;                                                \
-    _tile##_y += _tile##_cy;                                                \
-    _tile = map_pos_to_tile(nmap, _tile##_x, _tile##_y);                    \
+    _tile = _tile##_adjc[_dir];                                             \
     if (_tile == nullptr) {                                                 \
       continue;                                                             \
     }
@@ -549,19 +557,14 @@ extern struct terrain_misc terrain_control;
 #define adjc_dirlist_base_iterate(nmap, center_tile, _dir, dirlist, dircount)  \
 {                                                                              \
   enum direction8 _dir;                                                        \
-  int _tile##_x, _tile##_y, _center##_x, _center##_y;                          \
-  const struct tile *_tile##_center = (center_tile);                           \
-  bool _tile##_is_border = is_border_tile(_tile##_center, 1);                  \
-  int _tile##_index = 0;                                                       \
-  index_to_map_pos(&_center##_x, &_center##_y, tile_index(_tile##_center));    \
+  struct tile *const *_dir##_adjc                                              \
+    = (nmap)->adjc_tiles + tile_index(center_tile) * 8;                        \
+  int _dir##_index = 0;                                                        \
   for (;                                                                       \
-       _tile##_index < (dircount);                                             \
-       _tile##_index++) {                                                      \
-    _dir = (dirlist)[_tile##_index];                                           \
-    DIRSTEP(_tile##_x, _tile##_y, _dir);                                       \
-    _tile##_x += _center##_x;                                                  \
-    _tile##_y += _center##_y;                                                  \
-    if (_tile##_is_border && !normalize_map_pos(nmap, &_tile##_x, &_tile##_y)) { \
+       _dir##_index < (dircount);                                              \
+       _dir##_index++) {                                                       \
+    _dir = (dirlist)[_dir##_index];                                            \
+    if (_dir##_adjc[_dir] == nullptr) {                                        \
       continue;                                                                \
     }
 
@@ -704,6 +707,10 @@ moves. Includes MAP_MAX_LINEAR_SIZE because a map can be non wrapping. */
 #define MAP_MIN_WETNESS          0
 #define MAP_MAX_WETNESS          100
 
+#define MAP_DEFAULT_FLOWRIVERS   FALSE
+#define MAP_MIN_FLOWRIVERS       FALSE
+#define MAP_MAX_FLOWRIVERS       TRUE
+
 #define MAP_DEFAULT_GENERATOR    MAPGEN_RANDOM
 
 #define MAP_DEFAULT_STARTPOS     MAPSTARTPOS_DEFAULT
@@ -93,6 +93,10 @@ struct civ_map {
   int *ocean_sizes;
 
   struct tile *tiles;
+  /* Neighbor of each tile in each of the eight directions, or nullptr
+   * where the direction is invalid for the topology or leads off the
+   * map. Indexed by tile_index() * 8 + dir; filled by map_allocate(). */
+  struct tile **adjc_tiles;
   struct startpos_hash *startpos_table;
 
   union {
@@ -116,6 +120,7 @@ struct civ_map {
       int temperature;
       int wetness;
       int steepness;
+      bool flowrivers;
       bool ocean_resources;         /* Resources in the middle of the ocean */
       bool have_huts;
       bool have_resources;
@@ -30,6 +30,7 @@
 #include "bitvector.h"
 #include "fc_cmdline.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "string_vector.h"
@@ -339,6 +340,19 @@ struct mapdef {
 
   bv_mapdef_arg args;
   bool colortest;
+
+  /* Incremental rendering state. The last image rendered for this
+   * definition is kept between turns together with a bitvector of the
+   * tiles that changed since; if both are still usable, the next image
+   * only repaints the dirty tiles. The bitvector is fed by
+   * mapimg_tile_dirty(); if nothing ever feeds it (e.g. on the client),
+   * every image is a full render. */
+  struct {
+    struct img *pimg;          /* Last rendered image. */
+    bv_player plrbv;           /* Player selection it was rendered with. */
+    struct dbv dirty;          /* Tiles changed since it was rendered. */
+    bool tracking;             /* 'dirty' is allocated and being fed. */
+  } cache;
 };
 
 static struct mapdef *mapdef_new(bool colortest);
@@ -411,6 +425,27 @@ static bool img_save_magickwand(const struct img *pimg,
 static bool img_filename(const char *mapimgfile, enum imageformat format,
                          char *filename, size_t filename_len);
 static void img_createmap(struct img *pimg);
+static struct player *img_single_player(const struct img *pimg);
+static void img_createtile(struct img *pimg, struct tile *ptile,
+                           struct player *pplayer);
+static void img_refreshmap(struct img *pimg, const struct img *base,
+                           const struct dbv *dirty);
+static bool img_save_background(struct img *pimg, const char *mapimgfile,
+                                const char *path);
+
+/* == background image saving ==
+ * One image at a time is encoded and written on a worker thread; the
+ * main thread joins it via mapimg_save_wait() before touching anything
+ * the worker may still read. */
+struct img_save_job {
+  struct img *pimg;            /* Borrowed; stays owned by the cache. */
+  char mapimgfile[MAX_LEN_PATH];
+  char path[MAX_LEN_PATH];
+};
+
+static fc_thread mapimg_save_thread;
+static bool mapimg_save_thread_active = FALSE;
+static bool mapimg_save_thread_result = TRUE;
 
 /* == image toolkits == */
 typedef bool (*img_save_func)(const struct img *pimg,
@@ -552,6 +587,51 @@ void mapimg_reset(void)
   }
 }
 
+/************************************************************************//**
+  Mark a tile as changed since the last map image was rendered. Expected
+  to be called from the same places that flush tile changes to the
+  clients; once it is fed consistently, per-turn images only repaint the
+  marked tiles.
+****************************************************************************/
+void mapimg_tile_dirty(const struct tile *ptile)
+{
+  if (!mapimg_initialised() || ptile == nullptr || map_is_empty()) {
+    return;
+  }
+
+  mapdef_list_iterate(mapimg.mapdef, pmapdef) {
+    if (pmapdef->cache.tracking
+        && dbv_bits(&pmapdef->cache.dirty) != MAP_INDEX_SIZE) {
+      /* The map was resized; any cached image is rejected by the size
+       * check on the next render, so just restart the tracking. */
+      dbv_free(&pmapdef->cache.dirty);
+      pmapdef->cache.tracking = FALSE;
+    }
+    if (!pmapdef->cache.tracking) {
+      dbv_init(&pmapdef->cache.dirty, MAP_INDEX_SIZE);
+      pmapdef->cache.tracking = TRUE;
+    }
+    dbv_set(&pmapdef->cache.dirty, tile_index(ptile));
+  } mapdef_list_iterate_end;
+}
+
+/************************************************************************//**
+  Wait for a background image save to finish. Returns FALSE if that save
+  failed; the error message is available with mapimg_error().
+****************************************************************************/
+bool mapimg_save_wait(void)
+{
+  bool ret = TRUE;
+
+  if (mapimg_save_thread_active) {
+    fc_thread_wait(&mapimg_save_thread);
+    mapimg_save_thread_active = FALSE;
+    ret = mapimg_save_thread_result;
+  }
+
+  return ret;
+}
+
 /************************************************************************//**
   Free all memory allocated by the map image subsystem.
 ****************************************************************************/
@@ -1323,12 +1403,36 @@ bool mapimg_id2str(int id, char *str, size_t str_len)
   return mapimg_def2str(pmapdef, str, str_len);
 }
 
+/************************************************************************//**
+  Return TRUE if the cached frame of the definition can seed an
+  incremental render of the new image.
+****************************************************************************/
+static bool mapimg_cache_reusable(struct mapdef *pmapdef,
+                                  const struct img *pimg)
+{
+  const struct img *base = pmapdef->cache.pimg;
+
+  return base != nullptr
+         && pmapdef->cache.tracking
+         && dbv_bits(&pmapdef->cache.dirty) == MAP_INDEX_SIZE
+         && base->mapsize.x == pimg->mapsize.x
+         && base->mapsize.y == pimg->mapsize.y
+         && base->imgsize.x == pimg->imgsize.x
+         && base->imgsize.y == pimg->imgsize.y
+         && BV_ARE_EQUAL(pmapdef->cache.plrbv,
+                         pimg->def->player.checked_plrbv);
+}
+
 /************************************************************************//**
   Create the requested map image. The filename is created as
   [basename as used for savegames]-[mapstr].[mapext] where [mapstr]
   contains the map definition and [mapext] the selected image extension.
   If 'force' is FALSE, the image is only created if game.info.turn is a
   multiple of the map setting turns.
+
+  If 'force' is FALSE the image file is also written on a background
+  thread; a failure of such a save is reported by a later call or by
+  mapimg_save_wait().
 ****************************************************************************/
 bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
                    const char *path)
@@ -1363,6 +1467,12 @@ bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
     return TRUE;
   }
 
+  /* Join a still running background save; it may read the cached frame
+   * that is replaced below. A failure of that save is reported now. */
+  if (!mapimg_save_wait()) {
+    ret = FALSE;
+  }
+
 #ifdef FREECIV_DEBUG
   timer_cpu = timer_new(TIMER_CPU, TIMER_ACTIVE, "mapimg cpu");
   timer_start(timer_cpu);
@@ -1382,11 +1492,34 @@ bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
 
     pimg = img_new(pmapdef, CURRENT_TOPOLOGY, CURRENT_WRAP,
                    MAP_NATIVE_WIDTH, MAP_NATIVE_HEIGHT);
-    img_createmap(pimg);
-    if (!img_save(pimg, mapimgfile, path)) {
-      ret = FALSE;
+    if (mapimg_cache_reusable(pmapdef, pimg)) {
+      img_refreshmap(pimg, pmapdef->cache.pimg, &pmapdef->cache.dirty);
+    } else {
+      img_createmap(pimg);
+    }
+
+    /* Swap the cached frame; the background save was joined above, so
+     * nothing reads the old image any more. */
+    if (pmapdef->cache.pimg != nullptr) {
+      img_destroy(pmapdef->cache.pimg);
+    }
+    pmapdef->cache.pimg = pimg;
+    pmapdef->cache.plrbv = pmapdef->player.checked_plrbv;
+    if (pmapdef->cache.tracking) {
+      dbv_clr_all(&pmapdef->cache.dirty);
+    }
+
+    if (force) {
+      /* The caller wants to report errors right away. */
+      if (!img_save(pimg, mapimgfile, path)) {
+        ret = FALSE;
+      }
+    } else {
+      /* Per-turn export; encode and write on a worker thread. */
+      if (!img_save_background(pimg, mapimgfile, path)) {
+        ret = FALSE;
+      }
     }
-    img_destroy(pimg);
     break;
   case SHOW_EACH:    /* one map for each player */
   case SHOW_HUMAN:   /* one map for each human player */
@@ -1833,6 +1966,10 @@ static struct mapdef *mapdef_new(bool colortest)
   BV_CLR_ALL(pmapdef->args);
   pmapdef->colortest = colortest;
 
+  pmapdef->cache.pimg = nullptr;
+  BV_CLR_ALL(pmapdef->cache.plrbv);
+  pmapdef->cache.tracking = FALSE;
+
   return pmapdef;
 }
 
@@ -1845,6 +1982,16 @@ static void mapdef_destroy(struct mapdef *pmapdef)
     return;
   }
 
+  /* A background save may still read the cached image. */
+  mapimg_save_wait();
+
+  if (pmapdef->cache.pimg != nullptr) {
+    img_destroy(pmapdef->cache.pimg);
+  }
+  if (pmapdef->cache.tracking) {
+    dbv_free(&pmapdef->cache.dirty);
+  }
+
   free(pmapdef);
 }
 
@@ -2040,6 +2187,48 @@ static void img_plot_tile(struct img *pimg, const struct tile *ptile,
   img_plot(pimg, x, y, pcolor, pixel);
 }
 
+/************************************************************************//**
+  Worker thread main() for background image saving.
+****************************************************************************/
+static void img_save_thread_run(void *arg)
+{
+  struct img_save_job *job = arg;
+
+  mapimg_save_thread_result
+    = img_save(job->pimg, job->mapimgfile,
+               job->path[0] != '\0' ? job->path : nullptr);
+
+  free(job);
+}
+
+/************************************************************************//**
+  Encode and write the image on a worker thread. The image stays owned
+  by the caller and must stay valid until mapimg_save_wait().
+
+  Returns the result of the previous background save, which is joined
+  first; the result of this one is reported by the next wait.
+****************************************************************************/
+static bool img_save_background(struct img *pimg, const char *mapimgfile,
+                                const char *path)
+{
+  struct img_save_job *job = fc_malloc(sizeof(*job));
+  bool ret = mapimg_save_wait();
+
+  job->pimg = pimg;
+  sz_strlcpy(job->mapimgfile, mapimgfile);
+  if (path != nullptr) {
+    sz_strlcpy(job->path, path);
+  } else {
+    job->path[0] = '\0';
+  }
+
+  mapimg_save_thread_result = TRUE;
+  fc_thread_start(&mapimg_save_thread, img_save_thread_run, job);
+  mapimg_save_thread_active = TRUE;
+
+  return ret;
+}
+
 /************************************************************************//**
   Save an image as ppm file.
 ****************************************************************************/
@@ -2415,106 +2604,150 @@ static const char *img_playerstr(const struct player *pplayer)
   units, borders, known, fogofwar, ...).
 ****************************************************************************/
 static void img_createmap(struct img *pimg)
+{
+  struct player *pplayer = img_single_player(pimg);
+
+  whole_map_iterate(&(wld.map), ptile) {
+    img_createtile(pimg, ptile, pplayer);
+  } whole_map_iterate_end;
+}
+
+/************************************************************************//**
+  Return the displayed player if the map definition shows exactly one
+  player, else nullptr. Used for the 'known' and 'fogofwar' layers.
+****************************************************************************/
+static struct player *img_single_player(const struct img *pimg)
+{
+  if (bvplayers_count(pimg->def) == 1) {
+    players_iterate(aplayer) {
+      if (BV_ISSET(pimg->def->player.checked_plrbv,
+                   player_index(aplayer))) {
+        return aplayer;
+      }
+    } players_iterate_end;
+  }
+
+  return nullptr;
+}
+
+/************************************************************************//**
+  Plot all layers of one tile into the image. 'pplayer' is the single
+  displayed player as returned by img_single_player(), or nullptr.
+****************************************************************************/
+static void img_createtile(struct img *pimg, struct tile *ptile,
+                           struct player *pplayer)
 {
   const struct rgbcolor *pcolor;
   bv_pixel pixel;
   int player_id;
-  struct player *pplayer = nullptr;
   struct player *plr_tile = nullptr, *plr_city = nullptr, *plr_unit = nullptr;
   enum known_type tile_knowledge = TILE_UNKNOWN;
   struct terrain *pterrain = nullptr;
   bool plr_knowledge = pimg->def->layers[MAPIMG_LAYER_KNOWLEDGE];
 
-  whole_map_iterate(&(wld.map), ptile) {
-    if (bvplayers_count(pimg->def) == 1) {
-      /* Only one player; get player id for 'known' and 'fogofwar' */
-      players_iterate(aplayer) {
-        if (BV_ISSET(pimg->def->player.checked_plrbv,
-                     player_index(aplayer))) {
-          pplayer = aplayer;
-          tile_knowledge = mapimg.mapimg_tile_known(ptile, pplayer,
-                                                    plr_knowledge);
-          break;
-        }
-      } players_iterate_end;
-    }
+  if (pplayer != nullptr) {
+    tile_knowledge = mapimg.mapimg_tile_known(ptile, pplayer,
+                                              plr_knowledge);
+  }
 
-    /* Known tiles */
-    if (plr_knowledge && pplayer != nullptr && tile_knowledge == TILE_UNKNOWN) {
-      /* Plot nothing iff tile is not known */
-      continue;
+  /* Known tiles */
+  if (plr_knowledge && pplayer != nullptr && tile_knowledge == TILE_UNKNOWN) {
+    /* Plot nothing iff tile is not known */
+    return;
+  }
+
+  /* Terrain */
+  pterrain = mapimg.mapimg_tile_terrain(ptile, pplayer, plr_knowledge);
+  if (pimg->def->layers[MAPIMG_LAYER_TERRAIN]) {
+    /* Full terrain */
+    pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
+    pcolor = imgcolor_terrain(pterrain);
+    img_plot_tile(pimg, ptile, pcolor, pixel);
+  } else {
+    /* Basic terrain */
+    pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
+    if (is_ocean(pterrain)) {
+      img_plot_tile(pimg, ptile, imgcolor_special(IMGCOLOR_OCEAN), pixel);
+    } else {
+      img_plot_tile(pimg, ptile, imgcolor_special(IMGCOLOR_GROUND), pixel);
     }
+  }
 
-    /* Terrain */
-    pterrain = mapimg.mapimg_tile_terrain(ptile, pplayer, plr_knowledge);
-    if (pimg->def->layers[MAPIMG_LAYER_TERRAIN]) {
-      /* Full terrain */
+  /* (Land) area within borders and borders */
+  plr_tile = mapimg.mapimg_tile_owner(ptile, pplayer, plr_knowledge);
+  if (game.info.borders > 0 && plr_tile != nullptr) {
+    player_id = player_index(plr_tile);
+    if (pimg->def->layers[MAPIMG_LAYER_AREA] && !is_ocean(pterrain)
+        && BV_ISSET(pimg->def->player.checked_plrbv, player_id)) {
+      /* The tile is land and inside the players borders */
       pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
-      pcolor = imgcolor_terrain(pterrain);
+      pcolor = imgcolor_player(player_id);
+      img_plot_tile(pimg, ptile, pcolor, pixel);
+    } else if (pimg->def->layers[MAPIMG_LAYER_BORDERS]
+               && (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
+                   || (plr_knowledge && pplayer != nullptr))) {
+      /* Plot borders if player is selected or view range of the one
+       * displayed player */
+      pixel = pimg->pixel_border(ptile, pplayer, plr_knowledge);
+      pcolor = imgcolor_player(player_id);
       img_plot_tile(pimg, ptile, pcolor, pixel);
-    } else {
-      /* Basic terrain */
-      pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
-      if (is_ocean(pterrain)) {
-        img_plot_tile(pimg, ptile, imgcolor_special(IMGCOLOR_OCEAN), pixel);
-      } else {
-        img_plot_tile(pimg, ptile, imgcolor_special(IMGCOLOR_GROUND), pixel);
-      }
     }
+  }
 
-    /* (Land) area within borders and borders */
-    plr_tile = mapimg.mapimg_tile_owner(ptile, pplayer, plr_knowledge);
-    if (game.info.borders > 0 && plr_tile != nullptr) {
-      player_id = player_index(plr_tile);
-      if (pimg->def->layers[MAPIMG_LAYER_AREA] && !is_ocean(pterrain)
-          && BV_ISSET(pimg->def->player.checked_plrbv, player_id)) {
-        /* The tile is land and inside the players borders */
-        pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
-        img_plot_tile(pimg, ptile, pcolor, pixel);
-      } else if (pimg->def->layers[MAPIMG_LAYER_BORDERS]
-                 && (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
-                     || (plr_knowledge && pplayer != nullptr))) {
-        /* Plot borders if player is selected or view range of the one
-         * displayed player */
-        pixel = pimg->pixel_border(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
-        img_plot_tile(pimg, ptile, pcolor, pixel);
-      }
+  /* Cities and units */
+  plr_city = mapimg.mapimg_tile_city(ptile, pplayer, plr_knowledge);
+  plr_unit = mapimg.mapimg_tile_unit(ptile, pplayer, plr_knowledge);
+  if (pimg->def->layers[MAPIMG_LAYER_CITIES] && plr_city) {
+    player_id = player_index(plr_city);
+    if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
+        || (plr_knowledge && pplayer != nullptr)) {
+      /* Plot cities if player is selected or view range of the one
+       * displayed player */
+      pixel = pimg->pixel_city(ptile, pplayer, plr_knowledge);
+      pcolor = imgcolor_player(player_id);
+      img_plot_tile(pimg, ptile, pcolor, pixel);
     }
-
-    /* Cities and units */
-    plr_city = mapimg.mapimg_tile_city(ptile, pplayer, plr_knowledge);
-    plr_unit = mapimg.mapimg_tile_unit(ptile, pplayer, plr_knowledge);
-    if (pimg->def->layers[MAPIMG_LAYER_CITIES] && plr_city) {
-      player_id = player_index(plr_city);
-      if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
-          || (plr_knowledge && pplayer != nullptr)) {
-        /* Plot cities if player is selected or view range of the one
-         * displayed player */
-        pixel = pimg->pixel_city(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
-        img_plot_tile(pimg, ptile, pcolor, pixel);
-      }
-    } else if (pimg->def->layers[MAPIMG_LAYER_UNITS] && plr_unit) {
-      player_id = player_index(plr_unit);
-      if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
-          || (plr_knowledge && pplayer != nullptr)) {
-        /* Plot units if player is selected or view range of the one
-         * displayed player */
-        pixel = pimg->pixel_unit(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
-        img_plot_tile(pimg, ptile, pcolor, pixel);
-      }
+  } else if (pimg->def->layers[MAPIMG_LAYER_UNITS] && plr_unit) {
+    player_id = player_index(plr_unit);
+    if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
+        || (plr_knowledge && pplayer != nullptr)) {
+      /* Plot units if player is selected or view range of the one
+       * displayed player */
+      pixel = pimg->pixel_unit(ptile, pplayer, plr_knowledge);
+      pcolor = imgcolor_player(player_id);
+      img_plot_tile(pimg, ptile, pcolor, pixel);
     }
+  }
 
-    /* Fogofwar; if only 1 player is plotted */
-    if (game.info.fogofwar && pimg->def->layers[MAPIMG_LAYER_FOGOFWAR]
-        && pplayer != nullptr
-        && tile_knowledge == TILE_KNOWN_UNSEEN) {
-      pixel = pimg->pixel_fogofwar(ptile, pplayer, plr_knowledge);
-      pcolor = nullptr;
-      img_plot_tile(pimg, ptile, pcolor, pixel);
+  /* Fogofwar; if only 1 player is plotted */
+  if (game.info.fogofwar && pimg->def->layers[MAPIMG_LAYER_FOGOFWAR]
+      && pplayer != nullptr
+      && tile_knowledge == TILE_KNOWN_UNSEEN) {
+    pixel = pimg->pixel_fogofwar(ptile, pplayer, plr_knowledge);
+    pcolor = nullptr;
+    img_plot_tile(pimg, ptile, pcolor, pixel);
+  }
+}
+
+/************************************************************************//**
+  Create the map image incrementally: copy the pixels of the previous
+  frame and replot only the tiles marked dirty since it was rendered.
+****************************************************************************/
+static void img_refreshmap(struct img *pimg, const struct img *base,
+                           const struct dbv *dirty)
+{
+  struct player *pplayer = img_single_player(pimg);
+
+  memcpy(pimg->map, base->map,
+         pimg->imgsize.x * pimg->imgsize.y * sizeof(*pimg->map));
+
+  whole_map_iterate(&(wld.map), ptile) {
+    if (dbv_isset(dirty, tile_index(ptile))) {
+      /* Erase the tile back to the background first; a tile that became
+       * unknown plots nothing. */
+      img_plot_tile(pimg, ptile, nullptr,
+                    pimg->pixel_tile(ptile, nullptr, FALSE));
+      img_createtile(pimg, ptile, pplayer);
     }
   } whole_map_iterate_end;
 }
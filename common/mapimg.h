@@ -32,6 +32,8 @@
                         to save the definitions.
     mapimg_create()     ...
     mapimg_colortest()  ...
+    mapimg_tile_dirty() Mark a tile changed for incremental rendering.
+    mapimg_save_wait()  Wait for a background image save to finish.
 
     These functions return TRUE on success and FALSE on error. In the later
     case the error message is available with mapimg_error().
@@ -128,6 +130,9 @@ bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
                    const char *path);
 bool mapimg_colortest(const char *savename, const char *path);
 
+void mapimg_tile_dirty(const struct tile *ptile);
+bool mapimg_save_wait(void);
+
 struct mapdef *mapimg_isvalid(int id);
 
 const struct strvec *mapimg_get_format_list(void);
@@ -15,6 +15,9 @@
 #include <fc_config.h>
 #endif
 
+/* utility */
+#include "mem.h"
+
 /* common */
 #include "diptreaty.h"
 #include "game.h"
@@ -147,6 +150,99 @@ static bool can_plr_see_all_sym_diplrels_of(const struct player *pplayer,
   return FALSE;
 }
 
+/* Cached diplomatic knowability per (point of view, target) player pair.
+ * The underlying relations - embassies, contact and aliveness - only
+ * change on identifiable events, so each entry is computed once per epoch
+ * and the epoch is bumped by metaknowledge_intel_invalidate() when such
+ * an event happens. Server side only; the client learns of these changes
+ * from packets that bypass the invalidation points. */
+struct mke_intel {
+  unsigned epoch;
+  bool sym_diplrels; /* can_plr_see_all_sym_diplrels_of() */
+  bool techs;        /* can_see_techs_of_target() */
+  bool intel;        /* could_intel_with_player() */
+};
+
+static struct mke_intel *mke_intel_cache = nullptr;
+static unsigned mke_intel_epoch = 1;
+
+/**********************************************************************//**
+  Invalidate all cached diplomatic knowability. Call when an embassy is
+  gained or lost, contact is made or expires, or a player dies or is
+  created.
+**************************************************************************/
+void metaknowledge_intel_invalidate(void)
+{
+  mke_intel_epoch++;
+}
+
+/**********************************************************************//**
+  Get the cached diplomatic knowability entry for a player pair,
+  computing it if it is from an older epoch.
+**************************************************************************/
+static const struct mke_intel *
+mke_intel_get(const struct player *pov_player, const struct player *tplayer)
+{
+  struct mke_intel *ent;
+
+  if (mke_intel_cache == nullptr) {
+    mke_intel_cache = fc_calloc(MAX_NUM_PLAYER_SLOTS
+                                * MAX_NUM_PLAYER_SLOTS,
+                                sizeof(*mke_intel_cache));
+  }
+
+  ent = &mke_intel_cache[player_index(pov_player) * MAX_NUM_PLAYER_SLOTS
+                         + player_index(tplayer)];
+  if (ent->epoch != mke_intel_epoch) {
+    ent->epoch = mke_intel_epoch;
+    ent->sym_diplrels = can_plr_see_all_sym_diplrels_of(pov_player,
+                                                        tplayer);
+    ent->techs = can_see_techs_of_target(pov_player, tplayer);
+    ent->intel = could_intel_with_player(pov_player, tplayer);
+  }
+
+  return ent;
+}
+
+/**********************************************************************//**
+  Cached can_plr_see_all_sym_diplrels_of().
+**************************************************************************/
+static bool mke_sees_sym_diplrels(const struct player *pov_player,
+                                  const struct player *tplayer)
+{
+  if (!is_server()) {
+    return can_plr_see_all_sym_diplrels_of(pov_player, tplayer);
+  }
+
+  return mke_intel_get(pov_player, tplayer)->sym_diplrels;
+}
+
+/**********************************************************************//**
+  Cached can_see_techs_of_target().
+**************************************************************************/
+static bool mke_sees_techs(const struct player *pov_player,
+                           const struct player *tplayer)
+{
+  if (!is_server()) {
+    return can_see_techs_of_target(pov_player, tplayer);
+  }
+
+  return mke_intel_get(pov_player, tplayer)->techs;
+}
+
+/**********************************************************************//**
+  Cached could_intel_with_player().
+**************************************************************************/
+static bool mke_could_intel(const struct player *pov_player,
+                            const struct player *tplayer)
+{
+  if (!is_server()) {
+    return could_intel_with_player(pov_player, tplayer);
+  }
+
+  return mke_intel_get(pov_player, tplayer)->intel;
+}
+
 /**********************************************************************//**
   Is an evaluation of the requirement accurate when pov_player evaluates
   it?
@@ -298,9 +394,8 @@ static bool is_req_knowable(const struct player *pov_player,
         return TRUE;
       }
 
-      if (can_plr_see_all_sym_diplrels_of(pov_player, context->player)
-          || can_plr_see_all_sym_diplrels_of(pov_player,
-                                             other_context->player)) {
+      if (mke_sees_sym_diplrels(pov_player, context->player)
+          || mke_sees_sym_diplrels(pov_player, other_context->player)) {
         return TRUE;
       }
 
@@ -317,7 +412,7 @@ static bool is_req_knowable(const struct player *pov_player,
         return TRUE;
       }
 
-      if (can_plr_see_all_sym_diplrels_of(pov_player, context->player)) {
+      if (mke_sees_sym_diplrels(pov_player, context->player)) {
         return TRUE;
       }
 
@@ -572,7 +667,7 @@ static bool is_req_knowable(const struct player *pov_player,
         return prob_type == RPT_CERTAIN;
       }
 
-      return can_see_techs_of_target(pov_player, context->player);
+      return mke_sees_techs(pov_player, context->player);
     } else if (req->range == REQ_RANGE_WORLD && req->survives) {
       /* game.info.global_advances is sent to each player */
       return TRUE;
@@ -588,7 +683,7 @@ static bool is_req_knowable(const struct player *pov_player,
       }
 
       return (pov_player == context->player
-              || could_intel_with_player(pov_player, context->player));
+              || mke_could_intel(pov_player, context->player));
     }
   }
 
@@ -39,6 +39,8 @@ mke_eval_reqs(const struct player *pov_player,
 bool can_see_techs_of_target(const struct player *pov_player,
                              const struct player *target_player);
 
+void metaknowledge_intel_invalidate(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -26,6 +26,7 @@
 #include "astring.h"
 #include "base.h"
 #include "effects.h"
+#include "fc_interface.h"
 #include "fc_types.h"
 #include "game.h"
 #include "map.h"
@@ -82,16 +83,66 @@ int utype_move_rate(const struct unit_type *utype, const struct tile *ptile,
   return move_rate;
 }
 
+/* Memoized unit_move_rate() results. Pathfinding asks for the rate of
+ * the same unit on every node expansion, and each computation costs an
+ * effect evaluation (EFT_MOVE_BONUS). Entries are stamped with the
+ * effect cache epoch and validated against every other input, so stale
+ * values are never read. Server side only - the client does not see
+ * every change that would advance the epoch. */
+struct move_rate_cache_entry {
+  unsigned epoch;
+  int unit_id;
+  int utype;                    /* Transforms and upgrades keep the id */
+  int owner;
+  int tile_index;
+  int veteran;
+  int hp;                       /* Never zero in a used entry */
+  int move_rate;
+};
+
+#define MOVE_RATE_CACHE_SIZE 1024 /* Power of two */
+static struct move_rate_cache_entry move_rate_cache[MOVE_RATE_CACHE_SIZE];
+
 /************************************************************************//**
   This function calculates the move rate of the unit. See utype_move_rate()
   for further details.
 ****************************************************************************/
 int unit_move_rate(const struct unit *punit)
 {
+  struct move_rate_cache_entry *pentry = NULL;
+  int move_rate;
+
   fc_assert_ret_val(NULL != punit, 0);
 
-  return utype_move_rate(unit_type_get(punit), unit_tile(punit),
-                         unit_owner(punit), punit->veteran, punit->hp);
+  if (is_server() && punit->id != IDENTITY_NUMBER_ZERO
+      && unit_tile(punit) != NULL) {
+    pentry = &move_rate_cache[punit->id & (MOVE_RATE_CACHE_SIZE - 1)];
+    if (pentry->epoch == effect_cache_epoch()
+        && pentry->unit_id == punit->id
+        && pentry->utype == utype_number(unit_type_get(punit))
+        && pentry->owner == player_number(unit_owner(punit))
+        && pentry->tile_index == tile_index(unit_tile(punit))
+        && pentry->veteran == punit->veteran
+        && pentry->hp == punit->hp) {
+      return pentry->move_rate;
+    }
+  }
+
+  move_rate = utype_move_rate(unit_type_get(punit), unit_tile(punit),
+                              unit_owner(punit), punit->veteran, punit->hp);
+
+  if (pentry != NULL && !effect_cache_is_frozen()) {
+    pentry->epoch = effect_cache_epoch();
+    pentry->unit_id = punit->id;
+    pentry->utype = utype_number(unit_type_get(punit));
+    pentry->owner = player_number(unit_owner(punit));
+    pentry->tile_index = tile_index(unit_tile(punit));
+    pentry->veteran = punit->veteran;
+    pentry->hp = punit->hp;
+    pentry->move_rate = move_rate;
+  }
+
+  return move_rate;
 }
 
 /************************************************************************//**
@@ -632,6 +683,51 @@ bool unit_can_teleport_to_tile(const struct civ_map *nmap,
                                               enter_enemy_city));
 }
 
+/* Memoized unit_move_to_tile_test() results. Clients probe the
+ * legality of the same (unit, destination) pair once per displayed
+ * action before the actual move order arrives, and the action enabler
+ * checks re-ask during a single request. Entries validate themselves
+ * against the full query key; the generation is advanced whenever
+ * something the test reads - unit positions, cities, terrain, borders
+ * or diplomacy - changes, so stale verdicts are never returned.
+ * Generation 0 marks an unused entry. */
+struct move_legality_cache_entry {
+  unsigned generation;
+  int unit_id;
+  int src_tile;
+  int dst_tile;
+  short activity;
+  unsigned char flags;
+  signed char result;
+};
+
+#define MOVE_LEGALITY_CACHE_SIZE 4096 /* Power of two */
+static struct move_legality_cache_entry
+  move_legality_cache[MOVE_LEGALITY_CACHE_SIZE];
+static unsigned move_legality_generation = 1;
+
+static enum unit_move_result
+unit_move_to_tile_test_real(const struct civ_map *nmap,
+                            const struct unit *punit,
+                            enum unit_activity activity,
+                            const struct tile *src_tile,
+                            const struct tile *dst_tile, bool igzoc,
+                            bool enter_transport, struct unit *embark_to,
+                            bool enter_enemy_city);
+
+/************************************************************************//**
+  Drop all memoized move legality results. Called whenever units,
+  cities, tile contents, borders, or diplomatic states change.
+****************************************************************************/
+void move_legality_cache_invalidate(void)
+{
+  move_legality_generation++;
+  if (move_legality_generation == 0) {
+    /* Skip the "unused entry" marker on wrap-around. */
+    move_legality_generation = 1;
+  }
+}
+
 /************************************************************************//**
   Returns whether the unit can move from its current tile to the
   destination tile. An enumerated value is returned indication the error
@@ -665,6 +761,72 @@ unit_move_to_tile_test(const struct civ_map *nmap,
                        const struct tile *dst_tile, bool igzoc,
                        bool enter_transport, struct unit *embark_to,
                        bool enter_enemy_city)
+{
+  struct move_legality_cache_entry *pentry = NULL;
+  unsigned char flags = 0;
+  enum unit_move_result result;
+
+  /* Virtual units and queries against other maps or explicit transports
+   * bypass the cache; so do "random movement only" units, whose verdict
+   * depends on whose random moves are being executed right now. */
+  if (is_server() && nmap == &(wld.map)
+      && punit->id != IDENTITY_NUMBER_ZERO
+      && embark_to == NULL
+      && !utype_has_flag(unit_type_get(punit), UTYF_RANDOM_MOVEMENT)) {
+    unsigned slot;
+
+    flags = (igzoc ? 0x01 : 0)
+      | (enter_transport ? 0x02 : 0)
+      | (enter_enemy_city ? 0x04 : 0)
+      | (unit_transported(punit) ? 0x08 : 0)
+      | (punit->stay ? 0x10 : 0);
+    slot = (((unsigned) punit->id) * 2654435761u
+            + ((unsigned) tile_index(dst_tile)) * 97u
+            + ((unsigned) activity) * 13u + flags)
+      & (MOVE_LEGALITY_CACHE_SIZE - 1);
+
+    pentry = &move_legality_cache[slot];
+    if (pentry->generation == move_legality_generation
+        && pentry->unit_id == punit->id
+        && pentry->src_tile == tile_index(src_tile)
+        && pentry->dst_tile == tile_index(dst_tile)
+        && pentry->activity == (short) activity
+        && pentry->flags == flags) {
+      return (enum unit_move_result) pentry->result;
+    }
+  }
+
+  result = unit_move_to_tile_test_real(nmap, punit, activity, src_tile,
+                                       dst_tile, igzoc, enter_transport,
+                                       embark_to, enter_enemy_city);
+
+  /* The store is suppressed while the effect caches are frozen for the
+   * multi-threaded city evaluation window. */
+  if (pentry != NULL && !effect_cache_is_frozen()) {
+    pentry->generation = move_legality_generation;
+    pentry->unit_id = punit->id;
+    pentry->src_tile = tile_index(src_tile);
+    pentry->dst_tile = tile_index(dst_tile);
+    pentry->activity = (short) activity;
+    pentry->flags = flags;
+    pentry->result = (signed char) result;
+  }
+
+  return result;
+}
+
+/************************************************************************//**
+  Uncached backend of unit_move_to_tile_test(); see there for the rules
+  it enforces.
+****************************************************************************/
+static enum unit_move_result
+unit_move_to_tile_test_real(const struct civ_map *nmap,
+                            const struct unit *punit,
+                            enum unit_activity activity,
+                            const struct tile *src_tile,
+                            const struct tile *dst_tile, bool igzoc,
+                            bool enter_transport, struct unit *embark_to,
+                            bool enter_enemy_city)
 {
   bool zoc;
   struct city *pcity;
@@ -127,6 +127,7 @@ bool unit_can_teleport_to_tile(const struct civ_map *nmap,
                                const struct tile *ptile,
                                bool enter_transport,
                                bool enter_enemy_city);
+void move_legality_cache_invalidate(void);
 enum unit_move_result
 unit_move_to_tile_test(const struct civ_map *nmap,
                        const struct unit *punit,
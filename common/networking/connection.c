@@ -18,6 +18,7 @@
 #include "fc_prehdrs.h"
 
 #include <errno.h>
+#include <stdlib.h>             /* getenv() */
 #include <string.h>
 #include <time.h>
 
@@ -46,6 +47,10 @@
 
 #include "connection.h"
 
+#if defined(USE_COMPRESSION) && defined(FREECIV_HAVE_LIBZSTD)
+#include <zstd.h>
+#endif
+
 
 static void default_conn_close_callback(struct connection *pconn);
 
@@ -82,6 +87,23 @@ void connections_set_close_callback(conn_close_fn_t func)
   conn_close_callback = func;
 }
 
+/*
+ * When set, the whole content of a connection's send buffer is handed
+ * to this callback instead of being written to the socket on the
+ * calling thread. The server uses it to drain send buffers from a
+ * separate writer thread; see server/sernet.c. The client leaves it
+ * unset and keeps writing directly.
+ */
+static conn_write_fn_t conn_write_callback = nullptr;
+
+/**********************************************************************//**
+  Register the write_callback.
+**************************************************************************/
+void connections_set_write_callback(conn_write_fn_t func)
+{
+  conn_write_callback = func;
+}
+
 /**********************************************************************//**
   Call the conn_close_callback.
 **************************************************************************/
@@ -170,6 +192,13 @@ static int write_socket_data(struct connection *pc,
     return 0;
   }
 
+  if (conn_write_callback != nullptr
+      && conn_write_callback(pc, buf)) {
+    /* The whole backlog was handed off; nothing left to write here. */
+    buf->ndata = 0;
+    return 0;
+  }
+
   for (start = 0; buf->ndata-start > limit;) {
     fd_set writefs, exceptfs;
     fc_timeval tv;
@@ -197,7 +226,10 @@ static int write_socket_data(struct connection *pc,
     }
 
     if (FD_ISSET(pc->sock, &writefs)) {
-      nblock = MIN(buf->ndata-start, MAX_LEN_PACKET);
+      /* Hand the whole backlog to the kernel at once; at turn change
+       * the buffered data is far larger than one packet and chunking
+       * it only multiplies the syscalls. */
+      nblock = buf->ndata - start;
       log_debug("trying to write %d limit=%d", nblock, limit);
       if ((nput = fc_writesocket(pc->sock,
                                  (const char *)buf->data+start, nblock)) == -1) {
@@ -239,14 +271,21 @@ void flush_connection_send_buffer_all(struct connection *pc)
   }
 }
 
+/* While sends are buffered (connection_do_buffer()), let this much data
+ * coalesce in the send buffer before pushing it to the socket. Turn
+ * change floods then leave as a few large writes instead of one write
+ * per MAX_LEN_PACKET. Kept well below MAX_LEN_BUFFER so a slow socket
+ * still has buffer room left. */
+#define BUFFERED_FLUSH_SIZE (MAX_LEN_PACKET * 16)
+
 /**********************************************************************//**
   Flush'em
 **************************************************************************/
 #ifndef FREECIV_JSON_CONNECTION
 static void flush_connection_send_buffer_packets(struct connection *pc)
 {
-  if (pc && pc->used && pc->send_buffer->ndata >= MAX_LEN_PACKET) {
-    write_socket_data(pc, pc->send_buffer, MAX_LEN_PACKET-1);
+  if (pc && pc->used && pc->send_buffer->ndata >= BUFFERED_FLUSH_SIZE) {
+    write_socket_data(pc, pc->send_buffer, BUFFERED_FLUSH_SIZE - 1);
     if (pc->notify_of_writable_data) {
       pc->notify_of_writable_data(pc, pc->send_buffer
                                   && pc->send_buffer->ndata > 0);
@@ -319,6 +358,68 @@ bool connection_send_data(struct connection *pconn,
   return TRUE;
 }
 
+/**********************************************************************//**
+  Reserve space for writing 'len' bytes directly into the connection's
+  send buffer, to be accounted by connection_send_commit(). Returns
+  nullptr when there is no usable buffer (closed or closing connection,
+  or the buffer can't grow); the caller must then stage the data itself.
+  Abandoning a reservation without committing is harmless.
+**************************************************************************/
+unsigned char *connection_send_reserve(struct connection *pconn, int len)
+{
+  struct socket_packet_buffer *buf;
+
+  if (pconn == nullptr
+      || !pconn->used
+      || (is_server() && pconn->server.is_closing)) {
+    return nullptr;
+  }
+
+#ifndef FREECIV_JSON_CONNECTION
+  if (0 < pconn->send_buffer->do_buffer_sends) {
+    flush_connection_send_buffer_packets(pconn);
+  } else
+#endif /* FREECIV_JSON_CONNECTION */
+  {
+    flush_connection_send_buffer_all(pconn);
+  }
+
+  buf = pconn->send_buffer;
+  if (!buffer_ensure_free_extra_space(buf, len)) {
+    connection_close(pconn, _("buffer overflow"));
+    return nullptr;
+  }
+
+  return buf->data + buf->ndata;
+}
+
+/**********************************************************************//**
+  Send 'len' bytes written after connection_send_reserve(), like
+  connection_send_data() would have. Return TRUE on success.
+**************************************************************************/
+bool connection_send_commit(struct connection *pconn, int len)
+{
+  if (pconn == nullptr
+      || !pconn->used
+      || (is_server() && pconn->server.is_closing)) {
+    return TRUE;
+  }
+
+  pconn->statistics.bytes_send += len;
+  pconn->send_buffer->ndata += len;
+
+#ifndef FREECIV_JSON_CONNECTION
+  if (0 < pconn->send_buffer->do_buffer_sends) {
+    flush_connection_send_buffer_packets(pconn);
+  } else
+#endif /* FREECIV_JSON_CONNECTION */
+  {
+    flush_connection_send_buffer_all(pconn);
+  }
+
+  return TRUE;
+}
+
 /**********************************************************************//**
   Turn on buffering, using a counter so that calls may be nested.
 **************************************************************************/
@@ -543,6 +644,90 @@ int get_next_request_id(int old_request_id)
   return result;
 }
 
+/* Raw packet capture for benchmarking. Pointing the
+ * FREECIV_PACKET_CAPTURE environment variable at a file name prefix
+ * makes every connection log its timestamped packet traffic to
+ * "<prefix>-<n>.fcap", readable by freeciv-netbench. */
+static const char *capture_prefix = nullptr;
+static bool capture_checked = FALSE;
+static struct timer *capture_timer = nullptr;
+static int capture_count = 0;
+
+/**********************************************************************//**
+  Return the capture file of the given connection, opening it on first
+  use. Returns nullptr when capturing is disabled.
+**************************************************************************/
+static FILE *conn_capture_fp(struct connection *pconn)
+{
+  if (!capture_checked) {
+    capture_checked = TRUE;
+    capture_prefix = getenv("FREECIV_PACKET_CAPTURE");
+    if (capture_prefix != nullptr) {
+      capture_timer = timer_new(TIMER_USER, TIMER_ACTIVE, "capture");
+      timer_start(capture_timer);
+    }
+  }
+
+  if (capture_prefix != nullptr && pconn->capture_fp == nullptr) {
+    char fname[512];
+
+    fc_snprintf(fname, sizeof(fname), "%s-%d.fcap",
+                capture_prefix, capture_count++);
+    pconn->capture_fp = fopen(fname, "wb");
+    if (pconn->capture_fp == nullptr) {
+      log_error("Could not open capture file \"%s\".", fname);
+      /* Don't retry for every single packet. */
+      capture_prefix = nullptr;
+    } else {
+      fwrite(FCAP_MAGIC, 1, strlen(FCAP_MAGIC), pconn->capture_fp);
+    }
+  }
+
+  return pconn->capture_fp;
+}
+
+/**********************************************************************//**
+  Log one raw packet, with timestamp and direction, to the capture file
+  of the given connection. Does nothing when capturing is disabled.
+**************************************************************************/
+void conn_capture_packet(struct connection *pconn, bool outgoing,
+                         int packet_type, const unsigned char *data,
+                         int len)
+{
+  FILE *fp = conn_capture_fp(pconn);
+
+  if (fp != nullptr) {
+    double now = timer_read_seconds(capture_timer);
+    unsigned char kind = outgoing ? 'S' : 'R';
+    int sizes[3] = { packet_type, len, 0 };
+
+    fwrite(&now, sizeof(now), 1, fp);
+    fwrite(&kind, 1, 1, fp);
+    fwrite(sizes, sizeof(sizes), 1, fp);
+    fwrite(data, 1, len, fp);
+  }
+}
+
+/**********************************************************************//**
+  Log one compression flush: how many queued bytes went out as how many
+  wire bytes. freeciv-netbench reports compression ratios from these.
+**************************************************************************/
+void conn_capture_compression(struct connection *pconn, int wire_bytes,
+                              int queue_bytes)
+{
+  FILE *fp = conn_capture_fp(pconn);
+
+  if (fp != nullptr) {
+    double now = timer_read_seconds(capture_timer);
+    unsigned char kind = 'C';
+    int sizes[3] = { 0, wire_bytes, queue_bytes };
+
+    fwrite(&now, sizeof(now), 1, fp);
+    fwrite(&kind, 1, 1, fp);
+    fwrite(sizes, sizeof(sizes), 1, fp);
+  }
+}
+
 /**********************************************************************//**
   Free compression queue for given connection.
 **************************************************************************/
@@ -550,6 +735,17 @@ void free_compression_queue(struct connection *pc)
 {
 #ifdef USE_COMPRESSION
   byte_vector_free(&pc->compression.queue);
+
+#ifdef FREECIV_HAVE_LIBZSTD
+  if (pc->compression.zstd_cctx != nullptr) {
+    ZSTD_freeCCtx(pc->compression.zstd_cctx);
+    pc->compression.zstd_cctx = nullptr;
+  }
+  if (pc->compression.zstd_dctx != nullptr) {
+    ZSTD_freeDCtx(pc->compression.zstd_dctx);
+    pc->compression.zstd_dctx = nullptr;
+  }
+#endif /* FREECIV_HAVE_LIBZSTD */
 #endif /* USE_COMPRESSION */
 }
 
@@ -562,11 +758,17 @@ static void init_packet_hashes(struct connection *pc)
 
   pc->phs.sent = fc_malloc(sizeof(*pc->phs.sent) * PACKET_LAST);
   pc->phs.received = fc_malloc(sizeof(*pc->phs.received) * PACKET_LAST);
+  pc->phs.sent_cache
+    = fc_malloc(sizeof(*pc->phs.sent_cache) * PACKET_LAST);
+  pc->phs.received_cache
+    = fc_malloc(sizeof(*pc->phs.received_cache) * PACKET_LAST);
   pc->phs.handlers = packet_handlers_initial();
 
   for (i = 0; i < PACKET_LAST; i++) {
     pc->phs.sent[i] = nullptr;
     pc->phs.received[i] = nullptr;
+    pc->phs.sent_cache[i] = nullptr;
+    pc->phs.received_cache[i] = nullptr;
   }
 }
 
@@ -596,6 +798,26 @@ static void free_packet_hashes(struct connection *pc)
     free(pc->phs.received);
     pc->phs.received = nullptr;
   }
+
+  if (pc->phs.sent_cache) {
+    for (i = 0; i < PACKET_LAST; i++) {
+      if (pc->phs.sent_cache[i] != nullptr) {
+        packet_cache_destroy(pc->phs.sent_cache[i]);
+      }
+    }
+    free(pc->phs.sent_cache);
+    pc->phs.sent_cache = nullptr;
+  }
+
+  if (pc->phs.received_cache) {
+    for (i = 0; i < PACKET_LAST; i++) {
+      if (pc->phs.received_cache[i] != nullptr) {
+        packet_cache_destroy(pc->phs.received_cache[i]);
+      }
+    }
+    free(pc->phs.received_cache);
+    pc->phs.received_cache = nullptr;
+  }
 }
 
 /**********************************************************************//**
@@ -612,6 +834,8 @@ void connection_common_init(struct connection *pconn)
   pconn->buffer = new_socket_packet_buffer();
   pconn->send_buffer = new_socket_packet_buffer();
   pconn->statistics.bytes_send = 0;
+  pconn->statistics.net_stats = nullptr;
+  pconn->capture_fp = nullptr;
 #ifdef FREECIV_JSON_CONNECTION
   pconn->json_mode = TRUE;
 #endif /* FREECIV_JSON_CONNECTION */
@@ -621,6 +845,10 @@ void connection_common_init(struct connection *pconn)
 #ifdef USE_COMPRESSION
   byte_vector_init(&pconn->compression.queue);
   pconn->compression.frozen_level = 0;
+#ifdef FREECIV_HAVE_LIBZSTD
+  pconn->compression.zstd_cctx = nullptr;
+  pconn->compression.zstd_dctx = nullptr;
+#endif /* FREECIV_HAVE_LIBZSTD */
 #endif /* USE_COMPRESSION */
 
   pconn->client_gui = GUI_STUB;
@@ -654,6 +882,12 @@ void connection_common_close(struct connection *pconn)
 
     free_compression_queue(pconn);
     free_packet_hashes(pconn);
+    conn_packet_stats_free(pconn);
+
+    if (pconn->capture_fp != nullptr) {
+      fclose(pconn->capture_fp);
+      pconn->capture_fp = nullptr;
+    }
   }
 }
 
@@ -684,6 +918,14 @@ void conn_reset_delta_state(struct connection *pc)
       if (pc->phs.received != nullptr && pc->phs.received[i] != nullptr) {
         genhash_clear(pc->phs.received[i]);
       }
+      if (pc->phs.sent_cache != nullptr
+          && pc->phs.sent_cache[i] != nullptr) {
+        packet_cache_clear(pc->phs.sent_cache[i]);
+      }
+      if (pc->phs.received_cache != nullptr
+          && pc->phs.received_cache[i] != nullptr) {
+        packet_cache_clear(pc->phs.received_cache[i]);
+      }
     }
   }
 }
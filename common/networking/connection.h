@@ -40,6 +40,7 @@ extern "C" {
 ***************************************************************************/
 
 /* utility */
+#include "bitvector.h"          /* struct dbv */
 #include "shared.h"             /* MAX_LEN_ADDR */
 #include "support.h"            /* bool type */
 #include "timing.h"
@@ -52,9 +53,17 @@ extern "C" {
 
 struct conn_pattern_list;
 struct genhash;
+struct packet_cache;
 struct packet_handlers;
+struct packet_net_stats;
 struct timer_list;
 
+#ifdef FREECIV_HAVE_LIBZSTD
+/* From <zstd.h>; ZSTD_CCtx and ZSTD_DCtx are typedefs of these. */
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+#endif /* FREECIV_HAVE_LIBZSTD */
+
 /****************************************************************************
   Command access levels for client-side use; at present, they are only
   used to control access to server commands typed at the client chatline.
@@ -94,6 +103,9 @@ enum auth_status {
   AS_FAILED,
   AS_REQUESTING_NEW_PASS,
   AS_REQUESTING_OLD_PASS,
+  AS_CHECKING_USER,    /* user_exists() query on the fcdb worker thread */
+  AS_VERIFYING_PASS,   /* user_verify() query on the fcdb worker thread */
+  AS_SAVING_USER,      /* user_save() query on the fcdb worker thread */
   AS_ESTABLISHED
 };
 
@@ -215,6 +227,12 @@ struct connection {
       /* Used to follow where the connection is in the authentication
        * process */
       enum auth_status status;
+
+      /* Serial of the latest fcdb query issued for this connection;
+       * results of the worker thread that complete after the connection
+       * has been closed or reused are dropped by comparing this. */
+      int auth_query_serial;
+
       char password[MAX_LEN_PASSWORD];
 
       /* For reverse lookup and blacklisting in db */
@@ -233,6 +251,12 @@ struct connection {
        * but the closing has been postponed. */
       bool is_closing;
 
+      /* The connection's send backlog exceeded the 'netlagbytes'
+       * setting: game state packets are withheld from it until the
+       * backlog has drained, whereupon it is resynchronized with a
+       * full snapshot. See sernet.c. */
+      bool reduced_updates;
+
       /* If we use delegation the original player (playing) is replaced. Save
        * it here to easily restore it. */
       struct {
@@ -240,6 +264,12 @@ struct connection {
         struct player *playing;
         bool observer;
       } delegation;
+
+      /* Tiles send_tile_info() has deferred for this connection while
+       * server/maphand.c is in tile info batching mode; the flush sends
+       * each of them once. */
+      struct dbv tile_info_dirty;
+      int tile_info_dirty_count;
     } server;
   };
 
@@ -262,6 +292,10 @@ struct connection {
   struct {
     struct genhash **sent;
     struct genhash **received;
+    /* Used instead of the genhash tables above for packet types keyed
+     * by a single integer id; see packet_cache in packets.c. */
+    struct packet_cache **sent_cache;
+    struct packet_cache **received_cache;
     const struct packet_handlers *handlers;
   } phs;
 
@@ -270,11 +304,24 @@ struct connection {
     int frozen_level;
 
     struct byte_vector queue;
+
+#ifdef FREECIV_HAVE_LIBZSTD
+    /* Lazily created and then reused for every chunk; see packets.c */
+    struct ZSTD_CCtx_s *zstd_cctx;
+    struct ZSTD_DCtx_s *zstd_dctx;
+#endif /* FREECIV_HAVE_LIBZSTD */
   } compression;
 #endif
   struct {
     int bytes_send;
+    /* Always-on per-packet-type egress counters, lazily allocated on
+     * the first send; see packet_stats_*() in packets.c. */
+    struct packet_net_stats *net_stats;
   } statistics;
+
+  /* Raw packet capture for benchmarking; nullptr unless enabled with
+   * the FREECIV_PACKET_CAPTURE environment variable. */
+  FILE *capture_fp;
 };
 
 
@@ -282,10 +329,29 @@ typedef void (*conn_close_fn_t) (struct connection *pconn);
 void connections_set_close_callback(conn_close_fn_t func);
 void connection_close(struct connection *pconn, const char *reason);
 
+/* Takes over the full content of 'buf' for asynchronous writing and
+ * returns TRUE, or returns FALSE to fall back to a direct write. */
+typedef bool (*conn_write_fn_t) (struct connection *pconn,
+                                 struct socket_packet_buffer *buf);
+void connections_set_write_callback(conn_write_fn_t func);
+
+/* Header of the ".fcap" capture files written when the
+ * FREECIV_PACKET_CAPTURE environment variable is set, and read back by
+ * freeciv-netbench. The records following it are host endian. */
+#define FCAP_MAGIC "FCAP1\n"
+
+void conn_capture_packet(struct connection *pconn, bool outgoing,
+                         int packet_type, const unsigned char *data,
+                         int len);
+void conn_capture_compression(struct connection *pconn, int wire_bytes,
+                              int queue_bytes);
+
 int read_socket_data(int sock, struct socket_packet_buffer *buffer);
 void flush_connection_send_buffer_all(struct connection *pc);
 bool connection_send_data(struct connection *pconn,
                           const unsigned char *data, int len);
+unsigned char *connection_send_reserve(struct connection *pconn, int len);
+bool connection_send_commit(struct connection *pconn, int len);
 
 void connection_do_buffer(struct connection *pc);
 void connection_do_unbuffer(struct connection *pc);
@@ -209,6 +209,36 @@ static json_t *plocation_read_data(json_t *item,
   }
 }
 
+/**********************************************************************//**
+  Helper for dio_put_json_raw(). Appends the chunk jansson hands out
+  straight to the raw output buffer.
+**************************************************************************/
+static int put_json_raw_cb(const char *buffer, size_t size, void *data)
+{
+  struct raw_data_out *dout = data;
+
+  dio_put_memory_raw(dout, buffer, size);
+
+  return dout->too_short ? -1 : 0;
+}
+
+/**********************************************************************//**
+  Serialize the given JSON item directly to the raw output buffer, as a
+  '\0' terminated string. Writing in chunks avoids the intermediate heap
+  copy of the entire packet that json_dumps() would make.
+**************************************************************************/
+int dio_put_json_raw(struct raw_data_out *dout, const json_t *json)
+{
+  static const char terminator = '\0';
+
+  if (json_dump_callback(json, put_json_raw_cb, dout,
+                         JSON_COMPACT | JSON_ENSURE_ASCII) != 0) {
+    return -1;
+  }
+
+  return dio_put_memory_raw(dout, &terminator, 1);
+}
+
 /**********************************************************************//**
   Insert 8 bit value with json.
 **************************************************************************/
@@ -128,6 +128,8 @@ bool dio_get_uint16_vec8_json(struct connection *pc, struct data_in *din,
   dio_get_##f##_json(pc, d, l, ## __VA_ARGS__)
 
 /* puts */
+int dio_put_json_raw(struct raw_data_out *dout, const json_t *json);
+
 int dio_put_farray_json(struct json_data_out *dout,
                         const struct plocation *location, int size);
 int dio_put_object_json(struct json_data_out *dout,
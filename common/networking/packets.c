@@ -47,6 +47,9 @@
 
 #ifdef USE_COMPRESSION
 #include <zlib.h>
+#ifdef FREECIV_HAVE_LIBZSTD
+#include <zstd.h>
+#endif
 /*
  * Value for the 16bit size to indicate a jumbo packet
  */
@@ -67,6 +70,19 @@
 
 #define MAX_DECOMPRESSION 400
 
+/* Keep this a decent amount less than MAX_LEN_BUFFER to avoid the
+ * (remote) possibility of trying to dump MAX_LEN_BUFFER to the
+ * network in one go */
+#define MAX_LEN_COMPRESS_QUEUE (MAX_LEN_BUFFER/2)
+FC_STATIC_ASSERT(MAX_LEN_COMPRESS_QUEUE < MAX_LEN_BUFFER,
+                 compress_queue_maxlen_too_big);
+
+#ifdef FREECIV_HAVE_LIBZSTD
+/* Compresses about as well as zlib's default level at a fraction of
+ * the CPU cost on the short turn-change chunks we produce. */
+#define ZSTD_NET_COMPRESSION_LEVEL 3
+#endif /* FREECIV_HAVE_LIBZSTD */
+
 #endif /* USE_COMPRESSION */
 
 /*
@@ -85,6 +101,117 @@ extern const char *const packet_functional_capability;
 
 static struct packet_handler_hash *packet_handlers = nullptr;
 
+/* Always-on egress counters behind the /netstats command: packet count
+ * and raw (pre-compression) bytes per packet type, and the bytes that
+ * actually went to the socket. Kept per connection - allocated lazily
+ * on the first send - and aggregated into a grand total that survives
+ * connection closes. */
+struct packet_net_stats {
+  size_t wire_bytes;
+  struct {
+    size_t packets;
+    size_t bytes;
+  } type[PACKET_LAST];
+};
+
+static struct packet_net_stats net_stats_total;
+
+/**********************************************************************//**
+  Return the connection's counters, allocating them on first use.
+**************************************************************************/
+static struct packet_net_stats *conn_net_stats(struct connection *pc)
+{
+  if (pc->statistics.net_stats == nullptr) {
+    pc->statistics.net_stats
+      = fc_calloc(1, sizeof(*pc->statistics.net_stats));
+  }
+
+  return pc->statistics.net_stats;
+}
+
+/**********************************************************************//**
+  Count one outgoing packet of 'len' raw bytes.
+**************************************************************************/
+static void packet_stats_account(struct connection *pc,
+                                 enum packet_type packet_type, int len)
+{
+  struct packet_net_stats *stats = conn_net_stats(pc);
+
+  stats->type[packet_type].packets++;
+  stats->type[packet_type].bytes += len;
+  net_stats_total.type[packet_type].packets++;
+  net_stats_total.type[packet_type].bytes += len;
+}
+
+/**********************************************************************//**
+  Count 'len' bytes written to the connection's socket (headers and
+  compressed chunks included).
+**************************************************************************/
+static void packet_stats_wire_account(struct connection *pc, int len)
+{
+  conn_net_stats(pc)->wire_bytes += len;
+  net_stats_total.wire_bytes += len;
+}
+
+/**********************************************************************//**
+  Fetch the counters of one packet type, from the given connection or,
+  with nullptr, from the totals over all connections ever.
+**************************************************************************/
+void packet_stats_get(const struct connection *pc,
+                      enum packet_type packet_type,
+                      size_t *packets, size_t *bytes)
+{
+  const struct packet_net_stats *stats
+    = pc != nullptr ? pc->statistics.net_stats : &net_stats_total;
+
+  if (stats == nullptr) {
+    *packets = 0;
+    *bytes = 0;
+  } else {
+    *packets = stats->type[packet_type].packets;
+    *bytes = stats->type[packet_type].bytes;
+  }
+}
+
+/**********************************************************************//**
+  Bytes written to the socket of the given connection or, with nullptr,
+  to all sockets ever (compression headers and savings included).
+**************************************************************************/
+size_t packet_stats_wire(const struct connection *pc)
+{
+  if (pc != nullptr) {
+    return pc->statistics.net_stats != nullptr
+      ? pc->statistics.net_stats->wire_bytes : 0;
+  }
+
+  return net_stats_total.wire_bytes;
+}
+
+/**********************************************************************//**
+  Zero the grand totals and every living connection's counters.
+**************************************************************************/
+void packet_stats_reset(void)
+{
+  memset(&net_stats_total, 0, sizeof(net_stats_total));
+  conn_list_iterate(game.all_connections, pconn) {
+    if (pconn->statistics.net_stats != nullptr) {
+      memset(pconn->statistics.net_stats, 0,
+             sizeof(*pconn->statistics.net_stats));
+    }
+  } conn_list_iterate_end;
+}
+
+/**********************************************************************//**
+  Release the counters of a closing connection; the totals keep its
+  contribution.
+**************************************************************************/
+void conn_packet_stats_free(struct connection *pc)
+{
+  if (pc->statistics.net_stats != nullptr) {
+    FC_FREE(pc->statistics.net_stats);
+  }
+}
+
 #ifdef USE_COMPRESSION
 static int stat_size_alone = 0;
 static int stat_size_uncompressed = 0;
@@ -109,6 +236,30 @@ static inline int get_compression_level(void)
   return level;
 }
 
+#ifdef FREECIV_HAVE_LIBZSTD
+/**********************************************************************//**
+  Whether compressed chunks sent to this connection should use zstd.
+  The other side announces with the optional "zstdnet" capability that
+  it can decode them; without it we stick to zlib.
+**************************************************************************/
+static bool conn_send_zstd(const struct connection *pconn)
+{
+  return has_capability("zstdnet", pconn->capability);
+}
+
+/**********************************************************************//**
+  Does this compressed chunk carry a zstd frame? zstd frames begin with
+  a fixed magic number; its four bytes never form a valid zlib header,
+  so the two codecs can be told apart without extra signalling.
+**************************************************************************/
+static bool is_zstd_frame(const unsigned char *data, size_t size)
+{
+  return size >= 4
+         && data[0] == 0x28 && data[1] == 0xb5
+         && data[2] == 0x2f && data[3] == 0xfd;
+}
+#endif /* FREECIV_HAVE_LIBZSTD */
+
 /**********************************************************************//**
   Send all waiting data. Return TRUE on success.
 **************************************************************************/
@@ -116,19 +267,43 @@ static bool conn_compression_flush(struct connection *pconn)
 {
   int compression_level = get_compression_level();
   uLongf compressed_size = 12 + 1.001 * pconn->compression.queue.size;
+#ifdef FREECIV_HAVE_LIBZSTD
+  Bytef compressed[MAX((size_t) compressed_size,
+                       ZSTD_compressBound(pconn->compression.queue.size))];
+#else  /* FREECIV_HAVE_LIBZSTD */
   Bytef compressed[compressed_size];
+#endif /* FREECIV_HAVE_LIBZSTD */
   bool jumbo;
   unsigned long compressed_packet_len;
 
+#ifdef FREECIV_HAVE_LIBZSTD
+  if (conn_send_zstd(pconn)) {
+    size_t zsize;
+
+    if (pconn->compression.zstd_cctx == nullptr) {
+      pconn->compression.zstd_cctx = ZSTD_createCCtx();
+    }
+    zsize = ZSTD_compressCCtx(pconn->compression.zstd_cctx,
+                              compressed, sizeof(compressed),
+                              pconn->compression.queue.p,
+                              pconn->compression.queue.size,
+                              ZSTD_NET_COMPRESSION_LEVEL);
+
+    fc_assert_ret_val(!ZSTD_isError(zsize), FALSE);
+    compressed_size = zsize;
+  } else
+#endif /* FREECIV_HAVE_LIBZSTD */
+  {
 #ifndef FREECIV_NDEBUG
-  int error =
+    int error =
 #endif
-  compress2(compressed, &compressed_size,
-            pconn->compression.queue.p,
-            pconn->compression.queue.size,
-            compression_level);
+    compress2(compressed, &compressed_size,
+              pconn->compression.queue.p,
+              pconn->compression.queue.size,
+              compression_level);
 
-  fc_assert_ret_val(error == Z_OK, FALSE);
+    fc_assert_ret_val(error == Z_OK, FALSE);
+  }
 
   /* Compression signalling currently assumes a 2-byte packet length; if that
    * changes, the protocol should probably be changed */
@@ -146,6 +321,9 @@ static bool conn_compression_flush(struct connection *pconn)
                  compressed_size, compression_level);
     stat_size_uncompressed += pconn->compression.queue.size;
     stat_size_compressed += compressed_size;
+    packet_stats_wire_account(pconn, compressed_packet_len);
+    conn_capture_compression(pconn, compressed_packet_len,
+                             pconn->compression.queue.size);
 
     if (!jumbo) {
       unsigned char header[2];
@@ -180,6 +358,7 @@ static bool conn_compression_flush(struct connection *pconn)
     connection_send_data(pconn, pconn->compression.queue.p,
                          pconn->compression.queue.size);
     stat_size_no_compression += pconn->compression.queue.size;
+    packet_stats_wire_account(pconn, pconn->compression.queue.size);
   }
 
   return pconn->used;
@@ -216,6 +395,13 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
   /* default for the server */
   int result = 0;
 
+  if (is_server() && pc->server.reduced_updates
+      && packet_has_game_info_flag(packet_type)) {
+    /* The connection is too far behind; withholding game state is
+     * safe since it will get a full resync when it catches up. */
+    return 0;
+  }
+
   log_packet("sending packet type=%s(%d) len=%d to %s",
              packet_name(packet_type), packet_type, len,
              is_server() ? pc->username : "server");
@@ -231,6 +417,9 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
     pc->outgoing_packet_notify(pc, packet_type, len, result);
   }
 
+  conn_capture_packet(pc, TRUE, packet_type, data, len);
+  packet_stats_account(pc, packet_type, len);
+
 #ifdef USE_COMPRESSION
   if (TRUE) {
     int size = len;
@@ -238,13 +427,6 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
     if (conn_compression_frozen(pc)) {
       size_t old_size;
 
-      /* Keep this a decent amount less than MAX_LEN_BUFFER to avoid the
-       * (remote) possibility of trying to dump MAX_LEN_BUFFER to the
-       * network in one go */
-#define MAX_LEN_COMPRESS_QUEUE (MAX_LEN_BUFFER/2)
-      FC_STATIC_ASSERT(MAX_LEN_COMPRESS_QUEUE < MAX_LEN_BUFFER,
-                       compress_queue_maxlen_too_big);
-
       /* If this packet would cause us to overfill the queue, flush
        * everything that's in there already before queuing this one */
       if (MAX_LEN_COMPRESS_QUEUE
@@ -269,6 +451,7 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
       log_compress("COMPRESS: sending %s alone (%d bytes total)",
                    packet_name(packet_type), stat_size_alone);
       connection_send_data(pc, data, len);
+      packet_stats_wire_account(pc, len);
     }
 
     log_compress2("COMPRESS: STATS: alone=%d compression-expand=%d "
@@ -278,6 +461,7 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
   }
 #else  /* USE_COMPRESSION */
   connection_send_data(pc, data, len);
+  packet_stats_wire_account(pc, len);
 #endif /* USE_COMPRESSION */
 
 #if PACKET_SIZE_STATISTICS
@@ -365,6 +549,128 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
   return result;
 }
 
+/**********************************************************************//**
+  Reserve space to encode one packet directly into its final buffer -
+  the compression queue when the connection is frozen, the send buffer
+  otherwise - avoiding the staging copy of send_packet_data(). Returns
+  nullptr if in place encoding is not possible; the senders then fall
+  back to a stack buffer and send_packet_data(). Abandoning a
+  reservation without send_packet_commit() is harmless.
+  See SEND_PACKET_START / SEND_PACKET_END.
+**************************************************************************/
+unsigned char *send_packet_reserve(struct connection *pc)
+{
+#if PACKET_SIZE_STATISTICS
+  /* Keep every packet on the copying path so the statistics in
+   * send_packet_data() see all of them. */
+  return nullptr;
+#else  /* PACKET_SIZE_STATISTICS */
+  if (pc == nullptr
+      || !pc->used
+      || (is_server() && pc->server.is_closing)) {
+    return nullptr;
+  }
+
+#ifdef USE_COMPRESSION
+  if (conn_compression_frozen(pc)) {
+    size_t old_size;
+
+    /* If a maximum length packet would overfill the queue, flush
+     * everything that's in there already before reserving. */
+    if (MAX_LEN_COMPRESS_QUEUE
+        < byte_vector_size(&pc->compression.queue) + MAX_LEN_PACKET) {
+      log_compress2("COMPRESS: huge queue, forcing to flush (%lu/%lu)",
+                    (long unsigned)
+                    byte_vector_size(&pc->compression.queue),
+                    (long unsigned) MAX_LEN_COMPRESS_QUEUE);
+      if (!conn_compression_flush(pc)) {
+        return nullptr;
+      }
+      byte_vector_reserve(&pc->compression.queue, 0);
+    }
+
+    /* Grow the allocation for a worst case packet, but keep the
+     * logical size unchanged until the commit; a discarded packet
+     * must leave no trace in the queue. */
+    old_size = byte_vector_size(&pc->compression.queue);
+    byte_vector_reserve(&pc->compression.queue,
+                        old_size + MAX_LEN_PACKET);
+    byte_vector_reserve(&pc->compression.queue, old_size);
+
+    return pc->compression.queue.p + old_size;
+  }
+#endif /* USE_COMPRESSION */
+
+  return connection_send_reserve(pc, MAX_LEN_PACKET);
+#endif /* PACKET_SIZE_STATISTICS */
+}
+
+/**********************************************************************//**
+  Account and send a packet encoded in place after send_packet_reserve().
+  When 'in_place' is FALSE the packet was staged in the caller's own
+  buffer instead and takes the send_packet_data() path.
+  It returns the request id of the outgoing packet (or 0 if is_server()).
+**************************************************************************/
+int send_packet_commit(struct connection *pc, unsigned char *data,
+                       int len, bool in_place,
+                       enum packet_type packet_type)
+{
+  /* default for the server */
+  int result = 0;
+
+  if (!in_place) {
+    return send_packet_data(pc, data, len, packet_type);
+  }
+
+  if (is_server() && pc->server.reduced_updates
+      && packet_has_game_info_flag(packet_type)) {
+    /* As in send_packet_data(); abandoning the reservation the packet
+     * was encoded into is harmless. */
+    return 0;
+  }
+
+  log_packet("sending packet type=%s(%d) len=%d to %s",
+             packet_name(packet_type), packet_type, len,
+             is_server() ? pc->username : "server");
+
+  if (!is_server()) {
+    pc->client.last_request_id_used =
+        get_next_request_id(pc->client.last_request_id_used);
+    result = pc->client.last_request_id_used;
+    log_packet("sending request %d", result);
+  }
+
+  if (pc->outgoing_packet_notify) {
+    pc->outgoing_packet_notify(pc, packet_type, len, result);
+  }
+
+  conn_capture_packet(pc, TRUE, packet_type, data, len);
+  packet_stats_account(pc, packet_type, len);
+
+#ifdef USE_COMPRESSION
+  if (conn_compression_frozen(pc)) {
+    /* The packet bytes are already in the queue; just extend its
+     * logical size over them. This can't reallocate - the reserve
+     * already grew the allocation by a maximum length packet. */
+    byte_vector_reserve(&pc->compression.queue,
+                        byte_vector_size(&pc->compression.queue) + len);
+    log_compress2("COMPRESS: putting %s into the queue",
+                  packet_name(packet_type));
+  } else {
+    stat_size_alone += len;
+    log_compress("COMPRESS: sending %s alone (%d bytes total)",
+                 packet_name(packet_type), stat_size_alone);
+    connection_send_commit(pc, len);
+    packet_stats_wire_account(pc, len);
+  }
+#else  /* USE_COMPRESSION */
+  connection_send_commit(pc, len);
+  packet_stats_wire_account(pc, len);
+#endif /* USE_COMPRESSION */
+
+  return result;
+}
+
 /**********************************************************************//**
   Read and return a packet from the connection 'pc'. The type of the
   packet is written in 'ptype'. On error, the connection is closed and
@@ -441,34 +747,77 @@ void *get_packet_from_connection_raw(struct connection *pc,
 
   if (compressed_packet) {
     uLong compressed_size = whole_packet_len - header_size;
-    int decompress_factor = 80;
-    unsigned long int decompressed_size = decompress_factor * compressed_size;
-    int error = Z_BUF_ERROR;
+    unsigned long int decompressed_size;
     struct socket_packet_buffer *buffer = pc->buffer;
-    void *decompressed = fc_malloc(decompressed_size);
-
-    do {
-      error =
-        uncompress(decompressed, &decompressed_size,
-                   ADD_TO_POINTER(buffer->data, header_size),
-                   compressed_size);
-
-      if (error == Z_BUF_ERROR) {
-        decompress_factor += 50;
-        decompressed_size = decompress_factor * compressed_size;
-        decompressed = fc_realloc(decompressed, decompressed_size);
+    void *decompressed;
+
+#ifdef FREECIV_HAVE_LIBZSTD
+    if (is_zstd_frame(ADD_TO_POINTER(buffer->data, header_size),
+                      compressed_size)) {
+      unsigned long long frame_size
+        = ZSTD_getFrameContentSize(ADD_TO_POINTER(buffer->data, header_size),
+                                   compressed_size);
+      size_t zsize;
+
+      if (frame_size == ZSTD_CONTENTSIZE_UNKNOWN
+          || frame_size == ZSTD_CONTENTSIZE_ERROR
+          || frame_size > (unsigned long long) MAX_DECOMPRESSION
+                          * compressed_size) {
+        log_verbose("Uncompressing of the packet stream failed. "
+                    "The connection will be closed now.");
+        connection_close(pc, _("decoding error"));
+        return nullptr;
       }
 
-      if (error != Z_OK) {
-        if (error != Z_BUF_ERROR || decompress_factor > MAX_DECOMPRESSION ) {
-          log_verbose("Uncompressing of the packet stream failed. "
-                      "The connection will be closed now.");
-          connection_close(pc, _("decoding error"));
-          return nullptr;
-        }
+      if (pc->compression.zstd_dctx == nullptr) {
+        pc->compression.zstd_dctx = ZSTD_createDCtx();
+      }
+      decompressed_size = frame_size;
+      decompressed = fc_malloc(MAX(decompressed_size, 1));
+      zsize = ZSTD_decompressDCtx(pc->compression.zstd_dctx,
+                                  decompressed, decompressed_size,
+                                  ADD_TO_POINTER(buffer->data, header_size),
+                                  compressed_size);
+
+      if (ZSTD_isError(zsize) || zsize != decompressed_size) {
+        free(decompressed);
+        log_verbose("Uncompressing of the packet stream failed. "
+                    "The connection will be closed now.");
+        connection_close(pc, _("decoding error"));
+        return nullptr;
       }
+    } else
+#endif /* FREECIV_HAVE_LIBZSTD */
+    {
+      int decompress_factor = 80;
+      int error = Z_BUF_ERROR;
+
+      decompressed_size = decompress_factor * compressed_size;
+      decompressed = fc_malloc(decompressed_size);
+
+      do {
+        error =
+          uncompress(decompressed, &decompressed_size,
+                     ADD_TO_POINTER(buffer->data, header_size),
+                     compressed_size);
+
+        if (error == Z_BUF_ERROR) {
+          decompress_factor += 50;
+          decompressed_size = decompress_factor * compressed_size;
+          decompressed = fc_realloc(decompressed, decompressed_size);
+        }
 
-    } while (error != Z_OK);
+        if (error != Z_OK) {
+          if (error != Z_BUF_ERROR || decompress_factor > MAX_DECOMPRESSION ) {
+            log_verbose("Uncompressing of the packet stream failed. "
+                        "The connection will be closed now.");
+            connection_close(pc, _("decoding error"));
+            return nullptr;
+          }
+        }
+
+      } while (error != Z_OK);
+    }
 
     buffer->ndata -= whole_packet_len;
     /*
@@ -538,6 +887,9 @@ void *get_packet_from_connection_raw(struct connection *pc,
     pc->incoming_packet_notify(pc, utype.type, whole_packet_len);
   }
 
+  conn_capture_packet(pc, FALSE, utype.type, pc->buffer->data,
+                      whole_packet_len);
+
 #if PACKET_SIZE_STATISTICS
   {
     static struct {
@@ -901,3 +1253,201 @@ void packets_deinit(void)
 {
   packet_handlers_free();
 }
+
+/*
+ * The delta protocol remembers the last version of every keyed packet
+ * sent over (or received from) a connection. Almost all keyed packets
+ * are keyed by a single small integer id (tile index, unit id, city
+ * id, ...), for which a generic hash table costs a hash callback, a
+ * comparison callback and a separately allocated key per lookup. The
+ * open addressed table below maps such int keys straight to the cached
+ * packet instead; packets with no key field or with several of them
+ * keep using genhash. See generate_packets.py.
+ */
+
+enum packet_cache_slot_state {
+  PCS_EMPTY = 0,        /* Matches the zeroed fresh allocation */
+  PCS_USED,
+  PCS_DELETED           /* Keeps probe sequences over removed entries intact */
+};
+
+struct packet_cache_slot {
+  int key;
+  void *packet;
+  enum packet_cache_slot_state state;
+};
+
+struct packet_cache {
+  struct packet_cache_slot *slots;
+  unsigned int capacity;        /* Zero, or a power of two */
+  unsigned int used;            /* Slots in state PCS_USED */
+  unsigned int fill;            /* Slots in state PCS_USED or PCS_DELETED */
+  void (*free_packet)(void *packet);
+};
+
+#define PACKET_CACHE_MIN_CAPACITY 16
+
+/**********************************************************************//**
+  Bucket index for the given key; ids are mostly consecutive, so spread
+  them with a Fibonacci multiplier.
+**************************************************************************/
+static inline unsigned int packet_cache_hash(int key)
+{
+  return (unsigned int) key * 2654435761u;
+}
+
+/**********************************************************************//**
+  Create a new, empty packet cache. 'free_packet' is called for every
+  cached packet that gets removed, cleared, or destroyed with the cache.
+**************************************************************************/
+struct packet_cache *packet_cache_new(void (*free_packet)(void *packet))
+{
+  struct packet_cache *pcache = fc_malloc(sizeof(*pcache));
+
+  pcache->slots = nullptr;
+  pcache->capacity = 0;
+  pcache->used = 0;
+  pcache->fill = 0;
+  pcache->free_packet = free_packet;
+
+  return pcache;
+}
+
+/**********************************************************************//**
+  Free all packets cached in 'pcache', leaving it empty.
+**************************************************************************/
+void packet_cache_clear(struct packet_cache *pcache)
+{
+  unsigned int i;
+
+  for (i = 0; i < pcache->capacity; i++) {
+    if (pcache->slots[i].state == PCS_USED
+        && pcache->free_packet != nullptr) {
+      pcache->free_packet(pcache->slots[i].packet);
+    }
+    pcache->slots[i].packet = nullptr;
+    pcache->slots[i].state = PCS_EMPTY;
+  }
+  pcache->used = 0;
+  pcache->fill = 0;
+}
+
+/**********************************************************************//**
+  Free 'pcache' and all packets cached in it.
+**************************************************************************/
+void packet_cache_destroy(struct packet_cache *pcache)
+{
+  packet_cache_clear(pcache);
+  if (pcache->slots != nullptr) {
+    free(pcache->slots);
+  }
+  free(pcache);
+}
+
+/**********************************************************************//**
+  Return the packet cached under 'key', or nullptr if there is none.
+**************************************************************************/
+void *packet_cache_lookup(const struct packet_cache *pcache, int key)
+{
+  unsigned int i;
+
+  if (pcache->capacity == 0) {
+    return nullptr;
+  }
+
+  i = packet_cache_hash(key) & (pcache->capacity - 1);
+  while (pcache->slots[i].state != PCS_EMPTY) {
+    if (pcache->slots[i].state == PCS_USED && pcache->slots[i].key == key) {
+      return pcache->slots[i].packet;
+    }
+    i = (i + 1) & (pcache->capacity - 1);
+  }
+
+  return nullptr;
+}
+
+/**********************************************************************//**
+  Move the live entries of 'pcache' to a fresh slot array sized for
+  them. Deleted slots are dropped in the process.
+**************************************************************************/
+static void packet_cache_grow(struct packet_cache *pcache)
+{
+  struct packet_cache_slot *oslots = pcache->slots;
+  unsigned int ocap = pcache->capacity;
+  unsigned int i;
+
+  pcache->capacity = PACKET_CACHE_MIN_CAPACITY / 2;
+  do {
+    pcache->capacity *= 2;
+  } while (pcache->used * 2 >= pcache->capacity);
+  pcache->slots = fc_calloc(pcache->capacity, sizeof(*pcache->slots));
+  pcache->fill = pcache->used;
+
+  for (i = 0; i < ocap; i++) {
+    if (oslots[i].state == PCS_USED) {
+      unsigned int j = packet_cache_hash(oslots[i].key)
+                       & (pcache->capacity - 1);
+
+      while (pcache->slots[j].state != PCS_EMPTY) {
+        j = (j + 1) & (pcache->capacity - 1);
+      }
+      pcache->slots[j] = oslots[i];
+    }
+  }
+
+  if (oslots != nullptr) {
+    free(oslots);
+  }
+}
+
+/**********************************************************************//**
+  Cache 'packet' under 'key'. The key must not be in the cache already;
+  callers are expected to have done a lookup first.
+**************************************************************************/
+void packet_cache_insert(struct packet_cache *pcache, int key, void *packet)
+{
+  unsigned int i;
+
+  /* Keep at least a quarter of the slots empty so probes stay short. */
+  if ((pcache->fill + 1) * 4 >= pcache->capacity * 3) {
+    packet_cache_grow(pcache);
+  }
+
+  i = packet_cache_hash(key) & (pcache->capacity - 1);
+  while (pcache->slots[i].state == PCS_USED) {
+    i = (i + 1) & (pcache->capacity - 1);
+  }
+  if (pcache->slots[i].state == PCS_EMPTY) {
+    pcache->fill++;
+  }
+  pcache->slots[i].key = key;
+  pcache->slots[i].packet = packet;
+  pcache->slots[i].state = PCS_USED;
+  pcache->used++;
+}
+
+/**********************************************************************//**
+  Free the packet cached under 'key', if any, and forget it.
+**************************************************************************/
+void packet_cache_remove(struct packet_cache *pcache, int key)
+{
+  unsigned int i;
+
+  if (pcache->capacity == 0) {
+    return;
+  }
+
+  i = packet_cache_hash(key) & (pcache->capacity - 1);
+  while (pcache->slots[i].state != PCS_EMPTY) {
+    if (pcache->slots[i].state == PCS_USED && pcache->slots[i].key == key) {
+      if (pcache->free_packet != nullptr) {
+        pcache->free_packet(pcache->slots[i].packet);
+      }
+      pcache->slots[i].packet = nullptr;
+      pcache->slots[i].state = PCS_DELETED;
+      pcache->used--;
+      return;
+    }
+    i = (i + 1) & (pcache->capacity - 1);
+  }
+}
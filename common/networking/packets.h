@@ -105,6 +105,29 @@ const char *packet_name(enum packet_type type);
 bool packet_has_game_info_flag(enum packet_type type);
 void packet_destroy(void *packet, enum packet_type type);
 
+/* Always-on egress counters, shown by the server's /netstats command.
+ * Raw bytes are packet payloads before compression; wire bytes are
+ * what actually went to the socket. Passing nullptr for the connection
+ * reads the totals over all connections ever. */
+void packet_stats_get(const struct connection *pc,
+                      enum packet_type packet_type,
+                      size_t *packets, size_t *bytes);
+size_t packet_stats_wire(const struct connection *pc);
+void packet_stats_reset(void);
+void conn_packet_stats_free(struct connection *pc);
+
+/* Open addressed delta cache for packets keyed by a single integer id.
+ * Packets with no key or with several key fields use genhash instead. */
+struct packet_cache;
+
+struct packet_cache *packet_cache_new(void (*free_packet)(void *packet));
+void packet_cache_destroy(struct packet_cache *pcache);
+void packet_cache_clear(struct packet_cache *pcache);
+void *packet_cache_lookup(const struct packet_cache *pcache, int key);
+void packet_cache_insert(struct packet_cache *pcache, int key,
+                         void *packet);
+void packet_cache_remove(struct packet_cache *pcache, int key);
+
 void packet_header_init(struct packet_header *packet_header);
 void post_send_packet_server_join_reply(struct connection *pconn,
                                         const struct packet_server_join_reply
@@ -127,10 +150,15 @@ void packets_deinit(void);
 #else
 
 #define SEND_PACKET_START(packet_type) \
-  unsigned char buffer[MAX_LEN_PACKET]; \
+  unsigned char stage_buf[MAX_LEN_PACKET]; \
+  unsigned char *buffer = send_packet_reserve(pc); \
+  bool buffer_in_place = (buffer != nullptr); \
   struct raw_data_out dout; \
   \
-  dio_output_init(&dout, buffer, sizeof(buffer)); \
+  if (!buffer_in_place) { \
+    buffer = stage_buf; \
+  } \
+  dio_output_init(&dout, buffer, MAX_LEN_PACKET); \
   dio_put_type_raw(&dout, pc->packet_header.length, 0); \
   dio_put_type_raw(&dout, pc->packet_header.type, packet_type);
 
@@ -141,7 +169,8 @@ void packets_deinit(void);
     dio_output_rewind(&dout); \
     dio_put_type_raw(&dout, pc->packet_header.length, size); \
     fc_assert(!dout.too_short); \
-    return send_packet_data(pc, buffer, size, packet_type); \
+    return send_packet_commit(pc, buffer, size, buffer_in_place, \
+                              packet_type); \
   }
 
 #define SEND_PACKET_DISCARD() \
@@ -182,6 +211,10 @@ void packets_deinit(void);
 
 int send_packet_data(struct connection *pc, unsigned char *data, int len,
                      enum packet_type packet_type);
+unsigned char *send_packet_reserve(struct connection *pc);
+int send_packet_commit(struct connection *pc, unsigned char *data,
+                       int len, bool in_place,
+                       enum packet_type packet_type);
 bool packet_check(struct data_in *din, struct connection *pc);
 
 /* Utilities to move string vectors in and out of packets. */
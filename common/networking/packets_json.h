@@ -26,16 +26,15 @@ void *get_packet_from_connection_json(struct connection *pc,
 
 #define SEND_PACKET_START(packet_type)                                  \
   unsigned char buffer[MAX_LEN_PACKET * 5];                             \
-  struct plocation *pid_addr;                                           \
-  char *json_buffer = nullptr;                                          \
   struct json_data_out dout;                                            \
   dio_output_init(&(dout.raw), buffer, sizeof(buffer));                 \
   if (pc->json_mode) {                                                  \
+    struct plocation pid_addr                                           \
+      = { .kind = PADR_FIELD, .name = (char *) "pid",                   \
+          .sub_location = nullptr };                                    \
     dout.json = json_object();                                          \
     dio_put_uint16_raw(&(dout.raw), 0);                                 \
-    pid_addr = plocation_field_new("pid");                              \
-    dio_put_uint8_json(&dout, pid_addr, packet_type);                   \
-    FC_FREE(pid_addr);                                                  \
+    dio_put_uint8_json(&dout, &pid_addr, packet_type);                  \
   } else {                                                              \
     dout.json = nullptr;                                                \
     dio_put_type_raw(&dout.raw, pc->packet_header.length, 0);           \
@@ -46,16 +45,14 @@ void *get_packet_from_connection_json(struct connection *pc,
   {                                                                     \
     size_t size;                                                        \
     if (pc->json_mode) {                                                \
-      json_buffer = json_dumps(dout.json, JSON_COMPACT | JSON_ENSURE_ASCII); \
-      if (json_buffer) {                                                \
-        dio_put_string_raw(&(dout.raw), json_buffer);                   \
-        log_packet_json("Json out: %s", json_buffer);                   \
+      if (dio_put_json_raw(&(dout.raw), dout.json) == 0) {              \
+        /* The '\0' terminated json text starts after the length header. */ \
+        log_packet_json("Json out: %s", (char *) buffer + 2);           \
       }                                                                 \
       size = dio_output_used(&dout.raw);                                \
                                                                         \
       dio_output_rewind(&(dout.raw));                                   \
       dio_put_uint16_raw(&(dout.raw), size);                            \
-      free(json_buffer);                                                \
       json_decref(dout.json);                                           \
     } else {                                                            \
       size = dio_output_used(&dout.raw);                                \
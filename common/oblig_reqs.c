@@ -21,6 +21,7 @@
 #include "mem.h"
 
 /* common */
+#include "actions.h"
 #include "actres.h"
 #include "nation.h"
 #include "player.h"
@@ -32,6 +33,12 @@
 static struct obligatory_req_vector oblig_hard_reqs_r[ACTRES_NONE];
 static struct obligatory_req_vector oblig_hard_reqs_sr[ACT_SUB_RES_COUNT];
 
+/* The requirements of both the result and the sub results of each action,
+ * merged to one vector indexed by action id. Compiled on first use after
+ * a registration so callers stop re-walking the lists above. */
+static struct obligatory_req_vector oblig_hard_reqs_m[MAX_NUM_ACTIONS];
+static bool oblig_hard_reqs_m_valid = FALSE;
+
 
 /**********************************************************************//**
   Returns a new array of alternative action enabler contradictions. Only
@@ -86,6 +93,65 @@ static void ae_contra_close(struct ae_contra_or *contra)
   }
 }
 
+/**********************************************************************//**
+  Forget the merged per action requirement vectors. They are compiled
+  again the next time one is asked for.
+**************************************************************************/
+static void oblig_hard_reqs_merged_clear(void)
+{
+  int i;
+
+  for (i = 0; i < MAX_NUM_ACTIONS; i++) {
+    obligatory_req_vector_iterate(&oblig_hard_reqs_m[i], oreq) {
+      ae_contra_close(oreq->contras);
+    } obligatory_req_vector_iterate_end;
+    obligatory_req_vector_free(&oblig_hard_reqs_m[i]);
+    obligatory_req_vector_init(&oblig_hard_reqs_m[i]);
+  }
+
+  oblig_hard_reqs_m_valid = FALSE;
+}
+
+/**********************************************************************//**
+  Compile the obligatory hard requirements of every action - those of its
+  result and those of each of its sub results - into one vector per
+  action id, in the order the separate vectors used to be walked.
+**************************************************************************/
+static void oblig_hard_reqs_merge(void)
+{
+  oblig_hard_reqs_merged_clear();
+
+  action_iterate(act) {
+    struct action *paction = action_by_number(act);
+    struct obligatory_req_vector *merged = &oblig_hard_reqs_m[act];
+    enum action_sub_result sub_res;
+
+    if (paction->result != ACTRES_NONE) {
+      obligatory_req_vector_iterate(&oblig_hard_reqs_r[paction->result],
+                                    oreq) {
+        obligatory_req_vector_append(merged, *oreq);
+        oreq->contras->users++;
+      } obligatory_req_vector_iterate_end;
+    }
+
+    for (sub_res = action_sub_result_begin();
+         sub_res != action_sub_result_end();
+         sub_res = action_sub_result_next(sub_res)) {
+      if (!BV_ISSET(paction->sub_results, sub_res)) {
+        /* Not relevant */
+        continue;
+      }
+
+      obligatory_req_vector_iterate(&oblig_hard_reqs_sr[sub_res], oreq) {
+        obligatory_req_vector_append(merged, *oreq);
+        oreq->contras->users++;
+      } obligatory_req_vector_iterate_end;
+    }
+  } action_iterate_end;
+
+  oblig_hard_reqs_m_valid = TRUE;
+}
+
 /**********************************************************************//**
   Register an obligatory hard requirement for the specified action sub
   results.
@@ -126,6 +192,9 @@ static void voblig_hard_req_reg_sub_res(struct ae_contra_or *contras,
     /* Register the new user. */
     oreq.contras->users++;
   }
+
+  /* The merged per action vectors are out of date. */
+  oblig_hard_reqs_m_valid = FALSE;
 }
 
 /**********************************************************************//**
@@ -195,6 +264,9 @@ static void voblig_hard_req_reg(struct ae_contra_or *contras,
   fc_assert(users > 0);
 
   oreq.contras->users += users;
+
+  /* The merged per action vectors are out of date. */
+  oblig_hard_reqs_m_valid = FALSE;
 }
 
 /**********************************************************************//**
@@ -821,6 +893,12 @@ void oblig_hard_reqs_init(void)
     /* Prepare each action sub result's storage area. */
     obligatory_req_vector_init(&oblig_hard_reqs_sr[i]);
   }
+
+  /* Merged per action storage. */
+  for (i = 0; i < MAX_NUM_ACTIONS; i++) {
+    obligatory_req_vector_init(&oblig_hard_reqs_m[i]);
+  }
+  oblig_hard_reqs_m_valid = FALSE;
 }
 
 /**********************************************************************//**
@@ -843,6 +921,8 @@ void oblig_hard_reqs_free(void)
     } obligatory_req_vector_iterate_end;
     obligatory_req_vector_free(&oblig_hard_reqs_sr[i]);
   }
+
+  oblig_hard_reqs_merged_clear();
 }
 
 /**********************************************************************//**
@@ -866,3 +946,21 @@ struct obligatory_req_vector *oblig_hard_reqs_get_sub(enum action_sub_result res
 {
   return &(oblig_hard_reqs_sr[res]);
 }
+
+/**********************************************************************//**
+  Get the merged obligatory requirements of an action, covering both its
+  result and all its sub results. Compiled to an indexed table on first
+  use after a registration; later calls are plain lookups.
+
+  @param  paction Action to get requirements for
+  @return         Vector of obligatory requirements
+**************************************************************************/
+const struct obligatory_req_vector *
+oblig_hard_reqs_get_merged(const struct action *paction)
+{
+  if (!oblig_hard_reqs_m_valid) {
+    oblig_hard_reqs_merge();
+  }
+
+  return &(oblig_hard_reqs_m[action_number(paction)]);
+}
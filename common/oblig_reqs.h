@@ -64,8 +64,12 @@ void oblig_hard_reqs_free(void);
 void hard_code_oblig_hard_reqs(void);
 void hard_code_oblig_hard_reqs_ruleset(void);
 
+struct action;
+
 struct obligatory_req_vector *oblig_hard_reqs_get(enum action_result res);
 struct obligatory_req_vector *oblig_hard_reqs_get_sub(enum action_sub_result res);
+const struct obligatory_req_vector *
+oblig_hard_reqs_get_merged(const struct action *paction);
 
 #ifdef __cplusplus
 }
@@ -323,6 +323,11 @@ struct player
 
       struct player_tile *private_map;
 
+      /* Tiles where own_seen is nonzero on some vision layer. Kept in
+       * sync by map_change_own_seen(); lets shared vision changes walk
+       * only the tiles this player actually sees. */
+      struct dbv own_seen_tiles;
+
       /* Player can see inside their borders. */
       bool border_vision;
 
@@ -349,6 +354,13 @@ struct player
       int huts; /* How many huts this player has found */
 
       int bulbs_last_turn; /* Number of bulbs researched last turn only. */
+
+      /* Change stamp for delta autosaves; advanced whenever this
+       * player's savegame sections go stale, compared against the
+       * snapshot taken at the last full save. See
+       * server/savegame/savemain.c. */
+      unsigned delta_counter;
+      unsigned delta_base;
     } server;
 
     struct {
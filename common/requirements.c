@@ -18,6 +18,7 @@
 
 /* utility */
 #include "astring.h"
+#include "bitvector.h"
 #include "fcintl.h"
 #include "log.h"
 #include "support.h"
@@ -6632,6 +6633,208 @@ static struct req_def req_definitions[VUT_COUNT] = {
   [VUT_UTYPE] = {is_unittype_req_active, REQUCH_YES}
 };
 
+/*
+ * Hot-path query counters for the /reqstats command. Plain increments;
+ * concurrent AI threads may drop an occasional count, which is
+ * acceptable for profiling.
+ */
+static struct {
+  size_t calls[VUT_COUNT];
+  size_t turn_calls[VUT_COUNT];      /* Last completed turn */
+  size_t prev_calls[VUT_COUNT];
+  size_t memo_hits;
+  size_t memo_misses;
+  size_t turn_memo_hits;
+  size_t turn_memo_misses;
+  size_t prev_memo_hits;
+  size_t prev_memo_misses;
+} req_stats;
+
+/**********************************************************************//**
+  Snapshot per-turn requirement query counters. Called at turn change.
+**************************************************************************/
+void requirement_stats_turn(void)
+{
+  int kind;
+
+  for (kind = 0; kind < VUT_COUNT; kind++) {
+    req_stats.turn_calls[kind]
+      = req_stats.calls[kind] - req_stats.prev_calls[kind];
+    req_stats.prev_calls[kind] = req_stats.calls[kind];
+  }
+  req_stats.turn_memo_hits
+    = req_stats.memo_hits - req_stats.prev_memo_hits;
+  req_stats.prev_memo_hits = req_stats.memo_hits;
+  req_stats.turn_memo_misses
+    = req_stats.memo_misses - req_stats.prev_memo_misses;
+  req_stats.prev_memo_misses = req_stats.memo_misses;
+}
+
+/**********************************************************************//**
+  Reset all requirement query counters.
+**************************************************************************/
+void requirement_stats_clear(void)
+{
+  memset(&req_stats, 0, sizeof(req_stats));
+}
+
+/**********************************************************************//**
+  Read the is_req_active() call counters for one requirement kind.
+**************************************************************************/
+void requirement_stats_get(enum universals_n kind,
+                           size_t *calls, size_t *turn_calls)
+{
+  fc_assert_ret(kind >= 0 && kind < VUT_COUNT);
+
+  *calls = req_stats.calls[kind];
+  *turn_calls = req_stats.turn_calls[kind];
+}
+
+/**********************************************************************//**
+  Read the requirement memo hit/miss counters.
+**************************************************************************/
+void requirement_stats_memo(size_t *hits, size_t *misses,
+                            size_t *turn_hits, size_t *turn_misses)
+{
+  *hits = req_stats.memo_hits;
+  *misses = req_stats.memo_misses;
+  *turn_hits = req_stats.turn_memo_hits;
+  *turn_misses = req_stats.turn_memo_misses;
+}
+
+/*
+ * Phase-scoped memo of requirement evaluations keyed by (requirement,
+ * player). Only requirements whose value cannot change between resets
+ * are memoized; requirement_memo_reset() is called at phase start and
+ * from tech and government changes, which may happen mid phase.
+ * Server only - the client has no phase hooks.
+ */
+struct req_memo_entry {
+  unsigned gen[MAX_NUM_PLAYER_SLOTS];
+  unsigned char val[MAX_NUM_PLAYER_SLOTS];
+};
+
+static void req_memo_entry_destroy(struct req_memo_entry *entry);
+
+#define SPECHASH_TAG req_memo
+#define SPECHASH_IKEY_TYPE struct requirement *
+#define SPECHASH_IDATA_TYPE struct req_memo_entry *
+#define SPECHASH_IDATA_FREE req_memo_entry_destroy
+#include "spechash.h"
+
+static struct req_memo_hash *req_memo_table = nullptr;
+static unsigned req_memo_generation = 1;
+static bool req_memo_frozen = FALSE;
+
+/**********************************************************************//**
+  Free one requirement memo entry.
+**************************************************************************/
+static void req_memo_entry_destroy(struct req_memo_entry *entry)
+{
+  free(entry);
+}
+
+/**********************************************************************//**
+  Does this requirement, evaluated for a given player, keep its value
+  between requirement_memo_reset() calls? Tech and government changes
+  bump the generation themselves, so they are safe here despite being
+  able to happen mid phase.
+**************************************************************************/
+static bool req_is_phase_stable(const struct requirement *req)
+{
+  switch (req->source.kind) {
+  case VUT_ADVANCE:
+  case VUT_TECHFLAG:
+    /* Alliance (and thus Team-or-Alliance mixed) evaluations aggregate
+     * over the current allies, and alliances can form or break mid
+     * phase without anything bumping the generation. */
+    return (req->range == REQ_RANGE_LOCAL
+            || req->range == REQ_RANGE_PLAYER
+            || req->range == REQ_RANGE_WORLD);
+  case VUT_GOVERNMENT:
+  case VUT_STYLE:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+/**********************************************************************//**
+  Evaluate req's present-condition in context, reusing the memoized
+  value for phase-stable player requirements when available.
+**************************************************************************/
+static enum fc_tristate
+req_present_memo(const struct civ_map *nmap,
+                 const struct req_context *context,
+                 const struct req_context *other_context,
+                 const struct requirement *req)
+{
+  struct req_memo_entry *entry;
+  enum fc_tristate val;
+  int pslot;
+
+  if (!is_server() || context->player == nullptr
+      || !req_is_phase_stable(req)) {
+    return req_definitions[req->source.kind].cb(nmap, context,
+                                                other_context, req);
+  }
+
+  pslot = player_index(context->player);
+  if (req_memo_frozen) {
+    /* Concurrent readers may be active; use what is already memoized
+     * but do not modify the table. */
+    if (req_memo_table != nullptr
+        && req_memo_hash_lookup(req_memo_table, (struct requirement *) req,
+                                &entry)
+        && entry->gen[pslot] == req_memo_generation) {
+      req_stats.memo_hits++;
+      return (enum fc_tristate) entry->val[pslot];
+    }
+    req_stats.memo_misses++;
+    return req_definitions[req->source.kind].cb(nmap, context,
+                                                other_context, req);
+  }
+  if (req_memo_table == nullptr) {
+    req_memo_table = req_memo_hash_new();
+  }
+  if (!req_memo_hash_lookup(req_memo_table, (struct requirement *) req,
+                            &entry)) {
+    entry = fc_calloc(1, sizeof(*entry));
+    req_memo_hash_insert(req_memo_table, (struct requirement *) req, entry);
+  }
+  if (entry->gen[pslot] == req_memo_generation) {
+    req_stats.memo_hits++;
+    return (enum fc_tristate) entry->val[pslot];
+  }
+
+  req_stats.memo_misses++;
+  val = req_definitions[req->source.kind].cb(nmap, context,
+                                             other_context, req);
+  entry->gen[pslot] = req_memo_generation;
+  entry->val[pslot] = val;
+
+  return val;
+}
+
+/**********************************************************************//**
+  Drop all memoized requirement evaluations. Called at phase start and
+  whenever tech state or a government changes.
+**************************************************************************/
+void requirement_memo_reset(void)
+{
+  req_memo_generation++;
+}
+
+/**********************************************************************//**
+  Freeze or thaw the requirement memo. While frozen, memoized values are
+  still used but no new ones are stored, making the table safe to read
+  from several threads at once.
+**************************************************************************/
+void requirement_memo_freeze(bool frozen)
+{
+  req_memo_frozen = frozen;
+}
+
 /**********************************************************************//**
   Checks the requirement to see if it is active on the given target.
 
@@ -6651,8 +6854,13 @@ bool is_req_active(const struct req_context *context,
                    const enum   req_problem_type prob_type)
 {
   const struct civ_map *nmap = &(wld.map);
-  enum fc_tristate eval = tri_req_present(nmap, context, other_context,
-                                          req);
+  enum fc_tristate eval;
+
+  if (req->source.kind < VUT_COUNT) {
+    req_stats.calls[req->source.kind]++;
+  }
+
+  eval = tri_req_present(nmap, context, other_context, req);
 
   if (eval == TRI_MAYBE) {
     if (prob_type == RPT_POSSIBLE) {
@@ -6694,8 +6902,7 @@ enum fc_tristate tri_req_present(const struct civ_map *nmap,
 
   fc_assert_ret_val(req_definitions[req->source.kind].cb != nullptr, TRI_NO);
 
-  return req_definitions[req->source.kind].cb(nmap, context,
-                                              other_context, req);
+  return req_present_memo(nmap, context, other_context, req);
 }
 
 /**********************************************************************//**
@@ -6746,8 +6953,34 @@ bool are_reqs_active(const struct req_context *context,
                      const struct requirement_vector *reqs,
                      const enum   req_problem_type prob_type)
 {
+  const struct civ_map *nmap = &(wld.map);
+
+  if (context == nullptr) {
+    context = req_context_empty();
+  }
+  if (other_context == nullptr) {
+    other_context = req_context_empty();
+  }
+
+  /* Flat evaluation loop; compiled vectors (see
+   * requirement_vector_compile()) have their cheap requirements first,
+   * so expensive ones are often short-circuited away. */
   requirement_vector_iterate(reqs, preq) {
-    if (!is_req_active(context, other_context, preq, prob_type)) {
+    enum fc_tristate eval;
+
+    if (preq->source.kind >= VUT_COUNT
+        || req_definitions[preq->source.kind].cb == nullptr) {
+      log_error("are_reqs_active(): invalid source kind %d.",
+                preq->source.kind);
+      return FALSE;
+    }
+
+    eval = req_present_memo(nmap, context, other_context, preq);
+    if (eval == TRI_MAYBE) {
+      if (prob_type != RPT_POSSIBLE) {
+        return FALSE;
+      }
+    } else if (preq->present ? (eval == TRI_NO) : (eval == TRI_YES)) {
       return FALSE;
     }
   } requirement_vector_iterate_end;
@@ -6755,6 +6988,208 @@ bool are_reqs_active(const struct req_context *context,
   return TRUE;
 }
 
+/**********************************************************************//**
+  Which req_context members can req not evaluate without? If any of the
+  returned bits names a member that is missing from a context, evaluating
+  req there yields TRI_MAYBE - i.e. fails under RPT_CERTAIN - so callers
+  may skip the evaluation entirely. Conservative: bits are only set for
+  kind/range combinations where that implication is certain, everything
+  else returns 0.
+**************************************************************************/
+unsigned requirement_context_mask(const struct requirement *req)
+{
+  switch (req->source.kind) {
+  case VUT_UTYPE:
+  case VUT_UTFLAG:
+  case VUT_UCLASS:
+  case VUT_UCFLAG:
+    switch (req->range) {
+    case REQ_RANGE_LOCAL:
+      return REQF_UNITTYPE;
+    case REQ_RANGE_TILE:
+    case REQ_RANGE_CADJACENT:
+    case REQ_RANGE_ADJACENT:
+      return REQF_TILE;
+    default:
+      return 0;
+    }
+  case VUT_UNITSTATE:
+  case VUT_MINVETERAN:
+  case VUT_MINMOVES:
+  case VUT_MINHP:
+    return REQF_UNIT;
+  case VUT_GOVERNMENT:
+  case VUT_AI_LEVEL:
+  case VUT_ADVANCE:
+  case VUT_TECHFLAG:
+    return REQF_PLAYER;
+  case VUT_MINSIZE:
+  case VUT_NATIONALITY:
+  case VUT_MINFOREIGNPCT:
+  case VUT_CITYSTATUS:
+    return REQF_CITY;
+  case VUT_MINCULTURE:
+    switch (req->range) {
+    case REQ_RANGE_CITY:
+    case REQ_RANGE_TRADE_ROUTE:
+      return REQF_CITY;
+    case REQ_RANGE_PLAYER:
+    case REQ_RANGE_TEAM:
+    case REQ_RANGE_ALLIANCE:
+    case REQ_RANGE_WORLD:
+      return REQF_PLAYER;
+    default:
+      return 0;
+    }
+  case VUT_TERRAIN:
+  case VUT_TERRAINCLASS:
+  case VUT_TERRFLAG:
+    switch (req->range) {
+    case REQ_RANGE_TILE:
+    case REQ_RANGE_CADJACENT:
+    case REQ_RANGE_ADJACENT:
+      return REQF_TILE;
+    default:
+      return 0;
+    }
+  case VUT_OTYPE:
+    /* Missing output evaluates to TRI_NO, not TRI_MAYBE, so skipping is
+     * only equivalent for present requirements. */
+    return req->present ? REQF_OUTPUT : 0;
+  case VUT_SPECIALIST:
+    return req->present ? REQF_SPECIALIST : 0;
+  default:
+    return 0;
+  }
+}
+
+/**********************************************************************//**
+  The REQF_* bits for the members context does provide.
+**************************************************************************/
+unsigned req_context_present_mask(const struct req_context *context)
+{
+  unsigned mask = 0;
+
+  if (context == nullptr) {
+    return 0;
+  }
+
+  if (context->player != nullptr) {
+    mask |= REQF_PLAYER;
+  }
+  if (context->city != nullptr) {
+    mask |= REQF_CITY;
+  }
+  if (context->tile != nullptr) {
+    mask |= REQF_TILE;
+  }
+  if (context->unit != nullptr) {
+    mask |= REQF_UNIT;
+  }
+  if (context->unittype != nullptr) {
+    mask |= REQF_UNITTYPE;
+  }
+  if (context->output != nullptr) {
+    mask |= REQF_OUTPUT;
+  }
+  if (context->specialist != nullptr) {
+    mask |= REQF_SPECIALIST;
+  }
+
+  return mask;
+}
+
+/**********************************************************************//**
+  Is req provably satisfied in every context and game state, so that a
+  compiled requirement vector can drop it altogether?
+**************************************************************************/
+static bool req_is_constant_true(const struct requirement *req)
+{
+  if (!req->present) {
+    return FALSE;
+  }
+
+  switch (req->source.kind) {
+  case VUT_MINTECHS:
+    /* The world range count never drops below zero. Other ranges need
+     * a player in the context and so cannot be folded. */
+    return (req->range == REQ_RANGE_WORLD
+            && req->source.value.min_techs <= 0);
+  default:
+    return FALSE;
+  }
+}
+
+/**********************************************************************//**
+  Rough evaluation cost class of a requirement, used to order compiled
+  vectors. Only relative magnitudes matter.
+**************************************************************************/
+static int req_eval_cost(const struct requirement *req)
+{
+  switch (req->source.kind) {
+  case VUT_OTYPE:
+  case VUT_SPECIALIST:
+  case VUT_TOPO:
+  case VUT_WRAP:
+  case VUT_MINYEAR:
+  case VUT_MINCALFRAG:
+  case VUT_SERVERSETTING:
+    /* Globals and trivial comparisons. */
+    return 0;
+  default:
+    break;
+  }
+
+  switch (req->range) {
+  case REQ_RANGE_LOCAL:
+  case REQ_RANGE_TILE:
+    return 1;
+  case REQ_RANGE_CITY:
+  case REQ_RANGE_PLAYER:
+    return 2;
+  case REQ_RANGE_CADJACENT:
+  case REQ_RANGE_ADJACENT:
+    /* Walks the adjacent tiles. */
+    return 3;
+  default:
+    /* Trade route, continent, team, alliance and world ranges may have
+     * to scan whole city, player or tile lists. */
+    return 4;
+  }
+}
+
+/**********************************************************************//**
+  Compile a requirement vector for fast evaluation: fold away
+  requirements that are satisfied in any context and order the rest by
+  rough evaluation cost, giving cheap requirements the chance to
+  short-circuit expensive ones. Reordering is semantics neutral since
+  are_reqs_active() is a plain conjunction; the insertion sort is stable,
+  keeping equal-cost requirements in ruleset order.
+**************************************************************************/
+void requirement_vector_compile(struct requirement_vector *vec)
+{
+  size_t i;
+
+  for (i = requirement_vector_size(vec); i > 0; i--) {
+    if (req_is_constant_true(requirement_vector_get(vec, i - 1))) {
+      requirement_vector_remove(vec, i - 1);
+    }
+  }
+
+  for (i = 1; i < requirement_vector_size(vec); i++) {
+    struct requirement key = *requirement_vector_get(vec, i);
+    int cost = req_eval_cost(&key);
+    size_t j = i;
+
+    while (j > 0
+           && req_eval_cost(requirement_vector_get(vec, j - 1)) > cost) {
+      *requirement_vector_get(vec, j) = *requirement_vector_get(vec, j - 1);
+      j--;
+    }
+    *requirement_vector_get(vec, j) = key;
+  }
+}
+
 /**********************************************************************//**
   Like are_reqs_active() but checks only requirements that have
   one of the ranges between min_range and max_range.
@@ -6777,6 +7212,94 @@ bool are_reqs_active_ranges(const enum req_range min_range,
   return TRUE;
 }
 
+/**********************************************************************//**
+  Like are_reqs_active(), evaluated against a whole range of tiles in one
+  sweep. Bit i of result is set iff reqs are all active in context with
+  its tile member replaced by tiles[i]. result must have been initialized
+  to hold at least ntiles bits.
+
+  Requirements at player range and above cannot read the tile, so they
+  are evaluated once for the whole batch. The remaining requirements are
+  swept requirement-major, each one walking the tile array while its
+  source data is hot, instead of re-dispatching the full vector per tile.
+**************************************************************************/
+void are_reqs_active_tiles(const struct req_context *context,
+                           const struct req_context *other_context,
+                           const struct requirement_vector *reqs,
+                           const enum req_problem_type prob_type,
+                           struct tile *const *tiles, int ntiles,
+                           struct dbv *result)
+{
+  const struct civ_map *nmap = &(wld.map);
+  int i;
+
+  if (context == nullptr) {
+    context = req_context_empty();
+  }
+  if (other_context == nullptr) {
+    other_context = req_context_empty();
+  }
+
+  dbv_clr_all(result);
+
+  /* Tile independent requirements settle the whole batch at once. */
+  requirement_vector_iterate(reqs, preq) {
+    if (preq->source.kind >= VUT_COUNT
+        || req_definitions[preq->source.kind].cb == nullptr) {
+      log_error("are_reqs_active_tiles(): invalid source kind %d.",
+                preq->source.kind);
+      return;
+    }
+
+    if (preq->range >= REQ_RANGE_PLAYER) {
+      enum fc_tristate eval = req_present_memo(nmap, context, other_context,
+                                               preq);
+
+      if (eval == TRI_MAYBE) {
+        if (prob_type != RPT_POSSIBLE) {
+          return;
+        }
+      } else if (preq->present ? (eval == TRI_NO) : (eval == TRI_YES)) {
+        return;
+      }
+    }
+  } requirement_vector_iterate_end;
+
+  for (i = 0; i < ntiles; i++) {
+    dbv_set(result, i);
+  }
+
+  {
+    /* Initialized, not assigned - req_context has a const member. */
+    struct req_context tile_ctx = *context;
+
+    requirement_vector_iterate(reqs, preq) {
+      if (preq->range >= REQ_RANGE_PLAYER) {
+        /* Already covered above. */
+        continue;
+      }
+
+      for (i = 0; i < ntiles; i++) {
+        enum fc_tristate eval;
+
+        if (!dbv_isset(result, i)) {
+          continue;
+        }
+
+        tile_ctx.tile = tiles[i];
+        eval = tri_req_present(nmap, &tile_ctx, other_context, preq);
+        if (eval == TRI_MAYBE) {
+          if (prob_type != RPT_POSSIBLE) {
+            dbv_clr(result, i);
+          }
+        } else if (preq->present ? (eval == TRI_NO) : (eval == TRI_YES)) {
+          dbv_clr(result, i);
+        }
+      }
+    } requirement_vector_iterate_end;
+  }
+}
+
 /**********************************************************************//**
   For requirements changing with time, will they be active for the target
   after pass in period turns if nothing else changes?
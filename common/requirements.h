@@ -23,6 +23,7 @@ extern "C" {
 #include "map_types.h"
 
 struct astring;
+struct dbv;
 
 /* Range of requirements.
  * Used in the network protocol.
@@ -113,6 +114,19 @@ struct req_context {
   const enum unit_activity activity;
 };
 
+/* Bits naming req_context members a requirement cannot evaluate
+ * without; see requirement_context_mask(). */
+#define REQF_PLAYER      (1u << 0)
+#define REQF_CITY        (1u << 1)
+#define REQF_TILE        (1u << 2)
+#define REQF_UNIT        (1u << 3)
+#define REQF_UNITTYPE    (1u << 4)
+#define REQF_OUTPUT      (1u << 5)
+#define REQF_SPECIALIST  (1u << 6)
+
+unsigned requirement_context_mask(const struct requirement *req);
+unsigned req_context_present_mask(const struct req_context *context);
+
 enum req_unchanging_status {
   REQUCH_NO = 0, /* Changes regularly */
   REQUCH_CTRL, /* Can't be changed by game means as long as target player
@@ -184,6 +198,21 @@ bool are_reqs_active_ranges(const enum req_range min_range,
                             const struct req_context *other_context,
                             const struct requirement_vector *reqs,
                             const enum   req_problem_type prob_type);
+void are_reqs_active_tiles(const struct req_context *context,
+                           const struct req_context *other_context,
+                           const struct requirement_vector *reqs,
+                           const enum req_problem_type prob_type,
+                           struct tile *const *tiles, int ntiles,
+                           struct dbv *result);
+void requirement_vector_compile(struct requirement_vector *vec);
+void requirement_memo_reset(void);
+void requirement_memo_freeze(bool frozen);
+void requirement_stats_turn(void);
+void requirement_stats_clear(void);
+void requirement_stats_get(enum universals_n kind,
+                           size_t *calls, size_t *turn_calls);
+void requirement_stats_memo(size_t *hits, size_t *misses,
+                            size_t *turn_hits, size_t *turn_misses);
 enum fc_tristate
 tri_req_active_turns(int pass, int period,
                      const struct req_context *context,
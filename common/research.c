@@ -22,6 +22,7 @@
 #include "support.h"
 
 /* common */
+#include "effects.h"
 #include "fc_types.h"
 #include "game.h"
 #include "nation.h"
@@ -494,57 +495,134 @@ static bool research_get_root_reqs_known(const struct research *presearch,
   return TRUE;
 }
 
+/************************************************************************//**
+  Returns TRUE iff any advance of the current ruleset has research_reqs.
+  Such requirements may flip with about any change of the game state, so
+  tech states cached by a previous update cannot be trusted.
+
+  Helper for research_update().
+****************************************************************************/
+static bool research_update_rreqs_volatile(void)
+{
+  advance_iterate(padv) {
+    if (requirement_vector_size(&padv->research_reqs) > 0) {
+      return TRUE;
+    }
+  } advance_iterate_end;
+
+  return FALSE;
+}
+
 /************************************************************************//**
   Mark as TECH_PREREQS_KNOWN each tech which is available, not known and
   which has all requirements fulfilled.
 
   Recalculate presearch->num_known_tech_with_flag
   Should always be called after research_invention_set().
+
+  When the only changes since the previous update are techs becoming
+  known, only the techs requiring them are re-evaluated; the rest keep
+  their cached reachability and state. Any harder change - tech loss, a
+  change of the players sharing the research, research_reqs that depend
+  on the game state - falls back to the full recompute.
 ****************************************************************************/
 void research_update(struct research *presearch)
 {
   enum tech_flag_id flag;
   int techs_researched;
+  int players_num = 0;
+  int gained_num = 0;
+  Tech_type_id gained[game.control.num_tech_types];
+  bool full;
   Tech_type_id ac = advance_count();
 
+  /* research_allowed() depends on which players share the research; for
+   * a dead player it iterates over zero players and allows nothing. */
+  research_players_iterate(presearch, pplayer) {
+    (void) pplayer; /* Compiler wants us to do something with 'pplayer'. */
+    players_num++;
+  } research_players_iterate_end;
+
+  /* Diffing the states against the snapshot of the previous update
+   * catches every writer, also the ones not going through
+   * research_invention_set(). */
+  full = (!presearch->update_cache_valid
+          || players_num != presearch->update_prev_players
+          || research_update_rreqs_volatile());
+  advance_index_iterate_max(A_FIRST, i, ac) {
+    if (presearch->inventions[i].state != presearch->update_prev_state[i]) {
+      if (presearch->inventions[i].state == TECH_KNOWN) {
+        gained[gained_num++] = i;
+      } else {
+        /* Tech loss, or an external downgrade of the state. */
+        full = TRUE;
+      }
+    }
+  } advance_index_iterate_max_end;
+
   advance_index_iterate_max(A_FIRST, i, ac) {
     enum tech_state state = presearch->inventions[i].state;
-    bool root_reqs_known = TRUE;
-    bool reachable = research_get_reachable(presearch, i);
-
-    /* Finding if the root reqs of an unreachable tech isn't redundant.
-     * A tech can be unreachable via research but have known root reqs
-     * because of unfilfilled research_reqs. Unfulfilled research_reqs
-     * doesn't prevent the player from acquiring the tech by other means. */
-    root_reqs_known = research_get_root_reqs_known(presearch, i);
-
-    if (reachable) {
-      if (state != TECH_KNOWN) {
-        /* Update state. */
-        state = (root_reqs_known
-                 && (presearch->inventions[advance_required(i, AR_ONE)].state
-                     == TECH_KNOWN)
-                 && (presearch->inventions[advance_required(i, AR_TWO)].state
-                     == TECH_KNOWN)
-                 && research_is_allowed(presearch, i)
-                 ? TECH_PREREQS_KNOWN : TECH_UNKNOWN);
+    bool root_reqs_known = presearch->inventions[i].root_reqs_known;
+    bool reachable = presearch->inventions[i].reachable;
+    bool affected = full;
+
+    if (!affected) {
+      if (state != TECH_KNOWN && (!reachable || !root_reqs_known)) {
+        /* A gained tech may have opened a root requirement. */
+        affected = TRUE;
+      } else {
+        int k;
+
+        for (k = 0; k < gained_num; k++) {
+          if (gained[k] == i
+              || BV_ISSET(presearch->inventions[i].required_techs,
+                          gained[k])) {
+            affected = TRUE;
+            break;
+          }
+        }
       }
-    } else {
-      /* We used to assert here that state already is TECH_UNKNOWN. However, there is
-       * a special case where it can be e.g. TECH_PREREQS_KNOWN and still
-       * unreachable (like in above research_get_reachable() call) because
-       * player is dead. Dead player's don't research anything. More accurately
-       * research_players_iterate() for a dead player's research iterates over
-       * zero players in research_allowed(), so it falls through to default of FALSE.
-       *
-       * Now we set the state to TECH_UNKNOWN instead of asserting that it already is. */
-      state = TECH_UNKNOWN;
     }
-    presearch->inventions[i].state = state;
-    presearch->inventions[i].reachable = reachable;
-    presearch->inventions[i].root_reqs_known = root_reqs_known;
 
-    /* Updates required_techs, num_required_techs and bulbs_required. */
+    if (affected) {
+      reachable = research_get_reachable(presearch, i);
+
+      /* Finding if the root reqs of an unreachable tech isn't redundant.
+       * A tech can be unreachable via research but have known root reqs
+       * because of unfilfilled research_reqs. Unfulfilled research_reqs
+       * doesn't prevent the player from acquiring the tech by other means. */
+      root_reqs_known = research_get_root_reqs_known(presearch, i);
+
+      if (reachable) {
+        if (state != TECH_KNOWN) {
+          /* Update state. */
+          state = (root_reqs_known
+                   && (presearch->inventions[advance_required(i, AR_ONE)].state
+                       == TECH_KNOWN)
+                   && (presearch->inventions[advance_required(i, AR_TWO)].state
+                       == TECH_KNOWN)
+                   && research_is_allowed(presearch, i)
+                   ? TECH_PREREQS_KNOWN : TECH_UNKNOWN);
+        }
+      } else {
+        /* We used to assert here that state already is TECH_UNKNOWN. However, there is
+         * a special case where it can be e.g. TECH_PREREQS_KNOWN and still
+         * unreachable (like in above research_get_reachable() call) because
+         * player is dead. Dead player's don't research anything. More accurately
+         * research_players_iterate() for a dead player's research iterates over
+         * zero players in research_allowed(), so it falls through to default of FALSE.
+         *
+         * Now we set the state to TECH_UNKNOWN instead of asserting that it already is. */
+        state = TECH_UNKNOWN;
+      }
+      presearch->inventions[i].state = state;
+      presearch->inventions[i].reachable = reachable;
+      presearch->inventions[i].root_reqs_known = root_reqs_known;
+    }
+
+    /* Updates required_techs, num_required_techs and bulbs_required.
+     * Unaffected techs rebuild these too: under some tech cost styles the
+     * bulb costs change with every tech the research gains. */
     BV_CLR_ALL(presearch->inventions[i].required_techs);
     presearch->inventions[i].num_required_techs = 0;
     presearch->inventions[i].bulbs_required = 0;
@@ -573,6 +651,13 @@ void research_update(struct research *presearch)
     presearch->techs_researched = techs_researched;
   } advance_index_iterate_max_end;
 
+  /* Snapshot for the next update. */
+  advance_index_iterate_max(A_FIRST, i, ac) {
+    presearch->update_prev_state[i] = presearch->inventions[i].state;
+  } advance_index_iterate_max_end;
+  presearch->update_prev_players = players_num;
+  presearch->update_cache_valid = TRUE;
+
 #ifdef FREECIV_DEBUG
   advance_index_iterate_max(A_FIRST, i, ac) {
     char buf[advance_count() + 1];
@@ -651,6 +736,10 @@ enum tech_state research_invention_set(struct research *presearch,
   }
   presearch->inventions[tech].state = value;
 
+  /* Tech requirements feed many effects. */
+  effect_cache_invalidate();
+  requirement_memo_reset();
+
   if (value == TECH_KNOWN) {
     if (!game.info.global_advances[tech]) {
       game.info.global_advances[tech] = TRUE;
@@ -87,6 +87,14 @@ struct research {
    */
   int num_known_tech_with_flag[TF_COUNT];
 
+  /* Bookkeeping for the incremental mode of research_update(): the tech
+   * states as they were after the previous update, and the number of
+   * players that were then sharing the research. Only meaningful while
+   * 'update_cache_valid' is set. */
+  enum tech_state update_prev_state[A_ARRAY_SIZE];
+  int update_prev_players;
+  bool update_cache_valid;
+
   union {
     /* Add server side when needed */
 
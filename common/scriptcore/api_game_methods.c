@@ -1031,6 +1031,49 @@ City_List_Link *api_methods_private_player_city_list_head(lua_State *L,
   return city_list_head(pplayer->cities);
 }
 
+/**********************************************************************//**
+  Return packed data for all units of Player: a table with the parallel
+  arrays 'id', 'tile' and 'utype' holding unit id, tile index and unit
+  type id. Unlike units_iterate(), this creates no Unit objects, so bulk
+  scans do not churn the garbage collector.
+**************************************************************************/
+lua_Object api_methods_private_player_unit_data(lua_State *L,
+                                                Player *pplayer)
+{
+  lua_Object result = 0;
+  lua_Object ids, tindices, utypes;
+  int size, n = 0;
+
+  LUASCRIPT_CHECK_STATE(L, 0);
+  LUASCRIPT_CHECK_SELF(L, pplayer, 0);
+
+  size = unit_list_size(pplayer->units);
+  lua_createtable(L, 0, 3);
+  result = lua_gettop(L);
+  lua_createtable(L, size, 0);
+  ids = lua_gettop(L);
+  lua_createtable(L, size, 0);
+  tindices = lua_gettop(L);
+  lua_createtable(L, size, 0);
+  utypes = lua_gettop(L);
+
+  unit_list_iterate(pplayer->units, punit) {
+    n++;
+    lua_pushinteger(L, punit->id);
+    lua_rawseti(L, ids, n);
+    lua_pushinteger(L, tile_index(unit_tile(punit)));
+    lua_rawseti(L, tindices, n);
+    lua_pushinteger(L, utype_number(unit_type_get(punit)));
+    lua_rawseti(L, utypes, n);
+  } unit_list_iterate_end;
+
+  lua_setfield(L, result, "utype");
+  lua_setfield(L, result, "tile");
+  lua_setfield(L, result, "id");
+
+  return result;
+}
+
 /**********************************************************************//**
   Return rule name for Tech_Type
 **************************************************************************/
@@ -1505,6 +1548,60 @@ Tile *api_methods_private_tile_for_outward_index(lua_State *L,
   return map_pos_to_tile(&(wld.map), newx, newy);
 }
 
+/**********************************************************************//**
+  Return packed data for 'count' tiles starting at tile index
+  'start_index': a table with the parallel arrays 'index', 'terrain' and
+  'owner' holding tile index, terrain id and owner player id (-1 when
+  unowned). The range is clipped to the map size, so callers can walk the
+  whole map in fixed-size chunks without creating Tile objects.
+**************************************************************************/
+lua_Object api_methods_private_map_tile_data(lua_State *L,
+                                             int start_index, int count)
+{
+  lua_Object result = 0;
+  lua_Object tindices, terrains, owners;
+  int stop, i, n = 0;
+
+  LUASCRIPT_CHECK_STATE(L, 0);
+  LUASCRIPT_CHECK_ARG(L, start_index >= 0 && start_index < MAP_INDEX_SIZE,
+                      2, "index out of bounds", 0);
+  LUASCRIPT_CHECK_ARG(L, count >= 0, 3, "negative count", 0);
+
+  stop = start_index + count;
+  if (stop > MAP_INDEX_SIZE) {
+    stop = MAP_INDEX_SIZE;
+  }
+
+  lua_createtable(L, 0, 3);
+  result = lua_gettop(L);
+  lua_createtable(L, stop - start_index, 0);
+  tindices = lua_gettop(L);
+  lua_createtable(L, stop - start_index, 0);
+  terrains = lua_gettop(L);
+  lua_createtable(L, stop - start_index, 0);
+  owners = lua_gettop(L);
+
+  for (i = start_index; i < stop; i++) {
+    struct tile *ptile = index_to_tile(&(wld.map), i);
+    struct terrain *pterr = tile_terrain(ptile);
+    struct player *powner = tile_owner(ptile);
+
+    n++;
+    lua_pushinteger(L, i);
+    lua_rawseti(L, tindices, n);
+    lua_pushinteger(L, pterr != nullptr ? terrain_number(pterr) : -1);
+    lua_rawseti(L, terrains, n);
+    lua_pushinteger(L, powner != nullptr ? player_number(powner) : -1);
+    lua_rawseti(L, owners, n);
+  }
+
+  lua_setfield(L, result, "owner");
+  lua_setfield(L, result, "terrain");
+  lua_setfield(L, result, "index");
+
+  return result;
+}
+
 /**********************************************************************//**
   Return squared distance between tiles 1 and 2
 **************************************************************************/
@@ -119,6 +119,8 @@ Unit_List_Link *api_methods_private_player_unit_list_head(lua_State *L,
                                                           Player *pplayer);
 City_List_Link *api_methods_private_player_city_list_head(lua_State *L,
                                                           Player *pplayer);
+lua_Object api_methods_private_player_unit_data(lua_State *L,
+                                                Player *pplayer);
 int api_methods_player_culture_get(lua_State *L, Player *pplayer);
 
 bool api_methods_player_has_flag(lua_State *L, Player *pplayer, const char *flag);
@@ -194,6 +196,8 @@ Tile *api_methods_private_tile_for_outward_index(lua_State *L, Tile *pstart,
                                                  int tindex);
 Unit_List_Link *api_methods_private_tile_unit_list_head(lua_State *L,
                                                         Tile *ptile);
+lua_Object api_methods_private_map_tile_data(lua_State *L,
+                                             int start_index, int count);
 bool api_methods_tile_known(lua_State *L, Tile *self, Player *watcher);
 bool api_methods_tile_seen(lua_State *L, Tile *self, Player *watcher);
 
@@ -16,6 +16,7 @@
 #endif
 
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
@@ -26,7 +27,10 @@
 /* utility */
 #include "astring.h"
 #include "log.h"
+#include "mem.h"
 #include "registry.h"
+#include "shared.h"
+#include "support.h"
 
 /* common */
 #include "map.h"
@@ -64,6 +68,11 @@
 #define LUASCRIPT_SECURE_LUA_VERSION1 504
 #define LUASCRIPT_SECURE_LUA_VERSION2 505
 
+/* LuaJIT implements the Lua 5.1 API. The build opens neither the
+ * package library nor LuaJIT's ffi or jit modules, so the sandbox
+ * surface stays within the audited symbol set below. */
+#define LUASCRIPT_SECURE_LUAJIT_VERSION 501
+
 static const char *luascript_unsafe_symbols_secure[] = {
   "debug",
   "dofile",
@@ -78,7 +87,8 @@ static const char *luascript_unsafe_symbols_permissive[] = {
   nullptr
 };
 
-#if LUA_VERSION_NUM != LUASCRIPT_SECURE_LUA_VERSION1 && LUA_VERSION_NUM != LUASCRIPT_SECURE_LUA_VERSION2
+#if LUA_VERSION_NUM != LUASCRIPT_SECURE_LUA_VERSION1 && LUA_VERSION_NUM != LUASCRIPT_SECURE_LUA_VERSION2 \
+  && !(defined(FREECIV_USING_LUAJIT) && LUA_VERSION_NUM == LUASCRIPT_SECURE_LUAJIT_VERSION)
 #warning "The script runtime's unsafe symbols information is not up to date."
 #warning "This can be a big security hole!"
 #endif
@@ -113,10 +123,54 @@ static luaL_Reg luascript_lualibs_permissive[] = {
   {LUA_OSLIBNAME, luaopen_os},
   {nullptr, nullptr}
 };
+#elif defined(FREECIV_USING_LUAJIT) && LUA_VERSION_NUM == 501
+/* LuaJIT: 5.1 library set - no separate coroutine or utf8 modules.
+ * ffi and jit are deliberately never opened; the former would let a
+ * script escape the sandbox entirely. */
+static luaL_Reg luascript_lualibs_secure[] = {
+  /* Using default libraries excluding: package, io, os, bit, ffi, jit */
+  {"_G", luaopen_base},
+  {LUA_TABLIBNAME, luaopen_table},
+  {LUA_STRLIBNAME, luaopen_string},
+  {LUA_MATHLIBNAME, luaopen_math},
+  {LUA_DBLIBNAME, luaopen_debug},
+  {nullptr, nullptr}
+};
+
+static luaL_Reg luascript_lualibs_permissive[] = {
+  /* Using default libraries excluding: package, bit, ffi, jit */
+  {"_G", luaopen_base},
+  {LUA_TABLIBNAME, luaopen_table},
+  {LUA_STRLIBNAME, luaopen_string},
+  {LUA_MATHLIBNAME, luaopen_math},
+  {LUA_DBLIBNAME, luaopen_debug},
+  {LUA_IOLIBNAME, luaopen_io},
+  {LUA_OSLIBNAME, luaopen_os},
+  {nullptr, nullptr}
+};
 #else  /* LUA_VERSION_NUM */
 #error "Unsupported lua version"
 #endif /* LUA_VERSION_NUM */
 
+#ifdef FREECIV_USING_LUAJIT
+/**********************************************************************//**
+  LuaJIT provides the Lua 5.1 auxlib; supply the luaL_requiref() the
+  scriptcore uses to open libraries. 5.1 openers register their module
+  globally themselves, so this only runs the opener and leaves one
+  value for the caller to pop, like the real luaL_requiref() does.
+**************************************************************************/
+static void luaL_requiref(lua_State *L, const char *modname,
+                          lua_CFunction openf, int glb)
+{
+  (void) glb;
+
+  lua_pushcfunction(L, openf);
+  lua_pushstring(L, modname);
+  lua_call(L, 1, 0);
+  lua_pushboolean(L, 1);
+}
+#endif /* FREECIV_USING_LUAJIT */
+
 static int luascript_report(struct fc_lua *fcl, int status, const char *code);
 static void luascript_traceback_func_save(lua_State *L);
 static void luascript_traceback_func_push(lua_State *L);
@@ -631,23 +685,183 @@ int luascript_do_string(struct fc_lua *fcl, const char *str,
   return status;
 }
 
+/* Compiled bytecode cache. Scripts loaded through luascript_do_file()
+ * - script.lua, the ruleset script files and scenario scripts - are
+ * compiled from text at every server start and every scenario switch.
+ * After the first compile the lua_dump() output is stored under the
+ * freeciv storage directory, keyed by a hash of the source text, so
+ * later loads of an unchanged file hand the bytecode straight to the
+ * Lua runtime. A changed file hashes to a different key and is simply
+ * compiled and cached anew; stale entries are never read again. */
+
+/**********************************************************************//**
+  lua_Writer callback appending dumped bytecode to a FILE.
+**************************************************************************/
+static int luascript_bytecode_writer(lua_State *L, const void *p,
+                                     size_t size, void *ud)
+{
+  (void) L;
+
+  return fwrite(p, 1, size, (FILE *) ud) == size ? 0 : 1;
+}
+
 /**********************************************************************//**
-  Parse and execute the script at filename.
+  Read the whole file at 'filename' into a malloced, zero-terminated
+  buffer and set '*size' to its length. Returns nullptr when the file
+  cannot be read.
+**************************************************************************/
+static char *luascript_file_read(const char *filename, size_t *size)
+{
+  FILE *fp = fc_fopen(filename, "rb");
+  char *buf;
+  long len;
+
+  *size = 0;
+  if (fp == nullptr) {
+    return nullptr;
+  }
+  if (fseek(fp, 0, SEEK_END) != 0 || (len = ftell(fp)) < 0
+      || fseek(fp, 0, SEEK_SET) != 0) {
+    fclose(fp);
+    return nullptr;
+  }
+  buf = fc_malloc(len + 1);
+  if (len > 0 && fread(buf, 1, len, fp) != (size_t) len) {
+    free(buf);
+    fclose(fp);
+    return nullptr;
+  }
+  fclose(fp);
+  buf[len] = '\0';
+  *size = len;
+
+  return buf;
+}
+
+/**********************************************************************//**
+  Write the bytecode cache path for a source buffer to 'buf'. The key
+  combines an FNV-1a hash of the source text with its length and the
+  Lua version number; Lua bytecode is not portable between versions.
+**************************************************************************/
+static void luascript_bytecode_path(char *buf, size_t buf_len,
+                                    const char *src, size_t size)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  size_t i;
+
+  for (i = 0; i < size; i++) {
+    hash ^= (unsigned char) src[i];
+    hash *= 1099511628211ULL;
+  }
+
+  fc_snprintf(buf, buf_len, "%s" DIR_SEPARATOR "luacache" DIR_SEPARATOR
+              "%016llx-%lu-%d.luac", freeciv_storage_dir(), hash,
+              (unsigned long) size, LUA_VERSION_NUM);
+}
+
+/**********************************************************************//**
+  Dump the compiled chunk on top of the stack to the cache file at
+  'path', via a temporary file so an interrupted write cannot leave a
+  truncated entry behind. Failing to write the cache is harmless; the
+  chunk on the stack is left untouched either way.
+**************************************************************************/
+static void luascript_bytecode_store(lua_State *L, const char *path)
+{
+  char tmp[600];
+  FILE *fp;
+  int status;
+
+  fc_snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  if (!make_dir_for_file(tmp)) {
+    return;
+  }
+
+  fp = fc_fopen(tmp, "wb");
+  if (fp == nullptr) {
+    return;
+  }
+
+#ifdef FREECIV_USING_LUAJIT
+  /* LuaJIT keeps the 5.1 lua_dump() signature without the strip arg */
+  status = lua_dump(L, luascript_bytecode_writer, fp);
+#else
+  status = lua_dump(L, luascript_bytecode_writer, fp, 0);
+#endif
+  if (fclose(fp) != 0 || status != 0 || rename(tmp, path) != 0) {
+    fc_remove(tmp);
+  }
+}
+
+/**********************************************************************//**
+  Parse and execute the script at filename. Compiled bytecode is cached
+  across runs; see the comment block above.
 **************************************************************************/
 int luascript_do_file(struct fc_lua *fcl, const char *filename)
 {
   int status;
+  char *src;
+  size_t size;
 
   fc_assert_ret_val(fcl, -1);
   fc_assert_ret_val(fcl->state, -1);
 
-  status = luaL_loadfile(fcl->state, filename);
-  if (status) {
-    luascript_report(fcl, status, nullptr);
+  src = luascript_file_read(filename, &size);
+  if (src == nullptr) {
+    /* Unreadable file; let luaL_loadfile() produce the usual error. */
+    status = luaL_loadfile(fcl->state, filename);
+    if (status) {
+      luascript_report(fcl, status, nullptr);
+      return status;
+    }
   } else {
-    status = luascript_call(fcl, 0, 0, nullptr);
+    char name[600];
+    char path[600];
+    char *bc;
+    size_t bc_size;
+    bool loaded = FALSE;
+
+    /* Chunk name in the format luaL_loadfile() uses, so tracebacks
+     * still point at the source file. */
+    fc_snprintf(name, sizeof(name), "@%s", filename);
+    luascript_bytecode_path(path, sizeof(path), src, size);
+
+    bc = luascript_file_read(path, &bc_size);
+    if (bc != nullptr) {
+      if (bc_size > 0
+          && 0 == luaL_loadbufferx(fcl->state, bc, bc_size, name, "b")) {
+        loaded = TRUE;
+      } else if (bc_size > 0) {
+        /* Corrupt cache entry; drop the load error and recompile. */
+        lua_pop(fcl->state, 1);
+      }
+      free(bc);
+    }
+
+    if (!loaded) {
+      const char *chunk = src;
+      size_t chunk_size = size;
+
+      /* Skip a leading '#' line like luaL_loadfile() does, keeping the
+       * newline so line numbers are unchanged. */
+      if (chunk_size > 0 && chunk[0] == '#') {
+        while (chunk_size > 0 && *chunk != '\n') {
+          chunk++;
+          chunk_size--;
+        }
+      }
+
+      status = luaL_loadbufferx(fcl->state, chunk, chunk_size, name, "t");
+      if (status) {
+        luascript_report(fcl, status, src);
+        free(src);
+        return status;
+      }
+      luascript_bytecode_store(fcl->state, path);
+    }
+    free(src);
   }
-  return status;
+
+  return luascript_call(fcl, 0, 0, nullptr);
 }
 
 
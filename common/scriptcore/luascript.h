@@ -41,6 +41,8 @@ typedef void (*luascript_log_func_t) (struct fc_lua *fcl,
                                       const char *format, ...)
              fc__attribute((__format__ (__printf__, 3, 4)));
 
+struct signal;
+
 struct fc_lua {
   lua_State *state;
 
@@ -52,6 +54,10 @@ struct fc_lua {
 
   struct luascript_signal_hash *signals;
   struct luascript_signal_name_list *signal_names;
+  /* Signals indexed by the integer id handed out at creation time, for
+   * direct dispatch without the name hash; see luascript_signal_id(). */
+  struct signal **signals_by_id;
+  int signal_count;
 };
 
 /* Error functions for lua scripts. */
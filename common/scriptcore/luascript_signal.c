@@ -42,6 +42,7 @@
 #endif
 
 #include <stdarg.h>
+#include <time.h>
 
 /* utility */
 #include "deprecations.h"
@@ -73,6 +74,7 @@ static void signal_destroy(struct signal *psignal);
 
 /* Signal datastructure. */
 struct signal {
+  int id;                                 /* Index in fcl->signals_by_id */
   int nargs;                              /* Number of arguments to pass */
   enum api_types *arg_types;              /* Argument types */
   struct signal_callback_list *callbacks; /* Connected callbacks */
@@ -82,8 +84,15 @@ struct signal {
 /* Signal callback datastructure. */
 struct signal_callback {
   char *name;                             /* callback function name */
+  int invocations;                        /* Times the callback has run */
+  double total_time;                      /* Accumulated CPU time, seconds */
+  double max_time;                        /* Slowest single run, seconds */
 };
 
+/* Per-handler execution time budget, in seconds. A single callback run
+ * exceeding it is logged as a warning; zero disables the check. */
+static double signal_time_budget = 0.0;
+
 /*****************************************************************************
   Signal hash table.
 *****************************************************************************/
@@ -116,6 +125,9 @@ static struct signal_callback *signal_callback_new(const char *name)
   struct signal_callback *pcallback = fc_malloc(sizeof(*pcallback));
 
   pcallback->name = fc_strdup(name);
+  pcallback->invocations = 0;
+  pcallback->total_time = 0.0;
+  pcallback->max_time = 0.0;
   return pcallback;
 }
 
@@ -163,6 +175,44 @@ static void signal_destroy(struct signal *psignal)
   free(psignal);
 }
 
+/**********************************************************************//**
+  Invoke all the callback functions attached to 'psignal'.
+**************************************************************************/
+static void signal_emit_valist(struct fc_lua *fcl, struct signal *psignal,
+                               va_list args)
+{
+  signal_callback_list_iterate(psignal->callbacks, pcallback) {
+    va_list args_cb;
+    clock_t clk = clock();
+    double seconds;
+    bool stop;
+
+    va_copy(args_cb, args);
+    stop = luascript_callback_invoke(fcl, pcallback->name, psignal->nargs,
+                                     psignal->arg_types, args_cb);
+    va_end(args_cb);
+
+    seconds = (double)(clock() - clk) / CLOCKS_PER_SEC;
+    pcallback->invocations++;
+    pcallback->total_time += seconds;
+    if (seconds > pcallback->max_time) {
+      pcallback->max_time = seconds;
+    }
+    if (signal_time_budget > 0 && seconds > signal_time_budget) {
+      luascript_log(fcl, LOG_WARN,
+                    "Lua callback \"%s\" for signal \"%s\" ran %.1f ms "
+                    "(budget %.1f ms).",
+                    pcallback->name,
+                    luascript_signal_by_index(fcl, psignal->id),
+                    seconds * 1000.0, signal_time_budget * 1000.0);
+    }
+
+    if (stop) {
+      break;
+    }
+  } signal_callback_list_iterate_end;
+}
+
 /**********************************************************************//**
   Invoke all the callback functions attached to a given signal.
 **************************************************************************/
@@ -176,17 +226,9 @@ void luascript_signal_emit_valist(struct fc_lua *fcl,
   fc_assert_ret(fcl->signals);
 
   if (luascript_signal_hash_lookup(fcl->signals, signal_name, &psignal)) {
-    signal_callback_list_iterate(psignal->callbacks, pcallback) {
-      va_list args_cb;
-
-      va_copy(args_cb, args);
-      if (luascript_callback_invoke(fcl, pcallback->name, psignal->nargs,
-                                    psignal->arg_types, args_cb)) {
-        va_end(args_cb);
-        break;
-      }
-      va_end(args_cb);
-    } signal_callback_list_iterate_end;
+    if (signal_callback_list_size(psignal->callbacks) > 0) {
+      signal_emit_valist(fcl, psignal, args);
+    }
   } else {
     luascript_log(fcl, LOG_ERROR, "Signal \"%s\" does not exist, so cannot "
                                   "be invoked.", signal_name);
@@ -206,6 +248,60 @@ void luascript_signal_emit(struct fc_lua *fcl,
   va_end(args);
 }
 
+/**********************************************************************//**
+  Return the integer id of the signal named 'signal_name', or -1 if no
+  such signal exists. Ids are assigned in creation order, so they are
+  stable for the lifetime of the scripting state and can be resolved
+  once and cached by hot emission paths.
+**************************************************************************/
+int luascript_signal_id(struct fc_lua *fcl, const char *signal_name)
+{
+  struct signal *psignal;
+
+  fc_assert_ret_val(fcl != nullptr, -1);
+  fc_assert_ret_val(fcl->signals != nullptr, -1);
+
+  if (luascript_signal_hash_lookup(fcl->signals, signal_name, &psignal)) {
+    return psignal->id;
+  }
+
+  return -1;
+}
+
+/**********************************************************************//**
+  Invoke all the callback functions attached to the signal with the
+  given id. Unlike the named variants this neither hashes the name nor
+  touches the Lua machinery when nothing is connected - checking the
+  connected count is all an emission costs then, which is the common
+  case for most signals.
+**************************************************************************/
+void luascript_signal_emit_by_id_valist(struct fc_lua *fcl, int sid,
+                                        va_list args)
+{
+  struct signal *psignal;
+
+  fc_assert_ret(fcl);
+  fc_assert_ret(sid >= 0 && sid < fcl->signal_count);
+
+  psignal = fcl->signals_by_id[sid];
+  if (signal_callback_list_size(psignal->callbacks) > 0) {
+    signal_emit_valist(fcl, psignal, args);
+  }
+}
+
+/**********************************************************************//**
+  Invoke all the callback functions attached to the signal with the
+  given id.
+**************************************************************************/
+void luascript_signal_emit_by_id(struct fc_lua *fcl, int sid, ...)
+{
+  va_list args;
+
+  va_start(args, sid);
+  luascript_signal_emit_by_id_valist(fcl, sid, args);
+  va_end(args);
+}
+
 /**********************************************************************//**
   Create a new signal type.
 **************************************************************************/
@@ -245,6 +341,13 @@ static struct signal *luascript_signal_create_valist(struct fc_lua *fcl,
     strcpy(sn, signal_name);
     luascript_signal_name_list_append(fcl->signal_names, sn);
 
+    /* Register the signal for emit-by-id dispatch. */
+    created->id = fcl->signal_count;
+    fcl->signals_by_id
+      = fc_realloc(fcl->signals_by_id,
+                   (fcl->signal_count + 1) * sizeof(fcl->signals_by_id[0]));
+    fcl->signals_by_id[fcl->signal_count++] = created;
+
     return created;
   }
 }
@@ -421,6 +524,10 @@ void luascript_signal_free(struct fc_lua *fcl)
 
     luascript_signal_name_list_destroy(fcl->signal_names);
 
+    free(fcl->signals_by_id);
+    fcl->signals_by_id = nullptr;
+    fcl->signal_count = 0;
+
     fcl->signals = nullptr;
   }
 }
@@ -459,3 +566,63 @@ const char *luascript_signal_callback_by_index(struct fc_lua *fcl,
 
   return nullptr;
 }
+
+/**********************************************************************//**
+  Set the per-handler execution time budget, in seconds. Any single
+  callback run exceeding it is logged as a warning. Zero disables the
+  warnings.
+**************************************************************************/
+void luascript_signal_budget_set(double seconds)
+{
+  signal_time_budget = seconds;
+}
+
+/**********************************************************************//**
+  Return the current per-handler execution time budget, in seconds.
+**************************************************************************/
+double luascript_signal_budget_get(void)
+{
+  return signal_time_budget;
+}
+
+/**********************************************************************//**
+  Call 'cb' once for every callback connected to any signal, in signal
+  creation order, with the counters accumulated since the last reset.
+**************************************************************************/
+void luascript_signal_stats_iterate(struct fc_lua *fcl,
+                                    luascript_signal_stats_cb cb,
+                                    void *data)
+{
+  int i;
+
+  fc_assert_ret(fcl != nullptr);
+
+  for (i = 0; i < fcl->signal_count; i++) {
+    struct signal *psignal = fcl->signals_by_id[i];
+    const char *signal_name = luascript_signal_by_index(fcl, i);
+
+    signal_callback_list_iterate(psignal->callbacks, pcallback) {
+      cb(signal_name, pcallback->name, pcallback->invocations,
+         pcallback->total_time, pcallback->max_time, data);
+    } signal_callback_list_iterate_end;
+  }
+}
+
+/**********************************************************************//**
+  Reset the per-callback execution counters of every signal.
+**************************************************************************/
+void luascript_signal_stats_reset(struct fc_lua *fcl)
+{
+  int i;
+
+  fc_assert_ret(fcl != nullptr);
+
+  for (i = 0; i < fcl->signal_count; i++) {
+    signal_callback_list_iterate(fcl->signals_by_id[i]->callbacks,
+                                 pcallback) {
+      pcallback->invocations = 0;
+      pcallback->total_time = 0.0;
+      pcallback->max_time = 0.0;
+    } signal_callback_list_iterate_end;
+  }
+}
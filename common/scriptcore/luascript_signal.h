@@ -33,6 +33,10 @@ void luascript_signal_free(struct fc_lua *fcl);
 void luascript_signal_emit_valist(struct fc_lua *fcl,
                                   const char *signal_name, va_list args);
 void luascript_signal_emit(struct fc_lua *fcl, const char *signal_name, ...);
+int luascript_signal_id(struct fc_lua *fcl, const char *signal_name);
+void luascript_signal_emit_by_id_valist(struct fc_lua *fcl, int sid,
+                                        va_list args);
+void luascript_signal_emit_by_id(struct fc_lua *fcl, int sid, ...);
 struct signal_deprecator *luascript_signal_create(struct fc_lua *fcl,
                                                   const char *signal_name,
                                                   int nargs, ...);
@@ -50,6 +54,20 @@ const char *luascript_signal_callback_by_index(struct fc_lua *fcl,
                                                const char *signal_name,
                                                int sindex);
 
+/* Per-callback execution time accounting. */
+typedef void (*luascript_signal_stats_cb)(const char *signal_name,
+                                          const char *callback_name,
+                                          int invocations,
+                                          double total_time,
+                                          double max_time, void *data);
+
+void luascript_signal_budget_set(double seconds);
+double luascript_signal_budget_get(void);
+void luascript_signal_stats_iterate(struct fc_lua *fcl,
+                                    luascript_signal_stats_cb cb,
+                                    void *data);
+void luascript_signal_stats_reset(struct fc_lua *fcl);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -516,26 +516,12 @@ const char *get_infrastructure_text(bv_extras extras)
 
   s[0] = '\0';
 
-  extra_type_iterate(pextra) {
+  extra_set_iterate(extras, pextra) {
     if (pextra->category == ECAT_INFRA
-        && BV_ISSET(extras, extra_index(pextra))) {
-      bool hidden = FALSE;
-
-      extra_type_iterate(top) {
-        int topi = extra_index(top);
-
-        if (BV_ISSET(pextra->hidden_by, topi)
-            && BV_ISSET(extras, topi)) {
-          hidden = TRUE;
-          break;
-        }
-      } extra_type_iterate_end;
-
-      if (!hidden) {
-        cat_snprintf(s, sizeof(s), "%s/", extra_name_translation(pextra));
-      }
+        && !BV_CHECK_MASK(pextra->hidden_by, extras)) {
+      cat_snprintf(s, sizeof(s), "%s/", extra_name_translation(pextra));
     }
-  } extra_type_iterate_end;
+  } extra_set_iterate_end;
 
   len = strlen(s);
   p = s + len - 1;
@@ -21,6 +21,7 @@
 #include "support.h"
 
 /* common */
+#include "city.h"
 #include "fc_interface.h"
 #include "game.h"
 #include "map.h"
@@ -74,6 +75,10 @@ void tile_set_owner(struct tile *ptile, struct player *pplayer,
       || (tile_city(ptile) != nullptr || ptile->owner != nullptr)) {
     ptile->owner = pplayer;
     ptile->claimer = claimer;
+    map_soa_tile_update(ptile);
+
+    /* Borders are an input of cached move legality verdicts. */
+    move_legality_cache_invalidate();
   }
 }
 
@@ -159,6 +164,13 @@ void tile_set_terrain(struct tile *ptile, struct terrain *pterrain)
       BV_CLR(ptile->extras, extra_index(ptile->resource));
     }
   }
+  map_soa_tile_update(ptile);
+
+  /* Terrain is an input of cached city tile outputs, move costs, and
+   * move legality verdicts. */
+  city_tile_output_cache_invalidate();
+  move_cost_cache_invalidate();
+  move_legality_cache_invalidate();
 }
 
 /************************************************************************//**
@@ -383,6 +395,7 @@ Continent_id tile_continent(const struct tile *ptile)
 void tile_set_continent(struct tile *ptile, Continent_id val)
 {
   ptile->continent = val;
+  map_soa_tile_update(ptile);
 }
 
 /************************************************************************//**
@@ -917,23 +930,12 @@ bool tile_has_conflicting_extra(const struct tile *ptile,
 ****************************************************************************/
 bool tile_has_visible_extra(const struct tile *ptile, const struct extra_type *pextra)
 {
-  bool hidden = FALSE;
-
   if (!BV_ISSET(ptile->extras, extra_index(pextra))) {
     return FALSE;
   }
 
-  extra_type_iterate(top) {
-    int topi = extra_index(top);
-
-    if (BV_ISSET(pextra->hidden_by, topi)
-        && BV_ISSET(ptile->extras, topi)) {
-      hidden = TRUE;
-      break;
-    }
-  } extra_type_iterate_end;
-
-  return !hidden;
+  /* Hidden iff the tile has any of the extras that hide this one. */
+  return !BV_CHECK_MASK(pextra->hidden_by, ptile->extras);
 }
 
 /************************************************************************//**
@@ -957,6 +959,13 @@ void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
 {
   if (pextra != nullptr) {
     BV_SET(ptile->extras, extra_index(pextra));
+    map_soa_tile_update(ptile);
+
+    /* Extras are an input of cached city tile outputs, move costs, and
+     * move legality verdicts. */
+    city_tile_output_cache_invalidate();
+    move_cost_cache_invalidate();
+    move_legality_cache_invalidate();
   }
 }
 
@@ -970,6 +979,13 @@ void tile_remove_extra(struct tile *ptile, const struct extra_type *pextra)
     if (ptile->resource == pextra) {
       ptile->resource = nullptr;
     }
+    map_soa_tile_update(ptile);
+
+    /* Extras are an input of cached city tile outputs, move costs, and
+     * move legality verdicts. */
+    city_tile_output_cache_invalidate();
+    move_cost_cache_invalidate();
+    move_legality_cache_invalidate();
   }
 }
 
@@ -1007,11 +1023,7 @@ struct tile *tile_virtual_new(const struct tile *ptile)
     vtile->index = tile_index(ptile);
 
     /* Copy all but the unit list. */
-    extra_type_iterate(pextra) {
-      if (BV_ISSET(ptile->extras, extra_number(pextra))) {
-        BV_SET(vtile->extras, extra_number(pextra));
-      }
-    } extra_type_iterate_end;
+    vtile->extras = ptile->extras;
 
     vtile->resource = ptile->resource;
     vtile->terrain = ptile->terrain;
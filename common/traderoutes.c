@@ -326,17 +326,14 @@ bool can_establish_trade_route(const struct city *pc1, const struct city *pc2,
 }
 
 /*********************************************************************//**
-  Return the trade that exists between these cities, assuming they have a
-  trade route.
+  Return the revenue-style specific part of the trade formula - the part
+  that depends on the distance between and the outputs of the two cities,
+  before the trade route type percentage is applied.
 *************************************************************************/
-int trade_base_between_cities(const struct city *pc1, const struct city *pc2)
+static int trade_base_raw(const struct city *pc1, const struct city *pc2)
 {
   int bonus = 0;
 
-  if (NULL == pc1 || NULL == pc1->tile || NULL == pc2 || NULL == pc2->tile) {
-    return 0;
-  }
-
   if (game.info.trade_revenue_style == TRS_CLASSIC) {
     /* Classic Freeciv */
     int real_dist = real_map_distance(pc1->tile, pc2->tile);
@@ -353,7 +350,77 @@ int trade_base_between_cities(const struct city *pc1, const struct city *pc2)
 	    * 3;
   }
 
-  bonus = bonus
+  return bonus;
+}
+
+/*********************************************************************//**
+  Return the city input of the trade formula under the current trade
+  revenue style.
+*************************************************************************/
+static int trade_base_input(const struct city *pcity)
+{
+  if (game.info.trade_revenue_style == TRS_SIMPLE) {
+    return pcity->citizen_base[O_TRADE];
+  }
+
+  return city_size_get(pcity);
+}
+
+/*********************************************************************//**
+  Return the trade that exists between these cities, assuming they have a
+  trade route.
+*************************************************************************/
+int trade_base_between_cities(const struct city *pc1, const struct city *pc2)
+{
+  int bonus;
+
+  if (NULL == pc1 || NULL == pc1->tile || NULL == pc2 || NULL == pc2->tile) {
+    return 0;
+  }
+
+  bonus = trade_base_raw(pc1, pc2)
+          * trade_route_type_trade_pct(cities_trade_route_type(pc1, pc2))
+          / 100;
+
+  bonus /= 12;
+
+  return bonus;
+}
+
+/*********************************************************************//**
+  As trade_base_between_cities(), for an established route between the
+  cities. The distance and size part of the formula is memoized on the
+  route and reused as long as neither city has moved nor changed the
+  inputs of the current revenue style; the trade route type percentage
+  is cheap and always applied fresh.
+*************************************************************************/
+int trade_base_cached(struct trade_route *proute,
+                      const struct city *pc1, const struct city *pc2)
+{
+  int bonus;
+
+  if (NULL == pc1 || NULL == pc1->tile || NULL == pc2 || NULL == pc2->tile) {
+    return 0;
+  }
+
+  if (!proute->base_cache.valid
+      || proute->base_cache.tile1 != pc1->tile
+      || proute->base_cache.tile2 != pc2->tile
+      || proute->base_cache.input1 != trade_base_input(pc1)
+      || proute->base_cache.input2 != trade_base_input(pc2)
+      || proute->base_cache.style != game.info.trade_revenue_style
+      || proute->base_cache.world_pct != game.info.trade_world_rel_pct) {
+    proute->base_cache.base = trade_base_raw(pc1, pc2);
+    proute->base_cache.tile1 = pc1->tile;
+    proute->base_cache.tile2 = pc2->tile;
+    proute->base_cache.input1 = trade_base_input(pc1);
+    proute->base_cache.input2 = trade_base_input(pc2);
+    proute->base_cache.style = game.info.trade_revenue_style;
+    proute->base_cache.world_pct = game.info.trade_world_rel_pct;
+    proute->base_cache.valid = TRUE;
+  }
+
+  bonus = proute->base_cache.base
           * trade_route_type_trade_pct(cities_trade_route_type(pc1, pc2))
           / 100;
 
@@ -20,6 +20,9 @@ extern "C" {
 /* utility */
 #include "support.h" /* bool */
 
+/* common */
+#include "fc_types.h"
+
 struct city;
 struct city_list;
 
@@ -85,6 +88,18 @@ struct trade_route {
   int value;
   enum route_direction dir;
   struct goods_type *goods;
+
+  /* Memoized revenue-style part of trade_base_between_cities(), together
+   * with the inputs it was computed from. Managed by trade_base_cached();
+   * route creators only need to clear 'valid'. */
+  struct {
+    const struct tile *tile1, *tile2;  /* City locations */
+    int input1, input2;                /* Size or trade, by revenue style */
+    enum trade_revenue_style style;
+    int world_pct;
+    int base;
+    bool valid;
+  } base_cache;
 };
 
 /* get 'struct trade_route_list' and related functions: */
@@ -116,6 +131,8 @@ bool can_establish_trade_route(const struct city *pc1, const struct city *pc2,
                                int priority);
 bool have_cities_trade_route(const struct city *pc1, const struct city *pc2);
 int trade_base_between_cities(const struct city *pc1, const struct city *pc2);
+int trade_base_cached(struct trade_route *proute,
+                      const struct city *pc1, const struct city *pc2);
 int trade_from_route(const struct city *pc1, const struct trade_route *route,
 		     int base);
 int city_num_trade_routes(const struct city *pcity);
@@ -1312,6 +1312,9 @@ void unit_tile_set(struct unit *punit, struct tile *ptile)
 {
   fc_assert_ret(NULL != punit);
   punit->tile = ptile;
+
+  /* Unit positions are an input of cached move legality verdicts. */
+  move_legality_cache_invalidate();
 }
 
 /**********************************************************************//**
@@ -2482,6 +2485,10 @@ bool unit_transport_load(struct unit *pcargo, struct unit *ptrans, bool force)
     pcargo->transporter = ptrans;
     unit_list_append(ptrans->transporting, pcargo);
 
+    /* Transport occupancy is an input of cached move legality
+     * verdicts. */
+    move_legality_cache_invalidate();
+
     return TRUE;
   }
 
@@ -2520,6 +2527,9 @@ bool unit_transport_unload(struct unit *pcargo)
   /* For the server (also safe for the client). */
   pcargo->transporter = NULL;
 
+  /* Transport occupancy is an input of cached move legality verdicts. */
+  move_legality_cache_invalidate();
+
   return TRUE;
 }
 
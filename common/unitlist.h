@@ -23,7 +23,9 @@ extern "C" {
 #include "unit.h"               /* for diplomat_actions */
 #include "unittype.h"           /* for unit_type_flag_id */
 
-/* get 'struct unit_list' and related functions: */
+/* get 'struct unit_list' and related functions. Unit list links reach
+ * across call boundaries - the cargo iterator and the scripting API
+ * hand them out - so unit lists need the stable genlist links: */
 #define SPECLIST_TAG unit
 #define SPECLIST_TYPE struct unit
 #include "speclist.h"
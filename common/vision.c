@@ -15,6 +15,8 @@
 #include <fc_config.h>
 #endif
 
+#include <string.h>
+
 /* utility */
 #include "log.h"
 #include "mem.h"
@@ -26,6 +28,40 @@
 #include "tile.h"
 #include "vision.h"
 
+/* Recycled vision_site structures. Sites churn every time fog rolls
+ * over a city, so freed structures are kept here instead of going back
+ * to the allocator. */
+static struct vision_site **site_pool = nullptr;
+static int site_pool_count = 0;
+static int site_pool_space = 0;
+
+/************************************************************************//**
+  Take a vision_site structure from the pool, or from the allocator when
+  the pool is empty. The contents are undefined.
+****************************************************************************/
+static struct vision_site *vision_site_alloc(void)
+{
+  if (site_pool_count > 0) {
+    return site_pool[--site_pool_count];
+  }
+
+  return fc_malloc(sizeof(struct vision_site));
+}
+
+/************************************************************************//**
+  Release the pooled vision_site structures. Call when the game they
+  were sized for is torn down.
+****************************************************************************/
+void vision_site_pool_free(void)
+{
+  while (site_pool_count > 0) {
+    free(site_pool[--site_pool_count]);
+  }
+
+  free(site_pool);
+  site_pool = nullptr;
+  site_pool_space = 0;
+}
 
 /************************************************************************//**
   Create a new vision source.
@@ -77,7 +113,12 @@ void vision_site_destroy(struct vision_site *psite)
     free(psite->name);
   }
 
-  free(psite);
+  if (site_pool_count == site_pool_space) {
+    site_pool_space = (site_pool_space > 0 ? site_pool_space * 2 : 64);
+    site_pool = fc_realloc(site_pool,
+                           site_pool_space * sizeof(*site_pool));
+  }
+  site_pool[site_pool_count++] = psite;
 }
 
 /************************************************************************//**
@@ -86,8 +127,9 @@ void vision_site_destroy(struct vision_site *psite)
 struct vision_site *vision_site_new(int identity, struct tile *location,
                                     struct player *owner)
 {
-  struct vision_site *psite = fc_calloc(1, sizeof(*psite));
+  struct vision_site *psite = vision_site_alloc();
 
+  memset(psite, 0, sizeof(*psite));
   psite->identity = identity;
   psite->location = location;
   psite->owner = owner;
@@ -149,9 +191,9 @@ void vision_site_update_from_city(struct vision_site *psite,
 ****************************************************************************/
 struct vision_site *vision_site_copy(const struct vision_site *psite)
 {
-  /* Unlike in _new(), we don't need to use zeroing calloc() here
+  /* Unlike in _new(), we don't need to zero the structure here
    * as we overwrite everything. */
-  struct vision_site *copy = fc_malloc(sizeof(*psite));
+  struct vision_site *copy = vision_site_alloc();
 
   /* Copy everything. */
   *copy = *psite;
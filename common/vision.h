@@ -126,6 +126,7 @@ struct vision_site {
 };
 
 #define vision_site_owner(v) ((v)->owner)
+void vision_site_pool_free(void);
 void vision_site_destroy(struct vision_site *psite);
 struct vision_site *vision_site_new(int identity, struct tile *location,
                                     struct player *owner);
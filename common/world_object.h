@@ -21,23 +21,13 @@ extern "C" {
 #include "map_types.h"
 
 
-/* struct city_hash. */
-#define SPECHASH_TAG city
-#define SPECHASH_INT_KEY_TYPE
-#define SPECHASH_IDATA_TYPE struct city *
-#include "spechash.h"
-
-/* struct unit_hash. */
-#define SPECHASH_TAG unit
-#define SPECHASH_INT_KEY_TYPE
-#define SPECHASH_IDATA_TYPE struct unit *
-#include "spechash.h"
+struct idex_table;              /* Actually defined in idex.h */
 
 struct world
 {
   struct civ_map map;
-  struct city_hash *cities;
-  struct unit_hash *units;
+  struct idex_table *cities;
+  struct idex_table *units;
 };
 
 extern struct world wld; /* In game.c */
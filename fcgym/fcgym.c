@@ -63,6 +63,9 @@
 #include "unithand.h"
 #include "unittools.h"
 
+/* Server savegame */
+#include "savemain.h"
+
 /* Server advisors */
 #include "advdata.h"
 #include "autoworkers.h"
@@ -84,6 +87,41 @@
 static bool fcgym_initialized = false;
 static bool fcgym_game_running = false;
 static int controlled_player_idx = 0;  /* Index of the human-controlled player */
+static int opponent_mode = FCGYM_OPPONENTS_FULL;  /* From FcGameConfig */
+
+/*
+ * Environment handle.  The freeciv engine keeps its game state in
+ * process-wide globals (game, wld, the server structures), so a handle
+ * does not own any game state itself; it records the configuration so
+ * fcgym_env_reset() can replay it, and active_env tracks which handle
+ * currently owns the engine.
+ */
+struct fcgym_env {
+    FcGameConfig config;        /* Creation config, replayed on reset */
+    char ruleset[MAX_LEN_NAME]; /* Stable storage for config.ruleset */
+    FcSnapshot *template_snap;  /* Pristine turn-0 state for fast reset */
+};
+
+static FcEnv *active_env = NULL;
+
+/* Library-owned buffer for fcgym_update_observation() */
+static FcObservation persistent_obs = { 0 };
+
+/*
+ * Shadow copy of the previous persistent observation, and the delta
+ * computed against it; see fcgym_update_observation_delta().  The server's
+ * maphand dirty tracking is per-connection and never populated here (fcgym
+ * bypasses the network layer), so changes are detected by diffing.
+ */
+static FcObservation shadow_obs = { 0 };
+static FcObsDelta obs_delta = { 0 };
+static int obs_delta_max_tiles = 0;
+
+/* Library-owned buffers for fcgym_update_valid_mask() */
+static FcValidMask valid_mask = { 0 };
+static int mask_max_units = 0;
+static int mask_max_cities = 0;
+static int mask_max_techs = 0;
 
 /* ============== Helper Functions ============== */
 
@@ -95,6 +133,10 @@ static int fcgym_init_freeciv(void)
     /* Initialize server components */
     srv_init();
 
+    /* No client ever attaches to an embedded game; let the server's
+     * send paths short-circuit before packet encoding */
+    server_set_headless(true);
+
     /* Initialize random number generator early (needed by ruleset loading) */
     init_game_seed();
 
@@ -259,7 +301,14 @@ static int fcgym_start_game(void)
 
         /* Set AI difficulty level (this also sets science_cost) */
         if (is_ai(pplayer)) {
-            set_ai_level_direct(pplayer, pplayer->ai_common.skill_level);
+            if (opponent_mode != FCGYM_OPPONENTS_FULL) {
+                /* Throttled opponents get the away level, whose handicaps
+                 * also keep the end-of-phase management (last_activities)
+                 * minimal */
+                set_ai_level_direct(pplayer, AI_LEVEL_AWAY);
+            } else {
+                set_ai_level_direct(pplayer, pplayer->ai_common.skill_level);
+            }
         } else {
             /* Human players: set science_cost to 100 (normal rate) */
             pplayer->ai_common.science_cost = 100;
@@ -306,17 +355,53 @@ static int fcgym_start_game(void)
 }
 
 
+/*
+ * Scripted stand-in for the default AI under FCGYM_OPPONENTS_RANDOM:
+ * every unit tries one random adjacent move.  Cheap enough that the
+ * opponents stop dominating rollout wall time, but they still wander
+ * the map and contest territory.
+ */
+static void fcgym_random_opponent_activities(struct player *pplayer)
+{
+    unit_list_iterate_safe(pplayer->units, punit) {
+        enum direction8 dir
+            = wld.map.valid_dirs[fc_rand(wld.map.num_valid_dirs)];
+        struct tile *dst_tile = mapstep(&(wld.map), unit_tile(punit), dir);
+
+        if (dst_tile != NULL && punit->moves_left > 0
+            && unit_can_move_to_tile(&(wld.map), punit, dst_tile,
+                                     FALSE, FALSE, FALSE)) {
+            unit_move_handling(punit, dst_tile, TRUE);
+        }
+    } unit_list_iterate_safe_end;
+}
+
 /*
  * Run the main AI activities for the current phase.
  * Call this after begin_phase() and before end_phase().
  * end_phase() handles auto_workers, last_activities, and phase_finished.
+ * The opponent_mode setting decides how much work the AI players do
+ * here; the cheap modes skip the default AI's unit and city management
+ * (daiunit/daicity), which is where a full phase spends its time.
  */
 static void fcgym_run_current_ai_phase(void)
 {
     phase_players_iterate(pplayer) {
         if (is_ai(pplayer) && pplayer->is_alive) {
-            /* Main AI activities: move units, build cities, attack, etc. */
-            CALL_PLR_AI_FUNC(first_activities, pplayer, pplayer);
+            switch (opponent_mode) {
+            case FCGYM_OPPONENTS_IDLE:
+                /* Take no actions at all */
+                break;
+            case FCGYM_OPPONENTS_RANDOM:
+                fcgym_random_opponent_activities(pplayer);
+                break;
+            case FCGYM_OPPONENTS_FULL:
+            default:
+                /* Main AI activities: move units, build cities, attack,
+                 * etc. */
+                CALL_PLR_AI_FUNC(first_activities, pplayer, pplayer);
+                break;
+            }
             pplayer->phase_done = TRUE;
             pplayer->ai_phase_done = TRUE;
         }
@@ -427,6 +512,23 @@ void fcgym_shutdown(void)
         fcgym_game_running = false;
     }
 
+    fcgym_free_observation(&persistent_obs);
+    fcgym_free_observation(&shadow_obs);
+    free(obs_delta.tiles);
+    memset(&obs_delta, 0, sizeof(obs_delta));
+    obs_delta_max_tiles = 0;
+
+    free(valid_mask.unit_ids);
+    free(valid_mask.unit_masks);
+    free(valid_mask.city_ids);
+    free(valid_mask.city_buildable);
+    free(valid_mask.city_can_buy);
+    free(valid_mask.researchable);
+    memset(&valid_mask, 0, sizeof(valid_mask));
+    mask_max_units = 0;
+    mask_max_cities = 0;
+    mask_max_techs = 0;
+
     fcgym_initialized = false;
 }
 
@@ -446,6 +548,13 @@ int fcgym_new_game(const FcGameConfig *config)
         fcgym_game_running = false;
     }
 
+    /* Invalidate the delta shadow; observations of the new game must not
+     * be diffed against the old one */
+    shadow_obs.num_tiles = 0;
+
+    /* How much work the AI opponents do each turn */
+    opponent_mode = config->opponent_mode;
+
     /* Disable aifill BEFORE loading ruleset to prevent auto-creation */
     game.info.aifill = 0;
 
@@ -488,9 +597,12 @@ int fcgym_new_game(const FcGameConfig *config)
 
 int fcgym_reset(void)
 {
-    /* For now, just start a new game with the same config */
-    /* TODO: Implement faster reset by saving/loading initial state */
-    return -1;  /* Not yet implemented */
+    /* The legacy API does not remember the config it was started with;
+     * only the handle API can replay it. */
+    if (active_env != NULL) {
+        return fcgym_env_reset(active_env);
+    }
+    return -1;
 }
 
 void fcgym_get_observation(FcObservation *obs)
@@ -516,9 +628,12 @@ void fcgym_get_observation(FcObservation *obs)
     obs->current_player = game.info.phase;  /* Simplified */
     obs->controlled_player = controlled_player_idx;
 
-    /* Allocate/reallocate tile array if needed */
-    if (obs->tiles == NULL) {
+    /* Allocate/reallocate tile array if needed (map size can change
+     * between games) */
+    if (obs->tiles == NULL || obs->max_tiles < obs->num_tiles) {
+        free(obs->tiles);
         obs->tiles = fc_calloc(obs->num_tiles, sizeof(FcTileObs));
+        obs->max_tiles = obs->num_tiles;
     }
 
     /* Fill tile data with proper fog-of-war handling */
@@ -571,11 +686,21 @@ void fcgym_get_observation(FcObservation *obs)
         total_cities += city_list_size(p->cities);
     } players_iterate_end;
 
-    /* Allocate/reallocate unit array */
+    /* Allocate/reallocate unit array.  Grow geometrically so the buffer
+     * address stays stable across steps once the game settles down;
+     * zero-copy consumers of fcgym_update_observation() rely on this. */
     if (obs->units == NULL || obs->max_units < total_units) {
+        int want = 2 * obs->max_units;
+
+        if (want < total_units) {
+            want = total_units;
+        }
+        if (want < 64) {
+            want = 64;
+        }
         free(obs->units);
-        obs->units = fc_calloc(total_units, sizeof(FcUnitObs));
-        obs->max_units = total_units;
+        obs->units = fc_calloc(want, sizeof(FcUnitObs));
+        obs->max_units = want;
     }
 
     /* Fill unit data (own units always visible, enemy units only if tile visible) */
@@ -601,11 +726,19 @@ void fcgym_get_observation(FcObservation *obs)
         } unit_list_iterate_end;
     } players_iterate_end;
 
-    /* Allocate/reallocate city array */
+    /* Allocate/reallocate city array (geometric growth, as for units) */
     if (obs->cities == NULL || obs->max_cities < total_cities) {
+        int want = 2 * obs->max_cities;
+
+        if (want < total_cities) {
+            want = total_cities;
+        }
+        if (want < 32) {
+            want = 32;
+        }
         free(obs->cities);
-        obs->cities = fc_calloc(total_cities, sizeof(FcCityObs));
-        obs->max_cities = total_cities;
+        obs->cities = fc_calloc(want, sizeof(FcCityObs));
+        obs->max_cities = want;
     }
 
     /* Fill city data (own cities always, enemy cities only if explored) */
@@ -696,6 +829,121 @@ void fcgym_free_observation(FcObservation *obs)
     memset(obs, 0, sizeof(*obs));
 }
 
+const FcObservation *fcgym_update_observation(void)
+{
+    if (!fcgym_game_running) {
+        return NULL;
+    }
+
+    fcgym_get_observation(&persistent_obs);
+
+    return &persistent_obs;
+}
+
+const FcObsDelta *fcgym_update_observation_delta(void)
+{
+    const FcObservation *obs = fcgym_update_observation();
+    int i;
+
+    if (obs == NULL) {
+        return NULL;
+    }
+
+    /* The shadow is only usable when it holds a full previous
+     * observation of a map of the same size */
+    obs_delta.full = (shadow_obs.tiles == NULL
+                      || shadow_obs.num_tiles != obs->num_tiles);
+    obs_delta.num_tiles = 0;
+
+    if (obs_delta.tiles == NULL || obs_delta_max_tiles < obs->num_tiles) {
+        free(obs_delta.tiles);
+        obs_delta.tiles = fc_malloc(obs->num_tiles
+                                    * sizeof(obs_delta.tiles[0]));
+        obs_delta_max_tiles = obs->num_tiles;
+    }
+
+    if (obs_delta.full) {
+        obs_delta.units_changed = true;
+        obs_delta.cities_changed = true;
+        obs_delta.players_changed = true;
+    } else {
+        for (i = 0; i < obs->num_tiles; i++) {
+            if (memcmp(&shadow_obs.tiles[i], &obs->tiles[i],
+                       sizeof(FcTileObs)) != 0) {
+                obs_delta.tiles[obs_delta.num_tiles++] = i;
+            }
+        }
+        obs_delta.units_changed =
+            (shadow_obs.num_units != obs->num_units
+             || (obs->num_units > 0
+                 && memcmp(shadow_obs.units, obs->units,
+                           obs->num_units * sizeof(FcUnitObs)) != 0));
+        obs_delta.cities_changed =
+            (shadow_obs.num_cities != obs->num_cities
+             || (obs->num_cities > 0
+                 && memcmp(shadow_obs.cities, obs->cities,
+                           obs->num_cities * sizeof(FcCityObs)) != 0));
+        obs_delta.players_changed =
+            (shadow_obs.num_players != obs->num_players
+             || (obs->num_players > 0
+                 && memcmp(shadow_obs.players, obs->players,
+                           obs->num_players * sizeof(FcPlayerObs)) != 0));
+    }
+
+    /* Refresh the shadow for the next delta */
+    if (shadow_obs.tiles == NULL || shadow_obs.max_tiles < obs->num_tiles) {
+        free(shadow_obs.tiles);
+        shadow_obs.tiles = fc_malloc(obs->num_tiles * sizeof(FcTileObs));
+        shadow_obs.max_tiles = obs->num_tiles;
+    }
+    memcpy(shadow_obs.tiles, obs->tiles,
+           obs->num_tiles * sizeof(FcTileObs));
+    shadow_obs.num_tiles = obs->num_tiles;
+
+    if (shadow_obs.max_units < obs->num_units) {
+        free(shadow_obs.units);
+        shadow_obs.units = fc_malloc(obs->num_units * sizeof(FcUnitObs));
+        shadow_obs.max_units = obs->num_units;
+    }
+    if (obs->num_units > 0) {
+        memcpy(shadow_obs.units, obs->units,
+               obs->num_units * sizeof(FcUnitObs));
+    }
+    shadow_obs.num_units = obs->num_units;
+
+    if (shadow_obs.max_cities < obs->num_cities) {
+        free(shadow_obs.cities);
+        shadow_obs.cities = fc_malloc(obs->num_cities * sizeof(FcCityObs));
+        shadow_obs.max_cities = obs->num_cities;
+    }
+    if (obs->num_cities > 0) {
+        memcpy(shadow_obs.cities, obs->cities,
+               obs->num_cities * sizeof(FcCityObs));
+    }
+    shadow_obs.num_cities = obs->num_cities;
+
+    if (shadow_obs.players == NULL) {
+        shadow_obs.players = fc_calloc(MAX_NUM_PLAYERS,
+                                       sizeof(FcPlayerObs));
+    }
+    if (obs->num_players > 0) {
+        memcpy(shadow_obs.players, obs->players,
+               obs->num_players * sizeof(FcPlayerObs));
+    }
+    shadow_obs.num_players = obs->num_players;
+
+    return &obs_delta;
+}
+
+const FcObservation *fcgym_observation_buffer(void)
+{
+    if (!fcgym_game_running) {
+        return NULL;
+    }
+
+    return &persistent_obs;
+}
+
 void fcgym_get_valid_actions(FcValidActions *actions)
 {
     if (actions == NULL || !fcgym_game_running) {
@@ -921,6 +1169,183 @@ void fcgym_free_valid_actions(FcValidActions *actions)
     memset(actions, 0, sizeof(*actions));
 }
 
+const FcValidMask *fcgym_update_valid_mask(void)
+{
+    if (!fcgym_game_running) {
+        return NULL;
+    }
+
+    struct player *pplayer = player_by_number(controlled_player_idx);
+    if (pplayer == NULL) {
+        return NULL;
+    }
+
+    int num_units = unit_list_size(pplayer->units);
+    int num_cities = city_list_size(pplayer->cities);
+    int num_targets = utype_count() + improvement_count();
+    int num_techs = advance_count();
+
+    /* Grow the persistent rows geometrically, like the observation
+     * buffers, so addresses stay stable in steady state */
+    if (mask_max_units < num_units) {
+        int want = 2 * mask_max_units;
+
+        if (want < num_units) {
+            want = num_units;
+        }
+        if (want < 64) {
+            want = 64;
+        }
+        free(valid_mask.unit_ids);
+        free(valid_mask.unit_masks);
+        valid_mask.unit_ids =
+            fc_malloc(want * sizeof(valid_mask.unit_ids[0]));
+        valid_mask.unit_masks =
+            fc_malloc(want * sizeof(valid_mask.unit_masks[0]));
+        mask_max_units = want;
+    }
+
+    if (mask_max_cities < num_cities
+        || valid_mask.num_targets != num_targets) {
+        int want = 2 * mask_max_cities;
+
+        if (want < num_cities) {
+            want = num_cities;
+        }
+        if (want < 32) {
+            want = 32;
+        }
+        free(valid_mask.city_ids);
+        free(valid_mask.city_buildable);
+        free(valid_mask.city_can_buy);
+        valid_mask.city_ids =
+            fc_malloc(want * sizeof(valid_mask.city_ids[0]));
+        valid_mask.city_buildable = fc_malloc(want * num_targets);
+        valid_mask.city_can_buy = fc_malloc(want);
+        mask_max_cities = want;
+    }
+
+    if (mask_max_techs < num_techs) {
+        free(valid_mask.researchable);
+        valid_mask.researchable = fc_malloc(num_techs);
+        mask_max_techs = num_techs;
+    }
+
+    valid_mask.num_units = num_units;
+    valid_mask.num_cities = num_cities;
+    valid_mask.num_targets = num_targets;
+    valid_mask.num_techs = num_techs;
+    valid_mask.can_end_turn = true;
+
+    /* Unit masks: same enabler checks as fcgym_get_valid_actions(), but
+     * written straight into the bitset rows */
+    int idx = 0;
+    unit_list_iterate(pplayer->units, punit) {
+        uint32_t mask = 0;
+
+        for (int d = 0; d < wld.map.num_valid_dirs; d++) {
+            enum direction8 dir = wld.map.valid_dirs[d];
+            struct tile *dst_tile = mapstep(&(wld.map), punit->tile, dir);
+
+            if (dst_tile == NULL || punit->moves_left <= 0) {
+                continue;
+            }
+
+            if (is_enemy_unit_tile(dst_tile, pplayer)
+                || is_enemy_city_tile(dst_tile, pplayer)) {
+                if (is_action_enabled_unit_on_stack(&(wld.map), ACTION_ATTACK,
+                                                    punit, dst_tile)) {
+                    mask |= FCGYM_UMASK_ATTACK(dir);
+                }
+            } else if (unit_can_move_to_tile(&(wld.map), punit, dst_tile,
+                                             FALSE, FALSE, FALSE)) {
+                mask |= FCGYM_UMASK_MOVE(dir);
+            }
+        }
+
+        if (can_unit_do_activity(&(wld.map), punit, ACTIVITY_FORTIFYING,
+                                 activity_default_action(ACTIVITY_FORTIFYING))) {
+            mask |= FCGYM_UMASK_FORTIFY;
+        }
+        if (is_action_enabled_unit_on_tile(&(wld.map), ACTION_FOUND_CITY,
+                                           punit, punit->tile, NULL)) {
+            mask |= FCGYM_UMASK_BUILD_CITY;
+        }
+        {
+            struct extra_type *road_target = next_extra_for_tile(
+                punit->tile, EC_ROAD, unit_owner(punit), punit);
+
+            if (road_target != NULL
+                && can_unit_do_activity_targeted(&(wld.map), punit,
+                                                 ACTIVITY_GEN_ROAD,
+                                                 activity_default_action(ACTIVITY_GEN_ROAD),
+                                                 road_target)) {
+                mask |= FCGYM_UMASK_BUILD_ROAD;
+            }
+        }
+        if (can_unit_do_activity(&(wld.map), punit, ACTIVITY_IRRIGATE,
+                                 activity_default_action(ACTIVITY_IRRIGATE))) {
+            mask |= FCGYM_UMASK_BUILD_IRRIGATION;
+        }
+        if (can_unit_do_activity(&(wld.map), punit, ACTIVITY_MINE,
+                                 activity_default_action(ACTIVITY_MINE))) {
+            mask |= FCGYM_UMASK_BUILD_MINE;
+        }
+        if (unit_can_do_action(punit, ACTION_DISBAND_UNIT)
+            && is_action_enabled_unit_on_self(&(wld.map),
+                                              ACTION_DISBAND_UNIT, punit)) {
+            mask |= FCGYM_UMASK_DISBAND;
+        }
+
+        valid_mask.unit_ids[idx] = punit->id;
+        valid_mask.unit_masks[idx] = mask;
+        idx++;
+    } unit_list_iterate_end;
+
+    /* City production rows: unit types first, then building types */
+    int cidx = 0;
+    city_list_iterate(pplayer->cities, pcity) {
+        uint8_t *row = valid_mask.city_buildable + cidx * num_targets;
+
+        memset(row, 0, num_targets);
+        unit_type_iterate(ptype) {
+            if (can_city_build_unit_now(&(wld.map), pcity, ptype)) {
+                row[utype_index(ptype)] = 1;
+            }
+        } unit_type_iterate_end;
+        improvement_iterate(pimprove) {
+            if (can_city_build_improvement_now(pcity, pimprove)) {
+                row[utype_count() + improvement_index(pimprove)] = 1;
+            }
+        } improvement_iterate_end;
+
+        valid_mask.city_ids[cidx] = pcity->id;
+        /* Must match conditions in really_handle_city_buy() */
+        valid_mask.city_can_buy[cidx] =
+            (pcity->turn_founded != game.info.turn
+             && !pcity->did_buy
+             && pcity->shield_stock < city_production_build_shield_cost(pcity)
+             && pplayer->economic.gold >= city_production_buy_gold_cost(pcity)
+             && (pcity->production.kind != VUT_UTYPE || pcity->anarchy == 0))
+            ? 1 : 0;
+        cidx++;
+    } city_list_iterate_end;
+
+    /* Researchable techs */
+    memset(valid_mask.researchable, 0, num_techs);
+    struct research *presearch = research_get(pplayer);
+    if (presearch != NULL) {
+        advance_iterate(adv) {
+            if (research_invention_state(presearch, advance_index(adv))
+                == TECH_PREREQS_KNOWN) {
+                valid_mask.researchable[advance_index(adv)] = 1;
+            }
+        } advance_iterate_end;
+    }
+
+    return &valid_mask;
+}
+
 FcStepResult fcgym_step(const FcAction *action)
 {
     FcStepResult result = {0};
@@ -1095,6 +1520,36 @@ FcStepResult fcgym_step(const FcAction *action)
     return result;
 }
 
+FcStepResult fcgym_step_batch(const FcAction *actions, int num_actions)
+{
+    FcStepResult result = { 0.0f, false, false, NULL };
+    int i;
+
+    if (!fcgym_game_running) {
+        result.info = "No game running";
+        return result;
+    }
+    if (actions == NULL || num_actions <= 0) {
+        result.info = "No actions";
+        return result;
+    }
+
+    for (i = 0; i < num_actions; i++) {
+        FcStepResult one = fcgym_step(&actions[i]);
+
+        result.reward += one.reward;
+        result.info = one.info;
+        if (one.done || one.truncated) {
+            /* Episode over; drop the rest of the batch */
+            result.done = one.done;
+            result.truncated = one.truncated;
+            break;
+        }
+    }
+
+    return result;
+}
+
 int fcgym_num_unit_types(void)
 {
     return utype_count();
@@ -1128,6 +1583,193 @@ const char* fcgym_tech_name(int index)
     return padvance ? advance_rule_name(padvance) : NULL;
 }
 
+/*
+ * Snapshot handle.  The game state is held as the parsed registry tree
+ * that savegame_save() fills in; savegame_load() only reads from it, so
+ * the same snapshot can be restored any number of times.
+ */
+struct fcgym_snapshot {
+    struct section_file *sfile; /* In-memory savegame */
+    int controlled_player;      /* controlled_player_idx at capture time */
+};
+
+FcSnapshot *fcgym_snapshot(void)
+{
+    FcSnapshot *snap;
+
+    if (!fcgym_game_running) {
+        log_error("No game running to snapshot");
+        return NULL;
+    }
+
+    snap = fc_malloc(sizeof(*snap));
+    snap->sfile = secfile_new(TRUE);
+    savegame_save(snap->sfile, "fcgym snapshot", FALSE);
+    snap->controlled_player = controlled_player_idx;
+
+    return snap;
+}
+
+int fcgym_restore(FcSnapshot *snap)
+{
+    if (snap == NULL || snap->sfile == NULL) {
+        return -1;
+    }
+
+    /* Tear down the current game the same way fcgym_new_game() does */
+    if (fcgym_game_running) {
+        server_game_free();
+        fc_rand_uninit();
+        fcgym_game_running = false;
+    }
+    /* Keep the ruleset value; the load reinitializes everything else */
+    server_game_init(TRUE);
+    init_game_seed();  /* Overridden below if the snapshot saved the RNG */
+
+    /* savegame_load() insists on pregame state */
+    set_server_state(S_S_INITIAL);
+    savegame_load(snap->sfile);
+
+    /* Resume the loaded game; mirrors the loaded-game branch of
+     * srv_ready() */
+    CALL_FUNC_EACH_AI(map_ready);
+    set_server_state(S_S_RUNNING);
+
+    players_iterate(pplayer) {
+        adv_data_analyze_rulesets(pplayer);
+        if (is_ai(pplayer)) {
+            set_ai_level_direct(pplayer, pplayer->ai_common.skill_level);
+        }
+    } players_iterate_end;
+
+    CALL_FUNC_EACH_AI(game_start);
+
+    controlled_player_idx = snap->controlled_player;
+
+    /* Observations of the restored game must not be diffed against the
+     * pre-restore one */
+    shadow_obs.num_tiles = 0;
+
+    fcgym_game_running = true;
+    return 0;
+}
+
+void fcgym_snapshot_free(FcSnapshot *snap)
+{
+    if (snap == NULL) {
+        return;
+    }
+    secfile_destroy(snap->sfile);
+    free(snap);
+}
+
+FcEnv *fcgym_env_create(const FcGameConfig *config)
+{
+    FcEnv *env;
+
+    if (config == NULL) {
+        return NULL;
+    }
+
+    if (active_env != NULL) {
+        /* A second live environment would trample the first one's global
+         * game state.  Run extra environments in separate processes. */
+        log_error("fcgym: an environment is already active in this process");
+        return NULL;
+    }
+
+    if (fcgym_init() != 0) {
+        return NULL;
+    }
+
+    env = fc_calloc(1, sizeof(*env));
+    env->config = *config;
+    if (config->ruleset != NULL) {
+        /* The caller's string may not outlive the handle */
+        sz_strlcpy(env->ruleset, config->ruleset);
+        env->config.ruleset = env->ruleset;
+    }
+
+    if (fcgym_new_game(&env->config) != 0) {
+        free(env);
+        return NULL;
+    }
+
+    /* Capture the pristine turn-0 state so resets can restore it
+     * instead of regenerating the whole game */
+    env->template_snap = fcgym_snapshot();
+
+    active_env = env;
+    return env;
+}
+
+void fcgym_env_destroy(FcEnv *env)
+{
+    if (env == NULL) {
+        return;
+    }
+
+    if (env == active_env) {
+        /* Leave the game state in place; the next fcgym_env_create()
+         * or fcgym_new_game() tears it down before starting over. */
+        active_env = NULL;
+    }
+
+    fcgym_snapshot_free(env->template_snap);
+    free(env);
+}
+
+int fcgym_env_reset(FcEnv *env)
+{
+    if (env == NULL || env != active_env) {
+        log_error("fcgym: reset on an environment that is not active");
+        return -1;
+    }
+
+    if (env->template_snap != NULL
+        && fcgym_restore(env->template_snap) == 0) {
+        if (env->config.seed == 0) {
+            /* The template bakes in the RNG state it was captured with;
+             * reseed so episodes on this map diverge */
+            fc_rand_uninit();
+            init_game_seed();
+        }
+        return 0;
+    }
+
+    /* No template (or restore failed): regenerate from scratch */
+    return fcgym_new_game(&env->config);
+}
+
+FcStepResult fcgym_env_step(FcEnv *env, const FcAction *action)
+{
+    if (env == NULL || env != active_env) {
+        FcStepResult result = { 0.0f, false, false,
+                                "Environment is not active" };
+        return result;
+    }
+
+    return fcgym_step(action);
+}
+
+void fcgym_env_get_observation(FcEnv *env, FcObservation *obs)
+{
+    if (env == NULL || env != active_env) {
+        return;
+    }
+
+    fcgym_get_observation(obs);
+}
+
+void fcgym_env_get_valid_actions(FcEnv *env, FcValidActions *actions)
+{
+    if (env == NULL || env != active_env) {
+        return;
+    }
+
+    fcgym_get_valid_actions(actions);
+}
+
 struct player* fcgym_get_controlled_player(void)
 {
     if (!fcgym_game_running) {
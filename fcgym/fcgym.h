@@ -21,6 +21,19 @@ struct unit;
 struct city;
 struct tile;
 
+/*
+ * How much work the AI opponents do each turn.  The default AI's full
+ * phase (unit management, city management) dominates step time when
+ * training against opponents that don't need to be smart; the cheaper
+ * modes trade opponent strength for rollout throughput.  ai_skill_level
+ * still tunes the cost of FULL mode (lower levels do less lookahead).
+ */
+typedef enum {
+    FCGYM_OPPONENTS_FULL = 0,   /* Default AI runs its whole phase */
+    FCGYM_OPPONENTS_RANDOM,     /* Scripted opponents: random unit moves */
+    FCGYM_OPPONENTS_IDLE        /* Opponents take no actions at all */
+} FcOpponentMode;
+
 /*
  * Game configuration for new games
  */
@@ -32,6 +45,7 @@ typedef struct {
     int ai_skill_level;         /* 0-10 AI difficulty */
     unsigned int seed;          /* Random seed (0 for random) */
     bool fog_of_war;            /* Enable fog of war */
+    int opponent_mode;          /* FcOpponentMode; 0 = full AI */
 } FcGameConfig;
 
 /*
@@ -143,6 +157,7 @@ typedef struct {
     /* Tile data (map_xsize * map_ysize elements) */
     FcTileObs *tiles;
     int num_tiles;
+    int max_tiles;          /* Allocated size */
 
     /* Units visible to controlled player */
     FcUnitObs *units;
@@ -211,6 +226,22 @@ typedef struct {
     const char *info;       /* Additional info string */
 } FcStepResult;
 
+/*
+ * What changed between two consecutive fcgym_update_observation_delta()
+ * calls.  Lets a consumer patch its arrays instead of rebuilding full
+ * map planes each step.
+ */
+typedef struct {
+    bool full;              /* No usable previous observation (first update
+                               of a game, or map size changed); consumers
+                               must rebuild everything */
+    int *tiles;             /* Indices of tiles whose FcTileObs changed */
+    int num_tiles;
+    bool units_changed;     /* Unit array differs from previous update */
+    bool cities_changed;    /* City array differs from previous update */
+    bool players_changed;   /* Player array differs from previous update */
+} FcObsDelta;
+
 
 /* ============== API Functions ============== */
 
@@ -248,6 +279,37 @@ void fcgym_get_observation(FcObservation *obs);
  */
 void fcgym_free_observation(FcObservation *obs);
 
+/*
+ * Update and return the library-owned persistent observation buffer.
+ *
+ * Unlike fcgym_get_observation(), the returned struct and its arrays are
+ * owned by the library and rewritten in place on every call, so a trainer
+ * can wrap them once as zero-copy numpy (or similar) views instead of
+ * allocating and copying per step.  Array addresses only change when an
+ * array has to grow past its allocated capacity; compare the pointers
+ * after each call and rewrap views when they differ.  Do not pass the
+ * result to fcgym_free_observation().
+ * Returns NULL if no game is running.
+ */
+const FcObservation *fcgym_update_observation(void);
+
+/*
+ * Like fcgym_update_observation(), but additionally reports what changed
+ * since the previous update.  The returned delta is owned by the library
+ * and rewritten on every call; when delta->full is set the previous
+ * observation was unusable and everything must be rebuilt.  Fetch the
+ * updated observation itself with fcgym_observation_buffer().
+ * Returns NULL if no game is running.
+ */
+const FcObsDelta *fcgym_update_observation_delta(void);
+
+/*
+ * Return the library-owned observation buffer last filled by
+ * fcgym_update_observation() or fcgym_update_observation_delta(),
+ * or NULL if no game is running.
+ */
+const FcObservation *fcgym_observation_buffer(void);
+
 /*
  * Get valid actions for the controlled player.
  * Caller must provide allocated FcValidActions.
@@ -259,12 +321,71 @@ void fcgym_get_valid_actions(FcValidActions *actions);
  */
 void fcgym_free_valid_actions(FcValidActions *actions);
 
+/*
+ * Bit layout of a per-unit entry in FcValidMask.unit_masks
+ */
+#define FCGYM_UMASK_MOVE(dir)        (1u << (dir))        /* dirs 0-7 */
+#define FCGYM_UMASK_ATTACK(dir)      (1u << (8 + (dir)))  /* dirs 0-7 */
+#define FCGYM_UMASK_FORTIFY          (1u << 16)
+#define FCGYM_UMASK_BUILD_CITY       (1u << 17)
+#define FCGYM_UMASK_BUILD_ROAD       (1u << 18)
+#define FCGYM_UMASK_BUILD_IRRIGATION (1u << 19)
+#define FCGYM_UMASK_BUILD_MINE       (1u << 20)
+#define FCGYM_UMASK_DISBAND          (1u << 21)
+
+/*
+ * Dense valid-action masks over a fixed action space, as an alternative
+ * to the per-action descriptor lists of FcValidActions.
+ */
+typedef struct {
+    /* Per unit of the controlled player: engine ID and one bitmask
+     * combining the FCGYM_UMASK_* bits of the actions it may take */
+    int *unit_ids;
+    uint32_t *unit_masks;
+    int num_units;
+
+    /* Per city of the controlled player: engine ID, a 0/1 row over all
+     * production targets (unit types first, then building types; row
+     * stride is num_targets) and a 0/1 buy flag */
+    int *city_ids;
+    uint8_t *city_buildable;
+    uint8_t *city_can_buy;
+    int num_cities;
+    int num_targets;
+
+    /* One 0/1 entry per tech: researchable right now */
+    uint8_t *researchable;
+    int num_techs;
+
+    bool can_end_turn;
+} FcValidMask;
+
+/*
+ * Compute the valid-action masks for the controlled player into a
+ * library-owned persistent buffer and return it.  Carries the same
+ * information as fcgym_get_valid_actions(), but written as fixed-stride
+ * arrays usable directly as RL action masks; nothing is allocated per
+ * call once the buffers have grown to size, and array addresses follow
+ * the same stability rules as the observation buffers.  Do not free the
+ * result.  Returns NULL if no game is running.
+ */
+const FcValidMask *fcgym_update_valid_mask(void);
+
 /*
  * Execute an action and return the result.
  * The game advances after the action (AI players take their turns if applicable).
  */
 FcStepResult fcgym_step(const FcAction *action);
 
+/*
+ * Execute a batch of actions in order (e.g. all unit orders for the
+ * turn, optionally ending with FCGYM_ACTION_END_TURN) and return one
+ * combined result: rewards are summed and execution stops early when an
+ * action ends the episode.  Observations are only built on demand, so
+ * batching also skips all intermediate observation work.
+ */
+FcStepResult fcgym_step_batch(const FcAction *actions, int num_actions);
+
 /*
  * Get the number of possible unit types (for action space sizing).
  */
@@ -296,6 +417,89 @@ const char* fcgym_building_type_name(int index);
 const char* fcgym_tech_name(int index);
 
 
+/* ============== Snapshot / Restore (for tree search) ============== */
+
+/*
+ * Opaque in-memory snapshot of a running game.
+ *
+ * Captured: everything the savegame format stores - the map, player map
+ * knowledge, units, cities, players, research, diplomacy, settings and
+ * (with the saverandom setting enabled) the random number generator
+ * state.  Not captured: connection state, the event cache, AI module
+ * caches (rebuilt on restore) and fcgym's delta-observation shadow
+ * (invalidated on restore, so the first delta after a restore is full).
+ */
+typedef struct fcgym_snapshot FcSnapshot;
+
+/*
+ * Capture the running game into an in-memory snapshot.  The game state
+ * is serialized into a registry tree held in memory; nothing touches
+ * the filesystem.  Returns NULL if no game is running.
+ */
+FcSnapshot *fcgym_snapshot(void);
+
+/*
+ * Replace the current game state with the snapshot's.  The snapshot
+ * stays valid afterwards and can be restored any number of times, as
+ * tree search rollbacks require.  Returns 0 on success.
+ */
+int fcgym_restore(FcSnapshot *snap);
+
+/*
+ * Release a snapshot.  Safe to call with NULL.
+ */
+void fcgym_snapshot_free(FcSnapshot *snap);
+
+
+/* ============== Environment Handles ============== */
+
+/*
+ * Opaque environment handle for the handle-based API below.
+ *
+ * The handle remembers the FcGameConfig it was created with, so
+ * fcgym_env_reset() can restart the episode without the caller keeping
+ * the config around.  NOTE: the freeciv engine stores its game state in
+ * process-wide globals, so only ONE environment can be live per process;
+ * fcgym_env_create() fails while another handle is active.  Vectorized
+ * trainers that want several environments must run one process per
+ * environment (e.g. via multiprocessing) until the engine itself is
+ * de-globalized.
+ */
+typedef struct fcgym_env FcEnv;
+
+/*
+ * Create an environment and start a game with the given configuration.
+ * Initializes the library if needed.  Returns NULL on failure or if
+ * another environment is already active in this process.
+ */
+FcEnv *fcgym_env_create(const FcGameConfig *config);
+
+/*
+ * Destroy an environment and release the engine for a new handle.
+ * Safe to call with NULL.
+ */
+void fcgym_env_destroy(FcEnv *env);
+
+/*
+ * Restart the environment's episode.  When the handle holds a template
+ * snapshot of the pristine turn-0 state (taken at creation), reset
+ * restores it instead of regenerating the map and reloading the
+ * ruleset, which is far cheaper; a config with seed 0 additionally
+ * reseeds the RNG after the restore so episodes diverge.  Falls back to
+ * full game creation when no template is available.  Returns 0 on
+ * success, non-zero on failure.
+ */
+int fcgym_env_reset(FcEnv *env);
+
+/*
+ * Handle-based equivalents of fcgym_step(), fcgym_get_observation()
+ * and fcgym_get_valid_actions().  The env must be the active one.
+ */
+FcStepResult fcgym_env_step(FcEnv *env, const FcAction *action);
+void fcgym_env_get_observation(FcEnv *env, FcObservation *obs);
+void fcgym_env_get_valid_actions(FcEnv *env, FcValidActions *actions);
+
+
 /* ============== Low-level Access (for debugging/advanced use) ============== */
 
 /*
@@ -0,0 +1,272 @@
+/*
+ * fcgym_bench.c - Steps-per-second benchmark for the fcgym wrapper
+ *
+ * Runs scripted random-action episodes and reports step latency
+ * percentiles plus a breakdown of where the time goes (action
+ * execution, turn advance, observation build, valid-action query).
+ * Performance work on fcgym should quote this number before/after.
+ *
+ * Usage:
+ *   fcgym_bench [-x xsize] [-y ysize] [-a ai_players] [-s skill]
+ *               [-t turns] [-e episodes] [-o full|random|idle]
+ *               [-r seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fcgym.h"
+
+/* Timing buckets */
+enum bench_bucket {
+    BUCKET_ACTION = 0,      /* fcgym_step() for regular actions */
+    BUCKET_TURN_ADVANCE,    /* fcgym_step() for END_TURN (AI phases) */
+    BUCKET_OBSERVATION,     /* fcgym_update_observation() */
+    BUCKET_VALID_ACTIONS,   /* fcgym_get_valid_actions() */
+    BUCKET_COUNT
+};
+
+static const char *bucket_names[BUCKET_COUNT] = {
+    "action execution",
+    "turn advance",
+    "observation build",
+    "valid-action query",
+};
+
+static double bucket_ms[BUCKET_COUNT];
+
+/* Per-step latencies (one entry per fcgym_step call) for percentiles */
+static double *latencies = NULL;
+static int num_latencies = 0;
+static int max_latencies = 0;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1.0e6;
+}
+
+static void record_latency(double ms)
+{
+    if (num_latencies >= max_latencies) {
+        max_latencies = max_latencies > 0 ? 2 * max_latencies : 4096;
+        latencies = realloc(latencies, max_latencies * sizeof(double));
+        if (latencies == NULL) {
+            fprintf(stderr, "Out of memory recording latencies\n");
+            exit(1);
+        }
+    }
+    latencies[num_latencies++] = ms;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+
+    return (da > db) - (da < db);
+}
+
+/* p in [0, 100]; latencies must be sorted */
+static double percentile(double p)
+{
+    int idx;
+
+    if (num_latencies == 0) {
+        return 0.0;
+    }
+    idx = (int)(p / 100.0 * (num_latencies - 1) + 0.5);
+    return latencies[idx];
+}
+
+/*
+ * Take one random legal action for unit entry i of the valid-action
+ * set, or none if the unit has no legal moves.  Returns true if an
+ * action was stepped.  (The per-unit entries are an anonymous struct
+ * inside FcValidActions, so this takes the set and an index.)
+ */
+static bool random_unit_action(const FcValidActions *valid, int i)
+{
+    int legal_dirs[8];
+    int num_legal = 0;
+    FcAction action;
+    double t0, dt;
+
+    for (int d = 0; d < 8; d++) {
+        if (valid->unit_actions[i].can_move[d]) {
+            legal_dirs[num_legal++] = d;
+        }
+    }
+
+    if (num_legal == 0) {
+        if (valid->unit_actions[i].can_fortify) {
+            action.type = FCGYM_ACTION_UNIT_FORTIFY;
+            action.actor_id = valid->unit_actions[i].unit_id;
+            action.target_id = 0;
+            action.sub_target = 0;
+        } else {
+            return false;
+        }
+    } else {
+        action.type = FCGYM_ACTION_UNIT_MOVE;
+        action.actor_id = valid->unit_actions[i].unit_id;
+        action.target_id = 0;
+        action.sub_target = legal_dirs[rand() % num_legal];
+    }
+
+    t0 = now_ms();
+    fcgym_step(&action);
+    dt = now_ms() - t0;
+    record_latency(dt);
+    bucket_ms[BUCKET_ACTION] += dt;
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    FcGameConfig config = {
+        .ruleset = "civ2civ3",
+        .map_xsize = 40,
+        .map_ysize = 40,
+        .num_ai_players = 2,
+        .ai_skill_level = 3,
+        .seed = 12345,
+        .fog_of_war = true,
+        .opponent_mode = FCGYM_OPPONENTS_FULL,
+    };
+    int turns = 30;
+    int episodes = 3;
+    double wall_start, wall_ms;
+    double busy_ms = 0.0;
+    long total_steps = 0;
+
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "-x") == 0) {
+            config.map_xsize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-y") == 0) {
+            config.map_ysize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-a") == 0) {
+            config.num_ai_players = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            config.ai_skill_level = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            turns = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-e") == 0) {
+            episodes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0) {
+            config.seed = (unsigned int)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0) {
+            const char *mode = argv[++i];
+            if (strcmp(mode, "full") == 0) {
+                config.opponent_mode = FCGYM_OPPONENTS_FULL;
+            } else if (strcmp(mode, "random") == 0) {
+                config.opponent_mode = FCGYM_OPPONENTS_RANDOM;
+            } else if (strcmp(mode, "idle") == 0) {
+                config.opponent_mode = FCGYM_OPPONENTS_IDLE;
+            } else {
+                fprintf(stderr, "Unknown opponent mode: %s\n", mode);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    printf("=== fcgym throughput benchmark ===\n");
+    printf("map %dx%d, %d AI players (skill %d, mode %d), "
+           "%d episodes x %d turns, seed %u\n\n",
+           config.map_xsize, config.map_ysize, config.num_ai_players,
+           config.ai_skill_level, config.opponent_mode,
+           episodes, turns, config.seed);
+
+    if (fcgym_init() != 0) {
+        fprintf(stderr, "Failed to initialize fcgym\n");
+        return 1;
+    }
+    srand(config.seed);
+
+    wall_start = now_ms();
+
+    for (int ep = 0; ep < episodes; ep++) {
+        double ep_start = now_ms();
+        /* Vary the map between episodes like training would */
+        config.seed += ep;
+
+        if (fcgym_new_game(&config) != 0) {
+            fprintf(stderr, "Failed to create game for episode %d\n", ep);
+            fcgym_shutdown();
+            return 1;
+        }
+
+        for (int turn = 0; turn < turns; turn++) {
+            FcValidActions valid = { 0 };
+            const FcObservation *obs;
+            FcAction end_turn = { .type = FCGYM_ACTION_END_TURN };
+            double t0, dt;
+
+            t0 = now_ms();
+            fcgym_get_valid_actions(&valid);
+            bucket_ms[BUCKET_VALID_ACTIONS] += now_ms() - t0;
+
+            /* One random action per unit, like a scripted policy */
+            for (int i = 0; i < valid.num_unit_actions; i++) {
+                if (random_unit_action(&valid, i)) {
+                    total_steps++;
+                }
+            }
+            fcgym_free_valid_actions(&valid);
+
+            t0 = now_ms();
+            fcgym_step(&end_turn);
+            dt = now_ms() - t0;
+            record_latency(dt);
+            bucket_ms[BUCKET_TURN_ADVANCE] += dt;
+            total_steps++;
+
+            t0 = now_ms();
+            obs = fcgym_update_observation();
+            bucket_ms[BUCKET_OBSERVATION] += now_ms() - t0;
+
+            if (obs == NULL || obs->game_over) {
+                break;
+            }
+        }
+
+        printf("episode %d: %.1f ms\n", ep, now_ms() - ep_start);
+    }
+
+    wall_ms = now_ms() - wall_start;
+
+    for (int b = 0; b < BUCKET_COUNT; b++) {
+        busy_ms += bucket_ms[b];
+    }
+
+    qsort(latencies, num_latencies, sizeof(double), cmp_double);
+
+    printf("\n=== Results ===\n");
+    printf("total steps:    %ld\n", total_steps);
+    printf("wall time:      %.1f ms\n", wall_ms);
+    printf("throughput:     %.1f steps/sec\n",
+           wall_ms > 0.0 ? total_steps * 1000.0 / wall_ms : 0.0);
+    printf("\nstep latency (ms):\n");
+    printf("  p50: %.3f  p90: %.3f  p99: %.3f  max: %.3f\n",
+           percentile(50.0), percentile(90.0), percentile(99.0),
+           num_latencies > 0 ? latencies[num_latencies - 1] : 0.0);
+    printf("\nbreakdown:\n");
+    for (int b = 0; b < BUCKET_COUNT; b++) {
+        printf("  %-20s %10.1f ms  (%.1f%%)\n", bucket_names[b],
+               bucket_ms[b],
+               busy_ms > 0.0 ? 100.0 * bucket_ms[b] / busy_ms : 0.0);
+    }
+    printf("  %-20s %10.1f ms\n", "other (setup etc.)", wall_ms - busy_ms);
+
+    free(latencies);
+    fcgym_shutdown();
+
+    return 0;
+}
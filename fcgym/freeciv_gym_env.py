@@ -36,6 +36,13 @@ MAX_CITIES = 64
 MAX_PLAYERS = 8
 MAP_CHANNELS = 9  # visibility, terrain, road, irrigation, mine, ownership_self, ownership_enemy, city, unit_visible
 
+# Opponent throttling modes (values match the C FcOpponentMode enum)
+OPPONENT_MODES = {
+    "full": 0,    # Default AI plays its whole phase
+    "random": 1,  # Scripted opponents: random unit moves only
+    "idle": 2,    # Opponents take no actions
+}
+
 # Module-level library state (shared across all env instances in this process)
 _lib_handle = None
 _library_initialized = False
@@ -96,6 +103,7 @@ ffi.cdef("""
         int ai_skill_level;
         unsigned int seed;
         bool fog_of_war;
+        int opponent_mode;
     } FcGameConfig;
 
     typedef struct {
@@ -159,6 +167,7 @@ ffi.cdef("""
 
         FcTileObs *tiles;
         int num_tiles;
+        int max_tiles;
 
         FcUnitObs *units;
         int num_units;
@@ -197,6 +206,20 @@ ffi.cdef("""
         bool can_buy;
     } FcCityActions;
 
+    typedef struct {
+        int *unit_ids;
+        uint32_t *unit_masks;
+        int num_units;
+        int *city_ids;
+        uint8_t *city_buildable;
+        uint8_t *city_can_buy;
+        int num_cities;
+        int num_targets;
+        uint8_t *researchable;
+        int num_techs;
+        bool can_end_turn;
+    } FcValidMask;
+
     typedef struct {
         FcUnitActions *unit_actions;
         int num_unit_actions;
@@ -224,19 +247,59 @@ ffi.cdef("""
         const char *info;
     } FcStepResult;
 
+    typedef struct {
+        bool full;
+        int *tiles;
+        int num_tiles;
+        bool units_changed;
+        bool cities_changed;
+        bool players_changed;
+    } FcObsDelta;
+
     int fcgym_init(void);
     void fcgym_shutdown(void);
     int fcgym_new_game(FcGameConfig *config);
     void fcgym_get_observation(FcObservation *obs);
     void fcgym_free_observation(FcObservation *obs);
+    const FcObservation *fcgym_update_observation(void);
+    const FcObsDelta *fcgym_update_observation_delta(void);
+    const FcObservation *fcgym_observation_buffer(void);
     void fcgym_get_valid_actions(FcValidActions *actions);
     void fcgym_free_valid_actions(FcValidActions *actions);
+    const FcValidMask *fcgym_update_valid_mask(void);
     FcStepResult fcgym_step(FcAction *action);
+    FcStepResult fcgym_step_batch(FcAction *actions, int num_actions);
     const char* fcgym_unit_type_name(int unit_type);
     const char* fcgym_tech_name(int tech_id);
 """)
 
 
+def _struct_dtype(cname, fields):
+    """Build a numpy dtype matching a cffi struct layout.
+
+    Offsets and itemsize come from cffi itself, so padding inserted by the
+    C compiler is handled automatically.  Used for zero-copy views of the
+    library-owned observation buffers.
+    """
+    return np.dtype({
+        "names": [name for name, _ in fields],
+        "formats": [fmt for _, fmt in fields],
+        "offsets": [ffi.offsetof(cname, name) for name, _ in fields],
+        "itemsize": ffi.sizeof(cname),
+    })
+
+
+_TILE_DTYPE = _struct_dtype("FcTileObs", [
+    ("terrain", np.int32),
+    ("owner", np.int32),
+    ("has_city", np.bool_),
+    ("has_unit", np.bool_),
+    ("visible", np.bool_),
+    ("explored", np.bool_),
+    ("extras", np.int8),
+])
+
+
 def _find_library():
     """Find the fcgym library (prefer shared library for CFFI)."""
     script_dir = os.path.dirname(os.path.abspath(__file__))
@@ -287,9 +350,17 @@ class FreecivGymEnv(gym.Env):
         fog_of_war: bool = True,
         max_legal_actions: int = MAX_LEGAL_ACTIONS,
         render_mode: Optional[str] = None,
+        use_delta_observations: bool = True,
+        opponent_mode: str = "full",
     ):
         super().__init__()
 
+        if opponent_mode not in OPPONENT_MODES:
+            raise ValueError(
+                f"opponent_mode must be one of {sorted(OPPONENT_MODES)}, "
+                f"got {opponent_mode!r}"
+            )
+
         self.ruleset = ruleset
         self.map_width = map_width
         self.map_height = map_height
@@ -297,8 +368,12 @@ class FreecivGymEnv(gym.Env):
         self.ai_skill_level = ai_skill_level
         self.seed = seed
         self.fog_of_war = fog_of_war
+        # How much work the built-in AI opponents do each turn; cheaper
+        # modes trade opponent strength for rollout throughput
+        self.opponent_mode = opponent_mode
         self.max_legal_actions = max_legal_actions
         self.render_mode = render_mode
+        self.use_delta_observations = use_delta_observations
 
         # Load library
         self._lib = None
@@ -310,6 +385,15 @@ class FreecivGymEnv(gym.Env):
         self._slot_to_unit_id: Dict[int, int] = {}
         self._slot_to_city_id: Dict[int, int] = {}
 
+        # Zero-copy view of the library-owned tile buffer.  The C side keeps
+        # the buffer address stable across steps, so the numpy view only
+        # needs rebuilding when the buffer actually moves (grows).
+        self._tiles_np = None
+        self._tiles_view_key = None
+
+        # Persistent map plane, patched in place from delta observations
+        self._map_plane = None
+
         # Current legal actions cache
         self._legal_actions = np.zeros((max_legal_actions, 4), dtype=np.int32)
         self._action_mask = np.zeros(max_legal_actions, dtype=np.float32)
@@ -410,6 +494,70 @@ class FreecivGymEnv(gym.Env):
         _library_initialized = True
         self._initialized = True
 
+    def _fetch_observation(self):
+        """Update the library observation buffer, returning (obs, delta).
+
+        delta is None when delta observations are disabled.
+        """
+        if self.use_delta_observations:
+            delta = self._lib.fcgym_update_observation_delta()
+            if delta == ffi.NULL:
+                raise RuntimeError("Failed to get observation")
+            return self._lib.fcgym_observation_buffer(), delta
+        obs = self._lib.fcgym_update_observation()
+        if obs == ffi.NULL:
+            raise RuntimeError("Failed to get observation")
+        return obs, None
+
+    def _tile_channels(self, tiles, controlled):
+        """Compute the MAP_CHANNELS values for a structured tile array.
+
+        Works on any array shape; used both for full rebuilds (2-D crop)
+        and for delta patches (1-D gather of changed tiles).
+        """
+        visible = tiles["visible"]
+        explored = tiles["explored"]
+        extras = tiles["extras"]
+        owner = tiles["owner"]
+
+        out = np.zeros((MAP_CHANNELS,) + tiles.shape, dtype=np.uint8)
+
+        # Channel 0: visibility (255=visible, 128=explored, 0=unknown)
+        out[0] = np.where(visible, 255, np.where(explored, 128, 0))
+
+        # Remaining channels only carry data for explored tiles
+        # (C side sets terrain=-1 for unexplored)
+        terrain = np.where(tiles["terrain"] >= 0, tiles["terrain"], 0)
+        out[1] = np.where(explored, terrain, 0)
+
+        # Channel 2-4: extras (road, irrigation, mine from extras bitfield)
+        out[2] = np.where(explored & ((extras & 0x01) != 0), 255, 0)
+        out[3] = np.where(explored & ((extras & 0x02) != 0), 255, 0)
+        out[4] = np.where(explored & ((extras & 0x04) != 0), 255, 0)
+
+        # Channel 5-6: ownership
+        out[5] = np.where(explored & (owner == controlled), 255, 0)
+        out[6] = np.where(explored & (owner >= 0) & (owner != controlled),
+                          255, 0)
+
+        # Channel 7: city presence
+        out[7] = np.where(explored & tiles["has_city"], 255, 0)
+
+        # Channel 8: unit presence (only set when currently visible)
+        out[8] = np.where(explored & tiles["has_unit"], 255, 0)
+
+        return out
+
+    def _tiles_view(self, obs):
+        """Zero-copy structured numpy view of the C tile array."""
+        key = (int(ffi.cast("uintptr_t", obs.tiles)), obs.num_tiles)
+        if self._tiles_view_key != key:
+            buf = ffi.buffer(obs.tiles,
+                             obs.num_tiles * ffi.sizeof("FcTileObs"))
+            self._tiles_np = np.frombuffer(buf, dtype=_TILE_DTYPE)
+            self._tiles_view_key = key
+        return self._tiles_np
+
     def _update_slot_mappings(self, obs):
         """Update stable slot mappings from observation.
 
@@ -565,8 +713,12 @@ class FreecivGymEnv(gym.Env):
 
         self._num_legal_actions = idx
 
-    def _build_observation(self, obs) -> Dict[str, np.ndarray]:
-        """Build observation dict from FcObservation."""
+    def _build_observation(self, obs, delta=None) -> Dict[str, np.ndarray]:
+        """Build observation dict from FcObservation.
+
+        When a delta is given and usable, the map planes are patched in
+        place instead of being rebuilt from every tile.
+        """
         # Global features
         global_obs = np.zeros(10, dtype=np.float32)
         global_obs[0] = obs.turn
@@ -584,53 +736,36 @@ class FreecivGymEnv(gym.Env):
         # Channels:
         #   0=visibility, 1=terrain, 2=road, 3=irrigation, 4=mine,
         #   5=ownership_self, 6=ownership_enemy, 7=city, 8=unit_visible
-        map_obs = np.zeros((MAP_CHANNELS, self.map_height, self.map_width), dtype=np.uint8)
         controlled = obs.controlled_player
-
-        for i in range(obs.num_tiles):
-            tile = obs.tiles[i]
-            x = i % obs.map_xsize
-            y = i // obs.map_xsize
-
-            # Skip if out of our observation bounds
-            if x >= self.map_width or y >= self.map_height:
-                continue
-
-            # Channel 0: visibility (255=visible, 128=explored, 0=unknown)
-            if tile.visible:
-                map_obs[0, y, x] = 255
-            elif tile.explored:
-                map_obs[0, y, x] = 128
-            # else: stays 0 (unknown)
-
-            # Only fill other channels if tile has been explored
-            # (C side sets terrain=-1 for unexplored, which becomes 255 as uint8)
-            if tile.explored:
-                # Channel 1: terrain type (only if explored)
-                map_obs[1, y, x] = tile.terrain if tile.terrain >= 0 else 0
-
-                # Channel 2-4: extras (road, irrigation, mine from extras bitfield)
-                if tile.extras & 0x01:
-                    map_obs[2, y, x] = 255  # road
-                if tile.extras & 0x02:
-                    map_obs[3, y, x] = 255  # irrigation
-                if tile.extras & 0x04:
-                    map_obs[4, y, x] = 255  # mine
-
-                # Channel 5-6: ownership
-                if tile.owner >= 0:
-                    if tile.owner == controlled:
-                        map_obs[5, y, x] = 255  # ownership_self
-                    else:
-                        map_obs[6, y, x] = 255  # ownership_enemy
-
-                # Channel 7: city presence
-                if tile.has_city:
-                    map_obs[7, y, x] = 255
-
-                # Channel 8: unit presence (only set when currently visible)
-                if tile.has_unit:
-                    map_obs[8, y, x] = 255
+        h = min(obs.map_ysize, self.map_height)
+        w = min(obs.map_xsize, self.map_width)
+
+        if self._map_plane is None or delta is None or delta.full:
+            # Full vectorized rebuild over a zero-copy view of the C tile
+            # buffer, cropped to our observation bounds
+            self._map_plane = np.zeros(
+                (MAP_CHANNELS, self.map_height, self.map_width),
+                dtype=np.uint8)
+            tiles = self._tiles_view(obs).reshape(
+                obs.map_ysize, obs.map_xsize)[:h, :w]
+            self._map_plane[:, :h, :w] = self._tile_channels(tiles, controlled)
+        elif delta.num_tiles > 0:
+            # Patch only the tiles the library reports as changed
+            idx = np.frombuffer(
+                ffi.buffer(delta.tiles, delta.num_tiles * ffi.sizeof("int")),
+                dtype=np.intc)
+            ys = idx // obs.map_xsize
+            xs = idx % obs.map_xsize
+            in_bounds = (ys < self.map_height) & (xs < self.map_width)
+            if not in_bounds.all():
+                idx = idx[in_bounds]
+                ys = ys[in_bounds]
+                xs = xs[in_bounds]
+            tiles = self._tiles_view(obs)[idx]
+            self._map_plane[:, ys, xs] = self._tile_channels(tiles, controlled)
+
+        # Copy so callers that store observations don't alias our plane
+        map_obs = self._map_plane.copy()
 
         # Units
         unit_obs = np.zeros((MAX_UNITS, 10), dtype=np.float32)
@@ -721,6 +856,37 @@ class FreecivGymEnv(gym.Env):
             "player_mask": player_mask,
         }
 
+    def valid_action_masks(self) -> Dict[str, Any]:
+        """Dense valid-action masks as zero-copy numpy views.
+
+        Returns per-unit bitmasks (see the FCGYM_UMASK_* bit layout in
+        fcgym.h), per-city buildable rows over the fixed production
+        target space (unit types first, then buildings), the buy flags
+        and the researchable-tech mask.  The views alias library-owned
+        memory and are overwritten by the next call.
+        """
+        m = self._lib.fcgym_update_valid_mask()
+        if m == ffi.NULL:
+            raise RuntimeError("No running game")
+
+        def view(ptr, count, dtype):
+            if count <= 0:
+                return np.empty(0, dtype=dtype)
+            size = count * np.dtype(dtype).itemsize
+            return np.frombuffer(ffi.buffer(ptr, size), dtype=dtype)
+
+        return {
+            "unit_ids": view(m.unit_ids, m.num_units, np.intc),
+            "unit_masks": view(m.unit_masks, m.num_units, np.uint32),
+            "city_ids": view(m.city_ids, m.num_cities, np.intc),
+            "city_buildable": view(
+                m.city_buildable, m.num_cities * m.num_targets,
+                np.uint8).reshape(m.num_cities, m.num_targets),
+            "city_can_buy": view(m.city_can_buy, m.num_cities, np.uint8),
+            "researchable": view(m.researchable, m.num_techs, np.uint8),
+            "can_end_turn": bool(m.can_end_turn),
+        }
+
     def _decode_action(self, action_idx: int) -> Tuple[int, int, int, int]:
         """Decode action index to (type, actor_id, target_id, sub_target)."""
         if action_idx < 0 or action_idx >= self._num_legal_actions:
@@ -775,14 +941,14 @@ class FreecivGymEnv(gym.Env):
         config.ai_skill_level = self.ai_skill_level
         config.seed = seed if seed is not None else (self.seed if self.seed is not None else 0)
         config.fog_of_war = self.fog_of_war
+        config.opponent_mode = OPPONENT_MODES[self.opponent_mode]
 
         result = self._lib.fcgym_new_game(config)
         if result != 0:
             raise RuntimeError("Failed to create new game")
 
-        # Get initial observation
-        obs = ffi.new("FcObservation *")
-        self._lib.fcgym_get_observation(obs)
+        # Get initial observation (library-owned persistent buffer)
+        obs, delta = self._fetch_observation()
 
         # Update slot mappings
         self._update_slot_mappings(obs)
@@ -793,7 +959,7 @@ class FreecivGymEnv(gym.Env):
         self._build_legal_actions(valid)
 
         # Build observation dict
-        observation = self._build_observation(obs)
+        observation = self._build_observation(obs, delta)
 
         info = {
             "turn": obs.turn,
@@ -807,8 +973,7 @@ class FreecivGymEnv(gym.Env):
         self._score_at_turn_start = self._get_our_score(obs)
         self._actions_taken_this_turn.clear()
 
-        # Free C memory
-        self._lib.fcgym_free_observation(obs)
+        # Free C memory (the observation buffer is library-owned)
         self._lib.fcgym_free_valid_actions(valid)
 
         return observation, info
@@ -823,29 +988,45 @@ class FreecivGymEnv(gym.Env):
 
     def step(self, action: int) -> Tuple[Dict[str, np.ndarray], float, bool, bool, Dict[str, Any]]:
         """Execute one step in the environment."""
-        # Decode action
-        action_type, actor_id, target_id, sub_target = self._decode_action(action)
+        return self.step_batch([action])
 
-        # Create FcAction
-        fc_action = ffi.new("FcAction *")
-        fc_action.type = action_type
-        fc_action.actor_id = actor_id
-        fc_action.target_id = target_id
-        fc_action.sub_target = sub_target
+    def step_batch(self, actions: List[int]) -> Tuple[Dict[str, np.ndarray], float, bool, bool, Dict[str, Any]]:
+        """Execute several actions with a single observation rebuild.
 
-        # Execute action
-        result = self._lib.fcgym_step(fc_action)
-
-        # Track decision actions for per-turn limiting
-        if action_type in self._decision_actions:
-            self._actions_taken_this_turn.add((action_type, actor_id))
-
-        # Get new observation
-        obs = ffi.new("FcObservation *")
-        self._lib.fcgym_get_observation(obs)
-
-        # Update slot mappings
-        self._update_slot_mappings(obs)
+        All actions are decoded against the legal-action table from the
+        last observation, so this is meant for submitting the orders for
+        the current turn in one go (optionally ending with END_TURN)
+        without paying the per-action observation cost.  Rewards are
+        summed by the C side; execution stops early if an action ends
+        the episode.
+        """
+        num = len(actions)
+        fc_actions = ffi.new("FcAction[]", max(num, 1))
+        ended_turn = False
+
+        for i, action in enumerate(actions):
+            # Decode action
+            action_type, actor_id, target_id, sub_target = self._decode_action(action)
+            fc_actions[i].type = action_type
+            fc_actions[i].actor_id = actor_id
+            fc_actions[i].target_id = target_id
+            fc_actions[i].sub_target = sub_target
+
+            # Track decision actions for per-turn limiting
+            if action_type in self._decision_actions:
+                self._actions_taken_this_turn.add((action_type, actor_id))
+            if action_type == FcActionType.END_TURN:
+                ended_turn = True
+
+        # Execute the whole batch in one call
+        result = self._lib.fcgym_step_batch(fc_actions, num)
+
+        # Get new observation (library-owned persistent buffer)
+        obs, delta = self._fetch_observation()
+
+        # Update slot mappings (stable unless the unit/city sets changed)
+        if delta is None or delta.units_changed or delta.cities_changed:
+            self._update_slot_mappings(obs)
 
         # Get valid actions
         valid = ffi.new("FcValidActions *")
@@ -853,13 +1034,13 @@ class FreecivGymEnv(gym.Env):
         self._build_legal_actions(valid)
 
         # Build observation dict
-        observation = self._build_observation(obs)
+        observation = self._build_observation(obs, delta)
 
         terminated = result.done or obs.game_over
         truncated = result.truncated
 
         # Turn-based rewards: only give reward when turn ends
-        turn_ended = (action_type == FcActionType.END_TURN) or (obs.turn != self._current_turn)
+        turn_ended = ended_turn or (obs.turn != self._current_turn)
 
         if turn_ended or terminated:
             # Reward = score change since turn start
@@ -880,8 +1061,7 @@ class FreecivGymEnv(gym.Env):
             "step_info": ffi.string(result.info).decode('utf-8') if result.info != ffi.NULL else "",
         }
 
-        # Free C memory
-        self._lib.fcgym_free_observation(obs)
+        # Free C memory (the observation buffer is library-owned)
         self._lib.fcgym_free_valid_actions(valid)
 
         return observation, reward, terminated, truncated, info
@@ -906,6 +1086,9 @@ class FreecivGymEnv(gym.Env):
         # Clear instance state but don't touch the shared library
         self._initialized = False
         self._lib = None
+        self._tiles_np = None
+        self._tiles_view_key = None
+        self._map_plane = None
         self._unit_id_to_slot.clear()
         self._city_id_to_slot.clear()
         self._slot_to_unit_id.clear()
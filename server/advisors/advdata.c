@@ -236,6 +236,206 @@ static void count_my_units(struct player *pplayer)
   } unit_list_iterate_end;
 }
 
+/*
+ * Per unit owner summary of the unit derived threat information consumed
+ * by adv_data_phase_init(). Maintained incrementally from unit creation,
+ * death, move and transform events, so that phase init does not have to
+ * rescan every unit list. Counts rather than booleans, so that a unit's
+ * death can subtract exactly what its creation added.
+ */
+struct adv_threat_profile {
+  int igwall_units;
+  int invasion_units;     /* Seaborne units able to take over cities, or
+                           * transports able to carry such units. */
+  int suicide_units;
+  int nuke_units;
+  int *ocean_threat;      /* Per-ocean count of offensive naval presence. */
+};
+
+static struct adv_threat_profile threat_profiles[MAX_NUM_PLAYER_SLOTS];
+
+/* Number of oceans the profiles were built for; < 0 means the profiles
+ * are invalid and the next adv_data_phase_init() does a full rebuild. */
+static int threat_profiles_oceans = -1;
+
+/* Nuke capable actions, cached when the profiles are rebuilt. */
+static action_id threat_nuke_actions[MAX_NUM_ACTIONS];
+
+/**********************************************************************//**
+  Add 'delta' to the ocean threat counts touched by an offensive naval
+  unit standing on ptile.
+**************************************************************************/
+static void threat_profile_ocean_apply(struct adv_threat_profile *prof,
+                                       const struct tile *ptile, int delta)
+{
+  if (is_ocean_tile(ptile)) {
+    Continent_id continent = tile_continent(ptile);
+
+    if (-continent > threat_profiles_oceans) {
+      /* Ocean numbering has changed under us; force a full rebuild. */
+      threat_profiles_oceans = -1;
+      return;
+    }
+    prof->ocean_threat[-continent] += delta;
+  } else {
+    adjc_iterate(&(wld.map), ptile, tile2) {
+      if (is_ocean_tile(tile2)) {
+        Continent_id continent = tile_continent(tile2);
+
+        if (-continent > threat_profiles_oceans) {
+          threat_profiles_oceans = -1;
+          return;
+        }
+        prof->ocean_threat[-continent] += delta;
+      }
+    } adjc_iterate_end;
+  }
+}
+
+/**********************************************************************//**
+  Add ('delta' == 1) or remove ('delta' == -1) one unit's contribution
+  to its owner's threat profile, evaluated as if the unit stood on ptile.
+**************************************************************************/
+static void threat_profile_unit_apply(const struct unit *punit,
+                                      const struct tile *ptile, int delta)
+{
+  struct adv_threat_profile *prof
+    = &threat_profiles[player_index(unit_owner(punit))];
+  const struct unit_type *putype = unit_type_get(punit);
+  const struct unit_class *pclass = utype_class(putype);
+
+  if (putype->adv.igwall) {
+    prof->igwall_units += delta;
+  }
+
+  if (pclass->adv.sea_move != MOVE_NONE) {
+    if (unit_can_take_over(punit)) {
+      prof->invasion_units += delta;
+    } else if (get_transporter_capacity(punit) > 0) {
+      unit_type_iterate(cargotype) {
+        if (can_unit_type_transport(putype, cargotype->uclass)
+            && utype_can_take_over(cargotype)) {
+          prof->invasion_units += delta;
+          break;
+        }
+      } unit_type_iterate_end;
+    }
+
+    if (putype->attack_strength > 1) {
+      threat_profile_ocean_apply(prof, ptile, delta);
+    }
+
+    /* Like adv_data_phase_init() used to, ignore missile and nuke
+     * capabilities of seaborne units. */
+    return;
+  }
+
+  if (utype_can_do_action(putype, ACTION_SUICIDE_ATTACK)
+      && putype->attack_strength > 1) {
+    prof->suicide_units += delta;
+  }
+
+  action_array_iterate(threat_nuke_actions, act_id) {
+    if (unit_can_do_action(punit, act_id)) {
+      prof->nuke_units += delta;
+      break;
+    }
+  } action_array_iterate_end;
+}
+
+/**********************************************************************//**
+  Rebuild every player's threat profile from scratch. Fallback used when
+  the profiles have been invalidated or ocean numbering has changed.
+**************************************************************************/
+static void threat_profiles_refresh(void)
+{
+  int i;
+
+  for (i = 0; i < MAX_NUM_PLAYER_SLOTS; i++) {
+    if (threat_profiles[i].ocean_threat != nullptr) {
+      FC_FREE(threat_profiles[i].ocean_threat);
+    }
+    memset(&threat_profiles[i], 0, sizeof(threat_profiles[i]));
+  }
+
+  threat_profiles_oceans = wld.map.num_oceans;
+
+  for (i = 0; i < MAX_NUM_PLAYER_SLOTS; i++) {
+    threat_profiles[i].ocean_threat
+      = fc_calloc(threat_profiles_oceans + 1,
+                  sizeof(*threat_profiles[i].ocean_threat));
+  }
+
+  i = 0;
+  action_array_add_all_by_result(threat_nuke_actions, &i, ACTRES_NUKE);
+  action_array_add_all_by_result(threat_nuke_actions, &i, ACTRES_NUKE_UNITS);
+  action_array_end(threat_nuke_actions, i);
+
+  players_iterate(aplayer) {
+    unit_list_iterate(aplayer->units, punit) {
+      threat_profile_unit_apply(punit, unit_tile(punit), +1);
+    } unit_list_iterate_end;
+  } players_iterate_end;
+}
+
+/**********************************************************************//**
+  A unit has entered play (or gained a new type); add it to its owner's
+  threat profile.
+**************************************************************************/
+void adv_threat_unit_created(const struct unit *punit)
+{
+  if (threat_profiles_oceans < 0) {
+    return;
+  }
+  threat_profile_unit_apply(punit, unit_tile(punit), +1);
+}
+
+/**********************************************************************//**
+  A unit is leaving play (or losing its current type); remove it from
+  its owner's threat profile.
+**************************************************************************/
+void adv_threat_unit_destroyed(const struct unit *punit)
+{
+  if (threat_profiles_oceans < 0) {
+    return;
+  }
+  threat_profile_unit_apply(punit, unit_tile(punit), -1);
+}
+
+/**********************************************************************//**
+  A unit has moved between the given tiles. Only the position dependent
+  part of the profile - the ocean threat counts - needs adjusting.
+**************************************************************************/
+void adv_threat_unit_moved(const struct unit *punit,
+                           const struct tile *from, const struct tile *to)
+{
+  const struct unit_type *putype = unit_type_get(punit);
+
+  if (threat_profiles_oceans < 0) {
+    return;
+  }
+
+  if (utype_class(putype)->adv.sea_move != MOVE_NONE
+      && putype->attack_strength > 1) {
+    struct adv_threat_profile *prof
+      = &threat_profiles[player_index(unit_owner(punit))];
+
+    threat_profile_ocean_apply(prof, from, -1);
+    if (threat_profiles_oceans >= 0) {
+      threat_profile_ocean_apply(prof, to, +1);
+    }
+  }
+}
+
+/**********************************************************************//**
+  Invalidate the threat profiles. The next adv_data_phase_init() call
+  rebuilds them from the unit lists.
+**************************************************************************/
+void adv_threat_invalidate(void)
+{
+  threat_profiles_oceans = -1;
+}
+
 /**********************************************************************//**
   Return whether data phase is currently open. Data phase is open
   between adv_data_phase_init() and adv_data_phase_done() calls.
@@ -307,6 +507,12 @@ bool adv_data_phase_init(struct player *pplayer, bool is_new_phase)
     }
   } whole_map_iterate_end;
 
+  if (threat_profiles_oceans != wld.map.num_oceans) {
+    /* Fallback: the profiles are invalid or the ocean numbering has
+     * changed since they were built. */
+    threat_profiles_refresh();
+  }
+
   players_iterate(aplayer) {
     if (!adv_is_player_dangerous(pplayer, aplayer)) {
       continue;
@@ -324,64 +530,40 @@ bool adv_data_phase_init(struct player *pplayer, bool is_new_phase)
       }
     } city_list_iterate_end;
 
-    unit_list_iterate(aplayer->units, punit) {
-      const struct unit_class *pclass = unit_class_get(punit);
+    {
+      const struct adv_threat_profile *prof
+        = &threat_profiles[player_index(aplayer)];
+      int i;
 
-      if (unit_type_get(punit)->adv.igwall) {
+      if (prof->igwall_units > 0) {
         adv->threats.igwall = TRUE;
       }
 
-      if (pclass->adv.sea_move != MOVE_NONE) {
-        /* If the enemy has not started sailing yet, or we have total
-         * control over the seas, don't worry, keep attacking. */
-        if (unit_can_take_over(punit)) {
-          /* Enemy represents a cross-continental threat! */
-          adv->threats.invasions = TRUE;
-        } else if (get_transporter_capacity(punit) > 0) {
-          unit_type_iterate(cargotype) {
-            if (can_unit_type_transport(unit_type_get(punit),
-                                        cargotype->uclass)
-                && utype_can_take_over(cargotype)) {
-              /* Enemy can transport some threatening units! */
-              adv->threats.invasions = TRUE;
-              break;
-            }
-          } unit_type_iterate_end;
-        }
+      /* If the enemy has not started sailing yet, or we have total
+       * control over the seas, don't worry, keep attacking. */
+      if (prof->invasion_units > 0) {
+        /* Enemy represents a cross-continental threat! */
+        adv->threats.invasions = TRUE;
+      }
 
-        /* The idea is that while our enemies don't have any offensive
-         * seaborne units, we don't have to worry. Go on the offensive! */
-        if (unit_type_get(punit)->attack_strength > 1) {
-          if (is_ocean_tile(unit_tile(punit))) {
-            Continent_id continent = tile_continent(unit_tile(punit));
-
-            adv->oceans[-continent].threat = TRUE;
-          } else {
-            adjc_iterate(&(wld.map), unit_tile(punit), tile2) {
-              if (is_ocean_tile(tile2)) {
-                Continent_id continent = tile_continent(tile2);
-
-                adv->oceans[-continent].threat = TRUE;
-              }
-            } adjc_iterate_end;
-          }
+      /* The idea is that while our enemies don't have any offensive
+       * seaborne units, we don't have to worry. Go on the offensive! */
+      for (i = 1; i <= adv->num_oceans; i++) {
+        if (prof->ocean_threat[i] > 0) {
+          adv->oceans[i].threat = TRUE;
         }
-        continue;
       }
 
       /* If our enemy builds missiles, worry about missile defense. */
-      if (utype_can_do_action(unit_type_get(punit), ACTION_SUICIDE_ATTACK)
-          && unit_type_get(punit)->attack_strength > 1) {
+      if (prof->suicide_units > 0) {
         adv->threats.suicide_attack = TRUE;
       }
 
       /* If they build nukes, worry a lot. */
-      action_array_iterate(nuke_actions, act_id) {
-        if (unit_can_do_action(punit, act_id)) {
-          danger_of_nukes = TRUE;
-        }
-      } action_array_iterate_end;
-    } unit_list_iterate_end;
+      if (prof->nuke_units > 0) {
+        danger_of_nukes = TRUE;
+      }
+    }
 
     /* Check for nuke capability */
     action_array_iterate(nuke_actions, act_id) {
@@ -155,6 +155,12 @@ bool is_adv_data_phase_open(struct player *pplayer);
 
 void adv_data_analyze_rulesets(struct player *pplayer);
 
+void adv_threat_unit_created(const struct unit *punit);
+void adv_threat_unit_destroyed(const struct unit *punit);
+void adv_threat_unit_moved(const struct unit *punit,
+                           const struct tile *from, const struct tile *to);
+void adv_threat_invalidate(void);
+
 struct adv_data *adv_data_get(struct player *pplayer, bool *close);
 
 adv_want adv_gov_action_immunity_want(struct government *gov);
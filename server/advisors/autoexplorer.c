@@ -20,6 +20,7 @@
 /* utility */
 #include "bitvector.h"
 #include "log.h"
+#include "mem.h"
 
 /* common */
 #include "ai.h"
@@ -45,6 +46,111 @@
 #include "autoexplorer.h"
 
 
+/*
+ * Per-player exploration frontier: the known tiles bordering unknown
+ * ones. All of a player's explorers share one frontier; it is kept up
+ * to date from map_set_known() as tiles become known.
+ */
+struct explorer_frontier {
+  bool *tiles;      /* Indexed by tile index; TRUE on the frontier. */
+  int size;         /* Map size the array was allocated for. */
+  bool valid;
+};
+
+static struct explorer_frontier frontiers[MAX_NUM_PLAYER_SLOTS];
+
+/**********************************************************************//**
+  Is ptile on pplayer's exploration frontier, i.e. known with at least
+  one unknown adjacent tile?
+**************************************************************************/
+static bool explorer_frontier_tile_check(const struct player *pplayer,
+                                         const struct tile *ptile)
+{
+  if (!map_is_known(ptile, pplayer)) {
+    return FALSE;
+  }
+
+  adjc_iterate(&(wld.map), ptile, ptile1) {
+    if (!map_is_known(ptile1, pplayer)) {
+      return TRUE;
+    }
+  } adjc_iterate_end;
+
+  return FALSE;
+}
+
+/**********************************************************************//**
+  Rebuild pplayer's frontier from scratch, (re)allocating the backing
+  array as needed.
+**************************************************************************/
+static void explorer_frontier_refresh(struct player *pplayer)
+{
+  struct explorer_frontier *pfront = &frontiers[player_index(pplayer)];
+
+  if (pfront->tiles == NULL || pfront->size != MAP_INDEX_SIZE) {
+    if (pfront->tiles != NULL) {
+      FC_FREE(pfront->tiles);
+    }
+    pfront->tiles = fc_calloc(MAP_INDEX_SIZE, sizeof(*pfront->tiles));
+    pfront->size = MAP_INDEX_SIZE;
+  } else {
+    memset(pfront->tiles, 0, MAP_INDEX_SIZE * sizeof(*pfront->tiles));
+  }
+
+  whole_map_iterate(&(wld.map), ptile) {
+    if (explorer_frontier_tile_check(pplayer, ptile)) {
+      pfront->tiles[tile_index(ptile)] = TRUE;
+    }
+  } whole_map_iterate_end;
+
+  pfront->valid = TRUE;
+}
+
+/**********************************************************************//**
+  Return pplayer's frontier array, rebuilding it first if it is not
+  valid for the current map.
+**************************************************************************/
+static const bool *explorer_frontier_get(struct player *pplayer)
+{
+  struct explorer_frontier *pfront = &frontiers[player_index(pplayer)];
+
+  if (!pfront->valid || pfront->size != MAP_INDEX_SIZE) {
+    explorer_frontier_refresh(pplayer);
+  }
+
+  return pfront->tiles;
+}
+
+/**********************************************************************//**
+  ptile has just become known to pplayer. Frontier membership can only
+  have changed for the tile itself and its neighbours.
+**************************************************************************/
+void explorer_frontier_tile_known(struct player *pplayer,
+                                  struct tile *ptile)
+{
+  struct explorer_frontier *pfront = &frontiers[player_index(pplayer)];
+
+  if (!pfront->valid || pfront->size != MAP_INDEX_SIZE) {
+    /* Rebuilt lazily when next consulted. */
+    return;
+  }
+
+  pfront->tiles[tile_index(ptile)]
+    = explorer_frontier_tile_check(pplayer, ptile);
+  adjc_iterate(&(wld.map), ptile, ptile1) {
+    pfront->tiles[tile_index(ptile1)]
+      = explorer_frontier_tile_check(pplayer, ptile1);
+  } adjc_iterate_end;
+}
+
+/**********************************************************************//**
+  Invalidate pplayer's frontier; used when tiles become unknown again.
+**************************************************************************/
+void explorer_frontier_invalidate(struct player *pplayer)
+{
+  frontiers[player_index(pplayer)].valid = FALSE;
+}
+
 /**********************************************************************//**
   Determine if a tile is likely to be native, given information that
   the player actually has. Return the % certainty that it's native
@@ -301,6 +407,13 @@ enum unit_move_result manage_auto_explorer(struct unit *punit)
 
   const struct civ_map *nmap = &(wld.map);
 
+  /* Scoring a tile is expensive; restrict it to the shared exploration
+   * frontier (plus hut tiles) whenever the frontier is a superset of the
+   * tiles explorer_desirable() can value, i.e. when the unit cannot see
+   * past adjacent tiles. */
+  const bool *frontier = explorer_frontier_get(pplayer);
+  bool frontier_only = unit_type_get(punit)->vision_radius_sq <= 2;
+
 #define DIST_FACTOR   0.6
 
   double logDF = log(DIST_FACTOR);
@@ -329,6 +442,12 @@ enum unit_move_result manage_auto_explorer(struct unit *punit)
     /* Our callback should insure this. */
     fc_assert_action(map_is_known(ptile, pplayer), continue);
 
+    if (frontier_only && !frontier[tile_index(ptile)]
+        && !hut_on_tile(ptile)) {
+      /* Nothing to uncover and no hut to enter here. */
+      continue;
+    }
+
     desirable = explorer_desirable(ptile, pplayer, punit);
 
     if (desirable <= 0) {
@@ -13,8 +13,14 @@
 #ifndef FC__AUTOEXPLORER_H
 #define FC__AUTOEXPLORER_H
 
+struct player;
+struct tile;
 struct unit;
 
 enum unit_move_result manage_auto_explorer(struct unit *punit);
 
+void explorer_frontier_tile_known(struct player *pplayer,
+                                  struct tile *ptile);
+void explorer_frontier_invalidate(struct player *pplayer);
+
 #endif /* FC__AUTOEXPLORER_H */
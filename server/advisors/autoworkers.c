@@ -20,6 +20,7 @@
 #include <string.h>
 
 /* utility */
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "support.h"
@@ -28,6 +29,8 @@
 /* common */
 #include "ai.h"
 #include "city.h"
+#include "combat.h"
+#include "effects.h"
 #include "game.h"
 #include "government.h"
 #include "map.h"
@@ -46,6 +49,7 @@
 #include "maphand.h"
 #include "plrhand.h"
 #include "srv_log.h"
+#include "srv_main.h"
 #include "unithand.h"
 #include "unittools.h"
 
@@ -422,383 +426,557 @@ autoworker_tile_behavior(const struct tile *ptile,
   return TB_NORMAL;
 }
 
-/**********************************************************************//**
-  Finds tiles to improve, using punit.
+/* Maximum number of threads fanning out candidate task evaluation. */
+#define AW_EVAL_THREADS 4
+/* Minimum number of cities before evaluation is fanned out at all. */
+#define AW_EVAL_MIN_CITIES 8
+
+/*
+ * Raw inputs of a candidate task, kept so that a thread's winning
+ * candidate can be replayed through consider_worker_action() when the
+ * per-thread results are merged.
+ */
+struct aw_candidate {
+  enum unit_activity act;
+  struct extra_type *target;
+  adv_want extra;
+  adv_want base_value;
+  adv_want oldv;
+  bool in_use;
+  int turns;
+  struct tile *ptile;
+};
 
-  The returned value is the goodness of the best tile and action found.
-  If this return value is > 0, then best_tile indicates the tile chosen,
-  bestact indicates the activity it wants to do, and path (if not NULL)
-  indicates the path to follow for the unit. If 0 is returned
-  then there are no worthwhile activities available.
+/*
+ * Everything the evaluation of one city reads, plus the running best;
+ * each thread owns one instance when evaluation is fanned out.
+ */
+struct aw_city_eval {
+  const struct civ_map *nmap;
+  struct unit *punit;
+  struct pf_map *pfm;
+  bool omniscience;
+  struct workermap *state;
 
-  completion_time is the time that would be taken by punit to travel to
-  and complete work at best_tile
+  adv_want best_newv;
+  adv_want best_oldv;
+  int best_extra;
+  bool improve_worked;
+  int best_delay;
+  enum unit_activity best_act;
+  struct extra_type *best_target;
+  struct tile *best_tile;
 
-  state contains, for each tile, the unit id of the worker en route,
-  and the eta of this worker (if any). This information
-  is used to possibly displace this previously assigned worker.
-  if this array is NULL, workers are never displaced.
+  bool have_winner;
+  struct aw_candidate winner;
+};
+
+struct aw_eval_thread {
+  struct aw_city_eval ev;
+  struct city_list *cities;
+  int stride, offset;
+  fc_thread thread;
+};
+
+/**********************************************************************//**
+  Feed one candidate into the running best of 'ev', remembering the raw
+  inputs of whichever candidate is currently winning.
 **************************************************************************/
-adv_want worker_evaluate_improvements(const struct civ_map *nmap,
-                                      struct unit *punit,
-                                      enum unit_activity *best_act,
-                                      struct extra_type **best_target,
-                                      struct tile **best_tile,
-                                      struct pf_path **ppath,
-                                      struct workermap *state)
+static void aw_eval_consider(struct aw_city_eval *ev,
+                             enum unit_activity act,
+                             struct extra_type *target,
+                             adv_want extra, adv_want base_value,
+                             adv_want oldv, bool in_use, int turns,
+                             struct tile *ptile)
 {
+  const struct player *pplayer = unit_owner(ev->punit);
+  struct tile *was_tile = ev->best_tile;
+  enum unit_activity was_act = ev->best_act;
+  struct extra_type *was_target = ev->best_target;
+  int was_delay = ev->best_delay;
+
+  consider_worker_action(pplayer, act, target, extra, base_value, oldv,
+                         in_use, turns,
+                         &ev->best_newv, &ev->best_oldv, &ev->best_extra,
+                         &ev->improve_worked, &ev->best_delay,
+                         &ev->best_act, &ev->best_target, &ev->best_tile,
+                         ptile);
+
+  if (ev->best_tile != was_tile || ev->best_act != was_act
+      || ev->best_target != was_target || ev->best_delay != was_delay) {
+    ev->winner.act = act;
+    ev->winner.target = target;
+    ev->winner.extra = extra;
+    ev->winner.base_value = base_value;
+    ev->winner.oldv = oldv;
+    ev->winner.in_use = in_use;
+    ev->winner.turns = turns;
+    ev->winner.ptile = ptile;
+    ev->have_winner = TRUE;
+  }
+}
+
+/**********************************************************************//**
+  Evaluate every candidate worker task in one city's radius against the
+  running best of 'ev'. Reads map, city and unit state but writes only
+  to 'ev', so several instances may run concurrently as long as the
+  path-finding map is completely filled beforehand.
+**************************************************************************/
+static void aw_evaluate_city(struct aw_city_eval *ev, struct city *pcity)
+{
+  const struct civ_map *nmap = ev->nmap;
+  struct unit *punit = ev->punit;
+  struct pf_map *pfm = ev->pfm;
+  struct workermap *state = ev->state;
   const struct player *pplayer = unit_owner(punit);
-  struct pf_parameter parameter;
-  struct pf_map *pfm;
+  bool omniscience = ev->omniscience;
   struct pf_position pos;
   adv_want oldv;             /* Current value of consideration tile. */
-  adv_want best_oldv = 9999; /* oldv of best target so far; compared if
-                              * newv == best_newv; not initialized to zero,
-                              * so that newv = 0 activities are not chosen. */
-  adv_want best_newv = 0;
-  bool improve_worked = FALSE;
-  int best_extra = 0;
-  int best_delay = 0;
-
-  /* Closest worker, if any, headed towards target tile */
   struct unit *enroute = NULL;
+  struct tile *pcenter = city_tile(pcity);
 
-  pft_fill_unit_parameter(&parameter, nmap, punit);
-  parameter.omniscience = !has_handicap(pplayer, H_MAP);
-  parameter.get_TB = autoworker_tile_behavior;
-  pfm = pf_map_new(&parameter);
+  /* Try to work near the city */
+  city_tile_iterate_index(nmap, city_map_radius_sq_get(pcity), pcenter, ptile,
+                          cindex) {
+    bool consider = TRUE;
+    bool in_use = (tile_worked(ptile) == pcity);
 
-  city_list_iterate(pplayer->cities, pcity) {
-    struct tile *pcenter = city_tile(pcity);
+    if (!in_use && !city_can_work_tile(pcity, ptile)) {
+      /* Don't risk bothering with this tile. */
+      continue;
+    }
 
-    /* Try to work near the city */
-    city_tile_iterate_index(nmap, city_map_radius_sq_get(pcity), pcenter, ptile,
-                            cindex) {
-      bool consider = TRUE;
-      bool in_use = (tile_worked(ptile) == pcity);
+    if (!adv_worker_safe_tile(nmap, pplayer, punit, ptile)) {
+      /* Too dangerous place */
+      continue;
+    }
 
-      if (!in_use && !city_can_work_tile(pcity, ptile)) {
-        /* Don't risk bothering with this tile. */
-        continue;
+    /* Do not go to tiles that already have workers there. */
+    unit_list_iterate(ptile->units, aunit) {
+      if (unit_owner(aunit) == pplayer
+          && aunit->id != punit->id
+          && unit_has_type_flag(aunit, UTYF_WORKERS)) {
+        consider = FALSE;
       }
+    } unit_list_iterate_end;
 
-      if (!adv_worker_safe_tile(nmap, pplayer, punit, ptile)) {
-        /* Too dangerous place */
-        continue;
-      }
+    if (!consider) {
+      continue;
+    }
 
-      /* Do not go to tiles that already have workers there. */
-      unit_list_iterate(ptile->units, aunit) {
-        if (unit_owner(aunit) == pplayer
-            && aunit->id != punit->id
-            && unit_has_type_flag(aunit, UTYF_WORKERS)) {
-          consider = FALSE;
-        }
-      } unit_list_iterate_end;
+    if (state) {
+      enroute = player_unit_by_number(pplayer,
+                                      state[tile_index(ptile)].enroute);
+    }
 
-      if (!consider) {
-        continue;
-      }
+    if (pf_map_position(pfm, ptile, &pos)) {
+      int eta = FC_INFINITY, inbound_distance = FC_INFINITY, turns;
 
-      if (state) {
-        enroute = player_unit_by_number(pplayer,
-                                        state[tile_index(ptile)].enroute);
+      if (enroute) {
+        eta = state[tile_index(ptile)].eta;
+        inbound_distance = real_map_distance(ptile, unit_tile(enroute));
       }
 
-      if (pf_map_position(pfm, ptile, &pos)) {
-        int eta = FC_INFINITY, inbound_distance = FC_INFINITY, turns;
+      /* Only consider this tile if we are closer in time and space to
+       * it than our other worker (if any) travelling to the site. */
+      if ((enroute && enroute->id == punit->id)
+          || pos.turn < eta
+          || (pos.turn == eta
+              && (real_map_distance(ptile, unit_tile(punit))
+                  < inbound_distance))) {
 
         if (enroute) {
-          eta = state[tile_index(ptile)].eta;
-          inbound_distance = real_map_distance(ptile, unit_tile(enroute));
+          UNIT_LOG(LOG_DEBUG, punit,
+                   "Considering (%d, %d) because we're closer "
+                   "(%d, %d) than %d (%d, %d)",
+                   TILE_XY(ptile), pos.turn,
+                   real_map_distance(ptile, unit_tile(punit)),
+                   enroute->id, eta, inbound_distance);
         }
 
-        /* Only consider this tile if we are closer in time and space to
-         * it than our other worker (if any) travelling to the site. */
-        if ((enroute && enroute->id == punit->id)
-            || pos.turn < eta
-            || (pos.turn == eta
-                && (real_map_distance(ptile, unit_tile(punit))
-                    < inbound_distance))) {
-
-          if (enroute) {
-            UNIT_LOG(LOG_DEBUG, punit,
-                     "Considering (%d, %d) because we're closer "
-                     "(%d, %d) than %d (%d, %d)",
-                     TILE_XY(ptile), pos.turn,
-                     real_map_distance(ptile, unit_tile(punit)),
-                     enroute->id, eta, inbound_distance);
+        oldv = city_tile_value(pcity, ptile, 0, 0);
+
+        /* Now, consider various activities... */
+        aw_transform_action_iterate(act) {
+          struct extra_type *target = NULL;
+          enum extra_cause cause =
+              activity_to_extra_cause(action_id_get_activity(act));
+          enum extra_rmcause rmcause =
+              activity_to_extra_rmcause(action_id_get_activity(act));
+
+          if (cause != EC_NONE) {
+            target = next_extra_for_tile(ptile, cause, pplayer,
+                                         punit);
+          } else if (rmcause != ERM_NONE) {
+            target = prev_extra_in_tile(ptile, rmcause, pplayer,
+                                        punit);
           }
 
-          oldv = city_tile_value(pcity, ptile, 0, 0);
-
-          /* Now, consider various activities... */
-          aw_transform_action_iterate(act) {
-            struct extra_type *target = NULL;
-            enum extra_cause cause =
-                activity_to_extra_cause(action_id_get_activity(act));
-            enum extra_rmcause rmcause =
-                activity_to_extra_rmcause(action_id_get_activity(act));
-
-            if (cause != EC_NONE) {
-              target = next_extra_for_tile(ptile, cause, pplayer,
-                                           punit);
-            } else if (rmcause != ERM_NONE) {
-              target = prev_extra_in_tile(ptile, rmcause, pplayer,
-                                          punit);
+          if (adv_city_worker_act_get(pcity, cindex,
+                                      action_id_get_activity(act)) >= 0
+              && action_prob_possible(
+                action_speculate_unit_on_tile(nmap, act,
+                                              punit, unit_home(punit),
+                                              ptile,
+                                              omniscience,
+                                              ptile, target))) {
+            adv_want base_value
+              = adv_city_worker_act_get(pcity, cindex,
+                                        action_id_get_activity(act));
+
+            turns = pos.turn
+                + get_turns_for_activity_at(punit,
+                                            action_id_get_activity(act),
+                                            ptile, target);
+            if (pos.moves_left == 0) {
+              /* We need moves left to begin activity immediately. */
+              turns++;
             }
 
-            if (adv_city_worker_act_get(pcity, cindex,
-                                        action_id_get_activity(act)) >= 0
-                && action_prob_possible(
-                  action_speculate_unit_on_tile(nmap, act,
-                                                punit, unit_home(punit),
-                                                ptile,
-                                                parameter.omniscience,
-                                                ptile, target))) {
-              adv_want base_value
-                = adv_city_worker_act_get(pcity, cindex,
-                                          action_id_get_activity(act));
-
-              turns = pos.turn
-                  + get_turns_for_activity_at(punit,
-                                              action_id_get_activity(act),
-                                              ptile, target);
-              if (pos.moves_left == 0) {
-                /* We need moves left to begin activity immediately. */
-                turns++;
+            aw_eval_consider(ev,
+                                   action_id_get_activity(act),
+                                   target, 0.0, base_value,
+                                   oldv, in_use, turns,
+                                   ptile);
+
+          } /* endif: can the worker perform this action */
+        } aw_transform_action_iterate_end;
+
+        extra_type_iterate(pextra) {
+          enum unit_activity act = ACTIVITY_LAST;
+          enum unit_activity eval_act = ACTIVITY_LAST;
+          adv_want base_value;
+          bool removing = tile_has_extra(ptile, pextra);
+
+          if (removing) {
+            aw_rmextra_action_iterate(try_act) {
+              struct action *taction = action_by_number(try_act);
+
+              if (is_extra_removed_by_action(pextra, taction)) {
+                /* We do not even evaluate actions we can't do.
+                 * Removal is not considered prerequisite for anything */
+                if (action_prob_possible(
+                      action_speculate_unit_on_tile(nmap, try_act,
+                                                    punit,
+                                                    unit_home(punit),
+                                                    ptile,
+                                                    omniscience,
+                                                    ptile, pextra))) {
+                  act = action_get_activity(taction);
+                  eval_act = action_get_activity(taction);
+                  break;
+                }
+              }
+            } aw_rmextra_action_iterate_end;
+          } else {
+            aw_extra_action_iterate(try_act) {
+              struct action *taction = action_by_number(try_act);
+
+              if (is_extra_caused_by_action(pextra, taction)) {
+                eval_act = action_id_get_activity(try_act);
+                if (action_prob_possible(
+                      action_speculate_unit_on_tile(nmap, try_act,
+                                                    punit,
+                                                    unit_home(punit),
+                                                    ptile,
+                                                    omniscience,
+                                                    ptile, pextra))) {
+                  act = action_get_activity(taction);
+                  break;
+                }
               }
+            } aw_extra_action_iterate_end;
+          }
 
-              consider_worker_action(pplayer,
-                                     action_id_get_activity(act),
-                                     target, 0.0, base_value,
-                                     oldv, in_use, turns,
-                                     &best_newv, &best_oldv, &best_extra,
-                                     &improve_worked,
-                                     &best_delay, best_act, best_target,
-                                     best_tile, ptile);
+          if (eval_act == ACTIVITY_LAST) {
+            /* No activity can provide (or remove) the extra */
+            continue;
+          }
 
-            } /* endif: can the worker perform this action */
-          } aw_transform_action_iterate_end;
+          if (removing) {
+            base_value = adv_city_worker_rmextra_get(pcity, cindex, pextra);
+          } else {
+            base_value = adv_city_worker_extra_get(pcity, cindex, pextra);
+          }
 
-          extra_type_iterate(pextra) {
-            enum unit_activity act = ACTIVITY_LAST;
-            enum unit_activity eval_act = ACTIVITY_LAST;
-            adv_want base_value;
-            bool removing = tile_has_extra(ptile, pextra);
+          if (base_value >= 0) {
+            adv_want extra;
+            struct road_type *proad;
 
-            if (removing) {
-              aw_rmextra_action_iterate(try_act) {
-                struct action *taction = action_by_number(try_act);
-
-                if (is_extra_removed_by_action(pextra, taction)) {
-                  /* We do not even evaluate actions we can't do.
-                   * Removal is not considered prerequisite for anything */
-                  if (action_prob_possible(
-                        action_speculate_unit_on_tile(nmap, try_act,
-                                                      punit,
-                                                      unit_home(punit),
-                                                      ptile,
-                                                      parameter.omniscience,
-                                                      ptile, pextra))) {
-                    act = action_get_activity(taction);
-                    eval_act = action_get_activity(taction);
-                    break;
+            turns = pos.turn + get_turns_for_activity_at(punit, eval_act,
+                                                         ptile, pextra);
+            if (pos.moves_left == 0) {
+              /* We need moves left to begin activity immediately. */
+              turns++;
+            }
+
+            proad = extra_road_get(pextra);
+
+            if (proad != NULL && road_provides_move_bonus(proad)) {
+              int mc_multiplier = 1;
+              int mc_divisor = 1;
+              int old_move_cost = tile_terrain(ptile)->movement_cost * SINGLE_MOVE;
+
+              /* Here 'old' means actually 'without the evaluated': In case of
+               * removal activity it's the value after the removal. */
+
+              extra_type_by_cause_iterate(EC_ROAD, pold) {
+                if (tile_has_extra(ptile, pold) && pold != pextra) {
+                  struct road_type *po_road = extra_road_get(pold);
+
+                  /* This ignores the fact that new road may be native to units that
+                   * old road is not. */
+                  if (po_road->move_cost < old_move_cost) {
+                    old_move_cost = po_road->move_cost;
                   }
                 }
-              } aw_rmextra_action_iterate_end;
-            } else {
-              aw_extra_action_iterate(try_act) {
-                struct action *taction = action_by_number(try_act);
-
-                if (is_extra_caused_by_action(pextra, taction)) {
-                  eval_act = action_id_get_activity(try_act);
-                  if (action_prob_possible(
-                        action_speculate_unit_on_tile(nmap, try_act,
-                                                      punit,
-                                                      unit_home(punit),
-                                                      ptile,
-                                                      parameter.omniscience,
-                                                      ptile, pextra))) {
-                    act = action_get_activity(taction);
-                    break;
+              } extra_type_by_cause_iterate_end;
+
+              if (proad->move_cost < old_move_cost) {
+                if (proad->move_cost >= terrain_control.move_fragments) {
+                  mc_divisor = proad->move_cost / terrain_control.move_fragments;
+                } else {
+                  if (proad->move_cost == 0) {
+                    mc_multiplier = 2;
+                  } else {
+                    mc_multiplier = 1 - proad->move_cost;
                   }
+                  mc_multiplier += old_move_cost;
                 }
-              } aw_extra_action_iterate_end;
-            }
+              }
 
-            if (eval_act == ACTIVITY_LAST) {
-              /* No activity can provide (or remove) the extra */
-              continue;
-            }
+              extra = adv_workers_road_bonus(nmap, ptile, proad)
+                * mc_multiplier / mc_divisor;
 
-            if (removing) {
-              base_value = adv_city_worker_rmextra_get(pcity, cindex, pextra);
             } else {
-              base_value = adv_city_worker_extra_get(pcity, cindex, pextra);
+              extra = 0;
             }
 
-            if (base_value >= 0) {
-              adv_want extra;
-              struct road_type *proad;
-
-              turns = pos.turn + get_turns_for_activity_at(punit, eval_act,
-                                                           ptile, pextra);
-              if (pos.moves_left == 0) {
-                /* We need moves left to begin activity immediately. */
-                turns++;
-              }
+            if (extra_has_flag(pextra, EF_GLOBAL_WARMING)) {
+              extra -= pplayer->ai_common.warmth;
+            }
+            if (extra_has_flag(pextra, EF_NUCLEAR_WINTER)) {
+              extra -= pplayer->ai_common.frost;
+            }
 
-              proad = extra_road_get(pextra);
+            if (removing) {
+              extra = -extra;
+            }
 
-              if (proad != NULL && road_provides_move_bonus(proad)) {
-                int mc_multiplier = 1;
-                int mc_divisor = 1;
-                int old_move_cost = tile_terrain(ptile)->movement_cost * SINGLE_MOVE;
+            if (act != ACTIVITY_LAST) {
+              aw_eval_consider(ev, act, pextra, extra, base_value,
+                                     oldv, in_use, turns,
+                                     ptile);
+            } else {
+              fc_assert(!removing);
+
+              road_deps_iterate(&(pextra->reqs), pdep) {
+                struct extra_type *dep_tgt;
+
+                dep_tgt = road_extra_get(pdep);
+
+                if (action_prob_possible(
+                      action_speculate_unit_on_tile(nmap, ACTION_ROAD,
+                                                    punit, unit_home(punit), ptile,
+                                                    omniscience,
+                                                    ptile, dep_tgt))) {
+                  /* Consider building dependency road for later upgrade to target extra.
+                   * Here we set value to be sum of dependency
+                   * road and target extra values, which increases want, and turns is sum
+                   * of dependency and target build turns, which decreases want. This can
+                   * result in either bigger or lesser want than when checking dependency
+                   * road for the sake of itself when its turn in extra_type_iterate() is. */
+                  int dep_turns
+                    = turns + get_turns_for_activity_at(punit,
+                                                        ACTIVITY_GEN_ROAD,
+                                                        ptile, dep_tgt);
+                  adv_want dep_value
+                    = base_value + adv_city_worker_extra_get(pcity, cindex,
+                                                             dep_tgt);
+
+                  aw_eval_consider(ev, ACTIVITY_GEN_ROAD,
+                                         dep_tgt, extra, dep_value,
+                                         oldv, in_use, dep_turns,
+                                         ptile);
+                }
+              } road_deps_iterate_end;
 
-                /* Here 'old' means actually 'without the evaluated': In case of
-                 * removal activity it's the value after the removal. */
+              extra_deps_iterate(&(pextra->reqs), pdep) {
+                /* Roads handled above already */
+                if (!is_extra_caused_by(pdep, EC_ROAD)) {
+                  enum unit_activity eval_dep_act = ACTIVITY_LAST;
+                  action_id eval_dep_action;
 
-                extra_type_by_cause_iterate(EC_ROAD, pold) {
-                  if (tile_has_extra(ptile, pold) && pold != pextra) {
-                    struct road_type *po_road = extra_road_get(pold);
+                  aw_extra_action_iterate(try_act) {
+                    struct action *taction = action_by_number(try_act);
 
-                    /* This ignores the fact that new road may be native to units that
-                     * old road is not. */
-                    if (po_road->move_cost < old_move_cost) {
-                      old_move_cost = po_road->move_cost;
+                    if (is_extra_caused_by_action(pdep, taction)) {
+                      eval_dep_action = try_act;
+                      eval_dep_act = action_id_get_activity(try_act);
+                      break;
                     }
-                  }
-                } extra_type_by_cause_iterate_end;
-
-                if (proad->move_cost < old_move_cost) {
-                  if (proad->move_cost >= terrain_control.move_fragments) {
-                    mc_divisor = proad->move_cost / terrain_control.move_fragments;
-                  } else {
-                    if (proad->move_cost == 0) {
-                      mc_multiplier = 2;
-                    } else {
-                      mc_multiplier = 1 - proad->move_cost;
+                  } aw_extra_action_iterate_end;
+
+                  if (eval_dep_act != ACTIVITY_LAST) {
+                    if (action_prob_possible(
+                          action_speculate_unit_on_tile(nmap, eval_dep_action,
+                                                        punit, unit_home(punit), ptile,
+                                                        omniscience,
+                                                        ptile, pdep))) {
+                      /* Consider building dependency extra for later upgrade to
+                       * target extra. See similar road implementation above for
+                       * extended commentary. */
+                      int dep_turns
+                        = turns + get_turns_for_activity_at(punit,
+                                                            eval_dep_act,
+                                                            ptile, pdep);
+                      adv_want dep_value
+                        = base_value + adv_city_worker_extra_get(pcity,
+                                                                 cindex,
+                                                                 pdep);
+
+                      aw_eval_consider(ev, eval_dep_act, pdep,
+                                             0.0, dep_value, oldv, in_use,
+                                             dep_turns, ptile);
                     }
-                    mc_multiplier += old_move_cost;
                   }
                 }
+              } extra_deps_iterate_end;
+            }
+          }
+        } extra_type_iterate_end;
+      } /* endif: can we arrive sooner than current worker, if any? */
+    } /* endif: are we travelling to a legal destination? */
+  } city_tile_iterate_index_end;
+}
 
-                extra = adv_workers_road_bonus(nmap, ptile, proad)
-                  * mc_multiplier / mc_divisor;
+/**********************************************************************//**
+  Worker function of one evaluation thread: every AW_EVAL_THREADS'th
+  city, starting at the thread's offset.
+**************************************************************************/
+static void aw_eval_thread_run(void *arg)
+{
+  struct aw_eval_thread *self = arg;
+  int i, ncities = city_list_size(self->cities);
 
-              } else {
-                extra = 0;
-              }
+  for (i = self->offset; i < ncities; i += self->stride) {
+    aw_evaluate_city(&self->ev, city_list_get(self->cities, i));
+  }
+}
 
-              if (extra_has_flag(pextra, EF_GLOBAL_WARMING)) {
-                extra -= pplayer->ai_common.warmth;
-              }
-              if (extra_has_flag(pextra, EF_NUCLEAR_WINTER)) {
-                extra -= pplayer->ai_common.frost;
-              }
+/**********************************************************************//**
+  Finds tiles to improve, using punit.
 
-              if (removing) {
-                extra = -extra;
-              }
+  The returned value is the goodness of the best tile and action found.
+  If this return value is > 0, then best_tile indicates the tile chosen,
+  bestact indicates the activity it wants to do, and path (if not NULL)
+  indicates the path to follow for the unit. If 0 is returned
+  then there are no worthwhile activities available.
 
-              if (act != ACTIVITY_LAST) {
-                consider_worker_action(pplayer, act, pextra, extra, base_value,
-                                       oldv, in_use, turns,
-                                       &best_newv, &best_oldv, &best_extra,
-                                       &improve_worked,
-                                       &best_delay, best_act, best_target,
-                                       best_tile, ptile);
-              } else {
-                fc_assert(!removing);
-
-                road_deps_iterate(&(pextra->reqs), pdep) {
-                  struct extra_type *dep_tgt;
-
-                  dep_tgt = road_extra_get(pdep);
-
-                  if (action_prob_possible(
-                        action_speculate_unit_on_tile(nmap, ACTION_ROAD,
-                                                      punit, unit_home(punit), ptile,
-                                                      parameter.omniscience,
-                                                      ptile, dep_tgt))) {
-                    /* Consider building dependency road for later upgrade to target extra.
-                     * Here we set value to be sum of dependency
-                     * road and target extra values, which increases want, and turns is sum
-                     * of dependency and target build turns, which decreases want. This can
-                     * result in either bigger or lesser want than when checking dependency
-                     * road for the sake of itself when its turn in extra_type_iterate() is. */
-                    int dep_turns
-                      = turns + get_turns_for_activity_at(punit,
-                                                          ACTIVITY_GEN_ROAD,
-                                                          ptile, dep_tgt);
-                    adv_want dep_value
-                      = base_value + adv_city_worker_extra_get(pcity, cindex,
-                                                               dep_tgt);
-
-                    consider_worker_action(pplayer, ACTIVITY_GEN_ROAD,
-                                           dep_tgt, extra, dep_value,
-                                           oldv, in_use, dep_turns,
-                                           &best_newv, &best_oldv, &best_extra,
-                                           &improve_worked,
-                                           &best_delay, best_act, best_target,
-                                           best_tile, ptile);
-                  }
-                } road_deps_iterate_end;
-
-                extra_deps_iterate(&(pextra->reqs), pdep) {
-                  /* Roads handled above already */
-                  if (!is_extra_caused_by(pdep, EC_ROAD)) {
-                    enum unit_activity eval_dep_act = ACTIVITY_LAST;
-                    action_id eval_dep_action;
-
-                    aw_extra_action_iterate(try_act) {
-                      struct action *taction = action_by_number(try_act);
-
-                      if (is_extra_caused_by_action(pdep, taction)) {
-                        eval_dep_action = try_act;
-                        eval_dep_act = action_id_get_activity(try_act);
-                        break;
-                      }
-                    } aw_extra_action_iterate_end;
-
-                    if (eval_dep_act != ACTIVITY_LAST) {
-                      if (action_prob_possible(
-                            action_speculate_unit_on_tile(nmap, eval_dep_action,
-                                                          punit, unit_home(punit), ptile,
-                                                          parameter.omniscience,
-                                                          ptile, pdep))) {
-                        /* Consider building dependency extra for later upgrade to
-                         * target extra. See similar road implementation above for
-                         * extended commentary. */
-                        int dep_turns
-                          = turns + get_turns_for_activity_at(punit,
-                                                              eval_dep_act,
-                                                              ptile, pdep);
-                        adv_want dep_value
-                          = base_value + adv_city_worker_extra_get(pcity,
-                                                                   cindex,
-                                                                   pdep);
-
-                        consider_worker_action(pplayer, eval_dep_act, pdep,
-                                               0.0, dep_value, oldv, in_use,
-                                               dep_turns, &best_newv,
-                                               &best_oldv,
-                                               &best_extra, &improve_worked,
-                                               &best_delay,
-                                               best_act, best_target,
-                                               best_tile, ptile);
-                      }
-                    }
-                  }
-                } extra_deps_iterate_end;
-              }
-            }
-          } extra_type_iterate_end;
-        } /* endif: can we arrive sooner than current worker, if any? */
-      } /* endif: are we travelling to a legal destination? */
-    } city_tile_iterate_index_end;
-  } city_list_iterate_end;
+  completion_time is the time that would be taken by punit to travel to
+  and complete work at best_tile
+
+  state contains, for each tile, the unit id of the worker en route,
+  and the eta of this worker (if any). This information
+  is used to possibly displace this previously assigned worker.
+  if this array is NULL, workers are never displaced.
+**************************************************************************/
+adv_want worker_evaluate_improvements(const struct civ_map *nmap,
+                                      struct unit *punit,
+                                      enum unit_activity *best_act,
+                                      struct extra_type **best_target,
+                                      struct tile **best_tile,
+                                      struct pf_path **ppath,
+                                      struct workermap *state)
+{
+  const struct player *pplayer = unit_owner(punit);
+  struct pf_parameter parameter;
+  struct pf_map *pfm;
+  struct aw_city_eval ev;
+  adv_want best_newv, best_oldv;
+  bool improve_worked;
+  int best_extra, best_delay;
+
+  pft_fill_unit_parameter(&parameter, nmap, punit);
+  parameter.omniscience = !has_handicap(pplayer, H_MAP);
+  parameter.get_TB = autoworker_tile_behavior;
+  pfm = pf_map_new(&parameter);
+
+  ev.nmap = nmap;
+  ev.punit = punit;
+  ev.pfm = pfm;
+  ev.omniscience = parameter.omniscience;
+  ev.state = state;
+  ev.best_newv = 0;
+  ev.best_oldv = 9999; /* Not zero, so that newv == 0 activities are
+                        * never chosen. */
+  ev.best_extra = 0;
+  ev.improve_worked = FALSE;
+  ev.best_delay = 0;
+  ev.best_act = ACTIVITY_IDLE;
+  ev.best_target = NULL;
+  ev.best_tile = NULL;
+  ev.have_winner = FALSE;
+
+  if (city_list_size(pplayer->cities) >= AW_EVAL_MIN_CITIES) {
+    struct aw_eval_thread threads[AW_EVAL_THREADS];
+    int t;
+
+    /* The map must be complete before the threads share it read-only;
+     * a lazy fill would race. */
+    while (pf_map_iterate(pfm)) {
+      /* Nothing. */
+    }
+
+    /* The workers must not write to the shared evaluation caches. */
+    effect_cache_freeze(TRUE);
+    requirement_memo_freeze(TRUE);
+    city_tile_output_cache_freeze(TRUE);
+    combat_cache_freeze(TRUE);
+
+    for (t = 0; t < AW_EVAL_THREADS; t++) {
+      threads[t].ev = ev;
+      threads[t].cities = pplayer->cities;
+      threads[t].stride = AW_EVAL_THREADS;
+      threads[t].offset = t;
+      fc_thread_start(&threads[t].thread, aw_eval_thread_run, &threads[t]);
+    }
+    for (t = 0; t < AW_EVAL_THREADS; t++) {
+      fc_thread_wait(&threads[t].thread);
+    }
+
+    combat_cache_freeze(FALSE);
+    city_tile_output_cache_freeze(FALSE);
+    requirement_memo_freeze(FALSE);
+    effect_cache_freeze(FALSE);
+
+    /* Deterministic merge: adopt the first thread's running best, then
+     * replay the other threads' winning candidates through the same
+     * comparison, in thread order. */
+    ev = threads[0].ev;
+    for (t = 1; t < AW_EVAL_THREADS; t++) {
+      if (threads[t].ev.have_winner) {
+        const struct aw_candidate *cand = &threads[t].ev.winner;
+
+        aw_eval_consider(&ev, cand->act, cand->target, cand->extra,
+                         cand->base_value, cand->oldv, cand->in_use,
+                         cand->turns, cand->ptile);
+      }
+    }
+  } else {
+    city_list_iterate(pplayer->cities, pcity) {
+      aw_evaluate_city(&ev, pcity);
+    } city_list_iterate_end;
+  }
+
+  best_newv = ev.best_newv;
+  best_oldv = ev.best_oldv;
+  best_extra = ev.best_extra;
+  improve_worked = ev.improve_worked;
+  best_delay = ev.best_delay;
+  *best_act = ev.best_act;
+  *best_target = ev.best_target;
+  *best_tile = ev.best_tile;
 
   if (!improve_worked) {
     /* best_newv contains total value of improved tile. Check amount
@@ -1184,7 +1362,9 @@ void auto_workers_player(struct player *pplayer)
   struct workermap *state;
   const struct civ_map *nmap = &(wld.map);
 
-  state = fc_calloc(MAP_INDEX_SIZE, sizeof(*state));
+  /* Per-phase scratch; reclaimed wholesale when the phase ends. */
+  state = fc_arena_calloc(server_phase_arena(),
+                          MAP_INDEX_SIZE, sizeof(*state));
 
   aw_timer = timer_renew(aw_timer, TIMER_CPU, TIMER_DEBUG,
                          aw_timer != NULL ? NULL : "autoworkers");
@@ -1276,8 +1456,6 @@ void auto_workers_player(struct player *pplayer)
 #endif
 
   }
-
-  FC_FREE(state);
 }
 
 /**********************************************************************//**
@@ -255,6 +255,12 @@ void initialize_infrastructure_cache(struct player *pplayer)
     struct tile *pcenter = city_tile(pcity);
     int radius_sq = city_map_radius_sq_get(pcity);
 
+    if (!pcity->server.adv->infra_dirty) {
+      /* Nothing the cached values depend on has changed within this
+       * city's radius since the last recompute. */
+      continue;
+    }
+
     city_map_iterate(radius_sq, city_index, city_x, city_y) {
       aw_transform_action_iterate(act) {
         adv_city_worker_act_set(pcity, city_index, action_id_get_activity(act),
@@ -292,6 +298,41 @@ void initialize_infrastructure_cache(struct player *pplayer)
         }
       } extra_type_iterate_end;
     } city_tile_iterate_index_end;
+
+    pcity->server.adv->infra_dirty = FALSE;
+  } city_list_iterate_end;
+}
+
+/**********************************************************************//**
+  A tile has changed (terrain, extra, ownership); the cached improvement
+  values of every city whose radius covers it must be recomputed.
+**************************************************************************/
+void adv_infra_cache_tile_dirty(struct tile *ptile)
+{
+  const struct civ_map *nmap = &(wld.map);
+
+  city_tile_iterate(nmap, CITY_MAP_MAX_RADIUS_SQ, ptile, ptile1) {
+    struct city *pcity = tile_city(ptile1);
+
+    if (pcity != NULL && pcity->server.adv != NULL
+        && sq_map_distance(ptile1, ptile)
+           <= city_map_radius_sq_get(pcity)) {
+      pcity->server.adv->infra_dirty = TRUE;
+    }
+  } city_tile_iterate_end;
+}
+
+/**********************************************************************//**
+  Something player-wide that the cached values depend on has changed
+  (e.g. a tech making new extras buildable); recompute all of the
+  player's cities.
+**************************************************************************/
+void adv_infra_cache_player_dirty(struct player *pplayer)
+{
+  city_list_iterate(pplayer->cities, pcity) {
+    if (pcity->server.adv != NULL) {
+      pcity->server.adv->infra_dirty = TRUE;
+    }
   } city_list_iterate_end;
 }
 
@@ -480,6 +521,7 @@ void adv_city_update(struct city *pcity)
            city_map_tiles(radius_sq)
            * sizeof(*(pcity->server.adv->act_cache)));
     pcity->server.adv->act_cache_radius_sq = radius_sq;
+    pcity->server.adv->infra_dirty = TRUE;
   }
 }
 
@@ -492,6 +534,7 @@ void adv_city_alloc(struct city *pcity)
 
   pcity->server.adv->act_cache = NULL;
   pcity->server.adv->act_cache_radius_sq = -1;
+  pcity->server.adv->infra_dirty = TRUE;
   /* Allocate memory for pcity->ai->act_cache */
   adv_city_update(pcity);
 }
@@ -17,6 +17,7 @@
 #include "advtools.h"
 
 struct player;
+struct tile;
 
 struct adv_city {
   /* Used for caching change in value from a worker performing
@@ -24,6 +25,11 @@ struct adv_city {
   struct worker_activity_cache *act_cache;
   int act_cache_radius_sq;
 
+  /* Whether the act_cache needs recomputation. Set by tile, border and
+   * tech events; initialize_infrastructure_cache() skips clean
+   * cities. */
+  bool infra_dirty;
+
   /* Building desirabilities - easiest to handle them here -- Syela */
   /* The units of building_want are output
    * (shields/gold/luxuries) multiplied by a priority
@@ -40,6 +46,9 @@ void adv_city_free(struct city *pcity);
 
 void initialize_infrastructure_cache(struct player *pplayer);
 
+void adv_infra_cache_tile_dirty(struct tile *ptile);
+void adv_infra_cache_player_dirty(struct player *pplayer);
+
 void adv_city_update(struct city *pcity);
 
 adv_want city_tile_value(const struct city *pcity, const struct tile *ptile,
@@ -16,6 +16,7 @@
 #endif
 
 /* utility */
+#include "mem.h"
 #include "rand.h" /* fc_rand() */
 
 /* common */
@@ -56,31 +57,23 @@ static const struct unit_type *animal_for_terrain(struct terrain *pterr)
 }
 
 /************************************************************************//**
-  Try to add one animal to the map.
+  Try to add one animal to the given tile. Returns whether an animal
+  was created.
 ****************************************************************************/
-static void place_animal(struct player *plr, int sqrdist)
+static bool place_animal(struct player *plr, struct tile *ptile, int sqrdist)
 {
-  struct tile *ptile = rand_map_pos(&(wld.map));
   const struct unit_type *ptype;
 
-  extra_type_by_rmcause_iterate(ERM_ENTER, pextra) {
-    if (tile_has_extra(ptile, pextra)) {
-      /* Animals should not displace huts */
-      /* FIXME: could animals not entering nor frightening huts appear here? */
-      return;
-    }
-  } extra_type_by_rmcause_iterate_end;
-
   if (unit_list_size(ptile->units) > 0) {
     /* Below we check against enemy units nearby. Here we make sure
      * there's no multiple animals in the very same tile. */
-    return;
+    return FALSE;
   }
 
   circle_iterate(&(wld.map), ptile, sqrdist, check) {
     if (tile_city(check) != NULL
         || is_non_allied_unit_tile(check, plr, TRUE)) {
-      return;
+      return FALSE;
     }
   } circle_iterate_end;
 
@@ -89,12 +82,16 @@ static void place_animal(struct player *plr, int sqrdist)
   if (ptype != NULL && !utype_player_already_has_this_unique(plr, ptype)) {
     struct unit *punit;
 
-    fc_assert_ret(can_exist_at_tile(&(wld.map), ptype, ptile));
+    fc_assert_ret_val(can_exist_at_tile(&(wld.map), ptype, ptile), FALSE);
 
     punit = create_unit(plr, ptile, ptype, 0, 0, -1);
 
     send_unit_info(NULL, punit);
+
+    return TRUE;
   }
+
+  return FALSE;
 }
 
 /************************************************************************//**
@@ -105,7 +102,10 @@ void create_animals(void)
   struct nation_type *anination;
   struct player *plr;
   struct research *presearch;
-  int i;
+  struct tile **candidates;
+  int count = 0;
+  int wanted;
+  int placed = 0;
 
   if (wld.map.server.animals <= 0) {
     return;
@@ -157,9 +157,44 @@ void create_animals(void)
    * about invalid team. */
   send_research_info(presearch, NULL);
 
-  for (i = 0;
-       i < MAP_NATIVE_WIDTH * MAP_NATIVE_HEIGHT * wld.map.server.animals / 1000;
-       i++) {
-    place_animal(plr, 2 * 2 + 1 * 1);
+  /* Index the tiles that can host an animal at all, so that placement
+   * samples from real candidates instead of rejecting random tiles over
+   * and over on mostly-ocean maps. The conditions that depend on the
+   * animals already placed are still checked per draw. */
+  candidates = fc_malloc(MAP_INDEX_SIZE * sizeof(*candidates));
+  whole_map_iterate(&(wld.map), ptile) {
+    bool hut = FALSE;
+
+    if (tile_terrain(ptile)->num_animals == 0) {
+      continue;
+    }
+
+    extra_type_by_rmcause_iterate(ERM_ENTER, pextra) {
+      if (tile_has_extra(ptile, pextra)) {
+        /* Animals should not displace huts */
+        /* FIXME: could animals not entering nor frightening huts
+         * appear here? */
+        hut = TRUE;
+      }
+    } extra_type_by_rmcause_iterate_end;
+
+    if (!hut) {
+      candidates[count++] = ptile;
+    }
+  } whole_map_iterate_end;
+
+  wanted = MAP_NATIVE_WIDTH * MAP_NATIVE_HEIGHT * wld.map.server.animals / 1000;
+
+  while (placed < wanted && count > 0) {
+    int pick = fc_rand(count);
+
+    if (place_animal(plr, candidates[pick], 2 * 2 + 1 * 1)) {
+      placed++;
+    }
+
+    /* Whether or not an animal appeared, never draw this tile again. */
+    candidates[pick] = candidates[--count];
   }
+
+  free(candidates);
 }
@@ -21,8 +21,10 @@
 
 /* utility */
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "md5.h"
+#include "mem.h"
 #include "registry.h"
 #include "shared.h"
 #include "support.h"
@@ -63,6 +65,348 @@ static bool is_guest_name(const char *name);
 static void get_unique_guest_name(char *name);
 static bool is_good_password(const char *password, char *msg);
 
+/* The fcdb queries that can run on the worker thread. */
+enum auth_query_type {
+  AUTH_QUERY_USER_EXISTS,
+  AUTH_QUERY_USER_VERIFY,
+  AUTH_QUERY_USER_SAVE
+};
+
+/* One database query in flight. The connection pointer stays valid even
+ * if the connection closes meanwhile - server connections live in a
+ * static array - but the result is only applied if the serial still
+ * matches the connection (see auth_query_finish()). */
+struct auth_query {
+  enum auth_query_type type;
+  struct connection *pconn;
+  int serial;
+  char password[MAX_LEN_PASSWORD];
+  bool db_success;         /* Whether the fcdb call itself worked. */
+  bool result;             /* Out value of user_exists()/user_verify(). */
+  struct auth_query *next;
+};
+
+/* Queries waiting for the worker thread, and finished queries waiting
+ * to be dispatched by auth_process_queue() on the main thread. Both
+ * lists are protected by auth_queue_mutex. */
+static struct auth_query *auth_pending_head = NULL;
+static struct auth_query *auth_pending_tail = NULL;
+static struct auth_query *auth_done_head = NULL;
+static struct auth_query *auth_done_tail = NULL;
+
+static fc_thread auth_thread;
+static fc_mutex auth_queue_mutex;
+static fc_thread_cond auth_queue_cond;
+static bool auth_queue_initialized = FALSE;
+static bool auth_thread_running = FALSE;
+static bool auth_thread_stopping = FALSE;
+static int auth_query_next_serial = 0;
+
+/************************************************************************//**
+  Run one database query. Called from the worker thread, or from the
+  main thread when the worker could not be started.
+****************************************************************************/
+static void auth_query_execute(struct auth_query *pquery)
+{
+  pquery->result = FALSE;
+
+  switch (pquery->type) {
+  case AUTH_QUERY_USER_EXISTS:
+    pquery->db_success = script_fcdb_call("user_exists", pquery->pconn,
+                                          &pquery->result);
+    break;
+  case AUTH_QUERY_USER_VERIFY:
+    pquery->db_success = script_fcdb_call("user_verify", pquery->pconn,
+                                          pquery->password,
+                                          &pquery->result);
+    break;
+  case AUTH_QUERY_USER_SAVE:
+    pquery->db_success = script_fcdb_call("user_save", pquery->pconn,
+                                          pquery->password);
+    break;
+  }
+
+  /* Don't keep the plaintext password around longer than needed. */
+  memset(pquery->password, 0, sizeof(pquery->password));
+}
+
+/************************************************************************//**
+  Worker thread main loop: take queries off the pending list, run them
+  against the database and put them on the done list for the main loop
+  to pick up.
+****************************************************************************/
+static void auth_thread_func(void *data)
+{
+  fc_mutex_allocate(&auth_queue_mutex);
+
+  while (!auth_thread_stopping) {
+    struct auth_query *pquery = auth_pending_head;
+
+    if (pquery == NULL) {
+      fc_thread_cond_wait(&auth_queue_cond, &auth_queue_mutex);
+      continue;
+    }
+
+    auth_pending_head = pquery->next;
+    if (auth_pending_head == NULL) {
+      auth_pending_tail = NULL;
+    }
+    fc_mutex_release(&auth_queue_mutex);
+
+    auth_query_execute(pquery);
+
+    pquery->next = NULL;
+    fc_mutex_allocate(&auth_queue_mutex);
+    if (auth_done_tail != NULL) {
+      auth_done_tail->next = pquery;
+    } else {
+      auth_done_head = pquery;
+    }
+    auth_done_tail = pquery;
+  }
+
+  fc_mutex_release(&auth_queue_mutex);
+}
+
+/************************************************************************//**
+  Append a finished query to the done list.
+****************************************************************************/
+static void auth_query_done(struct auth_query *pquery)
+{
+  pquery->next = NULL;
+  fc_mutex_allocate(&auth_queue_mutex);
+  if (auth_done_tail != NULL) {
+    auth_done_tail->next = pquery;
+  } else {
+    auth_done_head = pquery;
+  }
+  auth_done_tail = pquery;
+  fc_mutex_release(&auth_queue_mutex);
+}
+
+/************************************************************************//**
+  Queue a database query for the connection, starting the worker thread
+  on first use. If the thread cannot be started the query runs
+  synchronously right here; the result is still delivered through the
+  done list so the callers don't have to care.
+****************************************************************************/
+static void auth_query_enqueue(struct connection *pconn,
+                               enum auth_query_type type,
+                               const char *password)
+{
+  struct auth_query *pquery = fc_calloc(1, sizeof(*pquery));
+
+  pquery->type = type;
+  pquery->pconn = pconn;
+  pquery->serial = ++auth_query_next_serial;
+  if (password != NULL) {
+    sz_strlcpy(pquery->password, password);
+  }
+
+  pconn->server.auth_query_serial = pquery->serial;
+
+  if (!auth_queue_initialized) {
+    fc_mutex_init(&auth_queue_mutex);
+    fc_thread_cond_init(&auth_queue_cond);
+    auth_queue_initialized = TRUE;
+  }
+
+  if (!auth_thread_running) {
+    if (!has_thread_cond_impl()) {
+      /* No way to wake a sleeping worker; run the query right here. */
+      auth_query_execute(pquery);
+      auth_query_done(pquery);
+      return;
+    }
+
+    auth_thread_stopping = FALSE;
+    if (fc_thread_start(&auth_thread, auth_thread_func, NULL) == 0) {
+      auth_thread_running = TRUE;
+    } else {
+      log_error("Failed to start authentication database thread; "
+                "running the query synchronously.");
+      auth_query_execute(pquery);
+      auth_query_done(pquery);
+      return;
+    }
+  }
+
+  fc_mutex_allocate(&auth_queue_mutex);
+  if (auth_pending_tail != NULL) {
+    auth_pending_tail->next = pquery;
+  } else {
+    auth_pending_head = pquery;
+  }
+  auth_pending_tail = pquery;
+  fc_thread_cond_signal(&auth_queue_cond);
+  fc_mutex_release(&auth_queue_mutex);
+}
+
+/************************************************************************//**
+  Handle the result of the user_exists() query; this is the second half
+  of auth_user().
+****************************************************************************/
+static void auth_user_exists_result(struct connection *pconn,
+                                    bool db_success, bool exists)
+{
+  char tmpname[MAX_LEN_NAME] = "\0";
+  char buffer[MAX_LEN_MSG];
+
+  if (!db_success) {
+    if (srvarg.auth_allow_guests) {
+      sz_strlcpy(tmpname, pconn->username);
+      get_unique_guest_name(tmpname); /* don't pass pconn->username here */
+      sz_strlcpy(pconn->username, tmpname);
+
+      log_error("Error reading database; connection -> guest");
+      notify_conn_early(pconn->self, NULL, E_CONNECTION, ftc_warning,
+                        _("There was an error reading the user "
+                          "database, logging in as guest connection '%s'."),
+                        pconn->username);
+      establish_new_connection(pconn);
+    } else {
+      reject_new_connection(_("There was an error reading the user database "
+                              "and guest logins are not allowed. Sorry"),
+                            pconn);
+      log_normal(_("%s was rejected: Database error and guests not "
+                   "allowed."), pconn->username);
+      connection_close_server(pconn, _("auth failed"));
+    }
+  } else if (exists) {
+    /* we found a user */
+    fc_snprintf(buffer, sizeof(buffer), _("Enter password for %s:"),
+                pconn->username);
+    dsend_packet_authentication_req(pconn, AUTH_LOGIN_FIRST, buffer);
+    pconn->server.auth_settime = time(NULL);
+    pconn->server.status = AS_REQUESTING_OLD_PASS;
+  } else {
+    /* we couldn't find the user, they are new */
+    if (srvarg.auth_allow_newusers) {
+      /* TRANS: Try not to make the translation much longer than the original. */
+      sz_strlcpy(buffer, _("First time login. Set a new password and confirm it."));
+      dsend_packet_authentication_req(pconn, AUTH_NEWUSER_FIRST, buffer);
+      pconn->server.auth_settime = time(NULL);
+      pconn->server.status = AS_REQUESTING_NEW_PASS;
+    } else {
+      reject_new_connection(_("This server allows only preregistered "
+                              "users. Sorry."), pconn);
+      log_normal(_("%s was rejected: Only preregistered users allowed."),
+                 pconn->username);
+      connection_close_server(pconn, _("auth failed"));
+    }
+  }
+}
+
+/************************************************************************//**
+  Apply the result of a finished database query to its connection, then
+  free the query. Results for connections that closed, or were reused
+  for another login, while the query was in flight are dropped.
+****************************************************************************/
+static void auth_query_finish(struct auth_query *pquery)
+{
+  struct connection *pconn = pquery->pconn;
+
+  if (!pconn->used || pconn->server.is_closing
+      || pquery->serial != pconn->server.auth_query_serial) {
+    free(pquery);
+    return;
+  }
+
+  switch (pquery->type) {
+  case AUTH_QUERY_USER_EXISTS:
+    if (pconn->server.status == AS_CHECKING_USER) {
+      auth_user_exists_result(pconn, pquery->db_success, pquery->result);
+    }
+    break;
+  case AUTH_QUERY_USER_VERIFY:
+    if (pconn->server.status == AS_VERIFYING_PASS) {
+      if (pquery->db_success && pquery->result) {
+        establish_new_connection(pconn);
+      } else {
+        pconn->server.status = AS_FAILED;
+        pconn->server.auth_tries++;
+        pconn->server.auth_settime = time(NULL)
+          + auth_fail_wait[pconn->server.auth_tries];
+      }
+    }
+    break;
+  case AUTH_QUERY_USER_SAVE:
+    if (pconn->server.status == AS_SAVING_USER) {
+      if (!pquery->db_success) {
+        notify_conn(pconn->self, NULL, E_CONNECTION, ftc_warning,
+                    _("Warning: There was an error in saving to the database. "
+                      "Continuing, but your stats will not be saved."));
+        log_error("Error writing to database for: %s", pconn->username);
+      }
+      establish_new_connection(pconn);
+    }
+    break;
+  }
+
+  free(pquery);
+}
+
+/************************************************************************//**
+  Dispatch the results of finished database queries. Called regularly
+  from the server main loop in sernet.c.
+****************************************************************************/
+void auth_process_queue(void)
+{
+  struct auth_query *done;
+
+  if (!auth_queue_initialized) {
+    return;
+  }
+
+  fc_mutex_allocate(&auth_queue_mutex);
+  done = auth_done_head;
+  auth_done_head = NULL;
+  auth_done_tail = NULL;
+  fc_mutex_release(&auth_queue_mutex);
+
+  while (done != NULL) {
+    struct auth_query *pquery = done;
+
+    done = pquery->next;
+    auth_query_finish(pquery);
+  }
+}
+
+/************************************************************************//**
+  Stop the worker thread and drop any queries still queued. Must be
+  called before the fcdb scripting state is freed for good.
+****************************************************************************/
+void auth_queue_shutdown(void)
+{
+  struct auth_query *pquery;
+
+  if (!auth_queue_initialized) {
+    return;
+  }
+
+  if (auth_thread_running) {
+    fc_mutex_allocate(&auth_queue_mutex);
+    auth_thread_stopping = TRUE;
+    fc_thread_cond_signal(&auth_queue_cond);
+    fc_mutex_release(&auth_queue_mutex);
+    fc_thread_wait(&auth_thread);
+    auth_thread_running = FALSE;
+  }
+
+  /* The connections are going away with the server; nobody is waiting
+   * for these results any more. */
+  while ((pquery = auth_pending_head) != NULL) {
+    auth_pending_head = pquery->next;
+    free(pquery);
+  }
+  auth_pending_tail = NULL;
+  while ((pquery = auth_done_head) != NULL) {
+    auth_done_head = pquery->next;
+    free(pquery);
+  }
+  auth_done_tail = NULL;
+}
+
 /************************************************************************//**
   Handle authentication of a user; called by handle_login_request() if
   authentication is enabled.
@@ -96,56 +440,15 @@ bool auth_user(struct connection *pconn, char *username)
     }
   } else {
     /* We are not a guest, we need an extra check as to whether a
-     * connection can be established: the client must authenticate itself */
-    char buffer[MAX_LEN_MSG];
-    bool exists = FALSE;
-
+     * connection can be established: the client must authenticate itself.
+     * The user_exists() query runs on the worker thread so that a slow
+     * database doesn't stall the server; auth_user_exists_result()
+     * continues once it completes. */
     sz_strlcpy(pconn->username, username);
 
-    if (!script_fcdb_call("user_exists", pconn, &exists)) {
-      if (srvarg.auth_allow_guests) {
-        sz_strlcpy(tmpname, pconn->username);
-        get_unique_guest_name(tmpname); /* don't pass pconn->username here */
-        sz_strlcpy(pconn->username, tmpname);
-
-        log_error("Error reading database; connection -> guest");
-        notify_conn_early(pconn->self, NULL, E_CONNECTION, ftc_warning,
-                          _("There was an error reading the user "
-                            "database, logging in as guest connection '%s'."),
-                          pconn->username);
-        establish_new_connection(pconn);
-      } else {
-        reject_new_connection(_("There was an error reading the user database "
-                                "and guest logins are not allowed. Sorry"),
-                              pconn);
-        log_normal(_("%s was rejected: Database error and guests not "
-                     "allowed."), pconn->username);
-        return FALSE;
-      }
-    } else if (exists) {
-      /* we found a user */
-      fc_snprintf(buffer, sizeof(buffer), _("Enter password for %s:"),
-                  pconn->username);
-      dsend_packet_authentication_req(pconn, AUTH_LOGIN_FIRST, buffer);
-      pconn->server.auth_settime = time(NULL);
-      pconn->server.status = AS_REQUESTING_OLD_PASS;
-    } else {
-      /* we couldn't find the user, they are new */
-      if (srvarg.auth_allow_newusers) {
-        /* TRANS: Try not to make the translation much longer than the original. */
-        sz_strlcpy(buffer, _("First time login. Set a new password and confirm it."));
-        dsend_packet_authentication_req(pconn, AUTH_NEWUSER_FIRST, buffer);
-        pconn->server.auth_settime = time(NULL);
-        pconn->server.status = AS_REQUESTING_NEW_PASS;
-      } else {
-        reject_new_connection(_("This server allows only preregistered "
-                                "users. Sorry."), pconn);
-        log_normal(_("%s was rejected: Only preregistered users allowed."),
-                   pconn->username);
-
-        return FALSE;
-      }
-    }
+    auth_query_enqueue(pconn, AUTH_QUERY_USER_EXISTS, NULL);
+    pconn->server.auth_settime = time(NULL);
+    pconn->server.status = AS_CHECKING_USER;
   }
   return TRUE;
 }
@@ -173,26 +476,13 @@ bool auth_handle_reply(struct connection *pconn, char *password)
       }
     }
 
-    if (!script_fcdb_call("user_save", pconn, password)) {
-      notify_conn(pconn->self, NULL, E_CONNECTION, ftc_warning,
-                  _("Warning: There was an error in saving to the database. "
-                    "Continuing, but your stats will not be saved."));
-      log_error("Error writing to database for: %s", pconn->username);
-    }
-
-    establish_new_connection(pconn);
+    auth_query_enqueue(pconn, AUTH_QUERY_USER_SAVE, password);
+    pconn->server.auth_settime = time(NULL);
+    pconn->server.status = AS_SAVING_USER;
   } else if (pconn->server.status == AS_REQUESTING_OLD_PASS) {
-    bool success = FALSE;
-
-    if (script_fcdb_call("user_verify", pconn, password, &success)
-        && success) {
-      establish_new_connection(pconn);
-    } else {
-      pconn->server.status = AS_FAILED;
-      pconn->server.auth_tries++;
-      pconn->server.auth_settime = time(NULL)
-                                   + auth_fail_wait[pconn->server.auth_tries];
-    }
+    auth_query_enqueue(pconn, AUTH_QUERY_USER_VERIFY, password);
+    pconn->server.auth_settime = time(NULL);
+    pconn->server.status = AS_VERIFYING_PASS;
   } else {
     log_verbose("%s is sending unrequested auth packets", pconn->username);
     return FALSE;
@@ -244,6 +534,19 @@ void auth_process_status(struct connection *pconn)
       connection_close_server(pconn, _("auth failed"));
     }
     break;
+  case AS_CHECKING_USER:
+  case AS_VERIFYING_PASS:
+  case AS_SAVING_USER:
+    /* the database query is still on the worker thread; don't let a
+     * stuck database hold the connection slot forever */
+    if (time(NULL) >= pconn->server.auth_settime + MAX_WAIT_TIME) {
+      pconn->server.status = AS_NOT_ESTABLISHED;
+      reject_new_connection(_("Sorry, your connection timed out..."), pconn);
+      log_normal(_("%s was rejected: Database timeout during "
+                   "authentication."), pconn->username);
+      connection_close_server(pconn, _("auth failed"));
+    }
+    break;
   case AS_ESTABLISHED:
     /* this better fail bigtime */
     fc_assert(pconn->server.status != AS_ESTABLISHED);
@@ -21,6 +21,8 @@ struct connection;
 bool auth_user(struct connection *pconn, char *username);
 void auth_process_status(struct connection *pconn);
 bool auth_handle_reply(struct connection *pconn, char *password);
+void auth_process_queue(void);
+void auth_queue_shutdown(void);
 
 const char *auth_get_username(struct connection *pconn);
 const char *auth_get_ipaddr(struct connection *pconn);
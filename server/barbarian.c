@@ -26,6 +26,7 @@
 #include <string.h>
 
 /* utility */
+#include "bitvector.h"
 #include "fcintl.h"
 #include "log.h"
 #include "rand.h"
@@ -530,7 +531,7 @@ static struct tile *find_empty_tile_nearby(struct tile *ptile)
      be an average number of cities (all cities/player num)? Depending
      on the victim government type is also questionable.
 **************************************************************************/
-static void try_summon_barbarians(void)
+static void try_summon_barbarians(const struct dbv *candidates)
 {
   struct tile *ptile, *utile;
   int i, dist;
@@ -551,6 +552,12 @@ static void try_summon_barbarians(void)
    * gameplay. */
   ptile = rand_map_pos(nmap);
 
+  if (!dbv_isset(candidates, tile_index(ptile))) {
+    /* Guaranteed to be farther than MAX_UNREST_DIST from every city;
+     * don't bother with the expensive exact checks below. */
+    return;
+  }
+
   if (terrain_has_flag(tile_terrain(ptile), TER_NO_BARBS)) {
     return;
   }
@@ -737,6 +744,7 @@ static void try_summon_barbarians(void)
 **************************************************************************/
 void summon_barbarians(void)
 {
+  struct dbv candidates;
   int i, n;
 
   if (BARBS_DISABLED == game.server.barbarianrate
@@ -754,9 +762,23 @@ void summon_barbarians(void)
     n = 1;
   }
 
+  /* Index the tiles close enough to some city to host an uprising, so
+   * each attempt below can reject a hopeless tile with one bit test
+   * instead of a scan over every city. This is a superset prefilter:
+   * the exact distance rules still run for tiles inside the band, so
+   * every tile's chance of a summons is exactly what it was before. */
+  dbv_init(&candidates, MAP_INDEX_SIZE);
+  cities_iterate(pcity) {
+    square_iterate(&(wld.map), city_tile(pcity), MAX_UNREST_DIST, ptile) {
+      dbv_set(&candidates, tile_index(ptile));
+    } square_iterate_end;
+  } cities_iterate_end;
+
   for (i = 0; i < n * (game.server.barbarianrate - 1); i++) {
-    try_summon_barbarians();
+    try_summon_barbarians(&candidates);
   }
+
+  dbv_free(&candidates);
 }
 
 /**********************************************************************//**
@@ -29,6 +29,7 @@
 #include "support.h"
 
 /* common */
+#include "accessarea.h"
 #include "ai.h"
 #include "base.h"
 #include "citizens.h"
@@ -41,6 +42,7 @@
 #include "improvement.h"
 #include "idex.h"
 #include "map.h"
+#include "mapimg.h"
 #include "movement.h"
 #include "packets.h"
 #include "player.h"
@@ -70,6 +72,7 @@
 #include "notify.h"
 #include "plrhand.h"
 #include "sanitycheck.h"
+#include "score.h"
 #include "sernet.h"
 #include "spacerace.h"
 #include "srv_main.h"
@@ -77,6 +80,9 @@
 #include "unithand.h"
 #include "unittools.h"
 
+/* server/savegame */
+#include "savemain.h"
+
 /* server/advisors */
 #include "advbuilding.h"
 #include "advgoto.h"
@@ -1043,6 +1049,7 @@ static void build_free_small_wonders(struct player *pplayer,
                        continue);
 
       city_add_improvement(pnew_city, pimprove);
+      pnew_city->server.state_gen++;
 
       /*
        * send_player_cities() will recalculate all cities and send them to
@@ -1101,6 +1108,22 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
 
   fc_assert_ret_val(pgiver != ptaker, TRUE);
 
+  /* The transfer is a burst of city, tile, and unit updates; cork the
+   * connections so each client receives it in a single flush. */
+  conn_list_do_buffer(game.est_connections);
+
+  /* The tiles the city works change their settled area attribution
+   * with the city's owner. */
+  score_counters_invalidate();
+
+  /* Cached bonuses were computed against the old owner's player
+   * requirements. */
+  effect_cache_invalidate();
+
+  /* The city sets of both players change. */
+  access_areas_city_change(pgiver);
+  access_areas_city_change(ptaker);
+
   unit_list_iterate(pcenter->units, punit) {
     central_units[units_num++] = punit->id;
   } unit_list_iterate_end;
@@ -1420,8 +1443,11 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
 
   sync_cities();
 
+  pcity->server.state_gen++;
   CALL_FUNC_EACH_AI(city_info, pcity);
 
+  conn_list_do_unbuffer(game.est_connections);
+
   return city_remains;
 }
 
@@ -1530,6 +1556,11 @@ void create_city(struct player *pplayer, struct tile *ptile,
 
   log_debug("create_city() %s", name);
 
+  /* Founding a city sends city, tile, and unit updates for everything
+   * in its radius; cork the connections so each client receives them
+   * in a single flush. */
+  conn_list_do_buffer(game.est_connections);
+
   pcity = create_city_virtual(pplayer, ptile, name);
 
   /* Remove units no more seen. Do it before city is really put into
@@ -1569,6 +1600,7 @@ void create_city(struct player *pplayer, struct tile *ptile,
   /* Place a worker at the is_city_center() is_free_worked().
    * It is possible to build a city on a tile that is already worked;
    * this will displace the worker on the newly-built city's tile -- Syela */
+  score_counter_tile_worked(ptile, pcity);
   tile_set_worked(ptile, pcity); /* Instead of city_map_update_worker() */
 
   if (pwork != nullptr) {
@@ -1578,6 +1610,7 @@ void create_city(struct player *pplayer, struct tile *ptile,
     /* One less citizen. Citizen sanity will be handled later in
      * city_thaw_workers_queue() */
     pwork->server.synced = FALSE;
+    pwork->server.state_gen++;
     city_freeze_workers_queue(pwork);
   }
 
@@ -1607,6 +1640,7 @@ void create_city(struct player *pplayer, struct tile *ptile,
   vision_reveal_tiles(pcity->server.vision, game.server.vision_reveal_tiles);
   city_refresh_vision(pcity);
   city_list_prepend(pplayer->cities, pcity);
+  access_areas_city_change(pplayer);
 
   /* This is dependent on the current vision, so must be done after
    * vision is prepared and before arranging workers. */
@@ -1670,6 +1704,8 @@ void create_city(struct player *pplayer, struct tile *ptile,
 
   CALL_FUNC_EACH_AI(city_created, pcity);
   CALL_PLR_AI_FUNC(city_got, pplayer, pplayer, pcity);
+
+  conn_list_do_unbuffer(game.est_connections);
 }
 
 /************************************************************************//**
@@ -1728,6 +1764,12 @@ void remove_city(struct city *pcity)
   CALL_PLR_AI_FUNC(city_lost, powner, powner, pcity);
   CALL_FUNC_EACH_AI(city_destroyed, pcity);
 
+  access_areas_city_change(powner);
+
+  deltasave_dirty_player(powner);
+  mapimg_tile_dirty(pcenter);
+  deltasave_dirty_map();
+
   BV_CLR_ALL(had_small_wonders);
   city_built_iterate(pcity, pimprove) {
     building_removed(pcity, pimprove, "city_destroyed", nullptr);
@@ -1907,6 +1949,10 @@ void remove_city(struct city *pcity)
     } unit_list_iterate_end;
   } players_iterate_end;
 
+  /* game_remove_city() releases the city's worked tiles behind the
+   * back of the score counter hooks. */
+  score_counters_invalidate();
+
   fc_mutex_allocate(&game.server.mutexes.city_list);
   game_remove_city(&wld, pcity);
   fc_mutex_release(&game.server.mutexes.city_list);
@@ -2268,6 +2314,8 @@ void broadcast_city_info(struct city *pcity)
     return;
   }
 
+  mapimg_tile_dirty(city_tile(pcity));
+
   if (any_web_conns()) {
     webp_ptr = &web_packet;
   } else {
@@ -2373,6 +2421,10 @@ void send_city_info(struct player *dest, struct city *pcity)
     return;
   }
 
+  deltasave_dirty_player(powner);
+  /* Worked tiles are stored in the [map] savegame section. */
+  deltasave_dirty_map();
+
   if (dest == powner && send_city_suppressed) {
     return;
   }
@@ -3049,6 +3101,7 @@ struct city
   }
   if (oldcity && oldcity != pcity) {
     city_remove_improvement(oldcity, pimprove);
+    oldcity->server.state_gen++;
     city_add_improvement_with_gov_notice(pcity, pimprove,
                                          _("Moving %s"));
   } else {
@@ -3068,6 +3121,7 @@ bool building_removed(struct city *pcity, const struct impr_type *pimprove,
   int backup = pcity->id;
 
   city_remove_improvement(pcity, pimprove);
+  pcity->server.state_gen++;
 
   script_server_signal_emit("building_lost", pcity, pimprove, reason,
                             destroyer);
@@ -3279,9 +3333,11 @@ void change_build_target(struct player *pplayer, struct city *pcity,
 ****************************************************************************/
 void city_map_update_empty(struct city *pcity, struct tile *ptile)
 {
+  score_counter_tile_worked(ptile, nullptr);
   tile_set_worked(ptile, nullptr);
   send_tile_info(nullptr, ptile, FALSE);
   pcity->server.synced = FALSE;
+  pcity->server.state_gen++;
 }
 
 /************************************************************************//**
@@ -3293,9 +3349,11 @@ void city_map_update_empty(struct city *pcity, struct tile *ptile)
 ****************************************************************************/
 void city_map_update_worker(struct city *pcity, struct tile *ptile)
 {
+  score_counter_tile_worked(ptile, pcity);
   tile_set_worked(ptile, pcity);
   send_tile_info(nullptr, ptile, FALSE);
   pcity->server.synced = FALSE;
+  pcity->server.state_gen++;
 }
 
 /************************************************************************//**
@@ -3310,11 +3368,13 @@ static bool city_map_update_tile_direct(struct tile *ptile, bool queued)
   if (pwork != nullptr
       && !is_free_worked(pwork, ptile)
       && !city_can_work_tile(pwork, ptile)) {
+    score_counter_tile_worked(ptile, nullptr);
     tile_set_worked(ptile, nullptr);
     send_tile_info(nullptr, ptile, FALSE);
 
     pwork->specialists[DEFAULT_SPECIALIST]++; /* Keep city sanity */
     pwork->server.synced = FALSE;
+    pwork->server.state_gen++;
 
     if (queued) {
       city_freeze_workers_queue(pwork); /* Place the displaced later */
@@ -3693,6 +3753,8 @@ void city_add_improvement_with_gov_notice(struct city *pcity,
   } else {
     city_add_improvement(pcity, pimprove);
   }
+
+  pcity->server.state_gen++;
 }
 
 /************************************************************************//**
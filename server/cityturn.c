@@ -25,6 +25,7 @@
 
 /* utility */
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "rand.h"
@@ -41,8 +42,10 @@
 #include "calendar.h"
 #include "citizens.h"
 #include "city.h"
+#include "combat.h"
 #include "counters.h"
 #include "culture.h"
+#include "effects.h"
 #include "events.h"
 #include "disaster.h"
 #include "game.h"
@@ -84,6 +87,11 @@
 /* server/scripting */
 #include "script_server.h"
 
+/* Worker pool for the city refresh pass of update_city_activities().
+ * Kicks in once a player has CITY_REFRESH_MIN_CITIES cities. */
+#define CITY_REFRESH_THREADS 4
+#define CITY_REFRESH_MIN_CITIES 80
+
 /* Queue for pending city_refresh() */
 static struct city_list *city_refresh_queue = nullptr;
 
@@ -143,7 +151,8 @@ static bool city_balance_treasury_units(struct city *pcity);
 static bool disband_city(struct city *pcity);
 
 static void define_orig_production_values(struct city *pcity);
-static void update_city_activity(struct city *pcity);
+static void update_city_activity(struct city *pcity, bool pre_refreshed,
+                                 bool radius_changed);
 static void nullify_caravan_and_disband_plus(struct city *pcity);
 static bool city_illness_check(const struct city * pcity);
 
@@ -597,6 +606,89 @@ void send_city_turn_notifications(struct connection *pconn)
   }
 }
 
+struct city_refresh_thread {
+  struct city **cities;
+  int ncities;
+  int stride, offset;
+  fc_thread thread;
+};
+
+/**********************************************************************//**
+  Worker function of one refresh thread: every CITY_REFRESH_THREADS'th
+  city, starting at the thread's offset. Only the pure recalculation
+  runs here; nothing may be sent to clients from this context.
+**************************************************************************/
+static void city_refresh_thread_run(void *arg)
+{
+  struct city_refresh_thread *self = arg;
+  const struct civ_map *nmap = &(wld.map);
+  int i;
+
+  for (i = self->offset; i < self->ncities; i += self->stride) {
+    struct city *pcity = self->cities[i];
+
+    pcity->server.needs_refresh = FALSE;
+    city_units_upkeep(pcity);
+    city_refresh_from_main_map(nmap, pcity, nullptr);
+    city_style_refresh(pcity);
+  }
+}
+
+/**********************************************************************//**
+  Refresh every city in 'cities' across a worker pool, leaving the same
+  state behind as one city_refresh() per city would. The refreshes are
+  independent as long as the world state is frozen, so only the radius
+  updates - which can reassign worked tiles and city vision - and the
+  client syncs they force run on the main thread, before respectively
+  after the workers. radius_changed[] reports the radius updates to the
+  caller.
+**************************************************************************/
+static void city_refresh_parallel(struct city **cities,
+                                  bool *radius_changed, int n)
+{
+  struct city_refresh_thread threads[CITY_REFRESH_THREADS];
+  int i, t;
+
+  for (i = 0; i < n; i++) {
+    radius_changed[i] = city_map_update_radius_sq(cities[i]);
+  }
+
+  /* The workers reach the shared effect, requirement, tile output and
+   * move rate caches; none of them may be mutated from several threads
+   * at once. Frozen caches serve what is already in them and compute
+   * the rest directly. */
+  effect_cache_freeze(TRUE);
+  requirement_memo_freeze(TRUE);
+  city_tile_output_cache_freeze(TRUE);
+  combat_cache_freeze(TRUE);
+
+  for (t = 0; t < CITY_REFRESH_THREADS; t++) {
+    threads[t].cities = cities;
+    threads[t].ncities = n;
+    threads[t].stride = CITY_REFRESH_THREADS;
+    threads[t].offset = t;
+    fc_thread_start(&threads[t].thread, city_refresh_thread_run,
+                    &threads[t]);
+  }
+  for (t = 0; t < CITY_REFRESH_THREADS; t++) {
+    fc_thread_wait(&threads[t].thread);
+  }
+
+  combat_cache_freeze(FALSE);
+  city_tile_output_cache_freeze(FALSE);
+  requirement_memo_freeze(FALSE);
+  effect_cache_freeze(FALSE);
+
+  /* The syncs city_refresh() would have sent for radius changes. */
+  for (i = 0; i < n; i++) {
+    if (radius_changed[i]) {
+      conn_list_do_buffer(city_owner(cities[i])->connections);
+      send_city_info(city_owner(cities[i]), cities[i]);
+      conn_list_do_unbuffer(city_owner(cities[i])->connections);
+    }
+  }
+}
+
 /**********************************************************************//**
   Update all cities of one nation (costs for buildings, unit upkeep, ...).
 **************************************************************************/
@@ -610,6 +702,8 @@ void update_city_activities(struct player *pplayer)
 
   if (n > 0) {
     struct city *cities[n];
+    bool radius_changed[n];
+    bool pre_refreshed = FALSE;
     int i = 0, r;
 
     city_list_iterate(pplayer->cities, pcity) {
@@ -647,9 +741,18 @@ void update_city_activities(struct player *pplayer)
       } trade_routes_iterate_safe_end;
 
       /* Add cities to array for later random order handling */
+      radius_changed[i] = FALSE;
       cities[i++] = pcity;
     } city_list_iterate_end;
 
+    if (n >= CITY_REFRESH_MIN_CITIES) {
+      /* Refresh all cities up front on the worker pool; the loop below
+       * then skips the per-city refresh unless something dirtied the
+       * city again in the meantime. */
+      city_refresh_parallel(cities, radius_changed, n);
+      pre_refreshed = TRUE;
+    }
+
     /* How gold upkeep is handled depends on the setting
      * 'game.info.gold_upkeep_style':
      * GOLD_UPKEEP_CITY: Each city tries to balance its upkeep individually
@@ -664,10 +767,14 @@ void update_city_activities(struct player *pplayer)
     /* Iterate over cities in a random order. */
     while (i > 0) {
       r = fc_rand(i);
-      /* update unit upkeep */
-      city_units_upkeep(cities[r]);
-      update_city_activity(cities[r]);
+      if (!pre_refreshed) {
+        /* update unit upkeep */
+        city_units_upkeep(cities[r]);
+      }
+      update_city_activity(cities[r], pre_refreshed,
+                           pre_refreshed && radius_changed[r]);
       cities[r] = cities[--i];
+      radius_changed[r] = radius_changed[i];
     }
   }
 }
@@ -3210,9 +3317,14 @@ static bool sell_random_building(struct player *pplayer,
   pplayer->economic.gold += city_improvement_upkeep(pcityimpr->pcity,
                                                     pcityimpr->pimprove);
 
-  city_refresh_queue_add(pcityimpr->pcity);
+  /* The lost building may have carried effects with a wider than City
+   * range, so every city of the owner needs a refresh - including ones
+   * already refreshed up front this turn. */
+  city_list_iterate(pplayer->cities, acity) {
+    acity->server.needs_refresh = TRUE;
+  } city_list_iterate_end;
 
-  FC_FREE(pcityimpr);
+  city_refresh_queue_add(pcityimpr->pcity);
 
   return TRUE;
 }
@@ -3380,7 +3492,9 @@ bool player_balance_treasury_units_and_buildings(struct player *pplayer)
   city_list_iterate(pplayer->cities, pcity) {
     city_built_iterate(pcity, pimprove) {
       if (can_city_sell_building(pcity, pimprove)) {
-        struct cityimpr *ci = fc_malloc(sizeof(*ci));
+        /* Reclaimed by the phase arena; no matching free needed. */
+        struct cityimpr *ci = fc_arena_alloc(server_phase_arena(),
+                                             sizeof(*ci));
 
         ci->pcity = pcity;
         ci->pimprove = pimprove;
@@ -3407,11 +3521,6 @@ bool player_balance_treasury_units_and_buildings(struct player *pplayer)
     sell_unit = !sell_unit;
   }
 
-  /* Free remaining entries from list */
-  cityimpr_list_iterate(pimprlist, pimpr) {
-    FC_FREE(pimpr);
-  } cityimpr_list_iterate_end;
-
   if (pplayer->economic.gold < 0) {
     /* If we get here it means the player has
      * negative gold. This should never happen. */
@@ -3477,7 +3586,9 @@ static bool city_balance_treasury_buildings(struct city *pcity)
   /* Create a vector of all buildings that can be sold. */
   city_built_iterate(pcity, pimprove) {
     if (can_city_sell_building(pcity, pimprove)) {
-      struct cityimpr *ci = fc_malloc(sizeof(*ci));
+      /* Reclaimed by the phase arena; no matching free needed. */
+      struct cityimpr *ci = fc_arena_alloc(server_phase_arena(),
+                                           sizeof(*ci));
 
       ci->pcity = pcity;
       ci->pimprove = pimprove;
@@ -3491,11 +3602,6 @@ static bool city_balance_treasury_buildings(struct city *pcity)
     /* all done in sell_random_building */
   }
 
-  /* Free remaining entries from list */
-  cityimpr_list_iterate(pimprlist, pimpr) {
-    FC_FREE(pimpr);
-  } cityimpr_list_iterate_end;
-
   cityimpr_list_destroy(pimprlist);
 
   return pplayer->economic.gold >= 0;
@@ -3721,7 +3827,8 @@ void nullify_prechange_production(struct city *pcity)
 /**********************************************************************//**
   Called every turn, at end of turn, for every city.
 **************************************************************************/
-static void update_city_activity(struct city *pcity)
+static void update_city_activity(struct city *pcity, bool pre_refreshed,
+                                 bool radius_changed)
 {
   struct player *pplayer;
   struct government *gov;
@@ -3737,7 +3844,13 @@ static void update_city_activity(struct city *pcity)
   is_happy = city_happy(pcity);
   is_celebrating = city_celebrating(pcity);
 
-  if (city_refresh(pcity)) {
+  if (pre_refreshed && !pcity->server.needs_refresh) {
+    /* Refreshed on the worker pool just before this loop, and nothing
+     * has dirtied the city since. */
+    if (radius_changed) {
+      auto_arrange_workers(pcity);
+    }
+  } else if (city_refresh(pcity)) {
     auto_arrange_workers(pcity);
   }
 
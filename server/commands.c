@@ -692,6 +692,108 @@ static struct command commands[] = {
    NULL, mapimg_help,
    CMD_ECHO_ADMINS, VCF_NONE, 50
   },
+  {"pfbench", ALLOW_ADMIN,
+   /* TRANS: translate text between <> only */
+   N_("pfbench [repeat]"),
+   N_("Benchmark the path-finding engine on the current game."),
+   N_("Replay a complete path-finding map fill for every unit in the "
+      "game, [repeat] times (default 1), and report wall-clock time and "
+      "per-mode node expansion counters. Load a savegame first to "
+      "benchmark a specific map. Intended for measuring path-finding "
+      "changes; the game state is not modified."), NULL,
+   CMD_ECHO_ADMINS, VCF_NONE, 0
+  },
+  {"cmstats", ALLOW_ADMIN,
+   /* TRANS: translate text between <> only */
+   N_("cmstats [reset]"),
+   N_("Show city management solver statistics."),
+   N_("Report how much work the city arrangement solver has done since "
+      "the counters were last reset: queries, answers served from the "
+      "memo, searches, nodes expanded, branches pruned, and wall-clock "
+      "time, followed by the cities whose last solve was most "
+      "expensive. 'cmstats reset' clears the counters."), NULL,
+   CMD_ECHO_ADMINS, VCF_NONE, 0
+  },
+  {"timing", ALLOW_ADMIN,
+   /* TRANS: translate text between <> only */
+   N_("timing\n"
+      "timing on|off\n"
+      "timing log|nolog\n"
+      "timing clear"),
+   N_("Control the scoped profiler and show its timing tree."),
+   N_("'timing on' starts collecting wall-clock times in the "
+      "hierarchical profiler; the instrumentation costs next to "
+      "nothing while it is off. Plain 'timing' dumps the tree of "
+      "scopes with times and call counts accumulated since the "
+      "current turn began; the tree resets at each turn change. "
+      "'timing log' additionally emits one machine-readable line "
+      "with the whole tree to the server log at every turn change, "
+      "'timing nolog' stops that, and 'timing clear' restarts the "
+      "current aggregation interval."), NULL,
+   CMD_ECHO_ADMINS, VCF_NONE, 0
+  },
+  {"luastats", ALLOW_ADMIN,
+   /* TRANS: translate text between <> only */
+   N_("luastats\n"
+      "luastats reset\n"
+      "luastats budget <milliseconds>"),
+   N_("Show per-handler Lua signal execution statistics."),
+   N_("Report, for every Lua callback connected to a signal, how many "
+      "times it has run and how much processor time it has consumed "
+      "since the counters were last reset, including the slowest single "
+      "run. 'luastats reset' clears the counters. "
+      "'luastats budget <milliseconds>' makes the server log a warning "
+      "whenever one handler run exceeds the given time; 0 disables the "
+      "warnings."), NULL,
+   CMD_ECHO_ADMINS, VCF_NONE, 0
+  },
+  {"memstats", ALLOW_ADMIN,
+   /* TRANS: translate text between <> only */
+   N_("memstats\n"
+      "memstats on|off\n"
+      "memstats clear"),
+   N_("Show memory allocation traffic per subsystem."),
+   N_("'memstats on' starts attributing every allocation to a coarse "
+      "subsystem tag (map, units, cities, pathfinding, lua, ...) based "
+      "on the allocating file; the accounting costs next to nothing "
+      "while it is off. Plain 'memstats' shows the bytes and allocation "
+      "counts accumulated per tag, both in total and since the last "
+      "turn change. Frees cannot be attributed, so the numbers measure "
+      "allocation traffic, not live memory. 'memstats clear' resets "
+      "the counters."), NULL,
+   CMD_ECHO_ADMINS, VCF_NONE, 0
+  },
+  {"netstats", ALLOW_ADMIN,
+   /* TRANS: translate text between <> only */
+   N_("netstats\n"
+      "netstats <connection-name>\n"
+      "netstats clear"),
+   N_("Show network egress per packet type."),
+   N_("Report how many packets and bytes of each type the server has "
+      "sent since the counters were last cleared, sorted by raw "
+      "(pre-compression) bytes, together with the bytes that actually "
+      "went to the sockets, and per-connection backlog metrics: queued "
+      "bytes, egress rate and how far behind the connection is. With a "
+      "connection name, report that connection alone. 'netstats clear' "
+      "resets the counters. The counters are always on; one log line "
+      "with the totals is also written at each turn change at verbose "
+      "log level. See also the 'netlagbytes' setting, which throttles "
+      "connections whose backlog grows too large."), NULL,
+   CMD_ECHO_ADMINS, VCF_NONE, 0
+  },
+  {"reqstats", ALLOW_ADMIN,
+   /* TRANS: translate text between <> only */
+   N_("reqstats\n"
+      "reqstats clear"),
+   N_("Show requirement and effect query counters."),
+   N_("Report how often is_req_active() has run for each requirement "
+      "kind and how often each effect type has been queried, together "
+      "with the hit rates of the requirement memo and the effect value "
+      "caches, both in total and during the last completed turn. "
+      "'reqstats clear' resets the counters. The counters are always "
+      "on and cost one array increment per query."), NULL,
+   CMD_ECHO_ADMINS, VCF_NONE, 0
+  },
   {"lock",   ALLOW_HACK,
    /* TRANS: translate text between <> only */
    N_("lock <setting>"),
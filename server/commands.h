@@ -96,6 +96,13 @@ enum command_id {
   CMD_AICMD,
   CMD_FCDB,
   CMD_MAPIMG,
+  CMD_PFBENCH,
+  CMD_CMSTATS,
+  CMD_TIMING,
+  CMD_LUASTATS,
+  CMD_MEMSTATS,
+  CMD_NETSTATS,
+  CMD_REQSTATS,
 
   CMD_LOCK,
   CMD_UNLOCK,
@@ -46,6 +46,7 @@
 #include "report.h"
 #include "ruleload.h"
 #include "sernet.h"
+#include "sessionrec.h"
 #include "settings.h"
 #include "srv_main.h"
 #include "stdinhand.h"
@@ -1006,6 +1007,8 @@ bool connection_delegate_restore(struct connection *pconn)
 **************************************************************************/
 void connection_close_server(struct connection *pconn, const char *reason)
 {
+  session_record_conn_close(pconn->id);
+
   /* Restore possible delegations before the connection is closed. */
   connection_delegate_restore(pconn);
   connection_close(pconn, reason);
@@ -30,6 +30,8 @@
 #include "events.h"
 #include "game.h"
 #include "map.h"
+#include "metaknowledge.h"
+#include "movement.h"
 #include "packets.h"
 #include "player.h"
 #include "research.h"
@@ -137,6 +139,9 @@ void set_diplstate_type(struct player_diplstate *state1,
   state2->type = type;
   state1->max_state = max;
   state2->max_state = max;
+
+  /* Diplomatic states are an input of cached move legality verdicts. */
+  move_legality_cache_invalidate();
 }
 
 /**********************************************************************//**
@@ -699,6 +704,7 @@ void establish_embassy(struct player *pplayer, struct player *aplayer)
 {
   /* Establish the embassy. */
   BV_SET(pplayer->real_embassy, player_index(aplayer));
+  metaknowledge_intel_invalidate();
 
   player_list_iterate(team_members(pplayer->team), teammate) {
     /* Knowledge that pplayer has an embassy now */
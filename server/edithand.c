@@ -21,6 +21,7 @@
 #include "bitvector.h"
 #include "fcintl.h"
 #include "log.h"
+#include "mem.h"
 #include "shared.h"
 #include "support.h"
 
@@ -46,10 +47,14 @@
 #include "plrhand.h"
 #include "notify.h"
 #include "sanitycheck.h"
+#include "score.h"
 #include "stdinhand.h"
 #include "techtools.h"
 #include "unittools.h"
 
+/* server/advisors */
+#include "advdata.h"
+
 /* server/generator */
 #include "mapgen_utils.h"
 
@@ -67,6 +72,14 @@ static bool need_continents_reassigned = FALSE;
  * and final global fix-ups have been done. */
 static struct tile_hash *modified_tile_table = NULL;
 
+/* Ids of cities whose worked tiles were emptied during the edit
+ * sequence. Their workers are rearranged just once, when the sequence
+ * is complete, rather than after every single tile of a brush stroke.
+ * Stored by id since edits may also remove cities. */
+static int *deferred_city_arrange = NULL;
+static int deferred_city_arrange_count = 0;
+static int deferred_city_arrange_capacity = 0;
+
 /* Array of size player_slot_count() indexed by player
  * number to tell whether a given player has fog of war
  * disabled in edit mode. */
@@ -83,6 +96,7 @@ void edithand_init(void)
   modified_tile_table = tile_hash_new();
 
   need_continents_reassigned = FALSE;
+  deferred_city_arrange_count = 0;
 
   if (unfogged_players != NULL) {
     free(unfogged_players);
@@ -104,6 +118,13 @@ void edithand_free(void)
     free(unfogged_players);
     unfogged_players = NULL;
   }
+
+  if (deferred_city_arrange != NULL) {
+    free(deferred_city_arrange);
+    deferred_city_arrange = NULL;
+    deferred_city_arrange_count = 0;
+    deferred_city_arrange_capacity = 0;
+  }
 }
 
 /************************************************************************//**
@@ -140,20 +161,68 @@ void edithand_send_initial_packets(struct conn_list *dest)
   } map_startpos_iterate_end;
 }
 
+/************************************************************************//**
+  Run the side effects of a single tile edit, deferring the expensive
+  per-city worker rearrangement to the end of the edit sequence.
+****************************************************************************/
+static void edit_tile_side_effects(struct tile *ptile)
+{
+  struct city *pcity = ptile->worked;
+  int i;
+
+  tile_change_side_effects(ptile, FALSE);
+
+  if (pcity == NULL || ptile->worked != NULL) {
+    /* No city lost this tile. */
+    return;
+  }
+
+  for (i = 0; i < deferred_city_arrange_count; i++) {
+    if (deferred_city_arrange[i] == pcity->id) {
+      return;
+    }
+  }
+
+  if (deferred_city_arrange_count >= deferred_city_arrange_capacity) {
+    deferred_city_arrange_capacity
+      = MAX(deferred_city_arrange_capacity * 2, 16);
+    deferred_city_arrange
+      = fc_realloc(deferred_city_arrange,
+                   deferred_city_arrange_capacity
+                   * sizeof(*deferred_city_arrange));
+  }
+  deferred_city_arrange[deferred_city_arrange_count++] = pcity->id;
+}
+
 /************************************************************************//**
   Do the potentially slow checks required after one or several tiles'
   terrain has change.
 ****************************************************************************/
 static void check_edited_tile_terrains(void)
 {
+  int i;
+
   if (need_continents_reassigned) {
     assign_continent_numbers();
     send_all_known_tiles(NULL);
     need_continents_reassigned = FALSE;
+    adv_threat_invalidate();
 
     /* FIXME: adv / ai phase handling like in check_terrain_change() */
   }
 
+  /* Rearrange workers of each affected city once, however many of its
+   * worked tiles the edit sequence emptied. */
+  for (i = 0; i < deferred_city_arrange_count; i++) {
+    struct city *pcity = game_city_by_number(deferred_city_arrange[i]);
+
+    if (pcity != NULL) {
+      auto_arrange_workers(pcity);
+      send_city_info(NULL, pcity);
+    }
+  }
+  deferred_city_arrange_count = 0;
+
 #ifdef SANITY_CHECKING
   tile_hash_iterate(modified_tile_table, ptile) {
     sanity_check_tile(ptile);
@@ -246,7 +315,7 @@ static bool edit_tile_terrain_handling(struct tile *ptile,
     update_tile_knowledge(ptile);
   }
 
-  tile_change_side_effects(ptile, TRUE);
+  edit_tile_side_effects(ptile);
 
   return TRUE;
 }
@@ -289,7 +358,7 @@ static bool edit_tile_extra_handling(struct tile *ptile,
     update_tile_knowledge(ptile);
   }
 
-  tile_change_side_effects(ptile, TRUE);
+  edit_tile_side_effects(ptile);
 
   return TRUE;
 }
@@ -428,7 +497,7 @@ void handle_edit_tile(struct connection *pc,
     send_tile_info(NULL, ptile, FALSE);
   }
 
-  tile_change_side_effects(ptile, TRUE);
+  edit_tile_side_effects(ptile);
 }
 
 /************************************************************************//**
@@ -1109,6 +1178,7 @@ void handle_edit_player(struct connection *pc,
     }
     changed = TRUE;
     update_research = TRUE;
+    score_counters_invalidate();
   } advance_index_iterate_end;
 
   /* Handle a change in the player's gold. */
@@ -1325,7 +1395,9 @@ void handle_edit_city_remove(struct connection *pc, int id)
 ****************************************************************************/
 void handle_edit_check_tiles(struct connection *pc)
 {
+  conn_list_do_buffer(game.est_connections);
   check_edited_tile_terrains();
+  conn_list_do_unbuffer(game.est_connections);
 }
 
 /************************************************************************//**
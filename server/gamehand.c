@@ -16,6 +16,7 @@
 #endif
 
 #include <stdio.h> /* for remove() */
+#include <string.h>
 
 /* utility */
 #include "capability.h"
@@ -909,12 +910,33 @@ void send_year_to_clients(void)
 ****************************************************************************/
 void send_game_info(struct conn_list *dest)
 {
+  /* Snapshot of the content of the last full broadcast. */
+  static struct packet_game_info last_info;
+  static struct packet_calendar_info last_calendar;
+  static bool last_valid = FALSE;
+  bool broadcast = (dest == NULL);
+  bool send_info;
   struct packet_timeout_info tinfo;
 
   if (!dest) {
     dest = game.est_connections;
   }
 
+  /* The game and calendar info packets are big, and rebroadcast on many
+   * events that leave them untouched. When sending to everybody, compare
+   * against the previous broadcast once and skip the per-connection
+   * encoding entirely if nothing changed - every established connection
+   * already has this exact content. Targeted sends (e.g. to a newly
+   * established connection) always carry the full set. */
+  send_info = !broadcast || !last_valid
+    || memcmp(&last_info, &game.info, sizeof(last_info)) != 0
+    || memcmp(&last_calendar, &game.calendar, sizeof(last_calendar)) != 0;
+  if (broadcast && send_info) {
+    last_info = game.info;
+    last_calendar = game.calendar;
+    last_valid = TRUE;
+  }
+
   tinfo = game.tinfo;
 
   /* the following values are computed every
@@ -940,8 +962,10 @@ void send_game_info(struct conn_list *dest)
      * be sent always (it's not 'is-info') while the others are 'is-info'
      * Calendar info has been split from Game info packet to make packet
      * size more tolerable when json protocol is in use. */
-    send_packet_game_info(pconn, &(game.info));
-    send_packet_calendar_info(pconn, &(game.calendar));
+    if (send_info) {
+      send_packet_game_info(pconn, &(game.info));
+      send_packet_calendar_info(pconn, &(game.calendar));
+    }
     send_packet_timeout_info(pconn, &tinfo);
   }
   conn_list_iterate_end;
@@ -15,6 +15,7 @@
 #endif
 
 /* utility */
+#include "fcthread.h"
 #include "rand.h"
 
 /* common */
@@ -49,6 +50,65 @@ typedef struct {
 static map_landmass *landmass;
 static map_point *fracture_points;
 
+#define FRACTURE_ASSIGN_THREADS 4
+/* Maps smaller than this keep the classic expanding-circle assignment. */
+#define FRACTURE_ASSIGN_MIN_TILES (128 * 128)
+
+struct fracture_assign_thread {
+  int npoints;
+  int stride, offset;
+  fc_thread thread;
+};
+
+/**********************************************************************//**
+  Worker function of one assignment thread: every
+  FRACTURE_ASSIGN_THREADS'th tile, starting at the thread's offset.
+
+  The expanding circles of the classic path hand each tile to whichever
+  fracture point reaches it first, which in the limit is simply the
+  nearest point - with ties going to the lowest numbered landmass, as
+  the circles are drawn in landmass order at every radius. Computing
+  that directly per tile needs no shared state, so tiles can be
+  assigned concurrently and the result is independent of scheduling.
+**************************************************************************/
+static void fracture_assign_thread_run(void *arg)
+{
+  struct fracture_assign_thread *self = arg;
+  int mindex;
+
+  for (mindex = self->offset; mindex < MAP_INDEX_SIZE;
+       mindex += self->stride) {
+    struct tile *ptile = index_to_tile(&(wld.map), mindex);
+    int x, y;
+    int best = -1;
+    int bestdist = 0;
+    int nn;
+
+    index_to_native_pos(&x, &y, mindex);
+    for (nn = 0; nn < self->npoints; nn++) {
+      int dx = x - fracture_points[nn].x;
+      int dy = y - fracture_points[nn].y;
+      int dist;
+
+      /* The classic path wraps the circles in x but not in y. */
+      if (dx < 0) {
+        dx = -dx;
+      }
+      if (dx > MAP_NATIVE_WIDTH - dx) {
+        dx = MAP_NATIVE_WIDTH - dx;
+      }
+      dist = dx * dx + dy * dy;
+      if (best < 0 || dist < bestdist) {
+        best = nn;
+        bestdist = dist;
+      }
+    }
+
+    ptile->continent = best + 1;
+    hmap(ptile) = landmass[best].elevation;
+  }
+}
+
 /**********************************************************************//**
   Fracture map generator
 **************************************************************************/
@@ -120,10 +180,28 @@ void make_fracture_map(void)
   }
 
   /* Assign cells to landmass. Gradually expand the radius of the
-     fracture point. */
-  for (rad = 1; rad < (MAP_NATIVE_WIDTH >> 1); rad++) {
-    for (nn = 0; nn < mm + num_landmass; nn++) {
-      circle_bresenham(fracture_points[nn].x, fracture_points[nn].y, rad, nn+1);
+     fracture point. On big maps the tiles are instead handed straight
+     to their nearest fracture point across a worker pool; see
+     fracture_assign_thread_run(). */
+  if (MAP_INDEX_SIZE >= FRACTURE_ASSIGN_MIN_TILES) {
+    struct fracture_assign_thread threads[FRACTURE_ASSIGN_THREADS];
+    int t;
+
+    for (t = 0; t < FRACTURE_ASSIGN_THREADS; t++) {
+      threads[t].npoints = mm + num_landmass;
+      threads[t].stride = FRACTURE_ASSIGN_THREADS;
+      threads[t].offset = t;
+      fc_thread_start(&threads[t].thread, fracture_assign_thread_run,
+                      &threads[t]);
+    }
+    for (t = 0; t < FRACTURE_ASSIGN_THREADS; t++) {
+      fc_thread_wait(&threads[t].thread);
+    }
+  } else {
+    for (rad = 1; rad < (MAP_NATIVE_WIDTH >> 1); rad++) {
+      for (nn = 0; nn < mm + num_landmass; nn++) {
+        circle_bresenham(fracture_points[nn].x, fracture_points[nn].y, rad, nn+1);
+      }
     }
   }
 
@@ -15,6 +15,7 @@
 #endif
 
 /* utility */
+#include "fcthread.h"
 #include "rand.h"
 
 /* common */
@@ -29,6 +30,50 @@
 int *height_map = nullptr;
 int hmap_shore_level = 0, hmap_mountain_level = 0;
 
+#define HMAP_GEN_THREADS 4
+/* Maps smaller than this keep the classic single-threaded generators. */
+#define HMAP_GEN_MIN_TILES (128 * 128)
+
+/* Salt mixed into hmap_pos_noise() so different maps get different
+ * height maps. Drawn from the main random stream before any worker
+ * thread starts, so it is a pure function of the game seed. */
+static RANDOM_TYPE hmap_noise_salt;
+
+/**********************************************************************//**
+  Deterministic stand-in for fc_rand() on the threaded generator paths,
+  in the interval 0 to (size - 1) inclusive. The result depends only on
+  the map position and the per-map salt, never on evaluation order, so
+  workers that touch the same tile concurrently - the shared block edges
+  in make_pseudofractal1_hmap() - agree on its value and the finished
+  map does not depend on thread scheduling. fc_randomly() serves the
+  same purpose elsewhere, but its small modulus cannot cover the
+  displacement ranges needed here.
+**************************************************************************/
+static int hmap_pos_noise(int mindex, int size)
+{
+  RANDOM_TYPE hash = (RANDOM_TYPE) mindex ^ hmap_noise_salt;
+
+  if (size <= 1) {
+    return 0;
+  }
+
+  hash ^= hash >> 16;
+  hash *= 0x7feb352dU;
+  hash ^= hash >> 15;
+  hash *= 0x846ca68bU;
+  hash ^= hash >> 16;
+
+  return hash % (RANDOM_TYPE) size;
+}
+
+/**********************************************************************//**
+  Draw the position noise salt for this map from the main random stream.
+**************************************************************************/
+static void hmap_draw_noise_salt(void)
+{
+  hmap_noise_salt = ((RANDOM_TYPE) fc_rand(65536) << 16) ^ fc_rand(65536);
+}
+
 /**********************************************************************//**
   Factor by which to lower height map near poles in normalize_hmap_poles()
 **************************************************************************/
@@ -94,6 +139,27 @@ void renormalize_hmap_poles(void)
   } whole_map_iterate_end;
 }
 
+struct hmap_fill_thread {
+  int range;
+  int stride, offset;
+  fc_thread thread;
+};
+
+/**********************************************************************//**
+  Worker function of one fill thread: every HMAP_GEN_THREADS'th tile,
+  starting at the thread's offset.
+**************************************************************************/
+static void hmap_fill_thread_run(void *arg)
+{
+  struct hmap_fill_thread *self = arg;
+  int mindex;
+
+  for (mindex = self->offset; mindex < MAP_INDEX_SIZE;
+       mindex += self->stride) {
+    height_map[mindex] = hmap_pos_noise(mindex, self->range);
+  }
+}
+
 /**********************************************************************//**
   Create uncorrelated rand map and do some call to smoth to correlate
   it a little and create random shapes
@@ -103,7 +169,24 @@ void make_random_hmap(int smooth)
   int i = 0;
   height_map = fc_malloc(sizeof(*height_map) * MAP_INDEX_SIZE);
 
-  INITIALIZE_ARRAY(height_map, MAP_INDEX_SIZE, fc_rand(1000 * smooth));
+  if (MAP_INDEX_SIZE >= HMAP_GEN_MIN_TILES) {
+    struct hmap_fill_thread threads[HMAP_GEN_THREADS];
+    int t;
+
+    hmap_draw_noise_salt();
+    for (t = 0; t < HMAP_GEN_THREADS; t++) {
+      threads[t].range = 1000 * smooth;
+      threads[t].stride = HMAP_GEN_THREADS;
+      threads[t].offset = t;
+      fc_thread_start(&threads[t].thread, hmap_fill_thread_run,
+                      &threads[t]);
+    }
+    for (t = 0; t < HMAP_GEN_THREADS; t++) {
+      fc_thread_wait(&threads[t].thread);
+    }
+  } else {
+    INITIALIZE_ARRAY(height_map, MAP_INDEX_SIZE, fc_rand(1000 * smooth));
+  }
 
   for (; i < smooth; i++) {
     smooth_int_map(height_map, TRUE);
@@ -112,12 +195,35 @@ void make_random_hmap(int smooth)
   adjust_int_map(height_map, 0, hmap_max_level);
 }
 
+/**********************************************************************//**
+  Random displacement for the midpoint at native (x, y): drawn from the
+  main random stream on the classic path, from the position hash on the
+  threaded one.
+**************************************************************************/
+static int hmap_displace(bool threaded, int x, int y, int step)
+{
+  int r;
+
+  if (threaded) {
+    r = hmap_pos_noise(native_pos_to_index(x, y), step);
+  } else {
+    r = fc_rand(step);
+  }
+
+  return r - step / 2;
+}
+
 /**********************************************************************//**
   Recursive function which does the work for generator 5.
 
+  With 'threaded' set the random displacements come from hmap_pos_noise()
+  and already set tiles are never overwritten, so concurrent calls on
+  blocks that only overlap on their shared edge tiles compute identical
+  values for those and the result is independent of scheduling.
+
   All (x0, y0) and (x1, y1) are in native coordinates.
 **************************************************************************/
-static void gen5rec(int step, int xl, int yt, int xr, int yb)
+static void gen5rec(int step, bool threaded, int xl, int yt, int xr, int yb)
 {
   int val[2][2];
   int x1wrap = xr; /* To wrap correctly */
@@ -147,7 +253,11 @@ static void gen5rec(int step, int xl, int yt, int xr, int yb)
 #define set_midpoints(X, Y, V)                                          \
   {                                                                     \
     struct tile *ptile = native_pos_to_tile(&(wld.map), (X), (Y));      \
-    if (map_colatitude(ptile) <= ICE_BASE_LEVEL / 2) {                  \
+    if (threaded && hmap(ptile) != 0) {                                 \
+      /* Blocks overlap only on their shared edge tiles and all their   \
+       * workers compute the same value for those, so the first write   \
+       * is as good as any later one. */                                \
+    } else if (map_colatitude(ptile) <= ICE_BASE_LEVEL / 2) {           \
       /* Possibly flatten poles, or possibly not (even at map edge) */  \
       hmap(ptile) = (V) * (100 - wld.map.server.flatpoles) / 100;       \
     } else if (near_singularity(ptile)                                  \
@@ -159,26 +269,61 @@ static void gen5rec(int step, int xl, int yt, int xr, int yb)
   }
 
   set_midpoints((xl + xr) / 2, yt,
-                (val[0][0] + val[1][0]) / 2 + (int)fc_rand(step) - step / 2);
+                (val[0][0] + val[1][0]) / 2
+                + hmap_displace(threaded, (xl + xr) / 2, yt, step));
   set_midpoints((xl + xr) / 2,  y1wrap,
-                (val[0][1] + val[1][1]) / 2 + (int)fc_rand(step) - step / 2);
+                (val[0][1] + val[1][1]) / 2
+                + hmap_displace(threaded, (xl + xr) / 2, y1wrap, step));
   set_midpoints(xl, (yt + yb)/2,
-                (val[0][0] + val[0][1]) / 2 + (int)fc_rand(step) - step / 2);
+                (val[0][0] + val[0][1]) / 2
+                + hmap_displace(threaded, xl, (yt + yb) / 2, step));
   set_midpoints(x1wrap,  (yt + yb) / 2,
-                (val[1][0] + val[1][1]) / 2 + (int)fc_rand(step) - step / 2);
+                (val[1][0] + val[1][1]) / 2
+                + hmap_displace(threaded, x1wrap, (yt + yb) / 2, step));
 
   /* Set middle to average of midpoints plus a random factor, if not set */
   set_midpoints((xl + xr) / 2, (yt + yb) / 2,
                 ((val[0][0] + val[0][1] + val[1][0] + val[1][1]) / 4
-                 + (int)fc_rand(step) - step / 2));
+                 + hmap_displace(threaded, (xl + xr) / 2, (yt + yb) / 2,
+                                 step)));
 
 #undef set_midpoints
 
   /* Now call recursively on the four subrectangles */
-  gen5rec(2 * step / 3, xl, yt, (xr + xl) / 2, (yb + yt) / 2);
-  gen5rec(2 * step / 3, xl, (yb + yt) / 2, (xr + xl) / 2, yb);
-  gen5rec(2 * step / 3, (xr + xl) / 2, yt, xr, (yb + yt) / 2);
-  gen5rec(2 * step / 3, (xr + xl) / 2, (yb + yt) / 2, xr, yb);
+  gen5rec(2 * step / 3, threaded, xl, yt, (xr + xl) / 2, (yb + yt) / 2);
+  gen5rec(2 * step / 3, threaded, xl, (yb + yt) / 2, (xr + xl) / 2, yb);
+  gen5rec(2 * step / 3, threaded, (xr + xl) / 2, yt, xr, (yb + yt) / 2);
+  gen5rec(2 * step / 3, threaded, (xr + xl) / 2, (yb + yt) / 2, xr, yb);
+}
+
+struct hmap_block_thread {
+  int xdiv, ydiv;
+  int xmax, ymax;
+  int step;
+  int stride, offset;
+  fc_thread thread;
+};
+
+/**********************************************************************//**
+  Worker function of one pseudofractal thread: every HMAP_GEN_THREADS'th
+  block, starting at the thread's offset.
+**************************************************************************/
+static void hmap_block_thread_run(void *arg)
+{
+  struct hmap_block_thread *self = arg;
+  int nblocks = self->xdiv * self->ydiv;
+  int b;
+
+  for (b = self->offset; b < nblocks; b += self->stride) {
+    int x_current = b / self->ydiv;
+    int y_current = b % self->ydiv;
+
+    gen5rec(self->step, TRUE,
+            x_current * self->xmax / self->xdiv,
+            y_current * self->ymax / self->ydiv,
+            (x_current + 1) * self->xmax / self->xdiv,
+            (y_current + 1) * self->ymax / self->ydiv);
+  }
 }
 
 /**********************************************************************//**
@@ -194,6 +339,9 @@ static void gen5rec(int step, int xl, int yt, int xr, int yb)
 
   extra_div can be increased to break the world up into more, smaller
   islands. This is used in conjunction with the startpos setting.
+
+  On big maps the blocks recurse on a worker pool; see gen5rec() for why
+  that reproduces the same map for a given seed on any thread count.
 **************************************************************************/
 void make_pseudofractal1_hmap(int extra_div)
 {
@@ -245,10 +393,32 @@ void make_pseudofractal1_hmap(int extra_div)
   }
 
   /* Calculate recursively on each block */
-  for (x_current = 0; x_current < xdiv; x_current++) {
-    for (y_current = 0; y_current < ydiv; y_current++) {
-      gen5rec(step, x_current * xmax / xdiv, y_current * ymax / ydiv,
-              (x_current + 1) * xmax / xdiv, (y_current + 1) * ymax / ydiv);
+  if (MAP_INDEX_SIZE >= HMAP_GEN_MIN_TILES) {
+    struct hmap_block_thread threads[HMAP_GEN_THREADS];
+    int t;
+
+    hmap_draw_noise_salt();
+    for (t = 0; t < HMAP_GEN_THREADS; t++) {
+      threads[t].xdiv = xdiv;
+      threads[t].ydiv = ydiv;
+      threads[t].xmax = xmax;
+      threads[t].ymax = ymax;
+      threads[t].step = step;
+      threads[t].stride = HMAP_GEN_THREADS;
+      threads[t].offset = t;
+      fc_thread_start(&threads[t].thread, hmap_block_thread_run,
+                      &threads[t]);
+    }
+    for (t = 0; t < HMAP_GEN_THREADS; t++) {
+      fc_thread_wait(&threads[t].thread);
+    }
+  } else {
+    for (x_current = 0; x_current < xdiv; x_current++) {
+      for (y_current = 0; y_current < ydiv; y_current++) {
+        gen5rec(step, FALSE, x_current * xmax / xdiv,
+                y_current * ymax / ydiv, (x_current + 1) * xmax / xdiv,
+                (y_current + 1) * ymax / ydiv);
+      }
     }
   }
 
@@ -171,12 +171,19 @@ static int river_pct = 0;
 **************************************************************************/
 /* WETNESS */
 
-/* Necessary condition of deserts placement */
-#define map_pos_is_dry(ptile)                                           \
+/* Necessary condition of deserts placement. A real tmap caches this
+ * per tile while it sweeps the map anyway - see create_tmap() - which
+ * saves rescanning the tile's neighbourhood on every query below. The
+ * island generators run on a dummy tmap with their oceans still being
+ * placed, so they keep computing it from the terrain. */
+#define map_pos_is_dry_uncached(ptile)                                  \
   (map_colatitude((ptile)) <= DRY_MAX_LEVEL                             \
    && map_colatitude((ptile)) > DRY_MIN_LEVEL                           \
    && count_terrain_class_near_tile(&(wld.map), (ptile),                \
                                     FALSE, TRUE, TC_OCEAN) <= 35)
+#define map_pos_is_dry(ptile)                                           \
+  (tmap_has_dryness()                                                   \
+   ? tmap_is_dry((ptile)) : map_pos_is_dry_uncached(ptile))
 typedef enum { WC_ALL = 200, WC_DRY, WC_NDRY } wetness_c;
 
 /* MISCELLANEOUS (OTHER CONDITIONS) */
@@ -899,6 +906,172 @@ static bool make_river(struct river_map *privermap, struct tile *ptile,
   } /* end while; (Make a river.) */
 }
 
+/**********************************************************************//**
+  Compare two tile indices by height, tallest first, ties by index; for
+  the drainage ordering in make_flow_rivers().
+**************************************************************************/
+static int river_flow_height_cmp(const void *a, const void *b)
+{
+  int tindex_a = *(const int *) a;
+  int tindex_b = *(const int *) b;
+
+  if (height_map[tindex_a] != height_map[tindex_b]) {
+    return height_map[tindex_b] - height_map[tindex_a];
+  }
+
+  return tindex_a - tindex_b;
+}
+
+/**********************************************************************//**
+  Compare two flow accumulation values, largest first; for the river
+  threshold selection in make_flow_rivers().
+**************************************************************************/
+static int river_flow_acc_cmp(const void *a, const void *b)
+{
+  return *(const int *) b - *(const int *) a;
+}
+
+/**********************************************************************//**
+  Lay out rivers by following the water down the height map, for the
+  'flowrivers' setting. Each land tile drains into its lowest strictly
+  lower cardinal neighbour - or into the sea when one is cardinally
+  adjacent - and passes down everything that drained into it. The
+  tiles collecting the most flow become the rivers, with the threshold
+  picked so that roughly desirable_riverlength tiles qualify.
+
+  Unlike make_river() below this needs no retries: it is a fixed number
+  of whole-map passes plus two sorts, whatever the map size and
+  wetness. Each river system gets one river type, drawn where it meets
+  the sea (or dries up) and inherited upstream.
+**************************************************************************/
+static void make_flow_rivers(int desirable_riverlength)
+{
+  int *order, *downstream, *acc, *rtype;
+  int neligible = 0;
+  int threshold, i;
+
+  if (desirable_riverlength <= 0) {
+    return;
+  }
+
+  order = fc_malloc(MAP_INDEX_SIZE * sizeof(*order));
+  downstream = fc_malloc(MAP_INDEX_SIZE * sizeof(*downstream));
+  acc = fc_malloc(MAP_INDEX_SIZE * sizeof(*acc));
+  rtype = fc_malloc(MAP_INDEX_SIZE * sizeof(*rtype));
+
+  /* Choose each land tile's outflow. Insisting on a strictly lower
+   * neighbour keeps the drainage graph free of cycles; flat basins and
+   * local pits simply end there, like a river drying up inland. */
+  whole_map_iterate(&(wld.map), ptile) {
+    int tindex = tile_index(ptile);
+    int lowest = hmap(ptile);
+    int best = -1;
+    bool coastal = FALSE;
+
+    order[tindex] = tindex;
+    rtype[tindex] = -1;
+
+    if (is_ocean(tile_terrain(ptile))) {
+      downstream[tindex] = -1;
+      acc[tindex] = 0;
+      continue;
+    }
+    acc[tindex] = 1;
+
+    cardinal_adjc_iterate(&(wld.map), ptile, ptile1) {
+      if (is_ocean(tile_terrain(ptile1))) {
+        coastal = TRUE;
+      } else if (hmap(ptile1) < lowest) {
+        lowest = hmap(ptile1);
+        best = tile_index(ptile1);
+      }
+    } cardinal_adjc_iterate_end;
+
+    /* At the coast the water leaves the map rather than hugging it. */
+    downstream[tindex] = coastal ? -1 : best;
+  } whole_map_iterate_end;
+
+  /* Accumulate flow from the top down. Every outflow target is strictly
+   * lower than its source, so by the time a tile is reached everything
+   * draining through it has been added up. */
+  qsort(order, MAP_INDEX_SIZE, sizeof(*order), river_flow_height_cmp);
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    int tindex = order[i];
+
+    if (acc[tindex] > 0 && downstream[tindex] >= 0) {
+      acc[downstream[tindex]] += acc[tindex];
+    }
+  }
+
+  /* Find the accumulation level that turns about
+   * desirable_riverlength eligible tiles into rivers. */
+  {
+    int *eligible_acc = fc_malloc(MAP_INDEX_SIZE * sizeof(*eligible_acc));
+
+    whole_map_iterate(&(wld.map), ptile) {
+      int tindex = tile_index(ptile);
+
+      if (acc[tindex] > 0
+          && !(tile_terrain(ptile)->property[MG_FROZEN] > 0
+               && map_colatitude(ptile) < 0.8 * COLD_LEVEL)) {
+        eligible_acc[neligible++] = acc[tindex];
+      }
+    } whole_map_iterate_end;
+
+    if (neligible == 0) {
+      free(eligible_acc);
+      free(order);
+      free(downstream);
+      free(acc);
+      free(rtype);
+      return;
+    }
+
+    qsort(eligible_acc, neligible, sizeof(*eligible_acc),
+          river_flow_acc_cmp);
+    /* A spring needs at least one tile draining into it, or every
+     * hilltop on a dry map would qualify. */
+    threshold = MAX(2,
+                    eligible_acc[MIN(desirable_riverlength, neligible) - 1]);
+    free(eligible_acc);
+  }
+
+  /* Apply, from the river mouths up so that each river system keeps
+   * the type drawn where it ends. */
+  for (i = MAP_INDEX_SIZE - 1; i >= 0; i--) {
+    int tindex = order[i];
+    struct tile *ptile = index_to_tile(&(wld.map), tindex);
+    struct terrain *river_terrain;
+
+    if (acc[tindex] < threshold
+        || (tile_terrain(ptile)->property[MG_FROZEN] > 0
+            && map_colatitude(ptile) < 0.8 * COLD_LEVEL)) {
+      continue;
+    }
+
+    if (downstream[tindex] >= 0 && rtype[downstream[tindex]] >= 0) {
+      rtype[tindex] = rtype[downstream[tindex]];
+    } else {
+      rtype[tindex] = fc_rand(river_type_count);
+    }
+
+    river_terrain = tile_terrain(ptile);
+    if (!terrain_has_flag(river_terrain, TER_CAN_HAVE_RIVER)) {
+      /* We have to change the terrain to put a river here. */
+      river_terrain = pick_terrain_by_flag(TER_CAN_HAVE_RIVER);
+      if (river_terrain != nullptr) {
+        tile_set_terrain(ptile, river_terrain);
+      }
+    }
+    tile_add_extra(ptile, river_types[rtype[tindex]]);
+  }
+
+  free(order);
+  free(downstream);
+  free(acc);
+  free(rtype);
+}
+
 /**********************************************************************//**
   Calls make_river until there are enough river tiles on the map. It stops
   when it has tried to create RIVERS_MAXTRIES rivers.           -Erik Sigra
@@ -936,6 +1109,12 @@ static void make_rivers(void)
     return;
   }
 
+  if (wld.map.server.flowrivers) {
+    /* Trace drainage down the height map instead of random walks. */
+    make_flow_rivers(desirable_riverlength);
+    return;
+  }
+
   create_placed_map(); /* Needed by rand_map_characteristic() */
   set_all_ocean_tiles_placed();
 
@@ -16,6 +16,7 @@
 
 /* utility */
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "rand.h"
 #include "support.h"            /* bool type */
@@ -182,11 +183,164 @@ bool is_normal_nat_pos(int x, int y)
   return is_normal_map_pos(x, y);
 }
 
+#define SMOOTH_MAP_THREADS 4
+/* Maps smaller than this are smoothed on the calling thread alone. */
+#define SMOOTH_MAP_MIN_TILES (128 * 128)
+
+struct smooth_map_thread {
+  const float *weight;
+  int *source_map, *target_map;
+  bool axe, zeroes_at_edges, wrap;
+  int stride, offset;
+  fc_thread thread;
+};
+
+/**********************************************************************//**
+  Horizontal diffusion pass over one row; 'dst' and 'src' point at the
+  start of the row. All but the outermost two columns read five
+  consecutive source values, a straight run the compiler can
+  vectorize. The taps are accumulated in ascending offset order, so the
+  results match what tile-by-tile axis iteration used to produce.
+**************************************************************************/
+static void smooth_map_row_x(int *dst, const int *src, const float *weight,
+                             bool zeroes_at_edges, bool wrap)
+{
+  const int width = MAP_NATIVE_WIDTH;
+  const float dfull = zeroes_at_edges ? 1
+    : weight[0] + weight[1] + weight[2] + weight[3] + weight[4];
+  int x;
+
+  for (x = 2; x < width - 2; x++) {
+    float N = weight[0] * src[x - 2] + weight[1] * src[x - 1]
+      + weight[2] * src[x] + weight[3] * src[x + 1]
+      + weight[4] * src[x + 2];
+
+    dst[x] = N / dfull;
+  }
+
+  /* Columns whose stencil runs off the row: wrap it or drop the
+   * missing taps, like unreal positions always were. */
+  for (x = 0; x < width; x++) {
+    float N = 0, D = 0;
+    int k;
+
+    if (x >= 2 && x < width - 2) {
+      continue;
+    }
+    for (k = -2; k <= 2; k++) {
+      int xx = x + k;
+
+      if (wrap) {
+        if (xx < 0) {
+          xx += width;
+        } else if (xx >= width) {
+          xx -= width;
+        }
+      } else if (xx < 0 || xx >= width) {
+        continue;
+      }
+      D += weight[k + 2];
+      N += weight[k + 2] * src[xx];
+    }
+    if (zeroes_at_edges) {
+      D = 1;
+    }
+    dst[x] = N / D;
+  }
+}
+
+/**********************************************************************//**
+  Vertical diffusion pass for row 'y'; 'dst' points at the start of the
+  row, 'src' at the whole source map. Every tap is a contiguous row of
+  the source array, so the inner loops stream through memory and
+  vectorize just as well as the horizontal pass.
+**************************************************************************/
+static void smooth_map_row_y(int *dst, const int *src, int y,
+                             const float *weight, bool zeroes_at_edges,
+                             bool wrap)
+{
+  const int width = MAP_NATIVE_WIDTH;
+  const int height = MAP_NATIVE_HEIGHT;
+  const int *rows[5];
+  float tapweight[5];
+  float D = 0;
+  int ntaps = 0;
+  int k, x;
+
+  for (k = -2; k <= 2; k++) {
+    int yy = y + k;
+
+    if (wrap) {
+      if (yy < 0) {
+        yy += height;
+      } else if (yy >= height) {
+        yy -= height;
+      }
+    } else if (yy < 0 || yy >= height) {
+      continue;
+    }
+    rows[ntaps] = src + yy * width;
+    tapweight[ntaps] = weight[k + 2];
+    D += weight[k + 2];
+    ntaps++;
+  }
+  if (zeroes_at_edges) {
+    D = 1;
+  }
+
+  if (ntaps == 5) {
+    for (x = 0; x < width; x++) {
+      float N = tapweight[0] * rows[0][x] + tapweight[1] * rows[1][x]
+        + tapweight[2] * rows[2][x] + tapweight[3] * rows[3][x]
+        + tapweight[4] * rows[4][x];
+
+      dst[x] = N / D;
+    }
+  } else {
+    for (x = 0; x < width; x++) {
+      float N = 0;
+
+      for (k = 0; k < ntaps; k++) {
+        N += tapweight[k] * rows[k][x];
+      }
+      dst[x] = N / D;
+    }
+  }
+}
+
+/**********************************************************************//**
+  Worker function of one smoothing thread: every SMOOTH_MAP_THREADS'th
+  row, starting at the thread's offset. Each worker reads source_map
+  and writes its own rows of target_map, so the pass is a pure
+  function of its input and needs no further coordination.
+**************************************************************************/
+static void smooth_map_thread_run(void *arg)
+{
+  struct smooth_map_thread *self = arg;
+  int y;
+
+  for (y = self->offset; y < MAP_NATIVE_HEIGHT; y += self->stride) {
+    if (self->axe) {
+      smooth_map_row_x(self->target_map + y * MAP_NATIVE_WIDTH,
+                       self->source_map + y * MAP_NATIVE_WIDTH,
+                       self->weight, self->zeroes_at_edges, self->wrap);
+    } else {
+      smooth_map_row_y(self->target_map + y * MAP_NATIVE_WIDTH,
+                       self->source_map, y, self->weight,
+                       self->zeroes_at_edges, self->wrap);
+    }
+  }
+}
+
 /**********************************************************************//**
   Apply a Gaussian diffusion filter on the map. The size of the map is
   MAP_INDEX_SIZE and the map is indexed by native_pos_to_index function.
   If zeroes_at_edges is set, any unreal position on diffusion has 0 value
   if zeroes_at_edges in unset the unreal position are not counted.
+
+  The kernel is separable, so the filter runs as one horizontal and one
+  vertical sweep of row-contiguous passes over the int array rather
+  than tile-by-tile axis iteration.
 **************************************************************************/
 void smooth_int_map(int *int_map, bool zeroes_at_edges)
 {
@@ -204,18 +358,41 @@ void smooth_int_map(int *int_map, bool zeroes_at_edges)
   source_map = int_map;
 
   do {
-    whole_map_iterate(&(wld.map), ptile) {
-      float N = 0, D = 0;
-
-      axis_iterate(&(wld.map), ptile, pnear, i, 2, axe) {
-        D += weight[i + 2];
-        N += weight[i + 2] * source_map[tile_index(pnear)];
-      } axis_iterate_end;
-      if (zeroes_at_edges) {
-        D = 1;
+    bool wrap = axe ? current_wrap_has_flag(WRAP_X)
+                    : current_wrap_has_flag(WRAP_Y);
+
+    if (MAP_INDEX_SIZE >= SMOOTH_MAP_MIN_TILES) {
+      struct smooth_map_thread threads[SMOOTH_MAP_THREADS];
+      int t;
+
+      for (t = 0; t < SMOOTH_MAP_THREADS; t++) {
+        threads[t].weight = weight;
+        threads[t].source_map = source_map;
+        threads[t].target_map = target_map;
+        threads[t].axe = axe;
+        threads[t].zeroes_at_edges = zeroes_at_edges;
+        threads[t].wrap = wrap;
+        threads[t].stride = SMOOTH_MAP_THREADS;
+        threads[t].offset = t;
+        fc_thread_start(&threads[t].thread, smooth_map_thread_run,
+                        &threads[t]);
       }
-      target_map[tile_index(ptile)] = (float)N / D;
-    } whole_map_iterate_end;
+      for (t = 0; t < SMOOTH_MAP_THREADS; t++) {
+        fc_thread_wait(&threads[t].thread);
+      }
+    } else {
+      struct smooth_map_thread job;
+
+      job.weight = weight;
+      job.source_map = source_map;
+      job.target_map = target_map;
+      job.axe = axe;
+      job.zeroes_at_edges = zeroes_at_edges;
+      job.wrap = wrap;
+      job.stride = 1;
+      job.offset = 0;
+      smooth_map_thread_run(&job);
+    }
 
     if (MAP_IS_ISOMETRIC) {
       weight = weight_isometric;
@@ -20,6 +20,7 @@
 /* utility */
 #include "log.h"
 #include "fcintl.h"
+#include "rand.h"
 
 /* common */
 #include "game.h"
@@ -123,6 +124,23 @@ struct start_filter_data {
   int *value;
 };
 
+/* Start position candidates, precomputed once before the placement loop.
+ * Tiles that can never host a start position (wrong terrain, huts, polar
+ * zone, ...) are filtered out up front; the remainder is grouped by
+ * continent and kept in descending tile-value order, so that for any
+ * threshold the eligible candidates of a continent form a prefix of its
+ * group that a binary search can measure without touching the map. */
+struct startpos_candidates {
+  int *tiles;      /* Candidate tile indices, grouped by continent. */
+  int *offset;     /* offset[cont] .. offset[cont + 1] delimits continent
+                    * cont's group; indexed 0 .. num_continents + 1. */
+};
+
+/* States of the memoized check_native_area() results. */
+#define NATIVE_AREA_UNKNOWN   0
+#define NATIVE_AREA_OK        1
+#define NATIVE_AREA_TOO_SMALL 2
+
 /************************************************************************//**
   Check if number of reachable native tiles is sufficient.
   Initially given tile is assumed to be native (not checked by this function)
@@ -175,28 +193,24 @@ static bool check_native_area(const struct unit_type *utype,
 }
 
 /************************************************************************//**
-  Return TRUE if tile is a good starting position.
+  Return TRUE if the tile passes the placement-independent start position
+  checks. These only depend on the map itself, so they are evaluated once
+  per tile when the candidate lists are built.
 
   Bad places:
-  - Islands with no room.
   - Non-suitable terrain;
   - On a hut;
-  - Too close to another starter on the same continent:
-    'dist' is too close (real_map_distance)
+  - Too close to a pole.
 ****************************************************************************/
-static bool is_valid_start_pos(const struct tile *ptile, const void *dataptr)
+static bool is_startpos_candidate(const struct tile *ptile, const int *value,
+                                  const struct unit_type *initial_unit)
 {
-  const struct start_filter_data *pdata = dataptr;
-  struct islands_data_type *island;
-  int cont_size, cont = tile_continent(ptile);
-
   /* Only start on certain terrain types. */
-  if (pdata->value[tile_index(ptile)] < pdata->min_value) {
+  if (value[tile_index(ptile)] <= 0) {
     return FALSE;
   }
 
-  fc_assert_ret_val(cont > 0, FALSE);
-  if (islands[islands_index[cont]].starters == 0) {
+  if (tile_continent(ptile) <= 0) {
     return FALSE;
   }
 
@@ -207,13 +221,7 @@ static bool is_valid_start_pos(const struct tile *ptile, const void *dataptr)
   }
 
   /* Has to be native tile for initial unit */
-  if (!is_native_tile(pdata->initial_unit, ptile)) {
-    return FALSE;
-  }
-
-  /* Check native area size. */
-  if (!check_native_area(pdata->initial_unit, ptile,
-                         terrain_control.min_start_native_area)) {
+  if (!is_native_tile(initial_unit, ptile)) {
     return FALSE;
   }
 
@@ -229,6 +237,142 @@ static bool is_valid_start_pos(const struct tile *ptile, const void *dataptr)
     return FALSE;
   }
 
+  return TRUE;
+}
+
+/* Candidate sort key; set only while the qsort() calls in
+ * create_startpos_candidates() run. */
+static const int *cand_sort_value;
+
+/************************************************************************//**
+  Helper function for qsort. Orders candidate tile indices by descending
+  tile value, ties by index so the order is reproducible.
+****************************************************************************/
+static int compare_candidate_tiles(const void *A_, const void *B_)
+{
+  const int *A = A_, *B = B_;
+
+  if (cand_sort_value[*A] != cand_sort_value[*B]) {
+    return cand_sort_value[*B] - cand_sort_value[*A];
+  }
+
+  return *A - *B;
+}
+
+/************************************************************************//**
+  Build the per-continent candidate lists from the tile value array.
+****************************************************************************/
+static struct startpos_candidates *
+create_startpos_candidates(const int *value,
+                           const struct unit_type *initial_unit)
+{
+  struct startpos_candidates *cand = fc_malloc(sizeof(*cand));
+  int ncont = wld.map.num_continents;
+  int *fill = fc_malloc((ncont + 1) * sizeof(*fill));
+  int cont;
+
+  cand->offset = fc_calloc(ncont + 2, sizeof(*cand->offset));
+
+  /* Count candidates per continent... */
+  whole_map_iterate(&(wld.map), ptile) {
+    if (is_startpos_candidate(ptile, value, initial_unit)) {
+      cand->offset[tile_continent(ptile) + 1]++;
+    }
+  } whole_map_iterate_end;
+
+  /* ...turn the counts into group offsets... */
+  for (cont = 1; cont <= ncont; cont++) {
+    cand->offset[cont + 1] += cand->offset[cont];
+    fill[cont] = cand->offset[cont];
+  }
+
+  cand->tiles = fc_malloc(MAX(1, cand->offset[ncont + 1])
+                          * sizeof(*cand->tiles));
+
+  /* ...and fill and sort the groups. */
+  whole_map_iterate(&(wld.map), ptile) {
+    if (is_startpos_candidate(ptile, value, initial_unit)) {
+      cand->tiles[fill[tile_continent(ptile)]++] = tile_index(ptile);
+    }
+  } whole_map_iterate_end;
+
+  cand_sort_value = value;
+  for (cont = 1; cont <= ncont; cont++) {
+    qsort(cand->tiles + cand->offset[cont],
+          cand->offset[cont + 1] - cand->offset[cont],
+          sizeof(*cand->tiles), compare_candidate_tiles);
+  }
+  cand_sort_value = NULL;
+
+  free(fill);
+
+  return cand;
+}
+
+/************************************************************************//**
+  Free a candidate structure created by create_startpos_candidates().
+****************************************************************************/
+static void destroy_startpos_candidates(struct startpos_candidates *cand)
+{
+  free(cand->tiles);
+  free(cand->offset);
+  free(cand);
+}
+
+/************************************************************************//**
+  Return how many of the continent's candidates have at least the given
+  tile value. They form a prefix of the continent's descending-order
+  group, so a binary search for the first entry below the threshold
+  measures it.
+****************************************************************************/
+static int candidates_above(const struct startpos_candidates *cand,
+                            const int *value, int cont, int min_value)
+{
+  int lo = cand->offset[cont], hi = cand->offset[cont + 1];
+
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+
+    if (value[cand->tiles[mid]] >= min_value) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo - cand->offset[cont];
+}
+
+/************************************************************************//**
+  Return TRUE if the candidate tile is still a good starting position
+  given what has been placed so far.
+
+  Bad places:
+  - Islands with no room (checked by the caller via the eligible counts);
+  - Too close to another starter on the same continent:
+    'dist' is too close (real_map_distance)
+****************************************************************************/
+static bool is_valid_candidate(const struct tile *ptile,
+                               const struct start_filter_data *pdata,
+                               char *native_area_cache)
+{
+  struct islands_data_type *island;
+  int cont_size, cont = tile_continent(ptile);
+  int tindex = tile_index(ptile);
+
+  /* Check native area size. The reachable-area test depends only on the
+   * map and the initial unit, never on what has been placed so far, so
+   * its result is memoized across the whole placement loop. */
+  if (native_area_cache[tindex] == NATIVE_AREA_UNKNOWN) {
+    native_area_cache[tindex]
+      = (check_native_area(pdata->initial_unit, ptile,
+                           terrain_control.min_start_native_area)
+         ? NATIVE_AREA_OK : NATIVE_AREA_TOO_SMALL);
+  }
+  if (native_area_cache[tindex] == NATIVE_AREA_TOO_SMALL) {
+    return FALSE;
+  }
+
   /* Don't start too close to someone else. */
   cont_size = get_continent_size(cont);
   island = islands + islands_index[cont];
@@ -246,6 +390,86 @@ static bool is_valid_start_pos(const struct tile *ptile, const void *dataptr)
   return TRUE;
 }
 
+/************************************************************************//**
+  Find a random start position among the candidates whose value reaches
+  the current threshold, on continents that still have starters to place.
+  Returns NULL if no such position exists, without touching the map: the
+  eligible counts come straight from the precomputed groups, so a failed
+  threshold costs a binary search per continent rather than a map scan.
+****************************************************************************/
+static struct tile *search_start_pos(const struct startpos_candidates *cand,
+                                     const struct start_filter_data *pdata,
+                                     char *native_area_cache)
+{
+  int ncont = wld.map.num_continents;
+  int *eligible = fc_malloc((ncont + 1) * sizeof(*eligible));
+  int cont, total = 0, tries;
+  struct tile *found = NULL;
+
+  for (cont = 1; cont <= ncont; cont++) {
+    if (islands[islands_index[cont]].starters > 0) {
+      eligible[cont] = candidates_above(cand, pdata->value, cont,
+                                        pdata->min_value);
+    } else {
+      eligible[cont] = 0;
+    }
+    total += eligible[cont];
+  }
+
+  if (total == 0) {
+    free(eligible);
+    return NULL;
+  }
+
+  /* First do a few quick random draws; they nearly always hit since only
+   * the distance checks can still reject an eligible candidate. */
+  for (tries = 0; tries < 25 && found == NULL; tries++) {
+    int pick = fc_rand(total);
+
+    for (cont = 1; cont <= ncont; cont++) {
+      if (pick < eligible[cont]) {
+        struct tile *ptile
+          = index_to_tile(&(wld.map), cand->tiles[cand->offset[cont] + pick]);
+
+        if (is_valid_candidate(ptile, pdata, native_area_cache)) {
+          found = ptile;
+        }
+        break;
+      }
+      pick -= eligible[cont];
+    }
+  }
+
+  if (found == NULL) {
+    /* If that fails, collect all eligible candidates that pass and pick
+     * one. Slow but reliable. */
+    int *positions = fc_malloc(total * sizeof(*positions));
+    int count = 0, n;
+
+    for (cont = 1; cont <= ncont; cont++) {
+      for (n = 0; n < eligible[cont]; n++) {
+        int tindex = cand->tiles[cand->offset[cont] + n];
+
+        if (is_valid_candidate(index_to_tile(&(wld.map), tindex), pdata,
+                               native_area_cache)) {
+          positions[count] = tindex;
+          count++;
+        }
+      }
+    }
+
+    if (count > 0) {
+      found = index_to_tile(&(wld.map), positions[fc_rand(count)]);
+    }
+
+    free(positions);
+  }
+
+  free(eligible);
+
+  return found;
+}
+
 /************************************************************************//**
   Helper function for qsort
 ****************************************************************************/
@@ -303,6 +527,8 @@ bool create_start_positions(enum map_startpos mode,
   struct tile *ptile;
   int k, sum;
   struct start_filter_data data;
+  struct startpos_candidates *candidates;
+  char *native_area_cache;
   int *tile_value_aux = NULL;
   int *tile_value = NULL;
   int min_goodies_per_player = 1500;
@@ -484,10 +710,12 @@ bool create_start_positions(enum map_startpos mode,
   }
   fc_assert_ret_val(player_count() <= sum, FALSE);
 
+  candidates = create_startpos_candidates(tile_value, initial_unit);
+  native_area_cache = fc_calloc(MAP_INDEX_SIZE, sizeof(*native_area_cache));
+
   /* now search for the best place and set start_positions */
   while (map_startpos_count() < player_count()) {
-    if ((ptile = rand_map_pos_filtered(&(wld.map), &data,
-                                       is_valid_start_pos))) {
+    if ((ptile = search_start_pos(candidates, &data, native_area_cache))) {
       islands[islands_index[(int) tile_continent(ptile)]].starters--;
       log_debug("Adding (%d, %d) as starting position %d, %d goodies on "
                 "islands.", TILE_XY(ptile), map_startpos_count(),
@@ -505,6 +733,9 @@ bool create_start_positions(enum map_startpos mode,
     }
   }
 
+  destroy_startpos_candidates(candidates);
+  FC_FREE(native_area_cache);
+
   free(islands);
   free(islands_index);
   islands = NULL;
@@ -30,6 +30,13 @@
 
 static int *temperature_map;
 
+/* Second half of the climate arena: per-tile wetness input for the
+ * terrain passes, filled by the same sweep over the height map that
+ * computes the temperatures, so the colatitude and ocean proximity of
+ * every tile are only evaluated once. A dummy tmap does not carry it -
+ * the terrain classes it derives from are not in place yet. */
+static int *dryness_map;
+
 #define tmap(_tile) (temperature_map[tile_index(_tile)])
 
 /**********************************************************************//**
@@ -87,6 +94,27 @@ bool tmap_is(const struct tile *ptile, temperature_type tt)
   return BOOL_VAL(tmap(ptile) & (tt));
 }
 
+/**********************************************************************//**
+  Return TRUE if the climate arena carries the per-tile dryness input,
+  i.e. the tmap is a real one.
+**************************************************************************/
+bool tmap_has_dryness(void)
+{
+  return dryness_map != NULL;
+}
+
+/**********************************************************************//**
+  Return TRUE if the tile is in the desert-supporting latitude band and
+  far enough from the ocean, as cached when the real tmap was made.
+  Only valid once tmap_has_dryness() returns TRUE.
+**************************************************************************/
+bool tmap_is_dry(const struct tile *ptile)
+{
+  fc_assert_ret_val(dryness_map != NULL, FALSE);
+
+  return BOOL_VAL(dryness_map[tile_index(ptile)]);
+}
+
 /**********************************************************************//**
   Return true if at least one tile has tt temperature type
 **************************************************************************/
@@ -109,6 +137,7 @@ void destroy_tmap(void)
   fc_assert_ret(NULL != temperature_map);
   free(temperature_map);
   temperature_map = NULL;
+  dryness_map = NULL;
 }
 
 /**********************************************************************//**
@@ -125,7 +154,12 @@ void create_tmap(bool real)
   /* to debug, never load at this time */
   fc_assert_ret(NULL == temperature_map);
 
-  temperature_map = fc_malloc(sizeof(*temperature_map) * MAP_INDEX_SIZE);
+  /* A real tmap shares its arena with the dryness cache; both are
+   * filled by the single sweep below. */
+  temperature_map = fc_malloc(sizeof(*temperature_map) * MAP_INDEX_SIZE
+                              * (real ? 2 : 1));
+  dryness_map = real ? temperature_map + MAP_INDEX_SIZE : NULL;
+
   whole_map_iterate(&(wld.map), ptile) {
     /* The base temperature is equal to base map_colatitude */
     int t = map_colatitude(ptile);
@@ -144,6 +178,14 @@ void create_tmap(bool real)
                          / 100);
 
       tmap(ptile) =  t * (1.0 + temperate) * (1.0 + height);
+
+      /* Reuse the colatitude and ocean proximity just computed for the
+       * desert condition the terrain passes keep asking about. The
+       * land made at the poles after this sweep cannot reach the
+       * neighbourhood of the mid-latitude band tested here. */
+      dryness_map[tile_index(ptile)] = (t <= DRY_MAX_LEVEL
+                                        && t > DRY_MIN_LEVEL
+                                        && tcn <= 35);
     }
   } whole_map_iterate_end;
 
@@ -35,6 +35,8 @@ typedef int temperature_type;
 
 bool temperature_is_initialized(void);
 bool tmap_is(const struct tile *ptile, temperature_type tt);
+bool tmap_has_dryness(void);
+bool tmap_is_dry(const struct tile *ptile);
 bool is_temperature_type_near(const struct tile *ptile, temperature_type tt);
 void destroy_tmap(void);
 void create_tmap(bool real);
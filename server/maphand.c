@@ -24,12 +24,14 @@
 #include "support.h"
 
 /* common */
+#include "accessarea.h"
 #include "ai.h"
 #include "base.h"
 #include "borders.h"
 #include "events.h"
 #include "game.h"
 #include "map.h"
+#include "mapimg.h"
 #include "movement.h"
 #include "nation.h"
 #include "packets.h"
@@ -40,12 +42,18 @@
 #include "unitlist.h"
 #include "vision.h"
 
+/* common/aicore */
+#include "path_finding.h"
+#include "pf_alt.h"
+#include "pf_hier.h"
+
 /* server */
 #include "citytools.h"
 #include "cityturn.h"
 #include "notify.h"
 #include "plrhand.h"
 #include "sanitycheck.h"
+#include "score.h"
 #include "sernet.h"
 #include "srv_main.h"
 #include "unithand.h"
@@ -53,10 +61,15 @@
 
 /* server/advisors */
 #include "advdata.h"
+#include "autoexplorer.h"
+#include "infracache.h"
 
 /* server/generator */
 #include "mapgen_utils.h"
 
+/* server/savegame */
+#include "savemain.h"
+
 #include "maphand.h"
 
 /* Suppress send_tile_info() during game_load() */
@@ -87,6 +100,7 @@ static inline bool map_is_also_seen(const struct tile *ptile,
 
 static bool is_tile_claimable(struct tile *ptile, struct tile *source,
                               struct player *pplayer);
+static void border_claims_invalidate_tile(struct tile *ptile);
 
 /**********************************************************************//**
   Used only in global_warming() and nuclear_winter() below.
@@ -130,25 +144,42 @@ void nuclear_winter(int effect)
 **************************************************************************/
 void climate_change(bool warming, int effect)
 {
-  int k = map_num_tiles();
-  bool used[k];
+  struct tile **transformable;
+  int count = 0;
   const struct civ_map *nmap = &(wld.map);
 
-  memset(used, 0, sizeof(used));
-
   log_verbose("Climate change: %s (%d)",
               warming ? "Global warming" : "Nuclear winter", effect);
 
-  while (effect > 0 && (k--) > 0) {
+  /* Index the tiles whose terrain defines a result for this change at
+   * all. Drawing random map positions instead would burn up to one
+   * draw per map tile rejecting terrain that can never transform,
+   * while the old tile-sized "used" array no longer fits the stack
+   * comfortably on large maps. Drawing without replacement from this
+   * index visits the same tiles in the same distribution as the old
+   * whole-map rejection sampling did. */
+  transformable = fc_malloc(MAP_INDEX_SIZE * sizeof(*transformable));
+  whole_map_iterate(nmap, itile) {
+    struct terrain *pterr = tile_terrain(itile);
+
+    if ((warming ? pterr->warmer_wetter_result
+                 : pterr->cooler_wetter_result) != T_NONE
+        || (warming ? pterr->warmer_drier_result
+                    : pterr->cooler_drier_result) != T_NONE) {
+      transformable[count++] = itile;
+    }
+  } whole_map_iterate_end;
+
+  while (effect > 0 && count > 0) {
     struct terrain *old, *candidates[2], *new;
     struct tile *ptile;
+    int pick;
     int i;
 
-    do {
-      /* We want to transform a tile at most once due to a climate change. */
-      ptile = rand_map_pos(&(wld.map));
-    } while (used[tile_index(ptile)]);
-    used[tile_index(ptile)] = TRUE;
+    /* We want to transform a tile at most once due to a climate change. */
+    pick = fc_rand(count);
+    ptile = transformable[pick];
+    transformable[pick] = transformable[--count];
 
     old = tile_terrain(ptile);
     /* Prefer the transformation that's appropriate to the ambient moisture,
@@ -230,6 +261,8 @@ void climate_change(bool warming, int effect)
       effect--;
     }
   }
+
+  free(transformable);
 }
 
 /**********************************************************************//**
@@ -430,10 +463,103 @@ void give_citymap_from_player_to_player(struct city *pcity,
   sync_cities();
 }
 
+/**********************************************************************//**
+  Fill slot 'idx' of a bulk tile info packet with pplayer's view of
+  ptile, exactly as send_tile_info() would describe it. Returns FALSE
+  if the tile is not known to the player at all, i.e. would not have
+  been sent; the slot is then left untouched.
+**************************************************************************/
+static bool fill_bulk_tile_info(struct packet_tile_info_bulk *info, int idx,
+                                struct tile *ptile, struct player *pplayer)
+{
+  const struct player *owner;
+  const struct player *eowner;
+  bool known = FALSE;
+
+  if (pplayer != NULL) {
+    known = map_is_known(ptile, pplayer);
+  }
+
+  if (pplayer == NULL || (known && map_is_also_seen(ptile, pplayer, V_MAIN))) {
+    struct extra_type *resource;
+
+    info->known[idx] = TILE_KNOWN_SEEN;
+    info->continent[idx] = tile_continent(ptile);
+    owner = tile_owner(ptile);
+    eowner = extra_owner(ptile);
+    info->owner[idx] = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
+    info->extras_owner[idx]
+      = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
+    info->worked[idx] = (NULL != tile_worked(ptile))
+                        ? tile_worked(ptile)->id
+                        : IDENTITY_NUMBER_ZERO;
+
+    info->terrain[idx] = (NULL != tile_terrain(ptile))
+                         ? terrain_number(tile_terrain(ptile))
+                         : terrain_count();
+
+    resource = tile_resource(ptile);
+    if (resource != NULL
+        && (pplayer == NULL
+            || player_knows_extra_exist(pplayer, resource, ptile))) {
+      info->resource[idx] = extra_number(resource);
+    } else {
+      info->resource[idx] = MAX_EXTRA_TYPES;
+    }
+
+    if (pplayer != NULL) {
+      dbv_to_bv(info->extras[idx].vec,
+                &(map_get_player_tile(ptile, pplayer)->extras));
+    } else {
+      info->extras[idx] = ptile->extras;
+    }
+
+    info->altitude[idx] = ptile->altitude;
+
+    return TRUE;
+  } else if (known) {
+    struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+    struct vision_site *psite = map_get_playermap_site(plrtile);
+
+    info->known[idx] = TILE_KNOWN_UNSEEN;
+    info->continent[idx] = tile_continent(ptile);
+    owner = (game.server.foggedborders
+             ? plrtile->owner
+             : tile_owner(ptile));
+    eowner = plrtile->extras_owner;
+    info->owner[idx] = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
+    info->extras_owner[idx]
+      = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
+    info->worked[idx] = (NULL != psite)
+                        ? psite->identity
+                        : IDENTITY_NUMBER_ZERO;
+
+    info->terrain[idx] = (NULL != plrtile->terrain)
+                         ? terrain_number(plrtile->terrain)
+                         : terrain_count();
+    info->resource[idx] = (NULL != plrtile->resource)
+                          ? extra_number(plrtile->resource)
+                          : MAX_EXTRA_TYPES;
+
+    dbv_to_bv(info->extras[idx].vec, &(plrtile->extras));
+
+    info->altitude[idx] = ptile->altitude;
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
 /**********************************************************************//**
   Send all tiles known to specified clients.
   If dest is NULL means game.est_connections.
 
+  Tiles are sent as runs of consecutive tile indexes packed into
+  PACKET_TILE_INFO_BULK, to avoid paying the per packet overhead for
+  every single tile of the map. Tiles that need fields the bulk packet
+  does not carry fall back to plain send_tile_info().
+
   Note for multiple connections this may change "sent" multiple times
   for single player.  This is ok, because "sent" data is just optimised
   calculations, so it will be correct before this, for each connection
@@ -441,29 +567,77 @@ void give_citymap_from_player_to_player(struct city *pcity,
 **************************************************************************/
 void send_all_known_tiles(struct conn_list *dest)
 {
-  int tiles_sent;
+  if (send_tile_suppressed) {
+    return;
+  }
 
   if (!dest) {
     dest = game.est_connections;
   }
 
-  /* Send whole map piece by piece to each player to balance the load
-     of the send buffers better */
-  tiles_sent = 0;
-  conn_list_do_buffer(dest);
+  conn_list_iterate(dest, pconn) {
+    struct player *pplayer = pconn->playing;
+    struct packet_tile_info_bulk info;
+    int tiles_sent = 0;
 
-  whole_map_iterate(&(wld.map), ptile) {
-    tiles_sent++;
-    if ((tiles_sent % MAP_NATIVE_WIDTH) == 0) {
-      conn_list_do_unbuffer(dest);
-      flush_packets();
-      conn_list_do_buffer(dest);
+    if (NULL == pplayer && !pconn->observer) {
+      continue;
     }
 
-    send_tile_info(dest, ptile, FALSE);
-  } whole_map_iterate_end;
+    /* Send whole map piece by piece to each player to balance the load
+       of the send buffers better */
+    connection_do_buffer(pconn);
+    info.count = 0;
+
+    whole_map_iterate(&(wld.map), ptile) {
+      tiles_sent++;
+      if ((tiles_sent % MAP_NATIVE_WIDTH) == 0) {
+        if (info.count > 0) {
+          send_packet_tile_info_bulk(pconn, &info);
+          info.count = 0;
+        }
+        connection_do_unbuffer(pconn);
+        flush_packets();
+        connection_do_buffer(pconn);
+      }
+
+      if (ptile->spec_sprite != NULL || ptile->label != NULL
+          || ptile->placing != NULL) {
+        /* Needs fields the bulk packet leaves out. */
+        if (info.count > 0) {
+          send_packet_tile_info_bulk(pconn, &info);
+          info.count = 0;
+        }
+        send_tile_info(pconn->self, ptile, FALSE);
+        continue;
+      }
+
+      if (!fill_bulk_tile_info(&info, info.count, ptile, pplayer)) {
+        /* Unknown tiles are not sent; the run ends here. */
+        if (info.count > 0) {
+          send_packet_tile_info_bulk(pconn, &info);
+          info.count = 0;
+        }
+        continue;
+      }
+
+      if (info.count == 0) {
+        info.first_tile = tile_index(ptile);
+      }
+      info.count++;
+
+      if (info.count == MAX_TILE_INFO_BULK) {
+        send_packet_tile_info_bulk(pconn, &info);
+        info.count = 0;
+      }
+    } whole_map_iterate_end;
+
+    if (info.count > 0) {
+      send_packet_tile_info_bulk(pconn, &info);
+    }
+    connection_do_unbuffer(pconn);
+  } conn_list_iterate_end;
 
-  conn_list_do_unbuffer(dest);
   flush_packets();
 }
 
@@ -478,6 +652,79 @@ bool send_tile_suppression(bool now)
   return formerly;
 }
 
+/* Batch nesting depth of tile_info_batch_start(); while positive,
+ * send_tile_info() only marks the tile in the recipients' dirty sets
+ * and the outermost flush sends each dirty tile once, with the then
+ * current state. Tiles any call wanted sent as unknown are collected
+ * here; the over-approximation only re-sends an unknown tile to
+ * clients that already hold it as unknown. */
+static int tile_info_batch_depth = 0;
+static struct dbv tile_info_dirty_unknown;
+
+/**********************************************************************//**
+  Make sure 'pdbv' spans the current map and is ready for use.
+**************************************************************************/
+static void tile_info_dirty_prepare(struct dbv *pdbv)
+{
+  if (pdbv->vec == NULL) {
+    dbv_init(pdbv, MAP_INDEX_SIZE);
+  } else if (dbv_bits(pdbv) != MAP_INDEX_SIZE) {
+    dbv_resize(pdbv, MAP_INDEX_SIZE);
+  }
+}
+
+/**********************************************************************//**
+  Until the matching tile_info_batch_flush(), coalesce repeated
+  send_tile_info() calls into one send per tile and recipient. Used
+  around the processing of a player's packet and around end_phase(),
+  where moving a stack re-sends largely overlapping tile sets once per
+  unit. Batches nest; only the outermost flush sends.
+**************************************************************************/
+void tile_info_batch_start(void)
+{
+  if (tile_info_batch_depth++ == 0) {
+    tile_info_dirty_prepare(&tile_info_dirty_unknown);
+  }
+}
+
+/**********************************************************************//**
+  Send the coalesced tile info and leave batching mode.
+**************************************************************************/
+void tile_info_batch_flush(void)
+{
+  fc_assert_ret(tile_info_batch_depth > 0);
+
+  if (--tile_info_batch_depth > 0) {
+    return;
+  }
+
+  conn_list_iterate(game.est_connections, pconn) {
+    struct dbv *dirty = &pconn->server.tile_info_dirty;
+    int left = pconn->server.tile_info_dirty_count;
+    int i;
+
+    if (left <= 0 || dirty->vec == NULL
+        || dbv_bits(dirty) != MAP_INDEX_SIZE) {
+      continue;
+    }
+
+    conn_list_do_buffer(pconn->self);
+    for (i = 0; i < MAP_INDEX_SIZE && left > 0; i++) {
+      if (dbv_isset(dirty, i)) {
+        send_tile_info(pconn->self, index_to_tile(&(wld.map), i),
+                       dbv_isset(&tile_info_dirty_unknown, i));
+        left--;
+      }
+    }
+    conn_list_do_unbuffer(pconn->self);
+
+    dbv_clr_all(dirty);
+    pconn->server.tile_info_dirty_count = 0;
+  } conn_list_iterate_end;
+
+  dbv_clr_all(&tile_info_dirty_unknown);
+}
+
 /**********************************************************************//**
   Send tile information to all the clients in dest which know and see
   the tile. If dest is NULL, sends to all clients (game.est_connections)
@@ -497,7 +744,11 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
     CALL_FUNC_EACH_AI(tile_info, ptile);
   }
 
-  if (send_tile_suppressed) {
+  /* Tile changes flushed to the clients also dirty the per-turn map
+   * images; mark even while sending is suppressed. */
+  mapimg_tile_dirty(ptile);
+
+  if (send_tile_suppressed || server_is_headless()) {
     return;
   }
 
@@ -505,6 +756,26 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
     dest = game.est_connections;
   }
 
+  if (tile_info_batch_depth > 0) {
+    /* Just mark dirty; tile_info_batch_flush() sends once, with the
+     * tile state current at that point. */
+    if (send_unknown) {
+      dbv_set(&tile_info_dirty_unknown, tile_index(ptile));
+    }
+    conn_list_iterate(dest, pconn) {
+      if (pconn->playing == NULL && !pconn->observer) {
+        continue;
+      }
+      tile_info_dirty_prepare(&pconn->server.tile_info_dirty);
+      if (!dbv_isset(&pconn->server.tile_info_dirty, tile_index(ptile))) {
+        dbv_set(&pconn->server.tile_info_dirty, tile_index(ptile));
+        pconn->server.tile_info_dirty_count++;
+      }
+    } conn_list_iterate_end;
+
+    return;
+  }
+
   info.tile = tile_index(ptile);
 
   if (ptile->spec_sprite) {
@@ -790,6 +1061,14 @@ void map_show_tile(struct player *src_player, struct tile *ptile)
 	update_player_tile_knowledge(pplayer, ptile);
 	update_player_tile_last_seen(pplayer, ptile);
 
+        /* The known vector lives in the [map] savegame section. */
+        deltasave_dirty_map();
+        deltasave_dirty_player(pplayer);
+
+        /* A freshly learned tile may now be claimable by a border
+         * source whose parameters have not changed. */
+        border_claims_invalidate_tile(ptile);
+
         send_tile_info(pplayer->connections, ptile, FALSE);
 
 	/* Remove old cities that exist no more */
@@ -1156,6 +1435,14 @@ static void map_change_own_seen(struct player *pplayer,
   vision_layer_iterate(v) {
     plrtile->own_seen[v] += change[v];
   } vision_layer_iterate_end;
+
+  if (plrtile->own_seen[V_MAIN] != 0
+      || plrtile->own_seen[V_INVIS] != 0
+      || plrtile->own_seen[V_SUBSURFACE] != 0) {
+    dbv_set(&pplayer->server.own_seen_tiles, tile_index(ptile));
+  } else {
+    dbv_clr(&pplayer->server.own_seen_tiles, tile_index(ptile));
+  }
 }
 
 /**********************************************************************//**
@@ -1182,7 +1469,10 @@ void change_playertile_site(struct player_tile *ptile,
 **************************************************************************/
 void map_set_known(struct tile *ptile, struct player *pplayer)
 {
-  dbv_set(&pplayer->tile_known, tile_index(ptile));
+  if (!dbv_isset(&pplayer->tile_known, tile_index(ptile))) {
+    dbv_set(&pplayer->tile_known, tile_index(ptile));
+    explorer_frontier_tile_known(pplayer, ptile);
+  }
 }
 
 /**********************************************************************//**
@@ -1191,6 +1481,8 @@ void map_set_known(struct tile *ptile, struct player *pplayer)
 void map_clear_known(struct tile *ptile, struct player *pplayer)
 {
   dbv_clr(&pplayer->tile_known, tile_index(ptile));
+  /* Tiles becoming unknown again is rare; just rebuild the frontier. */
+  explorer_frontier_invalidate(pplayer);
 }
 
 /**********************************************************************//**
@@ -1234,6 +1526,12 @@ void player_map_init(struct player *pplayer)
   } whole_map_iterate_end;
 
   dbv_init(&pplayer->tile_known, MAP_INDEX_SIZE);
+
+  dbv_init(&pplayer->server.own_seen_tiles, MAP_INDEX_SIZE);
+  if (!game.server.fogofwar_old) {
+    /* player_tile_init() gave every tile one point of own sight. */
+    dbv_set_all(&pplayer->server.own_seen_tiles);
+  }
 }
 
 /**********************************************************************//**
@@ -1253,6 +1551,7 @@ void player_map_free(struct player *pplayer)
   pplayer->server.private_map = NULL;
 
   dbv_free(&pplayer->tile_known);
+  dbv_free(&pplayer->server.own_seen_tiles);
 }
 
 /**********************************************************************//**
@@ -1310,6 +1609,7 @@ void remove_player_from_maps(struct player *pplayer)
 
     /* Free all claimed tiles. */
     if (tile_owner(ptile) == pplayer) {
+      score_counter_tile_owner(pplayer, NULL);
       tile_set_owner(ptile, NULL, NULL);
       reality_changed = TRUE;
     }
@@ -1447,10 +1747,13 @@ void update_tile_knowledge(struct tile *ptile)
     return;
   }
 
+  deltasave_dirty_map();
+
   /* Players */
   players_iterate(pplayer) {
     if (map_is_known_and_seen(ptile, pplayer, V_MAIN)) {
       if (update_player_tile_knowledge(pplayer, ptile)) {
+        deltasave_dirty_player(pplayer);
         send_tile_info(pplayer->connections, ptile, FALSE);
       }
     }
@@ -1617,14 +1920,18 @@ static void create_vision_dependencies(void)
       players_iterate(pplayer2) {
         if (really_gives_vision(pplayer, pplayer2)
             && pplayer != pplayer2) {
-          players_iterate(pplayer3) {
-            if (really_gives_vision(pplayer2, pplayer3)
-                && !really_gives_vision(pplayer, pplayer3)
-                && pplayer != pplayer3) {
-              BV_SET(pplayer->server.really_gives_vision, player_index(pplayer3));
-              added++;
-            }
-          } players_iterate_end;
+          /* Union pplayer2's receivers into pplayer's, a word at a
+           * time. A player never gives vision to themselves, so mask
+           * the own bit back off before comparing. */
+          bv_player prev = pplayer->server.really_gives_vision;
+
+          BV_SET_ALL_FROM(pplayer->server.really_gives_vision,
+                          pplayer2->server.really_gives_vision);
+          BV_CLR(pplayer->server.really_gives_vision,
+                 player_index(pplayer));
+          if (!BV_ARE_EQUAL(prev, pplayer->server.really_gives_vision)) {
+            added++;
+          }
         }
       } players_iterate_end;
     } players_iterate_end;
@@ -1664,9 +1971,17 @@ void give_shared_vision(struct player *pfrom, struct player *pto)
       if (really_gives_vision(pplayer, pplayer2)
           && !BV_ISSET(save_vision[player_index(pplayer)],
                        player_index(pplayer2))) {
+        const struct dbv *own_tiles = &pplayer->server.own_seen_tiles;
+        int tindex;
+
         log_debug("really giving shared vision from %s to %s",
                   player_name(pplayer), player_name(pplayer2));
-        whole_map_iterate(&(wld.map), ptile) {
+        /* Only tiles pplayer sees with their own vision can contribute
+         * seen count to pplayer2, so walk just those instead of the
+         * whole map. */
+        for (tindex = dbv_first_set(own_tiles); tindex != -1;
+             tindex = dbv_next_set(own_tiles, tindex)) {
+          struct tile *ptile = index_to_tile(&(wld.map), tindex);
           const struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
           const v_radius_t change =
               V_RADIUS(player_tile_own_seen(plrtile, V_MAIN),
@@ -1677,7 +1992,7 @@ void give_shared_vision(struct player *pfrom, struct player *pto)
             map_change_seen(pplayer2, ptile, change,
                             map_is_known(ptile, pplayer));
           }
-        } whole_map_iterate_end;
+        }
 
         /* Squares that are not seen, but which pfrom may have more recent
            knowledge of */
@@ -1723,9 +2038,17 @@ void remove_shared_vision(struct player *pfrom, struct player *pto)
       if (!really_gives_vision(pplayer, pplayer2)
           && BV_ISSET(save_vision[player_index(pplayer)],
                       player_index(pplayer2))) {
+        const struct dbv *own_tiles = &pplayer->server.own_seen_tiles;
+        int tindex;
+
         log_debug("really removing shared vision from %s to %s",
                   player_name(pplayer), player_name(pplayer2));
-        whole_map_iterate(&(wld.map), ptile) {
+        /* Only tiles pplayer sees with their own vision ever fed seen
+         * count to pplayer2, so walk just those instead of the whole
+         * map. */
+        for (tindex = dbv_first_set(own_tiles); tindex != -1;
+             tindex = dbv_next_set(own_tiles, tindex)) {
+          struct tile *ptile = index_to_tile(&(wld.map), tindex);
           const struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
           const v_radius_t change =
               V_RADIUS(-player_tile_own_seen(plrtile, V_MAIN),
@@ -1735,7 +2058,7 @@ void remove_shared_vision(struct player *pfrom, struct player *pto)
           if (0 > change[V_MAIN] || 0 > change[V_INVIS]) {
             map_change_seen(pplayer2, ptile, change, FALSE);
           }
-        } whole_map_iterate_end;
+        }
       }
     } players_iterate_end;
     unbuffer_shared_vision(pplayer);
@@ -1990,6 +2313,8 @@ void fix_tile_on_terrain_change(struct tile *ptile,
     city_landlocked_sell_coastal_improvements(ptile);
   }
 
+  access_areas_tile_change(ptile);
+
   terrain_changed(ptile);
 }
 
@@ -2028,9 +2353,16 @@ void check_terrain_change(struct tile *ptile, struct terrain *oldter)
     }
   }
 
+  if (is_ocean(oldter) != is_ocean(newter)) {
+    /* Whether worked tiles count as settled area depends on the
+     * terrain class, which the score counters do not track. */
+    score_counters_invalidate();
+  }
+
   if (need_to_reassign_continents(oldter, newter)) {
     assign_continent_numbers();
     cont_reassigned = TRUE;
+    adv_threat_invalidate();
 
     phase_players_iterate(pplayer) {
       if (is_adv_data_phase_open(pplayer)) {
@@ -2147,6 +2479,7 @@ static void map_claim_border_ownership(struct tile *ptile,
     shared_vision_change_seen(powner, ptile, radius_sq, TRUE);
   }
 
+  score_counter_tile_owner(ploser, powner);
   tile_set_owner(ptile, powner, psource);
 
   /* Needed only when foggedborders enabled, but we do it unconditionally
@@ -2162,6 +2495,8 @@ static void map_claim_border_ownership(struct tile *ptile,
     if (!city_map_update_tile_frozen(ptile)) {
       send_tile_info(NULL, ptile, FALSE);
     }
+
+    adv_infra_cache_tile_dirty(ptile);
   }
 }
 
@@ -2243,12 +2578,14 @@ void map_update_border(struct tile *ptile, struct player *owner,
 }
 
 /**********************************************************************//**
-  Update borders for this source. Call this for each new source.
+  Update borders for this source.
 
   If radius_sq is -1, get value from the border source on tile.
+  If source_strength is -1, get value from the border source on tile;
+  map_calculate_borders() passes in strengths it has batch computed.
 **************************************************************************/
-void map_claim_border(struct tile *ptile, struct player *owner,
-                      int radius_sq)
+static void map_claim_border_full(struct tile *ptile, struct player *owner,
+                                  int radius_sq, int source_strength)
 {
   if (BORDERS_DISABLED == game.info.borders) {
     return;
@@ -2266,6 +2603,12 @@ void map_claim_border(struct tile *ptile, struct player *owner,
     radius_sq = tile_border_source_radius_sq(ptile);
   }
 
+  if (source_strength < 0) {
+    /* Hoisted out of the circle iteration; the old code recomputed this
+     * for every contested tile. */
+    source_strength = tile_border_source_strength(ptile);
+  }
+
   circle_dxyr_iterate(&(wld.map), ptile, radius_sq, dtile, dx, dy, dr) {
     struct tile *dclaimer = tile_claimer(dtile);
 
@@ -2307,7 +2650,8 @@ void map_claim_border(struct tile *ptile, struct player *owner,
       }
 
       strength_old = tile_border_strength(dtile, dclaimer);
-      strength_new = tile_border_strength(dtile, ptile);
+      strength_new = tile_border_strength_full(dtile, ptile,
+                                               source_strength);
 
       if (strength_new <= strength_old) {
         /* Stronger shall prevail,
@@ -2323,11 +2667,111 @@ void map_claim_border(struct tile *ptile, struct player *owner,
   } circle_dxyr_iterate_end;
 }
 
+/**********************************************************************//**
+  Update borders for this source. Call this for each new source.
+
+  If radius_sq is -1, get value from the border source on tile.
+**************************************************************************/
+void map_claim_border(struct tile *ptile, struct player *owner,
+                      int radius_sq)
+{
+  map_claim_border_full(ptile, owner, radius_sq, -1);
+}
+
+/* Cache of the last map_calculate_borders() pass, used to sweep only
+ * the sources whose claims can actually have changed. Per border source
+ * tile it holds the strength, radius and owner the source was last
+ * swept with. Tiles whose claims need another look although no source
+ * changed (e.g. freshly learned tiles) are marked in 'dirty_tiles';
+ * past BORDER_DIRTY_TILES_MAX of them - a map reveal, typically - the
+ * pass just sweeps every source. */
+#define BORDER_DIRTY_TILES_MAX 64
+
+static struct {
+  int size;        /* MAP_INDEX_SIZE the cache was built for */
+  bool valid;
+  int *strength;
+  int *radius_sq;
+  int *owner;
+  struct dbv is_source;
+  struct dbv dirty_tiles;
+  int dirty_count;
+} border_cache = { .size = 0, .valid = FALSE };
+
+/**********************************************************************//**
+  Make sure the border cache spans the current map. The cache starts
+  invalid, forcing the next map_calculate_borders() into a full pass.
+**************************************************************************/
+static void border_cache_prepare(void)
+{
+  if (border_cache.size != MAP_INDEX_SIZE) {
+    if (border_cache.size > 0) {
+      free(border_cache.strength);
+      free(border_cache.radius_sq);
+      free(border_cache.owner);
+      dbv_free(&border_cache.is_source);
+      dbv_free(&border_cache.dirty_tiles);
+    }
+    border_cache.strength
+      = fc_malloc(MAP_INDEX_SIZE * sizeof(*border_cache.strength));
+    border_cache.radius_sq
+      = fc_malloc(MAP_INDEX_SIZE * sizeof(*border_cache.radius_sq));
+    border_cache.owner
+      = fc_malloc(MAP_INDEX_SIZE * sizeof(*border_cache.owner));
+    dbv_init(&border_cache.is_source, MAP_INDEX_SIZE);
+    dbv_init(&border_cache.dirty_tiles, MAP_INDEX_SIZE);
+    border_cache.size = MAP_INDEX_SIZE;
+    border_cache.valid = FALSE;
+    border_cache.dirty_count = 0;
+  }
+}
+
+/**********************************************************************//**
+  Note that the claims on ptile may need recomputing at the next
+  map_calculate_borders() even if no border source changes.
+**************************************************************************/
+static void border_claims_invalidate_tile(struct tile *ptile)
+{
+  if (BORDERS_DISABLED == game.info.borders || wld.map.tiles == NULL) {
+    return;
+  }
+
+  border_cache_prepare();
+  if (!dbv_isset(&border_cache.dirty_tiles, tile_index(ptile))) {
+    dbv_set(&border_cache.dirty_tiles, tile_index(ptile));
+    border_cache.dirty_count++;
+  }
+}
+
+/**********************************************************************//**
+  Conservative test whether the claim circles of two border sources can
+  overlap: (sqrt(r1) + sqrt(r2))^2 <= 2 * (r1 + r2).
+**************************************************************************/
+static bool border_circles_overlap(const struct tile *ptile1, int radius1_sq,
+                                   const struct tile *ptile2, int radius2_sq)
+{
+  return sq_map_distance(ptile1, ptile2) <= 2 * (radius1_sq + radius2_sq);
+}
+
 /**********************************************************************//**
   Update borders for all sources. Call this on turn end.
+
+  Only the sources whose strength, radius or owner changed since the
+  last pass are swept, together with the sources their circles overlap
+  and the sources in reach of a tile marked dirty in between; for the
+  typical turn where most sources are unchanged city growth spikes no
+  longer trigger whole radius recomputes everywhere.
 **************************************************************************/
 void map_calculate_borders(void)
 {
+  struct tile **sources;
+  struct tile *dirty[BORDER_DIRTY_TILES_MAX];
+  int *strengths, *radii;
+  bool *sweep;
+  int count = 0, ndirty = 0, nvanished = 0;
+  int i, j;
+  bool full;
+
   if (BORDERS_DISABLED == game.info.borders) {
     return;
   }
@@ -2339,12 +2783,125 @@ void map_calculate_borders(void)
 
   log_verbose("map_calculate_borders()");
 
+  border_cache_prepare();
+  full = !border_cache.valid
+         || border_cache.dirty_count > BORDER_DIRTY_TILES_MAX;
+
+  /* Sources that vanished since the last pass free their claims; the
+   * freed tiles are left for the surviving sources in reach, which the
+   * overlap expansion below sends through a sweep. */
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    if (dbv_isset(&border_cache.is_source, i)) {
+      struct tile *ptile = index_to_tile(&(wld.map), i);
+
+      if (!is_border_source(ptile)) {
+        map_clear_border(ptile);
+        nvanished++;
+      }
+    }
+  }
+
+  /* Collect the sources first so that their strengths can be computed
+   * in one batched sweep rather than per claimed tile. */
+  sources = fc_malloc(MAP_INDEX_SIZE * sizeof(*sources));
   whole_map_iterate(&(wld.map), ptile) {
     if (is_border_source(ptile)) {
-      map_claim_border(ptile, ptile->owner, -1);
+      sources[count++] = ptile;
     }
   } whole_map_iterate_end;
 
+  if (!full && border_cache.dirty_count > 0) {
+    for (i = 0; i < MAP_INDEX_SIZE && ndirty < border_cache.dirty_count;
+         i++) {
+      if (dbv_isset(&border_cache.dirty_tiles, i)) {
+        dirty[ndirty++] = index_to_tile(&(wld.map), i);
+      }
+    }
+  }
+
+  if (count > 0) {
+    strengths = fc_malloc(count * sizeof(*strengths));
+    radii = fc_malloc(count * sizeof(*radii));
+    sweep = fc_malloc(count * sizeof(*sweep));
+    tile_border_source_strengths(sources, count, strengths);
+
+    /* Pass 1: sources whose own parameters changed. */
+    for (i = 0; i < count; i++) {
+      int tindex = tile_index(sources[i]);
+      int owner = (sources[i]->owner != NULL
+                   ? player_number(sources[i]->owner) : -1);
+
+      radii[i] = tile_border_source_radius_sq(sources[i]);
+      sweep[i] = full
+                 || !dbv_isset(&border_cache.is_source, tindex)
+                 || border_cache.strength[tindex] != strengths[i]
+                 || border_cache.radius_sq[tindex] != radii[i]
+                 || border_cache.owner[tindex] != owner;
+    }
+
+    /* Pass 2: sources contesting tiles with a changed source, or in
+     * reach of a vanished source or a dirty tile. Vanished sources are
+     * rare enough that their reach is not tracked; any of them sends
+     * every source through a sweep. */
+    if (!full) {
+      for (i = 0; i < count; i++) {
+        if (sweep[i]) {
+          continue;
+        }
+
+        if (nvanished > 0) {
+          sweep[i] = TRUE;
+          continue;
+        }
+
+        for (j = 0; j < ndirty && !sweep[i]; j++) {
+          sweep[i] = sq_map_distance(sources[i], dirty[j]) <= radii[i];
+        }
+        for (j = 0; j < count && !sweep[i]; j++) {
+          /* Only the pass 1 flags mark changed sources here; the flags
+           * this pass adds are behind 'i' and already expanded. */
+          if (j < i && sweep[j]) {
+            continue;
+          }
+          sweep[i] = (j != i && sweep[j]
+                      && border_circles_overlap(sources[i], radii[i],
+                                                sources[j], radii[j]));
+        }
+      }
+    }
+
+    for (i = 0; i < count; i++) {
+      if (sweep[i]) {
+        map_claim_border_full(sources[i], sources[i]->owner, radii[i],
+                              strengths[i]);
+      }
+    }
+
+    /* Remember what this pass was computed from. */
+    dbv_clr_all(&border_cache.is_source);
+    for (i = 0; i < count; i++) {
+      int tindex = tile_index(sources[i]);
+
+      dbv_set(&border_cache.is_source, tindex);
+      border_cache.strength[tindex] = strengths[i];
+      border_cache.radius_sq[tindex] = radii[i];
+      border_cache.owner[tindex] = (sources[i]->owner != NULL
+                                    ? player_number(sources[i]->owner)
+                                    : -1);
+    }
+
+    free(sweep);
+    free(radii);
+    free(strengths);
+  } else {
+    dbv_clr_all(&border_cache.is_source);
+  }
+  free(sources);
+
+  dbv_clr_all(&border_cache.dirty_tiles);
+  border_cache.dirty_count = 0;
+  border_cache.valid = TRUE;
+
   log_verbose("map_calculate_borders() workers");
   city_thaw_workers_queue();
   city_refresh_queue_processing();
@@ -2537,6 +3094,12 @@ void create_extra(struct tile *ptile, struct extra_type *pextra,
 
   tile_add_extra(ptile, pextra);
 
+  if (access_info_access_unit() != NULL
+      && is_native_extra_to_utype(pextra, access_info_access_unit())) {
+    /* The extra may connect access areas (e.g. a canal). */
+    access_areas_tile_change(ptile);
+  }
+
   /* Watchtower might become effective. */
   unit_list_refresh_vision(ptile->units);
 
@@ -2613,6 +3176,12 @@ void destroy_extra(struct tile *ptile, struct extra_type *pextra)
 
   tile_remove_extra(ptile, pextra);
 
+  if (access_info_access_unit() != NULL
+      && is_native_extra_to_utype(pextra, access_info_access_unit())) {
+    /* The extra may have been carrying access area connectivity. */
+    access_areas_tile_change(ptile);
+  }
+
   if (real) {
     /* Remove base from vision of players which were able to see the base. */
     players_iterate(pplayer) {
@@ -2681,6 +3250,19 @@ void tile_change_side_effects(struct tile *ptile, bool refresh_city)
 {
   struct city *pcity = ptile->worked;
 
+  /* Cached path-finding results near this tile may now be out of
+   * date. The pf_map cache needs no notification here; only the
+   * client goto code populates it. */
+  pf_alt_invalidate();
+  pf_hier_invalidate();
+
+  /* Cached tile improvement values of nearby cities are stale too. */
+  adv_infra_cache_tile_dirty(ptile);
+
+  /* Terrain changes may renumber continents and oceans, on which the
+   * incremental threat profiles depend. */
+  adv_threat_invalidate();
+
   /* Check the unit activities. */
   unit_activities_cancel_all_illegal_area(ptile);
 
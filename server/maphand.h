@@ -57,6 +57,8 @@ void give_citymap_from_player_to_player(struct city *pcity,
 void send_all_known_tiles(struct conn_list *dest);
 
 bool send_tile_suppression(bool now);
+void tile_info_batch_start(void);
+void tile_info_batch_flush(void);
 void send_tile_info(struct conn_list *dest, struct tile *ptile,
                     bool send_unknown);
 
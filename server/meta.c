@@ -74,7 +74,30 @@ static char meta_patches[256] = "";
 static char meta_message[256] = "";
 
 #ifdef FREECIV_META_ENABLED
-static fc_thread *meta_srv_thread = NULL;
+/* A prepared metaserver update: a plain name/value snapshot of game
+ * state, taken on the main thread. The worker thread turns it into the
+ * actual HTTP post, so no network or curl state is ever touched from
+ * the main loop. */
+struct meta_post {
+  int entries;
+  int capacity;
+  char **names;
+  char **values;
+};
+
+/* The next snapshot to send. Every snapshot carries the full server
+ * state, so a newer one simply replaces an unsent older one; the
+ * worker never falls behind by more than one update. Protected by
+ * meta_queue_mutex together with the flags below. */
+static struct meta_post *meta_pending = NULL;
+static bool meta_post_failed = FALSE;
+
+static fc_thread meta_srv_thread;
+static fc_mutex meta_queue_mutex;
+static fc_thread_cond meta_queue_cond;
+static bool meta_queue_initialized = FALSE;
+static bool meta_worker_running = FALSE;
+static bool meta_worker_stopping = FALSE;
 #endif /* FREECIV_META_ENABLED */
 
 /*********************************************************************//**
@@ -222,10 +245,67 @@ static void metaserver_failed(void)
   }
 }
 
+/*********************************************************************//**
+  Allocate an empty metaserver snapshot.
+*************************************************************************/
+static struct meta_post *meta_post_new(void)
+{
+  struct meta_post *post = fc_calloc(1, sizeof(*post));
+
+  return post;
+}
+
+/*********************************************************************//**
+  Free a metaserver snapshot.
+*************************************************************************/
+static void meta_post_free(struct meta_post *post)
+{
+  int i;
+
+  for (i = 0; i < post->entries; i++) {
+    free(post->names[i]);
+    free(post->values[i]);
+  }
+  free(post->names);
+  free(post->values);
+  free(post);
+}
+
+/*********************************************************************//**
+  Add one name/value pair to the snapshot.
+*************************************************************************/
+static void meta_post_add(struct meta_post *post,
+                          const char *name, const char *val)
+{
+  if (post->entries >= post->capacity) {
+    post->capacity = (post->capacity > 0 ? post->capacity * 2 : 32);
+    post->names = fc_realloc(post->names,
+                             post->capacity * sizeof(post->names[0]));
+    post->values = fc_realloc(post->values,
+                              post->capacity * sizeof(post->values[0]));
+  }
+
+  post->names[post->entries] = fc_strdup(name);
+  post->values[post->entries] = fc_strdup(val);
+  post->entries++;
+}
+
+/*********************************************************************//**
+  Add one integer name/value pair to the snapshot.
+*************************************************************************/
+static void meta_post_add_int(struct meta_post *post,
+                              const char *name, const int val)
+{
+  char buf[50];
+
+  fc_snprintf(buf, sizeof(buf), "%d", val);
+  meta_post_add(post, name, buf);
+}
+
 /*********************************************************************//**
   Insert a setting in the metaserver message. Return TRUE if it succeeded.
 *************************************************************************/
-static inline bool meta_insert_setting(struct netfile_post *post,
+static inline bool meta_insert_setting(struct meta_post *post,
                                        const char *set_name)
 {
   const struct setting *pset = setting_by_name(set_name);
@@ -233,19 +313,27 @@ static inline bool meta_insert_setting(struct netfile_post *post,
 
   fc_assert_ret_val_msg(NULL != pset, FALSE,
                         "Setting \"%s\" not found!", set_name);
-  netfile_add_form_str(post, "vn[]", setting_name(pset));
-  netfile_add_form_str(post, "vv[]",
-                       setting_value_name(pset, FALSE, buf, sizeof(buf)));
+  meta_post_add(post, "vn[]", setting_name(pset));
+  meta_post_add(post, "vv[]",
+                setting_value_name(pset, FALSE, buf, sizeof(buf)));
   return TRUE;
 }
 
 /*********************************************************************//**
-  Send POST to metaserver. This runs in its own thread.
+  Build the HTTP post from the snapshot and send it to the metaserver.
+  Consumes the snapshot. Runs on the worker thread, or on the main
+  thread when the worker could not be started.
 *************************************************************************/
-static void send_metaserver_post(void *arg)
+static bool meta_post_send(struct meta_post *snapshot)
 {
-  struct netfile_post *post = (struct netfile_post *) arg;
+  struct netfile_post *post = netfile_start_post();
   char *addr;
+  bool ok;
+  int i;
+
+  for (i = 0; i < snapshot->entries; i++) {
+    netfile_add_form_str(post, snapshot->names[i], snapshot->values[i]);
+  }
 
   if (srvarg.bind_meta_addr != NULL) {
     addr = srvarg.bind_meta_addr;
@@ -253,12 +341,68 @@ static void send_metaserver_post(void *arg)
     addr = srvarg.bind_addr;
   }
 
-  if (!netfile_send_post(srvarg.metaserver_addr, post, NULL, NULL, addr)) {
-    con_puts(C_METAERROR, _("Error connecting to metaserver"));
-    metaserver_failed();
-  }
+  ok = netfile_send_post(srvarg.metaserver_addr, post, NULL, NULL, addr);
 
   netfile_close_post(post);
+  meta_post_free(snapshot);
+
+  return ok;
+}
+
+/*********************************************************************//**
+  Worker thread main loop: send queued snapshots to the metaserver.
+  Failures are flagged for the main thread, which owns the console and
+  the retry bookkeeping. Keeps draining before honoring a stop request
+  so that the goodbye post still goes out at shutdown.
+*************************************************************************/
+static void meta_thread_func(void *arg)
+{
+  fc_mutex_allocate(&meta_queue_mutex);
+
+  for (;;) {
+    struct meta_post *snapshot = meta_pending;
+
+    if (snapshot != NULL) {
+      bool ok;
+
+      meta_pending = NULL;
+      fc_mutex_release(&meta_queue_mutex);
+
+      ok = meta_post_send(snapshot);
+
+      fc_mutex_allocate(&meta_queue_mutex);
+      if (!ok) {
+        meta_post_failed = TRUE;
+      }
+      continue;
+    }
+
+    if (meta_worker_stopping) {
+      break;
+    }
+
+    fc_thread_cond_wait(&meta_queue_cond, &meta_queue_mutex);
+  }
+
+  fc_mutex_release(&meta_queue_mutex);
+}
+
+/*********************************************************************//**
+  Stop the worker thread, after it has sent anything still queued.
+*************************************************************************/
+static void meta_worker_shutdown(void)
+{
+  if (!meta_worker_running) {
+    return;
+  }
+
+  fc_mutex_allocate(&meta_queue_mutex);
+  meta_worker_stopping = TRUE;
+  fc_thread_cond_signal(&meta_queue_cond);
+  fc_mutex_release(&meta_queue_mutex);
+  fc_thread_wait(&meta_srv_thread);
+  meta_worker_running = FALSE;
+  meta_worker_stopping = FALSE;
 }
 
 /*********************************************************************//**
@@ -271,7 +415,7 @@ static bool send_to_metaserver(enum meta_flag flag)
   char host[512];
   char state[20];
   char rs[256];
-  struct netfile_post *post;
+  struct meta_post *post;
 
   switch (server_state()) {
   case S_S_INITIAL:
@@ -298,34 +442,32 @@ static bool send_to_metaserver(enum meta_flag flag)
     sz_strlcpy(rs, game.control.name);
   }
 
-  /* Freed in metaserver thread function send_metaserver_post() */
-  post = netfile_start_post();
+  /* Consumed by meta_post_send() */
+  post = meta_post_new();
 
-  netfile_add_form_str(post, "host", host);
-  netfile_add_form_int(post, "port", srvarg.port);
-  netfile_add_form_str(post, "state", state);
-  netfile_add_form_str(post, "ruleset", rs);
+  meta_post_add(post, "host", host);
+  meta_post_add_int(post, "port", srvarg.port);
+  meta_post_add(post, "state", state);
+  meta_post_add(post, "ruleset", rs);
 
   if (flag == META_GOODBYE) {
-    netfile_add_form_int(post, "bye", 1);
+    meta_post_add_int(post, "bye", 1);
   } else {
     const char *srvtype = get_meta_type_string();
 
     if (srvtype != NULL) {
-      netfile_add_form_str(post, "type", srvtype);
+      meta_post_add(post, "type", srvtype);
     }
-    netfile_add_form_str(post, "version", VERSION_STRING);
-    netfile_add_form_str(post, "patches",
-                         get_meta_patches_string());
-    netfile_add_form_str(post, "capability", our_capability);
+    meta_post_add(post, "version", VERSION_STRING);
+    meta_post_add(post, "patches", get_meta_patches_string());
+    meta_post_add(post, "capability", our_capability);
 
-    netfile_add_form_str(post, "serverid", srvarg.serverid);
-    netfile_add_form_str(post, "message",
-                         get_meta_message_string());
+    meta_post_add(post, "serverid", srvarg.serverid);
+    meta_post_add(post, "message", get_meta_message_string());
 
     /* NOTE: Send info for ALL players or none at all. */
     if (normal_player_count() == 0) {
-      netfile_add_form_int(post, "dropplrs", 1);
+      meta_post_add_int(post, "dropplrs", 1);
     } else {
       players = 0; /* Counter for players_available */
       humans = 0;
@@ -347,19 +489,18 @@ static bool send_to_metaserver(enum meta_flag flag)
           sz_strlcpy(type, "-");
         }
 
-        netfile_add_form_str(post, "plu[]", plr->username);
-        netfile_add_form_str(post, "plt[]", type);
-        netfile_add_form_str(post, "pll[]", player_name(plr));
-        netfile_add_form_str(post, "pln[]",
-                             plr->nation != NO_NATION_SELECTED
-                             ? nation_plural_for_player(plr)
-                             : "none");
-        netfile_add_form_str(post, "plf[]",
-                             plr->nation != NO_NATION_SELECTED
-                             ? nation_of_player(plr)->flag_graphic_str
-                             : "none");
-        netfile_add_form_str(post, "plh[]",
-                             pconn ? pconn->addr : "");
+        meta_post_add(post, "plu[]", plr->username);
+        meta_post_add(post, "plt[]", type);
+        meta_post_add(post, "pll[]", player_name(plr));
+        meta_post_add(post, "pln[]",
+                      plr->nation != NO_NATION_SELECTED
+                      ? nation_plural_for_player(plr)
+                      : "none");
+        meta_post_add(post, "plf[]",
+                      plr->nation != NO_NATION_SELECTED
+                      ? nation_of_player(plr)->flag_graphic_str
+                      : "none");
+        meta_post_add(post, "plh[]", pconn ? pconn->addr : "");
 
         /* Is this player available to take?
          * TODO: There's some duplication here with
@@ -392,8 +533,8 @@ static bool send_to_metaserver(enum meta_flag flag)
       } players_iterate_end;
 
       /* Send the number of available players. */
-      netfile_add_form_int(post, "available", players);
-      netfile_add_form_int(post, "humans", humans);
+      meta_post_add_int(post, "available", players);
+      meta_post_add_int(post, "humans", humans);
     }
 
     /* Send some variables: should be listed in inverted order? */
@@ -424,26 +565,46 @@ static bool send_to_metaserver(enum meta_flag flag)
     }
 
     /* Turn and year. */
-    netfile_add_form_str(post, "vn[]", "turn");
-    netfile_add_form_int(post, "vv[]", game.info.turn);
-    netfile_add_form_str(post, "vn[]", "year");
+    meta_post_add(post, "vn[]", "turn");
+    meta_post_add_int(post, "vv[]", game.info.turn);
+    meta_post_add(post, "vn[]", "year");
 
     if (server_state() != S_S_INITIAL) {
-      netfile_add_form_int(post, "vv[]", game.info.year);
+      meta_post_add_int(post, "vv[]", game.info.year);
     } else {
-      netfile_add_form_str(post, "vv[]", "Calendar not set up");
+      meta_post_add(post, "vv[]", "Calendar not set up");
     }
   }
 
-  if (meta_srv_thread != NULL) {
-    /* Previously started thread */
-    fc_thread_wait(meta_srv_thread);
-  } else {
-    meta_srv_thread = fc_malloc(sizeof(meta_srv_thread));
+  if (!meta_queue_initialized) {
+    fc_mutex_init(&meta_queue_mutex);
+    fc_thread_cond_init(&meta_queue_cond);
+    meta_queue_initialized = TRUE;
+  }
+
+  if (!meta_worker_running) {
+    if (!has_thread_cond_impl()
+        || fc_thread_start(&meta_srv_thread, meta_thread_func, NULL) != 0) {
+      /* No way to run the worker; send from this thread as a last
+       * resort. */
+      if (!meta_post_send(post)) {
+        con_puts(C_METAERROR, _("Error connecting to metaserver"));
+        metaserver_failed();
+        return FALSE;
+      }
+      return TRUE;
+    }
+    meta_worker_running = TRUE;
   }
 
-  /* Send POST in new thread */
-  fc_thread_start(meta_srv_thread, &send_metaserver_post, post);
+  fc_mutex_allocate(&meta_queue_mutex);
+  if (meta_pending != NULL) {
+    /* Not sent yet; this newer full snapshot supersedes it. */
+    meta_post_free(meta_pending);
+  }
+  meta_pending = post;
+  fc_thread_cond_signal(&meta_queue_cond);
+  fc_mutex_release(&meta_queue_mutex);
 
   return TRUE;
 }
@@ -500,6 +661,22 @@ bool send_server_info_to_metaserver(enum meta_flag flag)
   static bool want_update;
   int since_previous;
 
+  /* Report failures detected by the worker thread from here, on the
+   * main thread, where the console and the retry bookkeeping live. */
+  if (meta_queue_initialized) {
+    bool failed;
+
+    fc_mutex_allocate(&meta_queue_mutex);
+    failed = meta_post_failed;
+    meta_post_failed = FALSE;
+    fc_mutex_release(&meta_queue_mutex);
+
+    if (failed) {
+      con_puts(C_METAERROR, _("Error connecting to metaserver"));
+      metaserver_failed();
+    }
+  }
+
   if (!server_is_open) {
     return FALSE;
   }
@@ -521,10 +698,9 @@ bool send_server_info_to_metaserver(enum meta_flag flag)
     }
     send_to_metaserver(flag);
 
-    /* Wait metaserver thread to finish */
-    fc_thread_wait(meta_srv_thread);
-    free(meta_srv_thread);
-    meta_srv_thread = NULL;
+    /* Wait for the worker to deliver the goodbye; bounded by the
+     * netfile transfer timeouts. */
+    meta_worker_shutdown();
 
     return TRUE;
   }
@@ -244,6 +244,12 @@ void notify_conn(struct conn_list *dest,
   struct packet_chat_msg genmsg;
   va_list args;
 
+  if (server_is_headless()) {
+    /* No client will ever see these events; skip the message
+     * formatting and the event cache altogether. */
+    return;
+  }
+
   va_start(args, format);
   vpackage_event(&genmsg, ptile, event, color, format, args);
   va_end(args);
@@ -269,6 +275,10 @@ void notify_conn_early(struct conn_list *dest,
   struct packet_chat_msg genmsg;
   va_list args;
 
+  if (server_is_headless()) {
+    return;
+  }
+
   va_start(args, format);
   vpackage_event(&genmsg, ptile, event, color, format, args);
   va_end(args);
@@ -298,6 +308,10 @@ void notify_player(const struct player *pplayer,
   struct packet_chat_msg genmsg;
   va_list args;
 
+  if (server_is_headless()) {
+    return;
+  }
+
   va_start(args, format);
   vpackage_event(&genmsg, ptile, event, color, format, args);
   va_end(args);
@@ -322,6 +336,10 @@ void notify_embassies(const struct player *pplayer,
   struct event_cache_players *players = NULL;
   va_list args;
 
+  if (server_is_headless()) {
+    return;
+  }
+
   va_start(args, format);
   vpackage_event(&genmsg, ptile, event, color, format, args);
   va_end(args);
@@ -353,6 +371,10 @@ void notify_team(const struct player *pplayer,
   struct event_cache_players *players = NULL;
   va_list args;
 
+  if (server_is_headless()) {
+    return;
+  }
+
   va_start(args, format);
   vpackage_event(&genmsg, ptile, event, color, format, args);
   va_end(args);
@@ -400,6 +422,10 @@ void notify_research(const struct research *presearch,
   struct event_cache_players *players = NULL;
   va_list args;
 
+  if (server_is_headless()) {
+    return;
+  }
+
   va_start(args, format);
   vpackage_event(&genmsg, NULL, event, color, format, args);
   va_end(args);
@@ -440,6 +466,10 @@ void notify_research_embassies(const struct research *presearch,
   struct event_cache_players *players = NULL;
   va_list args;
 
+  if (server_is_headless()) {
+    return;
+  }
+
   va_start(args, format);
   vpackage_event(&genmsg, NULL, event, color, format, args);
   va_end(args);
@@ -481,35 +511,91 @@ struct event_cache_data {
   bv_player target;     /* Used if target_type == ECT_PLAYERS. */
 };
 
-#define SPECLIST_TAG event_cache_data
-#define SPECLIST_TYPE struct event_cache_data
-#include "speclist.h"
+/* The events are kept in a preallocated ring so that message floods do
+ * not allocate per entry; the oldest entry is overwritten in place once
+ * the configured maximum is reached. */
+static struct event_cache_data *event_ring = NULL;
+static int event_ring_capacity = 0;
+static int event_ring_start = 0;
+static int event_ring_size = 0;
+static bool event_ring_active = FALSE;
+
+#define EVENT_RING_INITIAL_CAPACITY 64
+
 #define event_cache_iterate(pdata) \
-    TYPED_LIST_ITERATE(struct event_cache_data, event_cache, pdata)
-#define event_cache_iterate_end  LIST_ITERATE_END
+{ \
+  int pdata##_index; \
+  for (pdata##_index = 0; pdata##_index < event_ring_size; \
+       pdata##_index++) { \
+    struct event_cache_data *pdata = event_ring \
+      + (event_ring_start + pdata##_index) % event_ring_capacity;
+#define event_cache_iterate_end \
+  } \
+}
 
 struct event_cache_players {
   bv_player vector;
 };
 
-/* The full list of the events. */
-static struct event_cache_data_list *event_cache = NULL;
-
 /* Event cache status: ON(TRUE) / OFF(FALSE); used for saving the
  * event cache */
 static bool event_cache_status = FALSE;
 
 /**********************************************************************//**
-  Callback for freeing event cache data
+  Returns the configured maximum number of cached events.
+**************************************************************************/
+static int event_cache_max_events(void)
+{
+  return (game.server.event_cache.max_size
+          ? game.server.event_cache.max_size
+          : GAME_MAX_EVENT_CACHE_MAX_SIZE);
+}
+
+/**********************************************************************//**
+  Drop the oldest entry of the ring.
 **************************************************************************/
-static void event_cache_data_free(struct event_cache_data *data)
+static void event_ring_pop_front(void)
 {
-  free(data);
+  fc_assert_ret(event_ring_size > 0);
+
+  event_ring_start = (event_ring_start + 1) % event_ring_capacity;
+  event_ring_size--;
+}
+
+/**********************************************************************//**
+  Make sure the ring has room for at least one more entry, growing the
+  backing storage geometrically up to the configured maximum. Entries
+  are linearized into the new storage, so this stays a rare event that
+  only follows a raised cache size setting or initial fill-up.
+**************************************************************************/
+static void event_ring_ensure_room(int max_events)
+{
+  struct event_cache_data *new_ring;
+  int new_capacity;
+  int i;
+
+  if (event_ring_size < event_ring_capacity) {
+    return;
+  }
+
+  new_capacity = MAX(event_ring_capacity * 2, EVENT_RING_INITIAL_CAPACITY);
+  new_capacity = MIN(new_capacity, max_events);
+
+  new_ring = fc_malloc(new_capacity * sizeof(*new_ring));
+  for (i = 0; i < event_ring_size; i++) {
+    new_ring[i]
+      = event_ring[(event_ring_start + i) % event_ring_capacity];
+  }
+
+  free(event_ring);
+  event_ring = new_ring;
+  event_ring_capacity = new_capacity;
+  event_ring_start = 0;
 }
 
 /**********************************************************************//**
-  Creates a new event_cache_data, appened to the list. It may remove an
-  old entry if needed.
+  Fills the next ring slot in place and returns it. It may overwrite
+  the oldest entry if needed.
 **************************************************************************/
 static struct event_cache_data *
 event_cache_data_new(const struct packet_chat_msg *packet,
@@ -520,7 +606,7 @@ event_cache_data_new(const struct packet_chat_msg *packet,
   struct event_cache_data *pdata;
   int max_events;
 
-  if (NULL == event_cache) {
+  if (!event_ring_active) {
     /* Don't do log for this, because this could make an infinite
      * recursion. */
     return NULL;
@@ -542,7 +628,18 @@ event_cache_data_new(const struct packet_chat_msg *packet,
     return NULL;
   }
 
-  pdata = fc_malloc(sizeof(*pdata));
+  /* The maximum may have been lowered since the last entry. */
+  max_events = event_cache_max_events();
+  while (event_ring_size >= max_events) {
+    event_ring_pop_front();
+  }
+
+  event_ring_ensure_room(max_events);
+
+  pdata = event_ring
+    + (event_ring_start + event_ring_size) % event_ring_capacity;
+  event_ring_size++;
+
   pdata->packet = *packet;
   pdata->timestamp = timestamp;
   pdata->server_state = server_status;
@@ -552,14 +649,6 @@ event_cache_data_new(const struct packet_chat_msg *packet,
   } else {
     BV_CLR_ALL(pdata->target);
   }
-  event_cache_data_list_append(event_cache, pdata);
-
-  max_events = game.server.event_cache.max_size
-               ? game.server.event_cache.max_size
-               : GAME_MAX_EVENT_CACHE_MAX_SIZE;
-  while (event_cache_data_list_size(event_cache) > max_events) {
-    event_cache_data_list_pop_front(event_cache);
-  }
 
   return pdata;
 }
@@ -569,10 +658,10 @@ event_cache_data_new(const struct packet_chat_msg *packet,
 **************************************************************************/
 void event_cache_init(void)
 {
-  if (event_cache != NULL) {
+  if (event_ring_active) {
     event_cache_free();
   }
-  event_cache = event_cache_data_list_new_full(event_cache_data_free);
+  event_ring_active = TRUE;
   event_cache_status = TRUE;
 }
 
@@ -581,10 +670,12 @@ void event_cache_init(void)
 **************************************************************************/
 void event_cache_free(void)
 {
-  if (event_cache != NULL) {
-    event_cache_data_list_destroy(event_cache);
-    event_cache = NULL;
-  }
+  free(event_ring);
+  event_ring = NULL;
+  event_ring_capacity = 0;
+  event_ring_start = 0;
+  event_ring_size = 0;
+  event_ring_active = FALSE;
   event_cache_status = FALSE;
 }
 
@@ -593,7 +684,8 @@ void event_cache_free(void)
 **************************************************************************/
 void event_cache_clear(void)
 {
-  event_cache_data_list_clear(event_cache);
+  event_ring_start = 0;
+  event_ring_size = 0;
 }
 
 /**********************************************************************//**
@@ -601,15 +693,11 @@ void event_cache_clear(void)
 **************************************************************************/
 void event_cache_remove_old(void)
 {
-  struct event_cache_data *current;
-
   /* This assumes that entries are in order, the ones to be removed first. */
-  current = event_cache_data_list_get(event_cache, 0);
-
-    while (current != NULL
-           && current->packet.turn + game.server.event_cache.turns <= game.info.turn) {
-    event_cache_data_list_pop_front(event_cache);
-    current = event_cache_data_list_get(event_cache, 0);
+  while (event_ring_size > 0
+         && (event_ring[event_ring_start].packet.turn
+             + game.server.event_cache.turns <= game.info.turn)) {
+    event_ring_pop_front();
   }
 }
 
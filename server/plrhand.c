@@ -30,8 +30,10 @@
 #include "citizens.h"
 #include "culture.h"
 #include "diptreaty.h"
+#include "effects.h"
 #include "government.h"
 #include "map.h"
+#include "metaknowledge.h"
 #include "movement.h"
 #include "multipliers.h"
 #include "nation.h"
@@ -58,6 +60,8 @@
 #include "mood.h"
 #include "notify.h"
 #include "plrhand.h"
+#include "report.h"
+#include "score.h"
 #include "sernet.h"
 #include "srv_main.h"
 #include "stdinhand.h"
@@ -70,6 +74,9 @@
 /* server/advisors */
 #include "advdata.h"
 
+/* server/savegame */
+#include "savemain.h"
+
 /* server/scripting */
 #include "script_server.h"
 
@@ -116,6 +123,15 @@ static int shuffled_order[MAX_NUM_PLAYER_SLOTS];
 /* Used by player_info_freeze() and player_info_thaw(). */
 static int player_info_frozen_level = 0;
 
+/* Used by player_info_batch_start() and player_info_batch_flush().
+ * While batching, broadcast sends are coalesced into these dirty sets
+ * and built just once from the flush. */
+static bool player_info_batching = FALSE;
+static bv_player player_info_dirty_all;
+static bv_player player_info_dirty_self;
+static bv_player player_diplstate_dirty_all;
+static bv_player player_diplstate_dirty_self;
+
 /**********************************************************************//**
   Murder a player in cold blood.
 
@@ -129,6 +145,12 @@ void kill_player(struct player *pplayer)
 
   pplayer->is_alive = FALSE;
 
+  /* Death cuts diplomatic intel. */
+  metaknowledge_intel_invalidate();
+
+  /* Dead players drop out of the demographics ranks. */
+  demographics_invalidate();
+
   /* Reset player status */
   player_status_reset(pplayer);
 
@@ -170,6 +192,9 @@ void kill_player(struct player *pplayer)
      rightful owners, if they are still around */
   save_palace = game.server.savepalace;
   game.server.savepalace = FALSE; /* Moving it around is dumb */
+  /* Every transferred city triggers its own cascade of updates; cork
+   * the connections so the whole collapse arrives in one flush. */
+  conn_list_do_buffer(game.est_connections);
   city_list_iterate_safe(pplayer->cities, pcity) {
     if (pcity->original != pplayer && pcity->original != nullptr
         && pcity->original->is_alive) {
@@ -183,6 +208,7 @@ void kill_player(struct player *pplayer)
       }
     }
   } city_list_iterate_safe_end;
+  conn_list_do_unbuffer(game.est_connections);
   game.server.savepalace = save_palace;
 
   /* Let there be civil war */
@@ -218,6 +244,7 @@ void kill_player(struct player *pplayer)
     adv_data_phase_init(barbarians, TRUE);
 
     /* Transfer any remaining cities */
+    conn_list_do_buffer(game.est_connections);
     city_list_iterate_safe(pplayer->cities, pcity) {
       if (transfer_city(barbarians, pcity, -1, FALSE, FALSE, FALSE,
                         FALSE)) {
@@ -225,6 +252,7 @@ void kill_player(struct player *pplayer)
                                   barbarians, "death-barbarians_get");
       }
     } city_list_iterate_safe_end;
+    conn_list_do_unbuffer(game.est_connections);
 
     game.server.savepalace = palace;
 
@@ -350,6 +378,10 @@ void government_change(struct player *pplayer, struct government *gov,
   pplayer->government = gov;
   pplayer->target_government = nullptr;
 
+  /* Government requirements feed many effects. */
+  effect_cache_invalidate();
+  requirement_memo_reset();
+
   if (revolution_finished) {
     log_debug("Revolution finished for %s. Government is %s. "
               "Revofin %d (%d).", player_name(pplayer),
@@ -1117,6 +1149,51 @@ void player_info_thaw(void)
   fc_assert(0 <= player_info_frozen_level);
 }
 
+/**********************************************************************//**
+  Until the matching player_info_batch_flush(), coalesce repeated player
+  info and diplstate broadcasts into a single send per player. Used
+  around phase processing, where counters like gold change many times
+  in a row and each send_player_info_c() call would otherwise package
+  and hash a full packet per recipient.
+**************************************************************************/
+void player_info_batch_start(void)
+{
+  fc_assert_ret(!player_info_batching);
+
+  player_info_batching = TRUE;
+  BV_CLR_ALL(player_info_dirty_all);
+  BV_CLR_ALL(player_info_dirty_self);
+  BV_CLR_ALL(player_diplstate_dirty_all);
+  BV_CLR_ALL(player_diplstate_dirty_self);
+}
+
+/**********************************************************************//**
+  Send the coalesced player info and diplstate broadcasts and leave
+  batching mode.
+**************************************************************************/
+void player_info_batch_flush(void)
+{
+  fc_assert_ret(player_info_batching);
+
+  player_info_batching = FALSE;
+
+  players_iterate(pplayer) {
+    int idx = player_index(pplayer);
+
+    if (BV_ISSET(player_info_dirty_all, idx)) {
+      send_player_info_c_real(pplayer, nullptr);
+    } else if (BV_ISSET(player_info_dirty_self, idx)) {
+      send_player_info_c_real(pplayer, pplayer->connections);
+    }
+
+    if (BV_ISSET(player_diplstate_dirty_all, idx)) {
+      send_player_diplstate_c_real(pplayer, nullptr);
+    } else if (BV_ISSET(player_diplstate_dirty_self, idx)) {
+      send_player_diplstate_c_real(pplayer, pplayer->connections);
+    }
+  } players_iterate_end;
+}
+
 /**********************************************************************//**
   Send all information about a player (player_info and all
   player_diplstates) to the given connections.
@@ -1147,10 +1224,35 @@ void send_player_all_c(struct player *src, struct conn_list *dest)
 **************************************************************************/
 void send_player_info_c(struct player *src, struct conn_list *dest)
 {
+  deltasave_dirty_player(src);
+
+  if (server_is_headless()) {
+    return; /* Nobody to send to, ever */
+  }
+
   if (0 < player_info_frozen_level) {
     return; /* Discard, see comment for player_info_freeze(). */
   }
 
+  if (player_info_batching) {
+    /* Just mark dirty; player_info_batch_flush() sends once. */
+    if (dest == nullptr || dest == game.est_connections) {
+      if (src != nullptr) {
+        BV_SET(player_info_dirty_all, player_index(src));
+      } else {
+        players_iterate(pplayer) {
+          BV_SET(player_info_dirty_all, player_index(pplayer));
+        } players_iterate_end;
+      }
+      return;
+    } else if (src != nullptr && dest == src->connections) {
+      BV_SET(player_info_dirty_self, player_index(src));
+      return;
+    }
+    /* Other destinations (single connections etc.) are rare enough to
+     * send right away. */
+  }
+
   if (src != nullptr) {
     send_player_info_c_real(src, dest);
     return;
@@ -1213,6 +1315,27 @@ static void send_player_info_c_real(struct player *src,
 **************************************************************************/
 void send_player_diplstate_c(struct player *src, struct conn_list *dest)
 {
+  if (server_is_headless()) {
+    return; /* Nobody to send to, ever */
+  }
+
+  if (player_info_batching) {
+    /* Just mark dirty; player_info_batch_flush() sends once. */
+    if (dest == nullptr || dest == game.est_connections) {
+      if (src != nullptr) {
+        BV_SET(player_diplstate_dirty_all, player_index(src));
+      } else {
+        players_iterate(pplayer) {
+          BV_SET(player_diplstate_dirty_all, player_index(pplayer));
+        } players_iterate_end;
+      }
+      return;
+    } else if (src != nullptr && dest == src->connections) {
+      BV_SET(player_diplstate_dirty_self, player_index(src));
+      return;
+    }
+  }
+
   if (src != nullptr) {
     send_player_diplstate_c_real(src, dest);
     return;
@@ -1982,6 +2105,7 @@ void server_remove_player(struct player *pplayer)
       remove_shared_vision(pplayer, aplayer);
     }
   } players_iterate_end;
+  metaknowledge_intel_invalidate();
 
   /* Remove citizens of this player from the cities of all other players. */
   /* FIXME: add a special case if the server quits - no need to run this for
@@ -2320,6 +2444,7 @@ void make_contact(struct player *pplayer1, struct player *pplayer2,
       && get_player_bonus(pplayer2, EFT_NO_DIPLOMACY) <= 0) {
     ds_plr1plr2->contact_turns_left = game.server.contactturns;
     ds_plr2plr1->contact_turns_left = game.server.contactturns;
+    metaknowledge_intel_invalidate();
   }
   if (ds_plr1plr2->type == DS_NO_CONTACT) {
     enum diplstate_type new_state = get_default_diplstate(pplayer1,
@@ -2850,6 +2975,7 @@ static struct player *split_player(struct player *pplayer)
         = old_research->inventions[i].bulbs_researched_saved;
     }
   } advance_index_iterate_end;
+  score_counters_invalidate();
   cplayer->phase_done = TRUE; /* Have other things to think
                                  about - paralysis */
   BV_CLR_ALL(cplayer->real_embassy);   /* All embassies destroyed */
@@ -2871,6 +2997,7 @@ static struct player *split_player(struct player *pplayer)
   old_research->bulbs_researched = 0;
   old_research->researching_saved = A_UNKNOWN;
   BV_CLR_ALL(pplayer->real_embassy);   /* All embassies destroyed */
+  metaknowledge_intel_invalidate();
 
   /* Give split player the embassies to their team mates back, if any */
   if (pplayer->team) {
@@ -3106,6 +3233,9 @@ struct player *civil_war(struct player *pplayer)
   /* Number to try to flip; ensure that at least one eligible city is
    * flipped */
   i = MAX(j/2, 1);
+  /* Cork the connections so the whole set of defections arrives at each
+   * client in one flush. */
+  conn_list_do_buffer(game.est_connections);
   city_list_iterate(defector_candidates, pcity) {
     fc_assert_action(!is_capital(pcity), continue);
     if (i >= j || (i > 0 && fc_rand(2) == 1)) {
@@ -3130,6 +3260,7 @@ struct player *civil_war(struct player *pplayer)
     }
     j--;
   } city_list_iterate_end;
+  conn_list_do_unbuffer(game.est_connections);
 
   city_list_destroy(defector_candidates);
 
@@ -84,6 +84,9 @@ void player_update_last_war_action(struct player *pplayer);
 void player_info_freeze(void);
 void player_info_thaw(void);
 
+void player_info_batch_start(void);
+void player_info_batch_flush(void);
+
 void send_player_all_c(struct player *src, struct conn_list *dest);
 void send_player_info_c(struct player *src, struct conn_list *dest);
 void send_player_diplstate_c(struct player *src, struct conn_list *dest);
@@ -268,6 +268,20 @@ static struct dem_col {
   char key;
 } coltable[] = {{'q'}, {'r'}, {'b'}}; /* Corresponds to dem_flag enum */
 
+/* Cached demographics. Every row value is derived from the per-player
+ * score struct, so the values, ranks and leaders can only change when
+ * the scores are recalculated or a player dies, joins or leaves. They
+ * are computed once here when that happens instead of on every
+ * demographics request, which web clients tend to poll; serving a
+ * request is then pure formatting. */
+static struct dem_stat {
+  int value[MAX_NUM_PLAYER_SLOTS];
+  int place[MAX_NUM_PLAYER_SLOTS];
+  struct player *best;
+} dem_stats[ARRAY_SIZE(rowtable)];
+static bool dem_stats_valid = FALSE;
+static int dem_stats_players = -1;
+
 /* Prime number of entries makes for better scaling */
 static const char *ranking[] = {
   /* TRANS: <#>: The <ranking> Poles */
@@ -1088,15 +1102,72 @@ static const char *culture_to_text(int value)
   return value_units(value, PL_(" point", " points", value));
 }
 
+/**********************************************************************//**
+  Throw the cached demographics away. Call when something that feeds
+  them changes; they are recomputed on the next demographics request.
+**************************************************************************/
+void demographics_invalidate(void)
+{
+  dem_stats_valid = FALSE;
+}
+
+/**********************************************************************//**
+  Recompute the cached value, rank and leader of every demographics
+  row for every player.
+**************************************************************************/
+static void dem_stats_refresh(void)
+{
+  int i;
+
+  for (i = 0; i < ARRAY_SIZE(rowtable); i++) {
+    const struct dem_row *prow = &rowtable[i];
+    struct dem_stat *pstat = &dem_stats[i];
+
+    pstat->best = nullptr;
+    players_iterate(pplayer) {
+      int value = prow->get_value(pplayer);
+
+      pstat->value[player_index(pplayer)] = value;
+      if (GOOD_PLAYER(pplayer)
+          && (pstat->best == nullptr
+              || (prow->greater_values_are_better
+                  && value > pstat->value[player_index(pstat->best)])
+              || (!prow->greater_values_are_better
+                  && value < pstat->value[player_index(pstat->best)]))) {
+        pstat->best = pplayer;
+      }
+    } players_iterate_end;
+
+    players_iterate(pplayer) {
+      int basis = pstat->value[player_index(pplayer)];
+      int place = 1;
+
+      players_iterate(other) {
+        if (GOOD_PLAYER(other)
+            && ((prow->greater_values_are_better
+                 && pstat->value[player_index(other)] > basis)
+                || (!prow->greater_values_are_better
+                    && pstat->value[player_index(other)] < basis))) {
+          place++;
+        }
+      } players_iterate_end;
+      pstat->place[player_index(pplayer)] = place;
+    } players_iterate_end;
+  }
+
+  dem_stats_valid = TRUE;
+  dem_stats_players = player_count();
+}
+
 /**********************************************************************//**
   Construct one demographics line.
 **************************************************************************/
 static void dem_line_item(char *outptr, size_t out_size,
                           struct player *pplayer, struct dem_row *prow,
-                          bv_cols selcols)
+                          const struct dem_stat *pstat, bv_cols selcols)
 {
   if (pplayer != nullptr && BV_ISSET(selcols, DEM_COL_QUANTITY)) {
-    const char *text = prow->to_text(prow->get_value(pplayer));
+    const char *text = prow->to_text(pstat->value[player_index(pplayer)]);
 
     cat_snprintf(outptr, out_size, " %s", text);
     cat_snprintf(outptr, out_size, "%*s",
@@ -1104,45 +1175,31 @@ static void dem_line_item(char *outptr, size_t out_size,
   }
 
   if (pplayer != nullptr && BV_ISSET(selcols, DEM_COL_RANK)) {
-    int basis = prow->get_value(pplayer);
-    int place = 1;
-
-    players_iterate(other) {
-      if (GOOD_PLAYER(other)
-          && ((prow->greater_values_are_better
-               && prow->get_value(other) > basis)
-              || (!prow->greater_values_are_better
-                  && prow->get_value(other) < basis))) {
-        place++;
-      }
-    } players_iterate_end;
-
-    cat_snprintf(outptr, out_size, _("(ranked %d)"), place);
+    cat_snprintf(outptr, out_size, _("(ranked %d)"),
+                 pstat->place[player_index(pplayer)]);
   }
 
   if (pplayer == nullptr || BV_ISSET(selcols, DEM_COL_BEST)) {
-    struct player *best_player = pplayer;
-    int best_value = (pplayer != nullptr) ? prow->get_value(pplayer) : 0;
-
-    players_iterate(other) {
-      if (GOOD_PLAYER(other)) {
-        int value = prow->get_value(other);
-
-        if (!best_player
-            || (prow->greater_values_are_better && value > best_value)
-            || (!prow->greater_values_are_better && value < best_value)) {
-          best_player = other;
-          best_value = value;
-        }
+    struct player *best_player = pstat->best;
+
+    if (pplayer != nullptr && best_player != nullptr) {
+      /* The requesting player keeps the top spot unless somebody is
+       * strictly better, as the old full scan did. */
+      int own = pstat->value[player_index(pplayer)];
+      int best = pstat->value[player_index(best_player)];
+
+      if (prow->greater_values_are_better ? own >= best : own <= best) {
+        best_player = pplayer;
       }
-    } players_iterate_end;
+    }
 
-    if (pplayer == nullptr
-        || (team_has_embassy(pplayer->team, best_player)
-            && (pplayer != best_player))) {
+    if (best_player != nullptr
+        && (pplayer == nullptr
+            || (team_has_embassy(pplayer->team, best_player)
+                && (pplayer != best_player)))) {
       cat_snprintf(outptr, out_size, "   %s: %s",
                    nation_plural_for_player(best_player),
-                   prow->to_text(prow->get_value(best_player)));
+                   prow->to_text(pstat->value[player_index(best_player)]));
     }
   }
 }
@@ -1247,6 +1304,10 @@ void report_demographics(struct connection *pconn)
     civbuf[0] = '\0';
   }
 
+  if (!dem_stats_valid || dem_stats_players != player_count()) {
+    dem_stats_refresh();
+  }
+
   buffer[0] = '\0';
   for (i = 0; i < ARRAY_SIZE(rowtable); i++) {
     if (strchr(game.server.demography, rowtable[i].key)) {
@@ -1255,7 +1316,8 @@ void report_demographics(struct connection *pconn)
       cat_snprintf(buffer, sizeof(buffer), "%s", name);
       cat_snprintf(buffer, sizeof(buffer), "%*s",
                    18 - (int) get_internal_string_length(name), "");
-      dem_line_item(buffer, sizeof(buffer), pplayer, &rowtable[i], selcols);
+      dem_line_item(buffer, sizeof(buffer), pplayer, &rowtable[i],
+                    &dem_stats[i], selcols);
       sz_strlcat(buffer, "\n");
     }
   }
@@ -39,6 +39,7 @@ void report_wonders_of_the_world(struct conn_list *dest);
 void report_wonders_of_the_world_long(struct conn_list *dest);
 void report_top_cities(struct conn_list *dest);
 bool is_valid_demography(const char *demography, int *error);
+void demographics_invalidate(void);
 void report_demographics(struct connection *pconn);
 void report_achievements(struct connection *pconn);
 void report_final_scores(struct conn_list *dest);
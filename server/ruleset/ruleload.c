@@ -21,15 +21,19 @@
 #include <string.h>
 
 /* utility */
+#include "astring.h"
 #include "bitvector.h"
 #include "deprecations.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "registry.h"
+#include "registry_bin.h"
 #include "shared.h"
 #include "string_vector.h"
 #include "support.h"
+#include "timing.h"
 
 /* common */
 #include "accessarea.h"
@@ -64,6 +68,7 @@
 #include "traderoutes.h"
 #include "unit.h"
 #include "unittype.h"
+#include "version.h"
 
 /* server */
 #include "citytools.h"
@@ -578,6 +583,270 @@ char *get_parser_buffer(void)
   return parser_buffer;
 }
 
+/* Parsed ruleset cache. The .ruleset files of a ruleset directory are
+ * cached under the freeciv storage directory in the binary registry
+ * format after the first parse, together with a manifest of the source
+ * files and their modification times. Later startups reuse the cached
+ * files as long as the manifest still matches, skipping the ini
+ * tokenizing that dominates a cold ruleset load. The cache holds the
+ * files exactly as parsed - before any compat conversion - so a hit is
+ * indistinguishable from a fresh parse. */
+#define RSCACHE_FORMAT_VERSION 1
+
+static bool rscache_hit = FALSE;
+static char rscache_rsdir[512] = "";
+static struct astring rscache_manifest = ASTRING_INIT;
+
+/**********************************************************************//**
+  Write the cache path of the ruleset file 'name' of 'rsdir' to 'buf'.
+  Directory separators in the names are flattened so that they cannot
+  escape the cache directory.
+**************************************************************************/
+static void rscache_file_path(char *buf, size_t buf_len,
+                              const char *rsdir, const char *name)
+{
+  char *i;
+
+  fc_snprintf(buf, buf_len, "%s" DIR_SEPARATOR "rscache" DIR_SEPARATOR
+              "%s.%s.fcb", freeciv_storage_dir(), rsdir, name);
+  for (i = buf + strlen(freeciv_storage_dir()) + strlen(DIR_SEPARATOR)
+         + strlen("rscache") + strlen(DIR_SEPARATOR);
+       *i != '\0'; i++) {
+    if (*i == '/' || *i == '\\') {
+      *i = '_';
+    }
+  }
+}
+
+/**********************************************************************//**
+  Build the manifest describing the current on-disk state of 'rsdir':
+  one line per .ruleset file in the ruleset directory or the default
+  directory of any data path, with its modification time. Those are the
+  only places valid_ruleset_filename() and the conventional *include
+  targets live in.
+**************************************************************************/
+static void rscache_manifest_build(const char *rsdir,
+                                   struct astring *manifest)
+{
+  struct strvec *dirs = strvec_new();
+  struct fileinfo_list *files;
+
+  strvec_iterate(get_data_dirs(), dirname) {
+    char subdir[512];
+
+    fc_snprintf(subdir, sizeof(subdir), "%s" DIR_SEPARATOR "%s",
+                dirname, rsdir);
+    strvec_append(dirs, subdir);
+    fc_snprintf(subdir, sizeof(subdir), "%s" DIR_SEPARATOR "default",
+                dirname);
+    strvec_append(dirs, subdir);
+  } strvec_iterate_end;
+
+  astr_clear(manifest);
+  files = fileinfolist_infix(dirs, "." RULES_SUFFIX, FALSE);
+  fileinfo_list_iterate(files, pfile) {
+    astr_add(manifest, "%s %lld\n", pfile->fullname,
+             (long long) pfile->mtime);
+  } fileinfo_list_iterate_end;
+  fileinfo_list_destroy(files);
+  strvec_destroy(dirs);
+}
+
+/**********************************************************************//**
+  Decide whether the cached files of 'rsdir' may be used for this load.
+  Called once per load_rulesetdir() run.
+**************************************************************************/
+static void rscache_prepare(const char *rsdir)
+{
+  char mpath[512];
+  struct section_file *manifest_file;
+
+  rscache_hit = FALSE;
+  sz_strlcpy(rscache_rsdir, rsdir);
+  rscache_manifest_build(rsdir, &rscache_manifest);
+
+  fc_snprintf(mpath, sizeof(mpath), "%s" DIR_SEPARATOR "rscache",
+              freeciv_storage_dir());
+  if (!make_dir(mpath, DIRMODE_DEFAULT)) {
+    log_verbose("Could not create ruleset cache directory \"%s\".", mpath);
+  }
+
+  rscache_file_path(mpath, sizeof(mpath), rsdir, "manifest");
+  manifest_file = binfile_load(mpath, FALSE);
+  if (manifest_file != NULL) {
+    const char *stored;
+
+    if (RSCACHE_FORMAT_VERSION
+        == secfile_lookup_int_default(manifest_file, -1, "cache.format")
+        && 0 == fc_strcasecmp(fc_comparable_version(),
+                              secfile_lookup_str_default(manifest_file, "",
+                                                         "cache.fcversion"))
+        && (stored = secfile_lookup_str_default(manifest_file, NULL,
+                                                "cache.manifest")) != NULL
+        && 0 == strcmp(stored, astr_str(&rscache_manifest))) {
+      rscache_hit = TRUE;
+      log_verbose("Using cached ruleset parse for \"%s\".", rsdir);
+    }
+    secfile_destroy(manifest_file);
+  }
+}
+
+/**********************************************************************//**
+  Record that the cached files written during this load describe the
+  manifest built by rscache_prepare(). Called only after every ruleset
+  file was parsed and cached successfully; until the manifest exists any
+  partially written cache is simply never used.
+**************************************************************************/
+static void rscache_commit(const char *rsdir)
+{
+  char mpath[512];
+  struct section_file *manifest_file;
+
+  if (rscache_hit || astr_empty(&rscache_manifest)) {
+    /* Loaded from the cache, or never prepared. */
+    return;
+  }
+
+  manifest_file = secfile_new(FALSE);
+  secfile_insert_int(manifest_file, RSCACHE_FORMAT_VERSION, "cache.format");
+  secfile_insert_str(manifest_file, fc_comparable_version(),
+                     "cache.fcversion");
+  secfile_insert_str(manifest_file, astr_str(&rscache_manifest),
+                     "cache.manifest");
+
+  rscache_file_path(mpath, sizeof(mpath), rsdir, "manifest");
+  if (!secfile_save_bin(manifest_file, mpath, 0, FZ_PLAIN)) {
+    log_verbose("Could not write ruleset cache manifest \"%s\".", mpath);
+  }
+  secfile_destroy(manifest_file);
+}
+
+/* Per-phase wall clock reporting of load_rulesetdir(), for the
+ * --ruleset-bench server option. Off by default; when off the cost is
+ * one branch per phase boundary. */
+static bool ruleset_bench = FALSE;
+static struct timer *rsbench_timer = NULL;
+static double rsbench_total = 0.0;
+
+/**********************************************************************//**
+  Enable or disable per-phase timing of ruleset loading.
+**************************************************************************/
+void ruleset_bench_enable(bool enable)
+{
+  ruleset_bench = enable;
+}
+
+/**********************************************************************//**
+  Start timing a ruleset load; the first phase begins now.
+**************************************************************************/
+static void rsbench_begin(void)
+{
+  if (!ruleset_bench) {
+    return;
+  }
+  rsbench_timer = timer_renew(rsbench_timer, TIMER_USER, TIMER_ACTIVE,
+                              rsbench_timer != NULL
+                              ? NULL : "ruleset-bench");
+  rsbench_total = 0.0;
+  timer_clear(rsbench_timer);
+  timer_start(rsbench_timer);
+}
+
+/**********************************************************************//**
+  Report the wall time of the phase that just ended, and begin timing
+  the next one.
+**************************************************************************/
+static void rsbench_phase(const char *phase)
+{
+  double secs;
+
+  if (!ruleset_bench) {
+    return;
+  }
+  timer_stop(rsbench_timer);
+  secs = timer_read_seconds(rsbench_timer);
+  rsbench_total += secs;
+  log_normal("ruleset-bench: phase=%s wall=%.6f", phase, secs);
+  timer_clear(rsbench_timer);
+  timer_start(rsbench_timer);
+}
+
+/**********************************************************************//**
+  Report the total for the load. The last phase must already have been
+  closed with rsbench_phase().
+**************************************************************************/
+static void rsbench_end(bool ok)
+{
+  if (!ruleset_bench) {
+    return;
+  }
+  timer_stop(rsbench_timer);
+  log_normal("ruleset-bench-total: wall=%.6f ok=%d",
+             rsbench_total, ok ? 1 : 0);
+}
+
+/* One ruleset file of the parallel parse phase of load_rulesetdir(). */
+struct ruleset_parse_job {
+  const char *whichset;
+  char sfilename[512];
+  char cfilename[512];
+  bool cached;                  /* Try the parse cache first */
+  bool started;                 /* Worker thread running */
+  struct section_file *secfile;
+  char error[512];
+  double parse_secs;            /* Valid only under --ruleset-bench */
+  fc_thread thread;
+};
+
+/**********************************************************************//**
+  Parse one ruleset file. Works only on job-local state; include
+  resolution is serialized inside the inputfile module, and each job
+  writes its own cache file.
+**************************************************************************/
+static void ruleset_parse_job_run(struct ruleset_parse_job *job)
+{
+  if (job->cached) {
+    job->secfile = binfile_load(job->cfilename, FALSE);
+    if (job->secfile != NULL) {
+      return;
+    }
+    /* Cache file lost; fall back to a fresh parse. */
+  }
+
+  job->secfile = secfile_load(job->sfilename, FALSE);
+  if (job->secfile == NULL) {
+    /* Copy right away; the registry error buffer is shared. */
+    sz_strlcpy(job->error, secfile_error());
+  } else if (!secfile_save_bin(job->secfile, job->cfilename, 0, FZ_PLAIN)) {
+    log_verbose("Could not write ruleset cache file \"%s\".",
+                job->cfilename);
+  }
+}
+
+/**********************************************************************//**
+  Worker for the parallel parse phase of load_rulesetdir().
+**************************************************************************/
+static void ruleset_parse_thread(void *data)
+{
+  struct ruleset_parse_job *job = data;
+  struct timer *ptimer = NULL;
+
+  if (ruleset_bench) {
+    /* Job-local timer; the shared bench timer stays with the
+     * coordinating thread. */
+    ptimer = timer_new(TIMER_USER, TIMER_ACTIVE, "ruleset-bench parse");
+    timer_start(ptimer);
+  }
+
+  ruleset_parse_job_run(job);
+
+  if (ptimer != NULL) {
+    timer_stop(ptimer);
+    job->parse_secs = timer_read_seconds(ptimer);
+    timer_destroy(ptimer);
+  }
+}
+
 /**********************************************************************//**
   Do initial section_file_load on a ruleset file.
   "whichset" = "techs", "units", "buildings", "terrain", ...
@@ -586,10 +855,22 @@ static struct section_file *openload_ruleset_file(const char *whichset,
                                                   const char *rsdir)
 {
   char sfilename[512];
-  const char *dfilename = valid_ruleset_filename(rsdir, whichset,
-                                                 RULES_SUFFIX, FALSE);
+  char cfilename[512];
+  const char *dfilename;
   struct section_file *secfile;
 
+  rscache_file_path(cfilename, sizeof(cfilename), rsdir, whichset);
+  if (rscache_hit && 0 == strcmp(rsdir, rscache_rsdir)) {
+    secfile = binfile_load(cfilename, FALSE);
+    if (secfile != NULL) {
+      return secfile;
+    }
+    /* Cache file lost; fall back to a fresh parse. */
+  }
+
+  dfilename = valid_ruleset_filename(rsdir, whichset,
+                                     RULES_SUFFIX, FALSE);
+
   if (dfilename == NULL) {
     return NULL;
   }
@@ -602,6 +883,12 @@ static struct section_file *openload_ruleset_file(const char *whichset,
   if (secfile == NULL) {
     ruleset_error(NULL, LOG_ERROR, "Could not load ruleset '%s':\n%s",
                   sfilename, secfile_error());
+  } else {
+    /* Refresh the parse cache. Written before any compat conversion
+     * touches the loaded file. */
+    if (!secfile_save_bin(secfile, cfilename, 0, FZ_PLAIN)) {
+      log_verbose("Could not write ruleset cache file \"%s\".", cfilename);
+    }
   }
 
   return secfile;
@@ -785,6 +1072,10 @@ struct requirement_vector *lookup_req_list(struct section_file *file,
     requirement_vector_append(&reqs_list, req);
   }
 
+  /* Fold constant requirements away and order the rest by evaluation
+   * cost before the callers copy the vector. */
+  requirement_vector_compile(&reqs_list);
+
   return &reqs_list;
 }
 
@@ -9559,17 +9850,87 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
 
   server.playable_nations = 0;
 
-  gamefile = openload_ruleset_file("game", rsdir);
-  techfile = openload_ruleset_file("techs", rsdir);
-  actionfile = openload_ruleset_file("actions", rsdir);
-  buildfile = openload_ruleset_file("buildings", rsdir);
-  govfile = openload_ruleset_file("governments", rsdir);
-  unitfile = openload_ruleset_file("units", rsdir);
-  terrfile = openload_ruleset_file("terrain", rsdir);
-  stylefile = openload_ruleset_file("styles", rsdir);
-  cityfile = openload_ruleset_file("cities", rsdir);
-  nationfile = openload_ruleset_file("nations", rsdir);
-  effectfile = openload_ruleset_file("effects", rsdir);
+  rscache_prepare(rsdir);
+
+  rsbench_begin();
+
+  {
+    /* The per-file parses are independent until the names are loaded,
+     * so run them all on worker threads. Filename resolution stays on
+     * this thread; fileinfoname() is not thread-safe. */
+    struct ruleset_parse_job jobs[] = {
+      { .whichset = "game" },
+      { .whichset = "techs" },
+      { .whichset = "actions" },
+      { .whichset = "buildings" },
+      { .whichset = "governments" },
+      { .whichset = "units" },
+      { .whichset = "terrain" },
+      { .whichset = "styles" },
+      { .whichset = "cities" },
+      { .whichset = "nations" },
+      { .whichset = "effects" }
+    };
+    int i;
+
+    for (i = 0; i < (int) ARRAY_SIZE(jobs); i++) {
+      struct ruleset_parse_job *job = &jobs[i];
+      const char *dfilename = valid_ruleset_filename(rsdir, job->whichset,
+                                                     RULES_SUFFIX, FALSE);
+
+      if (dfilename == NULL) {
+        continue;
+      }
+      sz_strlcpy(job->sfilename, dfilename);
+      rscache_file_path(job->cfilename, sizeof(job->cfilename),
+                        rsdir, job->whichset);
+      job->cached = rscache_hit;
+      job->started = (fc_thread_start(&job->thread,
+                                      ruleset_parse_thread, job) == 0);
+      if (!job->started) {
+        /* Parse on this thread instead. */
+        ruleset_parse_thread(job);
+      }
+    }
+
+    for (i = 0; i < (int) ARRAY_SIZE(jobs); i++) {
+      struct ruleset_parse_job *job = &jobs[i];
+
+      if (job->started) {
+        fc_thread_wait(&job->thread);
+      }
+      if (job->secfile == NULL && job->sfilename[0] != '\0') {
+        ruleset_error(NULL, LOG_ERROR, "Could not load ruleset '%s':\n%s",
+                      job->sfilename, job->error);
+      }
+    }
+
+    if (ruleset_bench) {
+      /* Per-file parse times. These overlap; the "parse" phase below is
+       * the wall time of the whole parallel part. */
+      for (i = 0; i < (int) ARRAY_SIZE(jobs); i++) {
+        if (jobs[i].sfilename[0] != '\0') {
+          log_normal("ruleset-bench: file=%s wall=%.6f cached=%d",
+                     jobs[i].whichset, jobs[i].parse_secs,
+                     jobs[i].cached ? 1 : 0);
+        }
+      }
+    }
+
+    gamefile = jobs[0].secfile;
+    techfile = jobs[1].secfile;
+    actionfile = jobs[2].secfile;
+    buildfile = jobs[3].secfile;
+    govfile = jobs[4].secfile;
+    unitfile = jobs[5].secfile;
+    terrfile = jobs[6].secfile;
+    stylefile = jobs[7].secfile;
+    cityfile = jobs[8].secfile;
+    nationfile = jobs[9].secfile;
+    effectfile = jobs[10].secfile;
+  }
+
+  rsbench_phase("parse");
 
   if (load_luadata) {
     game.server.luadata = openload_luadata_file(rsdir);
@@ -9591,6 +9952,11 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
     ok = FALSE;
   }
 
+  if (ok) {
+    /* Every file parsed and cached; make the cache usable next time. */
+    rscache_commit(rsdir);
+  }
+
   if (ok) {
     /* Note: Keep load_game_names() first so that compat_info.version is
      * correctly initialized. */
@@ -9609,39 +9975,52 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
     ok = rscompat_names(&compat_info);
   }
 
+  rsbench_phase("names");
+
   if (ok) {
     ok = load_ruleset_techs(techfile, &compat_info);
+    rsbench_phase("techs");
   }
   if (ok) {
     ok = load_ruleset_styles(stylefile, &compat_info);
+    rsbench_phase("styles");
   }
   if (ok) {
     ok = load_ruleset_cities(cityfile, &compat_info);
+    rsbench_phase("cities");
   }
   if (ok) {
     ok = load_ruleset_governments(govfile, &compat_info);
+    rsbench_phase("governments");
   }
   if (ok) {
     /* Terrain must precede nations and units */
     ok = load_ruleset_terrain(terrfile, &compat_info);
+    rsbench_phase("terrain");
   }
   if (ok) {
     ok = load_ruleset_units(unitfile, &compat_info);
+    rsbench_phase("units");
   }
   if (ok) {
     ok = load_ruleset_buildings(buildfile, &compat_info);
+    rsbench_phase("buildings");
   }
   if (ok) {
     ok = load_ruleset_nations(nationfile, &compat_info);
+    rsbench_phase("nations");
   }
   if (ok) {
     ok = load_ruleset_effects(effectfile, &compat_info);
+    rsbench_phase("effects");
   }
   if (ok) {
     ok = load_ruleset_actions(actionfile, gamefile, &compat_info);
+    rsbench_phase("actions");
   }
   if (ok) {
     ok = load_ruleset_game(gamefile, act, &compat_info);
+    rsbench_phase("game");
   }
 
   if (ok) {
@@ -9658,6 +10037,9 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
 
     ok = autoadjust_ruleset_data()
       && sanity_check_ruleset_data(&compat_info);
+
+    /* Requirement and action caches plus the sanity pass over them. */
+    rsbench_phase("precalc+sanity");
   }
 
   if (ok) {
@@ -9669,6 +10051,8 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
     if (ok) {
       secfile_check_unused(gamefile);
     }
+
+    rsbench_phase("settings");
   }
 
   nullcheck_secfile_destroy(techfile);
@@ -9708,6 +10092,8 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
     rscompat_postprocess(&compat_info);
   }
 
+  rsbench_phase("cleanup+compat");
+
   if (ok) {
     char **buffer = buffer_script ? &script_buffer : NULL;
 
@@ -9736,6 +10122,8 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
     ok = (openload_script_file("default", rsdir, NULL, FALSE) == TRI_YES);
   }
 
+  rsbench_phase("script");
+
   if (ok && act) {
     /* Populate remaining caches. */
     techs_precalc_data();
@@ -9756,8 +10144,12 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
     /* We may need to adjust the number of AI players
      * if the number of available nations changed. */
     (void) aifill(game.info.aifill);
+
+    rsbench_phase("unit+improvement caches");
   }
 
+  rsbench_end(ok);
+
   return ok;
 }
 
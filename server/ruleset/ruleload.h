@@ -45,6 +45,7 @@ bool load_rulesets(const char *restore, const char *alt, bool compat_mode,
                    rs_conversion_logger logger,
                    bool act, bool buffer_script, bool load_luadata);
 bool reload_rulesets_settings(void);
+void ruleset_bench_enable(bool enable);
 void send_rulesets(struct conn_list *dest);
 
 void rulesets_deinit(void);
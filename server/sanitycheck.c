@@ -18,6 +18,9 @@
 /* utility */
 #include "bitvector.h"
 #include "log.h"
+#include "mem.h"
+#include "shared.h"
+#include "timing.h"
 
 /* common */
 #include "city.h"
@@ -76,6 +79,189 @@
 static void check_city_feelings(const struct city *pcity, const char *file,
                                 const char *function, int line);
 
+/* While positive, sanity_check_city() and sanity_check_tile() only queue
+ * the object; sanity_check_defer_end() then verifies every queued object
+ * exactly once. This coalesces the repeated checks of the same city that
+ * turn-end processing would otherwise run back to back. */
+static int defer_depth = 0;
+
+struct deferred_check {
+  int id;                       /* City id or tile index. */
+  const char *file;             /* Call site that first queued the check. */
+  const char *function;
+  int line;
+};
+
+static struct deferred_check *deferred_cities = NULL;
+static int deferred_city_count = 0;
+static int deferred_city_capacity = 0;
+
+static struct deferred_check *deferred_tiles = NULL;
+static int deferred_tile_count = 0;
+static int deferred_tile_capacity = 0;
+
+static bool full_check_queued = FALSE;
+static struct deferred_check full_check_origin;
+
+/* Cost accounting, so the log can tell which checks are cheap enough
+ * to leave enabled. The single timer is reused; 'check_timer_busy'
+ * keeps checks nested inside the full check from restarting it. */
+static struct timer *check_timer = NULL;
+static bool check_timer_busy = FALSE;
+static double city_check_seconds = 0.0;
+static double tile_check_seconds = 0.0;
+static double full_check_seconds = 0.0;
+static int city_check_runs = 0;
+static int tile_check_runs = 0;
+static int full_check_runs = 0;
+static int city_checks_merged = 0;
+static int tile_checks_merged = 0;
+static int full_checks_merged = 0;
+
+/**********************************************************************//**
+  Start timing a check, creating the (reused) timer at first need.
+**************************************************************************/
+static void check_timer_begin(void)
+{
+  if (check_timer == NULL) {
+    check_timer = timer_new(TIMER_CPU, TIMER_ACTIVE, "sanitycheck");
+  }
+  timer_clear(check_timer);
+  timer_start(check_timer);
+}
+
+/**********************************************************************//**
+  Stop timing and return the seconds the check took.
+**************************************************************************/
+static double check_timer_end(void)
+{
+  timer_stop(check_timer);
+  return timer_read_seconds(check_timer);
+}
+
+/**********************************************************************//**
+  Queue a city for verification when the deferred section ends.
+**************************************************************************/
+static void defer_city_check(const struct city *pcity, const char *file,
+                             const char *function, int line)
+{
+  int i;
+
+  for (i = 0; i < deferred_city_count; i++) {
+    if (deferred_cities[i].id == pcity->id) {
+      city_checks_merged++;
+      return;
+    }
+  }
+
+  if (deferred_city_count >= deferred_city_capacity) {
+    deferred_city_capacity = MAX(deferred_city_capacity * 2, 32);
+    deferred_cities = fc_realloc(deferred_cities,
+                                 deferred_city_capacity
+                                 * sizeof(*deferred_cities));
+  }
+  deferred_cities[deferred_city_count].id = pcity->id;
+  deferred_cities[deferred_city_count].file = file;
+  deferred_cities[deferred_city_count].function = function;
+  deferred_cities[deferred_city_count].line = line;
+  deferred_city_count++;
+}
+
+/**********************************************************************//**
+  Queue a tile for verification when the deferred section ends.
+**************************************************************************/
+static void defer_tile_check(const struct tile *ptile, const char *file,
+                             const char *function, int line)
+{
+  int i, id = tile_index(ptile);
+
+  for (i = 0; i < deferred_tile_count; i++) {
+    if (deferred_tiles[i].id == id) {
+      tile_checks_merged++;
+      return;
+    }
+  }
+
+  if (deferred_tile_count >= deferred_tile_capacity) {
+    deferred_tile_capacity = MAX(deferred_tile_capacity * 2, 32);
+    deferred_tiles = fc_realloc(deferred_tiles,
+                                deferred_tile_capacity
+                                * sizeof(*deferred_tiles));
+  }
+  deferred_tiles[deferred_tile_count].id = id;
+  deferred_tiles[deferred_tile_count].file = file;
+  deferred_tiles[deferred_tile_count].function = function;
+  deferred_tiles[deferred_tile_count].line = line;
+  deferred_tile_count++;
+}
+
+/**********************************************************************//**
+  Enter a deferred section: until the matching sanity_check_defer_end(),
+  object checks are queued instead of run. Sections nest.
+**************************************************************************/
+void sanity_check_defer_begin(void)
+{
+  defer_depth++;
+}
+
+/**********************************************************************//**
+  Leave a deferred section. When the outermost section ends, verify each
+  queued object exactly once, attributed to the call site that first
+  queued it. Objects removed since being queued are skipped.
+**************************************************************************/
+void sanity_check_defer_end(void)
+{
+  int i;
+
+  fc_assert_ret(defer_depth > 0);
+
+  if (--defer_depth > 0) {
+    return;
+  }
+
+  for (i = 0; i < deferred_city_count; i++) {
+    struct deferred_check *pcheck = deferred_cities + i;
+    struct city *pcity = game_city_by_number(pcheck->id);
+
+    if (pcity != NULL) {
+      real_sanity_check_city(pcity, pcheck->file, pcheck->function,
+                             pcheck->line);
+    }
+  }
+  deferred_city_count = 0;
+
+  for (i = 0; i < deferred_tile_count; i++) {
+    struct deferred_check *pcheck = deferred_tiles + i;
+    struct tile *ptile = index_to_tile(&(wld.map), pcheck->id);
+
+    if (ptile != NULL) {
+      real_sanity_check_tile(ptile, pcheck->file, pcheck->function,
+                             pcheck->line);
+    }
+  }
+  deferred_tile_count = 0;
+
+  if (full_check_queued) {
+    full_check_queued = FALSE;
+    real_sanity_check(full_check_origin.file, full_check_origin.function,
+                      full_check_origin.line);
+  }
+}
+
+/**********************************************************************//**
+  Log how much time the sanity checks have consumed so far, and how many
+  redundant requests deferred sections merged away.
+**************************************************************************/
+void sanity_check_report(void)
+{
+  log_verbose("sanity checks: %d full in %.3f sec (%d merged), "
+              "%d city in %.3f sec (%d merged), "
+              "%d tile in %.3f sec (%d merged)",
+              full_check_runs, full_check_seconds, full_checks_merged,
+              city_check_runs, city_check_seconds, city_checks_merged,
+              tile_check_runs, tile_check_seconds, tile_checks_merged);
+}
+
 /**********************************************************************//**
   Sanity checking on map (tile) specials.
 **************************************************************************/
@@ -389,10 +575,28 @@ static void check_city_feelings(const struct city *pcity, const char *file,
 void real_sanity_check_city(struct city *pcity, const char *file,
                             const char *function, int line)
 {
+  bool timed = !check_timer_busy;
+
+  if (defer_depth > 0) {
+    defer_city_check(pcity, file, function, line);
+    return;
+  }
+
+  if (timed) {
+    check_timer_busy = TRUE;
+    check_timer_begin();
+  }
+
   if (check_city_good(pcity, file, function, line)) {
     check_city_size(pcity, file, function, line);
     check_city_feelings(pcity, file, function, line);
   }
+
+  if (timed) {
+    city_check_seconds += check_timer_end();
+    city_check_runs++;
+    check_timer_busy = FALSE;
+  }
 }
 
 /**********************************************************************//**
@@ -675,6 +879,25 @@ static void check_connections(const char *file, const char *function,
 **************************************************************************/
 void real_sanity_check(const char *file, const char *function, int line)
 {
+  bool timed = !check_timer_busy;
+
+  if (defer_depth > 0) {
+    if (full_check_queued) {
+      full_checks_merged++;
+    } else {
+      full_check_queued = TRUE;
+      full_check_origin.file = file;
+      full_check_origin.function = function;
+      full_check_origin.line = line;
+    }
+    return;
+  }
+
+  if (timed) {
+    check_timer_busy = TRUE;
+    check_timer_begin();
+  }
+
   if (!map_is_empty()) {
     /* Don't sanity-check the map if it hasn't been created yet (this
      * happens when loading scenarios). */
@@ -689,6 +912,12 @@ void real_sanity_check(const char *file, const char *function, int line)
   check_teams(file, function, line);
   check_researches(file, function, line);
   check_connections(file, function, line);
+
+  if (timed) {
+    full_check_seconds += check_timer_end();
+    full_check_runs++;
+    check_timer_busy = FALSE;
+  }
 }
 
 /**********************************************************************//**
@@ -698,6 +927,18 @@ void real_sanity_check(const char *file, const char *function, int line)
 void real_sanity_check_tile(struct tile *ptile, const char *file,
                             const char *function, int line)
 {
+  bool timed = !check_timer_busy;
+
+  if (defer_depth > 0 && ptile != NULL) {
+    defer_tile_check(ptile, file, function, line);
+    return;
+  }
+
+  if (timed) {
+    check_timer_busy = TRUE;
+    check_timer_begin();
+  }
+
   SANITY_CHECK(ptile != NULL);
   SANITY_CHECK(ptile->terrain != NULL);
 
@@ -711,6 +952,12 @@ void real_sanity_check_tile(struct tile *ptile, const char *file,
                   unit_rule_name(punit), tile_get_info_text(ptile, TRUE, 0));
     }
   } unit_list_iterate_end;
+
+  if (timed) {
+    tile_check_seconds += check_timer_end();
+    tile_check_runs++;
+    check_timer_busy = FALSE;
+  }
 }
 
 #endif /* SANITY_CHECKING */
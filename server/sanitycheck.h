@@ -36,12 +36,20 @@ void real_sanity_check_tile(struct tile *ptile, const char *file,
   real_sanity_check(__FILE__, __FUNCTION__, __FC_LINE__)
 void real_sanity_check( const char *file, const char *function, int line);
 
+void sanity_check_defer_begin(void);
+void sanity_check_defer_end(void);
+void sanity_check_report(void);
+
 #else /* SANITY_CHECKING */
 
 #  define sanity_check_city(x) (void)0
 #  define sanity_check_tile(x) (void)0
 #  define sanity_check() (void)0
 
+#  define sanity_check_defer_begin() (void)0
+#  define sanity_check_defer_end() (void)0
+#  define sanity_check_report() (void)0
+
 #endif /* SANITY_CHECKING */
 
 
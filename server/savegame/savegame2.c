@@ -3839,6 +3839,7 @@ static bool sg_load_player_city(struct loaddata *loading, struct player *plr,
       proute->partner = partner;
       proute->dir = RDIR_BIDIRECTIONAL;
       proute->goods = goods_by_number(0); /* First good */
+      proute->base_cache.valid = FALSE;
 
       trade_route_list_append(pcity->routes, proute);
     }
@@ -185,7 +185,13 @@ extern bool sg_success;
                      secpath, _line[_nat_x], _line[_nat_x]);                \
     }                                                                       \
     _line[MAP_NATIVE_WIDTH] = '\0';                                         \
-    secfile_insert_str(secfile, _line, secpath, ## __VA_ARGS__, _nat_y);    \
+    {                                                                       \
+      /* Worst case is four output chars per tile ("*1**"). */              \
+      char _rle_buf[4 * MAP_NATIVE_WIDTH + 1];                              \
+                                                                            \
+      secfile_insert_str(secfile, map_line_rle_encode(_line, _rle_buf),     \
+                         secpath, ## __VA_ARGS__, _nat_y);                  \
+    }                                                                       \
   }                                                                         \
 }
 
@@ -220,9 +226,16 @@ extern bool sg_success;
 {                                                                           \
   int _nat_x, _nat_y;                                                       \
   bool _printed_warning = FALSE;                                            \
+  /* Relies on 'loading' being in scope at every caller. */                 \
+  bool _rle = (loading->secfile_options != NULL                             \
+               && has_capability("maprle", loading->secfile_options));      \
   for (_nat_y = 0; _nat_y < MAP_NATIVE_HEIGHT; _nat_y++) {                  \
     const char *_line = secfile_lookup_str(secfile, secpath,                \
                                            ## __VA_ARGS__, _nat_y);         \
+    char _rle_buf[MAP_NATIVE_WIDTH + 1];                                    \
+    if (_line != NULL && _rle) {                                            \
+      _line = map_line_rle_decode(_line, _rle_buf, sizeof(_rle_buf));       \
+    }                                                                       \
     if (NULL == _line) {                                                    \
       char buf[64];                                                         \
       fc_snprintf(buf, sizeof(buf), secpath, ## __VA_ARGS__, _nat_y);       \
@@ -276,7 +289,7 @@ struct savedata {
 #define TOKEN_SIZE 10
 
 static const char savefile_options_default[] =
-  " +version3";
+  " +version3 +maprle";
 /* The following savefile option are added if needed:
  *  - nothing at current version
  * See also calls to sg_save_savefile_options(). */
@@ -301,6 +314,9 @@ static enum unit_activity char2activity(char activity);
 static char *quote_block(const void *const data, int length);
 static int unquote_block(const char *const quoted_, void *dest,
                          int dest_length);
+static const char *map_line_rle_encode(const char *line, char *buf);
+static const char *map_line_rle_decode(const char *line, char *buf,
+                                       int buf_len);
 static void worklist_load(struct section_file *file, int wlist_max_length,
                           struct worklist *pwl, const char *path, ...);
 static void worklist_save(struct section_file *file,
@@ -578,6 +594,170 @@ static void savegame3_save_real(struct section_file *file,
   }
 }
 
+/************************************************************************//**
+  Strip a freshly serialized savegame down to a delta against the last
+  full save: drop the [map] section and the [player<i>] / [score<i>]
+  sections of every player whose delta counter has not advanced since
+  the base snapshot was taken, and record the base file and the players
+  alive right now in a [delta] section. The result is merged back over
+  the base save by savegame3_delta_merge() on load.
+****************************************************************************/
+void savegame3_delta_prune(struct section_file *file)
+{
+  int plrnos[MAX_NUM_PLAYER_SLOTS];
+  int plrcount = 0;
+  struct section *psection;
+
+  players_iterate(pplayer) {
+    plrnos[plrcount++] = player_number(pplayer);
+
+    if (pplayer->server.delta_counter == pplayer->server.delta_base) {
+      psection = secfile_section_lookup(file, "player%d",
+                                        player_number(pplayer));
+      if (psection != NULL) {
+        section_destroy(psection);
+      }
+      psection = secfile_section_lookup(file, "score%d",
+                                        player_number(pplayer));
+      if (psection != NULL) {
+        section_destroy(psection);
+      }
+    }
+  } players_iterate_end;
+
+  if (game.server.delta.map_counter == game.server.delta.map_base) {
+    psection = secfile_section_by_name(file, "map");
+    if (psection != NULL) {
+      section_destroy(psection);
+    }
+  }
+
+  secfile_insert_str(file, game.server.delta.base_path, "delta.base");
+  secfile_insert_int_vec(file, plrnos, plrcount, "delta.players");
+}
+
+/************************************************************************//**
+  Does 'name' consist of 'prefix' followed by nothing but a number?
+  The number is returned in 'number'.
+****************************************************************************/
+static bool delta_section_number(const char *name, const char *prefix,
+                                 int *number)
+{
+  size_t len = strlen(prefix);
+  char *end;
+
+  if (strncmp(name, prefix, len) != 0 || name[len] == '\0') {
+    return FALSE;
+  }
+
+  *number = strtol(name + len, &end, 10);
+
+  return *end == '\0';
+}
+
+/************************************************************************//**
+  Merge a delta savegame produced by savegame3_delta_prune() over its
+  full base save, leaving 'base' loadable as an ordinary savegame.
+  Returns FALSE if the delta file is malformed.
+****************************************************************************/
+bool savegame3_delta_merge(struct section_file *base,
+                           struct section_file *delta)
+{
+  size_t count, i;
+  int *plrnos;
+
+  plrnos = secfile_lookup_int_vec(delta, &count, "delta.players");
+  if (plrnos == NULL) {
+    log_error("Delta savegame carries no player list.");
+    return FALSE;
+  }
+
+  /* Base sections that must not survive the merge: players (and their
+   * scores) that no longer existed when the delta was written, and the
+   * treaty sections, which the delta always carries in full. */
+  section_list_iterate(secfile_sections(base), psection) {
+    const char *name = section_name(psection);
+    int number;
+
+    if (delta_section_number(name, "treaty", &number)) {
+      section_destroy(psection);
+    } else if (delta_section_number(name, "player", &number)
+               || delta_section_number(name, "score", &number)) {
+      bool alive = FALSE;
+
+      for (i = 0; i < count && !alive; i++) {
+        alive = (plrnos[i] == number);
+      }
+      if (!alive) {
+        section_destroy(psection);
+      }
+    }
+  } section_list_iterate_end;
+  free(plrnos);
+
+  /* Replace every base section the delta carries with the delta's
+   * version. */
+  section_list_iterate(secfile_sections(delta), dsection) {
+    const char *name = section_name(dsection);
+    struct section *bsection;
+
+    if (strcmp(name, "delta") != 0) {
+      bsection = secfile_section_by_name(base, name);
+      if (bsection != NULL) {
+        section_destroy(bsection);
+      }
+      bsection = secfile_section_new(base, name);
+
+      entry_list_iterate(section_entries(dsection), pentry) {
+        const char *ename = entry_name(pentry);
+
+        switch (entry_type_get(pentry)) {
+        case ENTRY_BOOL:
+          {
+            bool value;
+
+            entry_bool_get(pentry, &value);
+            section_entry_bool_new(bsection, ename, value);
+          }
+          break;
+        case ENTRY_INT:
+          {
+            int value;
+
+            entry_int_get(pentry, &value);
+            section_entry_int_new(bsection, ename, value);
+          }
+          break;
+        case ENTRY_FLOAT:
+          {
+            float value;
+
+            entry_float_get(pentry, &value);
+            section_entry_float_new(bsection, ename, value);
+          }
+          break;
+        case ENTRY_STR:
+          {
+            const char *value;
+
+            entry_str_get(pentry, &value);
+            section_entry_str_new(bsection, ename, value,
+                                  entry_str_escaped(pentry));
+          }
+          break;
+        case ENTRY_FILEREFERENCE:
+        case ENTRY_LONG_COMMENT:
+        case ENTRY_ILLEGAL:
+          /* Not present in savegames. */
+          break;
+        }
+      } entry_list_iterate_end;
+    }
+  } section_list_iterate_end;
+
+  return TRUE;
+}
+
 /************************************************************************//**
   Create new loaddata item for given section file.
 ****************************************************************************/
@@ -959,6 +1139,81 @@ static int unquote_block(const char *const quoted_, void *dest,
   return length;
 }
 
+/************************************************************************//**
+  Run-length encode a map line into buf. Runs of four or more identical
+  chars are written as "*<len>*<char>"; a literal '*' is always written
+  that way since it is the run marker. Everything else is copied as is,
+  so a line without long runs keeps its old representation. 'buf' must
+  have room for four chars per input char, plus the terminator.
+  Returns buf.
+****************************************************************************/
+static const char *map_line_rle_encode(const char *line, char *buf)
+{
+  int out = 0;
+
+  while (*line != '\0') {
+    char ch = *line;
+    int len = 1;
+
+    while (line[len] == ch) {
+      len++;
+    }
+    if (len >= 4 || ch == '*') {
+      out += sprintf(buf + out, "*%d*%c", len, ch);
+    } else {
+      int i;
+
+      for (i = 0; i < len; i++) {
+        buf[out++] = ch;
+      }
+    }
+    line += len;
+  }
+  buf[out] = '\0';
+
+  return buf;
+}
+
+/************************************************************************//**
+  Expand a map line encoded by map_line_rle_encode() into buf, which is
+  buf_len bytes large. Returns buf, or NULL if the line is malformed or
+  does not fit.
+****************************************************************************/
+static const char *map_line_rle_decode(const char *line, char *buf,
+                                       int buf_len)
+{
+  int out = 0;
+
+  while (*line != '\0') {
+    if (*line == '*') {
+      int len = 0;
+
+      line++;
+      if (*line < '0' || *line > '9') {
+        return NULL;
+      }
+      for (; *line >= '0' && *line <= '9'; line++) {
+        len = len * 10 + (*line - '0');
+      }
+      if (line[0] != '*' || line[1] == '\0'
+          || len <= 0 || out + len >= buf_len) {
+        return NULL;
+      }
+      memset(buf + out, line[1], len);
+      out += len;
+      line += 2;
+    } else {
+      if (out + 1 >= buf_len) {
+        return NULL;
+      }
+      buf[out++] = *line++;
+    }
+  }
+  buf[out] = '\0';
+
+  return buf;
+}
+
 /************************************************************************//**
   Load the worklist elements specified by path to the worklist pointed to
   by 'pwl'. 'pwl' should be a pointer to an existing worklist.
@@ -982,20 +1237,35 @@ static void worklist_load(struct section_file *file, int wlist_max_length,
   pwl->length = secfile_lookup_int_default(file, 0,
                                            "%s.wl_length", path_str);
 
-  for (i = 0; i < pwl->length; i++) {
-    kind = secfile_lookup_str(file, "%s.wl_kind%d", path_str, i);
-
-    /* We lookup the production value by name. An invalid entry isn't a
-     * fatal error; we just truncate the worklist. */
-    name = secfile_lookup_str_default(file, "-", "%s.wl_value%d",
-                                      path_str, i);
-    pwl->entries[i] = universal_by_rule_name(kind, name);
-    if (pwl->entries[i].kind == universals_n_invalid()) {
-      log_sg("%s.wl_value%d: unknown \"%s\" \"%s\".", path_str, i, kind,
-             name);
-      pwl->length = i;
-      break;
+  if (pwl->length > 0) {
+    const char *kinds[pwl->length];
+    const char *names[pwl->length];
+    size_t kind_count, name_count;
+
+    /* Fetch the kind and value runs in two sequential walks rather than
+     * hashing every "wl_kind%d"/"wl_value%d" key separately; this is
+     * called once per city. */
+    kind_count = secfile_lookup_str_run(file, kinds, pwl->length, "",
+                                        "%s.wl_kind", path_str);
+    name_count = secfile_lookup_str_run(file, names, pwl->length, "",
+                                        "%s.wl_value", path_str);
+
+    for (i = 0; i < pwl->length; i++) {
+      kind = (i < (int) kind_count ? kinds[i] : NULL);
+
+      /* We lookup the production value by name. An invalid entry isn't a
+       * fatal error; we just truncate the worklist. */
+      name = (i < (int) name_count ? names[i] : "-");
+      pwl->entries[i] = universal_by_rule_name(kind, name);
+      if (pwl->entries[i].kind == universals_n_invalid()) {
+        log_sg("%s.wl_value%d: unknown \"%s\" \"%s\".", path_str, i, kind,
+               name);
+        pwl->length = i;
+        break;
+      }
     }
+  } else {
+    i = 0;
   }
 
   /* Padding entries */
@@ -5245,6 +5515,7 @@ static bool sg_load_player_city(struct loaddata *loading, struct player *plr,
     trade_route_list_append(pcity->routes, proute);
 
     proute->partner = partner;
+    proute->base_cache.valid = FALSE;
     dir = secfile_lookup_str(loading->file, "%s.route_direction%d", citystr, i);
     sg_warn_ret_val(dir != NULL, FALSE,
                     "No traderoute direction found for %s", citystr);
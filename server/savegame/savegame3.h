@@ -17,4 +17,8 @@ void savegame3_load(struct section_file *sfile);
 void savegame3_save(struct section_file *sfile, const char *save_reason,
                     bool scenario);
 
+void savegame3_delta_prune(struct section_file *file);
+bool savegame3_delta_merge(struct section_file *base,
+                           struct section_file *delta);
+
 #endif /* FC__SAVEGAME3_H */
@@ -15,15 +15,27 @@
 #include <fc_config.h>
 #endif
 
+#include <stdlib.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_SYS_WAIT_H
+#include <sys/wait.h>
+#endif
+
 /* utility */
 #include "log.h"
 #include "mem.h"
 #include "registry.h"
+#include "registry_bin.h"
 
 /* common */
 #include "ai.h"
 #include "capability.h"
 #include "game.h"
+#include "player.h"
 
 /* server */
 #include "console.h"
@@ -35,8 +47,18 @@
 
 #include "savemain.h"
 
+#if defined(HAVE_WORKING_FORK) && !defined(FREECIV_MSWINDOWS)
+/* Mirrors the check in client/connectdlg_common.c; on Windows even
+ * HAVE_WORKING_FORK hasn't meant a fork() that works for us. */
+#define HAVE_USABLE_FORK
+#endif
+
 static fc_thread *save_thread = nullptr;
 
+#ifdef HAVE_USABLE_FORK
+static pid_t save_child = -1;
+#endif
+
 /************************************************************************//**
   Main entry point for loading a game.
 ****************************************************************************/
@@ -46,6 +68,34 @@ void savegame_load(struct section_file *sfile)
 
   fc_assert_ret(sfile != nullptr);
 
+  if (secfile_section_by_name(sfile, "delta") != nullptr) {
+    /* A delta autosave; fetch its base save and merge the delta over
+     * it, then load the merged result as an ordinary savegame. */
+    const char *base_path
+      = secfile_lookup_str_default(sfile, nullptr, "delta.base");
+    struct section_file *base;
+
+    if (base_path == nullptr) {
+      log_error("Delta savegame names no base save. Can not load it.");
+      return;
+    }
+
+    log_verbose("delta savegame; loading base save %s ...", base_path);
+    base = secfile_load(base_path, FALSE);
+    if (base == nullptr) {
+      log_error("Can't load base save %s of the delta savegame: %s",
+                base_path, secfile_error());
+      return;
+    }
+
+    if (savegame3_delta_merge(base, sfile)) {
+      savegame_load(base);
+    }
+    secfile_destroy(base);
+
+    return;
+  }
+
 #ifdef DEBUG_TIMERS
   struct timer *loadtimer = timer_new(TIMER_CPU, TIMER_DEBUG, "load");
   timer_start(loadtimer);
@@ -83,6 +133,10 @@ void savegame_load(struct section_file *sfile)
     } city_list_iterate_end;
   } players_iterate_end;
 
+  /* The delta counters of the loaded game are unknown; autosave a new
+   * full base before the next delta. */
+  game.server.delta.have_base = FALSE;
+
 #ifdef DEBUG_TIMERS
   timer_stop(loadtimer);
   log_debug("Loading secfile in %.3f seconds.", timer_read_seconds(loadtimer));
@@ -105,6 +159,8 @@ struct save_thread_data
   char filepath[600];
   int save_compress_level;
   enum fz_method save_compress_type;
+  bool save_binary;
+  bool save_delta;
 };
 
 /************************************************************************//**
@@ -122,9 +178,19 @@ static void save_thread_data_free(struct save_thread_data *stdata)
 static void save_thread_run(void *arg)
 {
   struct save_thread_data *stdata = (struct save_thread_data *)arg;
+  bool success;
 
-  if (!secfile_save(stdata->sfile, stdata->filepath, stdata->save_compress_level,
-                    stdata->save_compress_type)) {
+  if (stdata->save_binary) {
+    success = secfile_save_bin(stdata->sfile, stdata->filepath,
+                               stdata->save_compress_level,
+                               stdata->save_compress_type);
+  } else {
+    success = secfile_save(stdata->sfile, stdata->filepath,
+                           stdata->save_compress_level,
+                           stdata->save_compress_type);
+  }
+
+  if (!success) {
     con_write(C_FAIL, _("Failed saving game as %s"), stdata->filepath);
     log_error("Game saving failed: %s", secfile_error());
     notify_conn(nullptr, nullptr, E_LOG_ERROR, ftc_warning,
@@ -137,82 +203,14 @@ static void save_thread_run(void *arg)
 }
 
 /************************************************************************//**
-  Unconditionally save the game, with specified filename.
-  Always prints a message: either save ok, or failed.
+  Append the proper extensions to the save file name and resolve it
+  against the saves (or scenarios) directory, creating the directory
+  when needed. Returns FALSE if the directory could not be created;
+  clients have been notified in that case.
 ****************************************************************************/
-void save_game(const char *orig_filename, const char *save_reason,
-               bool scenario)
+static bool save_filepath_finalize(struct save_thread_data *stdata,
+                                   bool scenario)
 {
-  char *dot, *filename;
-  struct timer *timer_cpu, *timer_user;
-  struct save_thread_data *stdata;
-
-  stdata = fc_malloc(sizeof(*stdata));
-
-  stdata->save_compress_type = game.server.save_compress_type;
-  stdata->save_compress_level = game.server.save_compress_level;
-
-  if (orig_filename == nullptr) {
-    stdata->filepath[0] = '\0';
-    filename = stdata->filepath;
-  } else {
-    sz_strlcpy(stdata->filepath, orig_filename);
-    if ((filename = strrchr(stdata->filepath, '/'))) {
-      filename++;
-    } else {
-      filename = stdata->filepath;
-    }
-
-    /* Ignores the dot at the start of the filename. */
-    for (dot = filename; '.' == *dot; dot++) {
-      /* Nothing. */
-    }
-    if ('\0' == *dot) {
-      /* Only dots in this file name, consider it as empty. */
-      filename[0] = '\0';
-    } else {
-      char *end_dot;
-      char *strip_extensions[] = {
-        ".sav", ".gz", ".bz2", ".xz", ".zst", nullptr };
-      bool stripped = TRUE;
-
-      while ((end_dot = strrchr(dot, '.')) && stripped) {
-        int i;
-
-        stripped = FALSE;
-
-        for (i = 0; strip_extensions[i] != nullptr && !stripped; i++) {
-          if (!strcmp(end_dot, strip_extensions[i])) {
-            *end_dot = '\0';
-            stripped = TRUE;
-          }
-        }
-      }
-    }
-  }
-
-  /* If orig_filename is nullptr or empty, use a generated default name. */
-  if (filename[0] == '\0') {
-    /* Manual save */
-    generate_save_name(game.server.save_name, filename,
-                       sizeof(stdata->filepath) + stdata->filepath - filename, "manual");
-  }
-
-  timer_cpu = timer_new(TIMER_CPU, TIMER_ACTIVE, "save cpu");
-  timer_user = timer_new(TIMER_USER, TIMER_ACTIVE, "save user");
-  timer_start(timer_cpu);
-  timer_start(timer_user);
-
-  /* Allowing duplicates shouldn't be allowed. However, it takes very too
-   * long time for huge game saving... */
-  stdata->sfile = secfile_new(TRUE);
-  savegame_save(stdata->sfile, save_reason, scenario);
-
-  /* We have consistent game state in stdata->sfile now, so
-   * we could pass it to the saving thread already. We want to
-   * handle below notify_conn() and directory creation in
-   * main thread, though. */
-
   /* Append ".sav" to filename. */
   sz_strlcat(stdata->filepath, ".sav");
 
@@ -261,11 +259,7 @@ void save_game(const char *orig_filename, const char *save_reason,
         notify_conn(nullptr, nullptr, E_SETTING, ftc_warning,
                     _("Can't create saves directory!"));
 
-        save_thread_data_free(stdata);
-        timer_destroy(timer_cpu);
-        timer_destroy(timer_user);
-
-        return;
+        return FALSE;
       }
 
       sz_strlcpy(tmpname, srvarg.saves_pathname);
@@ -279,11 +273,7 @@ void save_game(const char *orig_filename, const char *save_reason,
         notify_conn(nullptr, nullptr, E_SETTING, ftc_warning,
                     _("Can't create scenario saves directory!"));
 
-        save_thread_data_free(stdata);
-        timer_destroy(timer_cpu);
-        timer_destroy(timer_user);
-
-        return;
+        return FALSE;
       }
 
       sz_strlcpy(tmpname, srvarg.scenarios_pathname);
@@ -296,6 +286,210 @@ void save_game(const char *orig_filename, const char *save_reason,
     sz_strlcpy(stdata->filepath, tmpname);
   }
 
+  return TRUE;
+}
+
+#ifdef HAVE_USABLE_FORK
+/************************************************************************//**
+  Wait for the previous forked save, if any, to finish, and report
+  its failure if it had one.
+****************************************************************************/
+static void save_child_wait(void)
+{
+  if (save_child > 0) {
+    int status = 0;
+
+    waitpid(save_child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+      notify_conn(nullptr, nullptr, E_LOG_ERROR, ftc_warning,
+                  _("Failed saving game."));
+    }
+    save_child = -1;
+  }
+}
+
+/************************************************************************//**
+  Serialize and write the savegame in a forked child process. The fork
+  gave us a copy-on-write snapshot of the game state, so we see a
+  consistent game here while the parent goes on running it.
+
+  Must not touch client connections - the sockets are shared with the
+  parent - so results are only written to the console and log; the
+  parent reports failures to the clients when it reaps us.
+****************************************************************************/
+static void save_child_run(struct save_thread_data *stdata,
+                           const char *save_reason,
+                           bool scenario) fc__noreturn;
+
+static void save_child_run(struct save_thread_data *stdata,
+                           const char *save_reason, bool scenario)
+{
+  bool success;
+
+  stdata->sfile = secfile_new(TRUE);
+  savegame_save(stdata->sfile, save_reason, scenario);
+
+  if (stdata->save_delta) {
+    savegame3_delta_prune(stdata->sfile);
+  }
+
+  if (stdata->save_binary) {
+    success = secfile_save_bin(stdata->sfile, stdata->filepath,
+                               stdata->save_compress_level,
+                               stdata->save_compress_type);
+  } else {
+    success = secfile_save(stdata->sfile, stdata->filepath,
+                           stdata->save_compress_level,
+                           stdata->save_compress_type);
+  }
+
+  if (success) {
+    con_write(C_OK, _("Game saved as %s"), stdata->filepath);
+  } else {
+    con_write(C_FAIL, _("Failed saving game as %s"), stdata->filepath);
+    log_error("Game saving failed: %s", secfile_error());
+  }
+
+  _exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+#endif /* HAVE_USABLE_FORK */
+
+/************************************************************************//**
+  Unconditionally save the game, with specified filename. When 'delta'
+  is set, the save is stripped down to the sections changed since the
+  last full save before it is written.
+  Always prints a message: either save ok, or failed.
+****************************************************************************/
+static void save_game_real(const char *orig_filename,
+                           const char *save_reason,
+                           bool scenario, bool delta)
+{
+  char *dot, *filename;
+  struct timer *timer_cpu, *timer_user;
+  struct save_thread_data *stdata;
+
+  stdata = fc_malloc(sizeof(*stdata));
+
+  stdata->sfile = nullptr;
+  stdata->save_compress_type = game.server.save_compress_type;
+  stdata->save_compress_level = game.server.save_compress_level;
+  /* Scenarios stay text so that they remain hand-editable. */
+  stdata->save_binary = game.server.binary_save && !scenario;
+  stdata->save_delta = delta;
+
+  if (orig_filename == nullptr) {
+    stdata->filepath[0] = '\0';
+    filename = stdata->filepath;
+  } else {
+    sz_strlcpy(stdata->filepath, orig_filename);
+    if ((filename = strrchr(stdata->filepath, '/'))) {
+      filename++;
+    } else {
+      filename = stdata->filepath;
+    }
+
+    /* Ignores the dot at the start of the filename. */
+    for (dot = filename; '.' == *dot; dot++) {
+      /* Nothing. */
+    }
+    if ('\0' == *dot) {
+      /* Only dots in this file name, consider it as empty. */
+      filename[0] = '\0';
+    } else {
+      char *end_dot;
+      char *strip_extensions[] = {
+        ".sav", ".gz", ".bz2", ".xz", ".zst", nullptr };
+      bool stripped = TRUE;
+
+      while ((end_dot = strrchr(dot, '.')) && stripped) {
+        int i;
+
+        stripped = FALSE;
+
+        for (i = 0; strip_extensions[i] != nullptr && !stripped; i++) {
+          if (!strcmp(end_dot, strip_extensions[i])) {
+            *end_dot = '\0';
+            stripped = TRUE;
+          }
+        }
+      }
+    }
+  }
+
+  /* If orig_filename is nullptr or empty, use a generated default name. */
+  if (filename[0] == '\0') {
+    /* Manual save */
+    generate_save_name(game.server.save_name, filename,
+                       sizeof(stdata->filepath) + stdata->filepath - filename, "manual");
+  }
+
+  /* Notify_conn() calls and directory creation belong to the main
+   * thread / parent process, so resolve the full path already here. */
+  if (!save_filepath_finalize(stdata, scenario)) {
+    free(stdata);
+
+    return;
+  }
+
+  if (!scenario && !delta && game.server.delta_saves) {
+    /* This full save becomes the base the following delta autosaves
+     * are diffed against. Snapshot the change counters already here -
+     * serialization may happen in a thread or a forked child, but the
+     * game state can't change before the fork or the in-process
+     * savegame_save() call below. */
+    players_iterate(pplayer) {
+      pplayer->server.delta_base = pplayer->server.delta_counter;
+    } players_iterate_end;
+    game.server.delta.map_base = game.server.delta.map_counter;
+    sz_strlcpy(game.server.delta.base_path, stdata->filepath);
+    game.server.delta.have_base = TRUE;
+  }
+
+#ifdef HAVE_USABLE_FORK
+  if (game.server.forked_save && !scenario) {
+    pid_t pid;
+
+    /* Reap the previous save child; also reports its failure, if any. */
+    save_child_wait();
+
+    if (save_thread != nullptr) {
+      /* Don't fork while a threaded save could be holding locks. */
+      fc_thread_wait(save_thread);
+    }
+
+    pid = fork();
+    if (pid == 0) {
+      save_child_run(stdata, save_reason, scenario);
+      /* Does not return. */
+    } else if (pid > 0) {
+      save_child = pid;
+      free(stdata);
+
+      return;
+    }
+
+    log_error("fork() for saving failed: %s. Saving in this process.",
+              fc_strerror(fc_get_errno()));
+  }
+#endif /* HAVE_USABLE_FORK */
+
+  timer_cpu = timer_new(TIMER_CPU, TIMER_ACTIVE, "save cpu");
+  timer_user = timer_new(TIMER_USER, TIMER_ACTIVE, "save user");
+  timer_start(timer_cpu);
+  timer_start(timer_user);
+
+  /* Allowing duplicates shouldn't be allowed. However, it takes very too
+   * long time for huge game saving... */
+  stdata->sfile = secfile_new(TRUE);
+  savegame_save(stdata->sfile, save_reason, scenario);
+
+  if (stdata->save_delta) {
+    savegame3_delta_prune(stdata->sfile);
+  }
+
+  /* We have consistent game state in stdata->sfile now, so
+   * we can pass it to the saving thread already. */
+
   if (save_thread != nullptr) {
     /* Previously started thread */
     fc_thread_wait(save_thread);
@@ -323,6 +517,55 @@ void save_game(const char *orig_filename, const char *save_reason,
   timer_destroy(timer_user);
 }
 
+/************************************************************************//**
+  Unconditionally save the game, with specified filename.
+  Always prints a message: either save ok, or failed.
+****************************************************************************/
+void save_game(const char *orig_filename, const char *save_reason,
+               bool scenario)
+{
+  save_game_real(orig_filename, save_reason, scenario, FALSE);
+}
+
+/************************************************************************//**
+  Save only the savegame sections that changed since the last full save,
+  recording that save as the base to merge the delta over on load.
+  Falls back to a full save when no base exists yet.
+****************************************************************************/
+void save_game_delta(const char *orig_filename, const char *save_reason)
+{
+  if (!game.server.delta.have_base) {
+    save_game_real(orig_filename, save_reason, FALSE, FALSE);
+  } else {
+    save_game_real(orig_filename, save_reason, FALSE, TRUE);
+  }
+}
+
+/************************************************************************//**
+  Record that pplayer's savegame sections are out of date relative to
+  the last full save. With a nullptr argument every player is marked.
+  Cheap enough to call from the send paths.
+****************************************************************************/
+void deltasave_dirty_player(struct player *pplayer)
+{
+  if (pplayer != nullptr) {
+    pplayer->server.delta_counter++;
+  } else {
+    players_iterate(aplayer) {
+      aplayer->server.delta_counter++;
+    } players_iterate_end;
+  }
+}
+
+/************************************************************************//**
+  Record that the [map] savegame section is out of date relative to the
+  last full save.
+****************************************************************************/
+void deltasave_dirty_map(void)
+{
+  game.server.delta.map_counter++;
+}
+
 /************************************************************************//**
   Close saving system.
 ****************************************************************************/
@@ -333,4 +576,8 @@ void save_system_close(void)
     free(save_thread);
     save_thread = nullptr;
   }
+
+#ifdef HAVE_USABLE_FORK
+  save_child_wait();
+#endif
 }
@@ -24,6 +24,12 @@ void savegame_save(struct section_file *sfile, const char *save_reason,
 
 void save_game(const char *orig_filename, const char *save_reason,
                bool scenario);
+void save_game_delta(const char *orig_filename, const char *save_reason);
+
+struct player;
+
+void deltasave_dirty_player(struct player *pplayer);
+void deltasave_dirty_map(void);
 
 void save_system_close(void);
 
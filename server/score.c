@@ -37,6 +37,8 @@
 
 /* server */
 #include "plrhand.h"
+#include "report.h"
+#include "sanitycheck.h"
 #include "score.h"
 #include "srv_main.h"
 
@@ -245,6 +247,173 @@ static void get_player_landarea(struct claim_map *pcmap,
   }
 }
 
+/**************************************************************************
+  Incrementally maintained score counters.
+
+  The land area, settled area and known tech components of the score
+  used to be recomputed from the whole map and the whole advance table
+  for every player on every score turn. They are kept as running
+  counters here instead, adjusted by the events that change them: tile
+  ownership changes in maphand.c, worked tile changes in citytools.c
+  and tech gain/loss in techtools.c. Events with too many indirect
+  consequences to track (city transfer or removal, terrain class
+  changes, editor tech edits) call score_counters_invalidate() instead;
+  the counters are then rebuilt with a single full scan the next time a
+  score is calculated. The full recompute is retained as the fallback
+  for games without borders and, under SANITY_CHECKING, as verification
+  of the counters.
+**************************************************************************/
+struct score_counter_set {
+  int landarea;         /* Tiles owned by the player, oceanic included */
+  int settledarea;      /* Non-ocean tiles worked by the player's cities */
+  int techs;            /* Valid advances known to the player */
+};
+
+static struct score_counter_set score_counters[MAX_NUM_PLAYER_SLOTS];
+static bool score_counters_valid = FALSE;
+
+/**********************************************************************//**
+  Throw the incrementally maintained score counters away. Call after
+  any change that affects them but is too involved to track piecemeal;
+  they are rebuilt on the next score calculation.
+**************************************************************************/
+void score_counters_invalidate(void)
+{
+  score_counters_valid = FALSE;
+}
+
+/**********************************************************************//**
+  Rebuild all score counters from the current game state.
+**************************************************************************/
+static void score_counters_rebuild(void)
+{
+  memset(score_counters, 0, sizeof(score_counters));
+
+  whole_map_iterate(&(wld.map), ptile) {
+    struct player *owner = tile_owner(ptile);
+    struct city *pwork = tile_worked(ptile);
+
+    if (owner != nullptr) {
+      score_counters[player_index(owner)].landarea++;
+    }
+    if (pwork != nullptr && !is_ocean_tile(ptile)) {
+      score_counters[player_index(city_owner(pwork))].settledarea++;
+    }
+  } whole_map_iterate_end;
+
+  players_iterate(pplayer) {
+    const struct research *presearch = research_get(pplayer);
+    int techs = 0;
+
+    advance_index_iterate(A_FIRST, i) {
+      if (valid_advance_by_number(i) != nullptr
+          && research_invention_state(presearch, i) == TECH_KNOWN) {
+        techs++;
+      }
+    } advance_index_iterate_end;
+    score_counters[player_index(pplayer)].techs = techs;
+  } players_iterate_end;
+
+  score_counters_valid = TRUE;
+}
+
+/**********************************************************************//**
+  A tile is about to change owner from 'oldowner' to 'newowner'.
+**************************************************************************/
+void score_counter_tile_owner(const struct player *oldowner,
+                              const struct player *newowner)
+{
+  if (!score_counters_valid || oldowner == newowner) {
+    return;
+  }
+
+  if (oldowner != nullptr) {
+    score_counters[player_index(oldowner)].landarea--;
+  }
+  if (newowner != nullptr) {
+    score_counters[player_index(newowner)].landarea++;
+  }
+}
+
+/**********************************************************************//**
+  'ptile' is about to become worked by 'pwork' (possibly nullptr).
+  Must be called before the tile_set_worked() call it accounts for.
+**************************************************************************/
+void score_counter_tile_worked(const struct tile *ptile,
+                               const struct city *pwork)
+{
+  const struct city *old = tile_worked(ptile);
+
+  if (!score_counters_valid || old == pwork || is_ocean_tile(ptile)) {
+    return;
+  }
+
+  if (old != nullptr) {
+    score_counters[player_index(city_owner(old))].settledarea--;
+  }
+  if (pwork != nullptr) {
+    score_counters[player_index(city_owner(pwork))].settledarea++;
+  }
+}
+
+/**********************************************************************//**
+  The players of 'presearch' gained ('change' == 1) or lost
+  ('change' == -1) one valid advance.
+**************************************************************************/
+void score_counter_tech_change(const struct research *presearch, int change)
+{
+  if (!score_counters_valid) {
+    return;
+  }
+
+  research_players_iterate(presearch, pplayer) {
+    score_counters[player_index(pplayer)].techs += change;
+  } research_players_iterate_end;
+}
+
+/**********************************************************************//**
+  The settled area contribution of the player's units: tiles that are
+  neither city nor worked, where one of the player's units leads the
+  stack, inside the working radius of one of the player's cities. This
+  matches the claim map of build_landarea_map(), but costs time
+  proportional to the unit count rather than the map size.
+**************************************************************************/
+static int settled_area_by_units(const struct player *pplayer)
+{
+  const struct civ_map *nmap = &(wld.map);
+  int settled = 0;
+
+  unit_list_iterate(pplayer->units, punit) {
+    struct tile *ptile = unit_tile(punit);
+    bool claimed = FALSE;
+
+    if (is_ocean_tile(ptile)
+        || tile_city(ptile) != nullptr
+        || tile_worked(ptile) != nullptr
+        || unit_list_get(ptile->units, 0) != punit) {
+      continue;
+    }
+
+    circle_iterate(nmap, ptile, CITY_MAP_MAX_RADIUS_SQ, atile) {
+      struct city *pcity = tile_city(atile);
+
+      if (!claimed
+          && pcity != nullptr
+          && city_owner(pcity) == pplayer
+          && sq_map_distance(ptile, atile)
+             <= city_map_radius_sq_get(pcity)) {
+        claimed = TRUE;
+      }
+    } circle_iterate_end;
+
+    if (claimed) {
+      settled++;
+    }
+  } unit_list_iterate_end;
+
+  return settled;
+}
+
 /**********************************************************************//**
   Calculates the civilization score for the player.
 **************************************************************************/
@@ -303,19 +472,59 @@ void calc_civ_score(struct player *pplayer)
     pplayer->score.literacy += (city_population(pcity) * bonus) / 100;
   } city_list_iterate_end;
 
-  build_landarea_map(&cmap);
+  if (BORDERS_DISABLED != game.info.borders) {
+    int pidx = player_index(pplayer);
 
-  get_player_landarea(&cmap, pplayer, &landarea, &settledarea);
-  pplayer->score.landarea = landarea;
-  pplayer->score.settledarea = settledarea;
+    if (!score_counters_valid) {
+      score_counters_rebuild();
+    }
+
+    pplayer->score.landarea
+      = USER_AREA_MULT * score_counters[pidx].landarea;
+    pplayer->score.settledarea
+      = USER_AREA_MULT * (score_counters[pidx].settledarea
+                          + settled_area_by_units(pplayer));
+    pplayer->score.techs = score_counters[pidx].techs;
+
+#ifdef SANITY_CHECKING
+    /* The full recompute, as verification that no counter update was
+     * missed. */
+    {
+      int techs = 0;
+
+      build_landarea_map(&cmap);
+      get_player_landarea(&cmap, pplayer, &landarea, &settledarea);
+
+      presearch = research_get(pplayer);
+      advance_index_iterate(A_FIRST, i) {
+        if (valid_advance_by_number(i) != nullptr
+            && research_invention_state(presearch, i) == TECH_KNOWN) {
+          techs++;
+        }
+      } advance_index_iterate_end;
 
-  presearch = research_get(pplayer);
-  advance_index_iterate(A_FIRST, i) {
-    if (valid_advance_by_number(i) != nullptr
-        && research_invention_state(presearch, i) == TECH_KNOWN) {
-      pplayer->score.techs++;
+      fc_assert(pplayer->score.landarea == landarea);
+      fc_assert(pplayer->score.settledarea == settledarea);
+      fc_assert(pplayer->score.techs == techs);
     }
-  } advance_index_iterate_end;
+#endif /* SANITY_CHECKING */
+  } else {
+    /* Without borders, land area is derived from the claim map, which
+     * the counters do not track; do the full recompute. */
+    build_landarea_map(&cmap);
+
+    get_player_landarea(&cmap, pplayer, &landarea, &settledarea);
+    pplayer->score.landarea = landarea;
+    pplayer->score.settledarea = settledarea;
+
+    presearch = research_get(pplayer);
+    advance_index_iterate(A_FIRST, i) {
+      if (valid_advance_by_number(i) != nullptr
+          && research_invention_state(presearch, i) == TECH_KNOWN) {
+        pplayer->score.techs++;
+      }
+    } advance_index_iterate_end;
+  }
   pplayer->score.techs += research_get(pplayer)->future_tech * 5 / 2;
 
   unit_list_iterate(pplayer->units, punit) {
@@ -335,6 +544,9 @@ void calc_civ_score(struct player *pplayer)
   pplayer->score.spaceship = pplayer->spaceship.state;
 
   pplayer->score.game = get_civ_score(pplayer);
+
+  /* Every demographics row is derived from the values updated above. */
+  demographics_invalidate();
 }
 
 /**********************************************************************//**
@@ -16,8 +16,17 @@
 /* common */
 #include "fc_types.h"
 
+struct research;
+
 void calc_civ_score(struct player *pplayer);
 
+void score_counters_invalidate(void);
+void score_counter_tile_owner(const struct player *oldowner,
+                              const struct player *newowner);
+void score_counter_tile_worked(const struct tile *ptile,
+                               const struct city *pwork);
+void score_counter_tech_change(const struct research *presearch, int change);
+
 int get_civ_score(const struct player *pplayer);
 
 int total_player_citizens(const struct player *pplayer);
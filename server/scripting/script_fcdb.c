@@ -42,6 +42,7 @@
 
 /* utility */
 #include "capability.h"
+#include "fcthread.h"
 #include "log.h"
 #include "md5.h"
 #include "registry.h"
@@ -86,6 +87,28 @@ static void script_fcdb_cmd_reply(struct fc_lua *lfcl, enum log_level level,
 **************************************************************************/
 static struct fc_lua *fcl = NULL;
 
+/* Serializes access to the fcdb lua state. The authentication worker
+ * thread (server/auth.c) runs its database queries through
+ * script_fcdb_call() while the main thread may be using the state for
+ * console commands, delegation checks or a "/fcdb reload". */
+static fc_mutex fcl_mutex;
+
+/**********************************************************************//**
+  Make sure the lock serializing access to the fcdb lua state exists.
+  It is created once and never destroyed: the lua state itself can be
+  torn down and rebuilt by "/fcdb reload" while worker thread queries
+  are still in flight, so the lock has to outlive individual states.
+**************************************************************************/
+static void script_fcdb_mutex_ensure(void)
+{
+  static bool initialized = FALSE;
+
+  if (!initialized) {
+    fc_mutex_init(&fcl_mutex);
+    initialized = TRUE;
+  }
+}
+
 /**********************************************************************//**
   Add fcdb callback functions; these must be defined in the lua script
   'database.lua':
@@ -239,7 +262,11 @@ static int md5sum(lua_State *L)
 bool script_fcdb_init(const char *fcdb_luafile)
 {
 #ifdef HAVE_FCDB
+  script_fcdb_mutex_ensure();
+  fc_mutex_allocate(&fcl_mutex);
+
   if (fcl != NULL) {
+    fc_mutex_release(&fcl_mutex);
     fc_assert_ret_val(fcl->state != NULL, FALSE);
 
     return TRUE;
@@ -252,6 +279,7 @@ bool script_fcdb_init(const char *fcdb_luafile)
 
   fcl = luascript_new(NULL, FALSE);
   if (fcl == NULL) {
+    fc_mutex_release(&fcl_mutex);
     log_error("Error loading the Freeciv database lua definition.");
     return FALSE;
   }
@@ -297,6 +325,7 @@ bool script_fcdb_init(const char *fcdb_luafile)
     log_error("Error loading the Freeciv database lua script '%s'.",
               fcdb_luafile);
     script_fcdb_free();
+    fc_mutex_release(&fcl_mutex);
     return FALSE;
   }
 
@@ -304,15 +333,18 @@ bool script_fcdb_init(const char *fcdb_luafile)
     if (!script_fcdb_call("database_init")) {
       log_error("Error connecting to the database");
       script_fcdb_free();
+      fc_mutex_release(&fcl_mutex);
       return FALSE;
     }
 
     if (!script_fcdb_capstr()) {
       log_error(_("Database capabilities not compatible with server"));
+      fc_mutex_release(&fcl_mutex);
       return FALSE;
     }
   }
 
+  fc_mutex_release(&fcl_mutex);
 #endif /* HAVE_FCDB */
 
   return TRUE;
@@ -364,7 +396,16 @@ bool script_fcdb_call(const char *func_name, ...)
   va_list args;
   va_start(args, func_name);
 
-  success = luascript_func_call_valist(fcl, func_name, args);
+  script_fcdb_mutex_ensure();
+  fc_mutex_allocate(&fcl_mutex);
+  if (fcl == NULL) {
+    /* The scripting state is down, e.g. in the middle of a
+     * "/fcdb reload". Report the call as failed. */
+    success = FALSE;
+  } else {
+    success = luascript_func_call_valist(fcl, func_name, args);
+  }
+  fc_mutex_release(&fcl_mutex);
   va_end(args);
 #endif /* HAVE_FCDB */
 
@@ -377,15 +418,19 @@ bool script_fcdb_call(const char *func_name, ...)
 void script_fcdb_free(void)
 {
 #ifdef HAVE_FCDB
+  script_fcdb_mutex_ensure();
+
   if (!script_fcdb_call("database_free", 0)) {
     log_error("Error closing the database connection. Continuing anyway...");
   }
 
+  fc_mutex_allocate(&fcl_mutex);
   if (fcl) {
     /* luascript_func_free() is called by luascript_destroy(). */
     luascript_destroy(fcl);
     fcl = NULL;
   }
+  fc_mutex_release(&fcl_mutex);
 #endif /* HAVE_FCDB */
 }
 
@@ -400,6 +445,9 @@ bool script_fcdb_do_string(struct connection *caller, const char *str)
   struct connection *save_caller;
   luascript_log_func_t save_output_fct;
 
+  script_fcdb_mutex_ensure();
+  fc_mutex_allocate(&fcl_mutex);
+
   /* Set a log callback function which allows to send the results of the
    * command to the clients. */
   save_caller = fcl->caller;
@@ -413,6 +461,8 @@ bool script_fcdb_do_string(struct connection *caller, const char *str)
   fcl->caller = save_caller;
   fcl->output_fct = save_output_fct;
 
+  fc_mutex_release(&fcl_mutex);
+
   return (status == 0);
 #else
   return TRUE;
@@ -414,6 +414,48 @@ void script_server_signal_emit(const char *signal_name, ...)
   va_end(args);
 }
 
+/***********************************************************************//**
+  Return the integer id of a signal, or -1 if it does not exist. Ids
+  are stable for the lifetime of the scripting state; hot emission
+  paths can resolve their signal once and emit by id afterwards.
+***************************************************************************/
+int script_server_signal_id(const char *signal_name)
+{
+  return luascript_signal_id(fcl_main, signal_name);
+}
+
+/***********************************************************************//**
+  Invoke all the callback functions attached to the signal with the
+  given id. When nothing is connected - the common case - this returns
+  after a counter check, without hashing the name or entering Lua.
+***************************************************************************/
+void script_server_signal_emit_by_id(int sid, ...)
+{
+  va_list args;
+
+  va_start(args, sid);
+  luascript_signal_emit_by_id_valist(fcl_main, sid, args);
+  va_end(args);
+}
+
+/***********************************************************************//**
+  Call 'cb' once per signal callback with the execution counters
+  accumulated since the last reset.
+***************************************************************************/
+void script_server_signal_stats_iterate(luascript_signal_stats_cb cb,
+                                        void *data)
+{
+  luascript_signal_stats_iterate(fcl_main, cb, data);
+}
+
+/***********************************************************************//**
+  Reset the per-callback execution counters.
+***************************************************************************/
+void script_server_signal_stats_reset(void)
+{
+  luascript_signal_stats_reset(fcl_main);
+}
+
 /***********************************************************************//**
   Declare any new signal types you need here.
 ***************************************************************************/
@@ -18,6 +18,7 @@
 #include "support.h"
 
 /* common/scriptcore */
+#include "luascript_signal.h"
 #include "luascript_types.h"
 
 struct section_file;
@@ -44,6 +45,11 @@ void script_server_state_save(struct section_file *file);
 
 /* Signals. */
 void script_server_signal_emit(const char *signal_name, ...);
+int script_server_signal_id(const char *signal_name);
+void script_server_signal_emit_by_id(int sid, ...);
+void script_server_signal_stats_iterate(luascript_signal_stats_cb cb,
+                                        void *data);
+void script_server_signal_stats_reset(void);
 
 /* Functions */
 bool script_server_call(const char *func_name, ...);
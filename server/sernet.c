@@ -35,6 +35,9 @@
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
 #ifdef HAVE_NETDB_H
 #include <netdb.h>
 #endif
@@ -62,6 +65,7 @@
 #include "capability.h"
 #include "fciconv.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "netintf.h"
@@ -85,6 +89,7 @@
 #include "console.h"
 #include "meta.h"
 #include "plrhand.h"
+#include "sessionrec.h"
 #include "srv_main.h"
 #include "stdinhand.h"
 #include "voting.h"
@@ -97,6 +102,31 @@ static int *listen_socks;
 static int listen_count;
 static int socklan;
 
+/* Shared readiness monitoring set for all sockets the server watches.
+ * Kept across wakeups so the kernel side registrations survive between
+ * calls. */
+static struct fc_eventset *server_events = NULL;
+
+/* Asynchronous network writer. Send buffer flushes hand their data to
+ * a dedicated thread that performs the actual socket writes, so a
+ * client whose socket has stopped accepting data can no longer stall
+ * the main loop. One slot per connection, indexed like connections[]. */
+struct net_writer_slot {
+  struct byte_vector pending;   /* Data waiting for the writer thread */
+  int sock;                     /* Socket to write it to */
+  bool busy;                    /* Writer is writing this slot now */
+  bool cancelled;               /* Tells the writer to stop doing so */
+  bool failed;                  /* Writer gave up on this connection */
+};
+
+static struct net_writer_slot writer_slots[MAX_NUM_CONNECTIONS];
+static fc_thread net_writer_thread;
+static fc_mutex net_writer_mutex;
+static fc_thread_cond net_writer_wake;  /* New data queued, or shutdown */
+static fc_thread_cond net_writer_done;  /* A slot finished writing */
+static bool net_writer_active = FALSE;
+static volatile bool net_writer_stop = FALSE;
+
 #if defined(__VMS)
 #  if defined(_VAX_)
 #    define lib$stop LIB$STOP
@@ -127,6 +157,11 @@ static void send_ping_times_to_all(void);
 static void get_lanserver_announcement(void);
 static void send_lanserver_response(void);
 
+static void net_writer_start(void);
+static void net_writer_shutdown(void);
+static void net_writer_forget(struct connection *pconn);
+static void net_writer_process_failures(void);
+
 static bool no_input = FALSE;
 
 /* Avoid compiler warning about defined, but unused function
@@ -182,6 +217,7 @@ static void handle_readline_input_callback(char *line)
   con_prompt_enter();      /* just got an 'Enter' hit */
   current_internal = local_to_internal_string_malloc(line);
   free(line); /* This is already freed if we exit() with /quit command */
+  session_record_console(current_internal);
   handle_stdin_input_free(NULL, current_internal);
   current_internal = NULL;
 
@@ -231,6 +267,9 @@ static void close_connection(struct connection *pconn)
     pconn->server.ping_timers = NULL;
   }
 
+  dbv_free(&pconn->server.tile_info_dirty);
+  pconn->server.tile_info_dirty_count = 0;
+
   conn_pattern_list_destroy(pconn->server.ignore_list);
   pconn->server.ignore_list = NULL;
 
@@ -243,6 +282,7 @@ static void close_connection(struct connection *pconn)
   pconn->playing = NULL;
   pconn->client_gui = GUI_STUB;
   pconn->access_level = ALLOW_NONE;
+  net_writer_forget(pconn);
   connection_common_close(pconn);
 
   send_updated_vote_totals(NULL);
@@ -256,6 +296,10 @@ void close_connections_and_socket(void)
 {
   int i;
 
+  /* Stop the writer thread first, so the last packets below go out
+   * synchronously. */
+  net_writer_shutdown();
+
   lsend_packet_server_shutdown(game.all_connections);
 
   for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
@@ -280,6 +324,11 @@ void close_connections_and_socket(void)
     fc_closesocket(socklan);
   }
 
+  if (server_events != NULL) {
+    fc_eventset_destroy(server_events);
+    server_events = NULL;
+  }
+
 #ifdef FREECIV_HAVE_LIBREADLINE
   if (history_file) {
     write_history(history_file);
@@ -369,6 +418,371 @@ static void cut_lagging_connection(struct connection *pconn)
   }
 }
 
+/*************************************************************************//**
+  Write 'size' bytes to 'sock' on the writer thread, waiting for the
+  socket as long as needed. Gives up when the socket stays unwritable
+  beyond tcptimeout, or when the write fails; returns FALSE then.
+  '*cancelled' is set by the main thread when the connection goes away
+  under us; stopping early then is not a failure.
+*****************************************************************************/
+static bool net_writer_drain(int sock, const unsigned char *data,
+                             size_t size, const volatile bool *cancelled)
+{
+  size_t start = 0;
+  double stalled = 0.0;
+
+  while (start < size && !net_writer_stop && !*cancelled) {
+    fd_set writefs;
+    fc_timeval tv;
+    int ret, nput;
+
+    FC_FD_ZERO(&writefs);
+    FD_SET(sock, &writefs);
+    tv.tv_sec = 0;
+    tv.tv_usec = 100000;
+
+    ret = fc_select(sock + 1, NULL, &writefs, NULL, &tv);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return FALSE;
+    }
+    if (ret == 0) {
+      /* Keep waiting for the socket, but not beyond the point where
+       * the lagging connection would have been cut anyway. */
+      stalled += 0.1;
+      if (game.server.tcptimeout != 0 && stalled > game.server.tcptimeout) {
+        return FALSE;
+      }
+      continue;
+    }
+
+    nput = fc_writesocket(sock, (const char *) data + start, size - start);
+    if (nput == -1) {
+#ifdef NONBLOCKING_SOCKETS
+      if (errno == EWOULDBLOCK || errno == EAGAIN) {
+        continue;
+      }
+#endif /* NONBLOCKING_SOCKETS */
+      return FALSE;
+    }
+    start += nput;
+    stalled = 0.0;
+  }
+
+  return TRUE;
+}
+
+/*************************************************************************//**
+  Main function of the writer thread: picks a slot with queued data,
+  steals its backlog and writes it out, then goes back to sleep until
+  more data is handed over.
+*****************************************************************************/
+static void net_writer_run(void *arg)
+{
+  fc_mutex_allocate(&net_writer_mutex);
+
+  while (!net_writer_stop) {
+    struct net_writer_slot *slot = NULL;
+    struct byte_vector chunk;
+    int i, sock;
+    bool ok;
+
+    for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+      if (byte_vector_size(&writer_slots[i].pending) > 0
+          && !writer_slots[i].failed) {
+        slot = &writer_slots[i];
+        break;
+      }
+    }
+
+    if (slot == NULL) {
+      fc_thread_cond_wait(&net_writer_wake, &net_writer_mutex);
+      continue;
+    }
+
+    /* Steal the backlog; data handed over meanwhile goes to a fresh
+     * vector and is picked up on the next round. */
+    chunk = slot->pending;
+    byte_vector_init(&slot->pending);
+    sock = slot->sock;
+    slot->busy = TRUE;
+    fc_mutex_release(&net_writer_mutex);
+
+    ok = net_writer_drain(sock, chunk.p, byte_vector_size(&chunk),
+                          &slot->cancelled);
+    byte_vector_free(&chunk);
+
+    fc_mutex_allocate(&net_writer_mutex);
+    slot->busy = FALSE;
+    if (!ok) {
+      slot->failed = TRUE;
+    }
+    fc_thread_cond_signal(&net_writer_done);
+  }
+
+  fc_mutex_release(&net_writer_mutex);
+}
+
+/*************************************************************************//**
+  'conn_write_fn_t' callback: queue the content of 'buf' for the writer
+  thread. Also applies backpressure: a backlog beyond MAX_LEN_BUFFER
+  means the client cannot catch up any more, and since dropping part of
+  the packet stream would desynchronise it, the whole backlog is
+  dropped by cutting the connection - just like a send buffer overflow
+  would have done.
+*****************************************************************************/
+static bool net_writer_handoff(struct connection *pconn,
+                               struct socket_packet_buffer *buf)
+{
+  struct net_writer_slot *slot;
+  size_t old_size;
+
+  if (!net_writer_active
+      || pconn < connections
+      || pconn >= connections + MAX_NUM_CONNECTIONS
+      || pconn->server.is_closing) {
+    return FALSE;
+  }
+
+  slot = &writer_slots[pconn - connections];
+
+  fc_mutex_allocate(&net_writer_mutex);
+
+  if (slot->failed) {
+    fc_mutex_release(&net_writer_mutex);
+    connection_close_server(pconn, _("lagging connection"));
+    return TRUE;
+  }
+
+  old_size = byte_vector_size(&slot->pending);
+  if (old_size + buf->ndata > MAX_LEN_BUFFER) {
+    fc_mutex_release(&net_writer_mutex);
+    log_verbose("connection (%s) cut due to huge write backlog",
+                conn_description(pconn));
+    connection_close_server(pconn, _("lagging connection"));
+    return TRUE;
+  }
+
+  slot->sock = pconn->sock;
+  byte_vector_reserve(&slot->pending, old_size + buf->ndata);
+  memcpy(slot->pending.p + old_size, buf->data, buf->ndata);
+  fc_thread_cond_signal(&net_writer_wake);
+  fc_mutex_release(&net_writer_mutex);
+
+  return TRUE;
+}
+
+/*************************************************************************//**
+  Close the connections whose writer gave up on them. Called from the
+  main loop; the writer thread itself never touches connection state.
+*****************************************************************************/
+static void net_writer_process_failures(void)
+{
+  bool failed[MAX_NUM_CONNECTIONS];
+  int i;
+
+  if (!net_writer_active) {
+    return;
+  }
+
+  fc_mutex_allocate(&net_writer_mutex);
+  for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    failed[i] = writer_slots[i].failed;
+  }
+  fc_mutex_release(&net_writer_mutex);
+
+  for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    if (failed[i] && connections[i].used
+        && !connections[i].server.is_closing) {
+      log_verbose("connection (%s) cut due to lagging player",
+                  conn_description(&connections[i]));
+      connection_close_server(&connections[i], _("lagging connection"));
+    }
+  }
+}
+
+/*************************************************************************//**
+  Bytes queued for 'pconn' and not yet written to its socket: the send
+  buffer plus whatever has been handed to the writer thread. The chunk
+  the writer is currently pushing out is not counted.
+*****************************************************************************/
+size_t connection_send_backlog(const struct connection *pconn)
+{
+  size_t backlog = 0;
+
+  if (!pconn->used || pconn->server.is_closing) {
+    return 0;
+  }
+
+  if (pconn->send_buffer != NULL) {
+    backlog = pconn->send_buffer->ndata;
+  }
+
+  if (net_writer_active
+      && pconn >= connections
+      && pconn < connections + MAX_NUM_CONNECTIONS) {
+    fc_mutex_allocate(&net_writer_mutex);
+    backlog += byte_vector_size(&writer_slots[pconn - connections].pending);
+    fc_mutex_release(&net_writer_mutex);
+  }
+
+  return backlog;
+}
+
+/*************************************************************************//**
+  The 'netlagbytes' policy: a connection whose send backlog exceeds the
+  setting is switched to reduced updates - game state packets are
+  withheld from it in send_packet_data() - so that a chronically slow
+  client stops growing server-side buffers. When its backlog has fully
+  drained, the withheld state is made up for with a snapshot resync,
+  just as if it had reconnected. Called from the sniff loop.
+*****************************************************************************/
+static void process_lagging_connections(void)
+{
+  if (game.server.netlagbytes == 0 || S_S_RUNNING != server_state()) {
+    return;
+  }
+
+  conn_list_iterate(game.est_connections, pconn) {
+    size_t backlog;
+
+    if (pconn->server.is_closing) {
+      continue;
+    }
+    backlog = connection_send_backlog(pconn);
+
+    if (!pconn->server.reduced_updates) {
+      if (backlog > (size_t) game.server.netlagbytes) {
+        pconn->server.reduced_updates = TRUE;
+        log_verbose("connection (%s) switched to reduced updates "
+                    "(backlog %lu bytes)",
+                    conn_description(pconn), (unsigned long) backlog);
+      }
+    } else if (backlog == 0) {
+      pconn->server.reduced_updates = FALSE;
+      log_verbose("connection (%s) caught up; resyncing",
+                  conn_description(pconn));
+      /* The delta caches still describe packets the connection never
+       * got; reset them before sending the snapshot. */
+      conn_reset_delta_state(pconn);
+      conn_compression_freeze(pconn);
+      send_all_info(pconn->self);
+      conn_compression_thaw(pconn);
+    }
+  } conn_list_iterate_end;
+}
+
+/*************************************************************************//**
+  Drop the data queued for 'pconn' and wait until the writer thread is
+  no longer touching its socket. Must be called before the socket is
+  closed, so that a reused descriptor number cannot receive data meant
+  for the old connection.
+*****************************************************************************/
+static void net_writer_forget(struct connection *pconn)
+{
+  struct net_writer_slot *slot;
+
+  if (!net_writer_active
+      || pconn < connections
+      || pconn >= connections + MAX_NUM_CONNECTIONS) {
+    return;
+  }
+
+  slot = &writer_slots[pconn - connections];
+
+  fc_mutex_allocate(&net_writer_mutex);
+  byte_vector_free(&slot->pending);
+  byte_vector_init(&slot->pending);
+  slot->cancelled = TRUE;
+  while (slot->busy) {
+    fc_thread_cond_wait(&net_writer_done, &net_writer_mutex);
+  }
+  slot->cancelled = FALSE;
+  slot->failed = FALSE;
+  fc_mutex_release(&net_writer_mutex);
+}
+
+/*************************************************************************//**
+  Start the writer thread and route send buffer flushes through it.
+  Without a working condition variable implementation socket writes
+  simply stay on the main thread, as they used to.
+*****************************************************************************/
+static void net_writer_start(void)
+{
+  int i;
+
+  if (!has_thread_cond_impl()) {
+    return;
+  }
+
+  for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    byte_vector_init(&writer_slots[i].pending);
+    writer_slots[i].busy = FALSE;
+    writer_slots[i].cancelled = FALSE;
+    writer_slots[i].failed = FALSE;
+  }
+
+  fc_mutex_init(&net_writer_mutex);
+  fc_thread_cond_init(&net_writer_wake);
+  fc_thread_cond_init(&net_writer_done);
+  net_writer_stop = FALSE;
+
+  if (fc_thread_start(&net_writer_thread, net_writer_run, NULL) == 0) {
+    net_writer_active = TRUE;
+    connections_set_write_callback(net_writer_handoff);
+  } else {
+    log_error("Failed to start the network writer thread; "
+              "keeping socket writes on the main thread.");
+    fc_thread_cond_destroy(&net_writer_done);
+    fc_thread_cond_destroy(&net_writer_wake);
+    fc_mutex_destroy(&net_writer_mutex);
+  }
+}
+
+/*************************************************************************//**
+  Stop the writer thread. Data still queued for it is dropped, so any
+  last packets sent after this go out synchronously again.
+*****************************************************************************/
+static void net_writer_shutdown(void)
+{
+  int i;
+
+  if (!net_writer_active) {
+    return;
+  }
+
+  connections_set_write_callback(NULL);
+
+  fc_mutex_allocate(&net_writer_mutex);
+  net_writer_stop = TRUE;
+  fc_thread_cond_signal(&net_writer_wake);
+  fc_mutex_release(&net_writer_mutex);
+
+  fc_thread_wait(&net_writer_thread);
+
+  for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    byte_vector_free(&writer_slots[i].pending);
+  }
+
+  fc_thread_cond_destroy(&net_writer_done);
+  fc_thread_cond_destroy(&net_writer_wake);
+  fc_mutex_destroy(&net_writer_mutex);
+  net_writer_active = FALSE;
+}
+
+/*************************************************************************//**
+  TRUE iff socket writes go through the asynchronous writer thread, in
+  which case flush_packets() is a non-blocking handoff. Callers use this
+  to decide whether flushing in the middle of a computation would
+  overlap with it or stall it.
+*****************************************************************************/
+bool is_net_writer_active(void)
+{
+  return net_writer_active;
+}
+
 /*************************************************************************//**
   Attempt to flush all information in the send buffers for upto 'netwait'
   seconds.
@@ -376,11 +790,27 @@ static void cut_lagging_connection(struct connection *pconn)
 void flush_packets(void)
 {
   int i;
-  int max_desc;
-  fd_set writefs, exceptfs;
+  int pending;
   fc_timeval tv;
   time_t start;
 
+  if (net_writer_active) {
+    /* Socket writes happen on the writer thread. Hand over whatever
+     * is still buffered and close the connections the writer gave up
+     * on, instead of waiting for sockets here. */
+    for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+      struct connection *pconn = &connections[i];
+
+      if (pconn->used
+          && !pconn->server.is_closing
+          && 0 < pconn->send_buffer->ndata) {
+        flush_connection_send_buffer_all(pconn);
+      }
+    }
+    net_writer_process_failures();
+    return;
+  }
+
   (void) time(&start);
 
   for (;;) {
@@ -394,9 +824,8 @@ void flush_packets(void)
     tv.tv_usec = 0;
     tv.tv_sec = signsecs;
 
-    FC_FD_ZERO(&writefs);
-    FC_FD_ZERO(&exceptfs);
-    max_desc = -1;
+    fc_eventset_monitor_begin(server_events);
+    pending = 0;
 
     for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
       struct connection *pconn = &connections[i];
@@ -404,17 +833,17 @@ void flush_packets(void)
       if (pconn->used
           && !pconn->server.is_closing
           && 0 < pconn->send_buffer->ndata) {
-        FD_SET(pconn->sock, &writefs);
-        FD_SET(pconn->sock, &exceptfs);
-        max_desc = MAX(pconn->sock, max_desc);
+        fc_eventset_monitor(server_events, pconn->sock,
+                            FALSE, TRUE, TRUE);
+        pending++;
       }
     }
 
-    if (max_desc == -1) {
+    if (pending == 0) {
       return;
     }
 
-    if (fc_select(max_desc + 1, NULL, &writefs, &exceptfs, &tv) <= 0) {
+    if (fc_eventset_wait(server_events, &tv) <= 0) {
       return;
     }
 
@@ -422,13 +851,13 @@ void flush_packets(void)
       struct connection *pconn = &connections[i];
 
       if (pconn->used && !pconn->server.is_closing) {
-        if (FD_ISSET(pconn->sock, &exceptfs)) {
+        if (fc_eventset_excepted(server_events, pconn->sock)) {
           log_verbose("connection (%s) cut due to exception data",
                       conn_description(pconn));
           connection_close_server(pconn, _("network exception"));
         } else {
           if (pconn->send_buffer && pconn->send_buffer->ndata > 0) {
-            if (FD_ISSET(pconn->sock, &writefs)) {
+            if (fc_eventset_writable(server_events, pconn->sock)) {
               flush_connection_send_buffer_all(pconn);
             } else {
               cut_lagging_connection(pconn);
@@ -510,6 +939,115 @@ static void incoming_client_packets(struct connection *pconn)
 #endif /* PROCESSING_TIME_STATISTICS */
 }
 
+/* Recorded connection id each replay connection stands in for,
+ * by connections[] slot. */
+static int replay_conn_ids[MAX_NUM_CONNECTIONS];
+
+/*************************************************************************//**
+  Return the replay connection standing in for the given recorded
+  connection id, or NULL.
+*****************************************************************************/
+static struct connection *replay_conn_by_id(int conn_id)
+{
+  int i;
+
+  for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    if (connections[i].used && replay_conn_ids[i] == conn_id) {
+      return &connections[i];
+    }
+  }
+
+  return NULL;
+}
+
+/*************************************************************************//**
+  Feed recorded session inputs through the normal processing paths,
+  standing in for server_sniff_all_input() during --replay. Runs at
+  full speed; each call processes records up to the next turn marker.
+  See sessionrec.c for the record format.
+*****************************************************************************/
+static enum server_events session_replay_pump(void)
+{
+  struct session_rec rec;
+
+  while (TRUE) {
+    struct connection *pconn;
+
+    if (force_end_of_sniff) {
+      force_end_of_sniff = FALSE;
+      return S_E_FORCE_END_OF_SNIFF;
+    }
+
+    if (!session_replay_next(&rec)) {
+      log_normal(_("Session replay complete."));
+      session_replay_stop();
+      server_quit();
+    }
+
+    switch (rec.kind) {
+    case SREC_CONN_OPEN:
+      {
+        /* A sink the send paths can write to without anyone there. */
+#ifdef HAVE_FCNTL_H
+        int sink = open("/dev/null", O_WRONLY);
+#else
+        int sink = -1;
+#endif
+        int i;
+
+        if (sink < 0
+            || server_make_connection(sink, "replay", "127.0.0.1") != 0) {
+          log_error("Could not create replay connection %d.", rec.conn_id);
+          break;
+        }
+        for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+          if (connections[i].used && connections[i].sock == sink) {
+            replay_conn_ids[i] = rec.conn_id;
+            break;
+          }
+        }
+      }
+      break;
+    case SREC_CONN_CLOSE:
+      pconn = replay_conn_by_id(rec.conn_id);
+      if (pconn != NULL && !pconn->server.is_closing) {
+        connection_close_server(pconn, _("replayed disconnect"));
+      }
+      break;
+    case SREC_DATA:
+      pconn = replay_conn_by_id(rec.conn_id);
+      if (pconn == NULL || pconn->server.is_closing) {
+        log_error("Session replay desync: data for unknown "
+                  "connection %d.", rec.conn_id);
+        break;
+      }
+      if (pconn->buffer->ndata + rec.len > pconn->buffer->nsize) {
+        pconn->buffer->nsize = pconn->buffer->ndata + rec.len;
+        pconn->buffer->data = fc_realloc(pconn->buffer->data,
+                                         pconn->buffer->nsize);
+      }
+      memcpy(pconn->buffer->data + pconn->buffer->ndata,
+             rec.data, rec.len);
+      pconn->buffer->ndata += rec.len;
+      incoming_client_packets(pconn);
+      break;
+    case SREC_CONSOLE:
+      handle_stdin_input_free(NULL,
+                              fc_strdup(rec.len > 0
+                                        ? (const char *) rec.data : ""));
+      break;
+    case SREC_SEED:
+      /* Normally consumed by init_game_seed(); apply it anyway. */
+      log_verbose("Session replay: stray seed record.");
+      fc_srand(rec.seed);
+      break;
+    case SREC_TURN:
+      /* End the turn where the recorded session ended it. */
+      return S_E_END_OF_TURN_TIMEOUT;
+    }
+  }
+}
+
 /*************************************************************************//**
   Get and handle:
   - new connections,
@@ -522,16 +1060,22 @@ static void incoming_client_packets(struct connection *pconn)
 enum server_events server_sniff_all_input(void)
 {
   int i, s;
-  int max_desc;
   bool excepting;
-  fd_set readfs, writefs, exceptfs;
   fc_timeval tv;
 #ifdef FREECIV_SOCKET_ZERO_NOT_STDIN
   char *bufptr;
+#else
+  bool stdin_ready = FALSE;
 #endif
 
   con_prompt_init();
 
+  if (session_replay_active()) {
+    /* All external input comes from the record; no console, no
+     * sockets, no waiting. */
+    return session_replay_pump();
+  }
+
 #ifdef FREECIV_HAVE_LIBREADLINE
   {
     if (!no_input && !readline_initialized) {
@@ -582,6 +1126,12 @@ enum server_events server_sniff_all_input(void)
       return S_E_FORCE_END_OF_SNIFF;
     }
 
+    /* Cut the connections the writer thread gave up on. */
+    net_writer_process_failures();
+
+    /* Throttle or resync the connections that cannot keep up. */
+    process_lagging_connections();
+
     get_lanserver_announcement();
 
     /* end server if no players for 'srvarg.quitidle' seconds,
@@ -670,6 +1220,12 @@ enum server_events server_sniff_all_input(void)
       game.server.last_ping = time(NULL);
     }
 
+    /* dispatch results of database queries finished on the auth worker
+     * thread */
+    if (srvarg.auth_enabled) {
+      auth_process_queue();
+    }
+
     /* if we've waited long enough after a failure, respond to the client */
     conn_list_iterate(game.all_connections, pconn) {
       if (srvarg.auth_enabled
@@ -690,42 +1246,38 @@ enum server_events server_sniff_all_input(void)
     tv.tv_sec = 1;
     tv.tv_usec = 0;
 
-    FC_FD_ZERO(&readfs);
-    FC_FD_ZERO(&writefs);
-    FC_FD_ZERO(&exceptfs);
+    fc_eventset_monitor_begin(server_events);
 
     if (!no_input) {
 #ifdef FREECIV_SOCKET_ZERO_NOT_STDIN
       fc_init_console();
 #else /* FREECIV_SOCKET_ZERO_NOT_STDIN */
 #   if !defined(__VMS)
-      FD_SET(0, &readfs);
+      fc_eventset_monitor(server_events, 0, TRUE, FALSE, FALSE);
 #   endif /* VMS */
 #endif /* FREECIV_SOCKET_ZERO_NOT_STDIN */
     }
 
-    max_desc = 0;
     for (i = 0; i < listen_count; i++) {
-      FD_SET(listen_socks[i], &readfs);
-      FD_SET(listen_socks[i], &exceptfs);
-      max_desc = MAX(max_desc, listen_socks[i]);
+      fc_eventset_monitor(server_events, listen_socks[i],
+                          TRUE, FALSE, TRUE);
     }
 
     for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
       struct connection *pconn = connections + i;
 
       if (pconn->used && !pconn->server.is_closing) {
-        FD_SET(pconn->sock, &readfs);
-        if (0 < pconn->send_buffer->ndata) {
-          FD_SET(pconn->sock, &writefs);
-        }
-        FD_SET(pconn->sock, &exceptfs);
-        max_desc = MAX(pconn->sock, max_desc);
+        fc_eventset_monitor(server_events, pconn->sock,
+                            TRUE, 0 < pconn->send_buffer->ndata, TRUE);
       }
     }
     con_prompt_off();    /* output doesn't generate a new prompt */
 
-    selret = fc_select(max_desc + 1, &readfs, &writefs, &exceptfs, &tv);
+    selret = fc_eventset_wait(server_events, &tv);
+#ifndef FREECIV_SOCKET_ZERO_NOT_STDIN
+    stdin_ready = (selret > 0 && !no_input
+                   && fc_eventset_readable(server_events, 0));
+#endif /* FREECIV_SOCKET_ZERO_NOT_STDIN */
     if (selret == 0) {
       /* timeout */
       call_ai_refresh();
@@ -771,7 +1323,7 @@ enum server_events server_sniff_all_input(void)
             lib$stop(status);
           }
           if (ttchar.numchars) {
-            FD_SET(0, &readfs);
+            stdin_ready = TRUE;
           } else {
             continue;
           }
@@ -784,12 +1336,13 @@ enum server_events server_sniff_all_input(void)
 #endif /* !__VMS */
       }
     } else if (selret < 0) {
-      log_error("fc_select() failed: %s", fc_strerror(fc_get_errno()));
+      log_error("fc_eventset_wait() failed: %s",
+                fc_strerror(fc_get_errno()));
     }
 
     excepting = FALSE;
     for (i = 0; i < listen_count; i++) {
-      if (FD_ISSET(listen_socks[i], &exceptfs)) {
+      if (fc_eventset_excepted(server_events, listen_socks[i])) {
         excepting = TRUE;
         break;
       }
@@ -799,7 +1352,7 @@ enum server_events server_sniff_all_input(void)
     }
     for (i = 0; i < listen_count; i++) {
       s = listen_socks[i];
-      if (FD_ISSET(s, &readfs)) {     /* new players connects */
+      if (fc_eventset_readable(server_events, s)) { /* new players connects */
         log_verbose("got new connection");
         if (-1 == server_accept_connection(s)) {
           /* There will be a log_error() message from
@@ -816,7 +1369,7 @@ enum server_events server_sniff_all_input(void)
 
       if (pconn->used
           && !pconn->server.is_closing
-          && FD_ISSET(pconn->sock, &exceptfs)) {
+          && fc_eventset_excepted(server_events, pconn->sock)) {
         log_verbose("connection (%s) cut due to exception data",
                     conn_description(pconn));
         connection_close_server(pconn, _("network exception"));
@@ -827,11 +1380,12 @@ enum server_events server_sniff_all_input(void)
       current_internal = local_to_internal_string_malloc(bufptr);
 
       con_prompt_enter();     /* Will need a new prompt, regardless */
+      session_record_console(current_internal);
       handle_stdin_input_free(NULL, current_internal);
       current_internal = NULL;
     }
 #else  /* !FREECIV_SOCKET_ZERO_NOT_STDIN */
-    if (!no_input && FD_ISSET(0, &readfs)) {    /* input from server operator */
+    if (!no_input && stdin_ready) {    /* input from server operator */
 #ifdef FREECIV_HAVE_LIBREADLINE
       rl_callback_read_char();
       if (readline_handled_input) {
@@ -871,6 +1425,7 @@ enum server_events server_sniff_all_input(void)
 
       if (didget >= 0) {
         current_internal = local_to_internal_string_malloc(buffer);
+        session_record_console(current_internal);
         handle_stdin_input_free(NULL, current_internal);
         current_internal = NULL;
       }
@@ -886,12 +1441,17 @@ enum server_events server_sniff_all_input(void)
 
         if (!pconn->used
             || pconn->server.is_closing
-            || !FD_ISSET(pconn->sock, &readfs)) {
+            || !fc_eventset_readable(server_events, pconn->sock)) {
           continue;
         }
 
+        int ndata_before = pconn->buffer->ndata;
+
         nb = read_socket_data(pconn->sock, pconn->buffer);
         if (0 <= nb) {
+          session_record_data(pconn->id,
+                              pconn->buffer->data + ndata_before,
+                              pconn->buffer->ndata - ndata_before);
           /* We read packets; now handle them. */
           incoming_client_packets(pconn);
         } else if (-2 == nb) {
@@ -909,7 +1469,7 @@ enum server_events server_sniff_all_input(void)
             && !pconn->server.is_closing
             && pconn->send_buffer
             && pconn->send_buffer->ndata > 0) {
-          if (FD_ISSET(pconn->sock, &writefs)) {
+          if (fc_eventset_writable(server_events, pconn->sock)) {
             flush_connection_send_buffer_all(pconn);
           } else {
             cut_lagging_connection(pconn);
@@ -1097,6 +1657,8 @@ int server_make_connection(int new_sock, const char *client_addr,
       pconn->server.ignore_list =
           conn_pattern_list_new_full(conn_pattern_destroy);
       pconn->server.is_closing = FALSE;
+      pconn->server.reduced_updates = FALSE;
+      pconn->server.tile_info_dirty_count = 0;
       pconn->ping_time = -1.0;
       pconn->incoming_packet_notify = NULL;
       pconn->outgoing_packet_notify = NULL;
@@ -1116,6 +1678,8 @@ int server_make_connection(int new_sock, const char *client_addr,
       timer_start(timer);
       timer_list_append(pconn->server.ping_timers, timer);
 
+      session_record_conn_open(pconn->id);
+
       return 0;
     }
   }
@@ -1368,6 +1932,8 @@ void init_connections(void)
   game.glob_observers = conn_list_new();
   game.web_client_connections = conn_list_new();
 
+  server_events = fc_eventset_new();
+
   for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
     struct connection *pconn = &connections[i];
 
@@ -1375,6 +1941,8 @@ void init_connections(void)
     pconn->self = conn_list_new();
     conn_list_prepend(pconn->self, pconn);
   }
+
+  net_writer_start();
 #if defined(__VMS)
   {
     unsigned long status;
@@ -17,6 +17,9 @@
 extern "C" {
 #endif /* __cplusplus */
 
+/* utility */
+#include "support.h"            /* bool type */
+
 struct connection;
 
 #define BUF_SIZE 512
@@ -35,6 +38,8 @@ enum server_events server_sniff_all_input(void);
 
 int server_open_socket(void);
 void flush_packets(void);
+bool is_net_writer_active(void);
+size_t connection_send_backlog(const struct connection *pconn);
 void close_connections_and_socket(void);
 void init_connections(void);
 int server_make_connection(int new_sock,
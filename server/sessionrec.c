@@ -0,0 +1,331 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+/* utility */
+#include "fcintl.h"
+#include "log.h"
+#include "mem.h"
+#include "support.h"
+#include "timing.h"
+
+#include "sessionrec.h"
+
+/*
+ * Deterministic session record and replay.
+ *
+ * Recording (--record FILE) logs every external input the server
+ * acts on: raw bytes read from each client socket, server console
+ * lines, the game seed, and a marker at each turn change. Replaying
+ * (--replay FILE) re-executes the session at full speed by feeding
+ * the recorded inputs back through the normal processing paths - see
+ * session_replay_pump() in sernet.c. A replay is deterministic when
+ * the replaying server is started with the same command line, script
+ * and data files as the recording one; everything else (RNG, client
+ * packets, commands, turn boundaries) comes from the record.
+ *
+ * On-disk format: SESSION_REC_MAGIC, then per record a double
+ * timestamp, one kind byte, two ints, and for SREC_DATA/SREC_CONSOLE
+ * a payload whose size is the second int. Host endian, like the
+ * ".fcap" packet captures.
+ */
+
+static FILE *record_fp = NULL;
+static struct timer *record_timer = NULL;
+
+static FILE *replay_fp = NULL;
+static unsigned char *replay_buf = NULL;
+static int replay_buf_size = 0;
+static struct session_rec replay_pushback;
+static bool replay_have_pushback = FALSE;
+
+/**********************************************************************//**
+  Begin recording session inputs to the given file.
+**************************************************************************/
+bool session_record_start(const char *filename)
+{
+  fc_assert_ret_val(record_fp == NULL, FALSE);
+
+  record_fp = fc_fopen(filename, "wb");
+  if (record_fp == NULL) {
+    log_error(_("Could not open session record file \"%s\"."), filename);
+    return FALSE;
+  }
+  fwrite(SESSION_REC_MAGIC, 1, strlen(SESSION_REC_MAGIC), record_fp);
+
+  record_timer = timer_new(TIMER_USER, TIMER_ACTIVE, "session record");
+  timer_start(record_timer);
+
+  log_normal(_("Recording session to \"%s\"."), filename);
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Stop recording and close the record file.
+**************************************************************************/
+void session_record_stop(void)
+{
+  if (record_fp != NULL) {
+    fclose(record_fp);
+    record_fp = NULL;
+  }
+  if (record_timer != NULL) {
+    timer_destroy(record_timer);
+    record_timer = NULL;
+  }
+}
+
+/**********************************************************************//**
+  Is a session being recorded?
+**************************************************************************/
+bool session_record_active(void)
+{
+  return record_fp != NULL;
+}
+
+/**********************************************************************//**
+  Append one record. 'payload' may be NULL when 'len' is zero.
+**************************************************************************/
+static void session_record_write(enum session_rec_kind kind,
+                                 int a, int len,
+                                 const unsigned char *payload)
+{
+  double now = timer_read_seconds(record_timer);
+  unsigned char byte = kind;
+  int v[2] = { a, len };
+
+  fwrite(&now, sizeof(now), 1, record_fp);
+  fwrite(&byte, 1, 1, record_fp);
+  fwrite(v, sizeof(v), 1, record_fp);
+  if (len > 0) {
+    fwrite(payload, 1, len, record_fp);
+  }
+}
+
+/**********************************************************************//**
+  Record that a connection with the given id was accepted.
+**************************************************************************/
+void session_record_conn_open(int conn_id)
+{
+  if (record_fp != NULL) {
+    session_record_write(SREC_CONN_OPEN, conn_id, 0, NULL);
+  }
+}
+
+/**********************************************************************//**
+  Record that the connection with the given id was closed.
+**************************************************************************/
+void session_record_conn_close(int conn_id)
+{
+  if (record_fp != NULL) {
+    session_record_write(SREC_CONN_CLOSE, conn_id, 0, NULL);
+  }
+}
+
+/**********************************************************************//**
+  Record raw bytes read from the socket of the given connection.
+**************************************************************************/
+void session_record_data(int conn_id, const unsigned char *data, int len)
+{
+  if (record_fp != NULL && len > 0) {
+    session_record_write(SREC_DATA, conn_id, len, data);
+  }
+}
+
+/**********************************************************************//**
+  Record one line of server console input, before it is handled.
+**************************************************************************/
+void session_record_console(const char *line)
+{
+  if (record_fp != NULL) {
+    session_record_write(SREC_CONSOLE, 0, strlen(line),
+                         (const unsigned char *) line);
+  }
+}
+
+/**********************************************************************//**
+  Record the seed the game RNG was fed.
+**************************************************************************/
+void session_record_seed(RANDOM_TYPE seed)
+{
+  if (record_fp != NULL) {
+    session_record_write(SREC_SEED, (int) seed, 0, NULL);
+  }
+}
+
+/**********************************************************************//**
+  Record that the given turn ended. Replay uses these markers to end
+  its turns at the recorded points instead of on the timeout.
+**************************************************************************/
+void session_record_turn(int turn)
+{
+  if (record_fp != NULL) {
+    session_record_write(SREC_TURN, turn, 0, NULL);
+    /* A crashing or killed server should still leave a usable record;
+     * a turn boundary is a cheap enough place to make sure. */
+    fflush(record_fp);
+  }
+}
+
+/**********************************************************************//**
+  Open the given session record file for replay.
+**************************************************************************/
+bool session_replay_start(const char *filename)
+{
+  char magic[sizeof(SESSION_REC_MAGIC)];
+
+  fc_assert_ret_val(replay_fp == NULL, FALSE);
+
+  replay_fp = fc_fopen(filename, "rb");
+  if (replay_fp == NULL) {
+    log_error(_("Could not open session record file \"%s\"."), filename);
+    return FALSE;
+  }
+  if (fread(magic, 1, strlen(SESSION_REC_MAGIC), replay_fp)
+      != strlen(SESSION_REC_MAGIC)
+      || memcmp(magic, SESSION_REC_MAGIC, strlen(SESSION_REC_MAGIC)) != 0) {
+    log_error(_("\"%s\" is not a session record file."), filename);
+    fclose(replay_fp);
+    replay_fp = NULL;
+    return FALSE;
+  }
+
+  log_normal(_("Replaying session from \"%s\"."), filename);
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Stop replaying and release the reader state.
+**************************************************************************/
+void session_replay_stop(void)
+{
+  if (replay_fp != NULL) {
+    fclose(replay_fp);
+    replay_fp = NULL;
+  }
+  if (replay_buf != NULL) {
+    FC_FREE(replay_buf);
+    replay_buf_size = 0;
+  }
+  replay_have_pushback = FALSE;
+}
+
+/**********************************************************************//**
+  Is a session being replayed?
+**************************************************************************/
+bool session_replay_active(void)
+{
+  return replay_fp != NULL;
+}
+
+/**********************************************************************//**
+  Read the next record. Returns FALSE at the end of the record, or on
+  a truncated file. rec->data stays valid until the next call.
+**************************************************************************/
+bool session_replay_next(struct session_rec *rec)
+{
+  double ts;
+  unsigned char kind;
+  int v[2];
+
+  if (replay_fp == NULL) {
+    return FALSE;
+  }
+  if (replay_have_pushback) {
+    *rec = replay_pushback;
+    replay_have_pushback = FALSE;
+    return TRUE;
+  }
+
+  if (fread(&ts, sizeof(ts), 1, replay_fp) != 1
+      || fread(&kind, 1, 1, replay_fp) != 1
+      || fread(v, sizeof(v), 1, replay_fp) != 1) {
+    return FALSE;
+  }
+
+  memset(rec, 0, sizeof(*rec));
+  rec->kind = kind;
+  rec->timestamp = ts;
+
+  switch (rec->kind) {
+  case SREC_CONN_OPEN:
+  case SREC_CONN_CLOSE:
+    rec->conn_id = v[0];
+    break;
+  case SREC_DATA:
+    rec->conn_id = v[0];
+    break;
+  case SREC_SEED:
+    rec->seed = (RANDOM_TYPE) v[0];
+    break;
+  case SREC_TURN:
+    rec->turn = v[0];
+    break;
+  case SREC_CONSOLE:
+    break;
+  default:
+    log_error("Unknown session record kind '%c'.", kind);
+    return FALSE;
+  }
+
+  rec->len = v[1];
+  if (rec->len > 0) {
+    if (rec->len > replay_buf_size) {
+      replay_buf = fc_realloc(replay_buf, rec->len + 1);
+      replay_buf_size = rec->len;
+    }
+    if (fread(replay_buf, 1, rec->len, replay_fp) != (size_t) rec->len) {
+      log_error("Truncated session record file.");
+      return FALSE;
+    }
+    /* Terminate so SREC_CONSOLE payloads can be used as strings. */
+    replay_buf[rec->len] = '\0';
+    rec->data = replay_buf;
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Fetch the recorded game seed. Called from init_game_seed(), at which
+  point the seed record is the next one in the stream; if it is not,
+  the replay has diverged from the recording and the record is pushed
+  back unread.
+**************************************************************************/
+bool session_replay_seed(RANDOM_TYPE *seed)
+{
+  struct session_rec rec;
+
+  if (!session_replay_next(&rec)) {
+    return FALSE;
+  }
+  if (rec.kind != SREC_SEED) {
+    log_error("Session replay desync: expected the seed record, "
+              "got '%c'.", rec.kind);
+    replay_pushback = rec;
+    replay_have_pushback = TRUE;
+    return FALSE;
+  }
+
+  *seed = rec.seed;
+
+  return TRUE;
+}
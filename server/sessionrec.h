@@ -0,0 +1,70 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__SESSIONREC_H
+#define FC__SESSIONREC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* utility */
+#include "rand.h"               /* RANDOM_TYPE */
+#include "support.h"            /* bool type */
+
+/* Header of the ".fcsr" session record files written with --record and
+ * read back with --replay. The records following it are host endian. */
+#define SESSION_REC_MAGIC "FCSR1\n"
+
+/* One record of external server input. */
+enum session_rec_kind {
+  SREC_CONN_OPEN = 'O',         /* A connection was accepted */
+  SREC_CONN_CLOSE = 'X',        /* A connection was closed */
+  SREC_DATA = 'D',              /* Raw bytes read from a connection */
+  SREC_CONSOLE = 'L',           /* A line of server console input */
+  SREC_SEED = 'G',              /* The game seed the RNG was fed */
+  SREC_TURN = 'T'               /* A turn ended */
+};
+
+struct session_rec {
+  enum session_rec_kind kind;
+  double timestamp;             /* Seconds since recording started */
+  int conn_id;                  /* SREC_CONN_OPEN/CLOSE/DATA */
+  int len;                      /* Payload size, SREC_DATA/CONSOLE */
+  int turn;                     /* SREC_TURN */
+  RANDOM_TYPE seed;             /* SREC_SEED */
+  /* Payload; owned by the reader, valid until the next
+   * session_replay_next() call. */
+  unsigned char *data;
+};
+
+bool session_record_start(const char *filename);
+void session_record_stop(void);
+bool session_record_active(void);
+void session_record_conn_open(int conn_id);
+void session_record_conn_close(int conn_id);
+void session_record_data(int conn_id, const unsigned char *data, int len);
+void session_record_console(const char *line);
+void session_record_seed(RANDOM_TYPE seed);
+void session_record_turn(int turn);
+
+bool session_replay_start(const char *filename);
+void session_replay_stop(void);
+bool session_replay_active(void);
+bool session_replay_next(struct session_rec *rec);
+bool session_replay_seed(RANDOM_TYPE *seed);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FC__SESSIONREC_H */
@@ -18,6 +18,7 @@
 /* utility */
 #include "astring.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "game.h"
 #include "ioz.h"
 #include "log.h"
@@ -729,6 +730,14 @@ static void aifill_action(const struct setting *pset)
   }
 }
 
+/************************************************************************//**
+  Resize the shared worker thread pool.
+****************************************************************************/
+static void threadpoolsize_action(const struct setting *pset)
+{
+  fc_taskpool_global_resize(*pset->integer.pvalue);
+}
+
 /************************************************************************//**
   Restrict to the selected nation set.
 ****************************************************************************/
@@ -1834,6 +1843,16 @@ static struct setting settings[] = {
              "jungles, and rivers."), nullptr, nullptr, nullptr,
           MAP_MIN_WETNESS, MAP_MAX_WETNESS, MAP_DEFAULT_WETNESS)
 
+  GEN_BOOL("flowrivers", wld.map.server.flowrivers,
+           SSET_MAP_GEN, SSET_GEOLOGY, SSET_RARE, ALLOW_NONE, ALLOW_BASIC,
+           N_("Generate rivers from height map drainage"),
+           N_("If enabled, the map generator lays out rivers by tracing "
+              "how water drains down the generated height map and turning "
+              "the streams collecting the most flow into rivers, instead "
+              "of growing each river by a random walk. This is "
+              "considerably faster on large maps."), nullptr, nullptr,
+           MAP_DEFAULT_FLOWRIVERS)
+
   GEN_BOOL("globalwarming", game.info.global_warming,
            SSET_RULES, SSET_GEOLOGY, SSET_VITAL, ALLOW_NONE, ALLOW_BASIC,
            N_("Global warming"),
@@ -3052,6 +3071,20 @@ static struct setting settings[] = {
              "wait at all."), nullptr, nullptr, nullptr,
           GAME_MIN_NETWAIT, GAME_MAX_NETWAIT, GAME_DEFAULT_NETWAIT)
 
+  GEN_INT("netlagbytes", game.server.netlagbytes,
+          SSET_META, SSET_NETWORK, SSET_RARE, ALLOW_NONE, ALLOW_BASIC,
+          N_("Send backlog that switches a client to reduced updates"),
+          N_("When a client connection has this many bytes queued and "
+             "not yet written to its socket, the server stops sending "
+             "it game state updates instead of letting the backlog "
+             "grow. Once the backlog has drained, the client is "
+             "resynchronized with a full snapshot of the game state. "
+             "Zero disables the mechanism, leaving only the "
+             "'nettimeout' disconnection policy."),
+          nullptr, nullptr, nullptr,
+          GAME_MIN_NETLAGBYTES, GAME_MAX_NETLAGBYTES,
+          GAME_DEFAULT_NETLAGBYTES)
+
   GEN_INT("pingtime", game.server.pingtime,
           SSET_META, SSET_NETWORK, SSET_RARE, ALLOW_NONE, ALLOW_BASIC,
           N_("Seconds between PINGs"),
@@ -3192,6 +3225,53 @@ static struct setting settings[] = {
               "users are not required to wait for the save to finish."),
            nullptr, nullptr, GAME_DEFAULT_THREADED_SAVE)
 
+  GEN_INT("threadpoolsize", game.server.threadpoolsize,
+          SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+          N_("Size of the shared worker thread pool"),
+          N_("Number of worker threads in the pool that parallelized "
+             "server tasks are scheduled on. Set to 0 to use one "
+             "thread per available processor. A change takes effect "
+             "the next time the pool is used."),
+          nullptr, nullptr, threadpoolsize_action,
+          GAME_MIN_THREADPOOLSIZE, GAME_MAX_THREADPOOLSIZE,
+          GAME_DEFAULT_THREADPOOLSIZE)
+
+  GEN_BOOL("forked_save", game.server.forked_save,
+           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+           N_("Whether to save in a forked child process"),
+           /* TRANS: The string between single quotes is a setting name
+            * and should not be translated. */
+           N_("If this is enabled, the game state is snapshotted with a "
+              "copy-on-write fork() and both serialization and "
+              "compression of the savegame happen in the child process, "
+              "so not even building the save data blocks the game, as "
+              "it does with 'threaded_save'. Scenario saves are not "
+              "affected. Has no effect on systems without fork()."),
+           nullptr, nullptr, GAME_DEFAULT_FORKED_SAVE)
+
+  GEN_BOOL("binarysaves", game.server.binary_save,
+           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+           N_("Whether to write savegames in the binary format"),
+           N_("If this is enabled, savegames are written as binary "
+              "records instead of ini-style text, which is faster to "
+              "both write and read back. The server loads either "
+              "format regardless of this setting. Scenarios are "
+              "always saved as text so that they stay editable."),
+           nullptr, nullptr, GAME_DEFAULT_BINARY_SAVE)
+
+  GEN_BOOL("deltasaves", game.server.delta_saves,
+           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+           N_("Whether turn autosaves are incremental"),
+           /* TRANS: The string between single quotes is a setting name
+            * and should not be translated. */
+           N_("If this is enabled, an autosave is written every turn: "
+              "a full save every 'saveturns' turns as usual, and on the "
+              "turns in between a delta save holding only the savegame "
+              "sections that changed since the last full save. Loading "
+              "a delta save requires its base save to still be on "
+              "disk."),
+           nullptr, nullptr, GAME_DEFAULT_DELTA_SAVES)
+
   GEN_INT("compress", game.server.save_compress_level,
           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
           N_("Savegame compression level"),
@@ -3335,6 +3415,13 @@ static struct setting settings[] = {
 /* The number of settings, not including the END. */
 static const int SETTINGS_NUM = ARRAY_SIZE(settings);
 
+/* Batched setting broadcasts: while a batch is open, broadcast sends of
+ * single settings are only marked here and flushed once when the
+ * outermost batch closes, so commands that touch many settings (reading
+ * a script file, /reset) do not emit one update storm per setting. */
+static int setting_batch_depth = 0;
+static bool setting_batch_pending[ARRAY_SIZE(settings)];
+
 /************************************************************************//**
   Returns the setting to the given id.
 ****************************************************************************/
@@ -5304,12 +5391,67 @@ int settings_number(void)
   return SETTINGS_NUM;
 }
 
+/************************************************************************//**
+  Open a setting broadcast batch. Batches nest; only closing the
+  outermost one flushes.
+****************************************************************************/
+void send_server_setting_batch_begin(void)
+{
+  setting_batch_depth++;
+}
+
+/************************************************************************//**
+  Close a setting broadcast batch. When the outermost batch is closed,
+  every setting marked while batching was active is broadcast once,
+  within a single connection buffer. Returns whether any setting was
+  flushed.
+****************************************************************************/
+bool send_server_setting_batch_end(void)
+{
+  bool flushed = FALSE;
+  int i;
+
+  fc_assert_ret_val(setting_batch_depth > 0, FALSE);
+
+  if (--setting_batch_depth > 0) {
+    return FALSE;
+  }
+
+  conn_list_do_buffer(game.est_connections);
+  for (i = 0; i < SETTINGS_NUM; i++) {
+    if (setting_batch_pending[i]) {
+      setting_batch_pending[i] = FALSE;
+      send_server_setting(game.est_connections, settings + i);
+      flushed = TRUE;
+    }
+  }
+  conn_list_do_unbuffer(game.est_connections);
+
+  return flushed;
+}
+
+/************************************************************************//**
+  Is a setting broadcast batch currently open?
+****************************************************************************/
+bool send_server_setting_batch_active(void)
+{
+  return setting_batch_depth > 0;
+}
+
 /************************************************************************//**
   Tell the client about just one server setting.  Call this after a setting
   is saved.
 ****************************************************************************/
 void send_server_setting(struct conn_list *dest, const struct setting *pset)
 {
+  if (setting_batch_depth > 0
+      && (dest == nullptr || dest == game.est_connections)) {
+    /* Broadcast; defer to send_server_setting_batch_end(), which sends
+     * each setting at most once per batch. */
+    setting_batch_pending[setting_number(pset)] = TRUE;
+    return;
+  }
+
   if (!dest) {
     dest = game.est_connections;
   }
@@ -214,6 +214,9 @@ bool settings_ruleset(struct section_file *file, const char *section,
 
 void send_server_setting(struct conn_list *dest, const struct setting *pset);
 void send_server_settings(struct conn_list *dest);
+void send_server_setting_batch_begin(void);
+bool send_server_setting_batch_end(void);
+bool send_server_setting_batch_active(void);
 void send_server_access_level_settings(struct conn_list *dest,
                                        enum cmdlevel old_level,
                                        enum cmdlevel new_level);
@@ -175,6 +175,30 @@ int main(int argc, char *argv[])
       srvarg.scenarios_pathname = option;
     } else if ((option = get_option_malloc("--ruleset", argv, &inx, argc, TRUE))) {
       srvarg.ruleset = option;
+    } else if ((option = get_option_malloc("--ai-bench", argv, &inx, argc, FALSE))) {
+      if (!str_to_int(option, &srvarg.ai_bench_turns)
+          || srvarg.ai_bench_turns <= 0) {
+        fc_fprintf(stderr, _("Invalid number of benchmark turns \"%s\".\n"),
+                   option);
+        showhelp = TRUE;
+        break;
+      }
+      free(option);
+    } else if ((option = get_option_malloc("--record", argv, &inx, argc, TRUE))) {
+      srvarg.record_filename = option;
+    } else if ((option = get_option_malloc("--replay", argv, &inx, argc, TRUE))) {
+      srvarg.replay_filename = option;
+    } else if ((option = get_option_malloc("--ruleset-bench", argv, &inx, argc, FALSE))) {
+      if (!str_to_int(option, &srvarg.ruleset_bench_iters)
+          || srvarg.ruleset_bench_iters <= 0) {
+        fc_fprintf(stderr, _("Invalid number of benchmark iterations \"%s\".\n"),
+                   option);
+        showhelp = TRUE;
+        break;
+      }
+      free(option);
+    } else if (is_option("--logasync", argv[inx])) {
+      srvarg.log_async = TRUE;
     } else if (is_option("--version", argv[inx])) {
       showvers = TRUE;
     } else if ((option = get_option_malloc("--Announce", argv, &inx, argc, FALSE))) {
@@ -325,6 +349,34 @@ int main(int argc, char *argv[])
                 /* TRANS: "ruleset" is exactly what user must type, do not translate. */
                 _("ruleset RULESET"),
                 _("Load ruleset RULESET"));
+    cmdhelp_add(help, NULL,
+                /* TRANS: "ai-bench" is exactly what user must type, do not translate. */
+                _("ai-bench TURNS"),
+                _("Run an all-AI game for TURNS turns without clients, "
+                  "report per-turn AI stage timings, and exit"));
+    cmdhelp_add(help, NULL,
+                /* TRANS: "record" is exactly what user must type, do not translate. */
+                _("record FILE"),
+                _("Record all external inputs (client data, console "
+                  "lines, the game seed) to FILE for later replay"));
+    cmdhelp_add(help, NULL,
+                /* TRANS: "replay" is exactly what user must type, do not translate. */
+                _("replay FILE"),
+                _("Re-execute the session recorded in FILE "
+                  "deterministically at full speed; start the server "
+                  "with the same command line and data files as the "
+                  "recording run"));
+    cmdhelp_add(help, NULL,
+                /* TRANS: "ruleset-bench" is exactly what user must type, do not translate. */
+                _("ruleset-bench ITERATIONS"),
+                _("Load the selected ruleset ITERATIONS times, report "
+                  "per-phase load timings, and exit"));
+    cmdhelp_add(help, NULL,
+                /* TRANS: "logasync" is exactly what user must type, do not translate. */
+                _("logasync"),
+                _("Write log messages from a separate thread so logging "
+                  "does not slow the game down; errors are still "
+                  "written immediately"));
 #ifdef AI_MODULES
     cmdhelp_add(help, "L",
                 /* TRANS: "LoadAI" is exactly what user must type, do not translate. */
@@ -344,6 +396,12 @@ int main(int argc, char *argv[])
     exit(EXIT_SUCCESS);
   }
 
+  if (srvarg.record_filename != NULL && srvarg.replay_filename != NULL) {
+    fc_fprintf(stderr,
+               _("--record and --replay cannot be used together\n"));
+    exit(EXIT_FAILURE);
+  }
+
 #ifdef HAVE_FCDB
   if (srvarg.auth_enabled && !srvarg.fcdb_enabled) {
     fc_fprintf(stderr,
@@ -27,9 +27,11 @@
 /* common */
 #include "ai.h"
 #include "city.h"
+#include "connection.h"
 #include "game.h"
 #include "map.h"
 #include "nation.h"
+#include "packets.h"
 #include "unit.h"
 
 /* server */
@@ -44,6 +46,16 @@
 static struct timer *aitimer[AIT_LAST][2];
 static int recursion[AIT_LAST];
 
+/* Stage keys of the --ai-bench per-turn report, in enum ai_timer order */
+static const char *aitimer_names[AIT_LAST] = {
+  "all", "movemap", "units", "settlers", "workers", "aidata",
+  "government", "taxes", "cities", "citizen_arrange", "buildings",
+  "danger", "tech", "fstk", "defenders", "caravan", "hunter", "airlift",
+  "diplomat", "airunit", "explorer", "emergency", "city_military",
+  "city_terrain", "city_settlers", "attack", "military", "recover",
+  "bodyguard", "ferry", "rampage", "diplomacy"
+};
+
 /* General AI logging functions */
 
 /**********************************************************************//**
@@ -122,6 +134,19 @@ void real_unit_log(const char *file, const char *function, int line,
   do_log(file, function, line, FALSE, level, "%s", buffer);
 }
 
+/**********************************************************************//**
+  Whether the AI stage timers are ticking. They are always on in debug
+  builds; the --ai-bench benchmark mode turns them on at runtime.
+**************************************************************************/
+static bool timing_log_active(void)
+{
+#ifdef FREECIV_DEBUG
+  return TRUE;
+#else  /* FREECIV_DEBUG */
+  return srvarg.ai_bench_turns > 0;
+#endif /* FREECIV_DEBUG */
+}
+
 /**********************************************************************//**
   Measure the time between the calls.  Used to see where in the AI too
   much CPU is being used.
@@ -130,6 +155,10 @@ void timing_log_real(enum ai_timer timer, enum ai_timer_activity activity)
 {
   static int turn = -1;
 
+  if (!timing_log_active()) {
+    return;
+  }
+
   if (game.info.turn != turn) {
     int i;
 
@@ -158,6 +187,10 @@ void timing_results_real(void)
 {
   char buf[200];
 
+  if (!timing_log_active()) {
+    return;
+  }
+
 #ifdef LOG_TIMERS
 
 #define AILOG_OUT(text, which)                                              \
@@ -210,6 +243,205 @@ void timing_results_real(void)
   AILOG_OUT(" - Settler want", AIT_CITY_SETTLERS);
   AILOG_OUT("Citizen arrange", AIT_CITIZEN_ARRANGE);
   AILOG_OUT("Tech", AIT_TECH);
+  AILOG_OUT("Diplomacy", AIT_DIPLOMACY);
+}
+
+/**********************************************************************//**
+  Emit one machine-readable line with this turn's per-stage AI timings,
+  for the --ai-bench benchmark mode.
+**************************************************************************/
+void timing_log_turn_report(void)
+{
+  char buf[1024];
+  int i;
+
+  if (!timing_log_active()) {
+    return;
+  }
+
+  fc_snprintf(buf, sizeof(buf), "ai-bench: turn=%d", game.info.turn);
+  for (i = 0; i < AIT_LAST; i++) {
+    cat_snprintf(buf, sizeof(buf), " %s=%.6f", aitimer_names[i],
+                 timer_read_seconds(aitimer[i][0]));
+  }
+  log_normal("%s", buf);
+}
+
+/* Whether the scoped profiler emits its machine-readable line at each
+ * turn change; toggled with the 'timing log' server command. */
+static bool profile_turn_log = FALSE;
+
+struct profile_line_state {
+  struct astring *line;
+  const char *names[32];        /* Scope name per depth, for the path */
+};
+
+/**********************************************************************//**
+  fcprof_report() callback appending one "path.to.scope=secs/calls"
+  field to the turn line.
+**************************************************************************/
+static void profile_line_cb(int depth, const char *name, int calls,
+                            double seconds, void *data)
+{
+  struct profile_line_state *state = data;
+  int i;
+
+  if (depth >= (int) ARRAY_SIZE(state->names)) {
+    return;
+  }
+  state->names[depth] = name;
+
+  astr_add(state->line, " ");
+  for (i = 0; i < depth; i++) {
+    astr_add(state->line, "%s.", state->names[i]);
+  }
+  astr_add(state->line, "%s=%.6f/%d", name, seconds, calls);
+}
+
+struct profile_packet_state {
+  struct conn_list *dest;
+  const char *names[32];        /* Scope name per depth, for the path */
+};
+
+/**********************************************************************//**
+  fcprof_report() callback sending one PACKET_TIMING_INFO per scope to
+  the admin connections collected in the state.
+**************************************************************************/
+static void profile_packet_cb(int depth, const char *name, int calls,
+                              double seconds, void *data)
+{
+  struct profile_packet_state *state = data;
+  struct packet_timing_info packet;
+  int i;
+
+  if (depth >= (int) ARRAY_SIZE(state->names)) {
+    return;
+  }
+  state->names[depth] = name;
+
+  packet.turn = game.info.turn;
+  packet.path[0] = '\0';
+  for (i = 0; i < depth; i++) {
+    cat_snprintf(packet.path, sizeof(packet.path), "%s.",
+                 state->names[i]);
+  }
+  cat_snprintf(packet.path, sizeof(packet.path), "%s", name);
+  packet.calls = calls;
+  packet.seconds = seconds;
+
+  lsend_packet_timing_info(state->dest, &packet);
+}
+
+/**********************************************************************//**
+  Turn the per-turn machine-readable profile line on or off.
+**************************************************************************/
+void profile_turn_log_set(bool enable)
+{
+  profile_turn_log = enable;
+}
+
+/**********************************************************************//**
+  Whether the per-turn profile line is being emitted.
+**************************************************************************/
+bool profile_turn_log_get(void)
+{
+  return profile_turn_log;
+}
+
+/**********************************************************************//**
+  Close the turn's profiling interval: emit the machine-readable line
+  when requested, then clear the tree so the next turn aggregates from
+  zero. Called from the turn change; does nothing while the profiler
+  is off.
+**************************************************************************/
+void profile_turn_report(void)
+{
+  if (!fcprof_enabled()) {
+    return;
+  }
+
+  if (profile_turn_log) {
+    struct profile_line_state state;
+    struct astring line = ASTRING_INIT;
+
+    state.line = &line;
+    astr_set(&line, "profile: turn=%d", game.info.turn);
+    fcprof_report(profile_line_cb, &state);
+    log_normal("%s", astr_str(&line));
+    astr_free(&line);
+  }
+
+  /* Export the tree to admin connections, one packet per scope, so
+   * external monitoring can graph turn-time composition live. */
+  {
+    struct conn_list *admins = conn_list_new();
+
+    conn_list_iterate(game.est_connections, pconn) {
+      if (pconn->access_level >= ALLOW_ADMIN) {
+        conn_list_append(admins, pconn);
+      }
+    } conn_list_iterate_end;
+
+    if (conn_list_size(admins) > 0) {
+      struct profile_packet_state state;
+
+      state.dest = admins;
+      fcprof_report(profile_packet_cb, &state);
+    }
+    conn_list_destroy(admins);
+  }
+
+  fcprof_clear();
+}
+
+/**********************************************************************//**
+  Log one verbose line with the turn's network egress: totals and the
+  packet types that dominated the raw bytes since the previous turn
+  change. Called from the turn change.
+**************************************************************************/
+void netstats_turn_report(void)
+{
+  static size_t last_bytes[PACKET_LAST];
+  static size_t last_wire;
+  struct astring line = ASTRING_INIT;
+  size_t turn_bytes[PACKET_LAST];
+  size_t total = 0, wire;
+  int i, top;
+
+  for (i = 0; i < PACKET_LAST; i++) {
+    size_t packets, bytes;
+
+    packet_stats_get(NULL, i, &packets, &bytes);
+    /* A /netstats clear mid-turn makes bytes < last_bytes; restart. */
+    turn_bytes[i] = bytes >= last_bytes[i] ? bytes - last_bytes[i] : 0;
+    total += turn_bytes[i];
+    last_bytes[i] = bytes;
+  }
+  wire = packet_stats_wire(NULL);
+  astr_set(&line, "netstats: turn=%d raw=%lu wire=%lu",
+           game.info.turn, (unsigned long) total,
+           (unsigned long) (wire >= last_wire ? wire - last_wire : 0));
+  last_wire = wire;
+
+  for (top = 0; top < 3; top++) {
+    int biggest = -1;
+
+    for (i = 0; i < PACKET_LAST; i++) {
+      if (turn_bytes[i] > 0
+          && (biggest < 0 || turn_bytes[i] > turn_bytes[biggest])) {
+        biggest = i;
+      }
+    }
+    if (biggest < 0) {
+      break;
+    }
+    astr_add(&line, " %s=%lu", packet_name(biggest),
+             (unsigned long) turn_bytes[biggest]);
+    turn_bytes[biggest] = 0;
+  }
+
+  log_verbose("%s", astr_str(&line));
+  astr_free(&line);
 }
 
 /**********************************************************************//**
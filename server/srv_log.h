@@ -69,6 +69,7 @@ enum ai_timer {
   AIT_BODYGUARD,
   AIT_FERRY,
   AIT_RAMPAGE,
+  AIT_DIPLOMACY,
   AIT_LAST
 };
 
@@ -115,15 +116,19 @@ void real_unit_log(const char *file, const char *function, int line,
 void timing_log_init(void);
 void timing_log_free(void);
 
+void profile_turn_log_set(bool enable);
+bool profile_turn_log_get(void);
+void profile_turn_report(void);
+
+void netstats_turn_report(void);
+
 void timing_log_real(enum ai_timer timer, enum ai_timer_activity activity);
 void timing_results_real(void);
+void timing_log_turn_report(void);
 
-#ifdef FREECIV_DEBUG
+/* The timers only tick in debug builds and in --ai-bench mode;
+ * timing_log_real() checks that at runtime. */
 #define TIMING_LOG(timer, activity) timing_log_real(timer, activity)
 #define TIMING_RESULTS() timing_results_real()
-#else  /* FREECIV_DEBUG */
-#define TIMING_LOG(timer, activity)
-#define TIMING_RESULTS()
-#endif /* FREECIV_DEBUG */
 
 #endif  /* FC__SRV_LOG_H */
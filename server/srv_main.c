@@ -29,6 +29,9 @@
 #ifdef HAVE_SYS_IOCTL_H
 #include <sys/ioctl.h>
 #endif
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
 #ifdef HAVE_SYS_TERMIO_H
 #include <sys/termio.h>
 #endif
@@ -64,6 +67,9 @@
 
 /* common/aicore */
 #include "citymap.h"
+#include "path_finding.h"
+#include "pf_alt.h"
+#include "pf_hier.h"
 
 /* common */
 #include "accessarea.h"
@@ -80,10 +86,13 @@
 #include "government.h"
 #include "map.h"
 #include "mapimg.h"
+#include "metaknowledge.h"
 #include "modpack.h"
+#include "movement.h"
 #include "nation.h"
 #include "packets.h"
 #include "player.h"
+#include "requirements.h"
 #include "research.h"
 #include "tech.h"
 #include "unitlist.h"
@@ -114,6 +123,7 @@
 #include "sanitycheck.h"
 #include "score.h"
 #include "sernet.h"
+#include "sessionrec.h"
 #include "settings.h"
 #include "spacerace.h"
 #include "srv_log.h"
@@ -187,6 +197,11 @@ struct civserver server;
 /* Server state information */
 static enum server_states civserver_state = S_S_INITIAL;
 
+/* TRUE when no client will ever attach to this server process (set by
+ * embedded drivers such as fcgym); hot send paths may then skip packet
+ * construction entirely. */
+static bool headless_server = FALSE;
+
 /* This global is checked deep down the netcode.
    packets handling functions can set it to none-zero, to
    force end-of-tick asap
@@ -203,12 +218,23 @@ static struct timer *eot_timer = nullptr;
 
 static struct timer *between_turns = nullptr;
 
+/* Wall-clock timing of the --ai-bench benchmark run */
+static struct timer *ai_bench_wall = nullptr;
+static double ai_bench_wall_total = 0.0;
+
+/* Arena for scratch allocations whose lifetime is one phase; reset at
+ * the end of end_phase(). See server_phase_arena(). */
+static struct fc_arena *phase_arena = nullptr;
+
 /**********************************************************************//**
   Initialize the game seed. This may safely be called multiple times.
 **************************************************************************/
 void init_game_seed(void)
 {
-  if (game.server.seed_setting == 0) {
+  if (session_replay_active()
+      && session_replay_seed(&game.server.seed)) {
+    /* Roll the dice exactly as the recorded session did. */
+  } else if (game.server.seed_setting == 0) {
     /* We strip the high bit for now because neither game file nor
        server options can handle unsigned ints yet. - Cedric */
     game.server.seed = generate_game_seed() & (MAX_UINT32 >> 1);
@@ -222,6 +248,8 @@ void init_game_seed(void)
     game.server.seed = game.server.seed_setting;
   }
 
+  session_record_seed(game.server.seed);
+
   if (!fc_rand_is_init()) {
     fc_srand(game.server.seed);
   }
@@ -285,6 +313,12 @@ void srv_init(void)
 
   srvarg.quitidle = 0;
 
+  srvarg.ai_bench_turns = 0;
+  srvarg.ruleset_bench_iters = 0;
+  srvarg.record_filename = nullptr;
+  srvarg.replay_filename = nullptr;
+  srvarg.log_async = FALSE;
+
   srvarg.fcdb_enabled = FALSE;
   srvarg.fcdb_conf = nullptr;
   srvarg.auth_enabled = FALSE;
@@ -349,6 +383,24 @@ void set_server_state(enum server_states newstate)
   civserver_state = newstate;
 }
 
+/**********************************************************************//**
+  Return whether this server will never have client connections.
+**************************************************************************/
+bool server_is_headless(void)
+{
+  return headless_server;
+}
+
+/**********************************************************************//**
+  Declare that no client will ever attach to this server process, allowing
+  send paths to short-circuit before packet encoding.  Only embedded
+  drivers that bypass the network layer altogether should set this.
+**************************************************************************/
+void server_set_headless(bool headless)
+{
+  headless_server = headless;
+}
+
 /**********************************************************************//**
   Returns iff the game was started once upon a time.
 **************************************************************************/
@@ -833,16 +885,29 @@ static void update_environmental_upset(enum environment_upset_type type,
                                        int percent,
                                        void (*upset_action_fn)(int))
 {
+  const bv_extras *extras_vec = map_soa_extras();
   int count;
 
   count = 0;
   extra_type_iterate(cause) {
     if (extra_causes_env_upset(cause, type)) {
-      whole_map_iterate(&(wld.map), ptile) {
-        if (tile_has_extra(ptile, cause)) {
-          count++;
+      if (extras_vec != nullptr) {
+        /* Scan the dense extras mirror instead of every struct tile. */
+        int eidx = extra_index(cause);
+        int i;
+
+        for (i = 0; i < MAP_INDEX_SIZE; i++) {
+          if (BV_ISSET(extras_vec[i], eidx)) {
+            count++;
+          }
         }
-      } whole_map_iterate_end;
+      } else {
+        whole_map_iterate(&(wld.map), ptile) {
+          if (tile_has_extra(ptile, cause)) {
+            count++;
+          }
+        } whole_map_iterate_end;
+      }
     }
   } extra_type_iterate_end;
 
@@ -975,6 +1040,7 @@ static void update_diplomatics(void)
             state2->type = DS_PEACE;
             state->turns_left = 0;
             state2->turns_left = 0;
+            move_legality_cache_invalidate();
             remove_illegal_armistice_units(plr1, plr2);
           } else {
             notify_illegal_armistice_units(plr1, plr2, state->turns_left);
@@ -1008,6 +1074,7 @@ static void update_diplomatics(void)
             state2->type = DS_WAR;
             state->turns_left = 0;
             state2->turns_left = 0;
+            move_legality_cache_invalidate();
 
             enter_war(plr1, plr2);
 
@@ -1102,6 +1169,9 @@ static void update_diplomatics(void)
       }
     } players_iterate_alive_end;
   } players_iterate_alive_end;
+
+  /* Contact based intel may just have expired. */
+  metaknowledge_intel_invalidate();
 }
 
 /**********************************************************************//**
@@ -1139,9 +1209,21 @@ static void kill_dying_players(void)
 **************************************************************************/
 static void ai_start_phase(void)
 {
+  /* With the asynchronous network writer running, flush_packets() is a
+   * non-blocking handoff of the queued output, so the writer thread
+   * pushes one player's turn start flood to the sockets while the next
+   * player's AI is computed here. Game state is only ever touched on
+   * this thread; the writer sees nothing but copied bytes. Without the
+   * writer a flush here would be a blocking wait per player, so the
+   * players are then still processed back to back as before. */
+  bool pipelined = is_net_writer_active();
+
   phase_players_iterate(pplayer) {
     if (is_ai(pplayer)) {
       CALL_PLR_AI_FUNC(first_activities, pplayer, pplayer);
+      if (pipelined) {
+        flush_packets();
+      }
     }
   } phase_players_iterate_end;
   kill_dying_players();
@@ -1158,6 +1240,10 @@ void begin_turn(bool is_new_turn)
 
   event_cache_remove_old();
 
+  /* Time dependent effect requirements (turn, year, age...) may change
+   * value now. */
+  effect_cache_invalidate();
+
   /* Reset this each turn. */
   if (is_new_turn) {
     if (game.info.phase_mode != game.server.phase_mode_stored) {
@@ -1255,6 +1341,21 @@ void begin_turn(bool is_new_turn)
   sanity_check();
 }
 
+/**********************************************************************//**
+  Return the arena for allocations that live at most until the end of
+  the current phase. end_phase() resets it, freeing everything allocated
+  from it at once; never stash a pointer from it anywhere that survives
+  the phase.
+**************************************************************************/
+struct fc_arena *server_phase_arena(void)
+{
+  if (phase_arena == nullptr) {
+    phase_arena = fc_arena_create(0);
+  }
+
+  return phase_arena;
+}
+
 /**********************************************************************//**
   Begin a phase of movement. This handles all beginning-of-phase actions
   for one or more players.
@@ -1263,6 +1364,10 @@ void begin_phase(bool is_new_phase)
 {
   log_debug("Begin phase");
 
+  /* Phase-stable requirement evaluations memoized last phase are no
+   * longer trustworthy. */
+  requirement_memo_reset();
+
   conn_list_do_buffer(game.est_connections);
 
   phase_players_iterate(pplayer) {
@@ -1330,10 +1435,12 @@ void begin_phase(bool is_new_phase)
       }
     } whole_map_iterate_end;
 
+    FCPROF_BEGIN("unit_activities");
     phase_players_iterate(pplayer) {
       update_unit_activities(pplayer);
       flush_packets();
     } phase_players_iterate_end;
+    FCPROF_END();
 
     /* Execute orders after activities have been completed (roads built,
      * pillage done, etc.). */
@@ -1383,11 +1490,13 @@ void begin_phase(bool is_new_phase)
 
   if (is_new_phase) {
     /* Try to avoid hiding events under a diplomacy dialog */
+    TIMING_LOG(AIT_DIPLOMACY, TIMER_START);
     phase_players_iterate(pplayer) {
       if (is_ai(pplayer)) {
         CALL_PLR_AI_FUNC(diplomacy_actions, pplayer, pplayer);
       }
     } phase_players_iterate_end;
+    TIMING_LOG(AIT_DIPLOMACY, TIMER_STOP);
 
     /* Spend random movement move points before any controlled actions */
     phase_players_iterate(pplayer) {
@@ -1395,9 +1504,12 @@ void begin_phase(bool is_new_phase)
     } phase_players_iterate_end;
 
     log_debug("Aistartturn");
+    FCPROF_BEGIN("ai");
     ai_start_phase();
+    FCPROF_END();
 
     flush_packets();
+    FCPROF_BEGIN("unit_orders");
     phase_players_iterate(pplayer) {
       unit_list_iterate_safe(pplayer->units, punit) {
         if (punit->activity == ACTIVITY_EXPLORE) {
@@ -1407,6 +1519,7 @@ void begin_phase(bool is_new_phase)
       execute_unit_orders(pplayer);
       flush_packets();
     } phase_players_iterate_end;
+    FCPROF_END();
   } else {
     phase_players_iterate(pplayer) {
       if (is_ai(pplayer)) {
@@ -1442,6 +1555,18 @@ void end_phase(void)
 {
   log_debug("Endphase");
 
+  /* End-phase activities below change player state (gold, bulbs,
+   * upkeep, ...) many times in a row; collapse the resulting player
+   * info broadcasts into one send per player, and the tile updates of
+   * fog and border changes into one send per tile. */
+  player_info_batch_start();
+  tile_info_batch_start();
+
+  /* Turn-end processing below dirties the same cities over and over;
+   * queue their sanity checks and run each one once at the end of the
+   * phase instead of after every step. */
+  sanity_check_defer_begin();
+
   /*
    * This empties the client Messages window; put this before
    * everything else below, since otherwise any messages from the
@@ -1522,6 +1647,11 @@ void end_phase(void)
     auto_workers_player(pplayer);
     if (is_ai(pplayer)) {
       CALL_PLR_AI_FUNC(last_activities, pplayer, pplayer);
+      if (is_net_writer_active()) {
+        /* Hand this player's queued output to the writer thread while
+         * the next player's end of turn AI runs; see ai_start_phase(). */
+        flush_packets();
+      }
     }
   } phase_players_iterate_end;
 
@@ -1556,7 +1686,9 @@ void end_phase(void)
     old_gold = pplayer->economic.gold;
     pplayer->server.bulbs_last_turn = 0;
 
+    FCPROF_BEGIN("city_activities");
     update_city_activities(pplayer);
+    FCPROF_END();
 
     update_national_activities(pplayer, old_gold);
 
@@ -1599,6 +1731,35 @@ void end_phase(void)
        is initialized for human players also. */
     adv_data_phase_done(pplayer);
   } phase_players_iterate_end;
+
+  /* Verify everything dirtied above, each object exactly once. Runs
+   * inside the info batches as failed checks may repair state. */
+  sanity_check_defer_end();
+
+  tile_info_batch_flush();
+  player_info_batch_flush();
+
+  /* All per-phase scratch allocations are dead now. */
+  if (phase_arena != nullptr) {
+    fc_arena_reset(phase_arena);
+  }
+}
+
+/**********************************************************************//**
+  Peak resident set size of the server process in kibibytes, or 0 when
+  the platform doesn't provide it.
+**************************************************************************/
+static long peak_rss_kb(void)
+{
+#ifdef HAVE_SYS_RESOURCE_H
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return usage.ru_maxrss;
+  }
+#endif /* HAVE_SYS_RESOURCE_H */
+
+  return 0;
 }
 
 /**********************************************************************//**
@@ -1747,7 +1908,17 @@ static void end_turn(void)
    * Extra never appears only to disappear at the same turn,
    * but it can disappear and reappear. */
   extra_type_by_rmcause_iterate(ERM_DISAPPEARANCE, pextra) {
+    const bv_extras *extras_vec = map_soa_extras();
+
     whole_map_iterate(&(wld.map), ptile) {
+      /* The extras mirror filters out the (many) tiles without the
+       * extra before the struct tile is even touched; checking it
+       * first keeps the fc_rand() call sequence unchanged. */
+      if (extras_vec != nullptr
+          && !BV_ISSET(extras_vec[tile_index(ptile)],
+                       extra_index(pextra))) {
+        continue;
+      }
       if (tile_has_extra(ptile, pextra)
           && fc_rand(10000) < pextra->disappearance_chance
           && can_extra_disappear(pextra, ptile)) {
@@ -1830,6 +2001,27 @@ static void end_turn(void)
 
   log_debug("Sendyeartoclients");
   send_year_to_clients();
+
+  if (srvarg.ai_bench_turns > 0) {
+    /* One machine-readable line of AI stage timings per benchmark turn */
+    timing_log_turn_report();
+
+    /* ... and one of whole-turn wall time and peak memory, for the
+     * harnesses that gate on end-to-end cost. */
+    if (ai_bench_wall != nullptr) {
+      double turn_wall;
+
+      timer_stop(ai_bench_wall);
+      turn_wall = timer_read_seconds(ai_bench_wall);
+      ai_bench_wall_total += turn_wall;
+      log_normal("ai-bench-perf: turn=%d wall=%.6f total=%.6f "
+                 "rss_peak_kb=%ld",
+                 game.info.turn, turn_wall, ai_bench_wall_total,
+                 peak_rss_kb());
+      timer_clear(ai_bench_wall);
+      timer_start(ai_bench_wall);
+    }
+  }
 }
 
 /**********************************************************************//**
@@ -1955,6 +2147,10 @@ void fc__noreturn server_quit(void)
     game.server.save_timer = nullptr;
   }
 
+  /* Stop the authentication worker thread before the database scripting
+   * state goes away under it. */
+  auth_queue_shutdown();
+
 #ifdef HAVE_FCDB
   if (srvarg.fcdb_enabled) {
     /* If freeciv database has been initialized */
@@ -1969,9 +2165,12 @@ void fc__noreturn server_quit(void)
   voting_free();
   generator_free();
   close_connections_and_socket();
+  session_record_stop();
+  session_replay_stop();
   rulesets_deinit();
   CALL_FUNC_EACH_AI(module_close);
   timing_log_free();
+  fcprof_free();
   registry_module_close();
   fc_mutex_destroy(&game.server.mutexes.city_list);
   libfreeciv_free();
@@ -2233,11 +2432,18 @@ bool server_packet_input(struct connection *pconn, void *packet, int type)
   /* Make sure to set this back to nullptr before leaving this function: */
   pplayer->current_conn = pconn;
 
+  /* One player action (a stack move, a goto, ...) can touch largely
+   * overlapping tile sets once per unit; collapse the resulting tile
+   * info sends into one per tile. */
+  tile_info_batch_start();
+
   if (!server_handle_packet(type, packet, pplayer, pconn)) {
     log_error("Received unknown packet %d from %s.",
               type, conn_description(pconn));
   }
 
+  tile_info_batch_flush();
+
   if (S_S_RUNNING == server_state()
       && type != PACKET_PLAYER_READY) {
     /* handle_player_ready() calls start_game(), but the game isn't started
@@ -2901,6 +3107,10 @@ static void srv_running(void)
   /* We may as well reset is_new_game now. */
   game.info.is_new_game = FALSE;
 
+  /* Map generation and savegame loading write tile state without going
+   * through the score counter hooks. */
+  score_counters_invalidate();
+
   log_verbose("srv_running() mostly redundant send_server_settings()");
   send_server_settings(nullptr);
 
@@ -2929,7 +3139,9 @@ static void srv_running(void)
      * We have to initialize data as well as do some actions.  However when
      * loading a game we don't want to do these actions (like AI unit
      * movement and AI diplomacy). */
+    FCPROF_BEGIN("begin_turn");
     begin_turn(is_new_turn);
+    FCPROF_END();
 
     if (game.server.num_phases != 1) {
       /* We allow everyone to begin adjusting cities and such
@@ -2942,7 +3154,9 @@ static void srv_running(void)
     for (; game.info.phase < game.server.num_phases; game.info.phase++) {
       log_debug("Starting phase %d/%d.", game.info.phase,
                 game.server.num_phases);
+      FCPROF_BEGIN("begin_phase");
       begin_phase(is_new_turn);
+      FCPROF_END();
       if (need_send_pending_events) {
         /* When loading a savegame, we need to send loaded events, after
          * the clients switched to the game page (after the first
@@ -2974,10 +3188,19 @@ static void srv_running(void)
        * Post-increment so we don't count the first loop. */
       if (game.info.phase == 0) {
         /* Create autosaves if requested. */
-        if (save_counter >= game.server.save_nturns
-            && game.server.save_nturns > 0) {
-          save_counter = 0;
-          save_game_auto("Autosave", AS_TURN);
+        if (game.server.save_nturns > 0) {
+          if (save_counter >= game.server.save_nturns) {
+            save_counter = 0;
+            save_game_auto("Autosave", AS_TURN);
+          } else if (game.server.delta_saves
+                     && (game.server.autosaves & (1 << AS_TURN))) {
+            /* Delta saves fill the turns between full autosaves. */
+            char filename[512];
+
+            generate_save_name(game.server.save_name, filename,
+                               sizeof(filename), nullptr);
+            save_game_delta(filename, "Autosave");
+          }
         }
         save_counter++;
 
@@ -2996,8 +3219,17 @@ static void srv_running(void)
         log_debug("Unresponsive between turns %g seconds", game.server.turn_change_time);
       }
 
-      while (server_sniff_all_input() == S_E_OTHERWISE) {
-        /* Nothing */
+      {
+        enum server_events sniff_event;
+
+        while ((sniff_event = server_sniff_all_input()) == S_E_OTHERWISE) {
+          /* Nothing */
+        }
+        if (sniff_event == S_E_END_OF_TURN_TIMEOUT) {
+          /* Mark the timeout-driven phase end; it is the one input a
+           * replay cannot reproduce on its own. */
+          session_record_turn(game.info.turn);
+        }
       }
 
       between_turns = timer_renew(between_turns, TIMER_USER, TIMER_ACTIVE,
@@ -3017,7 +3249,9 @@ static void srv_running(void)
        */
       lsend_packet_freeze_client(game.est_connections);
 
+      FCPROF_BEGIN("end_phase");
       end_phase();
+      FCPROF_END();
 
       conn_list_do_unbuffer(game.est_connections);
 
@@ -3034,7 +3268,14 @@ static void srv_running(void)
      * where phase is too high for is_new_turn to get set. */
     is_new_turn = TRUE;
 
+    FCPROF_BEGIN("end_turn");
     end_turn();
+    FCPROF_END();
+    profile_turn_report();
+    netstats_turn_report();
+    mem_stats_turn();
+    requirement_stats_turn();
+    effect_stats_turn();
     log_debug("Sendinfotometaserver");
     (void) send_server_info_to_metaserver(META_REFRESH);
 
@@ -3056,6 +3297,8 @@ static void srv_running(void)
   /* This will thaw the reports and agents at the client.  */
   lsend_packet_thaw_client(game.est_connections);
 
+  sanity_check_report();
+
   if (game.server.save_timer != nullptr) {
     timer_destroy(game.server.save_timer);
     game.server.save_timer = nullptr;
@@ -3093,6 +3336,19 @@ static void srv_prepare(void)
                srvarg.fatal_assertions);
   /* Logging available after this point */
 
+  if (srvarg.log_async) {
+    log_async_set(TRUE);
+  }
+
+  if (srvarg.record_filename != nullptr
+      && !session_record_start(srvarg.record_filename)) {
+    exit(EXIT_FAILURE);
+  }
+  if (srvarg.replay_filename != nullptr
+      && !session_replay_start(srvarg.replay_filename)) {
+    exit(EXIT_FAILURE);
+  }
+
   server_open_socket();
 
 #if IS_BETA_VERSION || IS_DEVEL_VERSION
@@ -3152,6 +3408,27 @@ static void srv_prepare(void)
     load_rulesets(nullptr, nullptr, FALSE, nullptr, TRUE, FALSE, TRUE);
   }
 
+  if (srvarg.ruleset_bench_iters > 0) {
+    int i;
+
+    /* The load above warmed the parse cache; these iterations measure
+     * the loads users actually wait for. Per-phase lines come from
+     * load_rulesetdir(). */
+    ruleset_bench_enable(TRUE);
+    for (i = 0; i < srvarg.ruleset_bench_iters; i++) {
+      log_normal("ruleset-bench: iteration=%d ruleset=%s",
+                 i + 1, game.server.rulesetdir);
+      if (!load_rulesets(nullptr, nullptr, FALSE, nullptr,
+                         TRUE, FALSE, TRUE)) {
+        log_fatal(_("--ruleset-bench: failed to load ruleset \"%s\"."),
+                  game.server.rulesetdir);
+        break;
+      }
+    }
+    ruleset_bench_enable(FALSE);
+    server_quit();
+  }
+
   maybe_automatic_meta_message(default_meta_message_string());
 
   if (!(srvarg.metaserver_no_send)) {
@@ -3526,6 +3803,9 @@ void server_game_free(void)
 {
   CALL_FUNC_EACH_AI(game_free);
 
+  pf_alt_free();
+  pf_hier_free();
+
   /* Free all the treaties that were left open when game finished. */
   free_treaties();
 
@@ -3562,6 +3842,11 @@ void server_game_free(void)
   playercolor_free();
   citymap_free();
   game_free();
+
+  if (phase_arena != nullptr) {
+    fc_arena_destroy(phase_arena);
+    phase_arena = nullptr;
+  }
 }
 
 /**********************************************************************//**
@@ -3586,6 +3871,25 @@ void fc__noreturn srv_main(void)
       event_cache_clear();
     }
 
+    if (srvarg.ai_bench_turns > 0) {
+      /* Headless all-AI benchmark: start without waiting for client
+       * connections and exit once the requested number of turns has
+       * been played. */
+      game.info.timeout = -1;
+      game.server.min_players = 0;
+      game.server.end_turn = game.info.turn + srvarg.ai_bench_turns;
+      srvarg.exit_on_end = TRUE;
+      ai_bench_wall = timer_renew(ai_bench_wall, TIMER_USER, TIMER_ACTIVE,
+                                  ai_bench_wall != nullptr
+                                  ? nullptr : "ai-bench wall");
+      ai_bench_wall_total = 0.0;
+      timer_start(ai_bench_wall);
+      if (!start_command(nullptr, FALSE, FALSE)) {
+        log_fatal(_("--ai-bench: failed to start the game."));
+        server_quit();
+      }
+    }
+
     log_normal(_("Now accepting new client connections on port %d."),
                srvarg.port);
     /* Remain in S_S_INITIAL until all players are ready. */
@@ -3600,6 +3904,13 @@ void fc__noreturn srv_main(void)
       srv_ready(); /* srv_ready() sets server state to S_S_RUNNING. */
       srv_running();
       srv_scores();
+
+      if (srvarg.ai_bench_turns > 0) {
+        /* Summary line for harnesses gating on end-to-end cost. */
+        log_normal("ai-bench-total: turns=%d wall=%.6f rss_peak_kb=%ld",
+                   srvarg.ai_bench_turns, ai_bench_wall_total,
+                   peak_rss_kb());
+      }
     }
 
     /* Remain in S_S_OVER until players log out */
@@ -22,6 +22,7 @@
 #include "game.h"
 
 struct conn_list;
+struct fc_arena;
 
 struct server_arguments {
   /* Metaserver information */
@@ -51,6 +52,17 @@ struct server_arguments {
   int quitidle;
   /* Exit the server on game ending */
   bool exit_on_end;
+  /* Run a headless all-AI benchmark game for this many turns, reporting
+   * per-turn AI stage timings; 0 to disable */
+  int ai_bench_turns;
+  /* Load the ruleset this many times, reporting per-phase timings,
+   * then exit; 0 to disable */
+  int ruleset_bench_iters;
+  /* Record external inputs to this file, or replay them from it */
+  char *record_filename;
+  char *replay_filename;
+  /* Write log messages from a separate logger thread */
+  bool log_async;
   /* Authentication options */
   bool fcdb_enabled;            /* Defaults to FALSE */
   char *fcdb_conf;              /* Freeciv database configuration file */
@@ -98,6 +110,9 @@ void save_game_auto(const char *save_reason, enum autosave_type type);
 enum server_states server_state(void);
 void set_server_state(enum server_states newstate);
 
+bool server_is_headless(void);
+void server_set_headless(bool headless);
+
 void check_for_full_turn_done(void);
 bool check_for_game_over(void);
 bool game_was_started(void);
@@ -134,6 +149,10 @@ void begin_turn(bool is_new_turn);
 void begin_phase(bool is_new_phase);
 void end_phase(void);
 
+/* Scratch allocations living at most until the end of the current
+ * phase; reset by end_phase(). */
+struct fc_arena *server_phase_arena(void);
+
 /* Game setup - exported for fcgym */
 void generate_players(void);
 void final_ruleset_adjustments(void);
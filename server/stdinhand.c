@@ -41,8 +41,14 @@
 #include "timing.h"
 #include "section_file.h"
 
+/* common/aicore */
+#include "cm.h"
+#include "path_finding.h"
+#include "pf_tools.h"
+
 /* common */
 #include "capability.h"
+#include "effects.h"
 #include "events.h"
 #include "fc_types.h" /* LINE_BREAK */
 #include "featured_text.h"
@@ -52,6 +58,7 @@
 #include "modpack.h"
 #include "packets.h"
 #include "player.h"
+#include "requirements.h"
 #include "research.h"
 #include "rgbcolor.h"
 #include "srvdefs.h"
@@ -174,6 +181,20 @@ static bool playernation_command(struct connection *caller,
                                  char *str, bool check);
 static bool mapimg_command(struct connection *caller, char *arg, bool check);
 static const char *mapimg_accessor(int i);
+static bool pfbench_command(struct connection *caller, char *arg,
+                            bool check);
+static bool cmstats_command(struct connection *caller, char *arg,
+                            bool check);
+static bool timing_command(struct connection *caller, char *arg,
+                           bool check);
+static bool luastats_command(struct connection *caller, char *arg,
+                             bool check);
+static bool memstats_command(struct connection *caller, char *arg,
+                             bool check);
+static bool netstats_command(struct connection *caller, char *arg,
+                             bool check);
+static bool reqstats_command(struct connection *caller, char *arg,
+                             bool check);
 
 static void show_delegations(struct connection *caller);
 
@@ -1217,6 +1238,10 @@ static bool read_init_script_real(struct connection *caller,
       && (script_file = fc_fopen(real_filename, "r"))) {
     char buffer[MAX_LEN_CONSOLE_LINE];
 
+    /* Batch the setting broadcasts; scripts commonly set dozens of
+     * settings in a row. */
+    send_server_setting_batch_begin();
+
     /* The size is set as to not overflow buffer in handle_stdin_input */
     while (fgets(buffer, MAX_LEN_CONSOLE_LINE - 1, script_file)) {
       /* Execute script contents with same permissions as caller */
@@ -1224,6 +1249,14 @@ static bool read_init_script_real(struct connection *caller,
     }
     fclose(script_file);
 
+    if (send_server_setting_batch_end()) {
+      /* The script changed settings; do the per-change follow-ups the
+       * 'set' command skipped while batching, once. */
+      send_game_info(nullptr);
+      reset_all_start_commands(FALSE);
+      send_server_info_to_metaserver(META_INFO);
+    }
+
     show_ruleset_info(caller, CMD_READ_SCRIPT, check, read_recursion);
 
     return TRUE;
@@ -3114,10 +3147,15 @@ static bool set_command(struct connection *caller, char *str, bool check)
      * Send any modified game parameters to the clients -- if sent
      * before S_S_RUNNING, triggers a popdown_races_dialog() call
      * in client/packhand.c#handle_game_info()
+     *
+     * Within a setting batch (e.g. a script file) the closer of the
+     * batch does this once for all changed settings.
      */
-    send_game_info(nullptr);
-    reset_all_start_commands(FALSE);
-    send_server_info_to_metaserver(META_INFO);
+    if (!send_server_setting_batch_active()) {
+      send_game_info(nullptr);
+      reset_all_start_commands(FALSE);
+      send_server_info_to_metaserver(META_INFO);
+    }
   }
 
  cleanup:
@@ -4705,6 +4743,20 @@ static bool handle_stdin_input_real(struct connection *caller, char *str,
     return fcdb_command(caller, arg, check);
   case CMD_MAPIMG:
     return mapimg_command(caller, arg, check);
+  case CMD_PFBENCH:
+    return pfbench_command(caller, arg, check);
+  case CMD_CMSTATS:
+    return cmstats_command(caller, arg, check);
+  case CMD_TIMING:
+    return timing_command(caller, arg, check);
+  case CMD_LUASTATS:
+    return luastats_command(caller, arg, check);
+  case CMD_MEMSTATS:
+    return memstats_command(caller, arg, check);
+  case CMD_NETSTATS:
+    return netstats_command(caller, arg, check);
+  case CMD_REQSTATS:
+    return reqstats_command(caller, arg, check);
   case CMD_LOCK:
     return lock_command(caller, arg, check);
   case CMD_UNLOCK:
@@ -4928,7 +4980,10 @@ static bool reset_command(struct connection *caller, char *arg, bool check,
     break;
   }
 
+  /* One deduplicated, buffered broadcast of the full setting set. */
+  send_server_setting_batch_begin();
   send_server_settings(game.est_connections);
+  send_server_setting_batch_end();
   cmd_reply(CMD_RESET, caller, C_OK, _("Settings re-initialized."));
 
   /* Show ruleset summary and list changed values */
@@ -5912,6 +5967,672 @@ static bool mapimg_command(struct connection *caller, char *arg, bool check)
   return ret;
 }
 
+/**********************************************************************//**
+  Handle pfbench command. Replays a full path-finding fill for every
+  unit in the game and reports timing and node expansion counters per
+  map mode, so path-finding changes can be measured on real positions
+  (load a savegame first to pick the position).
+**************************************************************************/
+static bool pfbench_command(struct connection *caller, char *arg,
+                            bool check)
+{
+  static const char *mode_names[PF_STATS_MODE_COUNT] = {
+    "normal", "danger", "fuel"
+  };
+  const struct civ_map *nmap = &(wld.map);
+  struct pf_map_stats stats[PF_STATS_MODE_COUNT];
+  struct timer *ptimer;
+  struct tile *prev_tile = nullptr;
+  int repeat = 1, fills = 0, paths = 0, i;
+
+  if (!game_was_started()) {
+    cmd_reply(CMD_PFBENCH, caller, C_FAIL,
+              _("Cannot benchmark before the game has started."));
+    return FALSE;
+  }
+
+  if (arg[0] != '\0') {
+    repeat = atoi(arg);
+    if (repeat < 1 || repeat > 1000) {
+      cmd_reply(CMD_PFBENCH, caller, C_SYNTAX,
+                _("The repeat count must be between 1 and 1000."));
+      return FALSE;
+    }
+  }
+
+  if (check) {
+    return TRUE;
+  }
+
+  pf_map_stats_reset();
+  ptimer = timer_new(TIMER_USER, TIMER_ACTIVE, "pfbench");
+  timer_start(ptimer);
+
+  for (i = 0; i < repeat; i++) {
+    players_iterate(pplayer) {
+      unit_list_iterate(pplayer->units, punit) {
+        struct pf_parameter parameter;
+        struct pf_map *pfm;
+
+        pft_fill_unit_parameter(&parameter, nmap, punit);
+        pfm = pf_map_new(&parameter);
+
+        if (prev_tile != nullptr) {
+          /* A single-destination query on the cold map, as goto does. */
+          struct pf_path *path = pf_map_path(pfm, prev_tile);
+
+          if (path != nullptr) {
+            pf_path_destroy(path);
+          }
+          paths++;
+        }
+
+        /* Then exhaust the map, as the AI does. */
+        while (pf_map_iterate(pfm)) {
+          /* Nothing. */
+        }
+        pf_map_destroy(pfm);
+
+        prev_tile = unit_tile(punit);
+        fills++;
+      } unit_list_iterate_end;
+    } players_iterate_end;
+  }
+
+  timer_stop(ptimer);
+  pf_map_stats_get(stats);
+
+  cmd_reply(CMD_PFBENCH, caller, C_OK,
+            _("Replayed %d map fills and %d path queries in %g seconds."),
+            fills, paths, timer_read_seconds(ptimer));
+  for (i = 0; i < PF_STATS_MODE_COUNT; i++) {
+    cmd_reply(CMD_PFBENCH, caller, C_COMMENT,
+              /* TRANS: "normal: 12 maps, 52801 node expansions." */
+              _("%s: %lu maps, %lu node expansions."),
+              mode_names[i], stats[i].maps_built, stats[i].expansions);
+  }
+
+  timer_destroy(ptimer);
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Report the always-on city management solver statistics, or reset them
+  with 'cmstats reset'.
+**************************************************************************/
+static bool cmstats_command(struct connection *caller, char *arg,
+                            bool check)
+{
+  struct cm_stats stats;
+  struct cm_city_stats cities[10];
+  int i, count;
+
+  if (arg[0] != '\0') {
+    if (fc_strcasecmp(arg, "reset") != 0) {
+      cmd_reply(CMD_CMSTATS, caller, C_SYNTAX,
+                _("The only valid argument is 'reset'."));
+      return FALSE;
+    }
+    if (check) {
+      return TRUE;
+    }
+    cm_stats_reset();
+    cmd_reply(CMD_CMSTATS, caller, C_OK,
+              _("City management statistics reset."));
+    return TRUE;
+  }
+
+  if (check) {
+    return TRUE;
+  }
+
+  cm_stats_get(&stats);
+  cmd_reply(CMD_CMSTATS, caller, C_COMMENT,
+            _("Queries: %lu (%lu served from memo), searches: %lu."),
+            stats.queries, stats.memo_hits, stats.solves);
+  cmd_reply(CMD_CMSTATS, caller, C_COMMENT,
+            _("Nodes expanded: %lu, branches pruned: %lu, "
+              "solver wall time: %g seconds."),
+            stats.nodes, stats.prunes, stats.wall_seconds);
+
+  count = cm_stats_by_city(cities, ARRAY_SIZE(cities));
+  for (i = 0; i < count; i++) {
+    struct city *pcity = game_city_by_number(cities[i].city_id);
+
+    cmd_reply(CMD_CMSTATS, caller, C_COMMENT,
+              /* TRANS: "Roma: 5311 nodes, 0.021 seconds (last solve)." */
+              _("%s: %lu nodes, %g seconds (last solve)."),
+              pcity != nullptr ? city_name_get(pcity) : _("(removed city)"),
+              cities[i].nodes, cities[i].wall_seconds);
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  cmd_reply() one line of the profile tree, indented by nesting depth.
+**************************************************************************/
+static void timing_tree_cb(int depth, const char *name, int calls,
+                           double seconds, void *data)
+{
+  struct connection *caller = data;
+  char buf[128];
+  int i;
+
+  buf[0] = '\0';
+  for (i = 0; i < depth; i++) {
+    sz_strlcat(buf, "  ");
+  }
+  cat_snprintf(buf, sizeof(buf), "%s: %g sec, %d calls", name, seconds,
+               calls);
+  cmd_reply(CMD_TIMING, caller, C_COMMENT, "%s", buf);
+}
+
+/**********************************************************************//**
+  Handle the timing command: control the scoped profiler and dump its
+  tree of per-turn timings.
+**************************************************************************/
+static bool timing_command(struct connection *caller, char *arg,
+                           bool check)
+{
+  if (arg[0] != '\0') {
+    if (fc_strcasecmp(arg, "on") == 0) {
+      if (!check) {
+        fcprof_enable(TRUE);
+        cmd_reply(CMD_TIMING, caller, C_OK, _("Profiler enabled."));
+      }
+    } else if (fc_strcasecmp(arg, "off") == 0) {
+      if (!check) {
+        fcprof_enable(FALSE);
+        cmd_reply(CMD_TIMING, caller, C_OK, _("Profiler disabled."));
+      }
+    } else if (fc_strcasecmp(arg, "log") == 0) {
+      if (!check) {
+        profile_turn_log_set(TRUE);
+        cmd_reply(CMD_TIMING, caller, C_OK,
+                  _("Per-turn profile lines will be written to the "
+                    "server log."));
+      }
+    } else if (fc_strcasecmp(arg, "nolog") == 0) {
+      if (!check) {
+        profile_turn_log_set(FALSE);
+        cmd_reply(CMD_TIMING, caller, C_OK,
+                  _("Per-turn profile lines disabled."));
+      }
+    } else if (fc_strcasecmp(arg, "clear") == 0) {
+      if (!check) {
+        fcprof_clear();
+        cmd_reply(CMD_TIMING, caller, C_OK, _("Profile data cleared."));
+      }
+    } else {
+      cmd_reply(CMD_TIMING, caller, C_SYNTAX,
+                _("The valid arguments are 'on', 'off', 'log', 'nolog' "
+                  "and 'clear'."));
+      return FALSE;
+    }
+    return TRUE;
+  }
+
+  if (check) {
+    return TRUE;
+  }
+
+  if (!fcprof_enabled()) {
+    cmd_reply(CMD_TIMING, caller, C_COMMENT,
+              _("The profiler is off; start it with 'timing on'."));
+    return TRUE;
+  }
+
+  cmd_reply(CMD_TIMING, caller, C_COMMENT,
+            _("Scope timings since the current turn began:"));
+  fcprof_report(timing_tree_cb, caller);
+
+  return TRUE;
+}
+
+/* Carries the caller through script_server_signal_stats_iterate() and
+ * counts the lines printed, so an empty report can be detected. */
+struct luastats_report {
+  struct connection *caller;
+  int lines;
+};
+
+/**********************************************************************//**
+  cmd_reply() one line of the Lua signal handler statistics.
+**************************************************************************/
+static void luastats_line_cb(const char *signal_name,
+                             const char *callback_name, int invocations,
+                             double total_time, double max_time,
+                             void *data)
+{
+  struct luastats_report *report = data;
+
+  if (invocations == 0) {
+    return;
+  }
+
+  cmd_reply(CMD_LUASTATS, report->caller, C_COMMENT,
+            /* TRANS: "unit_moved -> hut_enter_callback: ..." */
+            _("%s -> %s: %d calls, %g sec total, %g sec max."),
+            signal_name, callback_name, invocations, total_time,
+            max_time);
+  report->lines++;
+}
+
+/**********************************************************************//**
+  Report per-handler Lua signal execution statistics, reset them, or set
+  the per-handler time budget.
+**************************************************************************/
+static bool luastats_command(struct connection *caller, char *arg,
+                             bool check)
+{
+  struct luastats_report report;
+
+  if (arg[0] != '\0') {
+    if (fc_strcasecmp(arg, "reset") == 0) {
+      if (!check) {
+        script_server_signal_stats_reset();
+        cmd_reply(CMD_LUASTATS, caller, C_OK,
+                  _("Lua signal statistics reset."));
+      }
+      return TRUE;
+    }
+    if (fc_strncasecmp(arg, "budget", strlen("budget")) == 0) {
+      const char *value = arg + strlen("budget");
+      char *end;
+      double ms;
+
+      while (*value == ' ') {
+        value++;
+      }
+      ms = strtod(value, &end);
+      if (end == value || ms < 0) {
+        cmd_reply(CMD_LUASTATS, caller, C_SYNTAX,
+                  _("Usage: luastats budget <milliseconds>"));
+        return FALSE;
+      }
+      if (!check) {
+        luascript_signal_budget_set(ms / 1000.0);
+        if (ms > 0) {
+          cmd_reply(CMD_LUASTATS, caller, C_OK,
+                    _("Lua handler runs longer than %g ms will be "
+                      "logged."), ms);
+        } else {
+          cmd_reply(CMD_LUASTATS, caller, C_OK,
+                    _("Lua handler budget warnings disabled."));
+        }
+      }
+      return TRUE;
+    }
+    cmd_reply(CMD_LUASTATS, caller, C_SYNTAX,
+              _("The valid arguments are 'reset' and "
+                "'budget <milliseconds>'."));
+    return FALSE;
+  }
+
+  if (check) {
+    return TRUE;
+  }
+
+  report.caller = caller;
+  report.lines = 0;
+  script_server_signal_stats_iterate(luastats_line_cb, &report);
+  if (report.lines == 0) {
+    cmd_reply(CMD_LUASTATS, caller, C_COMMENT,
+              _("No Lua signal handlers have run."));
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  cmd_reply() one line of the memory allocation statistics.
+**************************************************************************/
+static void memstats_line_cb(const char *tag, size_t bytes, size_t allocs,
+                             size_t turn_bytes, size_t turn_allocs,
+                             void *data)
+{
+  struct connection *caller = data;
+
+  if (allocs == 0) {
+    return;
+  }
+
+  cmd_reply(CMD_MEMSTATS, caller, C_COMMENT,
+            /* TRANS: "units: 12.3 MB in 45678 allocations ..." */
+            _("%s: %.1f MB in %lu allocations "
+              "(%.1f MB, %lu this turn)."),
+            tag, (double) bytes / (1024.0 * 1024.0),
+            (unsigned long) allocs,
+            (double) turn_bytes / (1024.0 * 1024.0),
+            (unsigned long) turn_allocs);
+}
+
+/**********************************************************************//**
+  Handle the memstats command: control the tagged memory accounting and
+  show allocation traffic per subsystem.
+**************************************************************************/
+static bool memstats_command(struct connection *caller, char *arg,
+                             bool check)
+{
+  if (arg[0] != '\0') {
+    if (fc_strcasecmp(arg, "on") == 0) {
+      if (!check) {
+        mem_stats_enable(TRUE);
+        cmd_reply(CMD_MEMSTATS, caller, C_OK,
+                  _("Memory accounting enabled."));
+      }
+    } else if (fc_strcasecmp(arg, "off") == 0) {
+      if (!check) {
+        mem_stats_enable(FALSE);
+        cmd_reply(CMD_MEMSTATS, caller, C_OK,
+                  _("Memory accounting disabled."));
+      }
+    } else if (fc_strcasecmp(arg, "clear") == 0) {
+      if (!check) {
+        mem_stats_clear();
+        cmd_reply(CMD_MEMSTATS, caller, C_OK,
+                  _("Memory statistics cleared."));
+      }
+    } else {
+      cmd_reply(CMD_MEMSTATS, caller, C_SYNTAX,
+                _("The valid arguments are 'on', 'off' and 'clear'."));
+      return FALSE;
+    }
+    return TRUE;
+  }
+
+  if (check) {
+    return TRUE;
+  }
+
+  if (!mem_stats_enabled()) {
+    cmd_reply(CMD_MEMSTATS, caller, C_COMMENT,
+              _("Memory accounting is off; start it with "
+                "'memstats on'."));
+    return TRUE;
+  }
+
+  cmd_reply(CMD_MEMSTATS, caller, C_COMMENT,
+            _("Allocation traffic per subsystem (not live memory; "
+              "frees are not tracked):"));
+  mem_stats_report(memstats_line_cb, caller);
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  cmd_reply() the egress counters of one connection, or of all
+  connections ever if 'pconn' is nullptr, sorted by raw bytes.
+**************************************************************************/
+static void netstats_dump(struct connection *caller,
+                          const struct connection *pconn)
+{
+  int order[PACKET_LAST];
+  size_t total_packets = 0, total_bytes = 0;
+  int i, j, used = 0;
+
+  /* Insertion sort of the non-empty packet types by raw bytes; the
+   * table is small and this runs only on demand. */
+  for (i = 0; i < PACKET_LAST; i++) {
+    size_t packets, bytes;
+
+    packet_stats_get(pconn, i, &packets, &bytes);
+    if (packets == 0) {
+      continue;
+    }
+    total_packets += packets;
+    total_bytes += bytes;
+
+    for (j = used; j > 0; j--) {
+      size_t other_packets, other_bytes;
+
+      packet_stats_get(pconn, order[j - 1], &other_packets, &other_bytes);
+      if (other_bytes >= bytes) {
+        break;
+      }
+      order[j] = order[j - 1];
+    }
+    order[j] = i;
+    used++;
+  }
+
+  cmd_reply(CMD_NETSTATS, caller, C_COMMENT,
+            _("Sent %lu packets, %lu raw bytes, %lu bytes on the wire."),
+            (unsigned long) total_packets, (unsigned long) total_bytes,
+            (unsigned long) packet_stats_wire(pconn));
+
+  for (i = 0; i < used; i++) {
+    size_t packets, bytes;
+
+    packet_stats_get(pconn, order[i], &packets, &bytes);
+    cmd_reply(CMD_NETSTATS, caller, C_COMMENT,
+              /* TRANS: "PACKET_TILE_INFO(16): ..." */
+              _("%s(%d): %lu packets, %lu bytes (%.1f%% of raw)."),
+              packet_name(order[i]), order[i],
+              (unsigned long) packets, (unsigned long) bytes,
+              total_bytes > 0 ? 100.0 * bytes / total_bytes : 0.0);
+  }
+}
+
+/**********************************************************************//**
+  cmd_reply() one line of backlog metrics per established connection:
+  queue depth, egress rate since the previous query, how long the
+  oldest unwritten data has been waiting, and the reduced-updates flag
+  of the 'netlagbytes' policy.
+**************************************************************************/
+static void netstats_conn_lines(struct connection *caller)
+{
+  static struct timer *rate_timer = nullptr;
+  static int prev_ids[MAX_NUM_CONNECTIONS];
+  static size_t prev_wire[MAX_NUM_CONNECTIONS];
+  static int prev_count = 0;
+  double interval
+    = rate_timer != nullptr ? timer_read_seconds(rate_timer) : 0.0;
+  int count = 0;
+
+  conn_list_iterate(game.est_connections, pconn) {
+    size_t wire = packet_stats_wire(pconn);
+    size_t backlog = connection_send_backlog(pconn);
+    double rate = 0.0, behind = 0.0;
+    int i;
+
+    if (interval > 0.0) {
+      for (i = 0; i < prev_count; i++) {
+        if (prev_ids[i] == pconn->id) {
+          rate = (wire - prev_wire[i]) / interval;
+          break;
+        }
+      }
+    }
+    if (backlog > 0 && pconn->last_write != nullptr) {
+      behind = timer_read_seconds(pconn->last_write);
+    }
+
+    cmd_reply(CMD_NETSTATS, caller, C_COMMENT,
+              /* TRANS: "player (user): 0 bytes queued, ..." */
+              _("%s: %lu bytes queued, %.0f bytes/s, %.1f s behind%s"),
+              conn_description(pconn), (unsigned long) backlog, rate,
+              behind,
+              pconn->server.reduced_updates
+              ? _(", reduced updates") : "");
+
+    if (count < MAX_NUM_CONNECTIONS) {
+      prev_ids[count] = pconn->id;
+      prev_wire[count] = wire;
+      count++;
+    }
+  } conn_list_iterate_end;
+  prev_count = count;
+
+  rate_timer = timer_renew(rate_timer, TIMER_USER, TIMER_ACTIVE,
+                           rate_timer != nullptr ? nullptr : "netstats");
+  timer_start(rate_timer);
+}
+
+/**********************************************************************//**
+  Handle the netstats command: show network egress per packet type, for
+  all connections or one, or clear the counters.
+**************************************************************************/
+static bool netstats_command(struct connection *caller, char *arg,
+                             bool check)
+{
+  if (arg[0] != '\0') {
+    if (fc_strcasecmp(arg, "clear") == 0) {
+      if (!check) {
+        packet_stats_reset();
+        cmd_reply(CMD_NETSTATS, caller, C_OK,
+                  _("Network statistics cleared."));
+      }
+      return TRUE;
+    } else {
+      enum m_pre_result match_result;
+      struct connection *pconn = conn_by_user_prefix(arg, &match_result);
+
+      if (pconn == nullptr) {
+        cmd_reply_no_such_conn(CMD_NETSTATS, caller, arg, match_result);
+        return FALSE;
+      }
+      if (!check) {
+        cmd_reply(CMD_NETSTATS, caller, C_COMMENT,
+                  _("Egress to %s:"), conn_description(pconn));
+        netstats_dump(caller, pconn);
+      }
+      return TRUE;
+    }
+  }
+
+  if (check) {
+    return TRUE;
+  }
+
+  cmd_reply(CMD_NETSTATS, caller, C_COMMENT,
+            _("Egress to all connections since the counters were "
+              "cleared:"));
+  netstats_dump(caller, nullptr);
+  if (conn_list_size(game.est_connections) > 0) {
+    cmd_reply(CMD_NETSTATS, caller, C_COMMENT, _("Per connection:"));
+    netstats_conn_lines(caller);
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Show requirement and effect query counters ('/reqstats' command).
+**************************************************************************/
+static bool reqstats_command(struct connection *caller, char *arg,
+                             bool check)
+{
+  size_t hits, misses, turn_hits, turn_misses;
+  int order[MAX((int) VUT_COUNT, (int) EFT_COUNT)];
+  int count, i, j;
+
+  if (arg[0] != '\0') {
+    if (fc_strcasecmp(arg, "clear") == 0) {
+      if (!check) {
+        requirement_stats_clear();
+        effect_stats_clear();
+        cmd_reply(CMD_REQSTATS, caller, C_OK,
+                  _("Requirement and effect statistics cleared."));
+      }
+      return TRUE;
+    }
+    cmd_reply(CMD_REQSTATS, caller, C_SYNTAX,
+              _("The only valid argument is 'clear'."));
+    return FALSE;
+  }
+
+  if (check) {
+    return TRUE;
+  }
+
+  cmd_reply(CMD_REQSTATS, caller, C_COMMENT,
+            _("Requirement checks by kind since the counters were "
+              "cleared:"));
+  count = 0;
+  for (i = 0; i < VUT_COUNT; i++) {
+    size_t calls, turn_calls;
+
+    requirement_stats_get(i, &calls, &turn_calls);
+    if (calls == 0) {
+      continue;
+    }
+    /* Insertion sort, descending by total calls. */
+    for (j = count; j > 0; j--) {
+      size_t other, other_turn;
+
+      requirement_stats_get(order[j - 1], &other, &other_turn);
+      if (other >= calls) {
+        break;
+      }
+      order[j] = order[j - 1];
+    }
+    order[j] = i;
+    count++;
+  }
+  for (i = 0; i < count; i++) {
+    size_t calls, turn_calls;
+
+    requirement_stats_get(order[i], &calls, &turn_calls);
+    cmd_reply(CMD_REQSTATS, caller, C_COMMENT,
+              "  %s: %lu (%lu last turn)",
+              universals_n_name(order[i]),
+              (unsigned long) calls, (unsigned long) turn_calls);
+  }
+
+  requirement_stats_memo(&hits, &misses, &turn_hits, &turn_misses);
+  if (hits + misses > 0) {
+    cmd_reply(CMD_REQSTATS, caller, C_COMMENT,
+              _("Requirement memo: %lu hits, %lu misses (%.1f%% hit)."),
+              (unsigned long) hits, (unsigned long) misses,
+              100.0 * hits / (hits + misses));
+  }
+
+  cmd_reply(CMD_REQSTATS, caller, C_COMMENT,
+            _("Effect queries by type:"));
+  count = 0;
+  for (i = 0; i < EFT_COUNT; i++) {
+    size_t calls, turn_calls;
+
+    effect_stats_get(i, &calls, &turn_calls);
+    if (calls == 0) {
+      continue;
+    }
+    for (j = count; j > 0; j--) {
+      size_t other, other_turn;
+
+      effect_stats_get(order[j - 1], &other, &other_turn);
+      if (other >= calls) {
+        break;
+      }
+      order[j] = order[j - 1];
+    }
+    order[j] = i;
+    count++;
+  }
+  for (i = 0; i < count; i++) {
+    size_t calls, turn_calls;
+
+    effect_stats_get(order[i], &calls, &turn_calls);
+    cmd_reply(CMD_REQSTATS, caller, C_COMMENT,
+              "  %s: %lu (%lu last turn)",
+              effect_type_name(order[i]),
+              (unsigned long) calls, (unsigned long) turn_calls);
+  }
+
+  effect_stats_cache(&hits, &misses, &turn_hits, &turn_misses);
+  if (hits + misses > 0) {
+    cmd_reply(CMD_REQSTATS, caller, C_COMMENT,
+              _("Effect value cache: %lu hits, %lu misses (%.1f%% hit)."),
+              (unsigned long) hits, (unsigned long) misses,
+              100.0 * hits / (hits + misses));
+  }
+
+  return TRUE;
+}
+
 /**********************************************************************//**
   Execute a command in the context of the AI of the player.
 **************************************************************************/
@@ -6682,11 +7403,20 @@ static void show_connections(struct connection *caller)
     cmd_reply(CMD_LIST, caller, C_COMMENT, _("<no connections>"));
   } else {
     conn_list_iterate(game.all_connections, pconn) {
+      size_t backlog = connection_send_backlog(pconn);
+
       sz_strlcpy(buf, conn_description(pconn));
       if (pconn->established) {
         cat_snprintf(buf, sizeof(buf), " command access level %s",
                      cmdlevel_name(pconn->access_level));
       }
+      if (backlog > 0) {
+        cat_snprintf(buf, sizeof(buf), _(" (%lu bytes queued)"),
+                     (unsigned long) backlog);
+      }
+      if (pconn->established && pconn->server.reduced_updates) {
+        sz_strlcat(buf, _(" (reduced updates)"));
+      }
       cmd_reply(CMD_LIST, caller, C_COMMENT, "%s", buf);
     } conn_list_iterate_end;
   }
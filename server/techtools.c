@@ -43,8 +43,12 @@
 #include "maphand.h"
 #include "notify.h"
 #include "plrhand.h"
+#include "score.h"
 #include "unittools.h"
 
+/* server/advisors */
+#include "infracache.h"
+
 /* server/scripting */
 #include "script_server.h"
 
@@ -369,6 +373,12 @@ void found_new_tech(struct research *presearch, Tech_type_id tech_found,
   /* Assign 'advance_name' before we increase the future tech counter. */
   advance_name = research_advance_name_translation(presearch, tech_found);
 
+  /* A new tech can make new extras buildable, so the advisor tile
+   * improvement caches of everyone sharing this research are stale. */
+  research_players_iterate(presearch, member) {
+    adv_infra_cache_player_dirty(member);
+  } research_players_iterate_end;
+
   if (was_first && vap) {
     /* Alert the owners of any wonders that have been made obsolete */
     improvement_iterate(pimprove) {
@@ -423,6 +433,7 @@ void found_new_tech(struct research *presearch, Tech_type_id tech_found,
   } else {
     research_invention_set(presearch, tech_found, TECH_KNOWN);
     research_update(presearch);
+    score_counter_tech_change(presearch, 1);
   }
 
   /* Inform players about their new tech. */
@@ -853,6 +864,7 @@ static void research_tech_lost(struct research *presearch, Tech_type_id tech)
   /* Remove technology. */
   research_invention_set(presearch, tech, TECH_UNKNOWN);
   research_update(presearch);
+  score_counter_tech_change(presearch, -1);
   log_debug("%s lost tech id %d (%s)", research_rule_name(presearch), tech,
             advance_rule_name(advance_by_number(tech)));
 
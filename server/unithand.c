@@ -6421,10 +6421,12 @@ void create_trade_route(struct city *from, struct city *to,
   proute_from = fc_malloc(sizeof(struct trade_route));
   proute_from->partner = to->id;
   proute_from->goods = goods;
+  proute_from->base_cache.valid = FALSE;
 
   proute_to = fc_malloc(sizeof(struct trade_route));
   proute_to->partner = from->id;
   proute_to->goods = goods;
+  proute_to->base_cache.valid = FALSE;
 
   if (goods_has_flag(goods, GF_BIDIRECTIONAL)) {
     proute_from->dir = RDIR_BIDIRECTIONAL;
@@ -6749,6 +6751,9 @@ static bool unit_activity_internal(struct unit *punit,
     struct extra_type *old_target = punit->activity_target;
 
     set_unit_activity(punit, new_activity, trigger_action);
+    if (new_activity == ACTIVITY_SENTRY) {
+      unit_spatial_index_watching(punit);
+    }
     send_unit_info(nullptr, punit);
     unit_activity_dependencies(punit, old_activity, old_target);
 
@@ -6941,6 +6946,9 @@ void handle_unit_orders(struct player *pplayer,
   if (length) {
     punit->orders.list = order_list;
   }
+  if (packet->vigilant) {
+    unit_spatial_index_watching(punit);
+  }
 
   if (!packet->repeat) {
     punit->goto_tile = index_to_tile(nmap, packet->dest_tile);
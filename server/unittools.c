@@ -22,6 +22,7 @@
 /* utility */
 #include "bitvector.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "rand.h"
@@ -37,6 +38,7 @@
 #include "government.h"
 #include "idex.h"
 #include "map.h"
+#include "mapimg.h"
 #include "movement.h"
 #include "packets.h"
 #include "player.h"
@@ -74,7 +76,11 @@
 #include "techtools.h"
 #include "unithand.h"
 
+/* server/savegame */
+#include "savemain.h"
+
 /* server/advisors */
+#include "advdata.h"
 #include "advgoto.h"
 #include "autoexplorer.h"
 #include "autoworkers.h"
@@ -158,6 +164,231 @@ static int get_unit_vision_base(const struct unit *punit,
 static int unit_vision_range_modifiers(const struct unit *punit,
                                        const struct tile *ptile);
 
+/* Spatial index over square blocks of native map coordinates, so that a
+ * unit move can ask "is there any unit - or any sentried or vigilant
+ * unit - near this tile?" without walking the unit lists of every tile
+ * in range. The counts are exact right after a rebuild and only ever
+ * overestimate afterwards: arrivals and freshly set sentries bump them
+ * through unit_spatial_index_moved() / unit_spatial_index_watching(),
+ * while departures, deaths and wakeups are left to the rebuild done on
+ * the first query of each turn. */
+#define UNIT_SPATIAL_REGION_BITS 3
+#define UNIT_SPATIAL_REGION_SIZE (1 << UNIT_SPATIAL_REGION_BITS)
+
+static struct {
+  int xregions, yregions;
+  int turn;             /* game.info.turn of the last rebuild */
+  bool valid;
+  int *presence;        /* Units per region */
+  int *wakeable;        /* Sentried or vigilant units per region */
+} unit_spatial_index = { .valid = FALSE };
+
+/**********************************************************************//**
+  Does this unit react to enemy movement nearby?
+**************************************************************************/
+static bool unit_is_wakeable(const struct unit *punit)
+{
+  return punit->activity == ACTIVITY_SENTRY
+         || (unit_has_orders(punit) && punit->orders.vigilant);
+}
+
+/**********************************************************************//**
+  Return the spatial index region column of native x coordinate nat_x,
+  or -1 when the coordinate is beyond a non-wrapping edge.
+**************************************************************************/
+static int unit_spatial_col(int nat_x)
+{
+  if (current_wrap_has_flag(WRAP_X)) {
+    nat_x = FC_WRAP(nat_x, MAP_NATIVE_WIDTH);
+  } else if (nat_x < 0 || nat_x >= MAP_NATIVE_WIDTH) {
+    return -1;
+  }
+
+  return nat_x >> UNIT_SPATIAL_REGION_BITS;
+}
+
+/**********************************************************************//**
+  Return the spatial index region row of native y coordinate nat_y,
+  or -1 when the coordinate is beyond a non-wrapping edge.
+**************************************************************************/
+static int unit_spatial_row(int nat_y)
+{
+  if (current_wrap_has_flag(WRAP_Y)) {
+    nat_y = FC_WRAP(nat_y, MAP_NATIVE_HEIGHT);
+  } else if (nat_y < 0 || nat_y >= MAP_NATIVE_HEIGHT) {
+    return -1;
+  }
+
+  return nat_y >> UNIT_SPATIAL_REGION_BITS;
+}
+
+/**********************************************************************//**
+  Return the spatial index region holding punit's tile.
+**************************************************************************/
+static int unit_spatial_region(const struct unit *punit)
+{
+  int nat_x, nat_y;
+
+  index_to_native_pos(&nat_x, &nat_y, tile_index(unit_tile(punit)));
+
+  return unit_spatial_row(nat_y) * unit_spatial_index.xregions
+         + unit_spatial_col(nat_x);
+}
+
+/**********************************************************************//**
+  TRUE iff the spatial index still describes the current map and turn;
+  only then may the counts be bumped in place.
+**************************************************************************/
+static bool unit_spatial_index_fresh(void)
+{
+  return unit_spatial_index.valid
+         && unit_spatial_index.turn == game.info.turn
+         && unit_spatial_index.xregions
+            == ((MAP_NATIVE_WIDTH + UNIT_SPATIAL_REGION_SIZE - 1)
+                >> UNIT_SPATIAL_REGION_BITS)
+         && unit_spatial_index.yregions
+            == ((MAP_NATIVE_HEIGHT + UNIT_SPATIAL_REGION_SIZE - 1)
+                >> UNIT_SPATIAL_REGION_BITS);
+}
+
+/**********************************************************************//**
+  Recount every region from the unit lists, making the index usable for
+  the current map and turn. Returns FALSE when there is no map yet.
+**************************************************************************/
+static bool unit_spatial_index_ready(void)
+{
+  int xregions, yregions;
+
+  if (wld.map.tiles == nullptr) {
+    return FALSE;
+  }
+
+  if (unit_spatial_index_fresh()) {
+    return TRUE;
+  }
+
+  xregions = (MAP_NATIVE_WIDTH + UNIT_SPATIAL_REGION_SIZE - 1)
+             >> UNIT_SPATIAL_REGION_BITS;
+  yregions = (MAP_NATIVE_HEIGHT + UNIT_SPATIAL_REGION_SIZE - 1)
+             >> UNIT_SPATIAL_REGION_BITS;
+
+  if (unit_spatial_index.xregions != xregions
+      || unit_spatial_index.yregions != yregions) {
+    if (unit_spatial_index.presence != nullptr) {
+      free(unit_spatial_index.presence);
+      free(unit_spatial_index.wakeable);
+    }
+    unit_spatial_index.presence
+      = fc_malloc(xregions * yregions
+                  * sizeof(*unit_spatial_index.presence));
+    unit_spatial_index.wakeable
+      = fc_malloc(xregions * yregions
+                  * sizeof(*unit_spatial_index.wakeable));
+    unit_spatial_index.xregions = xregions;
+    unit_spatial_index.yregions = yregions;
+  }
+
+  memset(unit_spatial_index.presence, 0,
+         xregions * yregions * sizeof(*unit_spatial_index.presence));
+  memset(unit_spatial_index.wakeable, 0,
+         xregions * yregions * sizeof(*unit_spatial_index.wakeable));
+
+  players_iterate(pplayer) {
+    unit_list_iterate(pplayer->units, punit) {
+      int region = unit_spatial_region(punit);
+
+      unit_spatial_index.presence[region]++;
+      if (unit_is_wakeable(punit)) {
+        unit_spatial_index.wakeable[region]++;
+      }
+    } unit_list_iterate_end;
+  } players_iterate_end;
+
+  unit_spatial_index.turn = game.info.turn;
+  unit_spatial_index.valid = TRUE;
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Sum the given per-region counts over every region with a tile within
+  real map distance dist of ptile. May overestimate - a region is wider
+  than a tile - but never misses a counted unit in range.
+**************************************************************************/
+static int unit_spatial_count_near(const int *counts,
+                                   const struct tile *ptile, int dist)
+{
+  /* An iso-map compresses the X direction but not the Y direction;
+   * cmp. is_border_tile(). */
+  int ydist = (MAP_IS_ISOMETRIC ? 2 * dist : dist);
+  int cols[2 * 3 + 1], rows[2 * 6 + 1];
+  int ncols = 0, nrows = 0;
+  int nat_x, nat_y, d, i, j, total = 0;
+
+  fc_assert(dist <= 3);
+
+  index_to_native_pos(&nat_x, &nat_y, tile_index(ptile));
+
+  /* Wrapping can break a span of regions apart, so collect the distinct
+   * region columns and rows coordinate by coordinate. */
+  for (d = -dist; d <= dist; d++) {
+    int col = unit_spatial_col(nat_x + d);
+
+    for (i = 0; i < ncols && cols[i] != col; i++) {
+      /* Nothing */
+    }
+    if (col >= 0 && i == ncols) {
+      cols[ncols++] = col;
+    }
+  }
+  for (d = -ydist; d <= ydist; d++) {
+    int row = unit_spatial_row(nat_y + d);
+
+    for (i = 0; i < nrows && rows[i] != row; i++) {
+      /* Nothing */
+    }
+    if (row >= 0 && i == nrows) {
+      rows[nrows++] = row;
+    }
+  }
+
+  for (j = 0; j < nrows; j++) {
+    for (i = 0; i < ncols; i++) {
+      total += counts[rows[j] * unit_spatial_index.xregions + cols[i]];
+    }
+  }
+
+  return total;
+}
+
+/**********************************************************************//**
+  Count punit into the region it has just been placed on or moved to.
+  Departures are not tracked; the stale count lasts until the next
+  rebuild and only costs a wasted scan.
+**************************************************************************/
+void unit_spatial_index_moved(struct unit *punit)
+{
+  if (unit_spatial_index_fresh()) {
+    int region = unit_spatial_region(punit);
+
+    unit_spatial_index.presence[region]++;
+    if (unit_is_wakeable(punit)) {
+      unit_spatial_index.wakeable[region]++;
+    }
+  }
+}
+
+/**********************************************************************//**
+  Count punit as watching its surroundings; call when it starts
+  sentrying or is given vigilant orders.
+**************************************************************************/
+void unit_spatial_index_watching(struct unit *punit)
+{
+  if (unit_spatial_index_fresh()) {
+    unit_spatial_index.wakeable[unit_spatial_region(punit)]++;
+  }
+}
+
 /**********************************************************************//**
   Returns a unit type that matches the role_tech or role roles.
 
@@ -464,6 +695,122 @@ static void do_upgrade_effects(struct player *pplayer)
   unit_list_destroy(candidates);
 }
 
+/* The turn change bookkeeping passes below process every unit of a
+ * player, but the per-unit work shares no state between units on
+ * different continents. The phase scheduler buckets the units by
+ * continent id and runs the buckets on the shared task pool; units
+ * that are not on a continent (at sea or airborne,
+ * tile_continent() <= 0) are funneled to a sequential tail run on the
+ * main thread in unit list order. Jobs must not touch other units,
+ * send packets or call fc_rand(); the shared evaluation caches are
+ * frozen for the window, as they would otherwise be mutated from
+ * every bucket at once. */
+#define UNIT_PHASE_MIN_UNITS 80
+
+struct unit_phase_state {
+  struct unit **grouped;  /* Units sorted by continent bucket */
+  int *sizes;             /* Bucket sizes, one per continent */
+  int *starts;            /* Bucket start offsets into 'grouped' */
+  void (*job)(struct unit *punit);
+};
+
+/**********************************************************************//**
+  Task pool callback of the phase scheduler. Runs the job over every
+  unit of one continent bucket.
+**************************************************************************/
+static void unit_phase_run_bucket(int bucket, void *data)
+{
+  struct unit_phase_state *state = data;
+  int i;
+
+  for (i = 0; i < state->sizes[bucket]; i++) {
+    state->job(state->grouped[state->starts[bucket] + i]);
+  }
+}
+
+/**********************************************************************//**
+  Run 'job' once for every unit of 'units', concurrently per continent
+  when there is enough work to win anything by it.
+**************************************************************************/
+static void unit_phase_run(struct unit_list *units,
+                           void (*job)(struct unit *punit))
+{
+  struct unit_phase_state state;
+  struct unit **grouped, **tail;
+  int *sizes, *starts, *fill;
+  int nunits = unit_list_size(units);
+  int nbuckets = wld.map.num_continents;
+  int ntail = 0;
+  int i, start;
+
+  if (nunits < UNIT_PHASE_MIN_UNITS || nbuckets < 2) {
+    unit_list_iterate(units, punit) {
+      job(punit);
+    } unit_list_iterate_end;
+    return;
+  }
+
+  /* Scratch only needed while the jobs run; the phase arena reclaims
+   * it wholesale at the end of the phase. */
+  grouped = fc_arena_alloc(server_phase_arena(),
+                           nunits * sizeof(*grouped));
+  tail = fc_arena_alloc(server_phase_arena(), nunits * sizeof(*tail));
+  sizes = fc_arena_calloc(server_phase_arena(), nbuckets, sizeof(*sizes));
+  starts = fc_arena_alloc(server_phase_arena(),
+                          nbuckets * sizeof(*starts));
+  fill = fc_arena_calloc(server_phase_arena(), nbuckets, sizeof(*fill));
+
+  unit_list_iterate(units, punit) {
+    Continent_id cont = tile_continent(unit_tile(punit));
+
+    if (cont > 0) {
+      sizes[cont - 1]++;
+    }
+  } unit_list_iterate_end;
+
+  start = 0;
+  for (i = 0; i < nbuckets; i++) {
+    starts[i] = start;
+    start += sizes[i];
+  }
+
+  unit_list_iterate(units, punit) {
+    Continent_id cont = tile_continent(unit_tile(punit));
+
+    if (cont > 0) {
+      grouped[starts[cont - 1] + fill[cont - 1]++] = punit;
+    } else {
+      tail[ntail++] = punit;
+    }
+  } unit_list_iterate_end;
+
+  state.grouped = grouped;
+  state.sizes = sizes;
+  state.starts = starts;
+  state.job = job;
+
+  /* The jobs reach unit_move_rate(), get_activity_rate() and the
+   * requirement memo; none of the caches behind those may be written
+   * from several threads at once. */
+  effect_cache_freeze(TRUE);
+  requirement_memo_freeze(TRUE);
+  city_tile_output_cache_freeze(TRUE);
+  combat_cache_freeze(TRUE);
+
+  fc_taskpool_range(fc_taskpool_global(), 0, nbuckets,
+                    unit_phase_run_bucket, &state);
+
+  combat_cache_freeze(FALSE);
+  city_tile_output_cache_freeze(FALSE);
+  requirement_memo_freeze(FALSE);
+  effect_cache_freeze(FALSE);
+
+  /* Cross-continent cases go last, sequentially. */
+  for (i = 0; i < ntail; i++) {
+    job(tail[i]);
+  }
+}
+
 /**********************************************************************//**
   1. Do Leonardo's Workshop upgrade if applicable.
 
@@ -486,10 +833,12 @@ void player_restore_units(struct player *pplayer)
   /* 1) get Leonardo out of the way first: */
   do_upgrade_effects(pplayer);
 
-  unit_list_iterate_safe(pplayer->units, punit) {
+  /* 2) Modify unit hitpoints. Helicopters can even lose them.
+   *    Purely per-unit work, so run by continent on the phase
+   *    scheduler. */
+  unit_phase_run(pplayer->units, unit_restore_hitpoints);
 
-    /* 2) Modify unit hitpoints. Helicopters can even lose them. */
-    unit_restore_hitpoints(punit);
+  unit_list_iterate_safe(pplayer->units, punit) {
 
     /* 3) Check that unit has hitpoints */
     if (punit->hp <= 0) {
@@ -665,11 +1014,51 @@ static void unit_restore_movepoints(struct player *pplayer, struct unit *punit)
   punit->done_moving = FALSE;
 }
 
+/**********************************************************************//**
+  Per-unit bookkeeping of the activity pass: progress the activity
+  counter and restore move points. Shares no state between units, so
+  the phase scheduler may run it concurrently.
+**************************************************************************/
+static void update_unit_activity_bookkeeping(struct unit *punit)
+{
+  switch (punit->activity) {
+  case ACTIVITY_IDLE:
+  case ACTIVITY_EXPLORE:
+  case ACTIVITY_FORTIFIED:
+  case ACTIVITY_SENTRY:
+  case ACTIVITY_GOTO:
+  case ACTIVITY_LAST:
+    /* We don't need the activity_count for the above */
+    break;
+
+  case ACTIVITY_FORTIFYING:
+  case ACTIVITY_CONVERT:
+  case ACTIVITY_CLEAN:
+  case ACTIVITY_MINE:
+  case ACTIVITY_IRRIGATE:
+  case ACTIVITY_PILLAGE:
+  case ACTIVITY_CULTIVATE:
+  case ACTIVITY_PLANT:
+  case ACTIVITY_TRANSFORM:
+  case ACTIVITY_BASE:
+  case ACTIVITY_GEN_ROAD:
+    punit->activity_count += get_activity_rate_this_turn(punit);
+    break;
+  };
+
+  unit_restore_movepoints(unit_owner(punit), punit);
+}
+
 /**********************************************************************//**
   Iterate through all units and update them.
 **************************************************************************/
 void update_unit_activities(struct player *pplayer)
 {
+  /* The counting and move point restoration cannot complete any work
+   * and is run up front by continent; finishing activities touches
+   * tiles and neighbouring units and stays sequential below. */
+  unit_phase_run(pplayer->units, update_unit_activity_bookkeeping);
+
   unit_list_iterate_safe(pplayer->units, punit) {
     update_unit_activity(punit);
   } unit_list_iterate_safe_end;
@@ -864,19 +1253,18 @@ static void update_unit_activity(struct unit *punit)
   struct tile *ptile = unit_tile(punit);
   const struct unit_type *act_utype = unit_type_get(punit);
 
+  /* Counting and move point restoration already happened in
+   * update_unit_activity_bookkeeping(). */
+
   switch (activity) {
   case ACTIVITY_IDLE:
   case ACTIVITY_EXPLORE:
   case ACTIVITY_FORTIFIED:
   case ACTIVITY_SENTRY:
   case ACTIVITY_GOTO:
-  case ACTIVITY_LAST:
-    /* We don't need the activity_count for the above */
-    break;
-
   case ACTIVITY_FORTIFYING:
   case ACTIVITY_CONVERT:
-    punit->activity_count += get_activity_rate_this_turn(punit);
+  case ACTIVITY_LAST:
     break;
 
   case ACTIVITY_CLEAN:
@@ -888,17 +1276,15 @@ static void update_unit_activity(struct unit *punit)
   case ACTIVITY_TRANSFORM:
   case ACTIVITY_BASE:
   case ACTIVITY_GEN_ROAD:
-    punit->activity_count += get_activity_rate_this_turn(punit);
-
     /* Worker may become veteran when doing something useful */
     if (maybe_become_veteran_real(punit, 100, TRUE)) {
       notify_unit_experience(punit);
+      /* The move rate may have grown with the new veteran level. */
+      unit_restore_movepoints(pplayer, punit);
     }
     break;
   };
 
-  unit_restore_movepoints(pplayer, punit);
-
   switch (activity) {
   case ACTIVITY_EXPLORE:
     /* Not accumulating activity - will be handled more like movement
@@ -1564,7 +1950,10 @@ void transform_unit(struct unit *punit, const struct unit_type *to_unit,
   int old_hp = unit_type_get(punit)->hp;
   int lvls;
 
+  /* The unit type changes; re-account it in the threat profiles. */
+  adv_threat_unit_destroyed(punit);
   punit->utype = to_unit;
+  adv_threat_unit_created(punit);
 
   /* New type may not have the same veteran system, and we may want to
    * knock some levels off. */
@@ -1740,6 +2129,8 @@ bool place_unit(struct unit *punit, struct player *pplayer,
 
   unit_list_prepend(pplayer->units, punit);
   unit_list_prepend(ptile->units, punit);
+  unit_spatial_index_moved(punit);
+  adv_threat_unit_created(punit);
   unit_make_contact(punit, ptile, nullptr);
   if (pcity && !unit_has_type_flag(punit, UTYF_NOHOME)) {
     fc_assert(punit->homecity == pcity->id);
@@ -1809,6 +2200,11 @@ static void server_remove_unit_full(struct unit *punit, bool transported,
   /* The unit is doomed. */
   punit->server.dying = TRUE;
 
+  deltasave_dirty_player(pplayer);
+  mapimg_tile_dirty(ptile);
+
+  adv_threat_unit_destroyed(punit);
+
 #if defined(FREECIV_DEBUG) && !defined(FREECIV_NDEBUG)
   unit_list_iterate(ptile->units, pcargo) {
     fc_assert(unit_transport_get(pcargo) != punit);
@@ -2892,6 +3288,9 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
 
   CHECK_UNIT(punit);
 
+  deltasave_dirty_player(unit_owner(punit));
+  mapimg_tile_dirty(unit_tile(punit));
+
   powner = unit_owner(punit);
   package_unit(punit, &info);
   package_short_unit(punit, &sinfo, UNIT_INFO_IDENTITY, 0);
@@ -3530,6 +3929,13 @@ static bool unit_survive_autoattack(struct unit *punit)
     return TRUE;
   }
 
+  if (unit_spatial_index_ready()
+      && unit_spatial_count_near(unit_spatial_index.presence,
+                                 unit_tile(punit), 1) <= 1) {
+    /* Nobody around but the moving unit itself. */
+    return TRUE;
+  }
+
   autoattack = autoattack_prob_list_new_full(autoattack_prob_free);
 
   /* Kludge to prevent attack power from dropping to zero during calc */
@@ -3666,6 +4072,13 @@ static void wakeup_neighbor_sentries(struct unit *punit)
 {
   bool alone_in_city;
 
+  if (unit_spatial_index_ready()
+      && unit_spatial_count_near(unit_spatial_index.wakeable,
+                                 unit_tile(punit), 3) == 0) {
+    /* No sentried or vigilant unit anywhere near. */
+    return;
+  }
+
   if (tile_city(unit_tile(punit)) != nullptr) {
     int count = 0;
 
@@ -3953,6 +4366,8 @@ static void unit_move_by_data(struct unit_move_data *pdata,
   /* Set new tile. */
   unit_tile_set(punit, pdesttile);
   unit_list_prepend(pdesttile->units, punit);
+  unit_spatial_index_moved(punit);
+  adv_threat_unit_moved(punit, psrctile, pdesttile);
 
   if (unit_transported(punit)) {
     /* Silently free orders since they won't be applicable anymore. */
@@ -4109,6 +4524,9 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
   psrctile = unit_tile(punit);
   adj = base_get_direction_for_step(&(wld.map), psrctile, pdesttile, &facing);
 
+  /* The destination tile is marked by send_unit_info() later on. */
+  mapimg_tile_dirty(psrctile);
+
   conn_list_do_buffer(game.est_connections);
 
   /* Unload the unit if on a transport. */
@@ -4425,8 +4843,19 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
   }
 
   if (unit_lives) {
+    /* "unit_moved" fires for every single move; emit by id so a game
+     * without a handler pays only a counter check. Ids are assigned in
+     * creation order, so the cached value stays valid across scripting
+     * state reloads. */
+    static int unit_moved_sid = -1;
+
+    if (unit_moved_sid < 0) {
+      unit_moved_sid = script_server_signal_id("unit_moved");
+    }
+
     /* Let the scripts run ... */
-    script_server_signal_emit("unit_moved", punit, psrctile, pdesttile);
+    script_server_signal_emit_by_id(unit_moved_sid, punit, psrctile,
+                                    pdesttile);
     unit_lives = unit_is_alive(saved_id);
   }
 
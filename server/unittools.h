@@ -177,6 +177,8 @@ bool do_paradrop(struct unit *punit, struct tile *ptile,
                  const struct action *paction);
 void unit_transport_load_send(struct unit *punit, struct unit *ptrans);
 void unit_transport_unload_send(struct unit *punit);
+void unit_spatial_index_moved(struct unit *punit);
+void unit_spatial_index_watching(struct unit *punit);
 bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
                struct unit *embark_to, bool find_embark_target,
                bool conquer_city_allowed, bool conquer_extras_allowed,
@@ -0,0 +1,355 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* Microbenchmarks for the utility containers. Build and run with
+ * "make bench" in tests/ (or "meson test --benchmark"). Each workload
+ * prints one machine-readable "bench: <name>=<seconds> ops=<count>"
+ * line, so container changes can be compared before/after by diffing
+ * the output of two runs.
+ *
+ * The workloads mimic the hot uses in the game: integer-keyed hashes
+ * accessed like the delta caches, unit-list style traversal with
+ * mid-list removals, map-sized bitvectors, a pathfinding frontier on
+ * the priority queue, log/chat line assembly, and a savegame-shaped
+ * section file. Seeds are fixed so runs are repeatable. */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* utility */
+#include "astring.h"
+#include "bitvector.h"
+#include "genhash.h"
+#include "ioz.h"
+#include "mem.h"
+#include "rand.h"
+#include "registry.h"
+#include "registry_ini.h"
+#include "shared.h"
+#include "support.h"
+#include "timing.h"
+
+/* A dummy unit for the list iteration traces. */
+struct bench_unit {
+  int id;
+  int moves_left;
+  int hp;
+};
+
+#define SPECLIST_TAG bench_unit
+#define SPECLIST_TYPE struct bench_unit
+#include "speclist.h"
+
+#define bench_unit_list_iterate(list, punit) \
+  TYPED_LIST_ITERATE(struct bench_unit, list, punit)
+#define bench_unit_list_iterate_end LIST_ITERATE_END
+
+/* Integer-keyed, integer-valued hash, as the id -> object tables and
+ * the delta caches use genhash. */
+#define SPECHASH_TAG bench
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_INT_DATA_TYPE
+#include "spechash.h"
+
+/* Pathfinding-frontier style priority queue. */
+#define SPECPQ_TAG bench
+#define SPECPQ_DATA_TYPE int
+#define SPECPQ_PRIORITY_TYPE int
+#include "specpq.h"
+
+#define BENCH_MAP_TILES (400 * 400)
+
+static struct timer *bench_timer;
+
+/* Accumulator the workloads fold results into, so the work cannot be
+ * optimized away. */
+static long bench_sink = 0;
+
+/**********************************************************************//**
+  Start timing a workload.
+**************************************************************************/
+static void bench_begin(void)
+{
+  timer_clear(bench_timer);
+  timer_start(bench_timer);
+}
+
+/**********************************************************************//**
+  Stop timing and print the workload's report line.
+**************************************************************************/
+static void bench_end(const char *name, long ops)
+{
+  timer_stop(bench_timer);
+  printf("bench: %s=%.6f ops=%ld\n", name,
+         timer_read_seconds(bench_timer), ops);
+}
+
+/**********************************************************************//**
+  genhash via spechash: build an id table, then hammer it with the
+  delta-cache access pattern - overwhelmingly lookups that hit, a few
+  that miss, and steady insert/remove churn as objects come and go.
+**************************************************************************/
+static void bench_genhash(void)
+{
+  struct bench_hash *hash = bench_hash_new();
+  const int entries = 50000;
+  const long lookups = 5000000;
+  const int churn = 200000;
+  long i;
+  int data;
+
+  bench_begin();
+  for (i = 0; i < entries; i++) {
+    bench_hash_insert(hash, i, i * 3);
+  }
+  bench_end("genhash_insert", entries);
+
+  bench_begin();
+  for (i = 0; i < lookups; i++) {
+    /* Every tenth key misses. */
+    int key = fc_rand(entries + entries / 10);
+
+    if (bench_hash_lookup(hash, key, &data)) {
+      bench_sink += data;
+    }
+  }
+  bench_end("genhash_lookup", lookups);
+
+  bench_begin();
+  for (i = 0; i < churn; i++) {
+    int key = fc_rand(entries);
+
+    bench_hash_remove(hash, key);
+    bench_hash_insert(hash, key, (int) i);
+  }
+  bench_end("genhash_churn", churn);
+
+  bench_hash_destroy(hash);
+}
+
+/**********************************************************************//**
+  speclist/genlist: traverse a unit-list sized list over and over, the
+  way the per-turn loops do, then mix in mid-list unit death and
+  new-unit prepends.
+**************************************************************************/
+static void bench_speclist(void)
+{
+  struct bench_unit_list *list = bench_unit_list_new();
+  const int units = 2000;
+  const int sweeps = 20000;
+  const int churn = 100000;
+  struct bench_unit *pool = fc_calloc(units, sizeof(*pool));
+  long i;
+
+  for (i = 0; i < units; i++) {
+    pool[i].id = i;
+    pool[i].moves_left = i % 9;
+    pool[i].hp = 20;
+    bench_unit_list_append(list, &pool[i]);
+  }
+
+  bench_begin();
+  for (i = 0; i < sweeps; i++) {
+    bench_unit_list_iterate(list, punit) {
+      bench_sink += punit->moves_left;
+    } bench_unit_list_iterate_end;
+  }
+  bench_end("speclist_iterate", (long) sweeps * units);
+
+  bench_begin();
+  for (i = 0; i < churn; i++) {
+    struct bench_unit *punit = &pool[fc_rand(units)];
+
+    bench_unit_list_remove(list, punit);
+    bench_unit_list_prepend(list, punit);
+  }
+  bench_end("speclist_churn", churn);
+
+  bench_unit_list_destroy(list);
+  free(pool);
+}
+
+/**********************************************************************//**
+  bitvector: map-sized dbv - the fogofwar and placement prefilter
+  shape. Set a scattered pattern, then scan it many times.
+**************************************************************************/
+static void bench_bitvector(void)
+{
+  struct dbv bv, copy;
+  const int scans = 100;
+  long i, bit;
+
+  dbv_init(&bv, BENCH_MAP_TILES);
+  dbv_init(&copy, BENCH_MAP_TILES);
+
+  bench_begin();
+  for (i = 0; i < scans; i++) {
+    dbv_clr_all(&bv);
+    for (bit = i % 7; bit < BENCH_MAP_TILES; bit += 7) {
+      dbv_set(&bv, bit);
+    }
+  }
+  bench_end("bitvector_set", (long) scans * (BENCH_MAP_TILES / 7));
+
+  bench_begin();
+  for (i = 0; i < scans; i++) {
+    for (bit = 0; bit < BENCH_MAP_TILES; bit++) {
+      if (dbv_isset(&bv, bit)) {
+        bench_sink++;
+      }
+    }
+  }
+  bench_end("bitvector_scan", (long) scans * BENCH_MAP_TILES);
+
+  bench_begin();
+  for (i = 0; i < scans; i++) {
+    dbv_copy(&copy, &bv);
+    if (dbv_are_equal(&copy, &bv)) {
+      bench_sink++;
+    }
+  }
+  bench_end("bitvector_copy", scans);
+
+  dbv_free(&bv);
+  dbv_free(&copy);
+}
+
+/**********************************************************************//**
+  specpq: push a map worth of tiles with mixed priorities and drain the
+  queue, as a pathfinding frontier does.
+**************************************************************************/
+static void bench_specpq(void)
+{
+  const int rounds = 10;
+  long i, r;
+
+  bench_begin();
+  for (r = 0; r < rounds; r++) {
+    struct bench_pq *pq = bench_pq_new(1024);
+    int data;
+
+    for (i = 0; i < BENCH_MAP_TILES; i++) {
+      bench_pq_insert(pq, (int) i, fc_rand(10000));
+    }
+    while (bench_pq_remove(pq, &data)) {
+      bench_sink += data;
+    }
+    bench_pq_destroy(pq);
+  }
+  bench_end("specpq_cycle", (long) rounds * BENCH_MAP_TILES);
+}
+
+/**********************************************************************//**
+  astring: assemble many multi-field lines the way log, chat and the
+  profiler output are built.
+**************************************************************************/
+static void bench_astring(void)
+{
+  const int lines = 20000;
+  const int fields = 20;
+  struct astring line = ASTRING_INIT;
+  long i, f;
+
+  bench_begin();
+  for (i = 0; i < lines; i++) {
+    astr_set(&line, "line: turn=%ld", i);
+    for (f = 0; f < fields; f++) {
+      astr_add(&line, " field%ld=%ld/%ld", f, i + f, i - f);
+    }
+    bench_sink += strlen(astr_str(&line));
+  }
+  bench_end("astring_build", (long) lines * fields);
+
+  astr_free(&line);
+}
+
+/**********************************************************************//**
+  registry_ini: build a savegame-shaped section file, save it, load it
+  back and look everything up again.
+**************************************************************************/
+static void bench_registry(void)
+{
+  const char *filename = "utility_bench.ini";
+  const int players = 8;
+  const int units = 500;
+  struct section_file *sf;
+  long p, u;
+  int value;
+
+  bench_begin();
+  sf = secfile_new(FALSE);
+  for (p = 0; p < players; p++) {
+    for (u = 0; u < units; u++) {
+      secfile_insert_int(sf, (int) (p * units + u),
+                         "player%ld.u%ld.id", p, u);
+      secfile_insert_int(sf, (int) (u % 80), "player%ld.u%ld.x", p, u);
+      secfile_insert_int(sf, (int) (u / 80), "player%ld.u%ld.y", p, u);
+      secfile_insert_str(sf, "settlers", "player%ld.u%ld.type", p, u);
+    }
+  }
+  bench_end("registry_insert", (long) players * units * 4);
+
+  bench_begin();
+  secfile_save(sf, filename, 0, FZ_PLAIN);
+  bench_end("registry_save", (long) players * units * 4);
+  secfile_destroy(sf);
+
+  bench_begin();
+  sf = secfile_load(filename, FALSE);
+  bench_end("registry_load", (long) players * units * 4);
+
+  if (sf != NULL) {
+    bench_begin();
+    for (p = 0; p < players; p++) {
+      for (u = 0; u < units; u++) {
+        if (secfile_lookup_int(sf, &value, "player%ld.u%ld.id", p, u)) {
+          bench_sink += value;
+        }
+      }
+    }
+    bench_end("registry_lookup", (long) players * units);
+    secfile_destroy(sf);
+  }
+
+  remove(filename);
+}
+
+/**********************************************************************//**
+  Run all the container workloads.
+**************************************************************************/
+int main(void)
+{
+  fc_srand(1234567);
+  registry_module_init();
+  bench_timer = timer_new(TIMER_USER, TIMER_ACTIVE, "bench");
+
+  bench_genhash();
+  bench_speclist();
+  bench_bitvector();
+  bench_specpq();
+  bench_astring();
+  bench_registry();
+
+  timer_destroy(bench_timer);
+  registry_module_close();
+
+  /* Reference the sink so no workload can be discarded entirely. */
+  fprintf(stderr, "(checksum %ld)\n", bench_sink);
+
+  return EXIT_SUCCESS;
+}
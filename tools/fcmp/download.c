@@ -32,22 +32,233 @@
 /* utility */
 #include "capability.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "netfile.h"
 #include "registry.h"
+#include "shared.h"
+#include "support.h"
 
 /* tools */
 #include "mpdb.h"
 
 #include "download.h"
 
+/* Number of concurrent connections used for modpack file downloads. */
+#define DOWNLOAD_POOL_SIZE 4
+
+/* Suffix of in-progress downloads, kept on failure so the next attempt
+ * can resume where this one stopped. */
+#define PARTDL_SUFFIX ".part"
+
+struct file_download_job {
+  char *URL;
+  char *local_name;  /* Final destination */
+  char *part_name;   /* In-progress download */
+  char *src_name;    /* For messages */
+  bool failed;
+};
+
+struct download_pool {
+  struct file_download_job *jobs;
+  int job_count;
+  int next_job;
+  int done;
+  fc_mutex mutex;
+};
+
+struct download_worker {
+  struct download_pool *pool;
+  struct netfile_conn *conn;
+  bool started;
+  fc_thread thread;
+};
+
 static const char *download_modpack_recursive(const char *URL,
                                               const struct fcmp_params *fcmp,
                                               dl_msg_callback mcb,
                                               dl_pb_callback pbcb,
                                               int recursion);
 
+/**********************************************************************//**
+  Queue one file for download.
+**************************************************************************/
+static void download_job_add(struct download_pool *pool, const char *URL,
+                             const char *local_name, const char *src_name)
+{
+  struct file_download_job *job;
+  size_t part_len = strlen(local_name) + strlen(PARTDL_SUFFIX) + 1;
+
+  pool->jobs = fc_realloc(pool->jobs,
+                          (pool->job_count + 1) * sizeof(*pool->jobs));
+  job = &pool->jobs[pool->job_count++];
+
+  job->URL = fc_strdup(URL);
+  job->local_name = fc_strdup(local_name);
+  job->part_name = fc_malloc(part_len);
+  fc_snprintf(job->part_name, part_len, "%s%s",
+              local_name, PARTDL_SUFFIX);
+  job->src_name = fc_strdup(src_name);
+  job->failed = FALSE;
+}
+
+/**********************************************************************//**
+  Free all the jobs of a download pool.
+**************************************************************************/
+static void download_pool_free(struct download_pool *pool)
+{
+  int i;
+
+  for (i = 0; i < pool->job_count; i++) {
+    free(pool->jobs[i].URL);
+    free(pool->jobs[i].local_name);
+    free(pool->jobs[i].part_name);
+    free(pool->jobs[i].src_name);
+  }
+
+  free(pool->jobs);
+  pool->jobs = NULL;
+  pool->job_count = 0;
+}
+
+/**********************************************************************//**
+  Download worker. Pulls queued files until the pool runs dry. No
+  callbacks from here - the gui callbacks are not thread safe, so
+  progress and failures are reported by the main thread.
+**************************************************************************/
+static void download_pool_thread(void *arg)
+{
+  struct download_worker *worker = arg;
+  struct download_pool *pool = worker->pool;
+
+  for (;;) {
+    struct file_download_job *job;
+
+    fc_mutex_allocate(&pool->mutex);
+    if (pool->next_job >= pool->job_count) {
+      fc_mutex_release(&pool->mutex);
+      break;
+    }
+    job = &pool->jobs[pool->next_job++];
+    fc_mutex_release(&pool->mutex);
+
+    log_debug("Download \"%s\" as \"%s\".", job->URL, job->local_name);
+
+    /* Download to the '.part' name so that an aborted run can resume,
+     * and a previously installed file is never used as a resume base. */
+    if (netfile_conn_download(worker->conn, job->URL, job->part_name,
+                              TRUE, NULL, NULL)) {
+      fc_remove(job->local_name); /* May not exist */
+      if (rename(job->part_name, job->local_name) != 0) {
+        job->failed = TRUE;
+      }
+    } else {
+      job->failed = TRUE;
+    }
+
+    fc_mutex_allocate(&pool->mutex);
+    pool->done++;
+    fc_mutex_release(&pool->mutex);
+  }
+}
+
+/**********************************************************************//**
+  Download all the queued files with a small pool of connections.
+  Progress and failure messages go out from the calling thread.
+  Returns TRUE if any file failed.
+**************************************************************************/
+static bool download_pool_run(struct download_pool *pool,
+                              dl_msg_callback mcb, dl_pb_callback pbcb)
+{
+  struct download_worker workers[DOWNLOAD_POOL_SIZE];
+  int worker_count = MIN(DOWNLOAD_POOL_SIZE, pool->job_count);
+  int last_done = -1;
+  bool started_any = FALSE;
+  bool failures = FALSE;
+  int i;
+
+  if (pool->job_count == 0) {
+    return FALSE;
+  }
+
+  fc_mutex_init(&pool->mutex);
+  pool->next_job = 0;
+  pool->done = 0;
+
+  /* Open the connections from this thread, before the workers start. */
+  for (i = 0; i < worker_count; i++) {
+    workers[i].pool = pool;
+    workers[i].conn = netfile_conn_open();
+    workers[i].started = FALSE;
+  }
+
+  for (i = 0; i < worker_count; i++) {
+    if (workers[i].conn != NULL) {
+      workers[i].started
+        = (fc_thread_start(&workers[i].thread, download_pool_thread,
+                           &workers[i]) == 0);
+      started_any = started_any || workers[i].started;
+    }
+  }
+
+  if (!started_any) {
+    if (workers[0].conn != NULL) {
+      /* No threads available; download in this thread instead. */
+      download_pool_thread(&workers[0]);
+    } else {
+      for (i = 0; i < pool->job_count; i++) {
+        pool->jobs[i].failed = TRUE;
+      }
+      pool->done = pool->job_count;
+    }
+  }
+
+  for (;;) {
+    int done;
+
+    fc_mutex_allocate(&pool->mutex);
+    done = pool->done;
+    fc_mutex_release(&pool->mutex);
+
+    if (pbcb != NULL && done != last_done) {
+      /* Count download of control file also */
+      pbcb(done + 1, pool->job_count + 1);
+      last_done = done;
+    }
+
+    if (done >= pool->job_count) {
+      break;
+    }
+
+    fc_usleep(50000);
+  }
+
+  for (i = 0; i < worker_count; i++) {
+    if (workers[i].started) {
+      fc_thread_wait(&workers[i].thread);
+    }
+    netfile_conn_close(workers[i].conn);
+  }
+
+  fc_mutex_destroy(&pool->mutex);
+
+  for (i = 0; i < pool->job_count; i++) {
+    if (pool->jobs[i].failed) {
+      failures = TRUE;
+      if (mcb != NULL) {
+        char buf[2048];
+
+        fc_snprintf(buf, sizeof(buf), _("Failed to download %s"),
+                    pool->jobs[i].src_name);
+        mcb(buf);
+      }
+    }
+  }
+
+  return failures;
+}
+
 /**********************************************************************//**
   Message callback called by netfile module when downloading files.
 **************************************************************************/
@@ -95,6 +306,7 @@ static const char *download_modpack_recursive(const char *URL,
   int dep;
   const char *dep_name;
   struct section_list *sec;
+  struct download_pool pool = { NULL, 0, 0, 0 };
 
   if (recursion > 5) {
     return _("Recursive dependencies too deep");
@@ -256,7 +468,6 @@ static const char *download_modpack_recursive(const char *URL,
   if (sec != NULL) {
     size_t sec_count = section_list_size(sec);
     size_t i;
-    int filenbr = 0;
 
     for (i = 0; i < sec_count; i++) {
       const char *sec_name = section_name(section_list_get(sec, i));
@@ -367,47 +578,42 @@ static const char *download_modpack_recursive(const char *URL,
 #endif /* DIR_SEPARATOR_IS_DEFAULT */
 
           if (!make_dir_for_file(local_name)) {
+            download_pool_free(&pool);
             secfile_destroy(control);
             return _("Cannot create required directories");
           }
 
-          if (mcb != NULL) {
-            char buf[2048];
-
-            fc_snprintf(buf, sizeof(buf), _("Downloading %s"), src_name);
-            mcb(buf);
-          }
-
           fc_snprintf(fileURL, sizeof(fileURL), "%s/%s", baseURL, src_name);
-          log_debug("Download \"%s\" as \"%s\".", fileURL, local_name);
-          if (!netfile_download_file(fileURL, local_name, nf_cb, mcb)) {
-            if (mcb != NULL) {
-              char buf[2048];
-
-              fc_snprintf(buf, sizeof(buf), _("Failed to download %s"),
-                          src_name);
-              mcb(buf);
-            }
-            partial_failure = TRUE;
-          }
+          download_job_add(&pool, fileURL, local_name, src_name);
         } else {
 #ifndef DIR_SEPARATOR_IS_DEFAULT
           free(dest_name_copy);
 #endif /* DIR_SEPARATOR_IS_DEFAULT */
         }
-
-        filenbr++;
-
-        if (pbcb != NULL) {
-          /* Count download of control file also */
-          pbcb(filenbr + 1, total_files + 1);
-        }
       }
     }
   }
 
   section_list_destroy(sec);
 
+  if (pool.job_count > 0) {
+    if (mcb != NULL) {
+      char buf[2048];
+
+      fc_snprintf(buf, sizeof(buf),
+                  PL_("Downloading %d file", "Downloading %d files",
+                      pool.job_count),
+                  pool.job_count);
+      mcb(buf);
+    }
+
+    if (download_pool_run(&pool, mcb, pbcb)) {
+      partial_failure = TRUE;
+    }
+  }
+
+  download_pool_free(&pool);
+
   if (partial_failure) {
     secfile_destroy(control);
 
@@ -421,6 +627,53 @@ static const char *download_modpack_recursive(const char *URL,
   return NULL;
 }
 
+/**********************************************************************//**
+  Count the modpacks of 'new_file' that are missing from 'old_file' or
+  carry a different version there.
+**************************************************************************/
+static int download_list_diff(const struct section_file *new_file,
+                              const struct section_file *old_file)
+{
+  int changed = 0;
+  const char *new_name;
+  int i;
+
+  for (i = 0;
+       (new_name = secfile_lookup_str_default(new_file, NULL,
+                                              "modpacks.list%d.name", i))
+         != NULL;
+       i++) {
+    const char *new_ver = secfile_lookup_str_default(new_file, NULL,
+                                                     "modpacks.list%d.version",
+                                                     i);
+    const char *old_ver = NULL;
+    const char *old_name;
+    bool found = FALSE;
+    int j;
+
+    for (j = 0;
+         (old_name = secfile_lookup_str_default(old_file, NULL,
+                                                "modpacks.list%d.name", j))
+           != NULL;
+         j++) {
+      if (!fc_strcasecmp(old_name, new_name)) {
+        found = TRUE;
+        old_ver = secfile_lookup_str_default(old_file, NULL,
+                                             "modpacks.list%d.version", j);
+        break;
+      }
+    }
+
+    if (!found
+        || (new_ver != NULL
+            && (old_ver == NULL || strcmp(new_ver, old_ver) != 0))) {
+      changed++;
+    }
+  }
+
+  return changed;
+}
+
 /**********************************************************************//**
   Download modpack list
 **************************************************************************/
@@ -434,9 +687,31 @@ const char *download_modpack_list(const struct fcmp_params *fcmp,
   const char *msg;
   const char *mp_name;
   int start_idx;
+  char cache_path[2048];
+  bool from_cache = FALSE;
+
+  if (fcmp->inst_prefix != NULL) {
+    fc_snprintf(cache_path, sizeof(cache_path),
+                "%s" DIR_SEPARATOR "modpack.list.cache",
+                fcmp->inst_prefix);
+  } else {
+    cache_path[0] = '\0';
+  }
 
   list_file = netfile_get_section_file(fcmp->list_url, nf_cb, mcb);
 
+  if (list_file == NULL && cache_path[0] != '\0') {
+    /* Fall back to the copy cached on an earlier run. */
+    list_file = secfile_load(cache_path, FALSE);
+
+    if (list_file != NULL) {
+      from_cache = TRUE;
+      if (mcb != NULL) {
+        mcb(_("Failed to fetch modpack list; using cached copy."));
+      }
+    }
+  }
+
   if (list_file == NULL) {
     return _("Cannot fetch and parse modpack list");
   }
@@ -473,6 +748,31 @@ const char *download_modpack_list(const struct fcmp_params *fcmp,
     mcb(msg);
   }
 
+  if (!from_cache && cache_path[0] != '\0') {
+    /* Tell what changed since the previous run, then refresh
+     * the cache. */
+    struct section_file *old_file = secfile_load(cache_path, FALSE);
+
+    if (old_file != NULL) {
+      int changed = download_list_diff(list_file, old_file);
+
+      if (changed > 0 && mcb != NULL) {
+        char buf[2048];
+
+        fc_snprintf(buf, sizeof(buf),
+                    PL_("%d modpack new or updated since the last run",
+                        "%d modpacks new or updated since the last run",
+                        changed),
+                    changed);
+        mcb(buf);
+      }
+
+      secfile_destroy(old_file);
+    }
+
+    secfile_save(list_file, cache_path, 0, FZ_PLAIN);
+  }
+
   modpack_count = 0;
   do {
     const char *mpURL;
@@ -531,5 +831,7 @@ const char *download_modpack_list(const struct fcmp_params *fcmp,
     modpack_count++;
   } while (mp_name != NULL);
 
+  secfile_destroy(list_file);
+
   return NULL;
 }
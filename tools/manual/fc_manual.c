@@ -29,6 +29,7 @@
 #include "fc_cmdline.h"
 #include "fciconv.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "registry.h"
@@ -36,8 +37,10 @@
 /* common */
 #include "capstr.h"
 #include "connection.h"
+#include "effects.h"
 #include "fc_cmdhelp.h"
 #include "fc_interface.h"
+#include "requirements.h"
 #include "version.h"
 
 /* client */
@@ -323,11 +326,47 @@ void manual_finalize(struct tag_types *tag_info, FILE *doc,
              _(manuals_name(manual)), manual + 1);
 }
 
+struct manual_page_job {
+  bool (*generate)(struct tag_types *tag_info);
+  struct tag_types *tag_info;
+  bool started;                 /* Worker thread running */
+  bool ok;
+  fc_thread thread;
+};
+
+/**********************************************************************//**
+  Worker thread writing a single manual page.
+**************************************************************************/
+static void manual_page_thread(void *data)
+{
+  struct manual_page_job *job = data;
+
+  job->ok = job->generate(job->tag_info);
+}
+
 /**********************************************************************//**
   Write a server manual, then quit.
 **************************************************************************/
 static bool manual_command(struct tag_types *tag_info)
 {
+  /* Once the ruleset is loaded the pages only read it, and each page
+   * streams to its own output file, so they can be written
+   * concurrently. helptext_unit_upkeep_str() returns a static buffer,
+   * but only the units page calls it. */
+  struct manual_page_job jobs[] = {
+    { .generate = manual_settings },
+    { .generate = manual_commands },
+    { .generate = manual_terrain },
+    { .generate = manual_extras },
+    { .generate = manual_buildings },
+    { .generate = manual_governments },
+    { .generate = manual_units },
+    { .generate = manual_uclasses },
+    { .generate = manual_techs }
+  };
+  int i;
+  bool ok = TRUE;
+
   /* Reset aifill to zero */
   game.info.aifill = 0;
 
@@ -336,19 +375,37 @@ static bool manual_command(struct tag_types *tag_info)
     return FALSE;
   }
 
-  if (!manual_settings(tag_info)
-      || !manual_commands(tag_info)
-      || !manual_terrain(tag_info)
-      || !manual_extras(tag_info)
-      || !manual_buildings(tag_info)
-      || !manual_governments(tag_info)
-      || !manual_units(tag_info)
-      || !manual_uclasses(tag_info)
-      || !manual_techs(tag_info)) {
-    return FALSE;
+  /* The workers must not write to the shared evaluation caches. */
+  effect_cache_freeze(TRUE);
+  requirement_memo_freeze(TRUE);
+
+  for (i = 0; i < (int) ARRAY_SIZE(jobs); i++) {
+    struct manual_page_job *job = &jobs[i];
+
+    job->tag_info = tag_info;
+    job->started = (fc_thread_start(&job->thread,
+                                    manual_page_thread, job) == 0);
+    if (!job->started) {
+      /* Write the page on this thread instead. */
+      manual_page_thread(job);
+    }
   }
 
-  return TRUE;
+  for (i = 0; i < (int) ARRAY_SIZE(jobs); i++) {
+    struct manual_page_job *job = &jobs[i];
+
+    if (job->started) {
+      fc_thread_wait(&job->thread);
+    }
+    if (!job->ok) {
+      ok = FALSE;
+    }
+  }
+
+  requirement_memo_freeze(FALSE);
+  effect_cache_freeze(FALSE);
+
+  return ok;
 }
 
 /**********************************************************************//**
@@ -0,0 +1,273 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+/* utility */
+#include "executable.h"
+#include "fc_cmdline.h"
+#include "fciconv.h"
+#include "fcintl.h"
+#include "log.h"
+#include "support.h"
+
+/* common */
+#include "fc_cmdhelp.h"
+#include "fc_interface.h"
+
+/* common/networking */
+#include "connection.h"
+#include "packets.h"
+
+/* tools/shared */
+#include "tools_fc_interface.h"
+
+static int fatal_assertions = -1;
+
+/* Per packet type traffic totals, indexed by direction. */
+struct type_stats {
+  long count[2];                /* 0 = received, 1 = sent */
+  long long bytes[2];
+};
+
+static struct type_stats stats[PACKET_LAST];
+static long long wire_bytes = 0;
+static long long queue_bytes = 0;
+static double first_time = -1.0;
+static double last_time = 0.0;
+static long records = 0;
+
+/**********************************************************************//**
+  Parse freeciv-netbench commandline parameters. Returns the index of
+  the first capture file argument.
+**************************************************************************/
+static int nbench_parse_cmdline(int argc, char *argv[])
+{
+  int i = 1;
+
+  while (i < argc && argv[i][0] == '-') {
+    if (is_option("--help", argv[i])) {
+      struct cmdhelp *help = cmdhelp_new(argv[0]);
+
+      cmdhelp_add(help, "h", "help",
+                  _("Print a summary of the options"));
+#ifndef FREECIV_NDEBUG
+      cmdhelp_add(help, "F",
+                  /* TRANS: "Fatal" is exactly what user must type, do not translate. */
+                  _("Fatal [SIGNAL]"),
+                  _("Raise a signal on failed assertion or broken data"));
+#endif /* FREECIV_NDEBUG */
+
+      /* The function below prints a header and footer for the options.
+       * Furthermore, the options are sorted. */
+      cmdhelp_display(help, TRUE, FALSE, TRUE);
+      cmdhelp_destroy(help);
+
+      fc_fprintf(stderr,
+                 /* TRANS: do not translate FREECIV_PACKET_CAPTURE */
+                 _("Remaining arguments are .fcap capture files, as "
+                   "written by a server or client running with the "
+                   "FREECIV_PACKET_CAPTURE environment variable set.\n"));
+
+      cmdline_option_values_free();
+
+      exit(EXIT_SUCCESS);
+#ifndef FREECIV_NDEBUG
+    } else if (is_option("--Fatal", argv[i])) {
+      if (i + 1 >= argc || '-' == argv[i + 1][0]) {
+        fatal_assertions = SIGABRT;
+      } else if (str_to_int(argv[i + 1], &fatal_assertions)) {
+        i++;
+      } else {
+        fc_fprintf(stderr, _("Invalid signal number \"%s\".\n"),
+                   argv[i + 1]);
+        fc_fprintf(stderr, _("Try using --help.\n"));
+        exit(EXIT_FAILURE);
+      }
+#endif /* FREECIV_NDEBUG */
+    } else {
+      fc_fprintf(stderr, _("Unrecognized option: \"%s\"\n"), argv[i]);
+      cmdline_option_values_free();
+      exit(EXIT_FAILURE);
+    }
+
+    i++;
+  }
+
+  return i;
+}
+
+/**********************************************************************//**
+  Aggregate one capture file into the totals. Returns FALSE if the file
+  could not be read or is not a capture.
+**************************************************************************/
+static bool read_capture(const char *fname)
+{
+  FILE *fp = fopen(fname, "rb");
+  char magic[sizeof(FCAP_MAGIC)];
+
+  if (fp == NULL) {
+    log_error(_("Could not open \"%s\"."), fname);
+    return FALSE;
+  }
+
+  if (fread(magic, 1, strlen(FCAP_MAGIC), fp) != strlen(FCAP_MAGIC)
+      || memcmp(magic, FCAP_MAGIC, strlen(FCAP_MAGIC)) != 0) {
+    log_error(_("\"%s\" is not a capture file."), fname);
+    fclose(fp);
+    return FALSE;
+  }
+
+  for (;;) {
+    double now;
+    unsigned char kind;
+    int sizes[3];
+
+    if (fread(&now, sizeof(now), 1, fp) != 1) {
+      /* Normal end of file */
+      break;
+    }
+    if (fread(&kind, 1, 1, fp) != 1
+        || fread(sizes, sizeof(sizes), 1, fp) != 1) {
+      log_error(_("\"%s\" is truncated."), fname);
+      break;
+    }
+
+    if (first_time < 0 || now < first_time) {
+      first_time = now;
+    }
+    if (now > last_time) {
+      last_time = now;
+    }
+
+    switch (kind) {
+    case 'S':
+    case 'R':
+      {
+        int type = sizes[0];
+        int len = sizes[1];
+        int dir = ('S' == kind) ? 1 : 0;
+
+        if (type < 0 || type >= PACKET_LAST || len < 0) {
+          log_error(_("\"%s\" is corrupt."), fname);
+          fclose(fp);
+          return FALSE;
+        }
+
+        stats[type].count[dir]++;
+        stats[type].bytes[dir] += len;
+        records++;
+        fseek(fp, len, SEEK_CUR);
+      }
+      break;
+    case 'C':
+      wire_bytes += sizes[1];
+      queue_bytes += sizes[2];
+      break;
+    default:
+      log_error(_("\"%s\" is corrupt."), fname);
+      fclose(fp);
+      return FALSE;
+    }
+  }
+
+  fclose(fp);
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Print the aggregated per packet type and stream wide statistics.
+**************************************************************************/
+static void report(void)
+{
+  double span = last_time - first_time;
+  long total_count = 0;
+  long long total_bytes = 0;
+  int i;
+
+  log_normal("%-34s %9s %12s %9s %12s",
+             _("packet type"), _("recv"), _("bytes"),
+             _("sent"), _("bytes"));
+
+  for (i = 0; i < PACKET_LAST; i++) {
+    if (stats[i].count[0] > 0 || stats[i].count[1] > 0) {
+      log_normal("%-34s %9ld %12lld %9ld %12lld",
+                 packet_name(i),
+                 stats[i].count[0], stats[i].bytes[0],
+                 stats[i].count[1], stats[i].bytes[1]);
+      total_count += stats[i].count[0] + stats[i].count[1];
+      total_bytes += stats[i].bytes[0] + stats[i].bytes[1];
+    }
+  }
+
+  log_normal("%ld packets, %lld bytes over %.3fs (%.0f packets/s)",
+             total_count, total_bytes, span,
+             span > 0 ? total_count / span : 0.0);
+
+  if (queue_bytes > 0 && wire_bytes > 0) {
+    log_normal(_("compression: %lld bytes sent as %lld (ratio %.2f)"),
+               queue_bytes, wire_bytes,
+               (double) queue_bytes / (double) wire_bytes);
+  }
+}
+
+/**********************************************************************//**
+  Main entry point for freeciv-netbench
+**************************************************************************/
+int main(int argc, char **argv)
+{
+  int exit_status = EXIT_SUCCESS;
+  int i;
+
+  executable_init();
+
+  /* Initialize the fc_interface functions needed for the common code.
+   * fc_interface_init_tool() includes low level support like
+   * guaranteeing that fc_vsnprintf() will work after it,
+   * so this need to be early. */
+  fc_interface_init_tool();
+
+  init_character_encodings(FC_DEFAULT_DATA_ENCODING, FALSE);
+
+  i = nbench_parse_cmdline(argc, argv);
+
+  log_init(NULL, LOG_NORMAL, NULL, NULL, fatal_assertions);
+
+  if (i >= argc) {
+    fc_fprintf(stderr, _("No capture files given. Try using --help.\n"));
+    exit_status = EXIT_FAILURE;
+  }
+
+  for (; i < argc; i++) {
+    if (!read_capture(argv[i])) {
+      exit_status = EXIT_FAILURE;
+    }
+  }
+
+  if (EXIT_SUCCESS == exit_status && records > 0) {
+    report();
+  }
+
+  log_close();
+  libfreeciv_free();
+  cmdline_option_values_free();
+
+  return exit_status;
+}
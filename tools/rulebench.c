@@ -0,0 +1,287 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <signal.h>
+
+/* utility */
+#include "executable.h"
+#include "fc_cmdline.h"
+#include "fciconv.h"
+#include "registry.h"
+#include "timing.h"
+
+/* common */
+#include "actions.h"
+#include "effects.h"
+#include "fc_cmdhelp.h"
+#include "fc_interface.h"
+#include "game.h"
+#include "improvement.h"
+#include "requirements.h"
+#include "unittype.h"
+
+/* server */
+#include "ruleload.h"
+#include "sernet.h"
+#include "settings.h"
+
+/* tools/shared */
+#include "tools_fc_interface.h"
+
+static char *rs_selected = NULL;
+static int rounds = 10;
+static int fatal_assertions = -1;
+
+/**********************************************************************//**
+  Parse freeciv-rulebench commandline parameters.
+**************************************************************************/
+static void rbench_parse_cmdline(int argc, char *argv[])
+{
+  int i = 1;
+
+  while (i < argc) {
+    char *option = NULL;
+
+    if (is_option("--help", argv[i])) {
+      struct cmdhelp *help = cmdhelp_new(argv[0]);
+
+      cmdhelp_add(help, "h", "help",
+                  _("Print a summary of the options"));
+#ifndef FREECIV_NDEBUG
+      cmdhelp_add(help, "F",
+                  /* TRANS: "Fatal" is exactly what user must type, do not translate. */
+                  _("Fatal [SIGNAL]"),
+                  _("Raise a signal on failed assertion or broken data"));
+#endif /* FREECIV_NDEBUG */
+      cmdhelp_add(help, "r",
+                  /* TRANS: "ruleset" is exactly what user must type, do not translate. */
+                  _("ruleset RULESET"),
+                  _("Benchmark RULESET"));
+      cmdhelp_add(help, "n",
+                  /* TRANS: "rounds" is exactly what user must type, do not translate. */
+                  _("rounds ROUNDS"),
+                  _("Run each query stream ROUNDS times"));
+
+      /* The function below prints a header and footer for the options.
+       * Furthermore, the options are sorted. */
+      cmdhelp_display(help, TRUE, FALSE, TRUE);
+      cmdhelp_destroy(help);
+
+      cmdline_option_values_free();
+
+      exit(EXIT_SUCCESS);
+    } else if ((option = get_option_malloc("--ruleset", argv, &i, argc, TRUE))) {
+      if (rs_selected != NULL) {
+        fc_fprintf(stderr,
+                   _("Multiple rulesets requested. Only one ruleset at time supported.\n"));
+      } else {
+        rs_selected = option;
+      }
+    } else if ((option = get_option_malloc("--rounds", argv, &i, argc, TRUE))) {
+      if (!str_to_int(option, &rounds) || rounds < 1) {
+        fc_fprintf(stderr, _("Invalid round count \"%s\".\n"), option);
+        cmdline_option_values_free();
+        exit(EXIT_FAILURE);
+      }
+#ifndef FREECIV_NDEBUG
+    } else if (is_option("--Fatal", argv[i])) {
+      if (i + 1 >= argc || '-' == argv[i + 1][0]) {
+        fatal_assertions = SIGABRT;
+      } else if (str_to_int(argv[i + 1], &fatal_assertions)) {
+        i++;
+      } else {
+        fc_fprintf(stderr, _("Invalid signal number \"%s\".\n"),
+                   argv[i + 1]);
+        fc_fprintf(stderr, _("Try using --help.\n"));
+        exit(EXIT_FAILURE);
+      }
+#endif /* FREECIV_NDEBUG */
+    } else {
+      fc_fprintf(stderr, _("Unrecognized option: \"%s\"\n"), argv[i]);
+      cmdline_option_values_free();
+      exit(EXIT_FAILURE);
+    }
+
+    i++;
+  }
+}
+
+/**********************************************************************//**
+  Conversion log callback
+**************************************************************************/
+static void conv_log(const char *msg)
+{
+  log_normal("%s", msg);
+}
+
+/**********************************************************************//**
+  One round of world range effect queries, the kind the per city and per
+  player bonus getters issue during a city refresh. Returns the number of
+  queries made.
+**************************************************************************/
+static long bench_effects_round(void)
+{
+  long queries = 0;
+  enum effect_type type;
+
+  for (type = 0; type < EFT_COUNT; type++) {
+    (void) get_world_bonus(type);
+    queries++;
+  }
+
+  return queries;
+}
+
+/**********************************************************************//**
+  One round of action enabler probes, the kind unithand.c and the action
+  probability code issue for every actor unit. Returns the number of
+  queries made.
+**************************************************************************/
+static long bench_enablers_round(void)
+{
+  long queries = 0;
+
+  action_iterate(act) {
+    unit_type_iterate(putype) {
+      const struct req_context actor = { .unittype = putype };
+
+      (void) action_enablers_allow(act, &actor, NULL);
+      queries++;
+    } unit_type_iterate_end;
+  } action_iterate_end;
+
+  return queries;
+}
+
+/**********************************************************************//**
+  One round of what-if template queries, the kind the AI building want
+  evaluation and the help text generators issue. Returns the number of
+  queries made.
+**************************************************************************/
+static long bench_templates_round(void)
+{
+  long queries = 0;
+  enum effect_type type;
+
+  for (type = 0; type < EFT_COUNT; type++) {
+    improvement_iterate(pimprove) {
+      struct universal uni = { .kind = VUT_IMPROVEMENT,
+                               .value = { .building = pimprove } };
+
+      (void) effect_value_from_universals(type, &uni, 1);
+      queries++;
+    } improvement_iterate_end;
+  }
+
+  return queries;
+}
+
+/**********************************************************************//**
+  Run one query stream for the configured number of rounds and report
+  throughput. The first round runs against cold caches; comparing it to
+  the remaining rounds shows how much the caches pay for this ruleset.
+**************************************************************************/
+static void bench_stream(const char *name, long (*round_func)(void))
+{
+  struct timer *t = timer_new(TIMER_CPU, TIMER_ACTIVE, name);
+  long queries = 0;
+  double cold, total;
+  int i;
+
+  timer_start(t);
+  queries += round_func();
+  cold = timer_read_seconds(t);
+
+  for (i = 1; i < rounds; i++) {
+    queries += round_func();
+  }
+  total = timer_read_seconds(t);
+
+  if (rounds > 1) {
+    log_normal("%-18s %10ld queries in %8.4fs (%.0f/s); "
+               "cold round %.4fs, warm rounds avg %.4fs",
+               name, queries, total,
+               total > 0 ? queries / total : 0.0,
+               cold, (total - cold) / (rounds - 1));
+  } else {
+    log_normal("%-18s %10ld queries in %8.4fs (%.0f/s)",
+               name, queries, total,
+               total > 0 ? queries / total : 0.0);
+  }
+
+  timer_destroy(t);
+}
+
+/**********************************************************************//**
+  Main entry point for freeciv-rulebench
+**************************************************************************/
+int main(int argc, char **argv)
+{
+  enum log_level loglevel = LOG_NORMAL;
+  int exit_status = EXIT_SUCCESS;
+
+  executable_init();
+
+  /* Initialize the fc_interface functions needed to understand rules.
+   * fc_interface_init_tool() includes low level support like
+   * guaranteeing that fc_vsnprintf() will work after it,
+   * so this need to be early. */
+  fc_interface_init_tool();
+
+  registry_module_init();
+  init_character_encodings(FC_DEFAULT_DATA_ENCODING, FALSE);
+
+  rbench_parse_cmdline(argc, argv);
+
+  log_init(NULL, loglevel, NULL, NULL, fatal_assertions);
+
+  init_connections();
+
+  settings_init(FALSE);
+
+  game_init(FALSE);
+  i_am_tool();
+
+  /* Set ruleset user requested to use */
+  if (rs_selected == NULL) {
+    rs_selected = GAME_DEFAULT_RULESETDIR;
+  }
+  sz_strlcpy(game.server.rulesetdir, rs_selected);
+
+  /* Reset aifill to zero */
+  game.info.aifill = 0;
+
+  if (load_rulesets(NULL, NULL, TRUE, conv_log, FALSE, TRUE, TRUE)) {
+    log_normal("Benchmarking ruleset %s (%d rounds per stream)",
+               rs_selected, rounds);
+
+    bench_stream("effect queries", bench_effects_round);
+    bench_stream("enabler probes", bench_enablers_round);
+    bench_stream("want templates", bench_templates_round);
+  } else {
+    log_error(_("Can't load ruleset %s"), rs_selected);
+
+    exit_status = EXIT_FAILURE;
+  }
+
+  registry_module_close();
+  log_close();
+  libfreeciv_free();
+  cmdline_option_values_free();
+
+  return exit_status;
+}
@@ -0,0 +1,270 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+/* utility */
+#include "executable.h"
+#include "fc_cmdline.h"
+#include "fciconv.h"
+#include "fcintl.h"
+#include "ioz.h"
+#include "log.h"
+#include "registry.h"
+#include "shared.h"
+#include "string_vector.h"
+#include "support.h"
+#include "timing.h"
+
+/* common */
+#include "fc_cmdhelp.h"
+#include "fc_interface.h"
+
+/* server */
+#include "sanitycheck.h"
+#include "sernet.h"
+#include "settings.h"
+#include "srv_main.h"
+
+/* server/savegame */
+#include "savemain.h"
+
+/* tools/shared */
+#include "tools_fc_interface.h"
+
+static char *saves_dir = NULL;
+static int fatal_assertions = -1;
+
+/**********************************************************************//**
+  Parse freeciv-savebench commandline parameters.
+**************************************************************************/
+static void sbench_parse_cmdline(int argc, char *argv[])
+{
+  int i = 1;
+
+  while (i < argc) {
+    char *option = NULL;
+
+    if (is_option("--help", argv[i])) {
+      struct cmdhelp *help = cmdhelp_new(argv[0]);
+
+      cmdhelp_add(help, "h", "help",
+                  _("Print a summary of the options"));
+#ifndef FREECIV_NDEBUG
+      cmdhelp_add(help, "F",
+                  /* TRANS: "Fatal" is exactly what user must type, do not translate. */
+                  _("Fatal [SIGNAL]"),
+                  _("Raise a signal on failed assertion or broken data"));
+#endif /* FREECIV_NDEBUG */
+      cmdhelp_add(help, "s",
+                  /* TRANS: "saves" is exactly what user must type, do not translate. */
+                  _("saves DIR"),
+                  _("Load the reference savegames from DIR"));
+
+      /* The function below prints a header and footer for the options.
+       * Furthermore, the options are sorted. */
+      cmdhelp_display(help, TRUE, FALSE, TRUE);
+      cmdhelp_destroy(help);
+
+      cmdline_option_values_free();
+
+      exit(EXIT_SUCCESS);
+    } else if ((option = get_option_malloc("--saves", argv, &i, argc, TRUE))) {
+      if (saves_dir != NULL) {
+        fc_fprintf(stderr,
+                   _("Multiple directories requested. Only one directory at time supported.\n"));
+      } else {
+        saves_dir = option;
+      }
+#ifndef FREECIV_NDEBUG
+    } else if (is_option("--Fatal", argv[i])) {
+      if (i + 1 >= argc || '-' == argv[i + 1][0]) {
+        fatal_assertions = SIGABRT;
+      } else if (str_to_int(argv[i + 1], &fatal_assertions)) {
+        i++;
+      } else {
+        fc_fprintf(stderr, _("Invalid signal number \"%s\".\n"),
+                   argv[i + 1]);
+        fc_fprintf(stderr, _("Try using --help.\n"));
+        exit(EXIT_FAILURE);
+      }
+#endif /* FREECIV_NDEBUG */
+    } else {
+      fc_fprintf(stderr, _("Unrecognized option: \"%s\"\n"), argv[i]);
+      cmdline_option_values_free();
+      exit(EXIT_FAILURE);
+    }
+
+    i++;
+  }
+}
+
+/**********************************************************************//**
+  Read the whole savefile through the ioz decompressor, without parsing
+  anything. Returns the number of uncompressed bytes read, or -1 on
+  error. The time this takes is the pure decompression cost; the parse
+  phase pays it again, so the difference between the two is the
+  tokenizing and hashing cost.
+**************************************************************************/
+static long long sbench_decompress(const char *fullname)
+{
+  fz_FILE *fp = fz_from_file(fullname, "r", -1, 0);
+  static char buffer[64 * 1024];
+  long long total = 0;
+  int len;
+
+  if (fp == NULL) {
+    return -1;
+  }
+
+  while ((len = fz_fread(buffer, sizeof(buffer), fp)) > 0) {
+    total += len;
+  }
+  if (len < 0 || 0 != fz_ferror(fp)) {
+    total = -1;
+  }
+  fz_fclose(fp);
+
+  return total;
+}
+
+/**********************************************************************//**
+  Time the load of one savegame, phase by phase, and print the table
+  row. Returns FALSE if the file could not be loaded.
+**************************************************************************/
+static bool sbench_file(const char *name, const char *fullname)
+{
+  struct timer *t = timer_new(TIMER_CPU, TIMER_ACTIVE, name);
+  double t_decompress, t_parse, t_game, t_sanity, mark;
+  long long uncompressed;
+  struct section_file *file;
+
+  timer_start(t);
+  uncompressed = sbench_decompress(fullname);
+  t_decompress = timer_read_seconds(t);
+
+  if (uncompressed < 0) {
+    log_error(_("Error reading savefile '%s'"), fullname);
+    timer_destroy(t);
+    return FALSE;
+  }
+
+  file = secfile_load(fullname, FALSE);
+  t_parse = timer_read_seconds(t) - t_decompress;
+
+  if (file == NULL) {
+    log_error(_("Error parsing savefile '%s': %s"), fullname,
+              secfile_error());
+    timer_destroy(t);
+    return FALSE;
+  }
+
+  /* Blow away the previous game like load_command() does. The reset is
+   * left out of the phase times. */
+  server_game_free();
+  server_game_init(TRUE);
+
+  mark = timer_read_seconds(t);
+  savegame_load(file);
+  t_game = timer_read_seconds(t) - mark;
+  secfile_destroy(file);
+
+  mark = timer_read_seconds(t);
+  sanity_check();
+  t_sanity = timer_read_seconds(t) - mark;
+
+  log_normal("%-28s %9.2f %10.3f %10.3f %10.3f %10.3f %10.3f",
+             name, uncompressed / (1024.0 * 1024.0),
+             t_decompress, t_parse, t_game, t_sanity,
+             t_decompress + t_parse + t_game + t_sanity);
+
+  timer_destroy(t);
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Main entry point for freeciv-savebench
+**************************************************************************/
+int main(int argc, char **argv)
+{
+  enum log_level loglevel = LOG_NORMAL;
+  int exit_status = EXIT_SUCCESS;
+  struct strvec *dirs;
+  struct fileinfo_list *files;
+  int loaded = 0;
+
+  executable_init();
+
+  /* Initialize the fc_interface functions needed to understand rules.
+   * fc_interface_init_tool() includes low level support like
+   * guaranteeing that fc_vsnprintf() will work after it,
+   * so this need to be early. */
+  fc_interface_init_tool();
+
+  registry_module_init();
+  init_character_encodings(FC_DEFAULT_DATA_ENCODING, FALSE);
+
+  sbench_parse_cmdline(argc, argv);
+
+  log_init(NULL, loglevel, NULL, NULL, fatal_assertions);
+
+  init_connections();
+
+  settings_init(FALSE);
+
+  server_game_init(FALSE);
+  i_am_tool();
+
+  if (saves_dir == NULL) {
+    saves_dir = ".";
+  }
+
+  dirs = strvec_new();
+  strvec_append(dirs, saves_dir);
+  files = fileinfolist_infix(dirs, ".sav", TRUE);
+
+  log_normal("%-28s %9s %10s %10s %10s %10s %10s",
+             "savegame", "MiB", "decomp", "parse", "sg_load", "sanity",
+             "total");
+
+  fileinfo_list_iterate(files, pfile) {
+    if (sbench_file(pfile->name, pfile->fullname)) {
+      loaded++;
+    } else {
+      exit_status = EXIT_FAILURE;
+    }
+  } fileinfo_list_iterate_end;
+
+  if (loaded == 0) {
+    log_error(_("No savegames found in \"%s\""), saves_dir);
+    exit_status = EXIT_FAILURE;
+  }
+
+  fileinfo_list_destroy(files);
+  strvec_destroy(dirs);
+
+  server_game_free();
+  registry_module_close();
+  log_close();
+  libfreeciv_free();
+  cmdline_option_values_free();
+
+  return exit_status;
+}
@@ -66,7 +66,6 @@
 
 /* utility */
 #include "fcintl.h"
-#include "fcthread.h"
 #include "log.h"                /* fc_assert() */
 #include "mem.h"
 #include "support.h"            /* fc_vsnprintf(), fc_strlcat() */
@@ -76,62 +75,9 @@
 #define str     _private_str_
 #define n       _private_n_
 #define n_alloc _private_n_alloc_
+#define buf     _private_buf_
 
 static const struct astring zero_astr = ASTRING_INIT;
-static char *astr_buffer = nullptr;
-static size_t astr_buffer_alloc = 0;
-
-static fc_mutex astr_mutex;
-
-static inline char *astr_buffer_get(size_t *alloc);
-static inline char *astr_buffer_grow(size_t request, size_t *alloc);
-static void astr_buffer_free(void);
-
-/************************************************************************//**
-  Returns the astring buffer. Create it if necessary.
-****************************************************************************/
-static inline char *astr_buffer_get(size_t *alloc)
-{
-  if (astr_buffer == nullptr) {
-    astr_buffer_alloc = 4096;
-    astr_buffer = fc_malloc(astr_buffer_alloc);
-    atexit(astr_buffer_free);
-  }
-
-  *alloc = astr_buffer_alloc;
-
-  return astr_buffer;
-}
-
-/************************************************************************//**
-  Grow the astring buffer.
-****************************************************************************/
-static inline char *astr_buffer_grow(size_t request, size_t *alloc)
-{
-  if (request > astr_buffer_alloc) {
-    /* We simply set buffer size to the requested one here.
-     * Old implementation went on by doubling the buffer size,
-     * presumably to match what low level memory handling does
-     * anyway. But need to increase the buffer size is so rare
-     * that we can as well call this function again, even when
-     * the increase would fall within limits of what doubling
-     * would have given us. */
-    astr_buffer_alloc = request;
-  }
-  astr_buffer = fc_realloc(astr_buffer, astr_buffer_alloc);
-
-  *alloc = astr_buffer_alloc;
-
-  return astr_buffer;
-}
-
-/************************************************************************//**
-  Free the astring buffer.
-****************************************************************************/
-static void astr_buffer_free(void)
-{
-  free(astr_buffer);
-}
 
 /************************************************************************//**
   Initialize the struct.
@@ -147,7 +93,7 @@ void astr_init(struct astring *astr)
 ****************************************************************************/
 void astr_free(struct astring *astr)
 {
-  if (astr->n_alloc > 0) {
+  if (astr->n_alloc > 0 && astr->str != astr->buf) {
     fc_assert_ret(astr->str != nullptr);
     free(astr->str);
   }
@@ -162,7 +108,15 @@ void astr_free(struct astring *astr)
 ****************************************************************************/
 char *astr_to_str(struct astring *astr)
 {
-  char *str = astr->str;
+  char *str;
+
+  if (astr->str == astr->buf) {
+    /* The string lives in the inline buffer; the caller expects heap
+     * storage they can free. */
+    str = fc_strdup(astr->str);
+  } else {
+    str = astr->str;
+  }
 
   *astr = zero_astr;
 
@@ -186,10 +140,28 @@ void astr_reserve(struct astring *astr, size_t n)
     return;
   }
 
+  if (astr->str == nullptr && n <= sizeof(astr->buf)) {
+    /* Small string; no allocation at all. */
+    astr->str = astr->buf;
+    astr->n_alloc = sizeof(astr->buf);
+    if (was_null) {
+      astr_clear(astr);
+    }
+    return;
+  }
+
   /* Allocated more if this is only a small increase on before: */
   n1 = (3 * (astr->n_alloc + 10)) / 2;
   astr->n_alloc = (n > n1) ? n : n1;
-  astr->str = (char *) fc_realloc(astr->str, astr->n_alloc);
+  if (astr->str == astr->buf) {
+    /* Graduating from the inline buffer to the heap. */
+    char *heap = fc_malloc(astr->n_alloc);
+
+    memcpy(heap, astr->buf, sizeof(astr->buf));
+    astr->str = heap;
+  } else {
+    astr->str = (char *) fc_realloc(astr->str, astr->n_alloc);
+  }
   if (was_null) {
     astr_clear(astr);
   }
@@ -214,35 +186,30 @@ void astr_clear(struct astring *astr)
 static inline void astr_vadd_at(struct astring *astr, size_t at,
                                 const char *format, va_list ap)
 {
-  char *buffer;
-  size_t buffer_size;
   size_t req_len;
   va_list copy;
 
-  fc_mutex_allocate(&astr_mutex);
-
-  buffer = astr_buffer_get(&buffer_size);
+  /* Make sure writing at 'at' stays within the allocation, then format
+   * straight into place. On the common path the result fits into the
+   * space already there and a single fc_vsnprintf() call does all the
+   * work, with no intermediate buffer to copy from. */
+  if (astr->n_alloc < at + 1) {
+    astr_reserve(astr, at + 1);
+  }
 
   va_copy(copy, ap);
 
-  req_len = fc_vsnprintf(buffer, buffer_size, format, ap);
-  if (req_len + 1 > buffer_size) {
-    buffer = astr_buffer_grow(req_len + 1, &buffer_size);
-    /* Even if buffer is *still* too small, we fill what we can */
-    req_len = fc_vsnprintf(buffer, buffer_size, format, copy);
-    if (req_len > buffer_size) {
-      /* What we actually got */
-      req_len = buffer_size;
-    }
+  req_len = fc_vsnprintf(astr->str + at, astr->n_alloc - at, format, ap);
+  if (req_len + 1 > astr->n_alloc - at) {
+    /* Truncated. Grow to the exact need (astr_reserve() still rounds up
+     * geometrically for small increases) and format again. */
+    astr_reserve(astr, at + req_len + 1);
+    req_len = fc_vsnprintf(astr->str + at, astr->n_alloc - at, format,
+                           copy);
   }
   va_end(copy);
 
-  req_len += at + 1;
-
-  astr_reserve(astr, req_len);
-  fc_strlcpy(astr->str + at, buffer, astr->n_alloc - at);
-
-  fc_mutex_release(&astr_mutex);
+  astr->n = at + req_len + 1;
 }
 
 /************************************************************************//**
@@ -392,12 +359,29 @@ void astr_copy(struct astring *dest, const struct astring *src)
   }
 }
 
+/************************************************************************//**
+  Fix up an astring after the struct itself has been moved to a new
+  address by assignment, memcpy() or realloc(). A small string lives in
+  the struct's own inline buffer, so the moved copy must re-point 'str'
+  at its new home; heap storage is unaffected by the move.
+****************************************************************************/
+void astr_rebind(struct astring *astr)
+{
+  if (astr->n_alloc == sizeof(astr->buf)) {
+    /* Only the inline buffer is ever allocated at exactly its own size;
+     * see astr_reserve(). */
+    astr->str = astr->buf;
+  }
+}
+
 /************************************************************************//**
   Initialize astr API
 ****************************************************************************/
 void fc_astr_init(void)
 {
-  fc_mutex_init(&astr_mutex);
+  /* Nothing to set up. Formatting happens in the target astring's own
+   * storage, so there is no shared buffer (or mutex guarding one)
+   * any more. */
 }
 
 /************************************************************************//**
@@ -405,5 +389,5 @@ void fc_astr_init(void)
 ****************************************************************************/
 void fc_astr_free(void)
 {
-  fc_mutex_destroy(&astr_mutex);
+  /* Nothing to tear down; see fc_astr_init(). */
 }
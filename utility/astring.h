@@ -32,16 +32,28 @@ extern "C" {
 #define str     _private_str_
 #define n       _private_n_
 #define n_alloc _private_n_alloc_
+#define buf     _private_buf_
+
+/* Number of bytes of string storage kept inline in the struct itself.
+ * Strings that never grow beyond this never touch the heap. */
+#define ASTR_INLINE_SIZE 24
 
 struct astring {
-  char *str;                    /* The string */
+  char *str;                    /* The string; points at 'buf' as long as
+                                 * the string fits there. Therefore a
+                                 * struct astring copied or moved by
+                                 * assignment/memcpy()/realloc() is
+                                 * broken until astr_rebind() has run on
+                                 * the copy; to duplicate the contents
+                                 * use astr_copy(). */
   size_t n;                     /* Size most recently requested */
   size_t n_alloc;               /* Total allocated */
+  char buf[ASTR_INLINE_SIZE];   /* Small-string storage */
 };
 
 /* Can assign this in variable declaration to initialize:
  * Notice a static astring var is exactly this already. */
-#define ASTRING_INIT { nullptr, 0, 0 }
+#define ASTRING_INIT { nullptr, 0, 0, { '\0' } }
 
 void astr_init(struct astring *astr) fc__attribute((nonnull (1)));
 void astr_free(struct astring *astr) fc__attribute((nonnull (1)));
@@ -82,6 +94,8 @@ const char *astr_build_and_list(struct astring *astr,
                                 const char *const *items, size_t number);
 void astr_copy(struct astring *dest, const struct astring *src)
      fc__attribute((nonnull (1, 2)));
+void astr_rebind(struct astring *astr)
+     fc__attribute((nonnull (1)));
 
 void fc_astr_init(void);
 void fc_astr_free(void);
@@ -130,6 +144,7 @@ static inline bool astr_empty(const struct astring *astr)
 #undef str
 #undef n
 #undef n_alloc
+#undef buf
 
 #ifdef __cplusplus
 }
@@ -190,6 +190,38 @@ bool dbv_are_equal(const struct dbv *pdbv1, const struct dbv *pdbv2)
                       _BV_BYTES(pdbv2->bits));
 }
 
+/***********************************************************************//**
+  Returns the index of the first set bit in a dynamic bitvector,
+  or -1 when no bit is set.
+***************************************************************************/
+int dbv_first_set(const struct dbv *pdbv)
+{
+  return dbv_next_set(pdbv, -1);
+}
+
+/***********************************************************************//**
+  Returns the index of the first set bit after 'prev' in a dynamic
+  bitvector, or -1 when no further bit is set. Together with
+  dbv_first_set() this allows iterating the set bits of the vector
+  without testing every bit individually.
+***************************************************************************/
+int dbv_next_set(const struct dbv *pdbv, int prev)
+{
+  int bit;
+
+  fc_assert_ret_val(pdbv->vec != nullptr, -1);
+
+  bit = bv_next_set(pdbv->vec, _BV_BYTES(pdbv->bits), prev);
+
+  /* The trailing bits of the last byte are outside the vector proper;
+   * dbv_set_all() leaves them set. */
+  if (bit >= pdbv->bits) {
+    return -1;
+  }
+
+  return bit;
+}
+
 /***********************************************************************//**
   Is content of static bitvector same as that of dynamic one.
   Comparison size is taken from the dynamic one.
@@ -261,6 +293,59 @@ void dbv_debug(struct dbv *pdbv)
   }
 }
 
+/* The functions below process the vectors a word at a time where they
+ * can, instead of byte by byte. The vectors are plain unsigned char
+ * arrays without any alignment guarantee, so words are loaded with
+ * memcpy(); compilers turn that into a single load on the architectures
+ * that matter. */
+#define BV_WORD_SIZE sizeof(unsigned long)
+
+/***********************************************************************//**
+  Load one word from an arbitrarily aligned position in a vector.
+***************************************************************************/
+static inline unsigned long bv_word_get(const unsigned char *vec)
+{
+  unsigned long word;
+
+  memcpy(&word, vec, sizeof(word));
+
+  return word;
+}
+
+#ifdef __GNUC__
+#define bv_word_popcount(word) __builtin_popcountl(word)
+#define bv_word_ctz(word) __builtin_ctzl(word)
+#else  /* __GNUC__ */
+/***********************************************************************//**
+  Count the set bits of the word.
+***************************************************************************/
+static inline int bv_word_popcount(unsigned long word)
+{
+  int count = 0;
+
+  for (; word != 0; word &= word - 1) {
+    count++;
+  }
+
+  return count;
+}
+
+/***********************************************************************//**
+  Count the trailing zero bits of the word, which must not be zero.
+***************************************************************************/
+static inline int bv_word_ctz(unsigned long word)
+{
+  int count = 0;
+
+  while ((word & 1) == 0) {
+    word >>= 1;
+    count++;
+  }
+
+  return count;
+}
+#endif /* __GNUC__ */
+
 /***********************************************************************//**
   Return whether two vectors: vec1 and vec2 have common
   bits. I.e. (vec1 & vec2) != 0.
@@ -271,16 +356,19 @@ void dbv_debug(struct dbv *pdbv)
 bool bv_check_mask(const unsigned char *vec1, const unsigned char *vec2,
                    size_t size1, size_t size2)
 {
-  size_t i;
+  size_t i = 0;
 
   fc_assert_ret_val(size1 == size2, FALSE);
 
-  for (i = 0; i < size1; i++) {
-    if ((vec1[0] & vec2[0]) != 0) {
+  for (; i + BV_WORD_SIZE <= size1; i += BV_WORD_SIZE) {
+    if ((bv_word_get(vec1 + i) & bv_word_get(vec2 + i)) != 0) {
+      return TRUE;
+    }
+  }
+  for (; i < size1; i++) {
+    if ((vec1[i] & vec2[i]) != 0) {
       return TRUE;
     }
-    vec1++;
-    vec2++;
   }
 
   return FALSE;
@@ -293,21 +381,110 @@ bool bv_check_mask(const unsigned char *vec1, const unsigned char *vec2,
 bool bv_are_equal(const unsigned char *vec1, const unsigned char *vec2,
                   size_t size1, size_t size2)
 {
-  size_t i;
+  size_t i = 0;
 
   fc_assert_ret_val(size1 == size2, FALSE);
 
-  for (i = 0; i < size1; i++) {
-    if (vec1[0] != vec2[0]) {
+  for (; i + BV_WORD_SIZE <= size1; i += BV_WORD_SIZE) {
+    if (bv_word_get(vec1 + i) != bv_word_get(vec2 + i)) {
+      return FALSE;
+    }
+  }
+  for (; i < size1; i++) {
+    if (vec1[i] != vec2[i]) {
       return FALSE;
     }
-    vec1++;
-    vec2++;
   }
 
   return TRUE;
 }
 
+/***********************************************************************//**
+  Return the number of set bits in the vector.
+
+  Don't call this function directly, use the BV_POPCOUNT macro instead.
+***************************************************************************/
+int bv_popcount(const unsigned char *vec, size_t size)
+{
+  int count = 0;
+  size_t i = 0;
+
+  for (; i + BV_WORD_SIZE <= size; i += BV_WORD_SIZE) {
+    count += bv_word_popcount(bv_word_get(vec + i));
+  }
+  for (; i < size; i++) {
+    count += bv_word_popcount(vec[i]);
+  }
+
+  return count;
+}
+
+/***********************************************************************//**
+  Return the index of the first set bit strictly after 'prev', or -1 if
+  no later bit is set. Pass -1 to start from the beginning; together with
+  bv_first_set() this allows iterating the set bits of a vector without
+  testing every bit individually:
+
+    for (i = bv_first_set(vec, size); i >= 0;
+         i = bv_next_set(vec, size, i)) { ... }
+
+  Don't call this function directly, use the BV_NEXT_SET macro instead.
+***************************************************************************/
+int bv_next_set(const unsigned char *vec, size_t size, int prev)
+{
+  int start = prev + 1;
+  size_t i;
+  unsigned char byte;
+
+  if (start < 0 || (size_t) start >= size * 8) {
+    return -1;
+  }
+
+  /* The remainder of the byte 'start' points into. */
+  i = start / 8;
+  byte = vec[i] & (0xff << (start & 0x7));
+  if (byte != 0) {
+    return i * 8 + bv_word_ctz(byte);
+  }
+  i++;
+
+#ifndef WORDS_BIGENDIAN
+  /* Scan bytes until a word boundary, then word at a time. Mapping a
+   * word's trailing zero count to a bit index relies on the bytes
+   * ending up in little-endian order within the word. */
+  for (; i < size && i % BV_WORD_SIZE != 0; i++) {
+    if (vec[i] != 0) {
+      return i * 8 + bv_word_ctz(vec[i]);
+    }
+  }
+  for (; i + BV_WORD_SIZE <= size; i += BV_WORD_SIZE) {
+    unsigned long word = bv_word_get(vec + i);
+
+    if (word != 0) {
+      return i * 8 + bv_word_ctz(word);
+    }
+  }
+#endif /* !WORDS_BIGENDIAN */
+
+  for (; i < size; i++) {
+    if (vec[i] != 0) {
+      return i * 8 + bv_word_ctz(vec[i]);
+    }
+  }
+
+  return -1;
+}
+
+/***********************************************************************//**
+  Return the index of the first set bit, or -1 for an all-clear vector.
+
+  Don't call this function directly, use the BV_FIRST_SET macro instead.
+***************************************************************************/
+int bv_first_set(const unsigned char *vec, size_t size)
+{
+  return bv_next_set(vec, size, -1);
+}
+
 /***********************************************************************//**
   Set everything that is true in vec_from in vec_to. Stuff that already is
   true in vec_to aren't touched. (Bitwise inclusive OR assignment)
@@ -321,11 +498,16 @@ void bv_set_all_from(unsigned char *vec_to,
                      const unsigned char *vec_from,
                      size_t size_to, size_t size_from)
 {
-  size_t i;
+  size_t i = 0;
 
   fc_assert_ret(size_to == size_from);
 
-  for (i = 0; i < size_to; i++) {
+  for (; i + BV_WORD_SIZE <= size_to; i += BV_WORD_SIZE) {
+    unsigned long word = bv_word_get(vec_to + i) | bv_word_get(vec_from + i);
+
+    memcpy(vec_to + i, &word, sizeof(word));
+  }
+  for (; i < size_to; i++) {
     vec_to[i] |= vec_from[i];
   }
 }
@@ -343,11 +525,43 @@ void bv_clr_all_from(unsigned char *vec_to,
                      const unsigned char *vec_from,
                      size_t size_to, size_t size_from)
 {
-  size_t i;
+  size_t i = 0;
 
   fc_assert_ret(size_to == size_from);
 
-  for (i = 0; i < size_to; i++) {
+  for (; i + BV_WORD_SIZE <= size_to; i += BV_WORD_SIZE) {
+    unsigned long word = bv_word_get(vec_to + i) & ~bv_word_get(vec_from + i);
+
+    memcpy(vec_to + i, &word, sizeof(word));
+  }
+  for (; i < size_to; i++) {
     vec_to[i] &= ~vec_from[i];
   }
 }
+
+/***********************************************************************//**
+  Clear everything that is false in vec_from in vec_to. (Bitwise AND
+  assignment)
+
+  Both vectors are expected to have same number of elements,
+  i.e. , size1 must be equal to size2.
+
+  Don't call this function directly, use BV_AND_ALL_FROM macro instead.
+***************************************************************************/
+void bv_and_all_from(unsigned char *vec_to,
+                     const unsigned char *vec_from,
+                     size_t size_to, size_t size_from)
+{
+  size_t i = 0;
+
+  fc_assert_ret(size_to == size_from);
+
+  for (; i + BV_WORD_SIZE <= size_to; i += BV_WORD_SIZE) {
+    unsigned long word = bv_word_get(vec_to + i) & bv_word_get(vec_from + i);
+
+    memcpy(vec_to + i, &word, sizeof(word));
+  }
+  for (; i < size_to; i++) {
+    vec_to[i] &= vec_from[i];
+  }
+}
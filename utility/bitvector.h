@@ -57,6 +57,11 @@ void dbv_clr_all(struct dbv *pdbv)
 
 bool dbv_are_equal(const struct dbv *pdbv1, const struct dbv *pdbv2)
   fc__attribute((nonnull (1, 2)));
+
+int dbv_first_set(const struct dbv *pdbv)
+  fc__attribute((nonnull (1)));
+int dbv_next_set(const struct dbv *pdbv, int prev)
+  fc__attribute((nonnull (1)));
 bool bv_match_dbv(const struct dbv *match, const unsigned char *src);
 void dbv_copy(struct dbv *dest, const struct dbv *src);
 
@@ -116,6 +121,14 @@ bool bv_check_mask(const unsigned char *vec1, const unsigned char *vec2,
                 sizeof((vec2).vec))
 #define BV_ISSET_ANY(vec) BV_CHECK_MASK(vec, vec)
 
+int bv_popcount(const unsigned char *vec, size_t size);
+#define BV_POPCOUNT(bv) bv_popcount((bv).vec, sizeof((bv).vec))
+
+int bv_first_set(const unsigned char *vec, size_t size);
+int bv_next_set(const unsigned char *vec, size_t size, int prev);
+#define BV_FIRST_SET(bv) bv_first_set((bv).vec, sizeof((bv).vec))
+#define BV_NEXT_SET(bv, prev) bv_next_set((bv).vec, sizeof((bv).vec), prev)
+
 bool bv_are_equal(const unsigned char *vec1, const unsigned char *vec2,
                   size_t size1, size_t size2);
 #define BV_ARE_EQUAL(vec1, vec2)                                            \
@@ -136,6 +149,13 @@ void bv_clr_all_from(unsigned char *vec_to,
   bv_clr_all_from((vec_to).vec, (vec_from).vec,                           \
                   sizeof((vec_to).vec), sizeof((vec_from).vec))
 
+void bv_and_all_from(unsigned char *vec_to,
+                     const unsigned char *vec_from,
+                     size_t size_to, size_t size_from);
+#define BV_AND_ALL_FROM(vec_to, vec_from)                                 \
+  bv_and_all_from((vec_to).vec, (vec_from).vec,                           \
+                  sizeof((vec_to).vec), sizeof((vec_from).vec))
+
 /* Used to make a BV typedef. Such types are usually called "bv_foo". */
 #define BV_DEFINE(name, bits)                                               \
   typedef struct { unsigned char vec[_BV_BYTES(bits)]; } name
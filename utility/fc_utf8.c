@@ -16,6 +16,7 @@
 #endif
 
 #include <stdarg.h>
+#include <stdint.h>
 #include <string.h>
 
 /* utility */
@@ -82,6 +83,57 @@ static const char fc_utf8_char_size[256] = {
 #define FC_UTF8_REP_CHAR "\xef\xbf\xbd" /* U+FFFD. */
 
 
+/************************************************************************//**
+  Advance over leading plain ASCII, a machine word at a time once the
+  pointer is aligned, looking at most 'byte_len' bytes ahead. Returns
+  the first byte that is NUL, non-ASCII, or past the length limit.
+  ASCII dominates the strings this module handles, so the per-character
+  validation then only runs on the tail.
+
+  The first 'byte_len' bytes must all be readable: the word loop loads
+  whole words, so a limit reaching past the allocation makes it read
+  beyond the terminator. Callers of NUL-terminated strings must pass
+  the string length, not a buffer size.
+****************************************************************************/
+static inline const char *fc_utf8_ascii_skip(const char *utf8_string,
+                                             size_t byte_len)
+{
+  const unsigned char *p = (const unsigned char *) utf8_string;
+  /* 0x0101...01 and 0x8080...80 for the word size. */
+  const unsigned long ones = (unsigned long) -1 / 0xFF;
+  const unsigned long highs = ones << 7;
+
+  /* Byte-wise until the pointer is word aligned. */
+  while (0 != (uintptr_t) p % sizeof(unsigned long)) {
+    if (0 == byte_len || '\0' == *p || 0x80 <= *p) {
+      return (const char *) p;
+    }
+    p++;
+    byte_len--;
+  }
+
+  /* Word-wise while the word holds neither a NUL, a non-ASCII byte,
+   * nor the length limit. */
+  while (sizeof(unsigned long) <= byte_len) {
+    unsigned long word;
+
+    memcpy(&word, p, sizeof(word));
+    if (0 != ((((word - ones) & ~word) | word) & highs)) {
+      break;
+    }
+    p += sizeof(word);
+    byte_len -= sizeof(word);
+  }
+
+  /* Byte-wise tail. */
+  while (0 < byte_len && '\0' != *p && 0x80 > *p) {
+    p++;
+    byte_len--;
+  }
+
+  return (const char *) p;
+}
+
 /************************************************************************//**
   Returns TRUE if the character beginning at the pointer 'utf8_char' of size
   'size' is a valid UTF-8 character.
@@ -238,8 +290,16 @@ const char *fc_utf8_find_prev_char(const char *utf8_char,
 ****************************************************************************/
 bool fc_utf8_validate(const char *utf8_string, const char **end)
 {
+  /* Bound the word-at-a-time scan by the real string length; our own
+   * word loads must never touch bytes past the terminator of a heap
+   * string, whereas the libc scan is free to. */
+  size_t byte_len = strlen(utf8_string);
+  const char *skip;
   char size;
 
+  skip = fc_utf8_ascii_skip(utf8_string, byte_len);
+  byte_len -= skip - utf8_string;
+  utf8_string = skip;
   while ('\0' != *utf8_string) {
     size = FC_UTF8_CHAR_SIZE(utf8_string);
     if (!base_fc_utf8_char_validate(utf8_string, size)) {
@@ -249,6 +309,10 @@ bool fc_utf8_validate(const char *utf8_string, const char **end)
       return FALSE;
     }
     utf8_string += size;
+    byte_len -= size;
+    skip = fc_utf8_ascii_skip(utf8_string, byte_len);
+    byte_len -= skip - utf8_string;
+    utf8_string = skip;
   }
 
   if (end != nullptr) {
@@ -270,7 +334,20 @@ bool fc_utf8_validate_len(const char *utf8_string, size_t byte_len,
                           const char **end)
 {
   unsigned char size;
+  const char *skip;
+  const char *nul;
+
+  /* Bound the word-at-a-time scan by the real string length; a NUL
+   * sitting before 'byte_len' would otherwise let it load bytes past
+   * the end of the allocation. */
+  nul = memchr(utf8_string, '\0', byte_len);
+  if (nul != nullptr) {
+    byte_len = nul - utf8_string;
+  }
 
+  skip = fc_utf8_ascii_skip(utf8_string, byte_len);
+  byte_len -= skip - utf8_string;
+  utf8_string = skip;
   while ('\0' != *utf8_string) {
     size = FC_UTF8_CHAR_SIZE(utf8_string);
 
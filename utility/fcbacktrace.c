@@ -105,6 +105,10 @@ static void backtrace_log(enum log_level level, bool print_from_where,
 
   if (level <= LOG_ERROR) {
     backtrace_print(LOG_BACKTRACE);
+    /* The backtrace lines themselves go out at LOG_BACKTRACE level and
+     * may have been queued; make sure they reach the log before the
+     * error path continues, possibly into abort(). */
+    log_async_flush();
   }
 }
 
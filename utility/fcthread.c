@@ -15,6 +15,10 @@
 #include <fc_config.h>
 #endif
 
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 /* utility */
 #include "log.h"
 #include "mem.h"
@@ -495,3 +499,384 @@ bool has_thread_cond_impl(void)
   return FALSE;
 #endif
 }
+
+/*******************************************************************//**
+  Number of CPUs available for running threads, or 1 when that cannot
+  be determined.
+***********************************************************************/
+int fc_thread_count(void)
+{
+#ifdef FREECIV_HAVE_WINTHREADS
+  SYSTEM_INFO info;
+
+  GetSystemInfo(&info);
+
+  return info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return count > 0 ? (int) count : 1;
+#else  /* No way to query the CPU count */
+  return 1;
+#endif
+}
+
+
+/* Task pools. The workers all pop from one mutex-protected queue;
+ * fc_taskpool_range() feeds it per-thread runner tasks that grab
+ * chunks of the index range dynamically, which is where the load
+ * balancing comes from. */
+
+struct fc_taskpool_task {
+  struct fc_taskpool_task *next;
+  fc_taskpool_task_fn *func;
+  void *data;
+  struct fc_taskpool_future *future;
+};
+
+struct fc_taskpool {
+  fc_mutex mutex;
+  fc_thread_cond cond;          /* Signaled when a task is queued and
+                                 * on shutdown */
+  struct fc_taskpool_task *head;
+  struct fc_taskpool_task *tail;
+  fc_thread *threads;
+  int nthreads;                 /* 0 means synchronous fallback mode */
+  bool shutdown;
+};
+
+static struct fc_taskpool *global_taskpool = nullptr;
+static int global_taskpool_size = 0;    /* 0: one thread per CPU */
+
+/*******************************************************************//**
+  Mark one task belonging to 'future' as finished, waking the waiter
+  when it was the last one.
+***********************************************************************/
+static void fc_taskpool_task_done(struct fc_taskpool_future *future)
+{
+  if (future != nullptr) {
+    fc_mutex_allocate(&future->mutex);
+    fc_assert(future->pending > 0);
+    future->pending--;
+    if (future->pending == 0) {
+      fc_thread_cond_signal(&future->cond);
+    }
+    fc_mutex_release(&future->mutex);
+  }
+}
+
+/*******************************************************************//**
+  Worker thread main loop. Pops and runs tasks until the pool shuts
+  down; the queue is drained before exiting.
+***********************************************************************/
+static void fc_taskpool_worker(void *data)
+{
+  struct fc_taskpool *tpool = data;
+
+  fc_mutex_allocate(&tpool->mutex);
+  for (;;) {
+    struct fc_taskpool_task *task;
+
+    while (tpool->head == nullptr && !tpool->shutdown) {
+      fc_thread_cond_wait(&tpool->cond, &tpool->mutex);
+    }
+    if (tpool->head == nullptr) {
+      /* Shutting down, nothing left to run. */
+      break;
+    }
+
+    task = tpool->head;
+    tpool->head = task->next;
+    if (tpool->head == nullptr) {
+      tpool->tail = nullptr;
+    }
+    fc_mutex_release(&tpool->mutex);
+
+    task->func(task->data);
+    fc_taskpool_task_done(task->future);
+    free(task);
+
+    fc_mutex_allocate(&tpool->mutex);
+  }
+  fc_mutex_release(&tpool->mutex);
+}
+
+/*******************************************************************//**
+  Create a task pool running 'threads' worker threads; pass a
+  non-positive count to get one worker per available CPU. When threads
+  cannot usefully wait for work here (single CPU, or no condition
+  variable support), the pool is created in synchronous fallback mode
+  and runs everything in the submitting thread.
+***********************************************************************/
+struct fc_taskpool *fc_taskpool_new(int threads)
+{
+  struct fc_taskpool *tpool = fc_calloc(1, sizeof(*tpool));
+  int i;
+
+  if (threads <= 0) {
+    threads = fc_thread_count();
+  }
+  if (threads <= 1 || !has_thread_cond_impl()) {
+    /* Synchronous fallback; nthreads stays 0. */
+    return tpool;
+  }
+
+  fc_mutex_init(&tpool->mutex);
+  fc_thread_cond_init(&tpool->cond);
+  tpool->threads = fc_malloc(threads * sizeof(*tpool->threads));
+
+  for (i = 0; i < threads; i++) {
+    if (fc_thread_start(&tpool->threads[i], fc_taskpool_worker,
+                        tpool) != 0) {
+      break;
+    }
+    tpool->nthreads++;
+  }
+
+  return tpool;
+}
+
+/*******************************************************************//**
+  Shut the pool down and free it. Queued tasks still run to completion
+  before the workers exit.
+***********************************************************************/
+void fc_taskpool_destroy(struct fc_taskpool *tpool)
+{
+  int i;
+
+  if (tpool == nullptr) {
+    return;
+  }
+
+  if (tpool->nthreads > 0) {
+    fc_mutex_allocate(&tpool->mutex);
+    tpool->shutdown = TRUE;
+    for (i = 0; i < tpool->nthreads; i++) {
+      fc_thread_cond_signal(&tpool->cond);
+    }
+    fc_mutex_release(&tpool->mutex);
+
+    for (i = 0; i < tpool->nthreads; i++) {
+      fc_thread_wait(&tpool->threads[i]);
+    }
+
+    fc_thread_cond_destroy(&tpool->cond);
+    fc_mutex_destroy(&tpool->mutex);
+  }
+
+  free(tpool->threads);
+  free(tpool);
+}
+
+/*******************************************************************//**
+  Number of worker threads in the pool; 0 when it runs tasks
+  synchronously.
+***********************************************************************/
+int fc_taskpool_threads(const struct fc_taskpool *tpool)
+{
+  return tpool->nthreads;
+}
+
+/*******************************************************************//**
+  Initialize a future with no tasks attached.
+***********************************************************************/
+void fc_taskpool_future_init(struct fc_taskpool_future *future)
+{
+  fc_mutex_init(&future->mutex);
+  fc_thread_cond_init(&future->cond);
+  future->pending = 0;
+}
+
+/*******************************************************************//**
+  Free future resources. Must not be called while a wait is possible.
+***********************************************************************/
+void fc_taskpool_future_destroy(struct fc_taskpool_future *future)
+{
+  fc_thread_cond_destroy(&future->cond);
+  fc_mutex_destroy(&future->mutex);
+}
+
+/*******************************************************************//**
+  Block until every task submitted against 'future' has run.
+***********************************************************************/
+void fc_taskpool_future_wait(struct fc_taskpool_future *future)
+{
+  fc_mutex_allocate(&future->mutex);
+  while (future->pending > 0) {
+    fc_thread_cond_wait(&future->cond, &future->mutex);
+  }
+  fc_mutex_release(&future->mutex);
+}
+
+/*******************************************************************//**
+  Queue 'func(data)' to run on a pool worker. A synchronous fallback
+  pool runs it before returning. Pass a future to be able to wait for
+  the task, or nullptr to fire and forget.
+***********************************************************************/
+void fc_taskpool_submit(struct fc_taskpool *tpool,
+                        fc_taskpool_task_fn *func, void *data,
+                        struct fc_taskpool_future *future)
+{
+  struct fc_taskpool_task *task;
+
+  if (future != nullptr) {
+    fc_mutex_allocate(&future->mutex);
+    future->pending++;
+    fc_mutex_release(&future->mutex);
+  }
+
+  if (tpool->nthreads == 0) {
+    func(data);
+    fc_taskpool_task_done(future);
+    return;
+  }
+
+  task = fc_malloc(sizeof(*task));
+  task->next = nullptr;
+  task->func = func;
+  task->data = data;
+  task->future = future;
+
+  fc_mutex_allocate(&tpool->mutex);
+  if (tpool->tail != nullptr) {
+    tpool->tail->next = task;
+  } else {
+    tpool->head = task;
+  }
+  tpool->tail = task;
+  fc_thread_cond_signal(&tpool->cond);
+  fc_mutex_release(&tpool->mutex);
+}
+
+struct fc_taskpool_range_state {
+  fc_mutex mutex;
+  fc_taskpool_range_fn *func;
+  void *data;
+  int next;                     /* First index not yet claimed */
+  int stop;
+  int chunk;
+};
+
+/*******************************************************************//**
+  Range worker; claims chunks of unprocessed indices until the range
+  is exhausted. Threads that drew cheap indices simply come back for
+  more, so nobody sits idle while work remains.
+***********************************************************************/
+static void fc_taskpool_range_runner(void *data)
+{
+  struct fc_taskpool_range_state *state = data;
+
+  for (;;) {
+    int begin, end;
+
+    fc_mutex_allocate(&state->mutex);
+    begin = state->next;
+    state->next += state->chunk;
+    fc_mutex_release(&state->mutex);
+
+    if (begin >= state->stop) {
+      return;
+    }
+
+    end = begin + state->chunk;
+    if (end > state->stop) {
+      end = state->stop;
+    }
+    for (; begin < end; begin++) {
+      state->func(begin, state->data);
+    }
+  }
+}
+
+/*******************************************************************//**
+  Run 'func(index, data)' for every index in [start, stop), spread
+  over the pool workers plus the calling thread. Returns only when the
+  whole range has been processed. The callback must be safe to run
+  concurrently against itself for different indices.
+***********************************************************************/
+void fc_taskpool_range(struct fc_taskpool *tpool, int start, int stop,
+                       fc_taskpool_range_fn *func, void *data)
+{
+  struct fc_taskpool_range_state state;
+  struct fc_taskpool_future future;
+  int helpers, i;
+
+  if (start >= stop) {
+    return;
+  }
+
+  if (tpool == nullptr || tpool->nthreads == 0 || stop - start == 1) {
+    for (i = start; i < stop; i++) {
+      func(i, data);
+    }
+    return;
+  }
+
+  state.func = func;
+  state.data = data;
+  state.next = start;
+  state.stop = stop;
+  /* Chunks well below an even split, so that the cheap-chunk threads
+   * keep coming back for the expensive ones' leftovers. */
+  state.chunk = (stop - start) / ((tpool->nthreads + 1) * 8);
+  if (state.chunk < 1) {
+    state.chunk = 1;
+  }
+  fc_mutex_init(&state.mutex);
+  fc_taskpool_future_init(&future);
+
+  helpers = tpool->nthreads;
+  if (helpers > stop - start - 1) {
+    helpers = stop - start - 1;
+  }
+  for (i = 0; i < helpers; i++) {
+    fc_taskpool_submit(tpool, fc_taskpool_range_runner, &state, &future);
+  }
+
+  /* The calling thread participates instead of just blocking. */
+  fc_taskpool_range_runner(&state);
+
+  fc_taskpool_future_wait(&future);
+  fc_taskpool_future_destroy(&future);
+  fc_mutex_destroy(&state.mutex);
+}
+
+/*******************************************************************//**
+  The process-wide shared pool, created on first use. Both the lazy
+  creation and fc_taskpool_global_resize() / _free() must happen from
+  the main thread.
+***********************************************************************/
+struct fc_taskpool *fc_taskpool_global(void)
+{
+  if (global_taskpool == nullptr) {
+    global_taskpool = fc_taskpool_new(global_taskpool_size);
+  }
+
+  return global_taskpool;
+}
+
+/*******************************************************************//**
+  Change the number of threads the global pool runs with; 0 means one
+  per available CPU. Takes effect on its next use.
+***********************************************************************/
+void fc_taskpool_global_resize(int threads)
+{
+  global_taskpool_size = threads;
+
+  if (global_taskpool != nullptr) {
+    /* Recreated lazily at the new size. */
+    fc_taskpool_destroy(global_taskpool);
+    global_taskpool = nullptr;
+  }
+}
+
+/*******************************************************************//**
+  Tear down the global pool, waiting for queued tasks to finish.
+***********************************************************************/
+void fc_taskpool_global_free(void)
+{
+  if (global_taskpool != nullptr) {
+    fc_taskpool_destroy(global_taskpool);
+    global_taskpool = nullptr;
+  }
+}
@@ -86,10 +86,51 @@ void fc_thread_cond_signal(fc_thread_cond *cond);
 
 bool has_thread_cond_impl(void);
 
+int fc_thread_count(void);
+
 typedef void (at_thread_exit_cb)(void);
 
 bool register_at_thread_exit_callback(at_thread_exit_cb *cb);
 
+/* Task pools. A fixed set of worker threads runs submitted tasks from
+ * a shared queue; parallel loops draw index chunks from the shared
+ * range dynamically, so an uneven workload balances itself. When no
+ * condition variable implementation is available, or the pool has been
+ * created with a single thread, everything runs synchronously in the
+ * calling thread and the API degrades to plain loops. */
+struct fc_taskpool;             /* Opaque. */
+
+typedef void (fc_taskpool_task_fn)(void *data);
+typedef void (fc_taskpool_range_fn)(int index, void *data);
+
+/* Completion handle. Initialize it, pass it to fc_taskpool_submit()
+ * for every task whose completion matters, then
+ * fc_taskpool_future_wait() blocks until all of them have run.
+ * Only the thread that submitted the tasks may wait. */
+struct fc_taskpool_future {
+  fc_mutex mutex;
+  fc_thread_cond cond;
+  int pending;
+};
+
+struct fc_taskpool *fc_taskpool_new(int threads);
+void fc_taskpool_destroy(struct fc_taskpool *tpool);
+int fc_taskpool_threads(const struct fc_taskpool *tpool);
+
+void fc_taskpool_future_init(struct fc_taskpool_future *future);
+void fc_taskpool_future_destroy(struct fc_taskpool_future *future);
+void fc_taskpool_future_wait(struct fc_taskpool_future *future);
+
+void fc_taskpool_submit(struct fc_taskpool *tpool,
+                        fc_taskpool_task_fn *func, void *data,
+                        struct fc_taskpool_future *future);
+void fc_taskpool_range(struct fc_taskpool *tpool, int start, int stop,
+                       fc_taskpool_range_fn *func, void *data);
+
+struct fc_taskpool *fc_taskpool_global(void);
+void fc_taskpool_global_resize(int threads);
+void fc_taskpool_global_free(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -50,9 +50,14 @@
    data_copy_func: same as 'key_copy_func', but for data.
    data_free_func: same as 'key_free_func', but for data.
 
-   Implementation uses open hashing. Collision resolution is done by
-   separate chaining with linked lists. Resize hash table when deemed
-   necessary by making and populating a new table.
+   Implementation uses open addressing with linear probing and entries
+   stored inline in the bucket array, so lookups touch consecutive memory
+   and insertions do not allocate. Collisions are resolved Robin Hood
+   style: an entry that probes past another entry closer to its home
+   bucket takes that bucket, which both bounds probe sequences and lets
+   lookups stop early. Deletion shifts the following displaced entries
+   backwards, so there are no tombstones. The table is resized when
+   deemed necessary by making and populating a new bucket array.
 ****************************************************************************/
 
 #ifdef HAVE_CONFIG_H
@@ -72,16 +77,12 @@
 #define FULL_RATIO 0.75         /* consider expanding when above this */
 #define MIN_RATIO 0.24          /* shrink when below this */
 
-struct genhash_entry {
-  void *key;
-  void *data;
-  genhash_val_t hash_val;
-  struct genhash_entry *next;
-};
+/* The genhash_entry layout lives in genhash.h so that the direct
+ * iteration macros can walk the bucket array inline. */
 
 /* Contents of the opaque type: */
 struct genhash {
-  struct genhash_entry **buckets;
+  struct genhash_entry *buckets;
   genhash_val_fn_t key_val_func;
   genhash_comp_fn_t key_comp_func;
   genhash_copy_fn_t key_copy_func;
@@ -95,8 +96,7 @@ struct genhash {
 
 struct genhash_iter {
   struct iterator vtable;
-  struct genhash_entry *const *bucket, *const *end;
-  const struct genhash_entry *iterator;
+  const struct genhash_entry *iterator, *end;
 };
 
 #define GENHASH_ITER(p) ((struct genhash_iter *) (p))
@@ -296,40 +296,74 @@ void genhash_destroy(struct genhash *pgenhash)
 }
 
 /************************************************************************//**
-  Resize the genhash table: relink entries.
+  Place an entry whose key is known not to be in the table yet. Takes
+  ownership of the key and data constructs. The caller must make sure the
+  table has at least one empty bucket left.
+****************************************************************************/
+static void genhash_entry_insert(struct genhash *pgenhash, void *key,
+                                 void *data, genhash_val_t hash_val)
+{
+  struct genhash_entry displaced;
+  struct genhash_entry *entry;
+  size_t pos = hash_val % pgenhash->num_buckets;
+
+  displaced.key = key;
+  displaced.data = data;
+  displaced.hash_val = hash_val;
+  displaced.probe = 1;
+
+  for (;;) {
+    entry = pgenhash->buckets + pos;
+    if (entry->probe == 0) {
+      *entry = displaced;
+      return;
+    }
+    if (entry->probe < displaced.probe) {
+      /* Robin Hood: the entry closer to its home bucket yields its
+       * bucket to the one probing from further away. */
+      struct genhash_entry tmp = *entry;
+
+      *entry = displaced;
+      displaced = tmp;
+    }
+    displaced.probe++;
+    pos++;
+    if (pos == pgenhash->num_buckets) {
+      pos = 0;
+    }
+  }
+}
+
+/************************************************************************//**
+  Resize the genhash table: relocate entries into a fresh bucket array.
 ****************************************************************************/
 static void genhash_resize_table(struct genhash *pgenhash,
                                  size_t new_nbuckets)
 {
-  struct genhash_entry **new_buckets, **bucket, **end, **slot;
-  struct genhash_entry *iter, *next;
+  struct genhash_entry *old_buckets, *entry, *end;
 
-  fc_assert(new_nbuckets >= pgenhash->num_entries);
+  fc_assert(new_nbuckets > pgenhash->num_entries);
 
-  new_buckets = fc_calloc(new_nbuckets, sizeof(*pgenhash->buckets));
+  old_buckets = pgenhash->buckets;
+  end = old_buckets + pgenhash->num_buckets;
+  pgenhash->buckets = fc_calloc(new_nbuckets, sizeof(*pgenhash->buckets));
+  pgenhash->num_buckets = new_nbuckets;
 
-  bucket = pgenhash->buckets;
-  end = bucket + pgenhash->num_buckets;
-  for (; bucket < end; bucket++) {
-    for (iter = *bucket; iter != nullptr; iter = next) {
-      slot = new_buckets + (iter->hash_val % new_nbuckets);
-      next = iter->next;
-      iter->next = *slot;
-      *slot = iter;
+  for (entry = old_buckets; entry < end; entry++) {
+    if (entry->probe != 0) {
+      genhash_entry_insert(pgenhash, entry->key, entry->data,
+                           entry->hash_val);
     }
   }
 
-  free(pgenhash->buckets);
-  pgenhash->buckets = new_buckets;
-  pgenhash->num_buckets = new_nbuckets;
+  free(old_buckets);
 }
 
 /************************************************************************//**
   Call this when an entry might be added or deleted: resizes the genhash
-  table if seems like a good idea.  Count deleted entries in check
-  because efficiency may be degraded if there are too many deleted
-  entries.  But for determining new size, ignore deleted entries,
-  since they'll be removed by rehashing.
+  table if seems like a good idea.  Keeping the load factor under
+  FULL_RATIO also guarantees that linear probe sequences stay short and
+  that there is always an empty bucket for the next insertion.
 ****************************************************************************/
 #define genhash_maybe_expand(htab) genhash_maybe_resize((htab), TRUE)
 #define genhash_maybe_shrink(htab) genhash_maybe_resize((htab), FALSE)
@@ -366,6 +400,10 @@ static bool genhash_maybe_resize(struct genhash *pgenhash, bool expandingp)
             (long unsigned) pgenhash->num_buckets,
             (long unsigned) new_nbuckets,
             expandingp ? "up": "down", (long unsigned) limit);
+  if (new_nbuckets == pgenhash->num_buckets) {
+    /* Open addressing needs no rehash to clean anything up. */
+    return FALSE;
+  }
   genhash_resize_table(pgenhash, new_nbuckets);
   return TRUE;
 }
@@ -385,33 +423,39 @@ static inline genhash_val_t genhash_val_calc(const struct genhash *pgenhash,
 }
 
 /************************************************************************//**
-  Return slot (entry pointer) in genhash table where key resides, or where
-  it should go if it is to be a new key.
+  Return the entry in the genhash table where the key resides, or nullptr
+  when the table does not contain the key.
 ****************************************************************************/
-static inline struct genhash_entry **
-genhash_slot_lookup(const struct genhash *pgenhash,
-                    const void *key,
-                    genhash_val_t hash_val)
+static inline struct genhash_entry *
+genhash_entry_lookup(const struct genhash *pgenhash,
+                     const void *key,
+                     genhash_val_t hash_val)
 {
-  struct genhash_entry **slot;
   genhash_comp_fn_t key_comp_func = pgenhash->key_comp_func;
-
-  slot = pgenhash->buckets + (hash_val % pgenhash->num_buckets);
-  if (key_comp_func != nullptr) {
-    for (; *slot != nullptr; slot = &(*slot)->next) {
-      if (hash_val == (*slot)->hash_val
-          && key_comp_func((*slot)->key, key)) {
-        return slot;
-      }
+  size_t pos = hash_val % pgenhash->num_buckets;
+  unsigned int probe = 1;
+  struct genhash_entry *entry;
+
+  for (;;) {
+    entry = pgenhash->buckets + pos;
+    if (entry->probe < probe) {
+      /* Empty bucket, or an entry closer to its home bucket than the
+       * key would be here: the Robin Hood invariant guarantees the key
+       * cannot be stored any further along the probe sequence. */
+      return nullptr;
     }
-  } else {
-    for (; *slot != nullptr; slot = &(*slot)->next) {
-      if (key == (*slot)->key) {
-        return slot;
-      }
+    if (entry->hash_val == hash_val
+        && (key_comp_func != nullptr
+            ? key_comp_func(entry->key, key)
+            : entry->key == key)) {
+      return entry;
+    }
+    probe++;
+    pos++;
+    if (pos == pgenhash->num_buckets) {
+      pos = 0;
     }
   }
-  return slot;
 }
 
 /************************************************************************//**
@@ -430,11 +474,9 @@ static inline void genhash_default_get(void **pkey, void **data)
 /************************************************************************//**
   Function to store data.
 ****************************************************************************/
-static inline void genhash_slot_get(struct genhash_entry *const *slot,
-                                    void **pkey, void **data)
+static inline void genhash_entry_get(const struct genhash_entry *entry,
+                                     void **pkey, void **data)
 {
-  const struct genhash_entry *entry = *slot;
-
   if (pkey != nullptr) {
     *pkey = entry->key;
   }
@@ -444,58 +486,69 @@ static inline void genhash_slot_get(struct genhash_entry *const *slot,
 }
 
 /************************************************************************//**
-  Create the entry and call the copy callbacks.
+  Call the copy callbacks and place the new entry into the table.
 ****************************************************************************/
-static inline void genhash_slot_create(struct genhash *pgenhash,
-                                       struct genhash_entry **slot,
-                                       const void *key, const void *data,
-                                       genhash_val_t hash_val)
+static inline void genhash_entry_create(struct genhash *pgenhash,
+                                        const void *key, const void *data,
+                                        genhash_val_t hash_val)
 {
-  struct genhash_entry *entry = fc_malloc(sizeof(*entry));
-
-  entry->key = (pgenhash->key_copy_func != nullptr
-                ? pgenhash->key_copy_func(key) : (void *) key);
-  entry->data = (pgenhash->data_copy_func != nullptr
-                 ? pgenhash->data_copy_func(data) : (void *) data);
-  entry->hash_val = hash_val;
-  entry->next = *slot;
-  *slot = entry;
+  genhash_entry_insert(pgenhash,
+                       (pgenhash->key_copy_func != nullptr
+                        ? pgenhash->key_copy_func(key) : (void *) key),
+                       (pgenhash->data_copy_func != nullptr
+                        ? pgenhash->data_copy_func(data) : (void *) data),
+                       hash_val);
 }
 
 /************************************************************************//**
-  Free the entry slot and call the free callbacks.
+  Call the free callbacks for the key and data constructs of an entry.
 ****************************************************************************/
-static inline void genhash_slot_free(struct genhash *pgenhash,
-                                     struct genhash_entry **slot)
+static inline void genhash_entry_free_contents(struct genhash *pgenhash,
+                                               struct genhash_entry *entry)
 {
-  struct genhash_entry *entry = *slot;
-
   if (pgenhash->key_free_func != nullptr) {
     pgenhash->key_free_func(entry->key);
   }
   if (pgenhash->data_free_func != nullptr) {
     pgenhash->data_free_func(entry->data);
   }
-
-  *slot = entry->next;
-  free(entry);
 }
 
 /************************************************************************//**
-  Clear previous values (with free callback) and call the copy callbacks.
+  Remove an entry from the table, shifting the following entries of its
+  probe sequence backwards so that no tombstone is left behind.
 ****************************************************************************/
-static inline void genhash_slot_set(struct genhash *pgenhash,
-                                    struct genhash_entry **slot,
-                                    const void *key, const void *data)
+static void genhash_entry_shift_delete(struct genhash *pgenhash,
+                                       struct genhash_entry *entry)
 {
-  struct genhash_entry *entry = *slot;
+  size_t pos = entry - pgenhash->buckets;
+  size_t next = pos + 1;
 
-  if (pgenhash->key_free_func != nullptr) {
-    pgenhash->key_free_func(entry->key);
-  }
-  if (pgenhash->data_free_func != nullptr) {
-    pgenhash->data_free_func(entry->data);
+  for (;;) {
+    if (next == pgenhash->num_buckets) {
+      next = 0;
+    }
+    if (pgenhash->buckets[next].probe <= 1) {
+      /* Next bucket is empty or holds an entry in its home bucket;
+       * neither may move backwards. */
+      break;
+    }
+    pgenhash->buckets[pos] = pgenhash->buckets[next];
+    pgenhash->buckets[pos].probe--;
+    pos = next;
+    next++;
   }
+  pgenhash->buckets[pos].probe = 0;
+}
+
+/************************************************************************//**
+  Clear previous values (with free callback) and call the copy callbacks.
+****************************************************************************/
+static inline void genhash_entry_set(struct genhash *pgenhash,
+                                     struct genhash_entry *entry,
+                                     const void *key, const void *data)
+{
+  genhash_entry_free_contents(pgenhash, entry);
 
   entry->key = (pgenhash->key_copy_func != nullptr
                 ? pgenhash->key_copy_func(key) : (void *) key);
@@ -533,37 +586,48 @@ size_t genhash_capacity(const struct genhash *pgenhash)
   return pgenhash->num_buckets;
 }
 
+/************************************************************************//**
+  Returns the bucket array of the genhash table, for the direct iteration
+  macros. Any modification of the table invalidates the pointer.
+****************************************************************************/
+const struct genhash_entry *genhash_buckets(const struct genhash *pgenhash)
+{
+  return pgenhash->buckets;
+}
+
 /************************************************************************//**
   Returns a newly allocated mostly deep copy of the given genhash table.
 ****************************************************************************/
 struct genhash *genhash_copy(const struct genhash *pgenhash)
 {
   struct genhash *new_genhash;
-  struct genhash_entry *const *src_bucket, *const *end;
-  const struct genhash_entry *src_iter;
-  struct genhash_entry **dest_slot, **dest_bucket;
+  struct genhash_entry *entry, *end;
 
   new_genhash = fc_malloc(sizeof(*new_genhash));
 
   /* Copy fields. */
   *new_genhash = *pgenhash;
 
-  /* But make fresh buckets. */
-  new_genhash->buckets = fc_calloc(new_genhash->num_buckets,
-                                   sizeof(*new_genhash->buckets));
-
-  /* Let's re-insert all data */
-  src_bucket = pgenhash->buckets;
-  end = src_bucket + pgenhash->num_buckets;
-  dest_bucket = new_genhash->buckets;
-
-  for (; src_bucket < end; src_bucket++, dest_bucket++) {
-    dest_slot = dest_bucket;
-    for (src_iter = *src_bucket; src_iter != nullptr;
-         src_iter = src_iter->next) {
-      genhash_slot_create(new_genhash, dest_slot, src_iter->key,
-                          src_iter->data, src_iter->hash_val);
-      dest_slot = &(*dest_slot)->next;
+  /* But make fresh buckets; the layout carries over as-is. */
+  new_genhash->buckets = fc_malloc(new_genhash->num_buckets
+                                   * sizeof(*new_genhash->buckets));
+  memcpy(new_genhash->buckets, pgenhash->buckets,
+         new_genhash->num_buckets * sizeof(*new_genhash->buckets));
+
+  /* Key and data constructs must be copied, not shared. */
+  if (new_genhash->key_copy_func != nullptr
+      || new_genhash->data_copy_func != nullptr) {
+    end = new_genhash->buckets + new_genhash->num_buckets;
+    for (entry = new_genhash->buckets; entry < end; entry++) {
+      if (entry->probe == 0) {
+        continue;
+      }
+      if (new_genhash->key_copy_func != nullptr) {
+        entry->key = new_genhash->key_copy_func(entry->key);
+      }
+      if (new_genhash->data_copy_func != nullptr) {
+        entry->data = new_genhash->data_copy_func(entry->data);
+      }
     }
   }
 
@@ -575,16 +639,21 @@ struct genhash *genhash_copy(const struct genhash *pgenhash)
 ****************************************************************************/
 void genhash_clear(struct genhash *pgenhash)
 {
-  struct genhash_entry **bucket, **end;
+  if (pgenhash->key_free_func != nullptr
+      || pgenhash->data_free_func != nullptr) {
+    struct genhash_entry *entry, *end;
 
-  bucket = pgenhash->buckets;
-  end = bucket + pgenhash->num_buckets;
-  for (; bucket < end; bucket++) {
-    while (*bucket != nullptr) {
-      genhash_slot_free(pgenhash, bucket);
+    end = pgenhash->buckets + pgenhash->num_buckets;
+    for (entry = pgenhash->buckets; entry < end; entry++) {
+      if (entry->probe != 0) {
+        genhash_entry_free_contents(pgenhash, entry);
+      }
     }
   }
 
+  memset(pgenhash->buckets, 0,
+         pgenhash->num_buckets * sizeof(*pgenhash->buckets));
+
   pgenhash->num_entries = 0;
   genhash_maybe_shrink(pgenhash);
 }
@@ -596,19 +665,14 @@ void genhash_clear(struct genhash *pgenhash)
 bool genhash_insert(struct genhash *pgenhash, const void *key,
                     const void *data)
 {
-  struct genhash_entry **slot;
   genhash_val_t hash_val;
 
   hash_val = genhash_val_calc(pgenhash, key);
-  slot = genhash_slot_lookup(pgenhash, key, hash_val);
-  if (*slot != nullptr) {
+  if (genhash_entry_lookup(pgenhash, key, hash_val) != nullptr) {
     return FALSE;
   } else {
-    if (genhash_maybe_expand(pgenhash)) {
-      /* Recalculate slot. */
-      slot = pgenhash->buckets + (hash_val % pgenhash->num_buckets);
-    }
-    genhash_slot_create(pgenhash, slot, key, data, hash_val);
+    genhash_maybe_expand(pgenhash);
+    genhash_entry_create(pgenhash, key, data, hash_val);
     pgenhash->num_entries++;
     return TRUE;
   }
@@ -638,24 +702,21 @@ bool genhash_replace_full(struct genhash *pgenhash, const void *key,
                           const void *data, void **old_pkey,
                           void **old_pdata)
 {
-  struct genhash_entry **slot;
+  struct genhash_entry *entry;
   genhash_val_t hash_val;
 
   hash_val = genhash_val_calc(pgenhash, key);
-  slot = genhash_slot_lookup(pgenhash, key, hash_val);
-  if (*slot != nullptr) {
+  entry = genhash_entry_lookup(pgenhash, key, hash_val);
+  if (entry != nullptr) {
     /* Replace. */
-    genhash_slot_get(slot, old_pkey, old_pdata);
-    genhash_slot_set(pgenhash, slot, key, data);
+    genhash_entry_get(entry, old_pkey, old_pdata);
+    genhash_entry_set(pgenhash, entry, key, data);
     return TRUE;
   } else {
     /* Insert. */
-    if (genhash_maybe_expand(pgenhash)) {
-      /* Recalculate slot. */
-      slot = pgenhash->buckets + (hash_val % pgenhash->num_buckets);
-    }
+    genhash_maybe_expand(pgenhash);
     genhash_default_get(old_pkey, old_pdata);
-    genhash_slot_create(pgenhash, slot, key, data, hash_val);
+    genhash_entry_create(pgenhash, key, data, hash_val);
     pgenhash->num_entries++;
     return FALSE;
   }
@@ -668,11 +729,12 @@ bool genhash_replace_full(struct genhash *pgenhash, const void *key,
 bool genhash_lookup(const struct genhash *pgenhash, const void *key,
                     void **pdata)
 {
-  struct genhash_entry **slot;
+  const struct genhash_entry *entry;
 
-  slot = genhash_slot_lookup(pgenhash, key, genhash_val_calc(pgenhash, key));
-  if (*slot != nullptr) {
-    genhash_slot_get(slot, nullptr, pdata);
+  entry = genhash_entry_lookup(pgenhash, key,
+                               genhash_val_calc(pgenhash, key));
+  if (entry != nullptr) {
+    genhash_entry_get(entry, nullptr, pdata);
     return TRUE;
   } else {
     genhash_default_get(nullptr, pdata);
@@ -698,17 +760,19 @@ bool genhash_remove(struct genhash *pgenhash, const void *key)
 bool genhash_remove_full(struct genhash *pgenhash, const void *key,
                          void **deleted_pkey, void **deleted_pdata)
 {
-  struct genhash_entry **slot;
+  struct genhash_entry *entry;
 
-  slot = genhash_slot_lookup(pgenhash, key, genhash_val_calc(pgenhash, key));
-  if (*slot != nullptr) {
-    genhash_slot_get(slot, deleted_pkey, deleted_pdata);
-    genhash_slot_free(pgenhash, slot);
-    genhash_maybe_shrink(pgenhash);
+  entry = genhash_entry_lookup(pgenhash, key,
+                               genhash_val_calc(pgenhash, key));
+  if (entry != nullptr) {
+    genhash_entry_get(entry, deleted_pkey, deleted_pdata);
+    genhash_entry_free_contents(pgenhash, entry);
+    genhash_entry_shift_delete(pgenhash, entry);
 
     fc_assert(0 < pgenhash->num_entries);
 
     pgenhash->num_entries--;
+    genhash_maybe_shrink(pgenhash);
     return TRUE;
   } else {
     genhash_default_get(deleted_pkey, deleted_pdata);
@@ -733,8 +797,7 @@ bool genhashes_are_equal_full(const struct genhash *pgenhash1,
                               const struct genhash *pgenhash2,
                               genhash_comp_fn_t data_comp_func)
 {
-  struct genhash_entry *const *bucket1, *const *max1, *const *slot2;
-  const struct genhash_entry *iter1;
+  const struct genhash_entry *entry1, *max1, *entry2;
 
   /* Check pointers. */
   if (pgenhash1 == pgenhash2) {
@@ -753,17 +816,18 @@ bool genhashes_are_equal_full(const struct genhash *pgenhash1,
   }
 
   /* Compare buckets. */
-  bucket1 = pgenhash1->buckets;
-  max1 = bucket1 + pgenhash1->num_buckets;
-  for (; bucket1 < max1; bucket1++) {
-    for (iter1 = *bucket1; iter1 != nullptr; iter1 = iter1->next) {
-      slot2 = genhash_slot_lookup(pgenhash2, iter1->key, iter1->hash_val);
-      if (*slot2 == nullptr
-          || (iter1->data != (*slot2)->data
-              && (data_comp_func == nullptr
-                  || !data_comp_func(iter1->data, (*slot2)->data)))) {
-        return FALSE;
-      }
+  entry1 = pgenhash1->buckets;
+  max1 = entry1 + pgenhash1->num_buckets;
+  for (; entry1 < max1; entry1++) {
+    if (entry1->probe == 0) {
+      continue;
+    }
+    entry2 = genhash_entry_lookup(pgenhash2, entry1->key, entry1->hash_val);
+    if (entry2 == nullptr
+        || (entry1->data != entry2->data
+            && (data_comp_func == nullptr
+                || !data_comp_func(entry1->data, entry2->data)))) {
+      return FALSE;
     }
   }
 
@@ -804,17 +868,9 @@ static void genhash_iter_next(struct iterator *genhash_iter)
 {
   struct genhash_iter *iter = GENHASH_ITER(genhash_iter);
 
-  iter->iterator = iter->iterator->next;
-  if (iter->iterator != nullptr) {
-    return;
-  }
-
-  for (iter->bucket++; iter->bucket < iter->end; iter->bucket++) {
-    if (*iter->bucket != nullptr) {
-      iter->iterator = *iter->bucket;
-      return;
-    }
-  }
+  do {
+    iter->iterator++;
+  } while (iter->iterator < iter->end && iter->iterator->probe == 0);
 }
 
 /************************************************************************//**
@@ -833,7 +889,7 @@ static void *genhash_iter_get(const struct iterator *genhash_iter)
 static bool genhash_iter_valid(const struct iterator *genhash_iter)
 {
   struct genhash_iter *iter = GENHASH_ITER(genhash_iter);
-  return iter->bucket < iter->end;
+  return iter->iterator < iter->end;
 }
 
 /************************************************************************//**
@@ -851,15 +907,12 @@ genhash_iter_init_common(struct genhash_iter *iter,
   iter->vtable.next = genhash_iter_next;
   iter->vtable.get = get;
   iter->vtable.valid = genhash_iter_valid;
-  iter->bucket = pgenhash->buckets;
+  iter->iterator = pgenhash->buckets;
   iter->end = pgenhash->buckets + pgenhash->num_buckets;
 
   /* Seek to the first used bucket. */
-  for (; iter->bucket < iter->end; iter->bucket++) {
-    if (*iter->bucket != nullptr) {
-      iter->iterator = *iter->bucket;
-      break;
-    }
+  while (iter->iterator < iter->end && iter->iterator->probe == 0) {
+    iter->iterator++;
   }
 
   return ITERATOR(iter);
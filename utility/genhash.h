@@ -31,6 +31,17 @@ struct genhash;                 /* opaque */
 /* Hash value type. */
 typedef unsigned int genhash_val_t;
 
+/* Layout of a bucket of the table, exposed so that the iteration macros
+ * below can walk the bucket array inline, without a function call per
+ * element. Treat entries as read-only; all modifications must go through
+ * the genhash functions. A bucket is used iff its 'probe' is non-zero. */
+struct genhash_entry {
+  void *key;
+  void *data;
+  genhash_val_t hash_val;
+  unsigned int probe;   /* Distance from the home bucket + 1; 0 = empty */
+};
+
 /* Function typedefs: */
 typedef genhash_val_t (*genhash_val_fn_t) (const void *);
 typedef bool (*genhash_comp_fn_t) (const void *, const void *);
@@ -115,6 +126,29 @@ bool genhashes_are_equal_full(const struct genhash *pgenhash1,
 
 
 /* Iteration. */
+const struct genhash_entry *genhash_buckets(const struct genhash *pgenhash)
+  fc__attribute((nonnull (1)));
+
+/* Walk the used buckets of the table directly, skipping the generic
+ * iterator interface. 'NAME_entry' names a pointer to the current entry.
+ * The table must not be modified during the iteration; an insertion or
+ * removal may relocate entries or the whole bucket array. */
+#define genhash_buckets_iterate(ARG_ht, NAME_entry)                         \
+do {                                                                        \
+  const struct genhash *MY_buckets_ht = (ARG_ht);                           \
+  if (MY_buckets_ht != nullptr) {                                           \
+    const struct genhash_entry *NAME_entry = genhash_buckets(MY_buckets_ht);\
+    const struct genhash_entry *MY_buckets_end                              \
+        = NAME_entry + genhash_capacity(MY_buckets_ht);                     \
+    for (; NAME_entry < MY_buckets_end; NAME_entry++) {                     \
+      if (NAME_entry->probe == 0) {                                         \
+        continue;                                                           \
+      }
+#define genhash_buckets_iterate_end                                         \
+    }                                                                       \
+  }                                                                         \
+} while (FALSE)
+
 struct genhash_iter;
 size_t genhash_iter_sizeof(void);
 
@@ -74,6 +74,7 @@
 /* utility */
 #include "astring.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "ioz.h"
 #include "log.h"
 #include "mem.h"
@@ -140,6 +141,10 @@ tok_tab[INF_TOK_LAST] =
 
 static bool read_a_line(struct inputfile *inf);
 
+/* Serializes '*include' resolution; the datafn commonly resolves through
+ * static buffers (fileinfoname()) that parallel parsers would trample. */
+static fc_mutex datafn_mutex;
+
 #define inf_log(inf, level, message, ...)                                   \
   if (log_do_output_for_level(level)) {                                     \
     do_log(__FILE__, __FUNCTION__, __FC_LINE__, FALSE, level, "%s",         \
@@ -148,6 +153,22 @@ static bool read_a_line(struct inputfile *inf);
 #define inf_warn(inf, message)                                              \
   inf_log(inf, LOG_NORMAL, "%s", message);
 
+/*******************************************************************//**
+  Initialize the inputfile module.
+***********************************************************************/
+void inputfile_init(void)
+{
+  fc_mutex_init(&datafn_mutex);
+}
+
+/*******************************************************************//**
+  Free resources allocated for the inputfile module.
+***********************************************************************/
+void inputfile_free(void)
+{
+  fc_mutex_destroy(&datafn_mutex);
+}
+
 /*******************************************************************//**
   Return true if c is a 'comment' character: '#' or ';'
 ***********************************************************************/
@@ -230,6 +251,38 @@ struct inputfile *inf_from_file(const char *filename,
   if (fp == nullptr) {
     return nullptr;
   }
+
+  /* Tokenizing goes over the data line by line in small steps. Doing
+   * that against the file directly would push every step through the
+   * decompressor state machine, so decompress the whole file into
+   * memory in one pass here and parse over the buffer instead. */
+  {
+    int len = 0;
+    int alloc = 64 * 1024;
+    char *buffer = fc_malloc(alloc);
+    int ret;
+
+    while ((ret = fz_fread(buffer + len, alloc - len, fp)) > 0) {
+      len += ret;
+      if (len == alloc) {
+        alloc *= 2;
+        buffer = fc_realloc(buffer, alloc);
+      }
+    }
+
+    if (ret < 0 || fz_ferror(fp) != 0) {
+      log_error("Error reading %s: %s", filename, fz_strerror(fp));
+      free(buffer);
+      fz_fclose(fp);
+
+      return nullptr;
+    }
+    fz_fclose(fp);
+
+    /* Ownership of the buffer goes to the memory stream. */
+    fp = fz_from_memory(buffer, len, TRUE);
+  }
+
   log_debug("inputfile: opened \"%s\" ok", filename);
   inf = inf_from_stream(fp, datafn);
   inf->filename = fc_strdup(filename);
@@ -431,10 +484,16 @@ static bool check_include(struct inputfile *inf)
   }
   inf->cur_line_pos = astr_len(&inf->cur_line) - 1;
 
+  /* The resolved name is only guaranteed to stay valid until the next
+   * datafn call, so hold the mutex until the included file has been
+   * opened. Parallel parsers thus serialize on resolving and opening
+   * includes, but not on tokenizing their contents. */
+  fc_mutex_allocate(&datafn_mutex);
   full_name = inf->datafn(bare_name);
   if (!full_name) {
     log_error("Could not find included file \"%s\"", bare_name);
     free(bare_name);
+    fc_mutex_release(&datafn_mutex);
     return FALSE;
   }
   free(bare_name);
@@ -446,12 +505,14 @@ static bool check_include(struct inputfile *inf)
     do {
       if (inc->filename && strcmp(full_name, inc->filename) == 0) {
         log_error("Recursion trap on '*include' for \"%s\"", full_name);
+        fc_mutex_release(&datafn_mutex);
         return FALSE;
       }
     } while ((inc = inc->included_from));
   }
 
   new_inf = inf_from_file(full_name, inf->datafn);
+  fc_mutex_release(&datafn_mutex);
 
   /* Swap things around so that memory pointed to by inf (user pointer,
      and pointer in calling functions) contains the new inputfile,
@@ -463,6 +524,16 @@ static bool check_include(struct inputfile *inf)
   *inf = temp;
   inf->included_from = new_inf;
 
+  /* The swap moved the astrings; small strings live in the struct's own
+   * inline buffer, so both copies must be re-pointed at their new
+   * homes. */
+  astr_rebind(&inf->cur_line);
+  astr_rebind(&inf->token);
+  astr_rebind(&inf->partial);
+  astr_rebind(&new_inf->cur_line);
+  astr_rebind(&new_inf->token);
+  astr_rebind(&new_inf->partial);
+
   return TRUE;
 }
 
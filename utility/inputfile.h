@@ -32,6 +32,9 @@ struct inputfile;		/* opaque */
 
 typedef const char *(*datafilename_fn_t)(const char *filename);
 
+void inputfile_init(void);
+void inputfile_free(void);
+
 struct inputfile *inf_from_file(const char *filename,
                                 datafilename_fn_t datafn);
 struct inputfile *inf_from_stream(fz_FILE * stream,
@@ -57,6 +57,7 @@
 #endif
 
 /* utility */
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "shared.h"
@@ -125,6 +126,11 @@ static void xz_action(fz_FILE *fp, lzma_action action);
 
 #define PLAIN_FILE_BUF_SIZE_ZSTD PLAIN_FILE_BUF_SIZE
 
+/* Worker threads used when writing, on top of the calling one.
+ * More than this gives diminishing returns, and we don't want
+ * a compressing server to hog every core of a big machine. */
+#define ZSTD_MAX_WRITE_WORKERS 4
+
 struct zstd_struct {
   ZSTD_DStream *dstream;
   ZSTD_CStream *cstream;
@@ -473,6 +479,21 @@ fz_FILE *fz_from_file(const char *filename, const char *in_mode,
        * we scale it a bit */
       ZSTD_initCStream(fp->u.zstd.cstream, compress_level * 2);
 
+#if defined(ZSTD_VERSION_NUMBER) && ZSTD_VERSION_NUMBER >= 10400
+      {
+        int workers = MIN(fc_thread_count() - 1, ZSTD_MAX_WRITE_WORKERS);
+
+        if (workers > 0) {
+          /* Compress in worker threads so that big files, savegames
+           * especially, don't serialize on a single core. This fails
+           * silently, leaving the normal single-threaded mode, when
+           * libzstd has been built without multithreading support. */
+          ZSTD_CCtx_setParameter(fp->u.zstd.cstream,
+                                 ZSTD_c_nbWorkers, workers);
+        }
+      }
+#endif /* ZSTD_VERSION_NUMBER >= 10400 */
+
       fp->u.zstd.in_buf.size = PLAIN_FILE_BUF_SIZE_ZSTD;
       fp->u.zstd.nonconst_in = fc_malloc(fp->u.zstd.in_buf.size);
       fp->u.zstd.in_buf.src = fp->u.zstd.nonconst_in;
@@ -900,6 +921,202 @@ char *fz_fgets(char *buffer, int size, fz_FILE *fp)
   return nullptr;
 }
 
+/************************************************************************//**
+  Read up to 'size' bytes to the buffer, like fread(). Unlike fz_fgets(),
+  the data read may contain anything; newlines and zero bytes are not
+  treated specially.
+
+  Returns number of (uncompressed) bytes actually read. A short count
+  means end-of-file; -1 means an error.
+****************************************************************************/
+int fz_fread(void *buffer, int size, fz_FILE *fp)
+{
+  fc_assert_ret_val(fp != nullptr, -1);
+
+  if (fp->memory) {
+    int len = MIN(size, fp->u.mem.size - fp->u.mem.pos);
+
+    memcpy(buffer, fp->u.mem.buffer + fp->u.mem.pos, len);
+    fp->u.mem.pos += len;
+
+    return len;
+  }
+
+  switch (fz_method_validate(fp->method)) {
+#ifdef FREECIV_HAVE_LIBLZMA
+  case FZ_XZ:
+    {
+      int i, j;
+
+      for (i = 0; i < size; i += j) {
+        size_t len = 0;
+
+        for (j = 0; fp->u.xz.out_avail > 0 && j < size - i;
+             j++, fp->u.xz.out_avail--) {
+          ((char *) buffer)[i + j] = fp->u.xz.out_buf[fp->u.xz.out_index++];
+          fp->u.xz.total_read++;
+        }
+
+        if (i + j == size) {
+          return size;
+        }
+
+        if (fp->u.xz.hack_byte_used) {
+          size_t hblen = 0;
+
+          fp->u.xz.in_buf[0] = fp->u.xz.hack_byte;
+          len = fread(fp->u.xz.in_buf + 1, 1, PLAIN_FILE_BUF_SIZE_XZ - 1,
+                      fp->u.xz.plain);
+          len++;
+
+          if (len <= 1) {
+            hblen = fread(&fp->u.xz.hack_byte, 1, 1, fp->u.xz.plain);
+          }
+          if (hblen == 0) {
+            fp->u.xz.hack_byte_used = FALSE;
+          }
+        }
+        if (len == 0) {
+          if (fp->u.xz.error == LZMA_STREAM_END) {
+            /* Plain file read complete, and xz buffers drained
+               -> end-of-file. */
+            return i + j;
+          } else {
+            fp->u.xz.stream.next_out = fp->u.xz.out_buf;
+            fp->u.xz.stream.avail_out = PLAIN_FILE_BUF_SIZE_XZ;
+            xz_action(fp, LZMA_FINISH);
+            fp->u.xz.out_index = 0;
+            fp->u.xz.out_avail =
+              fp->u.xz.stream.total_out - fp->u.xz.total_read;
+            if (fp->u.xz.error != LZMA_OK
+                && fp->u.xz.error != LZMA_STREAM_END) {
+              return -1;
+            }
+          }
+        } else {
+          lzma_action action;
+
+          fp->u.xz.stream.next_in = fp->u.xz.in_buf;
+          fp->u.xz.stream.avail_in = len;
+          fp->u.xz.stream.next_out = fp->u.xz.out_buf;
+          fp->u.xz.stream.avail_out = PLAIN_FILE_BUF_SIZE_XZ;
+          if (fp->u.xz.hack_byte_used) {
+            action = LZMA_RUN;
+          } else {
+            action = LZMA_FINISH;
+          }
+          xz_action(fp, action);
+          fp->u.xz.out_avail =
+            fp->u.xz.stream.total_out - fp->u.xz.total_read;
+          fp->u.xz.out_index = 0;
+          if (fp->u.xz.error != LZMA_OK && fp->u.xz.error != LZMA_STREAM_END) {
+            return -1;
+          }
+        }
+      }
+
+      return i;
+    }
+    break;
+#endif /* FREECIV_HAVE_LIBLZMA */
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+    {
+      int i;
+
+      for (i = 0; i < size;) {
+        int j;
+        size_t len = 0;
+
+        while (fp->u.zstd.outbuf_pos < fp->u.zstd.out_buf.pos) {
+          ((char *) buffer)[i++]
+            = ((char *)fp->u.zstd.out_buf.dst)[fp->u.zstd.outbuf_pos++];
+          if (i == size) {
+            return size;
+          }
+        }
+
+        fp->u.zstd.outbuf_pos = 0;
+
+        if (fp->u.zstd.in_buf.pos != 0) {
+          /* Move in-buffer */
+          for (j = 0; j < fp->u.zstd.in_buf.size - fp->u.zstd.in_buf.pos; j++) {
+            fp->u.zstd.nonconst_in[j] = fp->u.zstd.nonconst_in[j + fp->u.zstd.in_buf.pos];
+          }
+
+          /* Fill in-buffer from plain file */
+          len = fread(fp->u.zstd.nonconst_in + j, 1, fp->u.zstd.in_buf.size - j,
+                      fp->u.zstd.plain);
+
+          if (len + j < fp->u.zstd.in_buf.size) {
+            fp->u.zstd.in_buf.size = len + j;
+          }
+        }
+
+        fp->u.zstd.out_buf.pos = 0;
+        fp->u.zstd.in_buf.pos = 0;
+
+        fp->u.zstd.error = ZSTD_decompressStream(fp->u.zstd.dstream,
+                                                 &fp->u.zstd.out_buf,
+                                                 &fp->u.zstd.in_buf);
+        if (ZSTD_isError(fp->u.zstd.error)) {
+          /* zstd error */
+          return -1;
+        }
+
+        if (fp->u.zstd.out_buf.pos == 0 && len == 0) {
+          /* Plain file fully read, and decompression outbuffer drained. */
+          return i;
+        }
+      }
+
+      return i;
+    }
+    break;
+#endif /* FREECIV_HAVE_LIBZSTD */
+#ifdef FREECIV_HAVE_LIBBZ2
+  case FZ_BZIP2:
+    {
+      int i = 0;
+      int last_read;
+
+      /* See if first byte is already read and stored */
+      if (fp->u.bz2.firstbyte >= 0) {
+        ((char *) buffer)[0] = fp->u.bz2.firstbyte;
+        fp->u.bz2.firstbyte = -1;
+        i++;
+      }
+      if (!fp->u.bz2.eof && i < size) {
+        last_read = BZ2_bzRead(&fp->u.bz2.error, fp->u.bz2.file,
+                               (char *) buffer + i, size - i);
+        if (fp->u.bz2.error != BZ_OK
+            && fp->u.bz2.error != BZ_STREAM_END) {
+          return -1;
+        }
+        i += last_read;
+        if (fp->u.bz2.error == BZ_STREAM_END) {
+          /* EOF reached. Do not BZ2_bzRead() any more. */
+          fp->u.bz2.eof = TRUE;
+        }
+      }
+
+      return i;
+    }
+#endif /* FREECIV_HAVE_LIBBZ2 */
+#ifdef FREECIV_HAVE_LIBZ
+  case FZ_ZLIB:
+    return gzread(fp->u.zlib, buffer, size);
+#endif /* FREECIV_HAVE_LIBZ */
+  case FZ_PLAIN:
+    return fread(buffer, 1, size, fp->u.plain);
+  }
+
+  /* Should never happen */
+  fc_assert_msg(FALSE, "Internal error in %s() (method = %d)",
+                __FUNCTION__, fp->method);
+  return -1;
+}
+
 #ifdef FREECIV_HAVE_LIBLZMA
 
 /************************************************************************//**
@@ -1092,6 +1309,90 @@ int fz_fprintf(fz_FILE *fp, const char *format, ...)
   return 0;
 }
 
+/************************************************************************//**
+  Write 'size' bytes from the buffer, like fwrite(). Unlike fz_fprintf(),
+  the data may contain anything; it is not interpreted as a string.
+
+  Returns number of (uncompressed) bytes actually written, or
+  0 on error.
+****************************************************************************/
+int fz_fwrite(const void *buffer, int size, fz_FILE *fp)
+{
+  fc_assert_ret_val(fp != nullptr, 0);
+  fc_assert_ret_val(!fp->memory, 0);
+
+  switch (fz_method_validate(fp->method)) {
+#ifdef FREECIV_HAVE_LIBLZMA
+  case FZ_XZ:
+    fp->u.xz.stream.next_in = (const uint8_t *) buffer;
+    fp->u.xz.stream.avail_in = size;
+
+    if (!xz_outbuffer_to_file(fp, LZMA_RUN)) {
+      return 0;
+    } else {
+      return size;
+    }
+    break;
+#endif /* FREECIV_HAVE_LIBLZMA */
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+    {
+      ZSTD_inBuffer in_buf;
+
+      in_buf.src = buffer;
+      in_buf.size = size;
+      in_buf.pos = 0;
+
+      while (in_buf.pos < in_buf.size) {
+        int len;
+
+        fp->u.zstd.error = ZSTD_compressStream(fp->u.zstd.cstream,
+                                               &fp->u.zstd.out_buf,
+                                               &in_buf);
+        if (ZSTD_isError(fp->u.zstd.error)) {
+          return 0;
+        }
+
+        if (fp->u.zstd.out_buf.pos > 0) {
+          len = fwrite(fp->u.zstd.out_buf.dst, 1,
+                       fp->u.zstd.out_buf.pos, fp->u.zstd.plain);
+
+          if (len < 0) {
+            return 0;
+          }
+
+          fp->u.zstd.out_buf.pos = 0;
+        }
+      }
+
+      return size;
+    }
+    break;
+#endif /* FREECIV_HAVE_LIBZSTD */
+#ifdef FREECIV_HAVE_LIBBZ2
+  case FZ_BZIP2:
+    BZ2_bzWrite(&fp->u.bz2.error, fp->u.bz2.file,
+                (void *) buffer, size);
+    if (fp->u.bz2.error != BZ_OK) {
+      return 0;
+    } else {
+      return size;
+    }
+#endif /* FREECIV_HAVE_LIBBZ2 */
+#ifdef FREECIV_HAVE_LIBZ
+  case FZ_ZLIB:
+    return gzwrite(fp->u.zlib, buffer, (unsigned int) size);
+#endif /* FREECIV_HAVE_LIBZ */
+  case FZ_PLAIN:
+    return fwrite(buffer, 1, size, fp->u.plain);
+  }
+
+  /* Should never happen */
+  fc_assert_msg(FALSE, "Internal error in %s() (method = %d)",
+                __FUNCTION__, fp->method);
+  return 0;
+}
+
 /************************************************************************//**
   Return non-zero if there is an error status associated with
   this stream. Check fz_strerror() for details.
@@ -58,8 +58,10 @@ fz_FILE *fz_from_stream(FILE *stream);
 fz_FILE *fz_from_memory(char *buffer, int size, bool control);
 int fz_fclose(fz_FILE *fp);
 char *fz_fgets(char *buffer, int size, fz_FILE *fp);
+int fz_fread(void *buffer, int size, fz_FILE *fp);
 int fz_fprintf(fz_FILE *fp, const char *format, ...)
   fc__attribute((__format__ (__printf__, 2, 3)));
+int fz_fwrite(const void *buffer, int size, fz_FILE *fp);
 
 int fz_ferror(fz_FILE *fp);
 const char *fz_strerror(fz_FILE *fp);
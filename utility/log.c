@@ -32,9 +32,13 @@
 #include "log.h"
 
 static void log_write(FILE *fs, enum log_level level, bool print_from_where,
-                      const char *where, const char *message);
+                      const char *where, const char *prefix,
+                      const char *message);
 static void log_real(enum log_level level, bool print_from_where,
                      const char *where, const char *msg);
+static void log_real_write(enum log_level level, bool print_from_where,
+                           const char *where, const char *msg,
+                           const char *prefix);
 
 static char *log_filename = nullptr;
 static log_pre_callback_fn log_pre_callback = log_real;
@@ -43,6 +47,33 @@ static log_prefix_fn log_prefix = nullptr;
 
 static fc_mutex logfile_mutex;
 
+/* Asynchronous mode: messages below LOG_ERROR severity are queued on a
+ * ring and written by a logger thread, so the hot path never touches
+ * the log file (which is opened, written and flushed per message).
+ * Errors and fatals drain the queue and then write synchronously on
+ * the calling thread, both to survive a following crash and because
+ * the server's log callback touches connections for them. The prefix
+ * (the timestamp, in the server) is captured at enqueue time. */
+#define LOG_ASYNC_QUEUE_LEN 1024
+
+struct log_async_entry {
+  enum log_level level;
+  bool print_from_where;
+  char *where;
+  char *msg;
+  char *prefix;                 /* nullptr when no prefix callback */
+};
+
+static struct log_async_entry log_async_ring[LOG_ASYNC_QUEUE_LEN];
+static int log_async_head = 0;  /* Next entry to write out */
+static int log_async_len = 0;   /* Queued entries */
+static unsigned int log_async_dropped = 0;
+static bool log_async_on = FALSE;
+static bool log_async_stopping = FALSE;
+static fc_mutex log_async_mutex;
+static fc_thread_cond log_async_cond;
+static fc_thread log_async_thread;
+
 #ifdef FREECIV_DEBUG
 static const enum log_level max_level = LOG_DEBUG;
 #else
@@ -269,6 +300,7 @@ void log_init(const char *filename, enum log_level initial_level,
 **************************************************************************/
 void log_close(void)
 {
+  log_async_set(FALSE);
   fc_mutex_destroy(&logfile_mutex);
 }
 
@@ -364,22 +396,26 @@ bool log_do_output_for_level_at_location(enum log_level level,
   Let the callback do its own level formatting and add a '\n' if it wants.
 **************************************************************************/
 static void log_write(FILE *fs, enum log_level level, bool print_from_where,
-                      const char *where, const char *message)
+                      const char *where, const char *prefix,
+                      const char *message)
 {
   if (log_filename || (!log_callback)) {
-    char prefix[128];
+    char prefix_buf[128];
 
-    if (log_prefix) {
+    if (prefix != nullptr) {
+      /* Prefix captured when the message was queued. */
+      fc_snprintf(prefix_buf, sizeof(prefix_buf), "[%s] ", prefix);
+    } else if (log_prefix) {
       /* Get the log prefix. */
-      fc_snprintf(prefix, sizeof(prefix), "[%s] ", log_prefix());
+      fc_snprintf(prefix_buf, sizeof(prefix_buf), "[%s] ", log_prefix());
     } else {
-      prefix[0] = '\0';
+      prefix_buf[0] = '\0';
     }
 
     if (log_filename || (print_from_where && where)) {
-      fc_fprintf(fs, "%d: %s%s%s\n", level, prefix, where, message);
+      fc_fprintf(fs, "%d: %s%s%s\n", level, prefix_buf, where, message);
     } else {
-      fc_fprintf(fs, "%d: %s%s\n", level, prefix, message);
+      fc_fprintf(fs, "%d: %s%s\n", level, prefix_buf, message);
     }
     fflush(fs);
   }
@@ -426,9 +462,12 @@ void vdo_log(const char *file, const char *function, int line,
   For repeat message, may wait and print instead "last message repeated ..."
   at some later time.
   Calls log_callback if not nullptr, else prints to stderr.
+  'prefix' is a prefix string captured earlier, or nullptr to evaluate
+  the prefix callback now.
 **************************************************************************/
-static void log_real(enum log_level level, bool print_from_where,
-                     const char *where, const char *msg)
+static void log_real_write(enum log_level level, bool print_from_where,
+                           const char *where, const char *msg,
+                           const char *prefix)
 {
   static char last_msg[MAX_LEN_LOG_LINE] = "";
   static unsigned int repeated = 0; /* Total times current message repeated */
@@ -466,7 +505,7 @@ static void log_real(enum log_level level, bool print_from_where,
                          " (total %d repeats)",
                          repeated), repeated);
       }
-      log_write(fs, prev_level, print_from_where, where, buf);
+      log_write(fs, prev_level, print_from_where, where, prefix, buf);
       prev = repeated;
       next *= 2;
     }
@@ -474,7 +513,7 @@ static void log_real(enum log_level level, bool print_from_where,
     if (repeated > 0 && repeated != prev) {
       if (repeated == 1) {
         /* just repeat the previous message: */
-        log_write(fs, prev_level, print_from_where, where, last_msg);
+        log_write(fs, prev_level, print_from_where, where, prefix, last_msg);
       } else {
         fc_snprintf(buf, sizeof(buf),
                     PL_("last message repeated %d time",
@@ -485,14 +524,14 @@ static void log_real(enum log_level level, bool print_from_where,
                        PL_(" (total %d repeat)", " (total %d repeats)",
                            repeated),  repeated);
         }
-        log_write(fs, prev_level, print_from_where, where, buf);
+        log_write(fs, prev_level, print_from_where, where, prefix, buf);
       }
     }
     prev_level = level;
     repeated = 0;
     next = 2;
     prev = 0;
-    log_write(fs, level, print_from_where, where, msg);
+    log_write(fs, level, print_from_where, where, prefix, msg);
   }
   /* Save last message. */
   sz_strlcpy(last_msg, msg);
@@ -504,6 +543,186 @@ static void log_real(enum log_level level, bool print_from_where,
   }
 }
 
+/**********************************************************************//**
+  Release the strings of an async queue entry.
+**************************************************************************/
+static void log_async_entry_free(struct log_async_entry *entry)
+{
+  free(entry->where);
+  free(entry->msg);
+  free(entry->prefix);
+  entry->where = nullptr;
+  entry->msg = nullptr;
+  entry->prefix = nullptr;
+}
+
+/**********************************************************************//**
+  Pop the oldest queued entry into *entry, write it out and free it.
+  Call with log_async_mutex held; it is released around the write and
+  held again on return.
+**************************************************************************/
+static void log_async_write_one(void)
+{
+  struct log_async_entry entry = log_async_ring[log_async_head];
+  unsigned int dropped = 0;
+
+  log_async_head = (log_async_head + 1) % LOG_ASYNC_QUEUE_LEN;
+  log_async_len--;
+  if (log_async_len == 0 && log_async_dropped > 0) {
+    dropped = log_async_dropped;
+    log_async_dropped = 0;
+  }
+  fc_mutex_release(&log_async_mutex);
+
+  log_real_write(entry.level, entry.print_from_where, entry.where,
+                 entry.msg, entry.prefix);
+  log_async_entry_free(&entry);
+
+  if (dropped > 0) {
+    char buf[128];
+
+    fc_snprintf(buf, sizeof(buf),
+                PL_("async log queue overflowed, %u message lost",
+                    "async log queue overflowed, %u messages lost",
+                    dropped), dropped);
+    log_real_write(LOG_WARN, FALSE, nullptr, buf, nullptr);
+  }
+
+  fc_mutex_allocate(&log_async_mutex);
+}
+
+/**********************************************************************//**
+  Logger thread main loop: write out queued messages until the queue
+  is drained at shutdown.
+**************************************************************************/
+static void log_async_run(void *data)
+{
+  fc_mutex_allocate(&log_async_mutex);
+  for (;;) {
+    while (log_async_len == 0 && !log_async_stopping) {
+      fc_thread_cond_wait(&log_async_cond, &log_async_mutex);
+    }
+    if (log_async_len == 0) {
+      break;
+    }
+    log_async_write_one();
+  }
+  fc_mutex_release(&log_async_mutex);
+}
+
+/**********************************************************************//**
+  Queue one message for the logger thread.
+**************************************************************************/
+static void log_async_enqueue(enum log_level level, bool print_from_where,
+                              const char *where, const char *msg)
+{
+  fc_mutex_allocate(&log_async_mutex);
+  if (log_async_len >= LOG_ASYNC_QUEUE_LEN) {
+    /* Never block the game on logging; account for the loss instead. */
+    log_async_dropped++;
+  } else {
+    struct log_async_entry *entry
+      = &log_async_ring[(log_async_head + log_async_len)
+                        % LOG_ASYNC_QUEUE_LEN];
+
+    entry->level = level;
+    entry->print_from_where = print_from_where;
+    entry->where = (where != nullptr ? fc_strdup(where) : nullptr);
+    entry->msg = fc_strdup(msg);
+    entry->prefix = (log_prefix != nullptr
+                     ? fc_strdup(log_prefix()) : nullptr);
+    log_async_len++;
+    fc_thread_cond_signal(&log_async_cond);
+  }
+  fc_mutex_release(&log_async_mutex);
+}
+
+/**********************************************************************//**
+  Write out everything queued so far before returning. Used on the
+  error paths so that whatever happens next, the queued history is on
+  disk, and by log_async_set() when turning the mode off.
+**************************************************************************/
+void log_async_flush(void)
+{
+  if (!log_async_on) {
+    return;
+  }
+
+  fc_mutex_allocate(&log_async_mutex);
+  while (log_async_len > 0) {
+    log_async_write_one();
+  }
+  fc_mutex_release(&log_async_mutex);
+}
+
+/**********************************************************************//**
+  Turn asynchronous logging on or off. Enabling requires thread
+  condition variable support; without it logging simply stays
+  synchronous. Disabling drains the queue. Toggle from the main thread
+  only.
+**************************************************************************/
+void log_async_set(bool enable)
+{
+  if (enable == log_async_on) {
+    return;
+  }
+
+  if (enable) {
+    if (!has_thread_cond_impl()) {
+      return;
+    }
+    log_async_head = 0;
+    log_async_len = 0;
+    log_async_dropped = 0;
+    log_async_stopping = FALSE;
+    fc_mutex_init(&log_async_mutex);
+    fc_thread_cond_init(&log_async_cond);
+    if (fc_thread_start(&log_async_thread, log_async_run, nullptr) != 0) {
+      fc_thread_cond_destroy(&log_async_cond);
+      fc_mutex_destroy(&log_async_mutex);
+      return;
+    }
+    log_async_on = TRUE;
+  } else {
+    /* New messages go back to the synchronous path at once; then stop
+     * the logger thread, which drains the queue before exiting. */
+    log_async_on = FALSE;
+    fc_mutex_allocate(&log_async_mutex);
+    log_async_stopping = TRUE;
+    fc_thread_cond_signal(&log_async_cond);
+    fc_mutex_release(&log_async_mutex);
+    fc_thread_wait(&log_async_thread);
+    fc_thread_cond_destroy(&log_async_cond);
+    fc_mutex_destroy(&log_async_mutex);
+  }
+}
+
+/**********************************************************************//**
+  Whether asynchronous logging is active.
+**************************************************************************/
+bool log_async_get(void)
+{
+  return log_async_on;
+}
+
+/**********************************************************************//**
+  Hand the message to the logger thread, or write it synchronously.
+  Errors and fatals always go out synchronously, after the queued
+  backlog, so they are on disk even if the process dies right after.
+**************************************************************************/
+static void log_real(enum log_level level, bool print_from_where,
+                     const char *where, const char *msg)
+{
+  if (log_async_on) {
+    if (level > LOG_ERROR) {
+      log_async_enqueue(level, print_from_where, where, msg);
+      return;
+    }
+    log_async_flush();
+  }
+  log_real_write(level, print_from_where, where, msg, nullptr);
+}
+
 /**********************************************************************//**
   Unconditionally print a log message. This function is usually protected
   by do_log_for().
@@ -26,11 +26,193 @@
 
 /* utility */
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "shared.h"             /* TRUE, FALSE */
 
 #include "mem.h"
 
+/* Tagged allocation accounting for the /memstats command. While off
+ * (the default) each allocation pays one branch on a bool; while on,
+ * every fc_malloc()/fc_realloc()/fc_calloc()/fc_strdup() call is
+ * attributed to a subsystem by the name of the allocating file and
+ * counted under a mutex, since some subsystems allocate from worker
+ * threads. Frees are not tracked - plain free() carries neither size
+ * nor origin - so the counters are cumulative allocation traffic with
+ * a snapshot at each turn change for per-turn deltas, not live bytes. */
+
+enum mem_stat_tag {
+  MEM_TAG_PATHFINDING,
+  MEM_TAG_DELTA,
+  MEM_TAG_LUA,
+  MEM_TAG_SAVEGAME,
+  MEM_TAG_NETWORK,
+  MEM_TAG_MAP,
+  MEM_TAG_UNITS,
+  MEM_TAG_CITIES,
+  MEM_TAG_AI,
+  MEM_TAG_OTHER,
+
+  MEM_TAG_LAST
+};
+
+static const char *mem_tag_names[MEM_TAG_LAST] = {
+  "pathfinding", "delta", "lua", "savegame", "network",
+  "map", "units", "cities", "ai", "other"
+};
+
+static bool mem_stats_on = FALSE;
+static bool mem_stats_lock_ready = FALSE;
+static fc_mutex mem_stats_lock;
+
+static struct {
+  size_t bytes;
+  size_t allocs;
+  size_t turn_bytes;            /* Snapshot at the last turn change */
+  size_t turn_allocs;
+} mem_stats[MEM_TAG_LAST];
+
+/******************************************************************//**
+  Attribute the allocating file to a subsystem tag. The file is the
+  __FILE__ of the fc_malloc() call site, so generic containers count
+  towards whoever compiled them in, i.e. usually "other".
+**********************************************************************/
+static enum mem_stat_tag mem_stats_classify(const char *file)
+{
+  if (strstr(file, "path_finding") != NULL
+      || strstr(file, "pf_") != NULL) {
+    return MEM_TAG_PATHFINDING;
+  }
+  if (strstr(file, "packets") != NULL) {
+    return MEM_TAG_DELTA;
+  }
+  if (strstr(file, "lua") != NULL || strstr(file, "script") != NULL) {
+    return MEM_TAG_LUA;
+  }
+  if (strstr(file, "savegame") != NULL
+      || strstr(file, "registry") != NULL) {
+    return MEM_TAG_SAVEGAME;
+  }
+  if (strstr(file, "netintf") != NULL || strstr(file, "netfile") != NULL
+      || strstr(file, "sernet") != NULL || strstr(file, "dataio") != NULL
+      || strstr(file, "connection") != NULL) {
+    return MEM_TAG_NETWORK;
+  }
+  if (strstr(file, "map") != NULL || strstr(file, "tile") != NULL) {
+    return MEM_TAG_MAP;
+  }
+  if (strstr(file, "unit") != NULL) {
+    return MEM_TAG_UNITS;
+  }
+  if (strstr(file, "city") != NULL || strstr(file, "citizens") != NULL) {
+    return MEM_TAG_CITIES;
+  }
+  if (strstr(file, "dai") != NULL || strstr(file, "adv") != NULL
+      || strstr(file, "ai") != NULL) {
+    return MEM_TAG_AI;
+  }
+
+  return MEM_TAG_OTHER;
+}
+
+/******************************************************************//**
+  Count one successful allocation against its subsystem.
+**********************************************************************/
+static void mem_stats_count(size_t size, const char *file)
+{
+  enum mem_stat_tag tag = mem_stats_classify(file);
+
+  fc_mutex_allocate(&mem_stats_lock);
+  mem_stats[tag].bytes += size;
+  mem_stats[tag].allocs++;
+  fc_mutex_release(&mem_stats_lock);
+}
+
+/******************************************************************//**
+  Switch the tagged allocation accounting on or off. Enabling resets
+  the counters.
+**********************************************************************/
+void mem_stats_enable(bool enable)
+{
+  if (!mem_stats_lock_ready) {
+    fc_mutex_init(&mem_stats_lock);
+    mem_stats_lock_ready = TRUE;
+  }
+
+  if (enable && !mem_stats_on) {
+    mem_stats_clear();
+  }
+  mem_stats_on = enable;
+}
+
+/******************************************************************//**
+  Whether the tagged allocation accounting is currently on.
+**********************************************************************/
+bool mem_stats_enabled(void)
+{
+  return mem_stats_on;
+}
+
+/******************************************************************//**
+  Reset all the counters.
+**********************************************************************/
+void mem_stats_clear(void)
+{
+  if (mem_stats_lock_ready) {
+    fc_mutex_allocate(&mem_stats_lock);
+  }
+  memset(mem_stats, 0, sizeof(mem_stats));
+  if (mem_stats_lock_ready) {
+    fc_mutex_release(&mem_stats_lock);
+  }
+}
+
+/******************************************************************//**
+  Close the current per-turn interval: the report's turn deltas count
+  from the last call. Called at each turn change.
+**********************************************************************/
+void mem_stats_turn(void)
+{
+  int i;
+
+  if (!mem_stats_on) {
+    return;
+  }
+
+  fc_mutex_allocate(&mem_stats_lock);
+  for (i = 0; i < MEM_TAG_LAST; i++) {
+    mem_stats[i].turn_bytes = mem_stats[i].bytes;
+    mem_stats[i].turn_allocs = mem_stats[i].allocs;
+  }
+  fc_mutex_release(&mem_stats_lock);
+}
+
+/******************************************************************//**
+  Call the callback once per tag with the accumulated totals and the
+  growth since the last turn change.
+**********************************************************************/
+void mem_stats_report(mem_stats_cb cb, void *data)
+{
+  int i;
+
+  for (i = 0; i < MEM_TAG_LAST; i++) {
+    size_t bytes, allocs, turn_bytes, turn_allocs;
+
+    if (mem_stats_lock_ready) {
+      fc_mutex_allocate(&mem_stats_lock);
+    }
+    bytes = mem_stats[i].bytes;
+    allocs = mem_stats[i].allocs;
+    turn_bytes = bytes - mem_stats[i].turn_bytes;
+    turn_allocs = allocs - mem_stats[i].turn_allocs;
+    if (mem_stats_lock_ready) {
+      fc_mutex_release(&mem_stats_lock);
+    }
+
+    cb(mem_tag_names[i], bytes, allocs, turn_bytes, turn_allocs, data);
+  }
+}
+
 /******************************************************************//**
   Do whatever we should do when fc_malloc() fails.
   At the moment this just prints a log message and calls exit(EXIT_FAILURE)
@@ -91,6 +273,10 @@ void *fc_real_malloc(size_t size,
     handle_alloc_failure(size, called_as, line, file);
   }
 
+  if (mem_stats_on) {
+    mem_stats_count(size, file);
+  }
+
   return ptr;
 }
 
@@ -116,6 +302,11 @@ void *fc_real_realloc(void *ptr, size_t size,
     handle_alloc_failure(size, called_as, line, file);
   }
 
+  /* Counted at the new size; the old block's size is unknown here. */
+  if (mem_stats_on) {
+    mem_stats_count(size, file);
+  }
+
   return new_ptr;
 }
 
@@ -155,3 +346,158 @@ char *real_fc_strdup(const char *str,
 
   return dest;
 }
+
+/**********************************************************************
+  Arena allocator.
+**********************************************************************/
+
+/* Every allocation is rounded up to this alignment, which must suffice
+ * for any object type. */
+union arena_align {
+  long l;
+  double d;
+  void *p;
+};
+
+#define ARENA_ALIGN sizeof(union arena_align)
+
+struct arena_block {
+  struct arena_block *next;
+  size_t size;                  /* Usable bytes in data[] */
+  size_t used;
+  union arena_align data[1];    /* Actually 'size' bytes */
+};
+
+struct fc_arena {
+  struct arena_block *blocks;   /* Block currently allocated from first */
+  size_t block_size;            /* Default size of a new block */
+};
+
+/******************************************************************//**
+  Allocate a fresh block of at least 'size' usable bytes and push it in
+  front of the arena's block chain.
+**********************************************************************/
+static struct arena_block *arena_block_new(struct fc_arena *arena,
+                                           size_t size)
+{
+  struct arena_block *block;
+
+  size = MAX(size, arena->block_size);
+  block = fc_malloc(sizeof(*block) - sizeof(block->data) + size);
+  block->next = arena->blocks;
+  block->size = size;
+  block->used = 0;
+  arena->blocks = block;
+
+  return block;
+}
+
+/******************************************************************//**
+  Create an arena that allocates its memory in blocks of 'block_size'
+  bytes, or of a default size if 'block_size' is zero. Allocations
+  larger than the block size get a block of their own.
+**********************************************************************/
+struct fc_arena *fc_arena_create(size_t block_size)
+{
+  struct fc_arena *arena = fc_malloc(sizeof(*arena));
+
+  arena->blocks = nullptr;
+  arena->block_size = (block_size != 0 ? block_size : 64 * 1024);
+
+  return arena;
+}
+
+/******************************************************************//**
+  Free the arena and every allocation made from it.
+**********************************************************************/
+void fc_arena_destroy(struct fc_arena *arena)
+{
+  struct arena_block *block, *next;
+
+  if (arena == nullptr) {
+    return;
+  }
+
+  for (block = arena->blocks; block != nullptr; block = next) {
+    next = block->next;
+    free(block);
+  }
+  free(arena);
+}
+
+/******************************************************************//**
+  Allocate 'size' bytes from the arena. The memory cannot be freed
+  individually; it is released by fc_arena_reset() or
+  fc_arena_destroy(). Never returns nullptr.
+**********************************************************************/
+void *fc_arena_alloc(struct fc_arena *arena, size_t size)
+{
+  struct arena_block *block = arena->blocks;
+  void *ptr;
+
+  size = ((size + ARENA_ALIGN - 1) / ARENA_ALIGN) * ARENA_ALIGN;
+  size = MAX(size, ARENA_ALIGN);
+
+  if (block == nullptr || block->size - block->used < size) {
+    block = arena_block_new(arena, size);
+  }
+
+  ptr = (char *) block->data + block->used;
+  block->used += size;
+
+  return ptr;
+}
+
+/******************************************************************//**
+  As fc_arena_alloc(), but zeroes the memory, calloc() style.
+**********************************************************************/
+void *fc_arena_calloc(struct fc_arena *arena, size_t nelem, size_t elsize)
+{
+  size_t size = nelem * elsize; /* Potential overflow, as fc_calloc() */
+  void *ptr = fc_arena_alloc(arena, size);
+
+  memset(ptr, 0, size);
+
+  return ptr;
+}
+
+/******************************************************************//**
+  Copy the string into memory allocated from the arena.
+**********************************************************************/
+char *fc_arena_strdup(struct fc_arena *arena, const char *str)
+{
+  size_t size = strlen(str) + 1;
+  char *dest = fc_arena_alloc(arena, size);
+
+  memcpy(dest, str, size);
+
+  return dest;
+}
+
+/******************************************************************//**
+  Release every allocation made from the arena at once. The largest
+  block is kept for reuse so that a steady-state arena stops touching
+  malloc() altogether.
+**********************************************************************/
+void fc_arena_reset(struct fc_arena *arena)
+{
+  struct arena_block *block, *next, *keep = nullptr;
+
+  for (block = arena->blocks; block != nullptr; block = next) {
+    next = block->next;
+    if (keep == nullptr || block->size > keep->size) {
+      if (keep != nullptr) {
+        free(keep);
+      }
+      keep = block;
+    } else {
+      free(block);
+    }
+  }
+
+  if (keep != nullptr) {
+    keep->next = nullptr;
+    keep->used = 0;
+  }
+  arena->blocks = keep;
+}
@@ -61,6 +61,46 @@ char *real_fc_strdup(const char *str,
                      const char *called_as, int line, const char *file)
                      fc__warn_unused_result;
 
+/***********************************************************************/
+
+/* Tagged allocation accounting, driven by the /memstats command.
+ * When enabled, every allocation made through the macros above is
+ * attributed to a coarse subsystem tag ("map", "units", "lua", ...)
+ * derived from the allocating file, and counted. Frees cannot be
+ * attributed (free() carries neither size nor origin), so the numbers
+ * are cumulative allocation traffic, with per-turn deltas measured
+ * against a snapshot taken at each turn change. */
+
+typedef void (*mem_stats_cb)(const char *tag, size_t bytes, size_t allocs,
+                             size_t turn_bytes, size_t turn_allocs,
+                             void *data);
+
+void mem_stats_enable(bool enable);
+bool mem_stats_enabled(void);
+void mem_stats_clear(void);
+void mem_stats_turn(void);
+void mem_stats_report(mem_stats_cb cb, void *data);
+
+/***********************************************************************/
+
+/* Arena allocator: a chain of large blocks handed out as a bump pointer.
+ * Individual allocations cannot be freed; fc_arena_reset() releases them
+ * all at once in O(1) per block. Intended for masses of short-lived
+ * allocations with a common lifetime, such as per-phase scratch on the
+ * server - see server_phase_arena(). Allocation failure is handled like
+ * fc_malloc() failure, so the return value needs no checking. */
+
+struct fc_arena;        /* Opaque. */
+
+struct fc_arena *fc_arena_create(size_t block_size) fc__warn_unused_result;
+void fc_arena_destroy(struct fc_arena *arena);
+
+void *fc_arena_alloc(struct fc_arena *arena, size_t size);
+void *fc_arena_calloc(struct fc_arena *arena, size_t nelem, size_t elsize);
+char *fc_arena_strdup(struct fc_arena *arena, const char *str);
+
+void fc_arena_reset(struct fc_arena *arena);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
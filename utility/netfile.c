@@ -67,6 +67,10 @@ static CURL *netfile_init_handle(void)
   error_buf_curl[0] = '\0';
   curl_easy_setopt(chandle, CURLOPT_ERRORBUFFER, error_buf_curl);
 
+  /* Both the client and the server perform transfers from worker
+   * threads; signal-based resolver timeouts are not thread safe. */
+  curl_easy_setopt(chandle, CURLOPT_NOSIGNAL, (long)1);
+
 #ifdef CUSTOM_CACERT_PATH
   curl_easy_setopt(chandle, CURLOPT_CAINFO, CUSTOM_CACERT_PATH);
 #endif /* CUSTOM_CERT_PATH */
@@ -142,6 +146,163 @@ static bool netfile_download_file_core(const char *URL, FILE *fp,
   return ret;
 }
 
+/* A netfile_conn wraps a private curl handle, so several transfers can
+ * run concurrently from worker threads, one conn per thread. The plain
+ * download functions share one static handle and may only be used from
+ * a single thread at a time. */
+struct netfile_conn {
+  CURL *handle;
+  char error_buf[CURL_ERROR_SIZE];
+};
+
+/*******************************************************************//**
+  Open a private download connection. Open connections from the main
+  thread, before the workers that use them start.
+***********************************************************************/
+struct netfile_conn *netfile_conn_open(void)
+{
+  struct netfile_conn *conn = fc_malloc(sizeof(*conn));
+
+  conn->handle = curl_easy_init();
+
+  if (conn->handle == nullptr) {
+    free(conn);
+
+    return nullptr;
+  }
+
+  return conn;
+}
+
+/*******************************************************************//**
+  Close a download connection. Safe to call with nullptr.
+***********************************************************************/
+void netfile_conn_close(struct netfile_conn *conn)
+{
+  if (conn != nullptr) {
+    curl_easy_cleanup(conn->handle);
+    free(conn);
+  }
+}
+
+/*******************************************************************//**
+  Perform one transfer on the connection, appending to the stream from
+  the given offset of the remote file.
+***********************************************************************/
+static CURLcode netfile_conn_perform(struct netfile_conn *conn,
+                                     const char *URL, FILE *fp,
+                                     long offset,
+                                     struct curl_slist *headers)
+{
+  curl_easy_reset(conn->handle);
+
+  conn->error_buf[0] = '\0';
+  curl_easy_setopt(conn->handle, CURLOPT_ERRORBUFFER, conn->error_buf);
+
+  /* Signal-based resolver timeouts are not thread safe. */
+  curl_easy_setopt(conn->handle, CURLOPT_NOSIGNAL, (long)1);
+
+#ifdef CUSTOM_CACERT_PATH
+  curl_easy_setopt(conn->handle, CURLOPT_CAINFO, CUSTOM_CACERT_PATH);
+#endif /* CUSTOM_CACERT_PATH */
+
+  curl_easy_setopt(conn->handle, CURLOPT_URL, URL);
+  curl_easy_setopt(conn->handle, CURLOPT_WRITEDATA, fp);
+  curl_easy_setopt(conn->handle, CURLOPT_HTTPHEADER, headers);
+  curl_easy_setopt(conn->handle, CURLOPT_FAILONERROR, (long)1);
+  if (offset > 0) {
+    curl_easy_setopt(conn->handle, CURLOPT_RESUME_FROM, offset);
+  }
+
+  return curl_easy_perform(conn->handle);
+}
+
+/*******************************************************************//**
+  Fetch file from given URL and save as given filename, using a private
+  connection. When 'resume' is set and the local file already has
+  bytes, ask the server for the remainder only; if the server does not
+  honour the range request, the file is fetched again from the start.
+***********************************************************************/
+bool netfile_conn_download(struct netfile_conn *conn, const char *URL,
+                           const char *filename, bool resume,
+                           nf_errmsg cb, void *data)
+{
+  CURLcode curlret;
+  struct curl_slist *headers = nullptr;
+  long offset = 0;
+  FILE *fp;
+
+  if (resume) {
+    fp = fc_fopen(filename, "ab");
+    if (fp != nullptr) {
+      offset = ftell(fp);
+    }
+  } else {
+    fp = fc_fopen(filename, "w+b");
+  }
+
+  if (fp == nullptr) {
+    if (cb != nullptr) {
+      char buf[2048];
+
+      fc_snprintf(buf, sizeof(buf),
+                  _("Could not open %s for writing"), filename);
+      cb(buf, data);
+    }
+
+    return FALSE;
+  }
+
+  headers = curl_slist_append(headers, "User-Agent: Freeciv/" VERSION_STRING);
+
+  curlret = netfile_conn_perform(conn, URL, fp, offset, headers);
+
+  if (offset > 0) {
+    long http_resp = 0;
+
+    if (curlret == CURLE_OK) {
+      curl_easy_getinfo(conn->handle, CURLINFO_RESPONSE_CODE, &http_resp);
+    }
+
+    if (curlret != CURLE_OK || http_resp != 206) {
+      /* The server did not serve the requested range - it may have sent
+       * the whole file (appended after our partial bytes), rejected the
+       * range, or the local part may be stale. Redo from scratch. */
+      fclose(fp);
+      fp = fc_fopen(filename, "w+b");
+
+      if (fp == nullptr) {
+        curl_slist_free_all(headers);
+
+        return FALSE;
+      }
+
+      curlret = netfile_conn_perform(conn, URL, fp, 0, headers);
+    }
+  }
+
+  curl_slist_free_all(headers);
+  fclose(fp);
+
+  if (curlret != CURLE_OK) {
+    if (cb != nullptr) {
+      char buf[2048 + CURL_ERROR_SIZE];
+
+      fc_snprintf(buf, sizeof(buf),
+                  /* TRANS: first %s is URL, second is Curl error message
+                   * (not in Freeciv translation domain) */
+                  _("Failed to fetch %s: %s"), URL,
+                  conn->error_buf[0] != '\0'
+                  ? conn->error_buf : curl_easy_strerror(curlret));
+      cb(buf, data);
+    }
+
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 /*******************************************************************//**
   Fetch section file from net
 ***********************************************************************/
@@ -304,6 +465,11 @@ bool netfile_send_post(const char *URL, struct netfile_post *post,
   }
   curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
 
+  /* Posts carry small payloads and are sent to servers (metaserver)
+   * that may be unresponsive; give up rather than hang the sender. */
+  curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, (long)15);
+  curl_easy_setopt(handle, CURLOPT_TIMEOUT, (long)30);
+
   curlret = curl_easy_perform(handle);
 
   curl_slist_free_all(headers);
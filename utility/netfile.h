@@ -37,6 +37,15 @@ struct section_file *netfile_get_section_file(const char *URL,
 bool netfile_download_file(const char *URL, const char *filename,
                            nf_errmsg cb, void *data);
 
+/* Private connections for concurrent transfers; one conn per thread. */
+struct netfile_conn;
+
+struct netfile_conn *netfile_conn_open(void);
+bool netfile_conn_download(struct netfile_conn *conn, const char *URL,
+                           const char *filename, bool resume,
+                           nf_errmsg cb, void *data);
+void netfile_conn_close(struct netfile_conn *conn);
+
 struct netfile_post *netfile_start_post(void);
 void netfile_add_form_str(struct netfile_post *post,
                           const char *name, const char *val);
@@ -42,6 +42,9 @@
 #ifdef HAVE_SYS_IOCTL_H
 #include <sys/ioctl.h>
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #ifdef HAVE_SIGNAL_H
 #include <signal.h>
 #elif defined(HAVE_SYS_SIGNAL_H)
@@ -138,6 +141,288 @@ int fc_select(int n, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
   return result;
 }
 
+/* Interest and readiness bits of one monitored descriptor. */
+#define FC_EV_READ   0x01
+#define FC_EV_WRITE  0x02
+#define FC_EV_EXCEPT 0x04
+
+struct fc_eventset {
+#ifdef HAVE_SYS_EPOLL_H
+  int epfd;
+
+  /* Indexed by descriptor number. */
+  struct fc_evfd {
+    unsigned char want;   /* Interest registered with the kernel */
+    unsigned char marked; /* Interest given since monitor_begin() */
+    unsigned char ready;  /* Result of the last wait */
+    unsigned char always; /* Not pollable; report as always ready */
+  } *fds;
+  int fds_size;
+
+  struct epoll_event *events;
+#else  /* HAVE_SYS_EPOLL_H */
+  fd_set want[3];
+  fd_set ready[3];
+  int max_desc;
+#endif /* HAVE_SYS_EPOLL_H */
+};
+
+/*********************************************************************//**
+  Create an empty readiness monitoring set.
+*************************************************************************/
+struct fc_eventset *fc_eventset_new(void)
+{
+  struct fc_eventset *es = fc_calloc(1, sizeof(*es));
+
+#ifdef HAVE_SYS_EPOLL_H
+  es->epfd = epoll_create1(0);
+  if (es->epfd < 0) {
+    log_fatal("epoll_create1() failed: %s", fc_strerror(fc_get_errno()));
+    exit(EXIT_FAILURE);
+  }
+#else  /* HAVE_SYS_EPOLL_H */
+  es->max_desc = -1;
+#endif /* HAVE_SYS_EPOLL_H */
+
+  return es;
+}
+
+/*********************************************************************//**
+  Destroy a readiness monitoring set.
+*************************************************************************/
+void fc_eventset_destroy(struct fc_eventset *es)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  close(es->epfd);
+  free(es->fds);
+  free(es->events);
+#endif /* HAVE_SYS_EPOLL_H */
+  free(es);
+}
+
+/*********************************************************************//**
+  Start a new wakeup; descriptors not monitored again before the next
+  fc_eventset_wait() drop out of the set.
+*************************************************************************/
+void fc_eventset_monitor_begin(struct fc_eventset *es)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  int fd;
+
+  for (fd = 0; fd < es->fds_size; fd++) {
+    es->fds[fd].marked = 0;
+  }
+#else  /* HAVE_SYS_EPOLL_H */
+  FC_FD_ZERO(&es->want[0]);
+  FC_FD_ZERO(&es->want[1]);
+  FC_FD_ZERO(&es->want[2]);
+  es->max_desc = -1;
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*********************************************************************//**
+  Monitor a descriptor for readability, writability and/or exceptional
+  conditions until the next fc_eventset_wait() returns.
+*************************************************************************/
+void fc_eventset_monitor(struct fc_eventset *es, int fd,
+                         bool rd, bool wr, bool ex)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  if (fd >= es->fds_size) {
+    int newsize = MAX(fd + 1, MAX(es->fds_size * 2, 16));
+
+    es->fds = fc_realloc(es->fds, newsize * sizeof(es->fds[0]));
+    memset(es->fds + es->fds_size, 0,
+           (newsize - es->fds_size) * sizeof(es->fds[0]));
+    es->events = fc_realloc(es->events, newsize * sizeof(es->events[0]));
+    es->fds_size = newsize;
+  }
+
+  es->fds[fd].marked |= ((rd ? FC_EV_READ : 0)
+                         | (wr ? FC_EV_WRITE : 0)
+                         | (ex ? FC_EV_EXCEPT : 0));
+#else  /* HAVE_SYS_EPOLL_H */
+  fc_assert_ret(fd < FD_SETSIZE);
+
+  if (rd) {
+    FD_SET(fd, &es->want[0]);
+  }
+  if (wr) {
+    FD_SET(fd, &es->want[1]);
+  }
+  if (ex) {
+    FD_SET(fd, &es->want[2]);
+  }
+  es->max_desc = MAX(fd, es->max_desc);
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*********************************************************************//**
+  Wait until a monitored descriptor is ready or the timeout expires.
+  NULL timeout means waiting indefinitely. Returns the number of ready
+  descriptors, zero on timeout and a negative value on error, like
+  select() does.
+*************************************************************************/
+int fc_eventset_wait(struct fc_eventset *es, fc_timeval *timeout)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  int fd, n, i;
+  int timeout_ms;
+
+  if (timeout != NULL) {
+    timeout_ms = timeout->tv_sec * 1000 + timeout->tv_usec / 1000;
+  } else {
+    timeout_ms = -1;
+  }
+
+  /* Sync kernel side registrations with the descriptors monitored since
+   * monitor_begin(). Nothing to do for a descriptor whose interest did
+   * not change - the common case between consecutive wakeups. */
+  for (fd = 0; fd < es->fds_size; fd++) {
+    struct fc_evfd *pev = &es->fds[fd];
+
+    pev->ready = 0;
+
+    if (pev->marked != pev->want) {
+      struct epoll_event ev;
+
+      memset(&ev, 0, sizeof(ev));
+      ev.data.fd = fd;
+      ev.events = ((pev->marked & FC_EV_READ ? EPOLLIN : 0)
+                   | (pev->marked & FC_EV_WRITE ? EPOLLOUT : 0)
+                   | (pev->marked & FC_EV_EXCEPT ? EPOLLPRI : 0));
+
+      if (pev->marked == 0) {
+        if (!pev->always) {
+          epoll_ctl(es->epfd, EPOLL_CTL_DEL, fd, &ev);
+        }
+        pev->always = 0;
+      } else if (pev->want == 0) {
+        if (epoll_ctl(es->epfd, EPOLL_CTL_ADD, fd, &ev) != 0
+            && errno == EPERM) {
+          /* Not a pollable descriptor, e.g. stdin redirected from a
+           * regular file. select() reports those always ready, so
+           * keep doing that. */
+          pev->always = 1;
+        }
+      } else if (!pev->always) {
+        epoll_ctl(es->epfd, EPOLL_CTL_MOD, fd, &ev);
+      }
+      pev->want = pev->marked;
+    }
+
+    if (pev->always && pev->want != 0) {
+      /* Do not sleep on the others while this one is ready. */
+      timeout_ms = 0;
+    }
+  }
+
+  if (es->events == NULL) {
+    /* Nothing monitored yet; just honor the timeout. */
+    struct epoll_event dummy;
+
+    return epoll_wait(es->epfd, &dummy, 1, timeout_ms);
+  }
+
+  n = epoll_wait(es->epfd, es->events, es->fds_size, timeout_ms);
+
+  for (i = 0; i < n; i++) {
+    int ready = 0;
+    unsigned evs = es->events[i].events;
+
+    if (evs & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+      /* Errors and hangups are reported as readability; the caller's
+       * read path sees the failure, just as with select(). */
+      ready |= FC_EV_READ;
+    }
+    if (evs & (EPOLLOUT | EPOLLERR)) {
+      ready |= FC_EV_WRITE;
+    }
+    if (evs & EPOLLPRI) {
+      ready |= FC_EV_EXCEPT;
+    }
+    es->fds[es->events[i].data.fd].ready = ready;
+  }
+
+  if (n >= 0) {
+    for (fd = 0; fd < es->fds_size; fd++) {
+      struct fc_evfd *pev = &es->fds[fd];
+
+      if (pev->always && pev->want != 0 && pev->ready == 0) {
+        pev->ready = pev->want;
+        n++;
+      }
+    }
+  }
+
+  return n;
+#else  /* HAVE_SYS_EPOLL_H */
+  int n;
+
+  es->ready[0] = es->want[0];
+  es->ready[1] = es->want[1];
+  es->ready[2] = es->want[2];
+
+  n = fc_select(es->max_desc + 1, &es->ready[0], &es->ready[1],
+                &es->ready[2], timeout);
+
+  if (n <= 0) {
+    FC_FD_ZERO(&es->ready[0]);
+    FC_FD_ZERO(&es->ready[1]);
+    FC_FD_ZERO(&es->ready[2]);
+  }
+
+  return n;
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/*********************************************************************//**
+  Did the last wait report the given readiness for the descriptor?
+*************************************************************************/
+static bool eventset_is_ready(const struct fc_eventset *es, int fd,
+                              unsigned char event)
+{
+  return fd >= 0 && fd < es->fds_size && (es->fds[fd].ready & event);
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+/*********************************************************************//**
+  Did the last wait report the descriptor as readable?
+*************************************************************************/
+bool fc_eventset_readable(const struct fc_eventset *es, int fd)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  return eventset_is_ready(es, fd, FC_EV_READ);
+#else  /* HAVE_SYS_EPOLL_H */
+  return fd >= 0 && FD_ISSET(fd, &es->ready[0]);
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*********************************************************************//**
+  Did the last wait report the descriptor as writable?
+*************************************************************************/
+bool fc_eventset_writable(const struct fc_eventset *es, int fd)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  return eventset_is_ready(es, fd, FC_EV_WRITE);
+#else  /* HAVE_SYS_EPOLL_H */
+  return fd >= 0 && FD_ISSET(fd, &es->ready[1]);
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*********************************************************************//**
+  Did the last wait report an exceptional condition on the descriptor?
+*************************************************************************/
+bool fc_eventset_excepted(const struct fc_eventset *es, int fd)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  return eventset_is_ready(es, fd, FC_EV_EXCEPT);
+#else  /* HAVE_SYS_EPOLL_H */
+  return fd >= 0 && FD_ISSET(fd, &es->ready[2]);
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
 /*********************************************************************//**
   Read from a socket.
 *************************************************************************/
@@ -90,6 +90,30 @@ typedef TIMEVAL fc_timeval;
 typedef struct timeval fc_timeval;
 #endif /* FREECIV_MSWINDOWS */
 
+/* Readiness monitoring over a set of sockets. Backed by epoll(7) where
+ * available, so a wakeup only reports the sockets that are actually
+ * ready and the monitored socket count is not limited by FD_SETSIZE.
+ * Falls back to select() elsewhere.
+ *
+ * Usage per wakeup: fc_eventset_monitor_begin(), then
+ * fc_eventset_monitor() for every socket of interest, then
+ * fc_eventset_wait() and the readiness queries. The set remembers the
+ * kernel side registrations between wakeups, so monitoring the same
+ * sockets again is free. */
+struct fc_eventset;
+
+struct fc_eventset *fc_eventset_new(void);
+void fc_eventset_destroy(struct fc_eventset *es);
+
+void fc_eventset_monitor_begin(struct fc_eventset *es);
+void fc_eventset_monitor(struct fc_eventset *es, int fd,
+                         bool rd, bool wr, bool ex);
+int fc_eventset_wait(struct fc_eventset *es, fc_timeval *timeout);
+
+bool fc_eventset_readable(const struct fc_eventset *es, int fd);
+bool fc_eventset_writable(const struct fc_eventset *es, int fd);
+bool fc_eventset_excepted(const struct fc_eventset *es, int fd);
+
 int fc_connect(int sockfd, const struct sockaddr *serv_addr, socklen_t addrlen);
 int fc_select(int n, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
               fc_timeval *timeout);
@@ -282,6 +282,93 @@ void test_random1(int n)
   fc_rand_set_state(saved_state);
 }
 
+/*********************************************************************//**
+  Mix one counter block into a pseudo-random 64 bit value. This is the
+  output function of Vigna's SplitMix64 generator; the stream walks its
+  input through the counter sequence the generator was designed for.
+*************************************************************************/
+static uint64_t fc_rand_stream_mix(uint64_t block)
+{
+  block ^= block >> 30;
+  block *= (uint64_t) 0xbf58476d1ce4e5b9;
+  block ^= block >> 27;
+  block *= (uint64_t) 0x94d049bb133111eb;
+  block ^= block >> 31;
+
+  return block;
+}
+
+/*********************************************************************//**
+  Initialize a random stream from a base seed and a stream id.
+  Streams with different ids but the same seed are independent of each
+  other and of the global fc_rand() sequence.
+*************************************************************************/
+void fc_rand_stream_init(RANDOM_STREAM *pstream, RANDOM_TYPE seed,
+                         RANDOM_TYPE stream_id)
+{
+  pstream->key = fc_rand_stream_mix(((uint64_t) seed << 32)
+                                    | (uint64_t) stream_id);
+  pstream->counter = 0;
+  pstream->is_init = TRUE;
+}
+
+/*********************************************************************//**
+  Returns a new random value from the stream, in the interval 0 to
+  (size-1) inclusive, and updates the stream state for the next call.
+  This means that if size <= 1 the function will always return 0.
+
+  The value is derived purely from the stream key and a draw counter,
+  so the sequence of a stream depends only on its seed and stream id --
+  never on what other streams or fc_rand() have drawn in the meantime.
+  The reduction to the required range uses the same divisor scheme as
+  fc_rand(); see the comment on fc_rand_debug().
+*************************************************************************/
+RANDOM_TYPE fc_rand_stream_debug(RANDOM_STREAM *pstream, RANDOM_TYPE size,
+                                 const char *called_as,
+                                 int line, const char *file)
+{
+  RANDOM_TYPE new_rand;
+
+  fc_assert_ret_val(pstream->is_init, 0);
+
+  if (size > 1) {
+    RANDOM_TYPE divisor, max;
+    int bailout = 0;
+
+    divisor = MAX_UINT32 / size;
+    max = size * divisor - 1;
+
+    do {
+      /* SplitMix64 proper: the counter advances by the golden-ratio
+       * increment and the mixer turns it into the output. */
+      new_rand = (RANDOM_TYPE)
+        (fc_rand_stream_mix(pstream->key
+                            + pstream->counter
+                              * (uint64_t) 0x9e3779b97f4a7c15)
+         & MAX_UINT32);
+      pstream->counter++;
+
+      if (++bailout > 10000) {
+        log_error("%s(%lu) = %lu bailout at %s:%d",
+                  called_as, (unsigned long) size,
+                  (unsigned long) new_rand, file, line);
+        new_rand = 0;
+        break;
+      }
+
+    } while (new_rand > max);
+
+    new_rand /= divisor;
+  } else {
+    new_rand = 0;
+  }
+
+  RAND_VALUE_LOG(called_as, (unsigned long) size,
+                 (unsigned long) new_rand, file, line);
+
+  return new_rand;
+}
+
 /*********************************************************************//**
   Local pseudo-random function for repeatedly reaching the same result,
   instead of fc_rand(). Primarily needed for tiles.
@@ -70,6 +70,31 @@ void test_random1(int n);
 
 /*===*/
 
+/* A splittable counter-based random stream:
+ * Initialized by fc_rand_stream_init() from a base seed and a stream id,
+ * updated by fc_rand_stream(). Every (seed, stream id, draw count) triple
+ * maps to a fixed value, so any number of streams can be drawn from
+ * concurrently and in any order with reproducible results, without
+ * touching or reordering the global fc_rand() sequence. */
+typedef struct {
+  uint64_t key;
+  uint64_t counter;
+  bool is_init;                 /* Initially FALSE for static storage */
+} RANDOM_STREAM;
+
+#define fc_rand_stream(_pstream, _size) \
+  fc_rand_stream_debug((_pstream), (_size), "fc_rand_stream", \
+                       __FC_LINE__, __FILE__)
+
+void fc_rand_stream_init(RANDOM_STREAM *pstream, RANDOM_TYPE seed,
+                         RANDOM_TYPE stream_id);
+
+RANDOM_TYPE fc_rand_stream_debug(RANDOM_STREAM *pstream, RANDOM_TYPE size,
+                                 const char *called_as,
+                                 int line, const char *file);
+
+/*===*/
+
 #define fc_randomly(_seed, _size) \
   fc_randomly_debug((_seed), (_size), "fc_randomly", __FC_LINE__, __FILE__)
 
@@ -21,6 +21,8 @@
 #endif /* FREECIV_HAVE_XML_REGISTRY */
 
 /* utility */
+#include "inputfile.h"
+#include "registry_bin.h"
 #include "registry_xml.h"
 
 #include "registry.h"
@@ -30,6 +32,8 @@
 *************************************************************************/
 void registry_module_init(void)
 {
+  inputfile_init();
+
 #ifdef FREECIV_HAVE_XML_REGISTRY
   LIBXML_TEST_VERSION;
 #endif /* FREECIV_HAVE_XML_REGISTRY */
@@ -40,6 +44,8 @@ void registry_module_init(void)
 *************************************************************************/
 void registry_module_close(void)
 {
+  inputfile_free();
+
 #ifdef FREECIV_HAVE_XML_REGISTRY
   xmlCleanupParser();
 #endif /* FREECIV_HAVE_XML_REGISTRY */
@@ -51,6 +57,15 @@ void registry_module_close(void)
 struct section_file *secfile_load(const char *filename,
                                   bool allow_duplicates)
 {
+  struct section_file *bin_secfile;
+
+  /* Probe for the binary format first; this reads just the magic
+   * bytes when the file turns out to be something else. */
+  bin_secfile = binfile_load(filename, allow_duplicates);
+  if (bin_secfile != nullptr) {
+    return bin_secfile;
+  }
+
 #ifdef FREECIV_HAVE_XML_REGISTRY
   struct stat buf;
 
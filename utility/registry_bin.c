@@ -0,0 +1,439 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/***********************************************************************
+  Binary backend for the registry.
+
+  A binary registry file carries the same logical content as an
+  ini-style one - named sections containing typed entries - but as
+  length-prefixed records instead of formatted text, so that neither
+  saving nor loading has to go through number formatting, escaping
+  and tokenizing. It is written through ioz, so the usual compression
+  methods apply on top of it.
+
+  File layout, after the FCBR_MAGIC bytes:
+    'S' <u16 len> <section name>          start of a section
+    'B' <u16 len> <entry name> <u8>       boolean entry
+    'I' <u16 len> <entry name> <s32>      integer entry
+    'F' <u16 len> <entry name> <u32>      float entry (IEEE bits)
+    'T' <u16 len> <entry name>
+        <u8 escaped> <u32 len> <value>    string entry
+    'Z'                                   end of file
+  All multibyte values are little-endian regardless of host byte
+  order.
+
+  Comments, includes, and file references have no binary
+  representation; they are dropped when saving. Savegames, the
+  intended user of this format, contain none that carry game state.
+  The same goes for the gettext marking of strings.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <string.h>
+
+/* utility */
+#include "fcintl.h"
+#include "ioz.h"
+#include "log.h"
+#include "mem.h"
+#include "registry.h"
+#include "section_file.h"
+#include "shared.h"
+
+#include "registry_bin.h"
+
+#define MAX_LEN_BIN_NAME 1024
+
+/* Record tags. */
+#define FCBR_REC_SECTION 'S'
+#define FCBR_REC_BOOL    'B'
+#define FCBR_REC_INT     'I'
+#define FCBR_REC_FLOAT   'F'
+#define FCBR_REC_STR     'T'
+#define FCBR_REC_END     'Z'
+
+/**********************************************************************//**
+  Write 'size' bytes, TRUE on success.
+**************************************************************************/
+static bool fcbr_write(fz_FILE *fs, const void *data, int size)
+{
+  return fz_fwrite(data, size, fs) == size;
+}
+
+/**********************************************************************//**
+  Write an unsigned value as 'bytes' little-endian bytes.
+**************************************************************************/
+static bool fcbr_write_uint(fz_FILE *fs, unsigned int value, int bytes)
+{
+  unsigned char buf[4];
+  int i;
+
+  for (i = 0; i < bytes; i++) {
+    buf[i] = (value >> (8 * i)) & 0xFF;
+  }
+
+  return fcbr_write(fs, buf, bytes);
+}
+
+/**********************************************************************//**
+  Write a record header: tag byte plus length-prefixed name.
+**************************************************************************/
+static bool fcbr_write_name(fz_FILE *fs, char tag, const char *name)
+{
+  int len = strlen(name);
+
+  return fcbr_write(fs, &tag, 1)
+    && fcbr_write_uint(fs, len, 2)
+    && fcbr_write(fs, name, len);
+}
+
+/**********************************************************************//**
+  Write single entry to the file. Entry types with no binary
+  representation are silently dropped.
+**************************************************************************/
+static bool fcbr_write_entry(fz_FILE *fs, struct entry *pentry)
+{
+  const char *name = entry_name(pentry);
+
+  switch (entry_type_get(pentry)) {
+  case ENTRY_BOOL:
+    {
+      bool bval;
+      unsigned char byte;
+
+      if (!entry_bool_get(pentry, &bval)) {
+        return FALSE;
+      }
+      byte = bval ? 1 : 0;
+
+      return fcbr_write_name(fs, FCBR_REC_BOOL, name)
+        && fcbr_write(fs, &byte, 1);
+    }
+  case ENTRY_INT:
+    {
+      int ival;
+
+      if (!entry_int_get(pentry, &ival)) {
+        return FALSE;
+      }
+
+      return fcbr_write_name(fs, FCBR_REC_INT, name)
+        && fcbr_write_uint(fs, (unsigned int) ival, 4);
+    }
+  case ENTRY_FLOAT:
+    {
+      float fval;
+      unsigned int bits;
+
+      if (!entry_float_get(pentry, &fval)) {
+        return FALSE;
+      }
+      memcpy(&bits, &fval, 4);
+
+      return fcbr_write_name(fs, FCBR_REC_FLOAT, name)
+        && fcbr_write_uint(fs, bits, 4);
+    }
+  case ENTRY_STR:
+    {
+      const char *sval;
+      unsigned char escaped;
+
+      if (!entry_str_get(pentry, &sval)) {
+        return FALSE;
+      }
+      escaped = entry_str_escaped(pentry) ? 1 : 0;
+
+      return fcbr_write_name(fs, FCBR_REC_STR, name)
+        && fcbr_write(fs, &escaped, 1)
+        && fcbr_write_uint(fs, strlen(sval), 4)
+        && fcbr_write(fs, sval, strlen(sval));
+    }
+  case ENTRY_FILEREFERENCE:
+  case ENTRY_LONG_COMMENT:
+    /* Not representable; dropped. */
+    return TRUE;
+  case ENTRY_ILLEGAL:
+    fc_assert(entry_type_get(pentry) != ENTRY_ILLEGAL);
+    break;
+  }
+
+  return FALSE;
+}
+
+/**********************************************************************//**
+  Save the section file in the binary format. Compression is layered
+  on top by ioz, exactly as for secfile_save().
+**************************************************************************/
+bool secfile_save_bin(const struct section_file *secfile,
+                      const char *filename,
+                      int compression_level,
+                      enum fz_method compression_method)
+{
+  char real_filename[1024];
+  fz_FILE *fs;
+  bool ok = TRUE;
+
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, secfile != nullptr, FALSE);
+
+  if (filename == nullptr) {
+    filename = secfile->name;
+  }
+
+  interpret_tilde(real_filename, sizeof(real_filename), filename);
+  fs = fz_from_file(real_filename, "w",
+                    compression_method, compression_level);
+
+  if (!fs) {
+    SECFILE_LOG(secfile, nullptr, _("Could not open %s for writing"),
+                real_filename);
+
+    return FALSE;
+  }
+
+  ok = fcbr_write(fs, FCBR_MAGIC, FCBR_MAGIC_LEN);
+
+  section_list_iterate(secfile->sections, psection) {
+    if (!ok) {
+      break;
+    }
+
+    if (psection->special != EST_NORMAL) {
+      /* Includes and long comments are not representable; dropped. */
+      continue;
+    }
+
+    ok = fcbr_write_name(fs, FCBR_REC_SECTION, section_name(psection));
+
+    entry_list_iterate(section_entries(psection), pentry) {
+      if (!ok) {
+        break;
+      }
+      ok = fcbr_write_entry(fs, pentry);
+    } entry_list_iterate_end;
+  } section_list_iterate_end;
+
+  if (ok) {
+    char tag = FCBR_REC_END;
+
+    ok = fcbr_write(fs, &tag, 1);
+  }
+
+  if (!ok || 0 != fz_ferror(fs)) {
+    SECFILE_LOG(secfile, nullptr, "Error before closing %s: %s",
+                real_filename, fz_strerror(fs));
+    fz_fclose(fs);
+    return FALSE;
+  }
+  if (0 != fz_fclose(fs)) {
+    SECFILE_LOG(secfile, nullptr, "Error closing %s", real_filename);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Read 'size' bytes, TRUE on success.
+**************************************************************************/
+static bool fcbr_read(fz_FILE *fp, void *data, int size)
+{
+  return fz_fread(data, size, fp) == size;
+}
+
+/**********************************************************************//**
+  Read an unsigned value stored as 'bytes' little-endian bytes.
+**************************************************************************/
+static bool fcbr_read_uint(fz_FILE *fp, unsigned int *value, int bytes)
+{
+  unsigned char buf[4];
+  int i;
+
+  if (!fcbr_read(fp, buf, bytes)) {
+    return FALSE;
+  }
+
+  *value = 0;
+  for (i = 0; i < bytes; i++) {
+    *value |= ((unsigned int) buf[i]) << (8 * i);
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Read a length-prefixed section or entry name.
+**************************************************************************/
+static bool fcbr_read_name(fz_FILE *fp, char *name, int name_len)
+{
+  unsigned int len;
+
+  if (!fcbr_read_uint(fp, &len, 2) || len >= (unsigned int) name_len) {
+    return FALSE;
+  }
+  if (!fcbr_read(fp, name, len)) {
+    return FALSE;
+  }
+  name[len] = '\0';
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Load section file from a binary registry file. Returns nullptr
+  without complaint if the file does not carry the binary magic, so
+  that the caller can try the other formats.
+**************************************************************************/
+struct section_file *binfile_load(const char *filename,
+                                  bool allow_duplicates)
+{
+  fz_FILE *fp;
+  struct section_file *secfile;
+  struct section *psection = nullptr;
+  char magic[FCBR_MAGIC_LEN];
+  char name[MAX_LEN_BIN_NAME];
+  bool end = FALSE;
+
+  fp = fz_from_file(filename, "r", FZ_PLAIN, 0);
+  if (fp == nullptr) {
+    return nullptr;
+  }
+
+  if (fz_fread(magic, FCBR_MAGIC_LEN, fp) != FCBR_MAGIC_LEN
+      || memcmp(magic, FCBR_MAGIC, FCBR_MAGIC_LEN) != 0) {
+    /* Not a binary registry file. */
+    fz_fclose(fp);
+    return nullptr;
+  }
+
+  secfile = secfile_new(allow_duplicates);
+  secfile->name = fc_strdup(filename);
+
+  while (!end) {
+    unsigned char tag;
+
+    if (!fcbr_read(fp, &tag, 1)) {
+      log_error(_("%s: truncated binary registry file."), filename);
+      goto failure;
+    }
+
+    if (tag == FCBR_REC_END) {
+      end = TRUE;
+      continue;
+    }
+
+    if (tag == FCBR_REC_SECTION) {
+      if (!fcbr_read_name(fp, name, sizeof(name))
+          || (psection = secfile_section_new(secfile, name)) == nullptr) {
+        log_error(_("%s: bad section record."), filename);
+        goto failure;
+      }
+      continue;
+    }
+
+    if (psection == nullptr) {
+      log_error(_("%s: entry record before first section."), filename);
+      goto failure;
+    }
+    if (!fcbr_read_name(fp, name, sizeof(name))) {
+      log_error(_("%s: bad entry record."), filename);
+      goto failure;
+    }
+
+    switch (tag) {
+    case FCBR_REC_BOOL:
+      {
+        unsigned char byte;
+
+        if (!fcbr_read(fp, &byte, 1)) {
+          goto bad_value;
+        }
+        (void) section_entry_bool_new(psection, name, byte != 0);
+      }
+      break;
+    case FCBR_REC_INT:
+      {
+        unsigned int value;
+
+        if (!fcbr_read_uint(fp, &value, 4)) {
+          goto bad_value;
+        }
+        (void) section_entry_int_new(psection, name, (int) value);
+      }
+      break;
+    case FCBR_REC_FLOAT:
+      {
+        unsigned int bits;
+        float fval;
+
+        if (!fcbr_read_uint(fp, &bits, 4)) {
+          goto bad_value;
+        }
+        memcpy(&fval, &bits, 4);
+        (void) section_entry_float_new(psection, name, fval);
+      }
+      break;
+    case FCBR_REC_STR:
+      {
+        unsigned char escaped;
+        unsigned int len;
+        char *value;
+
+        if (!fcbr_read(fp, &escaped, 1)
+            || !fcbr_read_uint(fp, &len, 4)) {
+          goto bad_value;
+        }
+        value = fc_malloc(len + 1);
+        if (!fcbr_read(fp, value, len)) {
+          free(value);
+          goto bad_value;
+        }
+        value[len] = '\0';
+        (void) section_entry_str_new(psection, name, value, escaped != 0);
+        free(value);
+      }
+      break;
+    default:
+      log_error(_("%s: unknown record tag 0x%02x."), filename, tag);
+      goto failure;
+    }
+  }
+
+  fz_fclose(fp);
+
+  /* Build the entry lookup hash, as secfile_from_input() does for
+   * parsed text files. */
+  secfile->hash.entries = entry_hash_new_nentries(secfile->num_entries);
+  section_list_iterate(secfile->sections, hashing_section) {
+    entry_list_iterate(section_entries(hashing_section), pentry) {
+      char buf[256];
+
+      entry_path(pentry, buf, sizeof(buf));
+      entry_hash_replace(secfile->hash.entries, buf, pentry);
+    } entry_list_iterate_end;
+  } section_list_iterate_end;
+
+  return secfile;
+
+bad_value:
+  log_error(_("%s: bad value for entry \"%s.%s\"."), filename,
+            section_name(psection), name);
+
+failure:
+  secfile_destroy(secfile);
+  fz_fclose(fp);
+
+  return nullptr;
+}
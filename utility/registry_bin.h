@@ -0,0 +1,43 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__REGISTRY_BIN_H
+#define FC__REGISTRY_BIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* utility */
+#include "ioz.h"
+#include "support.h"            /* bool type */
+
+struct section_file;
+
+/* First bytes of a binary registry file, before any compression wrapper
+ * is taken into account. */
+#define FCBR_MAGIC "FCBR1\n"
+#define FCBR_MAGIC_LEN 6
+
+struct section_file *binfile_load(const char *filename,
+                                  bool allow_duplicates);
+
+bool secfile_save_bin(const struct section_file *secfile,
+                      const char *filename,
+                      int compression_level,
+                      enum fz_method compression_method);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FC__REGISTRY_BIN_H */
@@ -480,6 +480,12 @@ static struct section_file *secfile_from_input_file(struct inputfile *inf,
             astr_free(&columns.p[j]);
           }
           astring_vector_reserve(&columns, i + 1);
+          /* The realloc may have moved the astrings away from their
+           * inline small-string buffers; re-point them at the new
+           * slots. */
+          for (j = 0; j < n_prev && j <= i; j++) {
+            astr_rebind(&columns.p[j]);
+          }
           for (j = n_prev; j < i + 1; j++) {
             astr_init(&columns.p[j]);
           }
@@ -2284,6 +2290,236 @@ const char **secfile_lookup_str_vec(const struct section_file *secfile,
   return vec;
 }
 
+/**********************************************************************//**
+  Does the entry name match "<prefix><index><suffix>"?
+**************************************************************************/
+static bool entry_name_run_match(const struct entry *pentry,
+                                 const char *prefix, size_t prefix_len,
+                                 size_t index, const char *suffix)
+{
+  const char *name = entry_name(pentry);
+  size_t value = 0;
+
+  if (strncmp(name, prefix, prefix_len) != 0) {
+    return FALSE;
+  }
+
+  name += prefix_len;
+  if (*name < '0' || *name > '9') {
+    return FALSE;
+  }
+  for (; *name >= '0' && *name <= '9'; name++) {
+    value = value * 10 + (*name - '0');
+  }
+
+  return value == index && 0 == strcmp(name, suffix);
+}
+
+/**********************************************************************//**
+  Fetch the entries "<fullpath>0<suffix>", "<fullpath>1<suffix>", ...
+  up to 'n' of them, into 'vec'. Returns the number of entries found;
+  the run stops at the first index with no matching entry.
+
+  Unlike the hash lookups, this walks the entry list of the section once,
+  comparing names in place, so fetching a whole run costs no more than a
+  single scan when the entries appear in index order - as they do in
+  files we have written ourselves.
+**************************************************************************/
+static size_t secfile_entry_run(const struct section_file *secfile,
+                                struct entry **vec, size_t n,
+                                const char *suffix, const char *fullpath)
+{
+  char secname[MAX_LEN_SECPATH];
+  const char *ent_prefix;
+  size_t prefix_len, i;
+  struct section *psection;
+  struct entry_list_link *cursor;
+
+  /* Separates section and entry name prefix. */
+  ent_prefix = strchr(fullpath, '.');
+  if (ent_prefix == nullptr) {
+    return 0;
+  }
+  fc_strlcpy(secname, fullpath, MIN(sizeof(secname),
+                                    (size_t) (ent_prefix - fullpath) + 1));
+  ent_prefix++;
+  prefix_len = strlen(ent_prefix);
+
+  psection = secfile_section_by_name(secfile, secname);
+  if (psection == nullptr) {
+    return 0;
+  }
+
+  cursor = entry_list_head(psection->entries);
+  for (i = 0; i < n; i++) {
+    struct entry_list_link *plink = cursor;
+    struct entry *found = nullptr;
+    bool wrapped = FALSE;
+
+    while (TRUE) {
+      struct entry *pentry;
+
+      if (plink == nullptr) {
+        if (wrapped) {
+          break;
+        }
+        /* Out-of-order entry; scan again from the list head. */
+        wrapped = TRUE;
+        plink = entry_list_head(psection->entries);
+        if (plink == nullptr) {
+          break;
+        }
+      }
+      if (wrapped && plink == cursor) {
+        break;
+      }
+
+      pentry = entry_list_link_data(plink);
+      if (entry_name_run_match(pentry, ent_prefix, prefix_len, i, suffix)) {
+        found = pentry;
+        cursor = entry_list_link_next(plink);
+        break;
+      }
+      plink = entry_list_link_next(plink);
+    }
+
+    if (found == nullptr) {
+      return i;
+    }
+    entry_use(found);
+    vec[i] = found;
+  }
+
+  return n;
+}
+
+/**********************************************************************//**
+  Lookup the integer run "<path>0<suffix>", "<path>1<suffix>", ... into
+  'vec', which must have room for 'n' values. Returns the number of
+  consecutive values found, which is less than 'n' when the run ends
+  early. No error is logged for a short or missing run.
+**************************************************************************/
+size_t secfile_lookup_int_run(const struct section_file *secfile,
+                              int *vec, size_t n, const char *suffix,
+                              const char *path, ...)
+{
+  char fullpath[MAX_LEN_SECPATH];
+  struct entry **entries;
+  size_t count, i;
+  va_list args;
+
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, secfile != nullptr, 0);
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, vec != nullptr || n == 0, 0);
+
+  if (0 == n) {
+    return 0;
+  }
+
+  va_start(args, path);
+  fc_vsnprintf(fullpath, sizeof(fullpath), path, args);
+  va_end(args);
+
+  entries = fc_malloc(n * sizeof(*entries));
+  count = secfile_entry_run(secfile, entries, n, suffix, fullpath);
+  for (i = 0; i < count; i++) {
+    if (!entry_int_get(entries[i], vec + i)) {
+      SECFILE_LOG(secfile, entry_section(entries[i]),
+                  "\"%s%d%s\" entry is not an integer.",
+                  fullpath, (int) i, suffix);
+      count = i;
+      break;
+    }
+  }
+  free(entries);
+
+  return count;
+}
+
+/**********************************************************************//**
+  Lookup the boolean run "<path>0<suffix>", "<path>1<suffix>", ... into
+  'vec', which must have room for 'n' values. Returns the number of
+  consecutive values found, which is less than 'n' when the run ends
+  early. No error is logged for a short or missing run.
+**************************************************************************/
+size_t secfile_lookup_bool_run(const struct section_file *secfile,
+                               bool *vec, size_t n, const char *suffix,
+                               const char *path, ...)
+{
+  char fullpath[MAX_LEN_SECPATH];
+  struct entry **entries;
+  size_t count, i;
+  va_list args;
+
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, secfile != nullptr, 0);
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, vec != nullptr || n == 0, 0);
+
+  if (0 == n) {
+    return 0;
+  }
+
+  va_start(args, path);
+  fc_vsnprintf(fullpath, sizeof(fullpath), path, args);
+  va_end(args);
+
+  entries = fc_malloc(n * sizeof(*entries));
+  count = secfile_entry_run(secfile, entries, n, suffix, fullpath);
+  for (i = 0; i < count; i++) {
+    if (!entry_bool_get(entries[i], vec + i)) {
+      SECFILE_LOG(secfile, entry_section(entries[i]),
+                  "\"%s%d%s\" entry is not a boolean.",
+                  fullpath, (int) i, suffix);
+      count = i;
+      break;
+    }
+  }
+  free(entries);
+
+  return count;
+}
+
+/**********************************************************************//**
+  Lookup the string run "<path>0<suffix>", "<path>1<suffix>", ... into
+  'vec', which must have room for 'n' pointers. The strings are owned by
+  the registry and are valid as long as the secfile is. Returns the
+  number of consecutive values found, which is less than 'n' when the
+  run ends early. No error is logged for a short or missing run.
+**************************************************************************/
+size_t secfile_lookup_str_run(const struct section_file *secfile,
+                              const char **vec, size_t n,
+                              const char *suffix, const char *path, ...)
+{
+  char fullpath[MAX_LEN_SECPATH];
+  struct entry **entries;
+  size_t count, i;
+  va_list args;
+
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, secfile != nullptr, 0);
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, vec != nullptr || n == 0, 0);
+
+  if (0 == n) {
+    return 0;
+  }
+
+  va_start(args, path);
+  fc_vsnprintf(fullpath, sizeof(fullpath), path, args);
+  va_end(args);
+
+  entries = fc_malloc(n * sizeof(*entries));
+  count = secfile_entry_run(secfile, entries, n, suffix, fullpath);
+  for (i = 0; i < count; i++) {
+    if (!entry_str_get(entries[i], vec + i)) {
+      SECFILE_LOG(secfile, entry_section(entries[i]),
+                  "\"%s%d%s\" entry is not a string.",
+                  fullpath, (int) i, suffix);
+      count = i;
+      break;
+    }
+  }
+  free(entries);
+
+  return count;
+}
+
 /**********************************************************************//**
   Lookup an enumerator value in the secfile. Returns FALSE on error.
 **************************************************************************/
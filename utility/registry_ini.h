@@ -470,6 +470,23 @@ const char **secfile_lookup_str_vec(const struct section_file *secfile,
                                     size_t *dim, const char *path, ...)
                                     fc__attribute((__format__ (__printf__, 3, 4)));
 
+/* Run lookups fetch the whole homogeneous entry run
+ * "<path>0<suffix>", "<path>1<suffix>", ... in one sequential walk of
+ * the section's entry list, avoiding a key construction and a hash
+ * lookup per element. */
+size_t secfile_lookup_int_run(const struct section_file *secfile,
+                              int *vec, size_t n, const char *suffix,
+                              const char *path, ...)
+                              fc__attribute((__format__ (__printf__, 5, 6)));
+size_t secfile_lookup_bool_run(const struct section_file *secfile,
+                               bool *vec, size_t n, const char *suffix,
+                               const char *path, ...)
+                               fc__attribute((__format__ (__printf__, 5, 6)));
+size_t secfile_lookup_str_run(const struct section_file *secfile,
+                              const char **vec, size_t n,
+                              const char *suffix, const char *path, ...)
+                              fc__attribute((__format__ (__printf__, 5, 6)));
+
 bool secfile_lookup_plain_enum_full(const struct section_file *secfile,
                                     int *penumerator,
                                     secfile_enum_is_valid_fn_t is_valid_fn,
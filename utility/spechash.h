@@ -688,18 +688,23 @@ SPECHASH_FOO(_hash_value_iter_init) (SPECHASH_ITER *iter,
 #ifndef FC__SPECHASH_H  /* Defines this only once, no multiple inclusions. */
 #define FC__SPECHASH_H
 
+/* The iterators below walk the bucket array of the genhash directly
+ * (see genhash_buckets_iterate()), instead of going through the generic
+ * iterator interface with a function call per element. The table must
+ * not be modified during the iteration. */
+
 /* Spechash value iterator.
  *
  * TYPE_data - The real type of the data in the genhash.
  * ARG_ht - The genhash to iterate.
  * NAME_data - The name of the data iterator (defined inside the macro). */
 #define TYPED_HASH_DATA_ITERATE(TYPE_data, ARG_ht, NAME_data)               \
-  generic_iterate(struct genhash_iter, TYPE_data, NAME_data,                \
-                  genhash_iter_sizeof, genhash_value_iter_init,             \
-                  (const struct genhash *) (ARG_ht))
+  genhash_buckets_iterate((const struct genhash *) (ARG_ht), MY_entry) {    \
+    TYPE_data NAME_data = (TYPE_data) MY_entry->data;
 
 /* Balance for above: */
-#define HASH_DATA_ITERATE_END generic_iterate_end
+#define HASH_DATA_ITERATE_END                                               \
+  } genhash_buckets_iterate_end;
 
 /* Spechash key iterator.
  *
@@ -707,14 +712,12 @@ SPECHASH_FOO(_hash_value_iter_init) (SPECHASH_ITER *iter,
  * ARG_ht - The genhash to iterate.
  * NAME_key - The name of the key iterator (defined inside the macro). */
 #define TYPED_HASH_KEYS_ITERATE(TYPE_key, ARG_ht, NAME_key)                 \
-  generic_iterate(struct genhash_iter, TYPE_key, NAME_key,                  \
-                  genhash_iter_sizeof, genhash_key_iter_init,               \
-                  (const struct genhash *) (ARG_ht))
+  genhash_buckets_iterate((const struct genhash *) (ARG_ht), MY_entry) {    \
+    TYPE_key NAME_key = (TYPE_key) MY_entry->key;
 
 /* Balance for above: */
 #define HASH_KEYS_ITERATE_END                                               \
-  }                                                                         \
-} while (FALSE);
+  } genhash_buckets_iterate_end;
 
 /* Spechash key and values iterator.
  *
@@ -724,13 +727,13 @@ SPECHASH_FOO(_hash_value_iter_init) (SPECHASH_ITER *iter,
  * NAME_key - The name of the key iterator (defined inside the macro).
  * NAME_data - The name of the data iterator (defined inside the macro). */
 #define TYPED_HASH_ITERATE(TYPE_key, TYPE_data, ARG_ht, NAME_key, NAME_data)\
-  genhash_iterate((const struct genhash *) (ARG_ht), MY_iter) {             \
-    TYPE_key NAME_key = (TYPE_key) genhash_iter_key(MY_iter);               \
-    TYPE_data NAME_data = (TYPE_data) genhash_iter_value(MY_iter);
+  genhash_buckets_iterate((const struct genhash *) (ARG_ht), MY_entry) {    \
+    TYPE_key NAME_key = (TYPE_key) MY_entry->key;                           \
+    TYPE_data NAME_data = (TYPE_data) MY_entry->data;
 
 /* Balance for above: */
 #define HASH_ITERATE_END                                                    \
-  } genhash_iterate_end;
+  } genhash_buckets_iterate_end;
 
 #endif /* FC__SPECHASH_H */
 
@@ -21,6 +21,12 @@
  *   SPECPQ_TAG - this tag will be used to form names for functions etc.
  *   SPECPQ_PRIORITY_TYPE - the type for the priority property of the cells.
  *   SPECPQ_DATA_TYPE - the type for the data property of the cells.
+ * You may also define:
+ *   SPECPQ_INDEXED - the data type is a non-negative integer index from a
+ *     known range, and the queue should track the heap position of every
+ *     datum. This makes foo_pq_replace() a O(log n) decrease/increase-key
+ *     instead of a linear scan, and keeps at most one live cell per datum
+ *     even when foo_pq_insert() is called for a datum already queued.
  *
  * Assuming SPECPQ_TAG were 'foo', SPECPQ_PRIORITY_TYPE were 'priority_t',
  * and SPECPQ_DATA_TYPE were 'data_t'.
@@ -43,6 +49,11 @@
  *    bool foo_pq_peek(const struct foo_pq *pq, data_t *pdata);
  *    bool foo_pq_priority(const struct foo_pq *pq, priority_t *ppriority);
  *
+ * and, with SPECPQ_INDEXED, additionally for:
+ *    struct foo_pq *foo_pq_new_indexed(int initial_size, int index_range);
+ * Position tracking is active only for queues built with
+ * foo_pq_new_indexed(); foo_pq_new() still gives the plain behavior.
+ *
  * Note this is not protected against multiple inclusions; this is so that
  * you can have multiple different speclists. For each speclist, this file
  * should be included _once_, inside a .h file which _is_ itself protected
@@ -91,8 +102,26 @@ SPECPQ_PQ_ {
   int avail;
   int step;
   SPECPQ_CELL_ *cells;
+#ifdef SPECPQ_INDEXED
+  int *positions;       /* Maps datum -> cell index, -1 when not queued;
+                         * nullptr for queues from foo_pq_new(). */
+  int index_range;
+#endif /* SPECPQ_INDEXED */
 };
 
+/* Keep the position map in sync with a cell movement. Expands to nothing
+ * for non-indexed queues, so the heap code below can stay shared. */
+#ifdef SPECPQ_INDEXED
+#define SPECPQ_TRACK_(pq, i)                                                \
+  do {                                                                      \
+    if ((pq)->positions != nullptr) {                                       \
+      (pq)->positions[(pq)->cells[i].data] = (i);                           \
+    }                                                                       \
+  } while (FALSE)
+#else  /* SPECPQ_INDEXED */
+#define SPECPQ_TRACK_(pq, i) (void) 0
+#endif /* SPECPQ_INDEXED */
+
 /************************************************************************//**
   Build a new queue.
   'initial_size' is the number of queue items for which memory should be
@@ -108,9 +137,34 @@ static inline SPECPQ_PQ *SPECPQ_FOO(_pq_new)(int initial_size)
   pq->avail = initial_size;
   pq->step = initial_size;
   pq->size = 1;
+#ifdef SPECPQ_INDEXED
+  pq->positions = nullptr;
+  pq->index_range = 0;
+#endif /* SPECPQ_INDEXED */
   return (SPECPQ_PQ *) pq;
 }
 
+#ifdef SPECPQ_INDEXED
+/************************************************************************//**
+  Build a new queue which tracks the heap position of every datum, for
+  data in the range [0, index_range). See the SPECPQ_INDEXED notes at the
+  top of the file.
+****************************************************************************/
+static inline SPECPQ_PQ *SPECPQ_FOO(_pq_new_indexed)(int initial_size,
+                                                     int index_range)
+{
+  SPECPQ_PQ_ *pq = (SPECPQ_PQ_ *) SPECPQ_FOO(_pq_new)(initial_size);
+  int i;
+
+  pq->positions = fc_malloc(sizeof(*pq->positions) * index_range);
+  pq->index_range = index_range;
+  for (i = 0; i < index_range; i++) {
+    pq->positions[i] = -1;
+  }
+  return (SPECPQ_PQ *) pq;
+}
+#endif /* SPECPQ_INDEXED */
+
 /************************************************************************//**
   Destructor for queue structure.
 ****************************************************************************/
@@ -118,6 +172,9 @@ static inline void SPECPQ_FOO(_pq_destroy)(SPECPQ_PQ *_pq)
 {
   SPECPQ_PQ_ *pq = (SPECPQ_PQ_ *) _pq;
 
+#ifdef SPECPQ_INDEXED
+  free(pq->positions);
+#endif /* SPECPQ_INDEXED */
   free(pq->cells);
   free(pq);
 }
@@ -137,12 +194,17 @@ SPECPQ_FOO(_pq_destroy_full)(SPECPQ_PQ *_pq,
       data_free(pq->cells[i].data);
     }
   }
+#ifdef SPECPQ_INDEXED
+  free(pq->positions);
+#endif /* SPECPQ_INDEXED */
   free(pq->cells);
   free(pq);
 }
 
 /************************************************************************//**
-  Insert an item into the queue.
+  Insert an item into the queue. For a position-tracking queue, inserting
+  a datum that is already queued raises its priority instead of adding a
+  duplicate cell (and is a no-op when the new priority is not better).
 ****************************************************************************/
 static inline void SPECPQ_FOO(_pq_insert)(SPECPQ_PQ *_pq,
                                           SPECPQ_DATA_TYPE data,
@@ -151,6 +213,26 @@ static inline void SPECPQ_FOO(_pq_insert)(SPECPQ_PQ *_pq,
   SPECPQ_PQ_ *pq = (SPECPQ_PQ_ *) _pq;
   int i, j;
 
+#ifdef SPECPQ_INDEXED
+  if (pq->positions != nullptr && pq->positions[data] >= 0) {
+    /* Already queued; keep one live cell per datum. */
+    i = pq->positions[data];
+    if (pq->cells[i].priority >= priority) {
+      return;
+    }
+    /* Percolate-up from the existing cell. */
+    while ((j = i / 2) && pq->cells[j].priority < priority) {
+      pq->cells[i] = pq->cells[j];
+      SPECPQ_TRACK_(pq, i);
+      i = j;
+    }
+    pq->cells[i].data = data;
+    pq->cells[i].priority = priority;
+    SPECPQ_TRACK_(pq, i);
+    return;
+  }
+#endif /* SPECPQ_INDEXED */
+
   /* Allocate more memory if necessary. */
   if (pq->size >= pq->avail) {
     int newsize = pq->size + pq->step;
@@ -163,14 +245,18 @@ static inline void SPECPQ_FOO(_pq_insert)(SPECPQ_PQ *_pq,
   i = pq->size++;
   while (i > 1 && (j = i / 2) && pq->cells[j].priority < priority) {
     pq->cells[i] = pq->cells[j];
+    SPECPQ_TRACK_(pq, i);
     i = j;
   }
   pq->cells[i].data = data;
   pq->cells[i].priority = priority;
+  SPECPQ_TRACK_(pq, i);
 }
 
 /************************************************************************//**
   Set a better priority for datum. Insert if 'data' is not present yet.
+  For a position-tracking queue this is a O(log n) decrease-key; otherwise
+  it scans the heap for the datum.
 ****************************************************************************/
 static inline void SPECPQ_FOO(_pq_replace)(SPECPQ_PQ *_pq,
                                            SPECPQ_DATA_TYPE data,
@@ -179,6 +265,14 @@ static inline void SPECPQ_FOO(_pq_replace)(SPECPQ_PQ *_pq,
   SPECPQ_PQ_ *pq = (SPECPQ_PQ_ *) _pq;
   int i, j;
 
+#ifdef SPECPQ_INDEXED
+  if (pq->positions != nullptr) {
+    /* Insert handles the already-queued case via the position map. */
+    SPECPQ_FOO(_pq_insert)(_pq, data, priority);
+    return;
+  }
+#endif /* SPECPQ_INDEXED */
+
   /* Lookup for 'data'... */
   for (i = pq->size - 1; i >= 1; i--) {
     if (pq->cells[i].data == data) {
@@ -221,6 +315,11 @@ static inline bool SPECPQ_FOO(_pq_remove)(SPECPQ_PQ *_pq,
   fc_assert_ret_val(pq->size <= pq->avail, FALSE);
   top = pq->cells[1].data;
   pq->size--;
+#ifdef SPECPQ_INDEXED
+  if (pq->positions != nullptr) {
+    pq->positions[top] = -1;
+  }
+#endif /* SPECPQ_INDEXED */
   tmp = pq->cells[pq->size];
   s = pq->size / 2;
   i = 1;
@@ -237,10 +336,15 @@ static inline bool SPECPQ_FOO(_pq_remove)(SPECPQ_PQ *_pq,
       break;
     }
     *pcelli = *pcellj;
+    SPECPQ_TRACK_(pq, i);
     i = j;
     pcelli = pcellj;
   }
   *pcelli = tmp;
+  if (pq->size > 1) {
+    /* Not meaningful when the queue just became empty. */
+    SPECPQ_TRACK_(pq, i);
+  }
   if (pdata) {
     *pdata = top;
   }
@@ -285,12 +389,16 @@ static inline bool SPECPQ_FOO(_pq_priority)(const SPECPQ_PQ *_pq,
 #undef SPECPQ_TAG
 #undef SPECPQ_PRIORITY_TYPE
 #undef SPECPQ_DATA_TYPE
+#ifdef SPECPQ_INDEXED
+#undef SPECPQ_INDEXED
+#endif /* SPECPQ_INDEXED */
 #undef SPECPQ_PASTE_
 #undef SPECPQ_PASTE
 #undef SPECPQ_PQ
 #undef SPECPQ_PQ_
 #undef SPECPQ_CELL_
 #undef SPECPQ_FOO
+#undef SPECPQ_TRACK_
 
 #ifdef __cplusplus
 }
@@ -44,6 +44,7 @@
 #include <fc_config.h>
 #endif
 
+#include <string.h>
 #include <time.h>
 
 #ifdef HAVE_GETTIMEOFDAY
@@ -439,3 +440,201 @@ void timer_usleep_since_start(struct timer *t, long usec)
   fc_usleep(usec);
 #endif
 }
+
+/* Hierarchical scoped profiler. One node per distinct begin-name under
+ * a given parent scope; re-entering a scope accumulates into the same
+ * node. The tree persists until fcprof_free(), only the measurements
+ * are reset by fcprof_clear(). */
+struct prof_node {
+  char *name;
+  struct timer *timer;
+  int calls;
+  struct prof_node *parent;
+  struct prof_node *children;   /* First child, in creation order */
+  struct prof_node *sibling;    /* Next child of the same parent */
+};
+
+bool fcprof_is_on = FALSE;
+
+static struct prof_node prof_root = { nullptr, nullptr, 0,
+                                      nullptr, nullptr, nullptr };
+static struct prof_node *prof_current = &prof_root;
+
+/*******************************************************************//**
+  Turn the profiler on or off. Turning it off mid-scope abandons the
+  open scopes: running timers are stopped and the scope stack unwinds
+  to the root, so it is safe to toggle from a server command while
+  instrumented code is on the call stack.
+***********************************************************************/
+void fcprof_enable(bool enable)
+{
+  if (!enable) {
+    while (prof_current != &prof_root) {
+      timer_stop(prof_current->timer);
+      prof_current = prof_current->parent;
+    }
+  }
+  fcprof_is_on = enable;
+}
+
+/*******************************************************************//**
+  Whether the profiler is currently collecting.
+***********************************************************************/
+bool fcprof_enabled(void)
+{
+  return fcprof_is_on;
+}
+
+/*******************************************************************//**
+  Open a profiling scope named 'name' nested in the current scope.
+  'name' must outlive the profiler tree; string literals are the
+  intended use. Prefer the FCPROF_BEGIN() macro, which skips the call
+  entirely while the profiler is off.
+***********************************************************************/
+void fcprof_begin(const char *name)
+{
+  struct prof_node *node, **tailp;
+
+  if (!fcprof_is_on) {
+    return;
+  }
+
+  for (tailp = &prof_current->children; (node = *tailp) != nullptr;
+       tailp = &node->sibling) {
+    if (node->name == name || strcmp(node->name, name) == 0) {
+      break;
+    }
+  }
+  if (node == nullptr) {
+    node = fc_calloc(1, sizeof(*node));
+    node->name = fc_strdup(name);
+    node->timer = timer_new(TIMER_USER, TIMER_ACTIVE, name);
+    node->parent = prof_current;
+    *tailp = node;
+  }
+
+  node->calls++;
+  timer_start(node->timer);
+  prof_current = node;
+}
+
+/*******************************************************************//**
+  Close the innermost open profiling scope.
+***********************************************************************/
+void fcprof_end(void)
+{
+  if (!fcprof_is_on) {
+    return;
+  }
+
+  fc_assert_ret(prof_current != &prof_root);
+  timer_stop(prof_current->timer);
+  prof_current = prof_current->parent;
+}
+
+/*******************************************************************//**
+  Reset all accumulated times and call counts, keeping the tree.
+  The caller clears once per turn to get per-turn aggregation. Timers
+  of still-open scopes restart so their time before the clear is
+  dropped rather than attributed to the next interval twice.
+***********************************************************************/
+static void prof_node_clear(struct prof_node *node)
+{
+  struct prof_node *child;
+
+  if (node->timer != nullptr) {
+    bool running = FALSE;
+    struct prof_node *open;
+
+    for (open = prof_current; open != nullptr; open = open->parent) {
+      if (open == node) {
+        running = TRUE;
+        break;
+      }
+    }
+    timer_clear(node->timer);
+    if (running) {
+      timer_start(node->timer);
+    }
+  }
+  node->calls = 0;
+
+  for (child = node->children; child != nullptr; child = child->sibling) {
+    prof_node_clear(child);
+  }
+}
+
+/*******************************************************************//**
+  Reset the measurements of the whole tree; see prof_node_clear().
+***********************************************************************/
+void fcprof_clear(void)
+{
+  prof_node_clear(&prof_root);
+}
+
+/*******************************************************************//**
+  Report the tree in depth-first pre-order: the callback runs once per
+  node with its nesting depth (0 for top-level scopes), name, call
+  count and accumulated seconds. Open scopes report their time so far.
+***********************************************************************/
+static void prof_node_report(const struct prof_node *node, int depth,
+                             fcprof_report_cb *cb, void *data)
+{
+  const struct prof_node *child;
+
+  if (node->timer != nullptr) {
+    cb(depth, node->name, node->calls, timer_read_seconds(node->timer),
+       data);
+  }
+
+  for (child = node->children; child != nullptr; child = child->sibling) {
+    prof_node_report(child, depth + 1, cb, data);
+  }
+}
+
+/*******************************************************************//**
+  Walk the profile tree; see prof_node_report().
+***********************************************************************/
+void fcprof_report(fcprof_report_cb *cb, void *data)
+{
+  prof_node_report(&prof_root, -1, cb, data);
+}
+
+/*******************************************************************//**
+  Free the profile tree and stop collecting.
+***********************************************************************/
+static void prof_node_free(struct prof_node *node)
+{
+  struct prof_node *child = node->children;
+
+  while (child != nullptr) {
+    struct prof_node *sibling = child->sibling;
+
+    prof_node_free(child);
+    child = sibling;
+  }
+
+  timer_destroy(node->timer);
+  free(node->name);
+  free(node);
+}
+
+/*******************************************************************//**
+  Tear the profiler down; instrumented code may keep running, the
+  FCPROF_*() macros become no-ops again.
+***********************************************************************/
+void fcprof_free(void)
+{
+  struct prof_node *child = prof_root.children;
+
+  fcprof_is_on = FALSE;
+  prof_current = &prof_root;
+
+  while (child != nullptr) {
+    struct prof_node *sibling = child->sibling;
+
+    prof_node_free(child);
+    child = sibling;
+  }
+  prof_root.children = nullptr;
+}
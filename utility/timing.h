@@ -92,6 +92,40 @@ double timer_read_seconds(struct timer *t)
 void timer_usleep_since_start(struct timer *t, long usec)
   fc__attribute((nonnull (1)));
 
+/* Hierarchical scoped profiler, built on the timers above. Scopes nest:
+ * fcprof_begin("ai") ... fcprof_begin("settlers") ... fcprof_end() ...
+ * fcprof_end() grows a tree of named nodes, each accumulating wall-clock
+ * time and a call count. The FCPROF_*() macros compile to a single
+ * branch on a bool while the profiler is off, so instrumentation can
+ * stay in release builds. The profiler is not thread-safe; use it from
+ * the main thread only. */
+extern bool fcprof_is_on;       /* Read-only; set via fcprof_enable() */
+
+#define FCPROF_BEGIN(name)                                                  \
+  do {                                                                      \
+    if (fcprof_is_on) {                                                     \
+      fcprof_begin(name);                                                   \
+    }                                                                       \
+  } while (FALSE)
+
+#define FCPROF_END()                                                        \
+  do {                                                                      \
+    if (fcprof_is_on) {                                                     \
+      fcprof_end();                                                         \
+    }                                                                       \
+  } while (FALSE)
+
+void fcprof_enable(bool enable);
+bool fcprof_enabled(void);
+void fcprof_begin(const char *name);
+void fcprof_end(void);
+void fcprof_clear(void);
+void fcprof_free(void);
+
+typedef void (fcprof_report_cb)(int depth, const char *name, int calls,
+                                double seconds, void *data);
+void fcprof_report(fcprof_report_cb *cb, void *data);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */